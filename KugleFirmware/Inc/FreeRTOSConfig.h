@@ -95,11 +95,13 @@
 /* USER CODE BEGIN 0 */   	      
     extern void configureTimerForRunTimeStats(void);
     extern unsigned long getRunTimeCounterValue(void);  
+    extern void MemoryTrace_Malloc(void * ptr, unsigned int size);
+    extern void MemoryTrace_Free(void * ptr, unsigned int size);
 /* USER CODE END 0 */       
 #endif
 
 #define configUSE_PREEMPTION                     1
-#define configSUPPORT_STATIC_ALLOCATION          0
+#define configSUPPORT_STATIC_ALLOCATION          1
 #define configSUPPORT_DYNAMIC_ALLOCATION         1
 #define configUSE_IDLE_HOOK                      0
 #define configUSE_TICK_HOOK                      0
@@ -182,6 +184,9 @@ standard names. */
 /* Definitions needed when configGENERATE_RUN_TIME_STATS is on */
 #define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS configureTimerForRunTimeStats
 #define portGET_RUN_TIME_COUNTER_VALUE getRunTimeCounterValue    
+/* Allocation tracing, see MemoryManagement.c */
+#define traceMALLOC( pvAddress, uiSize ) MemoryTrace_Malloc( pvAddress, uiSize )
+#define traceFREE( pvAddress, uiSize ) MemoryTrace_Free( pvAddress, uiSize )
 /* USER CODE END 2 */
 
 /* USER CODE BEGIN Defines */   	      
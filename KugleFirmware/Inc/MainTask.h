@@ -33,6 +33,7 @@ void MainTask(void * pvParameters);
 #include "LSPC.hpp"
 void Reboot_Callback(void * param, const std::vector<uint8_t>& payload);
 void EnterBootloader_Callback(void * param, const std::vector<uint8_t>& payload);
+void HeapStats_Callback(void * param, const std::vector<uint8_t>& payload);
 
 #endif
 
@@ -21,6 +21,56 @@
 #ifndef MEMORY_MANAGEMENT_H
 #define MEMORY_MANAGEMENT_H
 
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MEMORY_TRACE_MAX_TASKS			32 // slot 0 holds allocations made before the scheduler is started, the last slot is shared when running out of slots
+#define MEMORY_TRACE_NAME_LENGTH		20 // configMAX_TASK_NAME_LEN
+#define MEMORY_TRACE_HISTOGRAM_BINS		16 // free block sizes in powers of two, bin i holds blocks of 16*2^i to 16*2^(i+1)-1 bytes (the last bin holds all larger blocks)
+
+/* Allocation statistics of a task. Byte counts are heap block sizes, i.e. including the block header and alignment.
+ * Frees are counted for the task calling free, which is not necessarily the task which allocated the memory (eg. LSPC packages) */
+typedef struct {
+	uint32_t allocations;
+	uint32_t frees;
+	uint32_t failedAllocations;
+	uint32_t allocatedBytes;	// accumulated
+	uint32_t freedBytes;		// accumulated
+	uint32_t peakBytes;			// peak of allocatedBytes - freedBytes
+	char name[MEMORY_TRACE_NAME_LENGTH];
+} MemoryTrace_TaskStats_t;
+
+typedef struct {
+	uint32_t freeBytes;
+	uint32_t minimumEverFreeBytes;
+	uint32_t freeBlocks;
+	uint32_t largestFreeBlock;
+	uint16_t freeBlockHistogram[MEMORY_TRACE_HISTOGRAM_BINS];
+	uint32_t allocations;
+	uint32_t frees;
+	uint32_t failedAllocations;
+	uint32_t currentBytes;
+	uint32_t peakBytes;
+} MemoryTrace_HeapStats_t;
+
 void ZeroInitFreeRTOSheap(void);
+
+void MemoryTrace_Malloc(void * ptr, unsigned int size);
+void MemoryTrace_Free(void * ptr, unsigned int size);
+uint32_t MemoryTrace_GetTaskStats(MemoryTrace_TaskStats_t * stats, uint32_t maxTasks);
+void MemoryTrace_GetHeapStats(MemoryTrace_HeapStats_t * stats);
+void MemoryTrace_Reset(void);
+
+/* Heap inspection functions added to heap_4.c */
+size_t xPortGetBlockSize(void * pv);
+void vPortGetFreeBlocks(void (*pxCallback)(size_t xBlockSize, void * pvParameter), void * pvParameter);
+
+#ifdef __cplusplus
+}
+#endif
 	
 #endif 
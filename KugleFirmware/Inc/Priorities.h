@@ -47,6 +47,8 @@
  */
 #define MAIN_TASK_PRIORITY				0
 #define POWER_MANAGEMENT_PRIORITY		1
+#define BLACKBOX_PRIORITY				1
+#define FIRMWARE_UPDATE_PRIORITY		1 // erases the inactive flash bank, which does not stall the execution from the active bank
 #define TEST_BENCH_PRIORITY				2
 #define DEBUG_MESSAGE_PRIORITY			3
 #define BALANCE_CONTROLLER_PRIORITY		6
@@ -22,20 +22,17 @@
 
 #include "Parameters.h"
 #include "Debug.h"
-#include "LQR.h"
+#include "BalanceLoop.h"
 #include "QuaternionVelocityControl.h"
-#include "SlidingMode.h"
-#include "IIR.hpp"
-#include "QEKF.h"
-#include "MadgwickAHRS.h"
-#include "COMEKF.h"
-#include "VelocityEKF.h"
-#include "Kinematics.h"
 #include "Quaternion.h"
 
+#include "StaticArena.h"
+
 #include <string> // for memcpy
 
-BalanceController::BalanceController(IMU& imu_, ESCON& motor1_, ESCON& motor2_, ESCON& motor3_, LSPC& com_, Timer& microsTimer_) : TaskHandle_(0), isRunning_(false), shouldStop_(false), imu(imu_), motor1(motor1_), motor2(motor2_), motor3(motor3_), com(com_), microsTimer(microsTimer_)
+STATIC_ARENA(balanceControllerArena, BALANCECONTROLLER_ARENA_SIZE); // only one balance controller exists
+
+BalanceController::BalanceController(IMU& imu_, ESCON& motor1_, ESCON& motor2_, ESCON& motor3_, LSPC& com_, Telemetry& telemetry_, BlackBox& blackBox_, Timer& microsTimer_, TimeSync& timeSync_) : TaskHandle_(0), isRunning_(false), shouldStop_(false), imu(imu_), motor1(motor1_), motor2(motor2_), motor3(motor3_), com(com_), telemetry(telemetry_), blackBox(blackBox_), microsTimer(microsTimer_), timeSync(timeSync_)
 {
 	/* Create setpoint semaphores */
 	VelocityReference.semaphore = xSemaphoreCreateBinary();
@@ -47,9 +44,17 @@ BalanceController::BalanceController(IMU& imu_, ESCON& motor1_, ESCON& motor2_,
 	xSemaphoreGive( VelocityReference.semaphore ); // give the semaphore the first time
 
 	/* Register message type callbacks */
-	com.registerCallback(lspc::MessageTypesFromPC::CalibrateIMU, &CalibrateIMUCallback, (void *)this);
-	com.registerCallback(lspc::MessageTypesFromPC::VelocityReference_Heading, &VelocityReference_Heading_Callback, (void *)this);
-	com.registerCallback(lspc::MessageTypesFromPC::VelocityReference_Inertial, &VelocityReference_Inertial_Callback, (void *)this);
+	com.registerCallback<lspc::MessageTypesFromPC::CalibrateIMU>(&CalibrateIMUCallback, (void *)this);
+	com.registerCallback<lspc::MessageTypesFromPC::VelocityReference_Heading>(&VelocityReference_Heading_Callback, (void *)this);
+	com.registerCallback<lspc::MessageTypesFromPC::VelocityReference_Inertial>(&VelocityReference_Inertial_Callback, (void *)this);
+
+	/* Register periodic messages, transmitted every sample by default */
+	telemetry.Register(lspc::MessageTypesToPC::StateEstimates);
+	telemetry.Register(lspc::MessageTypesToPC::ControllerInfo);
+	telemetry.Register(lspc::MessageTypesToPC::RawSensor_IMU_MPU9250);
+	telemetry.Register(lspc::MessageTypesToPC::RawSensor_Encoders);
+	telemetry.Register(lspc::MessageTypesToPC::MathDump);
+	telemetry.Register(lspc::MessageTypesToPC::SensorSample, 0); // only enabled by the PC when logging for replay
 
 	Start();
 }
@@ -58,6 +63,7 @@ BalanceController::~BalanceController()
 {
 	shouldStop_ = true;
 	while (isRunning_) osDelay(10);
+	if (TaskHandle_) vTaskDelete(TaskHandle_);
 
 	/* Unregister message callbacks */
 	com.unregisterCallback(lspc::MessageTypesFromPC::CalibrateIMU);
@@ -75,7 +81,12 @@ int BalanceController::Start()
 {
 	if (isRunning_) return 0; // task already running
 	shouldStop_ = false;
-	return xTaskCreate( BalanceController::Thread, (char *)"Balance Controller", THREAD_STACK_SIZE, (void*) this, THREAD_PRIORITY, &TaskHandle_);
+	if (TaskHandle_) { // thread is waiting to be started again
+		xTaskNotifyGive(TaskHandle_);
+		return 1;
+	}
+	TaskHandle_ = xTaskCreateStatic( BalanceController::Thread, (char *)"Balance Controller", THREAD_STACK_SIZE, (void*) this, THREAD_PRIORITY, threadStack_, &threadBuffer_);
+	return (TaskHandle_ != NULL);
 }
 
 int BalanceController::Stop(uint32_t timeout)
@@ -102,11 +113,23 @@ int BalanceController::Restart(uint32_t timeout)
 	return Start();
 }
 
+/* The statically allocated thread is created once and kept alive, since its task buffer can not be reused
+ * before the idle task has cleaned up after vTaskDelete. Stop ends the control loop and Start resumes the thread. */
 void BalanceController::Thread(void * pvParameters)
 {
 	BalanceController * balanceController = (BalanceController *)pvParameters;
+
+	while (1) {
+		balanceController->isRunning_ = true;
+		ControllerLoop(balanceController);
+		balanceController->isRunning_ = false;
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY); // wait for Start
+	}
+}
+
+void BalanceController::ControllerLoop(BalanceController * balanceController)
+{
 	TickType_t xLastWakeTime;
-	balanceController->isRunning_ = true;
 
 	/* Load initialized objects */
 	IMU& imu = balanceController->imu;
@@ -117,58 +140,28 @@ void BalanceController::Thread(void * pvParameters)
 	Timer& microsTimer = balanceController->microsTimer;
 
 	/* Create and load parameters */
-	Parameters& params = *(new Parameters);
+	balanceControllerArena.Reset();
+	Parameters& params = *(new (balanceControllerArena) Parameters);
 
 	/* Controller loop time / sample rate */
 	TickType_t loopWaitTicks = configTICK_RATE_HZ / params.controller.SampleRate;
 
 	/* Create and initialize controller and estimator objects */
-	LQR& lqr = *(new LQR(params));
-	SlidingMode& sm = *(new SlidingMode(params));
-	QuaternionVelocityControl& velocityController = *(new QuaternionVelocityControl(params, &balanceController->microsTimer, 1.0f / params.controller.SampleRate));
-	QEKF& qEKF = *(new QEKF(params, &balanceController->microsTimer));
-	Madgwick& madgwick = *(new Madgwick(params.controller.SampleRate, params.estimator.MadgwickBeta));
-	VelocityEKF& velocityEKF = *(new VelocityEKF(params, &balanceController->microsTimer));
-	COMEKF& comEKF = *(new COMEKF(params, &balanceController->microsTimer));
-	Kinematics& kinematics = *(new Kinematics(params));
-	IIR<sizeof(params.estimator.SoftwareLPFcoeffs_a)/sizeof(float)-1> accel_x_filt(params.estimator.SoftwareLPFcoeffs_a, params.estimator.SoftwareLPFcoeffs_b);
-	IIR<sizeof(params.estimator.SoftwareLPFcoeffs_a)/sizeof(float)-1> accel_y_filt(params.estimator.SoftwareLPFcoeffs_a, params.estimator.SoftwareLPFcoeffs_b);
-	IIR<sizeof(params.estimator.SoftwareLPFcoeffs_a)/sizeof(float)-1> accel_z_filt(params.estimator.SoftwareLPFcoeffs_a, params.estimator.SoftwareLPFcoeffs_b);
-	IIR<sizeof(params.estimator.SoftwareLPFcoeffs_a)/sizeof(float)-1> gyro_x_filt(params.estimator.SoftwareLPFcoeffs_a, params.estimator.SoftwareLPFcoeffs_b);
-	IIR<sizeof(params.estimator.SoftwareLPFcoeffs_a)/sizeof(float)-1> gyro_y_filt(params.estimator.SoftwareLPFcoeffs_a, params.estimator.SoftwareLPFcoeffs_b);
-	IIR<sizeof(params.estimator.SoftwareLPFcoeffs_a)/sizeof(float)-1> gyro_z_filt(params.estimator.SoftwareLPFcoeffs_a, params.estimator.SoftwareLPFcoeffs_b);
+	BalanceLoop& loop = *(new (balanceControllerArena) BalanceLoop(params, &balanceController->microsTimer));
+	QuaternionVelocityControl& velocityController = *(new (balanceControllerArena) QuaternionVelocityControl(params, &balanceController->microsTimer, 1.0f / params.controller.SampleRate));
 
 	/* Measurement variables */
 	IMU::Measurement_t imuMeas;
 	int32_t EncoderTicks[3];
 	float EncoderAngle[3];
-
-	/* Estimate covariance variables */
-	float Cov_q[4*4];
-	float Cov_dxy[2*2];
+	lspc::MessageTypesToPC::SensorSample_t sensorSample;
+	uint32_t sampleNumber = 0;
 
 	/* Control output variables */
 	float Torque[3];
 	float TorqueDelivered[3];
-	float TorqueRampUpGain = 0;
-	bool TorqueRampUpFinished = false;
 
-	/* Control output filtering objects */
-	FirstOrderLPF& Motor1_LPF = *(new FirstOrderLPF(1.0f/params.controller.SampleRate, params.controller.TorqueLPFtau));
-	FirstOrderLPF& Motor2_LPF = *(new FirstOrderLPF(1.0f/params.controller.SampleRate, params.controller.TorqueLPFtau));
-	FirstOrderLPF& Motor3_LPF = *(new FirstOrderLPF(1.0f/params.controller.SampleRate, params.controller.TorqueLPFtau));
-
-	if (!lqr.UnitTest()) {
-		ERROR("LQR Unit test failed!");
-	}
-
-	if (!sm.UnitTest()) {
-		ERROR("Sliding Mode Unit test failed!");
-	}
-
-	if (!qEKF.UnitTest()) {
-		ERROR("qEKF Unit test failed!");
-	}
+	loop.UnitTest();
 
 	/* Reset estimators */
 	imu.Get(imuMeas);
@@ -178,13 +171,9 @@ void BalanceController::Thread(void * pvParameters)
 	EncoderAngle[0] = motor1.GetAngle();
 	EncoderAngle[1] = motor2.GetAngle();
 	EncoderAngle[2] = motor3.GetAngle();
-	qEKF.Reset(imuMeas.Accelerometer); // reset attitude estimator to current attitude, based on IMU
-	madgwick.Reset(imuMeas.Accelerometer[0], imuMeas.Accelerometer[1], imuMeas.Accelerometer[2]);
-	velocityEKF.Reset(EncoderTicks);
-	comEKF.Reset();
-	kinematics.Reset(EncoderAngle);
+	loop.Reset(imuMeas, EncoderTicks, EncoderAngle);
 
-	balanceController->StabilizeFilters(params, imu, qEKF, madgwick, loopWaitTicks, 1.0f); // stabilize estimators for 1 second
+	balanceController->StabilizeFilters(imu, loop, loopWaitTicks, 1.0f); // stabilize estimators for 1 second
 
 	/* Reset COM estimate */
 	balanceController->COM[0] = 0;
@@ -248,18 +237,6 @@ __attribute__((optimize("O0")))
 
 		/* Get measurements (sample) */
 		imu.Get(imuMeas);
-	    /* Adjust the measurements according to the calibration */
-		imu.CorrectMeasurement(imuMeas);
-
-		if (params.estimator.EnableSoftwareLPFfilters) {
-			imuMeas.Accelerometer[0] = accel_x_filt.Filter(imuMeas.Accelerometer[0]);
-			imuMeas.Accelerometer[1] = accel_y_filt.Filter(imuMeas.Accelerometer[1]);
-			imuMeas.Accelerometer[2] = accel_z_filt.Filter(imuMeas.Accelerometer[2]);
-			imuMeas.Gyroscope[0] = gyro_x_filt.Filter(imuMeas.Gyroscope[0]);
-			imuMeas.Gyroscope[1] = gyro_y_filt.Filter(imuMeas.Gyroscope[1]);
-			imuMeas.Gyroscope[2] = gyro_z_filt.Filter(imuMeas.Gyroscope[2]);
-		}
-
 		EncoderTicks[0] = motor1.GetEncoderRaw();
 		EncoderTicks[1] = motor2.GetEncoderRaw();
 		EncoderTicks[2] = motor3.GetEncoderRaw();
@@ -267,89 +244,32 @@ __attribute__((optimize("O0")))
 		EncoderAngle[1] = motor2.GetAngle();
 		EncoderAngle[2] = motor3.GetAngle();
 
-		if (params.debug.EnableRawSensorOutput) {
-			balanceController->SendRawSensors(params, imuMeas, EncoderAngle);
-		}
+		/* Keep the uncorrected measurements for the sensor log */
+		bool SendSensorSample = balanceController->telemetry.Due(lspc::MessageTypesToPC::SensorSample);
+		if (SendSensorSample)
+			balanceController->SampleSensors(sensorSample, sampleNumber, prevTimer, imuMeas, EncoderTicks, EncoderAngle);
+		sampleNumber++;
 
-		/* Attitude estimation */
-		if (params.estimator.UseMadgwick) {
-			madgwick.updateIMU(imuMeas.Gyroscope[0], imuMeas.Gyroscope[1], imuMeas.Gyroscope[2], imuMeas.Accelerometer[0], imuMeas.Accelerometer[1], imuMeas.Accelerometer[2]);
-			madgwick.getQuaternion(balanceController->q);
-			madgwick.getQuaternionDerivative(balanceController->dq);
-			// Hack for Madgwick quaternion estimate covariance
-	        for (int m = 0; m < 4; m++) {
-	          for (int n = 0; n < 4; n++) {
-	        	  Cov_q[4*m + n] = 0;
-	          }
-	        }
-	        for (int d = 0; d < 4; d++) {
-	        	Cov_q[4*d + d] = 3*1E-7; // set q covariance when MADGWICK is used
-	        }
-		} else { // use QEKF
-			qEKF.Step(imuMeas.Accelerometer, imuMeas.Gyroscope, params.estimator.EstimateBias);
-			qEKF.GetQuaternion(balanceController->q);
-			qEKF.GetQuaternionDerivative(balanceController->dq);
-			qEKF.GetQuaternionCovariance(Cov_q);
-		}
-
-		/* Quaternion derivative LPF filtering */
-	    /*dq[0] = dq0_filt.Filter(dq[0]);
-	    dq[1] = dq1_filt.Filter(dq[1]);
-	    dq[2] = dq2_filt.Filter(dq[2]);
-	    dq[3] = dq3_filt.Filter(dq[3]);*/
-
-		/* Independent heading requires dq to be decoupled around the yaw/heading axis */
-	    if (params.behavioural.IndependentHeading && !params.behavioural.YawVelocityBraking && !params.controller.DisableQdot) {
-	      float dq_tmp[4];
-	      dq_tmp[0] = balanceController->dq[0];
-	      dq_tmp[1] = balanceController->dq[1];
-	      dq_tmp[2] = balanceController->dq[2];
-	      dq_tmp[3] = balanceController->dq[3];
-	      HeadingIndependentQdot(dq_tmp, balanceController->q, balanceController->dq);
-	    }
+		/* State estimation (corrects and filters the IMU measurement in place) */
+		loop.Estimate(imu, imuMeas, EncoderTicks, EncoderAngle, balanceController->q, balanceController->dq, balanceController->dxy, balanceController->COM);
 
-	    /* Velocity estimation using kinematics */
-	    if (!params.estimator.UseVelocityEstimator) {
-	    	// compute velocity from encoder-based motor velocities and forward kinematics
-	    	kinematics.EstimateMotorVelocity(EncoderAngle);
-			if (params.estimator.Use2Lvelocity) {
-				float dxy_ball[2];
-				kinematics.ForwardKinematics(balanceController->q, balanceController->dq, dxy_ball);
-				kinematics.ConvertBallTo2Lvelocity(dxy_ball, balanceController->q, balanceController->dq, balanceController->dxy);            // put 2L velocity into dxy
-			} else {
-				kinematics.ForwardKinematics(balanceController->q, balanceController->dq, balanceController->dxy);       // put ball velocity into dxy
-			}
-	    }
-
-	    /* Velocity estimation using velocity EKF */
-	    if (params.estimator.UseVelocityEstimator) {
-	    	velocityEKF.Step(EncoderTicks, balanceController->q, Cov_q, balanceController->dq, balanceController->COM); // velocity estimator estimates 2L velocity
-	    	velocityEKF.GetVelocity(balanceController->dxy);
-	    	velocityEKF.GetVelocityCovariance(Cov_dxy);
-
-	    	// OBS. dxy was in the original design supposed to be ball velocity, but the velocity estimator estimates the 2L velocity which gives indirect "stabilization"
-	    	// In the Sliding Mode controller this velocity is (only) used to calculated "feedforward" torque to counteract friction
-	        if (!params.estimator.Use2Lvelocity) { // however if the 2L velocity is not desired, it is here converted back to ball velocity
-	        	kinematics.Convert2LtoBallVelocity(balanceController->dxy, balanceController->q, balanceController->dq, balanceController->dxy);
-	        }
-	    }
-
-	    /* Center of Mass estimation */
-	    if (params.estimator.EstimateCOM && params.estimator.UseVelocityEstimator) { // can only estimate COM if velocity is also estimated (due to need of velocity estimate covariance)
-	    	comEKF.Step(balanceController->dxy, Cov_dxy, balanceController->q, Cov_q, balanceController->dq);
-	    	comEKF.GetCOM(balanceController->COM);
-	    }
-
-	    /* Disable dq to avoid noisy control outputs resulting from noisy dq estimates */
-	    if (params.controller.DisableQdot) { // q_dot removed because it is VERY noisy - this causes oscillations on yaw, if yaw reference is included
-	    	balanceController->dq[0] = 0.0f;
-	    	balanceController->dq[1] = 0.0f;
-	    	balanceController->dq[2] = 0.0f;
-	    	balanceController->dq[3] = 0.0f;
-	    }
+		if (params.debug.EnableRawSensorOutput) {
+			if (balanceController->telemetry.Due(lspc::MessageTypesToPC::RawSensor_IMU_MPU9250))
+				balanceController->SendRawIMU(params, imuMeas);
+			if (balanceController->telemetry.Due(lspc::MessageTypesToPC::RawSensor_Encoders))
+				balanceController->SendRawEncoders(EncoderAngle);
+		}
 
 		/* Send State Estimates message */
-		balanceController->SendEstimates();
+		if (balanceController->telemetry.Due(lspc::MessageTypesToPC::StateEstimates))
+			balanceController->SendEstimates();
+
+		/* Trigger the black box recorder if the robot is falling (cosine of the tilt angle from the quaternion) */
+		if (params.controller.mode != lspc::ParameterTypes::OFF) {
+			const float * q = balanceController->q;
+			if (q[0]*q[0] - q[1]*q[1] - q[2]*q[2] + q[3]*q[3] < BLACKBOX_TILT_LIMIT_COS)
+				balanceController->blackBox.Trigger(lspc::BlackBoxTypes::TILT_LIMIT);
+		}
 
 		/*Debug::printf("qEKF = [%.3f, %.3f, %.3f, %.3f]\n", balanceController->q[0], balanceController->q[1], balanceController->q[2], balanceController->q[3]);
 		float YPR[3];
@@ -364,61 +284,14 @@ __attribute__((optimize("O0")))
 	    /* Compute internal q_ref, omega_ref_body and omega_ref_inertial based on mode and setpoints */
 
 	    /* Compute control output based on references */
-	    if (params.controller.type == lspc::ParameterTypes::LQR_CONTROLLER && params.controller.mode != lspc::ParameterTypes::OFF) {
-	    	lqr.Step(balanceController->q, balanceController->dq, balanceController->q_ref, balanceController->omega_ref_body, Torque);
-		} else if (params.controller.type == lspc::ParameterTypes::SLIDING_MODE_CONTROLLER && params.controller.mode != lspc::ParameterTypes::OFF) {
-			// OBS. When running the Sliding Mode controller, inertial angular velocity reference is needed
-			float S[3];
-	    	sm.Step(balanceController->q, balanceController->dq, balanceController->xy, balanceController->dxy, balanceController->q_ref, balanceController->omega_ref_inertial, Torque, S);
-		} else {
-			// Undefined controller mode, eg. OFF - set torque output to 0
-			Torque[0] = 0;
-			Torque[1] = 0;
-			Torque[2] = 0;
-		}
-
-	    /* Check if any of the torque outputs is NaN - if so, turn off the outputs */
-	    if (isnan(Torque[0]) || isnan(Torque[1]) || isnan(Torque[2])) {
-	    	Torque[0] = 0;
-	    	Torque[1] = 0;
-	    	Torque[2] = 0;
+	    bool TorqueNaN = loop.Control(balanceController->q, balanceController->dq, balanceController->xy, balanceController->dxy, balanceController->q_ref, balanceController->omega_ref_body, balanceController->omega_ref_inertial, Torque);
+	    if (TorqueNaN) {
+	    	balanceController->blackBox.Trigger(lspc::BlackBoxTypes::NAN_TORQUE);
 	    }
 
-	    /* Clamp the torque outputs between configured limits */
-	    if (params.controller.EnableTorqueSaturation) {
-	    	Torque[0] = fmax(fmin(Torque[0], params.controller.TorqueMax), -params.controller.TorqueMax);
-	    	Torque[1] = fmax(fmin(Torque[1], params.controller.TorqueMax), -params.controller.TorqueMax);
-	    	Torque[2] = fmax(fmin(Torque[2], params.controller.TorqueMax), -params.controller.TorqueMax);
-	    }
-
-	    /* Initial Torque ramp up */
-	    if (params.controller.TorqueRampUp) {
-	    	if (params.controller.mode == lspc::ParameterTypes::OFF) {
-				TorqueRampUpGain = 0;
-				TorqueRampUpFinished = false;
-	    	}
-	    	else if (!TorqueRampUpFinished) { // if controller is running and ramp up is not finished
-	    		Torque[0] *= TorqueRampUpGain;
-	    		Torque[1] *= TorqueRampUpGain;
-	    		Torque[2] *= TorqueRampUpGain;
-
-	    		TorqueRampUpGain += 1.0f / (params.controller.TorqueRampUpTime * params.controller.SampleRate); // ramp up rate
-	    		if (TorqueRampUpGain >= 1.0) {
-	    			TorqueRampUpFinished = true;
-	    		}
-	    	}
-	    }
-
-	    /* Torque output LPF filtering */
-	    if (params.controller.EnableTorqueLPF && params.controller.mode != lspc::ParameterTypes::OFF) {
-			Torque[0] = Motor1_LPF.Filter(Torque[0]);
-			Torque[1] = Motor2_LPF.Filter(Torque[1]);
-			Torque[2] = Motor3_LPF.Filter(Torque[2]);
-	    } else {
-	    	Motor1_LPF.Reset();
-	    	Motor2_LPF.Reset();
-	    	Motor3_LPF.Reset();
-	    }
+	    /* Send the sensor sample with the references and outputs computed from it */
+	    if (SendSensorSample)
+	    	balanceController->SendSensorSample(sensorSample, params.controller.type, params.controller.mode, Torque);
 
 	    if (params.controller.mode != lspc::ParameterTypes::OFF) {
 			/* Set control output */
@@ -451,14 +324,20 @@ __attribute__((optimize("O0")))
 		dt_meas = microsTimer.GetDeltaTime(prevTimer);
 		dt_meas2 = HAL_toc(timerPrev);
 
+		/* Record all internal signals of this sample in the black box */
+		balanceController->RecordBlackBox(params.controller.mode, imuMeas, Torque, TorqueDelivered, dt_meas, TorqueNaN);
+
 		/* Send controller info package */
-		balanceController->SendControllerInfo(params.controller.type, params.controller.mode, Torque, dt_meas, TorqueDelivered);
+		if (balanceController->telemetry.Due(lspc::MessageTypesToPC::ControllerInfo))
+			balanceController->SendControllerInfo(params.controller.type, params.controller.mode, Torque, dt_meas, TorqueDelivered);
 		//Debug::printf("Balance controller compute time: %9.7f s\n", dt_meas);
 		//Debug::printf("Applied torque: %4.2f\t%4.2f\t%4.2f\n", TorqueApplied[0], TorqueApplied[1], TorqueApplied[2]);
 
 		/* Send IMU Log (test package) for MATH dump */
-		float imuLog[] = {microsTimer.GetTime(), imuMeas.Accelerometer[0], imuMeas.Accelerometer[1], imuMeas.Accelerometer[2], imuMeas.Gyroscope[0], imuMeas.Gyroscope[1], imuMeas.Gyroscope[2]};
-		com.TransmitAsync(lspc::MessageTypesToPC::MathDump, (uint8_t *)&imuLog, sizeof(imuLog));
+		if (balanceController->telemetry.Due(lspc::MessageTypesToPC::MathDump)) {
+			float imuLog[] = {balanceController->timeSync.GetTelemetryTime(), imuMeas.Accelerometer[0], imuMeas.Accelerometer[1], imuMeas.Accelerometer[2], imuMeas.Gyroscope[0], imuMeas.Gyroscope[1], imuMeas.Gyroscope[2]};
+			com.TransmitAsync(lspc::MessageTypesToPC::MathDump, (uint8_t *)&imuLog, sizeof(imuLog));
+		}
 	}
 	/* End of control loop */
 
@@ -468,20 +347,9 @@ __attribute__((optimize("O0")))
 	motor3.Disable();
 
 	/* Clear controller and estimator objects */
-	delete(&params);
-	delete(&lqr);
-	delete(&sm);
-	delete(&velocityController);
-	delete(&qEKF);
-	delete(&madgwick);
-	delete(&velocityEKF);
-	delete(&comEKF);
-	delete(&kinematics);
-
-	/* Stop and delete task */
-	balanceController->isRunning_ = false;
-	balanceController->TaskHandle_ = 0;
-	vTaskDelete(NULL); // delete/stop this current task
+	StaticArena_Destroy(&params);
+	StaticArena_Destroy(&loop);
+	StaticArena_Destroy(&velocityController);
 }
 
 /*
@@ -508,7 +376,7 @@ void BalanceController::SetReference(const float omega_ref_[3])
 
 
 /* Initialize/stabilize estimators for certain stabilization time */
-void BalanceController::StabilizeFilters(Parameters& params, IMU& imu, QEKF& qEKF, Madgwick& madgwick, TickType_t loopWaitTicks, float stabilizationTime)
+void BalanceController::StabilizeFilters(IMU& imu, BalanceLoop& loop, TickType_t loopWaitTicks, float stabilizationTime)
 {
 	TickType_t xLastWakeTime = xTaskGetTickCount();
 	TickType_t finishTick = xLastWakeTime + configTICK_RATE_HZ * stabilizationTime;
@@ -525,11 +393,7 @@ void BalanceController::StabilizeFilters(Parameters& params, IMU& imu, QEKF& qEK
 		imu.CorrectMeasurement(imuMeas);
 
 		// Compute attitude estimate
-		if (params.estimator.UseMadgwick) {
-			madgwick.updateIMU(imuMeas.Gyroscope[0], imuMeas.Gyroscope[1], imuMeas.Gyroscope[2], imuMeas.Accelerometer[0], imuMeas.Accelerometer[1], imuMeas.Accelerometer[2], 0.1); // use larger beta to make filter converge to current angle by trusting the accelerometer more
-		} else {
-			qEKF.Step(imuMeas.Accelerometer, imuMeas.Gyroscope, false); // do not estimate bias while stabilizing the filter
-		}
+		loop.Stabilize(imuMeas);
 	}
 }
 
@@ -608,7 +472,8 @@ void BalanceController::SendEstimates(void)
 {
 	lspc::MessageTypesToPC::StateEstimates_t msg;
 
-	msg.time = microsTimer.GetTime();
+	bool synchronized;
+	msg.time = timeSync.GetTelemetryTime(synchronized);
 	msg.q.w = q[0];
 	msg.q.x = q[1];
 	msg.q.y = q[2];
@@ -621,16 +486,19 @@ void BalanceController::SendEstimates(void)
 	msg.pos.y = xy[1];
 	msg.vel.x = dxy[0];
 	msg.vel.y = dxy[1];
+	msg.COM.x = COM[0];
+	msg.COM.y = COM[1];
+	msg.COM.z = COM[2];
 
-	com.TransmitAsync(lspc::MessageTypesToPC::StateEstimates, (uint8_t *)&msg, sizeof(msg));
+	telemetry.Transmit(lspc::MessageTypesToPC::StateEstimates, &msg, sizeof(msg), synchronized);
 }
 
-void BalanceController::SendRawSensors(Parameters& params, const IMU::Measurement_t& imuMeas, const float EncoderAngle[3])
+void BalanceController::SendRawIMU(Parameters& params, const IMU::Measurement_t& imuMeas)
 {
 	lspc::MessageTypesToPC::RawSensor_IMU_MPU9250_t imu_msg;
-	lspc::MessageTypesToPC::RawSensor_Encoders_t encoders_msg;
 
-	imu_msg.time = microsTimer.GetTime();
+	bool synchronized;
+	imu_msg.time = timeSync.GetTelemetryTime(synchronized);
 	imu_msg.accelerometer.x = imuMeas.Accelerometer[0];
 	imu_msg.accelerometer.y = imuMeas.Accelerometer[1];
 	imu_msg.accelerometer.z = imuMeas.Accelerometer[2];
@@ -643,21 +511,65 @@ void BalanceController::SendRawSensors(Parameters& params, const IMU::Measuremen
 	imu_msg.magnetometer.x = 0;//imuMeas.Magnetometer[0];
 	imu_msg.magnetometer.y = 0;//imuMeas.Magnetometer[1];
 	imu_msg.magnetometer.z = 0;//imuMeas.Magnetometer[2];
+	memset(imu_msg.magnetometer.cov, 0, sizeof(imu_msg.magnetometer.cov));
+
+	telemetry.Transmit(lspc::MessageTypesToPC::RawSensor_IMU_MPU9250, &imu_msg, sizeof(imu_msg), synchronized);
+}
+
+void BalanceController::SendRawEncoders(const float EncoderAngle[3])
+{
+	lspc::MessageTypesToPC::RawSensor_Encoders_t encoders_msg;
 
-	encoders_msg.time = microsTimer.GetTime();
+	bool synchronized;
+	encoders_msg.time = timeSync.GetTelemetryTime(synchronized);
 	encoders_msg.angle1 = EncoderAngle[0];
 	encoders_msg.angle2 = EncoderAngle[1];
 	encoders_msg.angle3 = EncoderAngle[2];
 
-	com.TransmitAsync(lspc::MessageTypesToPC::RawSensor_IMU_MPU9250, (uint8_t *)&imu_msg, sizeof(imu_msg));
-	com.TransmitAsync(lspc::MessageTypesToPC::RawSensor_Encoders, (uint8_t *)&encoders_msg, sizeof(encoders_msg));
+	telemetry.Transmit(lspc::MessageTypesToPC::RawSensor_Encoders, &encoders_msg, sizeof(encoders_msg), synchronized);
+}
+
+/**
+ * @brief 	Store the uncorrected measurements of a sample in a sensor sample message
+ * @param	sample          Output: sensor sample message
+ * @param	sampleNumber    Input: number of the sample since the controller was started
+ * @param	timer           Input: microseconds timer value at the time of the sample
+ */
+void BalanceController::SampleSensors(lspc::MessageTypesToPC::SensorSample_t& sample, const uint32_t sampleNumber, const uint32_t timer, const IMU::Measurement_t& imuMeas, const int32_t EncoderTicks[3], const float EncoderAngle[3])
+{
+	sample.sample = sampleNumber;
+	sample.timer = timer;
+	memcpy(sample.accelerometer, imuMeas.Accelerometer, sizeof(sample.accelerometer));
+	memcpy(sample.gyroscope, imuMeas.Gyroscope, sizeof(sample.gyroscope));
+	memcpy(sample.encoderTicks, EncoderTicks, sizeof(sample.encoderTicks));
+	memcpy(sample.encoderAngle, EncoderAngle, sizeof(sample.encoderAngle));
+}
+
+/**
+ * @brief 	Complete the sensor sample message with the references and outputs of the sample and send it
+ */
+void BalanceController::SendSensorSample(lspc::MessageTypesToPC::SensorSample_t& sample, const lspc::ParameterTypes::controllerType_t Type, const lspc::ParameterTypes::controllerMode_t Mode, const float Torque[3])
+{
+	memcpy(sample.xy, xy, sizeof(sample.xy));
+	memcpy(sample.q_ref, q_ref, sizeof(sample.q_ref));
+	memcpy(sample.omega_ref_body, omega_ref_body, sizeof(sample.omega_ref_body));
+	memcpy(sample.omega_ref_inertial, omega_ref_inertial, sizeof(sample.omega_ref_inertial));
+	sample.type = Type;
+	sample.mode = Mode;
+	sample.reserved[0] = 0;
+	sample.reserved[1] = 0;
+	memcpy(sample.q, q, sizeof(sample.q));
+	memcpy(sample.torque, Torque, sizeof(sample.torque));
+
+	telemetry.Transmit(lspc::MessageTypesToPC::SensorSample, &sample, sizeof(sample));
 }
 
 void BalanceController::SendControllerInfo(const lspc::ParameterTypes::controllerType_t Type, const lspc::ParameterTypes::controllerMode_t Mode, const float Torque[3], const float ComputeTime, const float TorqueDelivered[3])
 {
 	lspc::MessageTypesToPC::ControllerInfo_t msg;
 
-	msg.time = microsTimer.GetTime();
+	bool synchronized;
+	msg.time = timeSync.GetTelemetryTime(synchronized);
 	msg.type = Type;
 	msg.mode = Mode;
 	msg.torque1 = Torque[0];
@@ -668,25 +580,44 @@ void BalanceController::SendControllerInfo(const lspc::ParameterTypes::controlle
 	msg.delivered_torque2 = TorqueDelivered[1];
 	msg.delivered_torque3 = TorqueDelivered[2];
 
-	com.TransmitAsync(lspc::MessageTypesToPC::ControllerInfo, (uint8_t *)&msg, sizeof(msg));
+	telemetry.Transmit(lspc::MessageTypesToPC::ControllerInfo, &msg, sizeof(msg), synchronized);
+}
+
+void BalanceController::RecordBlackBox(const lspc::ParameterTypes::controllerMode_t Mode, const IMU::Measurement_t& imuMeas, const float Torque[3], const float TorqueDelivered[3], const float ComputeTime, const bool TorqueNaN)
+{
+	lspc::BlackBoxTypes::Record_t record;
+
+	record.time = microsTimer.Get();
+	record.mode = Mode;
+	record.flags = TorqueNaN ? 0x01 : 0x00;
+	record.reserved = 0;
+	memcpy(record.accelerometer, imuMeas.Accelerometer, sizeof(record.accelerometer));
+	memcpy(record.gyroscope, imuMeas.Gyroscope, sizeof(record.gyroscope));
+	memcpy(record.q, q, sizeof(record.q));
+	memcpy(record.dq, dq, sizeof(record.dq));
+	memcpy(record.xy, xy, sizeof(record.xy));
+	memcpy(record.dxy, dxy, sizeof(record.dxy));
+	memcpy(record.COM, COM, sizeof(record.COM));
+	memcpy(record.torque, Torque, sizeof(record.torque));
+	memcpy(record.delivered_torque, TorqueDelivered, sizeof(record.delivered_torque));
+	record.compute_time = ComputeTime;
+
+	blackBox.Record(record);
 }
 
 
-void BalanceController::CalibrateIMUCallback(void * param, const std::vector<uint8_t>& payload)
+void BalanceController::CalibrateIMUCallback(void * param, const lspc::MessageTypesFromPC::CalibrateIMU_t& msg)
 {
 	BalanceController * balanceController = (BalanceController *)param;
 	if (!balanceController) return;
 
-	lspc::MessageTypesFromPC::CalibrateIMU_t msg;
 	lspc::MessageTypesToPC::CalibrateIMUAck_t msgAck;
-	if (payload.size() != sizeof(msg)) return;
-	memcpy((uint8_t *)&msg, payload.data(), sizeof(msg));
 
 	/* Should both check whether the magic key in the payload is correct and that the system is not balancing - otherwise calibration can not be performed */
 	if (msg.magic_key != 0x12345678) {
 		// Send acknowledge back to PC
 		msgAck.acknowledged = false;
-		balanceController->com.TransmitAsync(lspc::MessageTypesToPC::CalibrateIMUAck, (uint8_t *)&msgAck, sizeof(msgAck));
+		balanceController->com.TransmitAsync<lspc::MessageTypesToPC::CalibrateIMUAck>(msgAck);
 		return;
 	}
 
@@ -697,7 +628,7 @@ void BalanceController::CalibrateIMUCallback(void * param, const std::vector<uin
 	if (mode != lspc::ParameterTypes::OFF) {
 		// Send acknowledge back to PC
 		msgAck.acknowledged = false;
-		balanceController->com.TransmitAsync(lspc::MessageTypesToPC::CalibrateIMUAck, (uint8_t *)&msgAck, sizeof(msgAck));
+		balanceController->com.TransmitAsync<lspc::MessageTypesToPC::CalibrateIMUAck>(msgAck);
 		return;
 	}
 
@@ -709,7 +640,7 @@ void BalanceController::CalibrateIMUCallback(void * param, const std::vector<uin
 
 	/* Send acknowledge message back to PC */
 	msgAck.acknowledged = true;
-	balanceController->com.TransmitAsync(lspc::MessageTypesToPC::CalibrateIMUAck, (uint8_t *)&msgAck, sizeof(msgAck));
+	balanceController->com.TransmitAsync<lspc::MessageTypesToPC::CalibrateIMUAck>(msgAck);
 
 	balanceController->imu.Calibrate(true);
 
@@ -721,18 +652,11 @@ void BalanceController::CalibrateIMUCallback(void * param, const std::vector<uin
 	}
 }
 
-void BalanceController::VelocityReference_Heading_Callback(void * param, const std::vector<uint8_t>& payload)
+void BalanceController::VelocityReference_Heading_Callback(void * param, const lspc::MessageTypesFromPC::VelocityReference_Heading_t& msg)
 {
 	BalanceController * balanceController = (BalanceController *)param;
 	if (!balanceController) return;
 
-	/*uint8_t * buffer = const_cast<uint8_t *>(payload.data());
-	uint32_t length = payload.size();*/
-
-	volatile lspc::MessageTypesFromPC::VelocityReference_Heading_t msg;
-	if (payload.size() != sizeof(msg)) return;
-	memcpy((uint8_t *)&msg, payload.data(), sizeof(msg));
-
 	xSemaphoreTake( balanceController->VelocityReference.semaphore, ( TickType_t ) portMAX_DELAY); // lock for updating
 
 	/* Update references with input values from message */
@@ -745,18 +669,11 @@ void BalanceController::VelocityReference_Heading_Callback(void * param, const s
 	xSemaphoreGive( balanceController->VelocityReference.semaphore ); // give semaphore back
 }
 
-void BalanceController::VelocityReference_Inertial_Callback(void * param, const std::vector<uint8_t>& payload)
+void BalanceController::VelocityReference_Inertial_Callback(void * param, const lspc::MessageTypesFromPC::VelocityReference_Inertial_t& msg)
 {
 	BalanceController * balanceController = (BalanceController *)param;
 	if (!balanceController) return;
 
-	/*uint8_t * buffer = const_cast<uint8_t *>(payload.data());
-	uint32_t length = payload.size();*/
-
-	volatile lspc::MessageTypesFromPC::VelocityReference_Heading_t msg;
-	if (payload.size() != sizeof(msg)) return;
-	memcpy((uint8_t *)&msg, payload.data(), sizeof(msg));
-
 	xSemaphoreTake( balanceController->VelocityReference.semaphore, ( TickType_t ) portMAX_DELAY); // lock for updating
 
 	/* Update references with input values from message */
@@ -21,23 +21,26 @@
 #define APPLICATION_BALANCECONTROLLER_H
 
 #include "cmsis_os.h"
+#include "Priorities.h"
 #include "Parameters.h"
 #include "LSPC.hpp"
+#include "Telemetry.h"
+#include "BlackBox.h"
+#include "TimeSync.h"
 #include "ESCON.h"
 #include "IMU.h"
 #include "Timer.h"
 #include "QuaternionVelocityControl.h"
-#include "LQR.h"
-#include "SlidingMode.h"
-#include "QEKF.h"
-#include "MadgwickAHRS.h"
-#include "COMEKF.h"
-#include "VelocityEKF.h"
+#include "BalanceLoop.h"
+#include "StaticArena.h"
+
+/* The controller and estimator objects are created in a static arena every time the controller thread is started */
+#define BALANCECONTROLLER_ARENA_SIZE	( STATIC_ARENA_SIZEOF(Parameters) + STATIC_ARENA_SIZEOF(BalanceLoop) + STATIC_ARENA_SIZEOF(QuaternionVelocityControl) )
 
 class BalanceController
 {
 	private:
-		const int THREAD_STACK_SIZE = 1500; // notice that this much stack is apparently necessary to avoid issues
+		static const int THREAD_STACK_SIZE = 1500; // notice that this much stack is apparently necessary to avoid issues
 		const uint32_t THREAD_PRIORITY = BALANCE_CONTROLLER_PRIORITY;
 
 	public:
@@ -48,7 +51,7 @@ class BalanceController
 		} referenceFrame_t;
 
 	public:
-		BalanceController(IMU& imu_, ESCON& motor1_, ESCON& motor2_, ESCON& motor3_, LSPC& com_, Timer& microsTimer_);
+		BalanceController(IMU& imu_, ESCON& motor1_, ESCON& motor2_, ESCON& motor3_, LSPC& com_, Telemetry& telemetry_, BlackBox& blackBox_, Timer& microsTimer_, TimeSync& timeSync_);
 		~BalanceController();
 
 		int Start();
@@ -62,21 +65,28 @@ class BalanceController
 
 	private:
 		void ReferenceGeneration(Parameters& params, QuaternionVelocityControl& velocityController);
-		void StabilizeFilters(Parameters& params, IMU& imu, QEKF& qEKF, Madgwick& madgwick, TickType_t loopWaitTicks, float stabilizationTime);
+		void StabilizeFilters(IMU& imu, BalanceLoop& loop, TickType_t loopWaitTicks, float stabilizationTime);
 
 	private:
 		static void Thread(void * pvParameters);
+		static void ControllerLoop(BalanceController * balanceController);
 		void SendEstimates(void);
-		void SendRawSensors(Parameters& params, const IMU::Measurement_t& imuMeas, const float EncoderAngle[3]);
+		void SendRawIMU(Parameters& params, const IMU::Measurement_t& imuMeas);
+		void SendRawEncoders(const float EncoderAngle[3]);
+		void SampleSensors(lspc::MessageTypesToPC::SensorSample_t& sample, const uint32_t sampleNumber, const uint32_t timer, const IMU::Measurement_t& imuMeas, const int32_t EncoderTicks[3], const float EncoderAngle[3]);
+		void SendSensorSample(lspc::MessageTypesToPC::SensorSample_t& sample, const lspc::ParameterTypes::controllerType_t Type, const lspc::ParameterTypes::controllerMode_t Mode, const float Torque[3]);
 		void SendControllerInfo(const lspc::ParameterTypes::controllerType_t Type, const lspc::ParameterTypes::controllerMode_t Mode, const float Torque[3], const float ComputeTime, const float TorqueDelivered[3]);
-		static void CalibrateIMUCallback(void * param, const std::vector<uint8_t>& payload);
-		static void VelocityReference_Heading_Callback(void * param, const std::vector<uint8_t>& payload);
-		static void VelocityReference_Inertial_Callback(void * param, const std::vector<uint8_t>& payload);
+		void RecordBlackBox(const lspc::ParameterTypes::controllerMode_t Mode, const IMU::Measurement_t& imuMeas, const float Torque[3], const float TorqueDelivered[3], const float ComputeTime, const bool TorqueNaN);
+		static void CalibrateIMUCallback(void * param, const lspc::MessageTypesFromPC::CalibrateIMU_t& msg);
+		static void VelocityReference_Heading_Callback(void * param, const lspc::MessageTypesFromPC::VelocityReference_Heading_t& msg);
+		static void VelocityReference_Inertial_Callback(void * param, const lspc::MessageTypesFromPC::VelocityReference_Inertial_t& msg);
 
 	private:
 		TaskHandle_t TaskHandle_;
 		bool isRunning_;
 		bool shouldStop_;
+		StaticTask_t threadBuffer_;
+		StackType_t threadStack_[THREAD_STACK_SIZE];
 
 	private:
 		IMU& imu;
@@ -84,7 +94,10 @@ class BalanceController
 		ESCON& motor2;
 		ESCON& motor3;
 		LSPC& com;
+		Telemetry& telemetry;
+		BlackBox& blackBox;
 		Timer& microsTimer;
+		TimeSync& timeSync;
 
 		// State estimates
 		float xy[2];
@@ -0,0 +1,269 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+ 
+ 
+#include "BalanceLoop.h"
+#include "Debug.h"
+#include "Quaternion.h"
+
+#include <math.h>
+
+BalanceLoop::BalanceLoop(Parameters& params, Timer * microsTimer) : params_(params),
+	lqr(params), sm(params), qEKF(params, microsTimer), mEKF(params, microsTimer), madgwick(params.controller.SampleRate, params.estimator.MadgwickBeta),
+	velocityEKF(params, microsTimer), comEKF(params, microsTimer), kinematics(params),
+	accel_x_filt(params.estimator.SoftwareLPFcoeffs_a, params.estimator.SoftwareLPFcoeffs_b),
+	accel_y_filt(params.estimator.SoftwareLPFcoeffs_a, params.estimator.SoftwareLPFcoeffs_b),
+	accel_z_filt(params.estimator.SoftwareLPFcoeffs_a, params.estimator.SoftwareLPFcoeffs_b),
+	gyro_x_filt(params.estimator.SoftwareLPFcoeffs_a, params.estimator.SoftwareLPFcoeffs_b),
+	gyro_y_filt(params.estimator.SoftwareLPFcoeffs_a, params.estimator.SoftwareLPFcoeffs_b),
+	gyro_z_filt(params.estimator.SoftwareLPFcoeffs_a, params.estimator.SoftwareLPFcoeffs_b),
+	Motor1_LPF(1.0f/params.controller.SampleRate, params.controller.TorqueLPFtau),
+	Motor2_LPF(1.0f/params.controller.SampleRate, params.controller.TorqueLPFtau),
+	Motor3_LPF(1.0f/params.controller.SampleRate, params.controller.TorqueLPFtau),
+	TorqueRampUpGain(0), TorqueRampUpFinished(false)
+{
+	for (int i = 0; i < 4*4; i++) Cov_q[i] = 0;
+	for (int i = 0; i < 2*2; i++) Cov_dxy[i] = 0;
+}
+
+BalanceLoop::~BalanceLoop()
+{
+}
+
+void BalanceLoop::UnitTest(void)
+{
+	if (!lqr.UnitTest()) {
+		ERROR("LQR Unit test failed!");
+	}
+
+	if (!sm.UnitTest()) {
+		ERROR("Sliding Mode Unit test failed!");
+	}
+
+	if (!qEKF.UnitTest()) {
+		ERROR("qEKF Unit test failed!");
+	}
+
+	if (!mEKF.UnitTest()) {
+		ERROR("mEKF Unit test failed!");
+	}
+}
+
+/**
+ * @brief 	Reset the estimators to the current attitude and encoder positions
+ * @param	imuMeas         Input: IMU measurement (not corrected)
+ * @param	EncoderTicks    Input: raw encoder values
+ * @param	EncoderAngle    Input: motor angles
+ */
+void BalanceLoop::Reset(const IMU::Measurement_t& imuMeas, const int32_t EncoderTicks[3], const float EncoderAngle[3])
+{
+	qEKF.Reset(imuMeas.Accelerometer); // reset attitude estimator to current attitude, based on IMU
+	mEKF.Reset(imuMeas.Accelerometer);
+	madgwick.Reset(imuMeas.Accelerometer[0], imuMeas.Accelerometer[1], imuMeas.Accelerometer[2]);
+	velocityEKF.Reset(EncoderTicks);
+	comEKF.Reset();
+	kinematics.Reset(EncoderAngle);
+}
+
+/**
+ * @brief 	Step the attitude estimator with settings that make it converge to the current attitude, eg. after a reset
+ * @param	imuMeas         Input: corrected IMU measurement
+ */
+void BalanceLoop::Stabilize(const IMU::Measurement_t& imuMeas)
+{
+	if (params_.estimator.UseMadgwick) {
+		madgwick.updateIMU(imuMeas.Gyroscope[0], imuMeas.Gyroscope[1], imuMeas.Gyroscope[2], imuMeas.Accelerometer[0], imuMeas.Accelerometer[1], imuMeas.Accelerometer[2], 0.1); // use larger beta to make filter converge to current angle by trusting the accelerometer more
+	} else if (params_.estimator.UseMEKF) {
+		mEKF.Step(imuMeas.Accelerometer, imuMeas.Gyroscope, false); // do not estimate bias while stabilizing the filter
+	} else {
+		qEKF.Step(imuMeas.Accelerometer, imuMeas.Gyroscope, false); // do not estimate bias while stabilizing the filter
+	}
+}
+
+/**
+ * @brief 	Estimate the state from a sample of the sensors
+ * @param	imu             Input: IMU with the calibration used to correct the measurement
+ * @param	imuMeas         Input/Output: IMU measurement, corrected and filtered in place
+ * @param	EncoderTicks    Input: raw encoder values
+ * @param	EncoderAngle    Input: motor angles
+ * @param	q               Output: attitude quaternion
+ * @param	dq              Output: quaternion derivative
+ * @param	dxy             Output: velocity
+ * @param	COM             Input/Output: center of mass, only updated if estimated
+ */
+void BalanceLoop::Estimate(IMU& imu, IMU::Measurement_t& imuMeas, const int32_t EncoderTicks[3], const float EncoderAngle[3], float q[4], float dq[4], float dxy[2], float COM[3])
+{
+    /* Adjust the measurements according to the calibration */
+	imu.CorrectMeasurement(imuMeas);
+
+	if (params_.estimator.EnableSoftwareLPFfilters) {
+		imuMeas.Accelerometer[0] = accel_x_filt.Filter(imuMeas.Accelerometer[0]);
+		imuMeas.Accelerometer[1] = accel_y_filt.Filter(imuMeas.Accelerometer[1]);
+		imuMeas.Accelerometer[2] = accel_z_filt.Filter(imuMeas.Accelerometer[2]);
+		imuMeas.Gyroscope[0] = gyro_x_filt.Filter(imuMeas.Gyroscope[0]);
+		imuMeas.Gyroscope[1] = gyro_y_filt.Filter(imuMeas.Gyroscope[1]);
+		imuMeas.Gyroscope[2] = gyro_z_filt.Filter(imuMeas.Gyroscope[2]);
+	}
+
+	/* Attitude estimation */
+	if (params_.estimator.UseMadgwick) {
+		madgwick.updateIMU(imuMeas.Gyroscope[0], imuMeas.Gyroscope[1], imuMeas.Gyroscope[2], imuMeas.Accelerometer[0], imuMeas.Accelerometer[1], imuMeas.Accelerometer[2]);
+		madgwick.getQuaternion(q);
+		madgwick.getQuaternionDerivative(dq);
+		// Hack for Madgwick quaternion estimate covariance
+        for (int m = 0; m < 4; m++) {
+          for (int n = 0; n < 4; n++) {
+        	  Cov_q[4*m + n] = 0;
+          }
+        }
+        for (int d = 0; d < 4; d++) {
+        	Cov_q[4*d + d] = 3*1E-7; // set q covariance when MADGWICK is used
+        }
+	} else if (params_.estimator.UseMEKF) {
+		mEKF.Step(imuMeas.Accelerometer, imuMeas.Gyroscope, params_.estimator.EstimateBias);
+		mEKF.GetQuaternion(q);
+		mEKF.GetQuaternionDerivative(dq);
+		mEKF.GetQuaternionCovariance(Cov_q);
+	} else { // use QEKF
+		qEKF.Step(imuMeas.Accelerometer, imuMeas.Gyroscope, params_.estimator.EstimateBias);
+		qEKF.GetQuaternion(q);
+		qEKF.GetQuaternionDerivative(dq);
+		qEKF.GetQuaternionCovariance(Cov_q);
+	}
+
+	/* Independent heading requires dq to be decoupled around the yaw/heading axis */
+    if (params_.behavioural.IndependentHeading && !params_.behavioural.YawVelocityBraking && !params_.controller.DisableQdot) {
+      float dq_tmp[4];
+      dq_tmp[0] = dq[0];
+      dq_tmp[1] = dq[1];
+      dq_tmp[2] = dq[2];
+      dq_tmp[3] = dq[3];
+      HeadingIndependentQdot(dq_tmp, q, dq);
+    }
+
+    /* Velocity estimation using kinematics */
+    if (!params_.estimator.UseVelocityEstimator) {
+    	// compute velocity from encoder-based motor velocities and forward kinematics
+    	kinematics.EstimateMotorVelocity(EncoderAngle);
+		if (params_.estimator.Use2Lvelocity) {
+			float dxy_ball[2];
+			kinematics.ForwardKinematics(q, dq, dxy_ball);
+			kinematics.ConvertBallTo2Lvelocity(dxy_ball, q, dq, dxy);            // put 2L velocity into dxy
+		} else {
+			kinematics.ForwardKinematics(q, dq, dxy);       // put ball velocity into dxy
+		}
+    }
+
+    /* Velocity estimation using velocity EKF */
+    if (params_.estimator.UseVelocityEstimator) {
+    	velocityEKF.Step(EncoderTicks, q, Cov_q, dq, COM); // velocity estimator estimates 2L velocity
+    	velocityEKF.GetVelocity(dxy);
+    	velocityEKF.GetVelocityCovariance(Cov_dxy);
+
+    	// OBS. dxy was in the original design supposed to be ball velocity, but the velocity estimator estimates the 2L velocity which gives indirect "stabilization"
+    	// In the Sliding Mode controller this velocity is (only) used to calculated "feedforward" torque to counteract friction
+        if (!params_.estimator.Use2Lvelocity) { // however if the 2L velocity is not desired, it is here converted back to ball velocity
+        	kinematics.Convert2LtoBallVelocity(dxy, q, dq, dxy);
+        }
+    }
+
+    /* Center of Mass estimation */
+    if (params_.estimator.EstimateCOM && params_.estimator.UseVelocityEstimator) { // can only estimate COM if velocity is also estimated (due to need of velocity estimate covariance)
+    	comEKF.Step(dxy, Cov_dxy, q, Cov_q, dq);
+    	comEKF.GetCOM(COM);
+    }
+
+    /* Disable dq to avoid noisy control outputs resulting from noisy dq estimates */
+    if (params_.controller.DisableQdot) { // q_dot removed because it is VERY noisy - this causes oscillations on yaw, if yaw reference is included
+    	dq[0] = 0.0f;
+    	dq[1] = 0.0f;
+    	dq[2] = 0.0f;
+    	dq[3] = 0.0f;
+    }
+}
+
+/**
+ * @brief 	Compute the torque outputs of the selected controller, including saturation, ramp up and filtering
+ * @param	q, dq, xy, dxy                           Input: state estimates
+ * @param	q_ref, omega_ref_body, omega_ref_inertial  Input: references
+ * @param	Torque                                   Output: torque of the three motors
+ * @retval	true if the controller output was NaN, in which case the torque is set to 0
+ */
+bool BalanceLoop::Control(const float q[4], const float dq[4], const float xy[2], const float dxy[2], const float q_ref[4], const float omega_ref_body[3], const float omega_ref_inertial[3], float Torque[3])
+{
+    /* Compute control output based on references */
+    if (params_.controller.type == lspc::ParameterTypes::LQR_CONTROLLER && params_.controller.mode != lspc::ParameterTypes::OFF) {
+    	lqr.Step(q, dq, q_ref, omega_ref_body, Torque);
+	} else if (params_.controller.type == lspc::ParameterTypes::SLIDING_MODE_CONTROLLER && params_.controller.mode != lspc::ParameterTypes::OFF) {
+		// OBS. When running the Sliding Mode controller, inertial angular velocity reference is needed
+		float S[3];
+    	sm.Step(q, dq, xy, dxy, q_ref, omega_ref_inertial, Torque, S);
+	} else {
+		// Undefined controller mode, eg. OFF - set torque output to 0
+		Torque[0] = 0;
+		Torque[1] = 0;
+		Torque[2] = 0;
+	}
+
+    /* Check if any of the torque outputs is NaN - if so, turn off the outputs */
+    bool TorqueNaN = isnan(Torque[0]) || isnan(Torque[1]) || isnan(Torque[2]);
+    if (TorqueNaN) {
+    	Torque[0] = 0;
+    	Torque[1] = 0;
+    	Torque[2] = 0;
+    }
+
+    /* Clamp the torque outputs between configured limits */
+    if (params_.controller.EnableTorqueSaturation) {
+    	Torque[0] = fmax(fmin(Torque[0], params_.controller.TorqueMax), -params_.controller.TorqueMax);
+    	Torque[1] = fmax(fmin(Torque[1], params_.controller.TorqueMax), -params_.controller.TorqueMax);
+    	Torque[2] = fmax(fmin(Torque[2], params_.controller.TorqueMax), -params_.controller.TorqueMax);
+    }
+
+    /* Initial Torque ramp up */
+    if (params_.controller.TorqueRampUp) {
+    	if (params_.controller.mode == lspc::ParameterTypes::OFF) {
+			TorqueRampUpGain = 0;
+			TorqueRampUpFinished = false;
+    	}
+    	else if (!TorqueRampUpFinished) { // if controller is running and ramp up is not finished
+    		Torque[0] *= TorqueRampUpGain;
+    		Torque[1] *= TorqueRampUpGain;
+    		Torque[2] *= TorqueRampUpGain;
+
+    		TorqueRampUpGain += 1.0f / (params_.controller.TorqueRampUpTime * params_.controller.SampleRate); // ramp up rate
+    		if (TorqueRampUpGain >= 1.0) {
+    			TorqueRampUpFinished = true;
+    		}
+    	}
+    }
+
+    /* Torque output LPF filtering */
+    if (params_.controller.EnableTorqueLPF && params_.controller.mode != lspc::ParameterTypes::OFF) {
+		Torque[0] = Motor1_LPF.Filter(Torque[0]);
+		Torque[1] = Motor2_LPF.Filter(Torque[1]);
+		Torque[2] = Motor3_LPF.Filter(Torque[2]);
+    } else {
+    	Motor1_LPF.Reset();
+    	Motor2_LPF.Reset();
+    	Motor3_LPF.Reset();
+    }
+
+    return TorqueNaN;
+}
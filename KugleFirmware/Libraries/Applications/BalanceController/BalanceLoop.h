@@ -0,0 +1,92 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+ 
+
+#ifndef APPLICATION_BALANCELOOP_H
+#define APPLICATION_BALANCELOOP_H
+
+#include "Parameters.h"
+#include "IMU.h"
+#include "Timer.h"
+#include "LQR.h"
+#include "SlidingMode.h"
+#include "QEKF.h"
+#include "MEKF.h"
+#include "MadgwickAHRS.h"
+#include "COMEKF.h"
+#include "VelocityEKF.h"
+#include "Kinematics.h"
+#include "FirstOrderLPF.h"
+#include "IIR.hpp"
+
+/* Estimation and control of a single sample of the balance controller, from the sensor measurements to the torque outputs.
+ * Does not access any hardware or operating system functions, such that the sensor log replay (see Tools/SensorReplay)
+ * runs exactly the same code as the BalanceController thread. The sample time of the estimators is measured with the given timer. */
+class BalanceLoop
+{
+	private:
+		typedef IIR<sizeof(Parameters::estimator_t::SoftwareLPFcoeffs_a)/sizeof(float)-1> SoftwareLPF;
+
+	public:
+		BalanceLoop(Parameters& params, Timer * microsTimer);
+		~BalanceLoop();
+
+		void UnitTest(void);
+		void Reset(const IMU::Measurement_t& imuMeas, const int32_t EncoderTicks[3], const float EncoderAngle[3]);
+		void Stabilize(const IMU::Measurement_t& imuMeas);
+		void Estimate(IMU& imu, IMU::Measurement_t& imuMeas, const int32_t EncoderTicks[3], const float EncoderAngle[3], float q[4], float dq[4], float dxy[2], float COM[3]);
+		bool Control(const float q[4], const float dq[4], const float xy[2], const float dxy[2], const float q_ref[4], const float omega_ref_body[3], const float omega_ref_inertial[3], float Torque[3]);
+
+	private:
+		Parameters& params_;
+
+		/* Controller and estimator objects */
+		LQR lqr;
+		SlidingMode sm;
+		QEKF qEKF;
+		MEKF mEKF;
+		Madgwick madgwick;
+		VelocityEKF velocityEKF;
+		COMEKF comEKF;
+		Kinematics kinematics;
+
+		/* Measurement filters */
+		SoftwareLPF accel_x_filt;
+		SoftwareLPF accel_y_filt;
+		SoftwareLPF accel_z_filt;
+		SoftwareLPF gyro_x_filt;
+		SoftwareLPF gyro_y_filt;
+		SoftwareLPF gyro_z_filt;
+
+		/* Control output filters */
+		FirstOrderLPF Motor1_LPF;
+		FirstOrderLPF Motor2_LPF;
+		FirstOrderLPF Motor3_LPF;
+
+		/* Estimate covariances */
+		float Cov_q[4*4];
+		float Cov_dxy[2*2];
+
+		/* Initial torque ramp up */
+		float TorqueRampUpGain;
+		bool TorqueRampUpFinished;
+};
+	
+	
+#endif
@@ -19,8 +19,10 @@
  
 #include "IMU.h"
 #include "Debug.h"
+#include "Log.h"
 #include "Math.h"
 #include <arm_math.h>
+#include <string.h> // for memcpy
 
 // Class for sensor abstraction, sampling and calibration
 // Should eg. configure MPU-9250 interrupt
@@ -70,6 +72,20 @@ void IMU::LoadCalibrationFromEEPROM(void)
 	ValidateCalibration();
 }
 
+/**
+ * @brief 	Use the calibration from a copy of the IMU calibration section of the EEPROM, eg. a dumped IMU_CALIBRATION block
+ * @param	data     Input: content of the calibration section
+ * @param	size     Input: size of the content in bytes
+ * @retval	true if the size matches the calibration section
+ */
+bool IMU::LoadCalibration(const uint8_t * data, uint32_t size)
+{
+	if (size != sizeof(calibration_)) return false;
+	memcpy(&calibration_, data, size);
+	ValidateCalibration();
+	return true;
+}
+
 void IMU::ValidateCalibration(void)
 {
 	const unsigned int ValidationPrecision = 2; // decimal places checked
@@ -110,31 +126,27 @@ void IMU::ValidateCalibration(void)
 void IMU::Calibrate(bool storeInEEPROM)
 {
 	Measurement_t meas;
-    Debug::print("Calibrating IMU\n");
+    LOG("Calibrating IMU\n");
     osDelay(1000);
 
     float avg_acc[3] = {0.0f, 0.0f, 0.0f};
     int num_samples = 10;
-    Debug::print("Getting "); Debug::printf("%d", num_samples); Debug::print(" accelerometer samples:\n");
+    LOG("Getting %d accelerometer samples:\n", num_samples);
     for (int i = 0; i < num_samples; ++i) {
     	Get(meas);
     	arm_add_f32(meas.Accelerometer, avg_acc, avg_acc, 3);
-    	Debug::printf("%f", meas.Accelerometer[0]); Debug::print("\t");
-    	Debug::printf("%f", meas.Accelerometer[1]); Debug::print("\t");
-    	Debug::printf("%f\n", meas.Accelerometer[2]);
+    	LOG("%f\t%f\t%f\n", meas.Accelerometer[0], meas.Accelerometer[1], meas.Accelerometer[2]);
     	osDelay(100);
     }
     arm_scale_f32(avg_acc, 1.f/num_samples, avg_acc, 3);
 
     float avg_gyro[3] = {0.0f, 0.0f, 0.0f};
     num_samples = 3000;
-    Debug::print("Getting "); Debug::printf("%d", num_samples); Debug::print(" gyro samples:\n");
+    LOG("Getting %d gyro samples:\n", num_samples);
     for (int i = 0; i < num_samples; ++i) {
     	Get(meas);
     	arm_add_f32(meas.Gyroscope, avg_gyro, avg_gyro, 3);
-    	Debug::printf("%f", meas.Gyroscope[0]); Debug::print("\t");
-    	Debug::printf("%f", meas.Gyroscope[1]); Debug::print("\t");
-    	Debug::printf("%f\n", meas.Gyroscope[2]);
+    	LOG("%f\t%f\t%f\n", meas.Gyroscope[0], meas.Gyroscope[1], meas.Gyroscope[2]);
     	osDelay(1);
     }
     arm_scale_f32(avg_gyro, 1.f/num_samples, calibration_.gyro_bias, 3);
@@ -145,38 +157,28 @@ void IMU::Calibrate(bool storeInEEPROM)
     	eeprom_->WriteData(eeprom_->sections.imu_calibration, (uint8_t *)&calibration_, sizeof(calibration_));
     }
 
-    Debug::print("Resulting calibration matrix:\n");
-    Debug::printf("%f", calibration_.imu_calibration_matrix[0]); Debug::print("\t");
-    Debug::printf("%f", calibration_.imu_calibration_matrix[1]); Debug::print("\t");
-    Debug::printf("%f\n", calibration_.imu_calibration_matrix[2]);
-    Debug::printf("%f", calibration_.imu_calibration_matrix[3]); Debug::print("\t");
-    Debug::printf("%f", calibration_.imu_calibration_matrix[4]); Debug::print("\t");
-    Debug::printf("%f\n", calibration_.imu_calibration_matrix[5]);
-    Debug::printf("%f", calibration_.imu_calibration_matrix[6]); Debug::print("\t");
-    Debug::printf("%f", calibration_.imu_calibration_matrix[7]); Debug::print("\t");
-    Debug::printf("%f\n", calibration_.imu_calibration_matrix[8]);
+    LOG("Resulting calibration matrix:\n");
+    LOG("%f\t%f\t%f\n", calibration_.imu_calibration_matrix[0], calibration_.imu_calibration_matrix[1], calibration_.imu_calibration_matrix[2]);
+    LOG("%f\t%f\t%f\n", calibration_.imu_calibration_matrix[3], calibration_.imu_calibration_matrix[4], calibration_.imu_calibration_matrix[5]);
+    LOG("%f\t%f\t%f\n", calibration_.imu_calibration_matrix[6], calibration_.imu_calibration_matrix[7], calibration_.imu_calibration_matrix[8]);
 
     calibration_.calibrated = true; // we have now calibrated, but we need to verify that the calibration is valid
     ValidateCalibration();
     if (!calibration_.calibrated) {
-    	Debug::print("Calibration failed: Could not validate calibration\n\n");
+    	LOG("Calibration failed: Could not validate calibration\n\n");
     	return;
     }
 
-    Debug::print("Testing:\n");
+    LOG("Testing:\n");
     Get(meas);
-    Debug::print("Unadjusted:\n");
-    Debug::print("Acc:\t"); Debug::printf("%f", meas.Accelerometer[0]); Debug::print("\t");
-    Debug::printf("%f", meas.Accelerometer[1]); Debug::print("\t"); Debug::printf("%f", meas.Accelerometer[2]); Debug::print("\n");
-    Debug::print("Gyro:\t"); Debug::printf("%f", meas.Gyroscope[0]); Debug::print("\t");
-    Debug::printf("%f", meas.Gyroscope[1]); Debug::print("\t"); Debug::printf("%f\n", meas.Gyroscope[2]);
+    LOG("Unadjusted:\n");
+    LOG("Acc:\t%f\t%f\t%f\n", meas.Accelerometer[0], meas.Accelerometer[1], meas.Accelerometer[2]);
+    LOG("Gyro:\t%f\t%f\t%f\n", meas.Gyroscope[0], meas.Gyroscope[1], meas.Gyroscope[2]);
     adjustImuMeasurement(meas.Gyroscope[0], meas.Gyroscope[1], meas.Gyroscope[2], meas.Accelerometer[0], meas.Accelerometer[1], meas.Accelerometer[2], calibration_.imu_calibration_matrix, calibration_.gyro_bias);
-    Debug::print("Adjusted:\n");
-    Debug::print("Acc:\t"); Debug::printf("%f", meas.Accelerometer[0]); Debug::print("\t");
-    Debug::printf("%f", meas.Accelerometer[1]); Debug::print("\t"); Debug::printf("%f", meas.Accelerometer[2]); Debug::print("\n");
-    Debug::print("Gyro:\t"); Debug::printf("%f", meas.Gyroscope[0]); Debug::print("\t");
-    Debug::printf("%f", meas.Gyroscope[1]); Debug::print("\t"); Debug::printf("%f\n", meas.Gyroscope[2]);
-    Debug::print("\n");
+    LOG("Adjusted:\n");
+    LOG("Acc:\t%f\t%f\t%f\n", meas.Accelerometer[0], meas.Accelerometer[1], meas.Accelerometer[2]);
+    LOG("Gyro:\t%f\t%f\t%f\n", meas.Gyroscope[0], meas.Gyroscope[1], meas.Gyroscope[2]);
+    LOG("\n");
 }
 
 float IMU::vector_length(const float v[3])
@@ -35,12 +35,13 @@ class IMU
 	public:
 		virtual ~IMU() {};
 
-		virtual uint32_t WaitForNewData(uint32_t xTicksToWait = portMAX_DELAY) { return pdFALSE; };
-		virtual void Get(Measurement_t& measurement) {};
+		virtual uint32_t WaitForNewData(uint32_t /*xTicksToWait*/ = portMAX_DELAY) { return pdFALSE; };
+		virtual void Get(Measurement_t& /*measurement*/) {};
 		void Calibrate(bool storeInEEPROM = true);
 		void CorrectMeasurement(Measurement_t& measurement);
 
 		void AttachEEPROM(EEPROM * eeprom);
+		bool LoadCalibration(const uint8_t * data, uint32_t size);
 
 	private:
 		void LoadCalibrationFromEEPROM(void);
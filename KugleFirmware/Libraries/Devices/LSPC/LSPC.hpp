@@ -4,6 +4,7 @@
 #include "Packet.hpp"
 #include "Serializable.hpp"
 #include "SocketBase.hpp"
+#include "MessageRegistry.hpp"
 #include "Debug.h"
 #include "cmsis_os.h" // for task creation
 #include "USBCDC.h"
@@ -12,30 +13,147 @@
 
 #define LSPC_MAX_ASYNCHRONOUS_PACKAGE_SIZE			100  // bytes
 #define LSPC_MAXIMUM_PACKAGE_LENGTH					250
-#define LSPC_ASYNCHRONOUS_QUEUE_LENGTH				30   // maximum 30 asynchronous packages in queue
+#define LSPC_CONTROL_QUEUE_LENGTH					10   // maximum number of queued asynchronous packages of each priority
+#define LSPC_TELEMETRY_QUEUE_LENGTH					20
+#define LSPC_BULK_QUEUE_LENGTH						30
+#define LSPC_RESERVED_PACKAGES						8    // packages which producers may be filling in place at the same time, besides the queued ones
+#define LSPC_PACKAGE_POOL_SIZE						(LSPC_CONTROL_QUEUE_LENGTH + LSPC_TELEMETRY_QUEUE_LENGTH + LSPC_BULK_QUEUE_LENGTH + LSPC_RESERVED_PACKAGES)
+#define LSPC_CONTROL_TIMEOUT						10   // ms a control package waits for space in a full queue before it is dropped
 #define LSPC_RX_PROCESSING_THREAD_STACK_SIZE		1024
 #define LSPC_TX_TRANSMITTER_THREAD_STACK_SIZE		512
+#define LSPC_MAXIMUM_FRAME_LENGTH					(LSPC_MAXIMUM_PACKAGE_LENGTH + 4) // start byte, type, length and COBS overhead
+#define LSPC_COALESCE_BUFFER_SIZE					1024 // encoded packages are combined into transfers of up to this many bytes
+#define LSPC_COALESCE_TIMEOUT						1    // ms to wait for more packages before a partially filled transfer is sent
 
 namespace lspc
 {
 
 typedef struct LSPC_Async_Package_t {
 	uint8_t type;
-	std::vector<uint8_t> * payloadPtr;
+	uint16_t length; // payload length
+	uint8_t * payload; // buffer of LSPC_MAXIMUM_PACKAGE_LENGTH bytes from the package pool of the socket
 } LSPC_Async_Package_t;
 
+// Priority class of a message type. Each class has its own transmit queue, which are drained in strict priority order,
+// such that acknowledges can not be lost behind a flood of telemetry or debug output.
+// Control packages are furthermore transmitted right away instead of waiting for more packages to fill up the transfer.
+inline TransmitTypes::priority_t TransmitPriority(uint8_t type)
+{
+  switch (type) {
+    case MessageTypesToPC::Test:
+    case MessageTypesToPC::GetParameter:
+    case MessageTypesToPC::SetParameterAck:
+    case MessageTypesToPC::StoreParametersAck:
+    case MessageTypesToPC::GetParameters:
+    case MessageTypesToPC::SetParametersAck:
+    case MessageTypesToPC::TransferInfo:
+    case MessageTypesToPC::TransferAck:
+    case MessageTypesToPC::TelemetryInfo:
+    case MessageTypesToPC::TimeSync:
+    case MessageTypesToPC::CalibrateIMUAck:
+    case MessageTypesToPC::FirmwareUpdateInfo:
+    case MessageTypesToPC::FirmwareUpdateAck:
+    case MessageTypesToPC::BlackBoxInfo:
+      return TransmitTypes::CONTROL;
+    case MessageTypesToPC::SystemInfo:
+    case MessageTypesToPC::StateEstimates:
+    case MessageTypesToPC::ControllerInfo:
+    case MessageTypesToPC::AttitudeControllerInfo:
+    case MessageTypesToPC::VelocityControllerInfo:
+    case MessageTypesToPC::MPCinfo:
+    case MessageTypesToPC::PredictedMPCtrajectory:
+    case MessageTypesToPC::RawSensor_IMU_MPU9250:
+    case MessageTypesToPC::RawSensor_IMU_MTI200:
+    case MessageTypesToPC::RawSensor_Encoders:
+    case MessageTypesToPC::RawSensor_Battery:
+    case MessageTypesToPC::CompactTelemetry:
+    case MessageTypesToPC::SensorSample:
+      return TransmitTypes::TELEMETRY;
+    default:
+      return TransmitTypes::BULK;
+  }
+}
+
+// Package of a bound message type (see MessageRegistry.hpp), which is filled in place in its transmit queue slot.
+// The slot is reserved on construction, and released again if the package is not transmitted.
+//
+//   LSPC::Message<lspc::MessageTypesToPC::CalibrateIMUAck> msgAck(com);
+//   msgAck->acknowledged = true;
+//   msgAck.Transmit();
+template <class SOCKET, MessageTypesToPC::MessageTypesToPC_t Type>
+class OutgoingMessage
+{
+public:
+  typedef typename ToPC<Type>::type type;
+
+  // @param dataLength Number of bytes following the structure, only for messages with data
+  OutgoingMessage(SOCKET& socket, uint16_t dataLength = 0) : socket_(socket), reserved_(false)
+  {
+	  if (dataLength > 0 && !ToPC<Type>::data) return;
+	  reserved_ = socket_.Reserve(Type, sizeof(type) + dataLength, package_);
+  }
+
+  ~OutgoingMessage()
+  {
+	  if (reserved_) socket_.Release(package_);
+  }
+
+  // False if the package would be dropped since the transmit queue is full, in which case it does not have to be filled
+  bool Reserved(void) const { return reserved_; }
+
+  // The structure is zero initialized
+  type * operator->() { return reinterpret_cast<type *>(package_.payload); }
+  type& operator*() { return *operator->(); }
+
+  // Data following the structure
+  uint8_t * Data(void) { return package_.payload + sizeof(type); }
+
+  bool Transmit(void)
+  {
+	  if (!reserved_) return false;
+	  reserved_ = false;
+	  return socket_.Submit(package_);
+  }
+
+private:
+  OutgoingMessage(const OutgoingMessage&);
+  OutgoingMessage& operator=(const OutgoingMessage&);
+
+  SOCKET& socket_;
+  LSPC_Async_Package_t package_;
+  bool reserved_;
+};
+
 template <class COM>
 class Socket : public SocketBase
 {
 public:
-  Socket(COM * com, uint32_t processingTaskPriority, uint32_t transmitterTaskPriority) : com(com), _processingTaskHandle(0), _transmitterTaskHandle(0)
+  Socket(COM * com, uint32_t processingTaskPriority, uint32_t transmitterTaskPriority) : com(com), _processingTaskHandle(0), _transmitterTaskHandle(0), _txBufferIndex(0), _txLength(0), _txRunPriority(TransmitTypes::PRIORITIES)
   {
-		_TXqueue = xQueueCreate( LSPC_ASYNCHRONOUS_QUEUE_LENGTH, sizeof(LSPC_Async_Package_t) );
-		if (_TXqueue == NULL) {
-			ERROR("Could not create asynchronous LSPC TX queue");
+		_TXqueue[TransmitTypes::CONTROL] = xQueueCreate( LSPC_CONTROL_QUEUE_LENGTH, sizeof(LSPC_Async_Package_t) );
+		_TXqueue[TransmitTypes::TELEMETRY] = xQueueCreate( LSPC_TELEMETRY_QUEUE_LENGTH, sizeof(LSPC_Async_Package_t) );
+		_TXqueue[TransmitTypes::BULK] = xQueueCreate( LSPC_BULK_QUEUE_LENGTH, sizeof(LSPC_Async_Package_t) );
+		_TXpending = xSemaphoreCreateCounting( LSPC_CONTROL_QUEUE_LENGTH + LSPC_TELEMETRY_QUEUE_LENGTH + LSPC_BULK_QUEUE_LENGTH, 0 );
+		_TXpool = xQueueCreate( LSPC_PACKAGE_POOL_SIZE, sizeof(uint8_t *) );
+		if (_TXqueue[TransmitTypes::CONTROL] == NULL || _TXqueue[TransmitTypes::TELEMETRY] == NULL || _TXqueue[TransmitTypes::BULK] == NULL || _TXpending == NULL || _TXpool == NULL) {
+			ERROR("Could not create asynchronous LSPC TX queues");
 			return;
 		}
-		vQueueAddToRegistry(_TXqueue, "LSPC TX");
+		vQueueAddToRegistry(_TXqueue[TransmitTypes::CONTROL], "LSPC TX control");
+		vQueueAddToRegistry(_TXqueue[TransmitTypes::TELEMETRY], "LSPC TX telemetry");
+		vQueueAddToRegistry(_TXqueue[TransmitTypes::BULK], "LSPC TX bulk");
+		vQueueAddToRegistry(_TXpending, "LSPC TX pending");
+		vQueueAddToRegistry(_TXpool, "LSPC TX pool");
+
+		for (int i = 0; i < LSPC_PACKAGE_POOL_SIZE; i++) {
+			uint8_t * payload = (uint8_t *)_txPackages[i];
+			xQueueSend(_TXpool, &payload, 0);
+		}
+
+		for (int i = 0; i < TransmitTypes::PRIORITIES; i++) {
+			_txSequence[i] = 0;
+			_txDropped[i] = 0;
+		}
 
 		xTaskCreate(Socket::ProcessingThread, (char *)"LSPC processing", LSPC_RX_PROCESSING_THREAD_STACK_SIZE, (void*) this, processingTaskPriority, &_processingTaskHandle);
 		xTaskCreate(Socket::TransmitterThread, (char *)"LSPC transmitter", LSPC_TX_TRANSMITTER_THREAD_STACK_SIZE, (void*) this, transmitterTaskPriority, &_transmitterTaskHandle);
@@ -83,19 +201,115 @@ private:
 
 
 public:
-  void TransmitAsync(uint8_t type, const uint8_t * payload, uint16_t payloadLength)
+  template <MessageTypesToPC::MessageTypesToPC_t Type>
+  using Message = OutgoingMessage<Socket<COM>, Type>;
+
+  using SocketBase::registerCallback;
+
+  // Register a handler of a bound message type (see MessageRegistry.hpp), which receives the payload as its structure
+  // straight from the receive buffer. Packages with a length different from the structure are discarded.
+  template <MessageTypesFromPC::MessageTypesFromPC_t Type>
+  bool registerCallback(void (*handler)(void * param, const typename FromPC<Type>::type& msg), void * parameter = 0)
+  {
+	  static_assert(!FromPC<Type>::data, "The message has data following the structure, which the handler has to receive");
+	  return registerMessageCallback(Type, handler, parameter);
+  }
+
+  // Register a handler of a bound message type with data following the structure.
+  // Packages shorter than the structure are discarded.
+  template <MessageTypesFromPC::MessageTypesFromPC_t Type>
+  bool registerCallback(void (*handler)(void * param, const typename FromPC<Type>::type& msg, const uint8_t * data, uint16_t length), void * parameter = 0)
+  {
+	  static_assert(FromPC<Type>::data, "The message does not have data following the structure");
+	  return registerMessageCallback(Type, handler, parameter);
+  }
+
+  // Queue a package for transmission with the priority of its type.
+  // Control packages wait up to LSPC_CONTROL_TIMEOUT for space in a full queue, other packages are dropped right away.
+  //
+  // @return True if the package was queued
+  bool TransmitAsync(uint8_t type, const uint8_t * payload, uint16_t payloadLength)
   {
 	  LSPC_Async_Package_t package;
-	  if (payloadLength > LSPC_MAXIMUM_PACKAGE_LENGTH) return; // payload size is too big
-	  if (uxQueueSpacesAvailable(_TXqueue) == 0) return; // no space in queue
+	  if (!Reserve(type, payloadLength, package)) return false;
+	  memcpy(package.payload, payload, payloadLength);
+	  return Submit(package);
+  }
+
+  // Queue a message of a bound message type (see MessageRegistry.hpp). Use Message to fill larger messages in place instead.
+  template <MessageTypesToPC::MessageTypesToPC_t Type>
+  bool TransmitAsync(const typename ToPC<Type>::type& msg)
+  {
+	  return TransmitAsync(Type, (const uint8_t *)&msg, sizeof(msg));
+  }
+
+  // Take a package from the package pool, whose payload is filled in place and queued with Submit (or returned with Release).
+  // Packages which would be dropped right away since their queue is full are not taken.
+  //
+  // @return True if the package was taken, with the payload zero initialized
+  bool Reserve(uint8_t type, uint16_t payloadLength, LSPC_Async_Package_t& package)
+  {
+	  TransmitTypes::priority_t priority = TransmitPriority(type);
+	  if (payloadLength > LSPC_MAXIMUM_PACKAGE_LENGTH) return false; // payload size is too big
+	  if ((priority != TransmitTypes::CONTROL && uxQueueSpacesAvailable(_TXqueue[priority]) == 0) || // no space in queue
+		  xQueueReceive(_TXpool, &package.payload, 0) != pdTRUE) { // every package of the pool is queued or being filled
+		  __atomic_fetch_add(&_txDropped[priority], 1, __ATOMIC_RELAXED);
+		  return false;
+	  }
 
 	  package.type = type;
-	  package.payloadPtr = new std::vector<uint8_t>(payloadLength);
-	  if (!package.payloadPtr) return;
-	  memcpy(package.payloadPtr->data(), payload, payloadLength);
-	  if (xQueueSend(_TXqueue, (void *)&package, (TickType_t) 0) != pdTRUE) {
-		  delete(package.payloadPtr); // could not add package to queue, probably because it is full
+	  package.length = payloadLength;
+	  memset(package.payload, 0, payloadLength);
+	  return true;
+  }
+
+  // Shorten the payload of a package taken with Reserve to the number of bytes filled in,
+  // for packages which are serialized in place before their final length is known
+  void Shrink(LSPC_Async_Package_t& package, uint16_t payloadLength)
+  {
+	  if (payloadLength < package.length)
+		  package.length = payloadLength;
+  }
+
+  // Queue a package taken with Reserve. The package is returned to the pool if it can not be queued.
+  //
+  // @return True if the package was queued
+  bool Submit(LSPC_Async_Package_t& package)
+  {
+	  TransmitTypes::priority_t priority = TransmitPriority(package.type);
+	  TickType_t timeout = (priority == TransmitTypes::CONTROL) ? pdMS_TO_TICKS(LSPC_CONTROL_TIMEOUT) : 0;
+	  if (xQueueSend(_TXqueue[priority], (void *)&package, timeout) != pdTRUE) {
+		  Release(package); // could not add package to queue because it is full
+		  __atomic_fetch_add(&_txDropped[priority], 1, __ATOMIC_RELAXED);
+		  return false;
 	  }
+	  xSemaphoreGive(_TXpending);
+	  return true;
+  }
+
+  // Return a package taken with Reserve which is not going to be transmitted to the pool
+  void Release(const LSPC_Async_Package_t& package)
+  {
+	  xQueueSend(_TXpool, &package.payload, 0);
+  }
+
+  // Number of packages of the pool which are neither queued nor being filled
+  uint32_t GetPoolAvailable(void)
+  {
+	  return uxQueueMessagesWaiting(_TXpool);
+  }
+
+  // Check whether a package of the given type would currently be queued.
+  // Allows producers to skip building packages which would be dropped anyway.
+  bool Accepts(uint8_t type)
+  {
+	  return uxQueueSpacesAvailable(_TXqueue[TransmitPriority(type)]) > 0;
+  }
+
+  // Number of packages of the given priority dropped because the queue was full
+  uint32_t GetDropped(TransmitTypes::priority_t priority)
+  {
+	  return __atomic_load_n(&_txDropped[priority], __ATOMIC_RELAXED);
   }
 
   bool Connected(void)
@@ -109,7 +323,8 @@ private:
   {
   	Socket<COM> * lspc = (Socket<COM> *)pvParameters;
 
-  	lspc->incoming_data.reserve(LSPC_MAXIMUM_PACKAGE_LENGTH);
+  	lspc->incoming_data.reserve(LSPC_MAXIMUM_FRAME_LENGTH);
+  	lspc->incoming_payload.reserve(LSPC_MAXIMUM_PAYLOAD_LENGTH);
 
 	// LSPC incoming data processing loop
 	while (1)
@@ -119,6 +334,9 @@ private:
 	}
   }
 
+  // Packages are coalesced into one transfer until the transfer is full, a latency critical package
+  // is added or LSPC_COALESCE_TIMEOUT has passed since the first package, to avoid a USB transaction
+  // with a partially filled packet for every small package
   static void TransmitterThread(void * pvParameters)
   {
 	  Socket<COM> * lspc = (Socket<COM> *)pvParameters;
@@ -126,39 +344,101 @@ private:
 
 	  while (1)
 	  {
-		  if (lspc->Connected()) {
-			  // LSPC outgoing (transmission) data loop
-			  while (lspc->Connected())
-			  {
-					if ( xQueueReceive( lspc->_TXqueue, &package, ( TickType_t ) portMAX_DELAY ) == pdPASS ) {
-						// Send it if possible
-						Packet * outPacket = new Packet(package.type, *package.payloadPtr);
-						if (!outPacket) continue;
-
-						if (outPacket->encodedDataSize() ==
-								lspc->com->WriteBlocking(outPacket->encodedDataPtr(), outPacket->encodedDataSize())) {
-							delete(package.payloadPtr); // clear memory used for payload data
-						}
-						else { // if not, re-add it to the queue
-							//xQueueSend(lspc->_TXqueue, (void *)&package, (TickType_t) 1); // re-add it to the queue is probably not a good idea
-							delete(package.payloadPtr); // clear memory used for payload data
-						}
-						delete(outPacket);
-					}
+		  // LSPC outgoing (transmission) data loop
+		  while (lspc->Connected())
+		  {
+			  if (!lspc->Receive(package, portMAX_DELAY)) continue;
+
+			  TickType_t start = xTaskGetTickCount();
+			  bool flush = lspc->Coalesce(package);
+			  while (1) {
+				  // Packages which are already queued are always added, since they do not delay the transfer.
+				  // Otherwise every latency critical package would take a transfer of its own under load.
+				  TickType_t timeout = 0;
+				  if (!flush) {
+					  TickType_t elapsed = xTaskGetTickCount() - start;
+					  if (elapsed < pdMS_TO_TICKS(LSPC_COALESCE_TIMEOUT)) timeout = pdMS_TO_TICKS(LSPC_COALESCE_TIMEOUT) - elapsed;
+				  }
+				  if (!lspc->Receive(package, timeout)) break;
+				  flush = lspc->Coalesce(package) || flush;
 			  }
+			  lspc->Flush();
 		  }
 		  osDelay(100);
 	  }
   }
 
+  // Get the next package from the highest priority queue which is not empty
+  bool Receive(LSPC_Async_Package_t& package, TickType_t timeout)
+  {
+	  if (xSemaphoreTake(_TXpending, timeout) != pdTRUE) return false;
+	  for (int i = 0; i < TransmitTypes::PRIORITIES; i++) {
+		  if (xQueueReceive(_TXqueue[i], &package, 0) == pdPASS)
+			  return true;
+	  }
+	  return false;
+  }
+
+  // Encode a package straight into the transfer buffer and return it to the pool.
+  // Every run of packages with the same priority within a transfer starts with a Sequence package,
+  // which lets the PC detect lost packages from the sequence number and dropped counter of each priority.
+  //
+  // @return True if the transfer should be sent now
+  bool Coalesce(const LSPC_Async_Package_t& package)
+  {
+	  TransmitTypes::priority_t priority = TransmitPriority(package.type);
+
+	  size_t sequenceSize = sizeof(TransmitTypes::Sequence_t) + 4; // encoded size
+	  if (_txLength + sequenceSize + package.length + 4 > LSPC_COALESCE_BUFFER_SIZE)
+		  Flush();
+
+	  if (priority != _txRunPriority) {
+		  TransmitTypes::Sequence_t sequence;
+		  sequence.priority = priority;
+		  sequence.reserved = 0;
+		  sequence.sequence = _txSequence[priority];
+		  sequence.dropped = GetDropped(priority);
+		  _txLength += Packet::encode(MessageTypesToPC::Sequence, (const uint8_t *)&sequence, sizeof(sequence), &_txBuffer[_txBufferIndex][_txLength]);
+		  _txRunPriority = priority;
+	  }
+
+	  _txLength += Packet::encode(package.type, package.payload, package.length, &_txBuffer[_txBufferIndex][_txLength]);
+	  Release(package);
+	  _txSequence[priority]++;
+
+	  return (priority == TransmitTypes::CONTROL) || (_txLength > LSPC_COALESCE_BUFFER_SIZE - LSPC_MAXIMUM_FRAME_LENGTH - sequenceSize);
+  }
+
+  // Send the coalesced packages.
+  // The transfer buffer has to stay untouched while it is being transmitted, so two buffers are used in turn.
+  // WriteBlocking waits for the previous transfer to complete before it starts the next one.
+  void Flush(void)
+  {
+	  if (_txLength == 0) return;
+	  com->WriteBlocking(_txBuffer[_txBufferIndex], _txLength); // packages which could not be sent are dropped
+	  _txBufferIndex ^= 1;
+	  _txLength = 0;
+	  _txRunPriority = TransmitTypes::PRIORITIES; // start the next transfer with a Sequence package
+  }
+
 public:
   COM * com;
 
 private:
   TaskHandle_t _processingTaskHandle;
   TaskHandle_t _transmitterTaskHandle;
-  SemaphoreHandle_t _newTransmitDataSemaphore;
-  QueueHandle_t _TXqueue;
+  QueueHandle_t _TXqueue[TransmitTypes::PRIORITIES];
+  SemaphoreHandle_t _TXpending; // counts the packages in all queues
+  QueueHandle_t _TXpool; // payload buffers of the packages which are neither queued nor being filled
+
+  uint64_t _txPackages[LSPC_PACKAGE_POOL_SIZE][(LSPC_MAXIMUM_PACKAGE_LENGTH + 7) / 8]; // aligned like a heap allocation, since the messages are filled in place
+
+  uint8_t _txBuffer[2][LSPC_COALESCE_BUFFER_SIZE];
+  uint8_t _txBufferIndex; // buffer being filled
+  uint16_t _txLength;
+  TransmitTypes::priority_t _txRunPriority; // priority of the packages at the end of the transfer buffer
+  uint16_t _txSequence[TransmitTypes::PRIORITIES]; // sequence number of the next package of each priority
+  uint32_t _txDropped[TransmitTypes::PRIORITIES];
 
 };
 
@@ -0,0 +1,135 @@
+#ifndef LSPC_MESSAGE_REGISTRY_HPP
+#define LSPC_MESSAGE_REGISTRY_HPP
+
+#include "MessageTypes.h"
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#define LSPC_MAXIMUM_PAYLOAD_LENGTH   254   // limit of the COBS encoding
+#define LSPC_PAYLOAD_ALIGNMENT        8     // alignment of the payload buffers, which are allocated on the heap (portBYTE_ALIGNMENT)
+
+namespace lspc
+{
+
+// Compile-time binding of the message type ids to their payload structure.
+//
+// FromPC<MessageTypesFromPC::X>::type and ToPC<MessageTypesToPC::X>::type is the structure of message X, which lets
+// handlers receive the payload as its structure (Socket::registerCallback<X>) and senders fill it in place in the
+// transmit queue (Socket::Message<X>). Message types without a binding, eg. the arrays of TelemetrySettings or the
+// text of Debug, are only available through the untyped interface.
+//
+// The payloads are the natural C layout of the structures, which the PC shares through MessageTypes.h.
+// The size of every structure is pinned, such that a change of the layout (eg. a member which adds padding)
+// is caught at compile time instead of silently breaking the PC side.
+// Messages with 'data' have a variable length: the structure is a header followed by message specific data.
+template <MessageTypesFromPC::MessageTypesFromPC_t Type> struct FromPC; // undefined for message types without a binding
+template <MessageTypesToPC::MessageTypesToPC_t Type> struct ToPC;
+
+#define LSPC_BIND_MESSAGE(direction, id, structure, bytes, hasData) \
+  template <> struct direction<MessageTypes##direction::id> \
+  { \
+    typedef structure type; \
+    static const bool data = hasData; \
+    static_assert(sizeof(structure) == bytes, "The layout of " #id " has changed, which breaks the PC side"); \
+    static_assert(std::is_standard_layout<structure>::value && std::is_trivially_copyable<structure>::value, #id " can not be transferred as raw bytes"); \
+    static_assert(alignof(structure) <= LSPC_PAYLOAD_ALIGNMENT, #id " requires a larger alignment than the payload buffers have"); \
+    static_assert(sizeof(structure) <= LSPC_MAXIMUM_PAYLOAD_LENGTH, #id " does not fit in a package"); \
+  };
+
+#define LSPC_BIND_FROM_PC(id, structure, bytes)        LSPC_BIND_MESSAGE(FromPC, id, structure, bytes, false)
+#define LSPC_BIND_FROM_PC_DATA(id, structure, bytes)   LSPC_BIND_MESSAGE(FromPC, id, structure, bytes, true)
+#define LSPC_BIND_TO_PC(id, structure, bytes)          LSPC_BIND_MESSAGE(ToPC, id, structure, bytes, false)
+#define LSPC_BIND_TO_PC_DATA(id, structure, bytes)     LSPC_BIND_MESSAGE(ToPC, id, structure, bytes, true)
+
+LSPC_BIND_FROM_PC(GetParameter, MessageTypesFromPC::GetParameter_t, 2)
+LSPC_BIND_FROM_PC_DATA(SetParameter, MessageTypesFromPC::SetParameter_t, 4) // followed by the parameter values
+LSPC_BIND_FROM_PC(TransferStart, MessageTypesFromPC::TransferStart_t, 12)
+LSPC_BIND_FROM_PC_DATA(TransferChunk, TransferTypes::Chunk_t, 2) // followed by the chunk data
+LSPC_BIND_FROM_PC(TransferAck, TransferTypes::Ack_t, 12)
+LSPC_BIND_FROM_PC(EstimatorSettings, MessageTypesFromPC::EstimatorSettings_t, 2)
+LSPC_BIND_FROM_PC(ControllerSettings, MessageTypesFromPC::ControllerSettings_t, 2)
+LSPC_BIND_FROM_PC(TimeSync, MessageTypesFromPC::TimeSync_t, 32)
+LSPC_BIND_FROM_PC(YawCorrection, MessageTypesFromPC::YawCorrection_t, 4)
+LSPC_BIND_FROM_PC(PositionCorrection, MessageTypesFromPC::PositionCorrection_t, 8)
+LSPC_BIND_FROM_PC(AttitudeReference, MessageTypesFromPC::AttitudeReference_t, 16)
+LSPC_BIND_FROM_PC(AngularVelocityReference_Body, MessageTypesFromPC::AngularVelocityReference_Body_t, 12)
+LSPC_BIND_FROM_PC(AngularVelocityReference_Inertial, MessageTypesFromPC::AngularVelocityReference_Inertial_t, 12)
+LSPC_BIND_FROM_PC(VelocityReference_Inertial, MessageTypesFromPC::VelocityReference_Inertial_t, 12)
+LSPC_BIND_FROM_PC(VelocityReference_Heading, MessageTypesFromPC::VelocityReference_Heading_t, 12)
+LSPC_BIND_FROM_PC(MPCpathReference, MessageTypesFromPC::MPCpathReference_t, 36)
+LSPC_BIND_FROM_PC(CalibrateIMU, MessageTypesFromPC::CalibrateIMU_t, 4)
+LSPC_BIND_FROM_PC(BlackBoxCommand, MessageTypesFromPC::BlackBoxCommand_t, 1)
+LSPC_BIND_FROM_PC(EnterBootloader, MessageTypesFromPC::EnterBootloader_t, 4)
+LSPC_BIND_FROM_PC(Reboot, MessageTypesFromPC::Reboot_t, 4)
+LSPC_BIND_FROM_PC(FirmwareUpdateStart, MessageTypesFromPC::FirmwareUpdateStart_t, 12)
+LSPC_BIND_FROM_PC_DATA(FirmwareUpdateChunk, TransferTypes::Chunk_t, 2) // followed by the chunk data
+
+LSPC_BIND_TO_PC_DATA(GetParameter, MessageTypesToPC::GetParameter_t, 4) // followed by the parameter values
+LSPC_BIND_TO_PC(SetParameterAck, MessageTypesToPC::SetParameterAck_t, 3)
+LSPC_BIND_TO_PC(StoreParametersAck, MessageTypesToPC::StoreParametersAck_t, 1)
+LSPC_BIND_TO_PC(SetParametersAck, MessageTypesToPC::SetParametersAck_t, 2)
+LSPC_BIND_TO_PC(TransferInfo, MessageTypesToPC::TransferInfo_t, 12)
+LSPC_BIND_TO_PC_DATA(TransferChunk, TransferTypes::Chunk_t, 2) // followed by the chunk data
+LSPC_BIND_TO_PC(TransferAck, TransferTypes::Ack_t, 12)
+LSPC_BIND_TO_PC(Sequence, TransmitTypes::Sequence_t, 8)
+LSPC_BIND_TO_PC(SystemInfo, MessageTypesToPC::SystemInfo_t, 12)
+LSPC_BIND_TO_PC(StateEstimates, MessageTypesToPC::StateEstimates_t, 64)
+LSPC_BIND_TO_PC(ControllerInfo, MessageTypesToPC::ControllerInfo_t, 36)
+LSPC_BIND_TO_PC(AttitudeControllerInfo, MessageTypesToPC::AttitudeControllerInfo_t, 4)
+LSPC_BIND_TO_PC(VelocityControllerInfo, MessageTypesToPC::VelocityControllerInfo_t, 4)
+LSPC_BIND_TO_PC(TimeSync, MessageTypesToPC::TimeSync_t, 64)
+LSPC_BIND_TO_PC(MPCinfo, MessageTypesToPC::MPCinfo_t, 4)
+LSPC_BIND_TO_PC(PredictedMPCtrajectory, MessageTypesToPC::PredictedMPCtrajectory_t, 56)
+LSPC_BIND_TO_PC(RawSensor_IMU_MPU9250, MessageTypesToPC::RawSensor_IMU_MPU9250_t, 148)
+LSPC_BIND_TO_PC(RawSensor_IMU_MTI200, MessageTypesToPC::RawSensor_IMU_MTI200_t, 40)
+LSPC_BIND_TO_PC(RawSensor_Encoders, MessageTypesToPC::RawSensor_Encoders_t, 16)
+LSPC_BIND_TO_PC(RawSensor_Battery, MessageTypesToPC::RawSensor_Battery_t, 28)
+LSPC_BIND_TO_PC_DATA(CompactTelemetry, TelemetryTypes::Compact_t, 4) // followed by the encoded fields
+LSPC_BIND_TO_PC(SensorSample, MessageTypesToPC::SensorSample_t, 136)
+LSPC_BIND_TO_PC(CalibrateIMUAck, MessageTypesToPC::CalibrateIMUAck_t, 1)
+LSPC_BIND_TO_PC_DATA(RunTimeStats, MessageTypesToPC::RunTimeStats_t, 8) // followed by the RunTimeStatsTask_t entries
+LSPC_BIND_TO_PC(TaskInfo, MessageTypesToPC::TaskInfo_t, 21)
+LSPC_BIND_TO_PC(HeapStats, MessageTypesToPC::HeapStats_t, 72)
+LSPC_BIND_TO_PC(BlackBoxInfo, MessageTypesToPC::BlackBoxInfo_t, 20)
+LSPC_BIND_TO_PC(FirmwareUpdateInfo, MessageTypesToPC::FirmwareUpdateInfo_t, 8)
+LSPC_BIND_TO_PC(FirmwareUpdateAck, TransferTypes::Ack_t, 12)
+
+#undef LSPC_BIND_FROM_PC
+#undef LSPC_BIND_FROM_PC_DATA
+#undef LSPC_BIND_TO_PC
+#undef LSPC_BIND_TO_PC_DATA
+#undef LSPC_BIND_MESSAGE
+
+// Typed view of a received payload.
+// The payload is referenced in place in the receive buffer, unless it is not aligned for the structure, in which
+// case it is copied into the view. The receive buffers are allocated on the heap, so this does not happen on the robot.
+template <typename T>
+class MessageView
+{
+public:
+  explicit MessageView(const uint8_t * payload)
+  {
+    if (((uintptr_t)payload % alignof(T)) == 0) {
+      msg_ = reinterpret_cast<const T *>(payload);
+    } else {
+      memcpy(&copy_, payload, sizeof(T));
+      msg_ = &copy_;
+    }
+  }
+
+  const T& operator*() const { return *msg_; }
+  const T * operator->() const { return msg_; }
+
+private:
+  MessageView(const MessageView&); // msg_ may point into the view itself
+  MessageView& operator=(const MessageView&);
+
+  const T * msg_;
+  T copy_;
+};
+
+} // namespace lspc
+
+#endif // LSPC_MESSAGE_REGISTRY_HPP
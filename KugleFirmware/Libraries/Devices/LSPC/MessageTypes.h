@@ -2,6 +2,7 @@
 #define LSPC_MESSAGE_TYPES_HPP
 
 #include <cstdint>
+#include <cstddef>
 
 namespace lspc
 {
@@ -28,7 +29,8 @@ namespace lspc
 		typedef enum: uint8_t
 		{
 			EnableLogOutput = 0x01,
-			EnableRawSensorOutput
+			EnableRawSensorOutput,
+			RunTimeStatsPeriod
 		} debug_t;
 
 		typedef enum: uint8_t
@@ -88,7 +90,10 @@ namespace lspc
 			sigma2_bias,
 			QEKF_P_init_diagonal,
 			VelocityEstimator_P_init_diagonal,
-			COMEstimator_P_init_diagonal
+			COMEstimator_P_init_diagonal,
+			UseJosephForm,
+			UseMEKF,
+			MEKF_P_init_diagonal
 		} estimator_t;
 
 		typedef enum: uint8_t
@@ -142,6 +147,112 @@ namespace lspc
 		} controllerMode_t;
 	}
 
+	namespace TransferTypes {
+		typedef enum: uint8_t {
+			PARAMETERS = 0x01, // complete parameter block (see Parameters::ReadBlock)
+			IMU_CALIBRATION,   // IMU calibration section of the EEPROM
+			BLACKBOX           // frozen black box recording, array of BlackBoxTypes::Record_t with the oldest record first (dump only)
+		} block_t;
+
+		typedef enum: uint8_t {
+			DUMP = 0x01, // from robot to PC
+			RESTORE      // from PC to robot
+		} direction_t;
+
+		typedef enum: uint8_t {
+			IN_PROGRESS = 0x00,
+			COMPLETE,
+			CRC_ERROR,
+			WRITE_ERROR,
+			REJECTED
+		} status_t;
+
+		typedef struct
+		{
+			uint16_t sequence;
+			//uint8_t data[]; // after the sequence number the chunk data follows (LSPC_TRANSFER_CHUNK_SIZE bytes, except for the last chunk)
+		} Chunk_t;
+
+		typedef struct
+		{
+			uint32_t received; // bit i set if chunk base+i has been received
+			uint16_t base; // all chunks before this have been received
+			uint16_t last; // chunk which triggered this acknowledge, or 0xFFFF if none
+			status_t status;
+		} Ack_t;
+	}
+
+	namespace BlackBoxTypes {
+		typedef enum: uint8_t {
+			RECORDING = 0x00,
+			TRIGGERED, // recording the records following the trigger
+			FROZEN,    // recording has stopped, the records are being prepared for the dump
+			READY      // the recording can be dumped with a BLACKBOX block transfer
+		} state_t;
+
+		typedef enum: uint8_t {
+			NO_TRIGGER = 0x00,
+			MANUAL,
+			NAN_TORQUE,
+			TILT_LIMIT
+		} trigger_t;
+
+		typedef enum: uint8_t {
+			INFO = 0x00, // only request the BlackBoxInfo reply
+			TRIGGER,     // manual trigger
+			ARM          // discard the recording and start recording again
+		} command_t;
+
+		typedef struct
+		{
+			uint32_t time; // microseconds
+			uint8_t mode; // ParameterTypes::controllerMode_t
+			uint8_t flags; // bit 0: torque output was NaN
+			uint16_t reserved;
+			float accelerometer[3];
+			float gyroscope[3];
+			float q[4];
+			float dq[4];
+			float xy[2];
+			float dxy[2];
+			float COM[3];
+			float torque[3];
+			float delivered_torque[3];
+			float compute_time;
+		} Record_t;
+	}
+
+	namespace TransmitTypes {
+		typedef enum: uint8_t {
+			CONTROL = 0x00, // acknowledges and replies to requests
+			TELEMETRY,      // periodic state and sensor messages
+			BULK,           // debug output, dumps and statistics
+			PRIORITIES
+		} priority_t;
+
+		typedef struct
+		{
+			priority_t priority;
+			uint8_t reserved;
+			uint16_t sequence; // sequence number of the following package, counted separately for each priority
+			uint32_t dropped; // packages of this priority dropped since boot because the transmit queue was full
+		} Sequence_t;
+	}
+
+	namespace TelemetryTypes {
+		typedef enum: uint8_t {
+			FULL = 0x00, // the message structure with full precision floats
+			COMPACT      // quantized and delta encoded CompactTelemetry package, see Compact_t (falls back to FULL for messages without a field table)
+		} format_t;
+
+		typedef struct
+		{
+			uint8_t type; // MessageTypesToPC::MessageTypesToPC_t of the periodic message
+			format_t format;
+			uint16_t prescaler; // transmit every prescaler'th sample, 0 unsubscribes the message
+		} Stream_t;
+	}
+
 	namespace MessageTypesFromPC
 	{
 		typedef enum MessageTypesFromPC: uint8_t
@@ -151,9 +262,16 @@ namespace lspc
 			SetParameter = 0x03,
 			StoreParameters = 0x04,
 			DumpParameters = 0x05,
+			GetParameters = 0x06,
+			SetParameters = 0x07,
+			TransferStart = 0x08,
+			TransferChunk = 0x09, // TransferTypes::Chunk_t (restore)
+			TransferAck = 0x0A, // TransferTypes::Ack_t (dump)
 			SystemSettings = 0x10,
 			EstimatorSettings = 0x11,
 			ControllerSettings = 0x12,
+			TelemetrySettings = 0x13, // array of TelemetryTypes::Stream_t, an empty payload only requests the TelemetryInfo reply
+			TimeSync = 0x14, // clock synchronization request, answered with TimeSync
 			YawCorrection = 0x20,
 			PositionCorrection = 0x21,
 			AttitudeReference = 0x30,
@@ -164,8 +282,12 @@ namespace lspc
 			MPCpathReference = 0x35,
             CalibrateIMU = 0xE0,
             CPUload = 0xE1,
+            HeapStats = 0xE2, // request heap statistics, no payload
+            BlackBoxCommand = 0xE3,
             EnterBootloader = 0xF0,
             Reboot = 0xF1,
+            FirmwareUpdateStart = 0xF2,
+            FirmwareUpdateChunk = 0xF3, // TransferTypes::Chunk_t
             Debug = 0xFF
 		} MessageTypesFromPC_t;
 
@@ -184,11 +306,40 @@ namespace lspc
             //void * valuePtr;  // after arraySize the parameter values are inserted in little-endian format with value[0] first (if array)
         } SetParameter_t;
 
+        // GetParameters: payload is an array of GetParameter_t, one per requested parameter
+        // SetParameters: payload is a sequence of SetParameter_t, each followed by its parameter values. Either all or none of the parameters are set
+
+        typedef struct
+        {
+        	TransferTypes::block_t block;
+        	TransferTypes::direction_t direction;
+        	uint32_t size; // block size in bytes (restore only)
+        	uint32_t crc; // CRC32 of the block (restore only)
+        } TransferStart_t;
+
+        typedef struct
+        {
+        	BlackBoxTypes::command_t command;
+        } BlackBoxCommand_t;
+
         typedef struct
         {
             uint16_t estimate_msg_prescaler;
         } EstimatorSettings_t;
 
+        /* Clock synchronization exchange with four time stamps, see TimeSync.h.
+         * The PC sends the request at t1 and receives the reply at t4 (PC clock), the robot receives the request at t2
+         * and sends the reply at t3 (robot clock). Since the reply arrives after the request has been sent, t4 of an exchange
+         * is delivered to the robot with the next request. */
+        typedef struct
+        {
+        	uint64_t t1; // transmit time of this request in microseconds since the UNIX epoch
+        	uint64_t previous_t4; // reception time of the reply to the previous request (sequence - 1), 0 if it was not received
+        	uint64_t epoch; // PC time which corresponds to zero of the telemetry time stamps, in microseconds since the UNIX epoch
+        	uint32_t sequence;
+        	uint32_t reserved;
+        } TimeSync_t;
+
         typedef struct
         {
         	ParameterTypes::controllerMode_t mode;
@@ -278,6 +429,13 @@ namespace lspc
         {
             uint32_t magic_key;
         } Reboot_t;
+
+        typedef struct
+        {
+            uint32_t magic_key;
+            uint32_t size; // image size in bytes
+            uint32_t crc; // CRC32 of the image
+        } FirmwareUpdateStart_t;
 	}
 
 	namespace MessageTypesToPC
@@ -289,20 +447,37 @@ namespace lspc
 			SetParameterAck = 0x03,
             StoreParametersAck = 0x04,
             DumpParameters = 0x05,
+            GetParameters = 0x06,
+            SetParametersAck = 0x07,
+            TransferInfo = 0x08,
+            TransferChunk = 0x09, // TransferTypes::Chunk_t (dump)
+            TransferAck = 0x0A, // TransferTypes::Ack_t (restore)
+            Sequence = 0x0B, // TransmitTypes::Sequence_t, sent in front of every run of packages with the same priority within a transfer
 			SystemInfo = 0x10,
 			StateEstimates = 0x11,
 			ControllerInfo = 0x12,
 			AttitudeControllerInfo = 0x13,
             VelocityControllerInfo = 0x14,
+            TelemetryInfo = 0x15, // array of TelemetryTypes::Stream_t with the settings of all telemetry messages
+            TimeSync = 0x16, // reply to a clock synchronization request
             MPCinfo = 0x20,
             PredictedMPCtrajectory = 0x21,
             RawSensor_IMU_MPU9250 = 0x30,
             RawSensor_IMU_MTI200 = 0x31,
             RawSensor_Encoders = 0x32,
             RawSensor_Battery = 0x33,
+            CompactTelemetry = 0x34, // TelemetryTypes::Compact_t header followed by the encoded fields
+            SensorSample = 0x35, // all inputs of a balance controller sample, for logging and replay (see SensorLog.hpp)
             CalibrateIMUAck = 0xE0,
-			CPUload = 0xE1,
-			MathDump = 0xFA, // publish array of floats (parsed by PC and dumped into tabulated .txt file in "~/kugle_dump/")
+			RunTimeStats = 0xE1, // RunTimeStats_t followed by RunTimeStatsTask_t for each task
+			TaskInfo = 0xE2,
+			HeapStats = 0xE3,
+			HeapTaskStats = 0xE4, // array of HeapTaskStats_t
+			BlackBoxInfo = 0xE5, // sent in reply to BlackBoxCommand and when a recording becomes ready
+			FirmwareUpdateInfo = 0xF2,
+			FirmwareUpdateAck = 0xF3, // TransferTypes::Ack_t
+			MathDump = 0xFA, // publish array of floats (stored by the PC in the MathDump_<n> table of the capture, see Tools/LSPCClient)
+			DebugLog = 0xFE, // uint32_t number of dropped records followed by binary log records, see Log.h
 			Debug = 0xFF
 		} MessageTypesToPC_t;
 
@@ -322,6 +497,15 @@ namespace lspc
             bool acknowledged;
         } SetParameterAck_t;
 
+        // GetParameters: payload is a sequence of GetParameter_t, each followed by its parameter values, in the order requested
+        // Unknown parameters are returned with valueType = _unknown and arraySize = 0. A response which does not fit in a single package is split across several packages
+
+        typedef struct
+        {
+            uint8_t count; // number of parameters in the request
+            bool acknowledged; // true if all parameters were set, false if none were set
+        } SetParametersAck_t;
+
         typedef struct
         {
             bool acknowledged;
@@ -333,6 +517,98 @@ namespace lspc
             uint8_t packages_to_follow;
         } DumpParameters_t;
 
+        typedef struct
+        {
+        	TransferTypes::block_t block;
+        	TransferTypes::direction_t direction;
+        	TransferTypes::status_t status; // IN_PROGRESS if the transfer has been started, REJECTED otherwise
+        	uint32_t size; // block size in bytes
+        	uint32_t crc; // CRC32 of the block (dump only)
+        } TransferInfo_t;
+
+        typedef struct
+        {
+        	uint64_t t1; // copied from the request
+        	uint64_t t2; // reception time of the request in microseconds since boot (robot clock)
+        	uint64_t t3; // transmit time of this reply in microseconds since boot (robot clock)
+        	uint64_t epoch; // epoch of the telemetry time stamps, copied from the request
+        	int64_t offset; // estimated PC time minus robot time at t3, in microseconds
+        	float drift; // estimated rate of the PC clock relative to the robot clock minus one, in ppm
+        	float offset_std; // standard deviation of the offset estimate in microseconds
+        	float delay; // round trip delay of the previous exchange in microseconds
+        	uint32_t sequence; // copied from the request
+        	uint8_t synchronized; // 1 if the telemetry is time stamped in the synchronized time base
+        	uint8_t reserved[7];
+        } TimeSync_t;
+
+        typedef struct
+        {
+        	BlackBoxTypes::state_t state;
+        	BlackBoxTypes::trigger_t trigger;
+        	uint16_t recordSize; // sizeof(BlackBoxTypes::Record_t)
+        	uint32_t records; // number of records in the recording
+        	uint32_t triggerRecord; // index of the record at which the trigger occurred (READY only)
+        	uint32_t recordCycles; // CPU cycles spent by the latest call to BlackBox::Record
+        	uint32_t maxRecordCycles; // since the recorder was armed
+        } BlackBoxInfo_t;
+
+        typedef struct
+        {
+        	uint32_t total_run_time; // run time counter ticks elapsed since the previous message
+        	uint8_t tasks; // number of RunTimeStatsTask_t entries following this header
+        	uint8_t total_tasks; // number of tasks in the system, which can exceed the entries fitting into one package
+        } RunTimeStats_t;
+
+        typedef struct
+        {
+        	uint32_t run_time; // run time counter ticks spent in the task since the previous message
+        	uint16_t stack_high_water_mark; // minimum amount of free stack space since the task was started [words]
+        	uint8_t task_number; // unique task number, see TaskInfo_t for the name
+        	uint8_t state; // eTaskState: 0=running, 1=ready, 2=blocked, 3=suspended, 4=deleted
+        	uint8_t priority;
+        	uint8_t base_priority; // priority before priority inheritance
+        } RunTimeStatsTask_t;
+
+        typedef struct
+        {
+        	uint8_t task_number;
+        	char name[20]; // zero terminated, configMAX_TASK_NAME_LEN
+        } TaskInfo_t;
+
+        typedef struct
+        {
+        	uint32_t free_bytes;
+        	uint32_t minimum_ever_free_bytes;
+        	uint32_t free_blocks;
+        	uint32_t largest_free_block;
+        	uint16_t free_block_histogram[16]; // number of free blocks of 16*2^i to 16*2^(i+1)-1 bytes, the last bin holds all larger blocks
+        	uint32_t allocations;
+        	uint32_t frees;
+        	uint32_t failed_allocations;
+        	uint32_t current_bytes; // allocated heap bytes including block headers
+        	uint32_t peak_bytes;
+        	uint8_t tasks; // number of HeapTaskStats_t entries following in HeapTaskStats packages
+        } HeapStats_t;
+
+        typedef struct
+        {
+        	uint32_t allocations;
+        	uint32_t frees; // frees are counted for the task calling free
+        	uint32_t failed_allocations;
+        	uint32_t allocated_bytes;
+        	uint32_t freed_bytes;
+        	uint32_t peak_bytes;
+        	char name[20];
+        } HeapTaskStats_t;
+
+        typedef struct
+        {
+        	TransferTypes::status_t status; // IN_PROGRESS while the inactive bank is erased and the image is received, REJECTED or WRITE_ERROR (erase failed) otherwise
+        	uint8_t erased_sectors; // sectors of the inactive bank erased so far, reported after every sector; the image can be sent once all are erased
+        	uint8_t sectors; // sectors covered by the image (in the former padding, so the layout of status and max_size is unchanged)
+        	uint32_t max_size; // maximum image size in bytes
+        } FirmwareUpdateInfo_t;
+
         typedef struct
         {
             float time;
@@ -502,12 +778,129 @@ namespace lspc
             float pct2;
         } RawSensor_Battery_t;
 
+        /* Sensor measurements and references used by a sample of the balance controller, before any correction or filtering,
+         * such that the estimators and controllers can be replayed on a host (see BalanceLoop) */
+        typedef struct
+        {
+            uint32_t sample; // sample number since the balance controller was started, to detect dropped packages
+            uint32_t timer; // microseconds timer at the time of the sample
+            float accelerometer[3]; // uncalibrated
+            float gyroscope[3]; // uncalibrated
+            int32_t encoderTicks[3];
+            float encoderAngle[3];
+            float xy[2];
+            float q_ref[4];
+            float omega_ref_body[3];
+            float omega_ref_inertial[3];
+            ParameterTypes::controllerType_t type;
+            ParameterTypes::controllerMode_t mode;
+            uint8_t reserved[2];
+            float q[4]; // attitude estimate of the firmware, to compare the replay with
+            float torque[3]; // torque output of the firmware before the motor drivers
+        } SensorSample_t;
+
         typedef struct
         {
             bool acknowledged;
         } CalibrateIMUAck_t;
     }
 
+	namespace TelemetryTypes {
+		/* Compact telemetry format.
+		 * Every field of the message structure is quantized to an integer with the resolution given in the field table of the message type,
+		 * and the integer (key frame) or the difference to the integer of the previous frame of the same stream (delta frame)
+		 * is zigzag encoded and sent as a little endian base 128 varint, i.e. 7 bits per byte with the top bit set on all but the last byte.
+		 * Integer differences wrap around at 32 bits.
+		 * WRAPPING fields (time stamps and accumulated angles) are quantized modulo 2^32 and unwrapped by the PC relative to the previous frame,
+		 * so they never saturate. A message with a FLOAT value outside the 32 bit range or not a number is sent in the full format instead.
+		 * CONSTANT fields are left out, except in frames with the COMPACT_CONSTANTS flag where they all precede the other fields as raw floats.
+		 * They are sent in the first frame after a stream is (re)configured or the connection is established, and again whenever they change.
+		 * The frame number increments by one for every frame of the stream, so a delta frame can only be decoded if the previous frame was received,
+		 * otherwise the PC has to wait for the next key frame (sent at least every TELEMETRY_KEY_FRAME_INTERVAL frames).
+		 * The COMPACT_SYNCHRONIZED flag gives the time base of the time field of each frame (see TimeSync.h), and a change of the time base starts a key frame. */
+		typedef enum: uint8_t {
+			COMPACT_KEY_FRAME = 0x01,
+			COMPACT_CONSTANTS = 0x02,
+			COMPACT_SYNCHRONIZED = 0x04 // the time is in seconds since the epoch given by the PC, otherwise in seconds since boot
+		} compactFlags_t;
+
+		typedef struct
+		{
+			uint8_t type; // MessageTypesToPC::MessageTypesToPC_t of the encoded message
+			uint8_t flags; // compactFlags_t
+			uint16_t frame;
+		} Compact_t;
+
+		typedef enum: uint8_t {
+			FIELD_FLOAT = 0x00,
+			FIELD_UINT8,
+			FIELD_CONSTANT, // float which is sent once per session
+			FIELD_WRAPPING // float which is quantized modulo 2^32, for values which grow without bound
+		} fieldKind_t;
+
+		typedef struct
+		{
+			uint8_t offset; // byte offset of the first value in the message structure
+			uint8_t count; // number of consecutive values of the same kind
+			fieldKind_t kind;
+			float resolution; // value of one quantization step of FIELD_FLOAT and FIELD_WRAPPING values
+		} CompactField_t;
+
+		static const CompactField_t StateEstimatesFields[] = {
+			{ offsetof(MessageTypesToPC::StateEstimates_t, time), 1, FIELD_WRAPPING, 1e-5f },
+			{ offsetof(MessageTypesToPC::StateEstimates_t, q), 4, FIELD_FLOAT, 1e-5f },
+			{ offsetof(MessageTypesToPC::StateEstimates_t, dq), 4, FIELD_FLOAT, 1e-4f },
+			{ offsetof(MessageTypesToPC::StateEstimates_t, pos), 2, FIELD_FLOAT, 1e-4f }, // 0.1 mm
+			{ offsetof(MessageTypesToPC::StateEstimates_t, vel), 2, FIELD_FLOAT, 1e-4f },
+			{ offsetof(MessageTypesToPC::StateEstimates_t, COM), 3, FIELD_FLOAT, 1e-4f }
+		};
+
+		static const CompactField_t ControllerInfoFields[] = {
+			{ offsetof(MessageTypesToPC::ControllerInfo_t, time), 1, FIELD_WRAPPING, 1e-5f },
+			{ offsetof(MessageTypesToPC::ControllerInfo_t, type), 2, FIELD_UINT8, 1 }, // type and mode
+			{ offsetof(MessageTypesToPC::ControllerInfo_t, torque1), 3, FIELD_FLOAT, 1e-4f },
+			{ offsetof(MessageTypesToPC::ControllerInfo_t, compute_time), 1, FIELD_FLOAT, 1e-6f },
+			{ offsetof(MessageTypesToPC::ControllerInfo_t, delivered_torque1), 3, FIELD_FLOAT, 1e-4f }
+		};
+
+		static const CompactField_t RawSensor_IMU_MPU9250Fields[] = {
+			{ offsetof(MessageTypesToPC::RawSensor_IMU_MPU9250_t, time), 1, FIELD_WRAPPING, 1e-5f },
+			{ offsetof(MessageTypesToPC::RawSensor_IMU_MPU9250_t, accelerometer.x), 3, FIELD_FLOAT, 1e-3f }, // below the 1.2e-3 m/s^2 sensor resolution at 4 g range
+			{ offsetof(MessageTypesToPC::RawSensor_IMU_MPU9250_t, accelerometer.cov), 9, FIELD_CONSTANT, 0 },
+			{ offsetof(MessageTypesToPC::RawSensor_IMU_MPU9250_t, gyroscope.x), 3, FIELD_FLOAT, 1e-4f }, // below the 2.7e-4 rad/s sensor resolution at 500 deg/s range
+			{ offsetof(MessageTypesToPC::RawSensor_IMU_MPU9250_t, gyroscope.cov), 9, FIELD_CONSTANT, 0 },
+			{ offsetof(MessageTypesToPC::RawSensor_IMU_MPU9250_t, magnetometer.x), 3, FIELD_FLOAT, 1e-3f },
+			{ offsetof(MessageTypesToPC::RawSensor_IMU_MPU9250_t, magnetometer.cov), 9, FIELD_CONSTANT, 0 }
+		};
+
+		static const CompactField_t RawSensor_EncodersFields[] = {
+			{ offsetof(MessageTypesToPC::RawSensor_Encoders_t, time), 1, FIELD_WRAPPING, 1e-5f },
+			{ offsetof(MessageTypesToPC::RawSensor_Encoders_t, angle1), 3, FIELD_WRAPPING, 1e-5f }
+		};
+
+		// Field table of the message types which can be sent in the compact format, or 0 if the message type does not have one
+		inline const CompactField_t * GetCompactFields(uint8_t type, uint8_t& count)
+		{
+			switch (type) {
+				case MessageTypesToPC::StateEstimates:
+					count = sizeof(StateEstimatesFields) / sizeof(CompactField_t);
+					return StateEstimatesFields;
+				case MessageTypesToPC::ControllerInfo:
+					count = sizeof(ControllerInfoFields) / sizeof(CompactField_t);
+					return ControllerInfoFields;
+				case MessageTypesToPC::RawSensor_IMU_MPU9250:
+					count = sizeof(RawSensor_IMU_MPU9250Fields) / sizeof(CompactField_t);
+					return RawSensor_IMU_MPU9250Fields;
+				case MessageTypesToPC::RawSensor_Encoders:
+					count = sizeof(RawSensor_EncodersFields) / sizeof(CompactField_t);
+					return RawSensor_EncodersFields;
+				default:
+					count = 0;
+					return 0;
+			}
+		}
+	}
+
 } // namespace lspc
 
 #endif // LSPC_MESSAGE_TYPES_HPP
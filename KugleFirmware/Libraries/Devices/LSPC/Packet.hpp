@@ -22,48 +22,52 @@ class Packet
   // Encode the payload with COBS
   //
   // @param input A buffer with the raw unencoded data.
-  //
-  // @return True if encoding succeeded, false if if the input is more than 254
-  // bytes.
-  void encodePayload(const std::vector<uint8_t> &input)
+  // @param length The number of bytes in input, at most 254.
+  // @param output The encoded buffer, which is written from the byte after the start byte, type and length.
+  static void encodePayload(const uint8_t * input, size_t length, uint8_t * output)
   {
     size_t output_offset = 3;
     size_t code_idx = output_offset;
     uint8_t code = 1;
 
-    for (size_t b = 0; b < input.size(); ++b, ++code)
+    for (size_t b = 0; b < length; ++b, ++code)
     {
       if (0x00 == input[b])
       {
-        encoded_buffer_[code_idx] = code;
+        output[code_idx] = code;
         code_idx = b + 1 + output_offset;
         code = 0;
       }
       else
       {
-        encoded_buffer_[b + 1 + output_offset] = input[b];
+        output[b + 1 + output_offset] = input[b];
       }
     }
-    encoded_buffer_[code_idx] = code;
+    output[code_idx] = code;
 
     return;
   };
 
   // Decode a downstream buffer with COBS.
   //
-  // @param input COBS encoded byte-string.
+  // @param encoded A complete encoded package, including the start byte, type and length.
   // @param output A decoded buffer of (input_size - 1) bytes, because the
   // decoder removes one byte of overhead.
   //
   // @return True if decoding succeded, false if the input is zero-size or
   // wrongly encoded.
-  bool decodePayload(std::vector<uint8_t> &output)
+  static bool decodePayload(const std::vector<uint8_t> &encoded, std::vector<uint8_t> &output)
   {
-    size_t dec_payload_size = encoded_buffer_.size() - 4;
+    if (encoded.size() < 4)
+    {
+      return false;
+    }
+
+    size_t dec_payload_size = encoded.size() - 4;
     output.resize(dec_payload_size);
 
     size_t in_index = 3; // the byte after start byte, type and length
-    uint8_t code = encoded_buffer_[in_index];
+    uint8_t code = encoded[in_index];
     size_t code_accumulator = code;
     ++in_index;
 
@@ -73,12 +77,12 @@ class Packet
     {
       for (int i = 1; i < code && out_index < dec_payload_size; ++i, ++out_index, ++in_index)
       {
-        output[out_index] = encoded_buffer_[in_index];
+        output[out_index] = encoded[in_index];
       }
       if (out_index >= dec_payload_size)
         break;
       output[out_index] = 0x00;
-      code = encoded_buffer_[in_index];
+      code = encoded[in_index];
       code_accumulator += code;
     };
 
@@ -130,7 +134,7 @@ class Packet
       #endif
     }
 
-    if (! decodePayload(decoded_payload_))
+    if (! decodePayload(encoded_buffer_, decoded_payload_))
     {
       degenerate_ = true;
       #ifdef __EXCEPTIONS
@@ -178,7 +182,40 @@ class Packet
     }
 
     // Encode the payload
-    encodePayload(payload);
+    encodePayload(payload.data(), payload.size(), encoded_buffer_.data());
+  }
+
+  // Encode a package straight into a transmit buffer, without the intermediate buffers of a Packet object
+  //
+  // @param type The message type, 0x01-0xFF.
+  // @param payload The serialized payload.
+  // @param length The payload length, at most 254 bytes.
+  // @param output A buffer of at least length + 4 bytes.
+  //
+  // @return The encoded size, or 0 if the type or length is invalid.
+  static size_t encode(uint8_t type, const uint8_t * payload, size_t length, uint8_t * output)
+  {
+    if (type == 0x00 || length > 254)
+      return 0;
+
+    output[0] = 0x00;
+    output[1] = type;
+    output[2] = length + 1;
+    encodePayload(payload, length, output);
+    return length + 4;
+  }
+
+  // Decode a received package straight into a payload buffer, which is reused for every package
+  //
+  // @param encoded A complete encoded package, including the start byte, type and length.
+  // @param payload The decoded payload.
+  //
+  // @return True if decoding succeeded.
+  static bool decode(const std::vector<uint8_t> &encoded, std::vector<uint8_t> &payload)
+  {
+    if (encoded.size() < 4 || encoded.size() > 258 || encoded[1] == 0x00 || encoded.size() != size_t(encoded[2] + 3))
+      return false;
+    return decodePayload(encoded, payload);
   }
 
   uint8_t* encodedDataPtr()
@@ -206,7 +243,7 @@ class Packet
     return degenerate_;
   }
 
-  std::vector<uint8_t> payload()
+  const std::vector<uint8_t>& payload()
   {
     return decoded_payload_;
   }
@@ -3,6 +3,7 @@
 
 #include "Packet.hpp"
 #include "Serializable.hpp"
+#include "MessageRegistry.hpp"
 
 #include <algorithm>
 #include <array>
@@ -27,12 +28,15 @@ class SocketBase
   typedef struct callback_t {
 	  void (*handler)(void * param, const std::vector<uint8_t>&);
 	  void * param;
+	  void (*dispatch)(const struct callback_t& callback, const std::vector<uint8_t>& payload); // set for typed handlers, which are stored in typedHandler
+	  void (*typedHandler)(void);
   } callback_t;
   std::map<uint8_t, callback_t> type_handlers;
 
 public:
   // Made public such that it can be initialized (reserve memory) during construction
   std::vector<uint8_t> incoming_data;
+  std::vector<uint8_t> incoming_payload; // decoded payload of the latest package, handed to the handlers without copying
 
 protected:
   void processIncomingByte(uint8_t incoming_byte)
@@ -42,6 +46,7 @@ protected:
       case LookingFor::header:
         if (incoming_byte == 0x00)
         {
+          incoming_data.clear(); // a previous package may have been left behind if decoding it threw an exception
           incoming_data.push_back(incoming_byte);
           fsr_state = LookingFor::type;
         }
@@ -54,26 +59,48 @@ protected:
         }
         break;
       case LookingFor::length:
+        if (incoming_byte == 0x00)
+        {
+          // The length includes the COBS overhead byte, so a zero can only be the header of the next package
+          incoming_data.clear();
+          incoming_data.push_back(incoming_byte);
+          fsr_state = LookingFor::type;
+          break;
+        }
         incoming_length = incoming_byte;
         incoming_data.push_back(incoming_byte);
         fsr_state = LookingFor::data;
         break;
       case LookingFor::data:
+        if (incoming_byte == 0x00)
+        {
+          // COBS encoded data does not contain zeros, so bytes of the current package have been lost
+          // and a new package starts. Resynchronize on it instead of swallowing its header.
+          incoming_data.clear();
+          incoming_data.push_back(incoming_byte);
+          fsr_state = LookingFor::type;
+          break;
+        }
+
         // Record the data
         incoming_data.push_back(incoming_byte);
 
         // If we got it all, decode it and invoke the handler
         if (size_t(incoming_length + 3) == incoming_data.size())
         {
-          Packet inPacket(incoming_data);
-          auto handler_it = type_handlers.find(inPacket.packetType());
-          if (handler_it != type_handlers.end())
+          fsr_state = LookingFor::header;
+          auto handler_it = type_handlers.find(incoming_data[1]);
+          if (handler_it != type_handlers.end() && Packet::decode(incoming_data, incoming_payload))
           {
-            handler_it->second.handler(handler_it->second.param, inPacket.payload());
+            const callback_t& callback = handler_it->second;
+            if (callback.dispatch)
+              callback.dispatch(callback, incoming_payload);
+            else
+              callback.handler(callback.param, incoming_payload);
           }
           else
           {
-            // We didn't find the handler.
+            // We didn't find the handler, or the package is malformed.
           }
           // Reset to receive the next.
           fsr_state = LookingFor::header;
@@ -130,12 +157,57 @@ public:
     callback_t callback;
     callback.handler = handler;
     callback.param = parameter;
+    callback.dispatch = 0;
+    callback.typedHandler = 0;
 
     type_handlers[type] = callback;
 
     return true;
   }
 
+protected:
+  // Register a handler which receives the payload as the structure T (see MessageRegistry.hpp).
+  // Packages with a length different from the structure are discarded.
+  template <typename T>
+  bool registerMessageCallback(uint8_t type, void (*handler)(void * param, const T& msg), void * parameter)
+  {
+    if (!registerCallback(type, 0, parameter))
+      return false;
+    type_handlers[type].dispatch = &dispatchMessage<T>;
+    type_handlers[type].typedHandler = reinterpret_cast<void (*)(void)>(handler);
+    return true;
+  }
+
+  // Register a handler which receives the payload as the structure T followed by message specific data.
+  // Packages shorter than the structure are discarded.
+  template <typename T>
+  bool registerMessageCallback(uint8_t type, void (*handler)(void * param, const T& msg, const uint8_t * data, uint16_t length), void * parameter)
+  {
+    if (!registerCallback(type, 0, parameter))
+      return false;
+    type_handlers[type].dispatch = &dispatchMessageWithData<T>;
+    type_handlers[type].typedHandler = reinterpret_cast<void (*)(void)>(handler);
+    return true;
+  }
+
+private:
+  template <typename T>
+  static void dispatchMessage(const callback_t& callback, const std::vector<uint8_t>& payload)
+  {
+    if (payload.size() != sizeof(T)) return; // package is malformed
+    MessageView<T> msg(payload.data());
+    reinterpret_cast<void (*)(void *, const T&)>(callback.typedHandler)(callback.param, *msg);
+  }
+
+  template <typename T>
+  static void dispatchMessageWithData(const callback_t& callback, const std::vector<uint8_t>& payload)
+  {
+    if (payload.size() < sizeof(T)) return; // package is malformed
+    MessageView<T> msg(payload.data());
+    reinterpret_cast<void (*)(void *, const T&, const uint8_t *, uint16_t)>(callback.typedHandler)(callback.param, *msg, payload.data() + sizeof(T), payload.size() - sizeof(T));
+  }
+
+public:
   bool unregisterCallback(uint8_t type)
   {
 	    if (type == 0x00)
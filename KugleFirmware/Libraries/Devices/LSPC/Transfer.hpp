@@ -0,0 +1,295 @@
+#ifndef LSPC_TRANSFER_HPP
+#define LSPC_TRANSFER_HPP
+
+#include "MessageTypes.h"
+#include "CRC32.h"
+
+#include <cstdint>
+#include <cstring>
+
+#define LSPC_TRANSFER_CHUNK_SIZE      224     // payload bytes per chunk (the chunk header is added on top), a multiple of the 32 byte flash word such that chunks can be programmed directly
+#ifndef LSPC_TRANSFER_WINDOW
+#define LSPC_TRANSFER_WINDOW          16      // maximum number of unacknowledged chunks in flight (at most 32, the size of the acknowledge bitmap)
+#endif
+#define LSPC_TRANSFER_NO_CHUNK        0xFFFF  // used as 'last' in an acknowledge which is not triggered by a chunk (timeout probe)
+
+#if LSPC_TRANSFER_WINDOW > 32
+#error "The transfer window can not exceed the 32 chunks of the acknowledge bitmap"
+#endif
+
+namespace lspc
+{
+
+// Transmit function used by the transfer classes, eg. a wrapper around Socket::TransmitAsync
+typedef void (*TransferTransmit_t)(void * param, uint8_t type, const uint8_t * payload, uint16_t length);
+
+// Write function used by the receiver to store a chunk at a byte offset within the block, eg. to program it into flash
+typedef bool (*TransferWrite_t)(void * param, uint32_t offset, const uint8_t * data, uint16_t length);
+
+// Streaming of a block of data as sequence-numbered chunks with a sliding window and selective retransmission.
+//
+// The receiver acknowledges every chunk with the first missing sequence number (base), a bitmap of the chunks
+// received beyond it and the sequence number of the chunk which triggered the acknowledge (last).
+// Since the link delivers packages in order, every chunk which is still missing and was transmitted before the
+// latest transmission of 'last' has been lost, and only these are retransmitted.
+// Lost chunks at the end of the window are recovered by a timeout: either the sender calls Timeout() itself, or
+// the receiver sends an acknowledge with last = LSPC_TRANSFER_NO_CHUNK (Probe), which makes the sender retransmit every
+// unacknowledged chunk in the window. This way a side without timers (the firmware) only has to react to packages.
+// The integrity of the complete block is verified by the receiver with a CRC32 given at the start of the transfer.
+
+inline uint32_t TransferChunks(uint32_t size)
+{
+  return (size + LSPC_TRANSFER_CHUNK_SIZE - 1) / LSPC_TRANSFER_CHUNK_SIZE;
+}
+
+class TransferSender
+{
+public:
+  TransferSender(TransferTransmit_t transmit, void * param, uint8_t chunkType)
+    : transmit_(transmit), param_(param), chunkType_(chunkType), data_(0), size_(0), chunks_(0), base_(0), next_(0), acked_(0), stamp_(0), retransmissions_(0), status_(TransferTypes::IN_PROGRESS)
+  {
+  }
+
+  // Start sending a block. The data has to stay valid until the transfer is completed or restarted.
+  void Start(const uint8_t * data, uint32_t size)
+  {
+    data_ = data;
+    size_ = size;
+    chunks_ = TransferChunks(size);
+    base_ = 0;
+    next_ = 0;
+    acked_ = 0;
+    retransmissions_ = 0;
+    status_ = TransferTypes::IN_PROGRESS;
+    Fill();
+  }
+
+  void Acknowledge(const TransferTypes::Ack_t& ack)
+  {
+    if (!data_) return;
+
+    // Slide the window to the first chunk not yet received
+    uint32_t received = ack.received;
+    if (ack.base > base_) {
+      if (ack.base > next_) return; // acknowledges chunks which have not been sent
+      uint32_t shift = ack.base - base_;
+      acked_ = (shift < 32) ? (acked_ >> shift) : 0;
+      base_ = ack.base;
+    } else {
+      uint32_t shift = base_ - ack.base; // old acknowledge
+      received = (shift < 32) ? (received >> shift) : 0;
+    }
+    acked_ |= received;
+    status_ = ack.status;
+
+    if (ack.last == LSPC_TRANSFER_NO_CHUNK) {
+      Timeout();
+    } else if (ack.last >= base_ && ack.last < next_) {
+      // Retransmit the chunks which were lost, i.e. those sent before the chunk which has just been received
+      uint32_t lastStamp = stamps_[ack.last % LSPC_TRANSFER_WINDOW];
+      for (uint16_t sequence = base_; sequence < next_; sequence++) {
+        if (!IsAcknowledged(sequence) && (int32_t)(lastStamp - stamps_[sequence % LSPC_TRANSFER_WINDOW]) > 0) {
+          Transmit(sequence);
+          retransmissions_++;
+        }
+      }
+    }
+
+    Fill();
+  }
+
+  // Retransmit every unacknowledged chunk in the window.
+  // If every chunk has been acknowledged but the final acknowledge is missing, the last chunk is retransmitted to request it again.
+  void Timeout(void)
+  {
+    if (!data_ || status_ != TransferTypes::IN_PROGRESS) return;
+    if (base_ == chunks_ && chunks_ > 0) {
+      Transmit(chunks_ - 1);
+      retransmissions_++;
+      return;
+    }
+    for (uint16_t sequence = base_; sequence < next_; sequence++) {
+      if (!IsAcknowledged(sequence)) {
+        Transmit(sequence);
+        retransmissions_++;
+      }
+    }
+  }
+
+  // The transfer is completed when the receiver has reported the final status
+  bool Completed(void) const { return data_ && status_ != TransferTypes::IN_PROGRESS; }
+  TransferTypes::status_t GetStatus(void) const { return status_; }
+  uint32_t GetRetransmissions(void) const { return retransmissions_; }
+
+private:
+  bool IsAcknowledged(uint16_t sequence) const
+  {
+    return (acked_ >> (sequence - base_)) & 1;
+  }
+
+  // Send new chunks until the window is full
+  void Fill(void)
+  {
+    while (next_ < chunks_ && next_ - base_ < LSPC_TRANSFER_WINDOW) {
+      Transmit(next_);
+      next_++;
+    }
+  }
+
+  void Transmit(uint16_t sequence)
+  {
+    uint8_t buffer[sizeof(TransferTypes::Chunk_t) + LSPC_TRANSFER_CHUNK_SIZE];
+    TransferTypes::Chunk_t chunk;
+    chunk.sequence = sequence;
+
+    uint32_t offset = (uint32_t)sequence * LSPC_TRANSFER_CHUNK_SIZE;
+    uint32_t length = size_ - offset;
+    if (length > LSPC_TRANSFER_CHUNK_SIZE) length = LSPC_TRANSFER_CHUNK_SIZE;
+
+    memcpy(buffer, &chunk, sizeof(chunk));
+    memcpy(&buffer[sizeof(chunk)], &data_[offset], length);
+    stamps_[sequence % LSPC_TRANSFER_WINDOW] = ++stamp_;
+    transmit_(param_, chunkType_, buffer, sizeof(chunk) + length);
+  }
+
+private:
+  TransferTransmit_t transmit_;
+  void * param_;
+  uint8_t chunkType_;
+
+  const uint8_t * data_;
+  uint32_t size_;
+  uint32_t chunks_;
+  uint16_t base_;     // first chunk not acknowledged
+  uint16_t next_;     // next chunk to send for the first time
+  uint32_t acked_;    // bit i set if chunk base_+i has been acknowledged
+  uint32_t stamp_;    // transmission counter
+  uint32_t stamps_[LSPC_TRANSFER_WINDOW]; // transmission counter of the latest transmission of each chunk in the window
+  uint32_t retransmissions_;
+  TransferTypes::status_t status_; // status reported by the receiver
+};
+
+class TransferReceiver
+{
+public:
+  TransferReceiver(TransferTransmit_t transmit, void * param, uint8_t ackType)
+    : transmit_(transmit), param_(param), ackType_(ackType), write_(0), writeParam_(0), data_(0), readback_(0), size_(0), crc_(0), chunks_(0), base_(0), received_(0), status_(TransferTypes::IN_PROGRESS)
+  {
+  }
+
+  // Start receiving a block into the given buffer of 'size' bytes, which is expected to have the given CRC32
+  void Start(uint8_t * data, uint32_t size, uint32_t crc)
+  {
+    Start(0, 0, data, size, crc);
+    data_ = data;
+  }
+
+  // Start receiving a block which is stored with the given write function.
+  // The CRC32 is verified on the stored content, which is read from 'readback'.
+  void Start(TransferWrite_t write, void * writeParam, const uint8_t * readback, uint32_t size, uint32_t crc)
+  {
+    write_ = write;
+    writeParam_ = writeParam;
+    data_ = 0;
+    readback_ = readback;
+    size_ = size;
+    crc_ = crc;
+    chunks_ = TransferChunks(size);
+    base_ = 0;
+    received_ = 0;
+    status_ = TransferTypes::IN_PROGRESS;
+  }
+
+  // Process a received chunk package and acknowledge it.
+  // Returns true when the complete block has been received with a valid CRC, in which case the final
+  // acknowledge is postponed until the caller has processed the block and calls Finish.
+  bool Receive(const uint8_t * payload, uint16_t length)
+  {
+    if (!readback_) return false;
+
+    TransferTypes::Chunk_t chunk;
+    if (length < sizeof(chunk)) return false;
+    memcpy(&chunk, payload, sizeof(chunk));
+    payload += sizeof(chunk);
+    length -= sizeof(chunk);
+
+    if (status_ == TransferTypes::IN_PROGRESS && chunk.sequence >= base_ && chunk.sequence < chunks_ && chunk.sequence - base_ < 32
+        && !((received_ >> (chunk.sequence - base_)) & 1)) { // duplicates are only acknowledged, since flash can not be programmed twice
+      uint32_t offset = (uint32_t)chunk.sequence * LSPC_TRANSFER_CHUNK_SIZE;
+      uint32_t expectedLength = size_ - offset;
+      if (expectedLength > LSPC_TRANSFER_CHUNK_SIZE) expectedLength = LSPC_TRANSFER_CHUNK_SIZE;
+      if (length != expectedLength) return false;
+
+      if (write_) {
+        if (!write_(writeParam_, offset, payload, length)) {
+          status_ = TransferTypes::WRITE_ERROR;
+          SendAck(chunk.sequence);
+          return false;
+        }
+      } else {
+        memcpy(&data_[offset], payload, length);
+      }
+      received_ |= (1UL << (chunk.sequence - base_));
+      while (received_ & 1) {
+        received_ >>= 1;
+        base_++;
+      }
+
+      if (base_ == chunks_) {
+        if (CRC32_Calculate(readback_, size_) == crc_)
+          return true; // postpone the final acknowledge until the block has been processed
+        status_ = TransferTypes::CRC_ERROR;
+      }
+    }
+
+    SendAck(chunk.sequence);
+    return false;
+  }
+
+  // Send the final acknowledge with the result of processing the received block
+  void Finish(TransferTypes::status_t status)
+  {
+    status_ = status;
+    SendAck(LSPC_TRANSFER_NO_CHUNK);
+  }
+
+  // Report the current state to the sender, which makes it retransmit every unacknowledged chunk
+  void Probe(void)
+  {
+    if (!readback_) return;
+    SendAck(LSPC_TRANSFER_NO_CHUNK);
+  }
+
+  TransferTypes::status_t GetStatus(void) const { return status_; }
+
+private:
+  void SendAck(uint16_t last)
+  {
+    TransferTypes::Ack_t ack;
+    ack.received = received_;
+    ack.base = base_;
+    ack.last = last;
+    ack.status = status_;
+    transmit_(param_, ackType_, (const uint8_t *)&ack, sizeof(ack));
+  }
+
+private:
+  TransferTransmit_t transmit_;
+  void * param_;
+  uint8_t ackType_;
+
+  TransferWrite_t write_;
+  void * writeParam_;
+  uint8_t * data_;
+  const uint8_t * readback_;
+  uint32_t size_;
+  uint32_t crc_;
+  uint32_t chunks_;
+  uint16_t base_;      // first chunk not received
+  uint32_t received_;  // bit i set if chunk base_+i has been received
+  TransferTypes::status_t status_;
+};
+
+} // namespace lspc
+
+#endif // LSPC_TRANSFER_HPP
@@ -0,0 +1,29 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+ 
+#ifndef MISC_CRC32_H
+#define MISC_CRC32_H
+
+#include <stdint.h>
+
+/* CRC-32 (IEEE 802.3, reflected polynomial 0xEDB88320) as used by zlib and Ethernet */
+uint32_t CRC32_Calculate(const uint8_t * data, uint32_t length);
+uint32_t CRC32_Update(uint32_t crc, const uint8_t * data, uint32_t length);
+
+#endif
@@ -0,0 +1,133 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+ 
+#ifndef MISC_DUAL_H
+#define MISC_DUAL_H
+
+/* Forward-mode automatic differentiation using dual numbers
+ * A Dual<N> carries a value together with its gradient with respect to N independent variables.
+ * Evaluating a function templated on the scalar type with Dual<N> arguments thus computes the value and the
+ * Jacobian of the function in a single pass, without a separately generated derivative function.
+ * The gradient width is fixed at compile time, so no heap allocation is needed.
+ *
+ * Usage:
+ *   Dual<2> x = Dual<2>::Variable(1.0f, 0);
+ *   Dual<2> y = Dual<2>::Variable(2.0f, 1);
+ *   Dual<2> f = x*y + 3*x;    // f.v = 5,  f.d = {df/dx, df/dy} = {5, 1}
+ */
+#define DUAL_INLINE inline __attribute__((always_inline)) // force inlining also when called from functions with a different optimization level
+
+template <int N>
+class Dual
+{
+	public:
+		float v;    // value
+		float d[N]; // gradient
+
+		DUAL_INLINE Dual()
+		{
+			v = 0;
+			for (int i = 0; i < N; i++) d[i] = 0;
+		}
+
+		DUAL_INLINE Dual(float value) // implicit conversion of constants (zero gradient)
+		{
+			v = value;
+			for (int i = 0; i < N; i++) d[i] = 0;
+		}
+
+		DUAL_INLINE static Dual Variable(float value, int index) // independent variable with unit gradient in the given direction
+		{
+			Dual x(value);
+			x.d[index] = 1;
+			return x;
+		}
+
+		DUAL_INLINE Dual& operator+=(const Dual& b)
+		{
+			v += b.v;
+			for (int i = 0; i < N; i++) d[i] += b.d[i];
+			return *this;
+		}
+
+		DUAL_INLINE Dual& operator-=(const Dual& b)
+		{
+			v -= b.v;
+			for (int i = 0; i < N; i++) d[i] -= b.d[i];
+			return *this;
+		}
+
+		DUAL_INLINE Dual& operator*=(const Dual& b)
+		{
+			for (int i = 0; i < N; i++) d[i] = d[i]*b.v + v*b.d[i];
+			v *= b.v;
+			return *this;
+		}
+
+		DUAL_INLINE Dual& operator/=(const Dual& b)
+		{
+			float inv = 1.0f / b.v;
+			v *= inv;
+			for (int i = 0; i < N; i++) d[i] = (d[i] - v*b.d[i]) * inv;
+			return *this;
+		}
+
+		DUAL_INLINE Dual& operator+=(float b) { v += b; return *this; }
+		DUAL_INLINE Dual& operator-=(float b) { v -= b; return *this; }
+
+		DUAL_INLINE Dual& operator*=(float b)
+		{
+			v *= b;
+			for (int i = 0; i < N; i++) d[i] *= b;
+			return *this;
+		}
+
+		DUAL_INLINE Dual& operator/=(float b)
+		{
+			return *this *= (1.0f / b);
+		}
+};
+
+template <int N> DUAL_INLINE Dual<N> operator-(const Dual<N>& a) { Dual<N> r(a); r *= -1.0f; return r; }
+template <int N> DUAL_INLINE Dual<N> operator+(const Dual<N>& a) { return a; }
+
+template <int N> DUAL_INLINE Dual<N> operator+(Dual<N> a, const Dual<N>& b) { return a += b; }
+template <int N> DUAL_INLINE Dual<N> operator-(Dual<N> a, const Dual<N>& b) { return a -= b; }
+template <int N> DUAL_INLINE Dual<N> operator*(Dual<N> a, const Dual<N>& b) { return a *= b; }
+template <int N> DUAL_INLINE Dual<N> operator/(Dual<N> a, const Dual<N>& b) { return a /= b; }
+
+template <int N> DUAL_INLINE Dual<N> operator+(Dual<N> a, float b) { return a += b; }
+template <int N> DUAL_INLINE Dual<N> operator-(Dual<N> a, float b) { return a -= b; }
+template <int N> DUAL_INLINE Dual<N> operator*(Dual<N> a, float b) { return a *= b; }
+template <int N> DUAL_INLINE Dual<N> operator/(Dual<N> a, float b) { return a /= b; }
+
+template <int N> DUAL_INLINE Dual<N> operator+(float a, Dual<N> b) { return b += a; }
+template <int N> DUAL_INLINE Dual<N> operator-(float a, const Dual<N>& b) { Dual<N> r(-b); return r += a; }
+template <int N> DUAL_INLINE Dual<N> operator*(float a, Dual<N> b) { return b *= a; }
+template <int N> DUAL_INLINE Dual<N> operator/(float a, const Dual<N>& b) // d(a/b) = -a/b^2 * db
+{
+	Dual<N> r;
+	float inv = 1.0f / b.v;
+	r.v = a * inv;
+	for (int i = 0; i < N; i++) r.d[i] = -r.v * inv * b.d[i];
+	return r;
+}
+	
+	
+#endif
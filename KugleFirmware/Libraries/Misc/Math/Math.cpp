@@ -25,7 +25,7 @@ float Math_Round(float num, unsigned int dec)
 {
 	//float power = powf(10, dec);
 	long long power = 1;
-	for (int i = 0; i < dec; i++) {
+	for (unsigned int i = 0; i < dec; i++) {
 		power *= 10;
 	}
 
@@ -23,7 +23,9 @@
 #include <stddef.h>
 #include <stdlib.h>
 
+#ifndef M_PI
 #define M_PI 3.14159265358979323846264338327950288
+#endif
 
 #define deg2rad(x) (M_PI*x/180.f)
 #define rad2deg(x) (180.f*x/M_PI)
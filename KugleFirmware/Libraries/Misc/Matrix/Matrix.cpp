@@ -38,7 +38,7 @@ Matrix::~Matrix()
  * Then the corresponding memory entry is given as: mat[n*i + j]
  */
 
-void Matrix_Extract(const float * in, const int in_rows, const int in_cols, const int in_row, const int in_col, const int out_rows, const int out_cols, float * out)
+void Matrix_Extract(const float * in, const int /*in_rows*/, const int in_cols, const int in_row, const int in_col, const int out_rows, const int out_cols, float * out)
 {
     /*assert(out_rows <= in_rows);
     assert(out_cols <= in_cols);
@@ -74,3 +74,221 @@ void Matrix_Print(float * matrix, int rows, int cols)
     Debug::print("\n");
   }
 }
+
+/* Symmetric matrices are stored in packed format, where only the upper triangular part (including the diagonal) is kept in Row-major format
+ * Assuming MATLAB syntax: mat(i,j)   where i <= j for a symmetric matrix of size n x n
+ * Then the corresponding memory entry is given as: mat[n*i - i*(i+1)/2 + j]
+ * This reduces the storage from n*n to n*(n+1)/2 entries and guarantees that the matrix stays exactly symmetric.
+ * The kernels below use static buffers (similar to the MATLAB generated code) to keep the stack usage low, hence they are not reentrant.
+ */
+
+/**
+ * @brief 	Pack a dense (Row-major) matrix into symmetric packed format
+ *          The off-diagonal elements are averaged, thus removing any asymmetry of the input
+ * @param	in[n*n]             Input: dense matrix
+ * @param	n                   Input: matrix dimension
+ * @param	out[n*(n+1)/2]      Output: packed symmetric matrix
+ */
+void Matrix_SymmetricPack(const float * in, const int n, float * out)
+{
+	for (int i = 0; i < n; i++) {
+		*out++ = in[n*i + i];
+		for (int j = i+1; j < n; j++) {
+			*out++ = 0.5f * (in[n*i + j] + in[n*j + i]);
+		}
+	}
+}
+
+/**
+ * @brief 	Unpack a packed symmetric matrix into a dense (Row-major) matrix
+ * @param	in[n*(n+1)/2]       Input: packed symmetric matrix
+ * @param	n                   Input: matrix dimension
+ * @param	out[n*n]            Output: dense matrix
+ */
+void Matrix_SymmetricUnpack(const float * in, const int n, float * out)
+{
+	for (int i = 0; i < n; i++) {
+		for (int j = i; j < n; j++) {
+			out[n*i + j] = *in;
+			out[n*j + i] = *in;
+			in++;
+		}
+	}
+}
+
+/**
+ * @brief 	Symmetric covariance propagation:  out = F * P * F' + Q
+ *          Only the upper triangle of the result is computed, saving close to half of the multiply-adds of the second product
+ * @param	F[n*n]              Input: dense state transition matrix (Row-major)
+ * @param	P[n*(n+1)/2]        Input: packed covariance matrix
+ * @param	Q[n*(n+1)/2]        Input: packed process covariance matrix (set to 0 to skip)
+ * @param	n                   Input: matrix dimension
+ * @param	out[n*(n+1)/2]      Output: packed propagated covariance matrix (may not point to P)
+ */
+void Matrix_SymmetricPropagate(const float * F, const float * P, const float * Q, const int n, float * out)
+{
+	static float FP[MATRIX_SYMMETRIC_MAX_DIMENSION*MATRIX_SYMMETRIC_MAX_DIMENSION];
+	if (n > MATRIX_SYMMETRIC_MAX_DIMENSION) {
+		ERROR("Matrix dimension exceeds MATRIX_SYMMETRIC_MAX_DIMENSION");
+		return;
+	}
+
+	/* FP = F * P */
+	for (int i = 0; i < n; i++) {
+		for (int j = 0; j < n; j++) {
+			float sum = 0;
+			for (int k = 0; k < n; k++) {
+				if (F[n*i + k] == 0) continue; // state transition matrices are usually sparse
+				sum += F[n*i + k] * P[Matrix_SymmetricIndex(n, k, j)];
+			}
+			FP[n*i + j] = sum;
+		}
+	}
+
+	/* out = FP * F' + Q  (upper triangle only) */
+	for (int i = 0; i < n; i++) {
+		for (int j = i; j < n; j++) {
+			float sum = 0;
+			for (int k = 0; k < n; k++) {
+				sum += FP[n*i + k] * F[n*j + k];
+			}
+			if (Q) sum += *Q++;
+			*out++ = sum;
+		}
+	}
+}
+
+/**
+ * @brief 	Symmetric Kalman filter covariance update:  out = (I - K*H) * P = P - K * (H * P)
+ *          Only the upper triangle of the result is computed
+ * @param	P[n*(n+1)/2]        Input: packed apriori covariance matrix
+ * @param	H[m*n]              Input: measurement Jacobian (Row-major)
+ * @param	K[n*m]              Input: Kalman gain (Row-major)
+ * @param	n                   Input: state dimension
+ * @param	m                   Input: measurement dimension
+ * @param	out[n*(n+1)/2]      Output: packed aposteriori covariance matrix (may point to P)
+ */
+void Matrix_SymmetricUpdate(const float * P, const float * H, const float * K, const int n, const int m, float * out)
+{
+	static float HP[MATRIX_SYMMETRIC_MAX_DIMENSION*MATRIX_SYMMETRIC_MAX_DIMENSION];
+	if (n > MATRIX_SYMMETRIC_MAX_DIMENSION || m > MATRIX_SYMMETRIC_MAX_DIMENSION) {
+		ERROR("Matrix dimension exceeds MATRIX_SYMMETRIC_MAX_DIMENSION");
+		return;
+	}
+
+	/* HP = H * P */
+	for (int a = 0; a < m; a++) {
+		for (int j = 0; j < n; j++) {
+			float sum = 0;
+			for (int k = 0; k < n; k++) {
+				if (H[n*a + k] == 0) continue; // measurement Jacobians are usually sparse
+				sum += H[n*a + k] * P[Matrix_SymmetricIndex(n, k, j)];
+			}
+			HP[n*a + j] = sum;
+		}
+	}
+
+	/* out = P - K * HP  (upper triangle only) */
+	for (int i = 0; i < n; i++) {
+		for (int j = i; j < n; j++) {
+			float sum = *P++;
+			for (int a = 0; a < m; a++) {
+				sum -= K[m*i + a] * HP[n*a + j];
+			}
+			*out++ = sum;
+		}
+	}
+}
+
+/**
+ * @brief 	Joseph form Kalman filter covariance update:  out = (I - K*H) * P * (I - K*H)' + K * R * K'
+ *          The Joseph form keeps the covariance positive definite even with a suboptimal gain or round-off errors, at the cost of additional computations.
+ *          It is evaluated as  out = A + (K*R - A*H') * K'  with  A = (I - K*H) * P,  and only the upper triangle of the result is computed
+ * @param	P[n*(n+1)/2]        Input: packed apriori covariance matrix
+ * @param	H[m*n]              Input: measurement Jacobian (Row-major)
+ * @param	K[n*m]              Input: Kalman gain (Row-major)
+ * @param	R[m*m]              Input: measurement covariance (Row-major)
+ * @param	n                   Input: state dimension
+ * @param	m                   Input: measurement dimension
+ * @param	out[n*(n+1)/2]      Output: packed aposteriori covariance matrix (may point to P)
+ */
+void Matrix_SymmetricJosephUpdate(const float * P, const float * H, const float * K, const float * R, const int n, const int m, float * out)
+{
+	static float HP[MATRIX_SYMMETRIC_MAX_DIMENSION*MATRIX_SYMMETRIC_MAX_DIMENSION];
+	static float A[MATRIX_SYMMETRIC_MAX_DIMENSION*MATRIX_SYMMETRIC_MAX_DIMENSION];
+	static float B[MATRIX_SYMMETRIC_MAX_DIMENSION*MATRIX_SYMMETRIC_MAX_DIMENSION];
+	if (n > MATRIX_SYMMETRIC_MAX_DIMENSION || m > MATRIX_SYMMETRIC_MAX_DIMENSION) {
+		ERROR("Matrix dimension exceeds MATRIX_SYMMETRIC_MAX_DIMENSION");
+		return;
+	}
+
+	/* HP = H * P */
+	for (int a = 0; a < m; a++) {
+		for (int j = 0; j < n; j++) {
+			float sum = 0;
+			for (int k = 0; k < n; k++) {
+				if (H[n*a + k] == 0) continue; // measurement Jacobians are usually sparse
+				sum += H[n*a + k] * P[Matrix_SymmetricIndex(n, k, j)];
+			}
+			HP[n*a + j] = sum;
+		}
+	}
+
+	/* A = P - K * HP  (full matrix, since A is not symmetric) */
+	for (int i = 0; i < n; i++) {
+		for (int j = 0; j < n; j++) {
+			float sum = P[Matrix_SymmetricIndex(n, i, j)];
+			for (int a = 0; a < m; a++) {
+				sum -= K[m*i + a] * HP[n*a + j];
+			}
+			A[n*i + j] = sum;
+		}
+	}
+
+	/* B = K * R - A * H' */
+	for (int i = 0; i < n; i++) {
+		for (int a = 0; a < m; a++) {
+			float sum = 0;
+			for (int b = 0; b < m; b++) {
+				sum += K[m*i + b] * R[m*b + a];
+			}
+			for (int k = 0; k < n; k++) {
+				if (H[n*a + k] == 0) continue;
+				sum -= A[n*i + k] * H[n*a + k];
+			}
+			B[m*i + a] = sum;
+		}
+	}
+
+	/* out = A + B * K'  (upper triangle only) */
+	for (int i = 0; i < n; i++) {
+		for (int j = i; j < n; j++) {
+			float sum = A[n*i + j];
+			for (int a = 0; a < m; a++) {
+				sum += B[m*i + a] * K[m*j + a];
+			}
+			*out++ = sum;
+		}
+	}
+}
+
+/**
+ * @brief 	Closed form inverse of a symmetric 3x3 matrix, eg. an innovation covariance, computed as  Sinv = adj(S) / det(S)
+ * @param	S[3*3]              Input: symmetric matrix (only the upper triangle is used)
+ * @param	Sinv[3*3]           Output: inverse matrix
+ */
+void Matrix_SymmetricInverse3x3(const float S[9], float Sinv[9])
+{
+	Sinv[0] = S[4]*S[8] - S[5]*S[5];
+	Sinv[1] = S[2]*S[5] - S[1]*S[8];
+	Sinv[2] = S[1]*S[5] - S[2]*S[4];
+	Sinv[4] = S[0]*S[8] - S[2]*S[2];
+	Sinv[5] = S[1]*S[2] - S[0]*S[5];
+	Sinv[8] = S[0]*S[4] - S[1]*S[1];
+	float invDet = 1.f / (S[0]*Sinv[0] + S[1]*Sinv[1] + S[2]*Sinv[2]);
+	Sinv[0] *= invDet;  Sinv[1] *= invDet;  Sinv[2] *= invDet;
+	Sinv[4] *= invDet;  Sinv[5] *= invDet;  Sinv[8] *= invDet;
+	Sinv[3] = Sinv[1];
+	Sinv[6] = Sinv[2];
+	Sinv[7] = Sinv[5];
+}
@@ -41,6 +41,25 @@ private:
 extern void Matrix_Extract(const float * in, const int in_rows, const int in_cols, const int in_row, const int in_col, const int out_rows, const int out_cols, float * out);
 extern void Matrix_Round(float * matrix, int rows, int cols);
 extern void Matrix_Print(float * matrix, int rows, int cols);
+
+/* Symmetric matrices (eg. covariance matrices) stored in packed upper triangular format */
+#define MATRIX_SYMMETRIC_SIZE(n)		((n)*((n)+1)/2)
+#define MATRIX_SYMMETRIC_MAX_DIMENSION	10 // largest symmetric matrix dimension supported by the kernels below (sets the size of the internal buffers)
+
+inline int Matrix_SymmetricIndex(const int n, const int row, const int col)
+{
+	if (row <= col)
+		return n*row - (row*(row+1))/2 + col;
+	else
+		return n*col - (col*(col+1))/2 + row;
+}
+
+extern void Matrix_SymmetricPack(const float * in, const int n, float * out);
+extern void Matrix_SymmetricUnpack(const float * in, const int n, float * out);
+extern void Matrix_SymmetricPropagate(const float * F, const float * P, const float * Q, const int n, float * out);
+extern void Matrix_SymmetricUpdate(const float * P, const float * H, const float * K, const int n, const int m, float * out);
+extern void Matrix_SymmetricInverse3x3(const float S[9], float Sinv[9]);
+extern void Matrix_SymmetricJosephUpdate(const float * P, const float * H, const float * K, const float * R, const int n, const int m, float * out);
 	
 	
 #endif
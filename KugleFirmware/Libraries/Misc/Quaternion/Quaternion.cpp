@@ -22,6 +22,7 @@
 #include <arm_math.h>
 #include <math.h>
 #include <stdlib.h>
+#include <string.h>
 
 // Quaternion class for computations with quaternions of the format
 //   q = {q0, q1, q2, q3} = {s, v}
@@ -34,10 +35,11 @@
 // See: http://en.wikipedia.org/wiki/Fast_inverse_square_root
 float invSqrt(float x) {
 	float halfx = 0.5f * x;
-	float y = x;
-	long i = *(long*)&y;
+	float y;
+	int32_t i;
+	memcpy(&i, &x, sizeof(i)); // reinterpret the bits without breaking strict aliasing, and 32 bit on the host as well
 	i = 0x5f3759df - (i>>1);
-	y = *(float*)&i;
+	memcpy(&y, &i, sizeof(y));
 	y = y * (1.5f - (halfx * y * y));
 	y = y * (1.5f - (halfx * y * y));
 	return y;
@@ -211,7 +213,7 @@ void Quaternion_Conjugate(float q[4])
     q[3] = -q[3];
 }
 
-void Quaternion_Print(const float q[4])
+void Quaternion_Print(const float /*q*/[4])
 {
     /*Serial.print("  ");
     Serial.printf("%7.4f\n", q[0]);
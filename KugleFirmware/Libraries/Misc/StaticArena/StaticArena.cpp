@@ -0,0 +1,69 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+ 
+
+#include "StaticArena.h"
+#include "Debug.h"
+#include <string.h> // for memset
+
+StaticArena::StaticArena(uint8_t * memory, size_t size) : memory_(memory), size_(size), used_(0)
+{
+}
+
+StaticArena::~StaticArena()
+{
+}
+
+/**
+ * @brief 	Allocate memory from the arena
+ * @param	size       Input: number of bytes, rounded up to STATIC_ARENA_ALIGNMENT
+ * @retval	pointer to the memory. An exhausted arena is reported with ERROR, which does not return on target.
+ */
+void * StaticArena::Allocate(size_t size)
+{
+	size = (size + STATIC_ARENA_ALIGNMENT - 1) & ~(size_t)(STATIC_ARENA_ALIGNMENT - 1);
+	if (size > size_ - used_) {
+		ERROR("Static arena exhausted");
+		return 0;
+	}
+
+	void * ptr = &memory_[used_];
+	used_ += size;
+	return ptr;
+}
+
+/**
+ * @brief 	Release all allocations. The objects in the arena must have been destroyed.
+ *          The used memory is zeroed, such that recreated objects start from zeroed memory as after boot.
+ */
+void StaticArena::Reset(void)
+{
+	memset(memory_, 0, used_);
+	used_ = 0;
+}
+
+void * operator new(size_t size, StaticArena& arena) noexcept
+{
+	return arena.Allocate(size);
+}
+
+void * operator new[](size_t size, StaticArena& arena) noexcept
+{
+	return arena.Allocate(size);
+}
@@ -0,0 +1,71 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+ 
+
+#ifndef MISC_STATICARENA_H
+#define MISC_STATICARENA_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <new>
+
+#define STATIC_ARENA_ALIGNMENT		8 // alignment of every allocation, sufficient for double and uint64_t
+#define STATIC_ARENA_SIZEOF(type)	((sizeof(type) + STATIC_ARENA_ALIGNMENT - 1) & ~(size_t)(STATIC_ARENA_ALIGNMENT - 1)) // space taken by one object
+
+/* Define a statically sized arena. The memory is placed in the .static_arena section (see linker script),
+ * which is in the same RAM as the FreeRTOS heap, such that objects moved from the heap keep the same memory properties (eg. DMA access).
+ * The section is zeroed by the startup code, as the heap is by ZeroInitFreeRTOSheap. */
+#define STATIC_ARENA(name, size) \
+	static uint8_t name##_memory[size] __attribute__((aligned(STATIC_ARENA_ALIGNMENT), section(".static_arena"))); \
+	static StaticArena name(name##_memory, sizeof(name##_memory))
+
+/* Bump allocator for long-lived objects, used with placement new:
+ *     LQR * lqr = new (arena) LQR(params);
+ * Objects are never freed individually. Instead the destructors are called explicitly (StaticArena_Destroy)
+ * and the whole arena is reset, eg. when a controller thread is restarted.
+ * An exhausted arena is a fatal error (ERROR), since the arenas are sized for the exact objects they hold,
+ * hence the result of a placement new does not have to be checked. */
+class StaticArena
+{
+	public:
+		StaticArena(uint8_t * memory, size_t size);
+		~StaticArena();
+
+		void * Allocate(size_t size);
+		void Reset(void);
+
+		size_t GetSize(void) const { return size_; };
+		size_t GetUsed(void) const { return used_; };
+
+	private:
+		uint8_t * memory_;
+		size_t size_;
+		size_t used_;
+};
+
+void * operator new(size_t size, StaticArena& arena) noexcept;
+void * operator new[](size_t size, StaticArena& arena) noexcept;
+
+template <typename T>
+void StaticArena_Destroy(T * object)
+{
+	if (object) object->~T();
+}
+
+#endif
@@ -0,0 +1,177 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+ 
+
+#include "BlockTransfer.h"
+#include "CRC32.h"
+#include "Debug.h"
+
+BlockTransfer::BlockTransfer(LSPC& com, EEPROM * eeprom, BlackBox * blackBox) : com_(com), eeprom_(eeprom), blackBox_(blackBox),
+	sender_(&Transmit, (void *)&com, lspc::MessageTypesToPC::TransferChunk),
+	receiver_(&Transmit, (void *)&com, lspc::MessageTypesToPC::TransferAck),
+	block_(lspc::TransferTypes::PARAMETERS), direction_(lspc::TransferTypes::DUMP), buffer_(0), dumpData_(0)
+{
+	/* Register message type callbacks (all callbacks are executed by the LSPC processing thread, hence no locking is needed) */
+	com_.registerCallback<lspc::MessageTypesFromPC::TransferStart>(&TransferStart_Callback, (void *)this);
+	com_.registerCallback(lspc::MessageTypesFromPC::TransferChunk, &TransferChunk_Callback, (void *)this);
+	com_.registerCallback<lspc::MessageTypesFromPC::TransferAck>(&TransferAck_Callback, (void *)this);
+}
+
+BlockTransfer::~BlockTransfer()
+{
+	/* Unregister message callbacks */
+	com_.unregisterCallback(lspc::MessageTypesFromPC::TransferStart);
+	com_.unregisterCallback(lspc::MessageTypesFromPC::TransferChunk);
+	com_.unregisterCallback(lspc::MessageTypesFromPC::TransferAck);
+	FreeBuffer();
+}
+
+uint32_t BlockTransfer::GetBlockSize(lspc::TransferTypes::block_t block)
+{
+	if (block == lspc::TransferTypes::PARAMETERS)
+		return params_.GetBlockSize();
+	else if (block == lspc::TransferTypes::IMU_CALIBRATION && eeprom_)
+		return eeprom_->GetSectionSize(eeprom_->sections.imu_calibration);
+	else if (block == lspc::TransferTypes::BLACKBOX && blackBox_) {
+		uint32_t size;
+		blackBox_->GetRecording(size);
+		return size;
+	}
+	return 0;
+}
+
+bool BlockTransfer::ReadBlock(lspc::TransferTypes::block_t block, uint8_t * data, uint32_t size)
+{
+	if (block == lspc::TransferTypes::PARAMETERS)
+		return params_.ReadBlock(data, size);
+	else if (block == lspc::TransferTypes::IMU_CALIBRATION && eeprom_)
+		return eeprom_->ReadData(eeprom_->sections.imu_calibration, data, size) == EEPROM::EEPROM_FLASH_COMPLETE;
+	return false;
+}
+
+bool BlockTransfer::WriteBlock(lspc::TransferTypes::block_t block, const uint8_t * data, uint32_t size)
+{
+	if (block == lspc::TransferTypes::PARAMETERS)
+		return params_.WriteBlock(data, size);
+	else if (block == lspc::TransferTypes::IMU_CALIBRATION && eeprom_)
+		return eeprom_->WriteData(eeprom_->sections.imu_calibration, (uint8_t *)data, size) == EEPROM::EEPROM_FLASH_COMPLETE;
+	return false;
+}
+
+void BlockTransfer::FreeBuffer(void)
+{
+	if (buffer_) {
+		vPortFree(buffer_);
+		buffer_ = 0;
+	}
+	dumpData_ = 0;
+}
+
+void BlockTransfer::Transmit(void * param, uint8_t type, const uint8_t * payload, uint16_t length)
+{
+	LSPC * com = (LSPC *)param;
+	com->TransmitAsync(type, payload, length);
+}
+
+/* Start a dump or restore of a block. A transfer in progress is aborted. */
+void BlockTransfer::TransferStart_Callback(void * param, const lspc::MessageTypesFromPC::TransferStart_t& msg)
+{
+	BlockTransfer * transfer = (BlockTransfer *)param;
+	if (!transfer) return;
+
+	lspc::MessageTypesToPC::TransferInfo_t info;
+	info.block = msg.block;
+	info.direction = msg.direction;
+	info.status = lspc::TransferTypes::REJECTED;
+	info.size = transfer->GetBlockSize(msg.block);
+	info.crc = 0;
+
+	transfer->FreeBuffer();
+	transfer->sender_.Start(0, 0);
+	transfer->receiver_.Start(0, 0, 0);
+
+	transfer->block_ = msg.block;
+	transfer->direction_ = msg.direction;
+
+	if (msg.block == lspc::TransferTypes::BLACKBOX) {
+		/* The frozen recording is dumped in place, as it is too large to be copied to the heap */
+		if (info.size > 0 && msg.direction == lspc::TransferTypes::DUMP) {
+			transfer->dumpData_ = transfer->blackBox_->GetRecording(info.size);
+			info.crc = CRC32_Calculate(transfer->dumpData_, info.size);
+			info.status = lspc::TransferTypes::IN_PROGRESS;
+		}
+	}
+	else {
+		if (info.size > 0 && (msg.direction == lspc::TransferTypes::DUMP || msg.size == info.size))
+			transfer->buffer_ = (uint8_t *)pvPortMalloc(info.size);
+
+		if (transfer->buffer_) {
+			if (msg.direction == lspc::TransferTypes::DUMP) {
+				if (transfer->ReadBlock(msg.block, transfer->buffer_, info.size)) {
+					transfer->dumpData_ = transfer->buffer_;
+					info.crc = CRC32_Calculate(transfer->buffer_, info.size);
+					info.status = lspc::TransferTypes::IN_PROGRESS;
+				}
+			}
+			else if (msg.direction == lspc::TransferTypes::RESTORE) {
+				transfer->receiver_.Start(transfer->buffer_, info.size, msg.crc);
+				info.status = lspc::TransferTypes::IN_PROGRESS;
+			}
+		}
+	}
+
+	if (info.status != lspc::TransferTypes::IN_PROGRESS)
+		transfer->FreeBuffer();
+
+	transfer->com_.TransmitAsync<lspc::MessageTypesToPC::TransferInfo>(info);
+
+	if (info.status == lspc::TransferTypes::IN_PROGRESS && msg.direction == lspc::TransferTypes::DUMP)
+		transfer->sender_.Start(transfer->dumpData_, info.size); // sends the first window of chunks
+}
+
+/* Chunk of a block being restored */
+void BlockTransfer::TransferChunk_Callback(void * param, const std::vector<uint8_t>& payload)
+{
+	BlockTransfer * transfer = (BlockTransfer *)param;
+	if (!transfer) return;
+	if (!transfer->buffer_ || transfer->direction_ != lspc::TransferTypes::RESTORE) return;
+
+	if (transfer->receiver_.Receive(payload.data(), payload.size())) {
+		/* Complete block received with a valid CRC */
+		uint32_t size = transfer->GetBlockSize(transfer->block_);
+		if (transfer->WriteBlock(transfer->block_, transfer->buffer_, size))
+			transfer->receiver_.Finish(lspc::TransferTypes::COMPLETE);
+		else
+			transfer->receiver_.Finish(lspc::TransferTypes::WRITE_ERROR);
+	}
+}
+
+/* Acknowledge of chunks of a block being dumped */
+void BlockTransfer::TransferAck_Callback(void * param, const lspc::TransferTypes::Ack_t& ack)
+{
+	BlockTransfer * transfer = (BlockTransfer *)param;
+	if (!transfer) return;
+	if (!transfer->dumpData_ || transfer->direction_ != lspc::TransferTypes::DUMP) return;
+
+	transfer->sender_.Acknowledge(ack);
+	if (transfer->sender_.Completed()) {
+		transfer->sender_.Start(0, 0);
+		transfer->FreeBuffer();
+	}
+}
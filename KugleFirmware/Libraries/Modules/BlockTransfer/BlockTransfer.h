@@ -0,0 +1,67 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+ 
+
+#ifndef MODULES_BLOCKTRANSFER_H
+#define MODULES_BLOCKTRANSFER_H
+
+#include "LSPC.hpp"
+#include "Transfer.hpp"
+#include "Parameters.h"
+#include "EEPROM.h"
+#include "BlackBox.h"
+
+/* Dump and restore of complete configuration blocks (parameters and IMU calibration) and dump of the black box recording over LSPC.
+ * The blocks are streamed as chunks with a sliding window and verified with a CRC32, see Transfer.hpp.
+ * A dump is a snapshot taken when the transfer is started, and a restore is only applied once the complete block has been received with a valid CRC.
+ * The firmware has no transfer timers, lost packages are recovered from the timeouts of the PC side.
+ * Restored parameters are not stored in EEPROM until StoreParameters is sent, while a restored IMU calibration is written to EEPROM and used from the next boot.
+ * The black box recording is dumped directly from the recorder memory, since it does not change until the recorder is armed again. */
+class BlockTransfer
+{
+	public:
+		BlockTransfer(LSPC& com, EEPROM * eeprom, BlackBox * blackBox);
+		~BlockTransfer();
+
+	private:
+		uint32_t GetBlockSize(lspc::TransferTypes::block_t block);
+		bool ReadBlock(lspc::TransferTypes::block_t block, uint8_t * data, uint32_t size);
+		bool WriteBlock(lspc::TransferTypes::block_t block, const uint8_t * data, uint32_t size);
+		void FreeBuffer(void);
+
+		static void Transmit(void * param, uint8_t type, const uint8_t * payload, uint16_t length);
+		static void TransferStart_Callback(void * param, const lspc::MessageTypesFromPC::TransferStart_t& msg);
+		static void TransferChunk_Callback(void * param, const std::vector<uint8_t>& payload);
+		static void TransferAck_Callback(void * param, const lspc::TransferTypes::Ack_t& ack);
+
+	private:
+		LSPC& com_;
+		EEPROM * eeprom_;
+		BlackBox * blackBox_;
+		Parameters params_;
+
+		lspc::TransferSender sender_;
+		lspc::TransferReceiver receiver_;
+		lspc::TransferTypes::block_t block_;
+		lspc::TransferTypes::direction_t direction_;
+		uint8_t * buffer_;
+		const uint8_t * dumpData_; // block being dumped, either buffer_ or the black box recording
+};
+
+#endif
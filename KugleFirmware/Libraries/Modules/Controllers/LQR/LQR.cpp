@@ -52,7 +52,7 @@ LQR::~LQR()
  * @param	omega_ref[3]  Input: desired/reference angular velocity defined in body frame   (OBS. Notice this is body frame)
  * @param	tau[3]    	  Output: motor torque outputs [Nm] where tau[0] is the motor placed along the x-axis of the robot-centric frame
  */
-void LQR::Step(const float q[4], const float dq[4], const float xy[2], const float dxy[2], const float q_ref[4], const float omega_ref[3], float tau[3])
+void LQR::Step(const float q[4], const float dq[4], const float /*xy*/[2], const float /*dxy*/[2], const float q_ref[4], const float omega_ref[3], float tau[3])
 {
 	Step(q, dq, q_ref, omega_ref, tau, (float32_t *)_params.controller.LQR_K);
 }
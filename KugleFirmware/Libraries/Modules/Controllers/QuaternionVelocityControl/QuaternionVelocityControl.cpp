@@ -66,7 +66,7 @@ void QuaternionVelocityControl::Step(const float q[4], const float dq[4], const
 	Step(q, dq, dxy, velocityRef, velocityRefGivenInHeadingFrame, headingRef, dt, q_ref_out);
 }
 
-void QuaternionVelocityControl::Step(const float q[4], const float dq[4], const float dxy[2], const float velocityRef[2], const bool velocityRefGivenInHeadingFrame, const float headingRef, const float dt, float q_ref_out[4])
+void QuaternionVelocityControl::Step(const float q[4], const float /*dq*/[4], const float dxy[2], const float velocityRef[2], const bool velocityRefGivenInHeadingFrame, const float headingRef, const float dt, float q_ref_out[4])
 {
 	//const float Velocity_Inertial_q[4] = {0, dx_filt.sample(fmin(fmax(*dx, -CLAMP_VELOCITY), CLAMP_VELOCITY)), dy_filt.sample(fmin(fmax(*dy, -CLAMP_VELOCITY), CLAMP_VELOCITY)), 0};
 	float Velocity_Inertial_q[4] = {0, dxy[0], dxy[1], 0};
@@ -73,7 +73,7 @@ void SlidingMode::Step(const float q[4], const float dq[4], const float xy[2], c
  * @param	tau[3]    	  Output: motor torque outputs [Nm] where tau[0] is the motor placed along the x-axis of the robot-centric frame
  * @param	S[3]      	  Output: sliding manifold values for the three surfaces used for the attitude control
  */
-void SlidingMode::Step(const float q[4], const float dq[4], const float xy[2], const float dxy[2], const float q_ref[4], const float omega_ref[3], const float Jk, const float Mk, const float rk, const float Mb, const float Jbx, const float Jby, const float Jbz, const float Jw, const float rw, const float Bvk, const float Bvm, const float Bvb, const float l, const float g_const, const float COM_X, const float COM_Y, const float COM_Z, const float K[3], const float eta, const float epsilon, const bool continuousSwitching, float tau[3], float S[3])
+void SlidingMode::Step(const float q[4], const float dq[4], const float xy[2], const float dxy[2], const float q_ref[4], const float omega_ref[3], const float Jk, const float Mk, const float rk, const float Mb, const float Jbx, const float Jby, const float Jbz, const float Jw, const float rw, const float Bvk, const float Bvm, const float Bvb, const float /*l*/, const float g_const, const float COM_X, const float COM_Y, const float COM_Z, const float K[3], const float eta, const float epsilon, const bool continuousSwitching, float tau[3], float S[3])
 {
     // See ARM-CMSIS DSP library for matrix operations: https://www.keil.com/pack/doc/CMSIS/DSP/html/group__groupMatrix.html
     arm_matrix_instance_f32 q_; arm_mat_init_f32(&q_, 4, 1, (float32_t *)q);
@@ -337,7 +337,6 @@ bool SlidingMode::UnitTest(void)
 	const float Jk = ((2.f * Mk * rk*rk) / 3.f);
 
 	const float rw = 0.05f;
-	const float Mw = 0.270f;
 	const float i_gear = 4.3;
 	const float Jow = 9.f * 0.0001f;
 	const float Jm = 1.21f * 0.0001f;
@@ -0,0 +1,176 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+ 
+ 
+#include "BlackBox.h"
+#include "stm32h7xx_hal.h" // for the DWT cycle counter
+#include "Debug.h"
+#include <algorithm> // for std::rotate
+#include <string.h> // for memcpy
+
+static lspc::BlackBoxTypes::Record_t blackBoxRecords[BLACKBOX_RECORDS] __attribute__((section(".blackbox")));
+
+BlackBox::BlackBox(LSPC& com, uint32_t taskPriority) : com_(com), taskHandle_(0), records_(blackBoxRecords), head_(0), count_(0), postTriggerRemaining_(0), triggerRecord_(0),
+	state_(lspc::BlackBoxTypes::RECORDING), trigger_(lspc::BlackBoxTypes::NO_TRIGGER), recordCycles_(0), maxRecordCycles_(0)
+{
+	/* Enable the cycle counter */
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->LAR = 0xC5ACCE55; // unlock access to the DWT registers, required on the Cortex-M7
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+	xTaskCreate(BlackBox::Thread, (char *)"Black box", BLACKBOX_THREAD_STACK, (void*) this, taskPriority, &taskHandle_);
+	if (!taskHandle_) {
+		ERROR("Could not create black box task");
+		return;
+	}
+
+	com_.registerCallback<lspc::MessageTypesFromPC::BlackBoxCommand>(&BlackBoxCommand_Callback, (void *)this);
+}
+
+BlackBox::~BlackBox()
+{
+	com_.unregisterCallback(lspc::MessageTypesFromPC::BlackBoxCommand);
+	if (taskHandle_)
+		vTaskDelete(taskHandle_); // stop task
+}
+
+/**
+ * @brief 	Add a record to the recording. Only to be called from one task, eg. every sample of the balance controller.
+ * @param	record     Input: record to copy into the circular buffer
+ */
+void BlackBox::Record(const lspc::BlackBoxTypes::Record_t& record)
+{
+	uint32_t start = DWT->CYCCNT;
+
+	lspc::BlackBoxTypes::state_t state = __atomic_load_n(&state_, __ATOMIC_ACQUIRE);
+	if (state != lspc::BlackBoxTypes::RECORDING && state != lspc::BlackBoxTypes::TRIGGERED) return;
+
+	records_[head_] = record;
+	head_ = (head_ + 1 < BLACKBOX_RECORDS) ? head_ + 1 : 0;
+	if (count_ < BLACKBOX_RECORDS) count_++;
+
+	if (state == lspc::BlackBoxTypes::RECORDING) {
+		if (__atomic_load_n(&trigger_, __ATOMIC_RELAXED) != lspc::BlackBoxTypes::NO_TRIGGER) { // this is the trigger record
+			postTriggerRemaining_ = BLACKBOX_POST_TRIGGER_RECORDS;
+			__atomic_store_n(&state_, lspc::BlackBoxTypes::TRIGGERED, __ATOMIC_RELEASE);
+		}
+	}
+	else if (--postTriggerRemaining_ == 0) {
+		__atomic_store_n(&state_, lspc::BlackBoxTypes::FROZEN, __ATOMIC_RELEASE);
+		xTaskNotifyGive(taskHandle_); // prepare the recording for the dump
+	}
+
+	uint32_t cycles = DWT->CYCCNT - start;
+	recordCycles_ = cycles;
+	if (cycles > maxRecordCycles_)
+		maxRecordCycles_ = cycles;
+}
+
+/**
+ * @brief 	Trigger the recorder. Only the first trigger after the recorder has been armed is used.
+ * @param	cause      Input: reason of the trigger
+ */
+void BlackBox::Trigger(lspc::BlackBoxTypes::trigger_t cause)
+{
+	if (__atomic_load_n(&state_, __ATOMIC_ACQUIRE) != lspc::BlackBoxTypes::RECORDING) return;
+
+	lspc::BlackBoxTypes::trigger_t expected = lspc::BlackBoxTypes::NO_TRIGGER;
+	__atomic_compare_exchange_n(&trigger_, &expected, cause, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief 	Discard the recording and start recording again. A dump of the recording in progress will fail its CRC check.
+ * @retval	false if a recording is being captured or prepared, in which case it is kept
+ */
+bool BlackBox::Arm(void)
+{
+	lspc::BlackBoxTypes::state_t state = __atomic_load_n(&state_, __ATOMIC_ACQUIRE);
+	if (state == lspc::BlackBoxTypes::RECORDING) return true; // already armed
+	if (state != lspc::BlackBoxTypes::READY) return false;
+
+	/* Record does not touch the recorder state until it sees the RECORDING state */
+	head_ = 0;
+	count_ = 0;
+	triggerRecord_ = 0;
+	maxRecordCycles_ = 0;
+	__atomic_store_n(&trigger_, lspc::BlackBoxTypes::NO_TRIGGER, __ATOMIC_RELAXED);
+	__atomic_store_n(&state_, lspc::BlackBoxTypes::RECORDING, __ATOMIC_RELEASE);
+	return true;
+}
+
+/**
+ * @brief 	Get the recording to be dumped
+ * @param	size       Output: size of the recording in bytes
+ * @retval	pointer to the records with the oldest record first, or 0 if no recording is ready
+ */
+const uint8_t * BlackBox::GetRecording(uint32_t& size)
+{
+	if (__atomic_load_n(&state_, __ATOMIC_ACQUIRE) != lspc::BlackBoxTypes::READY) {
+		size = 0;
+		return 0;
+	}
+
+	size = count_ * sizeof(lspc::BlackBoxTypes::Record_t);
+	return (const uint8_t *)records_;
+}
+
+void BlackBox::TransmitInfo(void)
+{
+	lspc::MessageTypesToPC::BlackBoxInfo_t info;
+	info.state = __atomic_load_n(&state_, __ATOMIC_ACQUIRE);
+	info.trigger = __atomic_load_n(&trigger_, __ATOMIC_RELAXED);
+	info.recordSize = sizeof(lspc::BlackBoxTypes::Record_t);
+	info.records = count_;
+	info.triggerRecord = triggerRecord_;
+	info.recordCycles = recordCycles_;
+	info.maxRecordCycles = maxRecordCycles_;
+	com_.TransmitAsync<lspc::MessageTypesToPC::BlackBoxInfo>(info);
+}
+
+void BlackBox::Thread(void * pvParameters)
+{
+	BlackBox * blackBox = (BlackBox *)pvParameters;
+
+	while (1) {
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+		if (__atomic_load_n(&blackBox->state_, __ATOMIC_ACQUIRE) != lspc::BlackBoxTypes::FROZEN) continue;
+
+		/* Rotate the circular buffer in place, such that the recording can be dumped as one block starting with the oldest record */
+		if (blackBox->count_ == BLACKBOX_RECORDS)
+			std::rotate(blackBox->records_, blackBox->records_ + blackBox->head_, blackBox->records_ + BLACKBOX_RECORDS);
+		blackBox->head_ = blackBox->count_ % BLACKBOX_RECORDS;
+		blackBox->triggerRecord_ = blackBox->count_ - 1 - BLACKBOX_POST_TRIGGER_RECORDS;
+
+		__atomic_store_n(&blackBox->state_, lspc::BlackBoxTypes::READY, __ATOMIC_RELEASE);
+		blackBox->TransmitInfo();
+	}
+}
+
+void BlackBox::BlackBoxCommand_Callback(void * param, const lspc::MessageTypesFromPC::BlackBoxCommand_t& msg)
+{
+	BlackBox * blackBox = (BlackBox *)param;
+	if (!blackBox) return;
+
+	if (msg.command == lspc::BlackBoxTypes::TRIGGER)
+		blackBox->Trigger(lspc::BlackBoxTypes::MANUAL);
+	else if (msg.command == lspc::BlackBoxTypes::ARM)
+		blackBox->Arm();
+
+	blackBox->TransmitInfo();
+}
@@ -0,0 +1,71 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+ 
+ 
+#ifndef MODULES_BLACKBOX_H
+#define MODULES_BLACKBOX_H
+
+#include "cmsis_os.h"
+#include "LSPC.hpp"
+
+#define BLACKBOX_RECORDS				1024 // size of the circular buffer, 5 seconds at 200 Hz
+#define BLACKBOX_POST_TRIGGER_RECORDS	256  // records kept after the trigger, such that the recording also shows the consequences
+#define BLACKBOX_TILT_LIMIT_COS			0.866f // cosine of the 30 degree tilt which triggers the recorder while the controller is running
+#define BLACKBOX_THREAD_STACK			256
+
+/* On-board recorder of the internal signals of the balance controller, which can not be streamed over USB at full rate.
+ * The balance loop adds a fixed-size record every sample to a circular buffer in AXI SRAM (see the .blackbox section in the linker script).
+ * A trigger (NaN torque, tilt limit or a manual BlackBoxCommand) stops the recording BLACKBOX_POST_TRIGGER_RECORDS samples later.
+ * The recorder task then rotates the buffer to start with the oldest record and announces the recording with a BlackBoxInfo message,
+ * after which the PC dumps it in chunks as a BLACKBOX block transfer (see BlockTransfer). The recording is kept until the PC arms the recorder again.
+ * Record copies a single record and costs a bounded number of cycles, which is measured with the DWT cycle counter and reported in BlackBoxInfo. */
+class BlackBox
+{
+	public:
+		BlackBox(LSPC& com, uint32_t taskPriority);
+		~BlackBox();
+
+		void Record(const lspc::BlackBoxTypes::Record_t& record);
+		void Trigger(lspc::BlackBoxTypes::trigger_t cause);
+		bool Arm(void);
+		const uint8_t * GetRecording(uint32_t& size);
+
+	private:
+		void TransmitInfo(void);
+
+		static void Thread(void * pvParameters);
+		static void BlackBoxCommand_Callback(void * param, const lspc::MessageTypesFromPC::BlackBoxCommand_t& msg);
+
+	private:
+		LSPC& com_;
+		TaskHandle_t taskHandle_;
+
+		lspc::BlackBoxTypes::Record_t * records_;
+		uint32_t head_; // index of the next record to write
+		uint32_t count_; // number of records written since the recorder was armed, up to BLACKBOX_RECORDS
+		uint32_t postTriggerRemaining_;
+		uint32_t triggerRecord_;
+		lspc::BlackBoxTypes::state_t state_;
+		lspc::BlackBoxTypes::trigger_t trigger_;
+
+		uint32_t recordCycles_;
+		uint32_t maxRecordCycles_;
+};
+
+#endif
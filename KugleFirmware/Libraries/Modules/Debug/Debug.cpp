@@ -18,15 +18,19 @@
  */
  
 #include "Debug.h"
+#include "stm32h7xx_hal.h" // for __get_IPSR
 #include "cmsis_os.h"
 #include "LSPC.hpp"
+#include "Log.h"
+
+#define DEBUG_TEXT_PACKAGE_WORDS	(MAX_DEBUG_TEXT_LENGTH / 4)
  
 Debug * Debug::debugHandle = 0;
 
 // Necessary to export for compiler such that the Error_Handler function can be called by C code
 extern "C" __EXPORT void Error_Handler(void);
 
-Debug::Debug(void * com) : com_(com)
+Debug::Debug(void * com) : com_(com), _TaskHandle(0), textBuffer_(textMemory_, DEBUG_TEXT_BUFFER_SIZE), textDropped_(0), textDroppedReported_(0)
 {
 	if (debugHandle) {
 		ERROR("Debug object already created");
@@ -38,16 +42,7 @@ Debug::Debug(void * com) : com_(com)
 		return;
 	}
 
-	mutex_ = xSemaphoreCreateBinary();
-	if (mutex_ == NULL) {
-		ERROR("Could not create Debug mutex");
-		return;
-	}
-	vQueueAddToRegistry(mutex_, "Debug mutex");
-	xSemaphoreGive( mutex_ ); // give the semaphore the first time
-
-	currentBufferLocation_ = 0;
-	memset(messageBuffer_, 0, MAX_DEBUG_TEXT_LENGTH);
+	memset(textMemory_, 0, sizeof(textMemory_)); // the ring buffer has to be zero initialized
 	xTaskCreate( Debug::PackageGeneratorThread, (char *)"Debug transmitter", THREAD_STACK_SIZE, (void*) this, THREAD_PRIORITY, &_TaskHandle);
 
 	debugHandle = this;
@@ -59,55 +54,124 @@ Debug::~Debug()
 }
 
 
+/* The transmitter sleeps until a producer stores data in an empty buffer (see Notify).
+ * It then waits up to DEBUG_FLUSH_TIMEOUT for a package to fill up, before transmitting everything which has been stored. */
 void Debug::PackageGeneratorThread(void * pvParameters)
 {
 	Debug * debug = (Debug *)pvParameters;
 
 	while (1)
 	{
-		osDelay(1);
-		xSemaphoreTake( debug->mutex_, ( TickType_t ) portMAX_DELAY ); // take debug mutex
-		if (debug->currentBufferLocation_ > 0) {
-			((LSPC*)debug->com_)->TransmitAsync(lspc::MessageTypesToPC::Debug, (const uint8_t *)debug->messageBuffer_, debug->currentBufferLocation_);
-			debug->currentBufferLocation_ = 0;
+		if (debug->textBuffer_.GetPending() == 0 && Log::GetPending() == 0)
+			ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+		if (debug->textBuffer_.GetPending() < DEBUG_TEXT_PACKAGE_WORDS && Log::GetPending() < MAX_DEBUG_LOG_WORDS-1)
+			ulTaskNotifyTake(pdTRUE, DEBUG_FLUSH_TIMEOUT);
+
+		debug->TransmitText();
+		debug->TransmitLog();
+	}
+}
+
+void Debug::TransmitText(void)
+{
+	const uint32_t * record;
+	uint16_t packageLength = 0;
+
+	while ((record = textBuffer_.Peek()) != 0) {
+		uint16_t length = RecordBuffer::GetTag(record[0]);
+		if (packageLength + length > MAX_DEBUG_TEXT_LENGTH) {
+			((LSPC*)com_)->TransmitAsync(lspc::MessageTypesToPC::Debug, (const uint8_t *)textPackage_, packageLength);
+			packageLength = 0;
 		}
-		xSemaphoreGive( debug->mutex_ ); // give hardware resource back
+		memcpy(&textPackage_[packageLength], &record[1], length);
+		packageLength += length;
+		textBuffer_.Release();
+	}
+
+	uint32_t dropped = __atomic_load_n(&textDropped_, __ATOMIC_RELAXED);
+	if (dropped != textDroppedReported_) {
+		if (packageLength > MAX_DEBUG_TEXT_LENGTH - 40) {
+			((LSPC*)com_)->TransmitAsync(lspc::MessageTypesToPC::Debug, (const uint8_t *)textPackage_, packageLength);
+			packageLength = 0;
+		}
+		packageLength += snprintf(&textPackage_[packageLength], MAX_DEBUG_TEXT_LENGTH - packageLength, "\n[%lu debug messages dropped]\n", (unsigned long)(dropped - textDroppedReported_));
+		textDroppedReported_ = dropped;
+	}
+
+	if (packageLength > 0)
+		((LSPC*)com_)->TransmitAsync(lspc::MessageTypesToPC::Debug, (const uint8_t *)textPackage_, packageLength);
+}
+
+/* Send the binary log records, see Log.h */
+void Debug::TransmitLog(void)
+{
+	uint32_t logPackage[MAX_DEBUG_LOG_WORDS];
+	uint32_t logWords;
+
+	do {
+		logPackage[0] = Log::GetDropped();
+		logWords = Log::Read(&logPackage[1], MAX_DEBUG_LOG_WORDS-1);
+		if (logWords > 0)
+			((LSPC*)com_)->TransmitAsync(lspc::MessageTypesToPC::DebugLog, (const uint8_t *)logPackage, (logWords+1) * sizeof(uint32_t));
+	} while (logWords > 0);
+}
+
+/**
+ * @brief 	Wake the transmitter thread when a record has been stored in an empty buffer or when the buffer holds enough for a package.
+ *          Waking only at these two points keeps the notifications to at most two per package. Safe from interrupts.
+ * @param	pending        Input: words in the buffer before the record was stored
+ * @param	length         Input: record length in words
+ * @param	packageWords   Input: words which fill a package
+ */
+void Debug::Notify(uint32_t pending, uint32_t length, uint32_t packageWords)
+{
+	if (pending != 0 && (pending >= packageWords || pending + length < packageWords)) return;
+	if (!debugHandle || !debugHandle->_TaskHandle) return;
+
+	if (__get_IPSR() != 0) { // called from an interrupt
+		portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
+		vTaskNotifyGiveFromISR( debugHandle->_TaskHandle, &xHigherPriorityTaskWoken );
+		portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
+	} else {
+		xTaskNotifyGive( debugHandle->_TaskHandle );
 	}
 }
 
+/**
+ * @brief 	Store a text message for transmission. Messages longer than a package are split up.
+ *          If the buffer is full a task waits up to DEBUG_FULL_TIMEOUT for the transmitter to make room, while messages from
+ *          interrupts are dropped immediately. Dropped messages are reported with the next transmission.
+ */
 void Debug::Message(const char * msg)
 {
 	if (!debugHandle) return;
 	if (!debugHandle->com_) return;
 	if (!((LSPC*)debugHandle->com_)->Connected()) return;
 
-	xSemaphoreTake( debugHandle->mutex_, ( TickType_t ) portMAX_DELAY ); // take debug mutex
-
-	uint16_t stringLength = strlen(msg);
-	if (stringLength > MAX_DEBUG_TEXT_LENGTH) { // message is too long to fit in one package
-		// Send current buffered package now and clear buffer
-		((LSPC*)debugHandle->com_)->TransmitAsync(lspc::MessageTypesToPC::Debug, (const uint8_t *)debugHandle->messageBuffer_, debugHandle->currentBufferLocation_);
-		debugHandle->currentBufferLocation_ = 0;
-
-		uint8_t * msgPtr = (uint8_t *)msg;
-		while (stringLength > 0) { // split the message up in seperate packages
-			uint16_t sendLength = stringLength;
-			if (sendLength > MAX_DEBUG_TEXT_LENGTH) sendLength = MAX_DEBUG_TEXT_LENGTH;
-			((LSPC*)debugHandle->com_)->TransmitAsync(lspc::MessageTypesToPC::Debug, (const uint8_t *)msgPtr, sendLength);
-			msgPtr += sendLength;
-			stringLength -= sendLength;
-		}
-	} else { // package can fit in one package
-		if (stringLength > (MAX_DEBUG_TEXT_LENGTH-debugHandle->currentBufferLocation_)) {// stringLength = (MAX_DEBUG_TEXT_LENGTH-debugHandle->currentBufferLocation_); // "cut away" any parts above the maximum string length
-			// Send package now and clear buffer
-			((LSPC*)debugHandle->com_)->TransmitAsync(lspc::MessageTypesToPC::Debug, (const uint8_t *)debugHandle->messageBuffer_, debugHandle->currentBufferLocation_);
-			debugHandle->currentBufferLocation_ = 0;
+	size_t stringLength = strlen(msg);
+	while (stringLength > 0) {
+		uint16_t partLength = stringLength;
+		if (partLength > MAX_DEBUG_TEXT_LENGTH) partLength = MAX_DEBUG_TEXT_LENGTH;
+
+		uint32_t length = 1 + (partLength + sizeof(uint32_t) - 1) / sizeof(uint32_t); // header and text
+		uint32_t pending;
+		uint32_t * record;
+		for (int wait = 0; (record = debugHandle->textBuffer_.Reserve(length, &pending)) == 0; wait++) {
+			if (__get_IPSR() != 0 || wait >= DEBUG_FULL_TIMEOUT) {
+				__atomic_fetch_add(&debugHandle->textDropped_, 1, __ATOMIC_RELAXED);
+				return;
+			}
+			xTaskNotifyGive( debugHandle->_TaskHandle );
+			osDelay(1);
 		}
+		memcpy(&record[1], msg, partLength);
+		debugHandle->textBuffer_.Publish(record, length, partLength);
+		Notify(pending, length, DEBUG_TEXT_PACKAGE_WORDS);
 
-		memcpy(&debugHandle->messageBuffer_[debugHandle->currentBufferLocation_], msg, stringLength);
-		debugHandle->currentBufferLocation_ += stringLength;
+		msg += partLength;
+		stringLength -= partLength;
 	}
-	xSemaphoreGive( debugHandle->mutex_ ); // give hardware resource back
 }
 
 void Debug::Message(std::string msg)
@@ -146,6 +210,7 @@ void Debug::Message(const char * type, const char * functionName, const char * m
 
 void Debug::Message(std::string type, const char * functionName, std::string msg)
 {
+	Message(type.c_str());
 	Message("[");
 	Message(functionName);
 	Message("] ");
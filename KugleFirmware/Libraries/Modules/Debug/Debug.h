@@ -29,13 +29,18 @@
 #include <cstring>
 #include <string>
 
-#include "cmsis_os.h" // for semaphore
+#include "cmsis_os.h" // for task notifications
 #include "Priorities.h"
+#include "RecordBuffer.h"
 
 #define DEBUG(msg)	Debug::Message("DEBUG: ", __PRETTY_FUNCTION__, msg)
 #define ERROR(msg)	Debug::Error("ERROR: ", __PRETTY_FUNCTION__, msg)
 
 #define MAX_DEBUG_TEXT_LENGTH	210 // LSPC_MAXIMUM_PACKAGE_LENGTH
+#define MAX_DEBUG_LOG_WORDS		62 // LSPC_MAXIMUM_PACKAGE_LENGTH / 4
+#define DEBUG_TEXT_BUFFER_SIZE	512 // text ring buffer size in 32-bit words, must be a power of two
+#define DEBUG_FLUSH_TIMEOUT		5 // ms to wait for a package to fill up before it is transmitted
+#define DEBUG_FULL_TIMEOUT		20 // ms a task waits for space in the text buffer before the message is dropped
 
 class Debug
 {
@@ -56,17 +61,22 @@ class Debug
 		static void print(const char * msg);
 		static void printf( const char *msgFmt, ... );
 		static void Error(const char * type, const char * functionName, const char * msg);
+		static void Notify(uint32_t pending, uint32_t length, uint32_t packageWords);
 
 	private:
 		static void PackageGeneratorThread(void * pvParameters);
+		void TransmitText(void);
+		void TransmitLog(void);
 
 	private:
 		void * com_; // LSPC object pointer
-		SemaphoreHandle_t mutex_;
 		TaskHandle_t _TaskHandle;
 
-		char messageBuffer_[MAX_DEBUG_TEXT_LENGTH];
-		uint16_t currentBufferLocation_;
+		uint32_t textMemory_[DEBUG_TEXT_BUFFER_SIZE];
+		RecordBuffer textBuffer_;
+		uint32_t textDropped_; // number of text messages dropped because the buffer was full
+		uint32_t textDroppedReported_;
+		char textPackage_[MAX_DEBUG_TEXT_LENGTH];
 
 
 	public:
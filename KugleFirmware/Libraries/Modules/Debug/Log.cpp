@@ -0,0 +1,93 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+ 
+ 
+#include "Log.h"
+
+#ifndef LOG_HOST
+#include "Debug.h"
+#include "stm32h7xx_hal_timebase_tim.h" // for HAL_GetHighResTick
+#define LOG_TIMESTAMP()					HAL_GetHighResTick() // 10 kHz
+#define LOG_NOTIFY(pending, length)		Debug::Notify(pending, length, MAX_DEBUG_LOG_WORDS-1)
+#else
+#define LOG_TIMESTAMP()					0
+#define LOG_NOTIFY(pending, length)
+#endif
+
+static uint32_t logMemory[LOG_BUFFER_SIZE];
+static RecordBuffer logBuffer(logMemory, LOG_BUFFER_SIZE);
+static uint32_t logDropped = 0;
+
+/**
+ * @brief 	Store an encoded log record, called by Log::Write through the LOG macro
+ * @param	id         Input: format string id
+ * @param	args       Input: encoded arguments
+ * @param	count      Input: number of arguments
+ */
+void Log::Store(uint32_t id, const uint32_t * args, uint32_t count)
+{
+	uint32_t length = LOG_RECORD_WORDS + count;
+	uint32_t pending;
+
+	uint32_t * record = logBuffer.Reserve(length, &pending);
+	if (!record) {
+		__atomic_fetch_add(&logDropped, 1, __ATOMIC_RELAXED);
+		return;
+	}
+
+	record[1] = id;
+	record[2] = LOG_TIMESTAMP();
+	for (uint32_t i = 0; i < count; i++)
+		record[LOG_RECORD_WORDS + i] = args[i];
+	logBuffer.Publish(record, length);
+
+	LOG_NOTIFY(pending, length);
+}
+
+/**
+ * @brief 	Move published records out of the ring. Only one consumer may call this.
+ * @param	buffer     Output: records
+ * @param	maxWords   Input: size of the output buffer in words
+ * @retval	number of words copied
+ */
+uint32_t Log::Read(uint32_t * buffer, uint32_t maxWords)
+{
+	const uint32_t * record;
+	uint32_t copied = 0;
+
+	while ((record = logBuffer.Peek()) != 0) {
+		uint32_t length = RecordBuffer::GetLength(record[0]);
+		if (copied + length > maxWords) break;
+		memcpy(&buffer[copied], record, length * sizeof(uint32_t));
+		copied += length;
+		logBuffer.Release();
+	}
+
+	return copied;
+}
+
+uint32_t Log::GetPending(void)
+{
+	return logBuffer.GetPending();
+}
+
+uint32_t Log::GetDropped(void)
+{
+	return __atomic_load_n(&logDropped, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,88 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+ 
+
+#ifndef MODULES_LOG_H
+#define MODULES_LOG_H
+
+#include <stdint.h>
+#include <string.h>
+#include "RecordBuffer.h"
+
+#define LOG_BUFFER_SIZE		1024 // ring buffer size in 32-bit words, must be a power of two
+#define LOG_MAX_ARGUMENTS	16
+
+/* Record layout in the ring and in the DebugLog package (32-bit words): [header][format id][timestamp][arguments] */
+#define LOG_HEADER_VALID	RECORD_HEADER_VALID
+#define LOG_HEADER_LENGTH	RECORD_HEADER_LENGTH // record length in words including the header
+#define LOG_RECORD_WORDS	3 // header, format id and timestamp
+
+/* Deferred binary logging.
+ *     LOG("Applied torque: %4.2f\t%4.2f\t%4.2f\n", Torque[0], Torque[1], Torque[2]);
+ * The format string is placed in the non-loaded 'log_strings' section (see linker script) and its address is used as
+ * the format id, so it takes no flash and is never formatted on the MCU. The arguments are stored as raw 32-bit words
+ * (integers, float, double as float) in a lock-free ring, which is drained by the Debug transmitter thread.
+ * The PC rebuilds the text with LogDecoder.hpp from the section extracted with
+ *     arm-none-eabi-objcopy --dump-section log_strings=KugleFirmware.log_strings KugleFirmware.elf
+ * Strings (%s) are not supported. Log calls are safe from any task and from interrupts. */
+#define LOG(format, ...) do { \
+		static const char _logFormat[] __attribute__((section("log_strings"), used)) = format; \
+		Log::Write(LOG_FORMAT_ID(_logFormat), ##__VA_ARGS__); \
+	} while (0)
+
+#ifdef LOG_HOST // in a host build (see Tools/HostTests/LogTest.cpp) the section is loaded, so the id is the offset within the section
+extern "C" const char __start_log_strings[];
+#define LOG_FORMAT_ID(format)	((uint32_t)((format) - __start_log_strings))
+#else
+#define LOG_FORMAT_ID(format)	((uint32_t)(format))
+#endif
+
+class Log
+{
+	public:
+		template <typename... Args>
+		static void Write(uint32_t id, Args... args)
+		{
+			static_assert(sizeof...(Args) <= LOG_MAX_ARGUMENTS, "Too many log arguments");
+			const uint32_t words[sizeof...(Args) + 1] = { Encode(args)... }; // one extra element to allow zero arguments
+			Store(id, words, sizeof...(Args));
+		}
+
+		static void Store(uint32_t id, const uint32_t * args, uint32_t count);
+		static uint32_t Read(uint32_t * buffer, uint32_t maxWords);
+		static uint32_t GetPending(void);
+		static uint32_t GetDropped(void);
+
+	private:
+		static inline uint32_t Encode(float value) { uint32_t word; memcpy(&word, &value, sizeof(word)); return word; }
+		static inline uint32_t Encode(double value) { return Encode((float)value); }
+		static inline uint32_t Encode(bool value) { return value; }
+		static inline uint32_t Encode(char value) { return (uint32_t)(int32_t)value; }
+		static inline uint32_t Encode(signed char value) { return (uint32_t)(int32_t)value; }
+		static inline uint32_t Encode(unsigned char value) { return value; }
+		static inline uint32_t Encode(short value) { return (uint32_t)(int32_t)value; }
+		static inline uint32_t Encode(unsigned short value) { return value; }
+		static inline uint32_t Encode(int value) { return (uint32_t)value; }
+		static inline uint32_t Encode(unsigned int value) { return value; }
+		static inline uint32_t Encode(long value) { return (uint32_t)value; }
+		static inline uint32_t Encode(unsigned long value) { return (uint32_t)value; }
+		static uint32_t Encode(const char * value) = delete; // strings are not supported
+};
+
+#endif
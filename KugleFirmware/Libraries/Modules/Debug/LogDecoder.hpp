@@ -0,0 +1,134 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+ 
+
+#ifndef MODULES_LOGDECODER_H
+#define MODULES_LOGDECODER_H
+
+#include "Log.h"
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+/* PC side decoder of the DebugLog packages produced by the LOG macro (see Log.h).
+ * Header only, since it is not used by the firmware itself. The format table is the content of the 'log_strings'
+ * section of the firmware ELF file, in which the format id is the offset of the format string. */
+class LogDecoder
+{
+	public:
+		typedef struct {
+			uint32_t timestamp; // HAL_GetHighResTick, 10 kHz
+			std::string text;
+		} Record_t;
+
+		LogDecoder(const std::vector<char>& formats) : formats_(formats), dropped_(0) {};
+
+		/**
+		 * @brief 	Decode a DebugLog package
+		 * @param	payload    Input: package payload
+		 * @param	length     Input: payload length in bytes
+		 * @retval	decoded records, an empty text is returned for unknown format ids
+		 */
+		std::vector<Record_t> Decode(const uint8_t * payload, size_t length)
+		{
+			std::vector<Record_t> records;
+			if (length < sizeof(uint32_t)) return records;
+			memcpy(&dropped_, payload, sizeof(uint32_t));
+
+			std::vector<uint32_t> words((length - sizeof(uint32_t)) / sizeof(uint32_t));
+			if (!words.empty()) memcpy(words.data(), &payload[sizeof(uint32_t)], words.size() * sizeof(uint32_t));
+
+			size_t i = 0;
+			while (i + LOG_RECORD_WORDS <= words.size()) {
+				uint32_t recordLength = words[i] & LOG_HEADER_LENGTH;
+				if (!(words[i] & LOG_HEADER_VALID) || recordLength < LOG_RECORD_WORDS || i + recordLength > words.size()) break; // corrupt package
+
+				Record_t record;
+				record.timestamp = words[i+2];
+				uint32_t id = words[i+1];
+				if (id < formats_.size())
+					record.text = Format(&formats_[id], &words[i + LOG_RECORD_WORDS], recordLength - LOG_RECORD_WORDS);
+				records.push_back(record);
+				i += recordLength;
+			}
+			return records;
+		}
+
+		/* Number of records dropped by the firmware because the ring buffer was full, as of the latest package */
+		uint32_t GetDropped(void) const { return dropped_; }
+
+		/**
+		 * @brief 	Format a log record like printf, with the arguments given as encoded 32-bit words
+		 */
+		static std::string Format(const char * format, const uint32_t * args, uint32_t count)
+		{
+			std::string text;
+			uint32_t arg = 0;
+			char buffer[64];
+
+			while (*format) {
+				if (*format != '%') {
+					text += *format++;
+					continue;
+				}
+				if (format[1] == '%') {
+					text += '%';
+					format += 2;
+					continue;
+				}
+
+				/* Copy the conversion specification without length modifiers, eg. "%-8.3lf" becomes "%-8.3f" */
+				std::string spec = "%";
+				format++;
+				while (*format && strchr("-+ #0123456789.", *format)) spec += *format++;
+				while (*format && strchr("hlLqjzt", *format)) format++;
+				char conversion = *format;
+				if (!conversion) break;
+				format++;
+				spec += conversion;
+
+				if (arg >= count) {
+					text += "<?>";
+					continue;
+				}
+				uint32_t word = args[arg++];
+
+				if (strchr("di", conversion)) {
+					snprintf(buffer, sizeof(buffer), spec.c_str(), (int)(int32_t)word);
+				} else if (strchr("uoxXc", conversion)) {
+					snprintf(buffer, sizeof(buffer), spec.c_str(), (unsigned int)word);
+				} else if (strchr("fFeEgGaA", conversion)) {
+					float value;
+					memcpy(&value, &word, sizeof(value));
+					snprintf(buffer, sizeof(buffer), spec.c_str(), (double)value);
+				} else {
+					snprintf(buffer, sizeof(buffer), "<%%%c?>", conversion); // strings and pointers are not supported
+				}
+				text += buffer;
+			}
+
+			return text;
+		}
+
+	private:
+		std::vector<char> formats_;
+		uint32_t dropped_;
+};
+
+#endif
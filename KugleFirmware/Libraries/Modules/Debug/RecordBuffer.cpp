@@ -0,0 +1,106 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+ 
+ 
+#include "RecordBuffer.h"
+#include <string.h>
+
+/**
+ * @brief 	Reserve space for a record
+ * @param	length     Input: record length in words including the header
+ * @param	pending    Output: number of words in the ring before this record, eg. to decide when to wake the consumer
+ * @retval	pointer to the record to be filled in from index 1 and published, or 0 if the ring is full
+ */
+uint32_t * RecordBuffer::Reserve(uint32_t length, uint32_t * pending)
+{
+	uint32_t head, tail, start, reserved;
+
+	if (length == 0 || length > size_ || length > RECORD_HEADER_LENGTH) return 0;
+
+	do {
+		head = __atomic_load_n(&head_, __ATOMIC_RELAXED);
+		start = head;
+		reserved = length;
+		uint32_t offset = head & (size_-1);
+		if (offset + length > size_) { // the record does not fit before the end of the ring, so pad the rest
+			start += size_ - offset;
+			reserved += size_ - offset;
+		}
+		tail = __atomic_load_n(&tail_, __ATOMIC_ACQUIRE);
+		if (head + reserved - tail > size_) return 0; // full
+	} while (!__atomic_compare_exchange_n(&head_, &head, head + reserved, true, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED));
+
+	if (start != head)
+		__atomic_store_n(&buffer_[head & (size_-1)], RECORD_HEADER_VALID | RECORD_HEADER_PADDING | (start - head), __ATOMIC_RELEASE);
+
+	if (pending) *pending = head - tail;
+	return &buffer_[start & (size_-1)];
+}
+
+/**
+ * @brief 	Make a reserved record visible to the consumer
+ * @param	record     Input: pointer returned by Reserve
+ * @param	length     Input: record length in words, as given to Reserve
+ * @param	tag        Input: user value of at most 14 bits stored in the header
+ */
+void RecordBuffer::Publish(uint32_t * record, uint32_t length, uint32_t tag)
+{
+	__atomic_store_n(&record[0], RECORD_HEADER_VALID | ((tag << RECORD_HEADER_TAG_SHIFT) & RECORD_HEADER_TAG) | length, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief 	Get the oldest published record, which stays in the ring until Release is called
+ * @retval	pointer to the record header or 0 if no record has been published
+ */
+const uint32_t * RecordBuffer::Peek(void)
+{
+	uint32_t tail = tail_;
+
+	while (tail != __atomic_load_n(&head_, __ATOMIC_ACQUIRE)) {
+		uint32_t * record = &buffer_[tail & (size_-1)];
+		uint32_t header = __atomic_load_n(&record[0], __ATOMIC_ACQUIRE);
+		if (!(header & RECORD_HEADER_VALID)) break; // not published yet
+		if (!(header & RECORD_HEADER_PADDING)) return record;
+
+		record[0] = 0;
+		tail += GetLength(header);
+		__atomic_store_n(&tail_, tail, __ATOMIC_RELEASE);
+	}
+
+	return 0;
+}
+
+/**
+ * @brief 	Remove the record returned by Peek
+ */
+void RecordBuffer::Release(void)
+{
+	uint32_t * record = &buffer_[tail_ & (size_-1)];
+	uint32_t length = GetLength(record[0]);
+	memset(record, 0, length * sizeof(uint32_t));
+	__atomic_store_n(&tail_, tail_ + length, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief 	Get the number of words which are reserved or published but not yet released
+ */
+uint32_t RecordBuffer::GetPending(void) const
+{
+	return __atomic_load_n(&head_, __ATOMIC_ACQUIRE) - __atomic_load_n(&tail_, __ATOMIC_ACQUIRE);
+}
@@ -0,0 +1,61 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+ 
+
+#ifndef MODULES_RECORDBUFFER_H
+#define MODULES_RECORDBUFFER_H
+
+#include <stdint.h>
+
+/* Record layout (32-bit words): [header][payload] */
+#define RECORD_HEADER_VALID			0x80000000
+#define RECORD_HEADER_PADDING		0x40000000 // skip to the start of the ring
+#define RECORD_HEADER_TAG			0x3FFF0000 // user value stored with the record, eg. the payload length in bytes
+#define RECORD_HEADER_TAG_SHIFT		16
+#define RECORD_HEADER_LENGTH		0x0000FFFF // record length in words including the header
+
+/* Lock-free multiple producer, single consumer ring buffer of variable length records.
+ * Producers reserve space by advancing the head with a compare-and-swap, write the payload and publish the record by writing
+ * the header last. The consumer clears every word it has read, such that a reserved but not yet published record always has
+ * a zero header. Records are never split at the end of the ring, a padding record is inserted instead.
+ * Reserve and Publish are safe from any task and from interrupts, Peek and Release may only be called by one consumer.
+ * The memory has to be zero initialized and the size a power of two. */
+class RecordBuffer
+{
+	public:
+		constexpr RecordBuffer(uint32_t * buffer, uint32_t size) : buffer_(buffer), size_(size), head_(0), tail_(0) {};
+
+		uint32_t * Reserve(uint32_t length, uint32_t * pending = 0);
+		void Publish(uint32_t * record, uint32_t length, uint32_t tag = 0);
+		const uint32_t * Peek(void);
+		void Release(void);
+
+		uint32_t GetPending(void) const;
+
+		static inline uint32_t GetLength(uint32_t header) { return header & RECORD_HEADER_LENGTH; };
+		static inline uint32_t GetTag(uint32_t header) { return (header & RECORD_HEADER_TAG) >> RECORD_HEADER_TAG_SHIFT; };
+
+	private:
+		uint32_t * buffer_;
+		uint32_t size_; // in words
+		uint32_t head_; // next word to reserve (free running)
+		uint32_t tail_; // next word to read (free running)
+};
+
+#endif
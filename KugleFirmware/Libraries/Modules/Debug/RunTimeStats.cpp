@@ -0,0 +1,126 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+ 
+
+#include "RunTimeStats.h"
+#include "Debug.h"
+#include <string.h> // for memcpy
+
+RunTimeStats::RunTimeStats(LSPC& com) : com_(com), tasks_(0), tasksAllocated_(0), previousTotalRunTime_(0), previousTasks_(0), taskInfoTimestamp_(0)
+{
+}
+
+RunTimeStats::~RunTimeStats()
+{
+	if (tasks_)
+		vPortFree(tasks_);
+}
+
+/**
+ * @brief 	Sample the run time statistics of all tasks and send them in a RunTimeStats message
+ */
+void RunTimeStats::Transmit(void)
+{
+	/* The task status array is only reallocated when tasks have been created since the previous call */
+	uint32_t numberOfTasks = uxTaskGetNumberOfTasks();
+	if (numberOfTasks > tasksAllocated_) {
+		if (tasks_) vPortFree(tasks_);
+		tasksAllocated_ = numberOfTasks + 2; // leave room for a few tasks being created between the calls
+		tasks_ = (TaskStatus_t *)pvPortMalloc(tasksAllocated_ * sizeof(TaskStatus_t));
+		if (!tasks_) {
+			tasksAllocated_ = 0;
+			ERROR("Could not allocate run time statistics");
+			return;
+		}
+	}
+
+	uint32_t totalRunTime;
+	numberOfTasks = uxTaskGetSystemState(tasks_, tasksAllocated_, &totalRunTime);
+	if (numberOfTasks == 0) return; // tasks have been created in the meantime, so the array was too small
+
+	bool sendTaskInfo = (xTaskGetTickCount() - taskInfoTimestamp_) >= pdMS_TO_TICKS(RUNTIMESTATS_TASK_INFO_INTERVAL) || taskInfoTimestamp_ == 0;
+	if (sendTaskInfo)
+		taskInfoTimestamp_ = xTaskGetTickCount();
+
+	uint8_t msgBuf[LSPC_MAXIMUM_PACKAGE_LENGTH];
+	lspc::MessageTypesToPC::RunTimeStats_t header;
+	header.total_run_time = totalRunTime - previousTotalRunTime_;
+	header.tasks = (numberOfTasks < RUNTIMESTATS_MAX_TASKS) ? numberOfTasks : RUNTIMESTATS_MAX_TASKS;
+	header.total_tasks = numberOfTasks;
+	memcpy(msgBuf, &header, sizeof(header));
+
+	/* Fill in the entries and remember the current counters for the next deltas */
+	uint32_t currentTaskNumber[RUNTIMESTATS_MAX_TASKS];
+	uint32_t currentRunTime[RUNTIMESTATS_MAX_TASKS];
+	lspc::MessageTypesToPC::RunTimeStatsTask_t * entries = (lspc::MessageTypesToPC::RunTimeStatsTask_t *)&msgBuf[sizeof(header)];
+	for (uint32_t i = 0; i < header.tasks; i++) {
+		const TaskStatus_t& task = tasks_[i];
+		uint32_t previousRunTime = 0;
+		bool newTask = !GetPreviousRunTime(task.xTaskNumber, previousRunTime);
+
+		lspc::MessageTypesToPC::RunTimeStatsTask_t entry;
+		entry.run_time = task.ulRunTimeCounter - previousRunTime; // the unsigned difference is also valid across a counter overflow
+		entry.stack_high_water_mark = task.usStackHighWaterMark;
+		entry.task_number = task.xTaskNumber;
+		entry.state = task.eCurrentState;
+		entry.priority = task.uxCurrentPriority;
+		entry.base_priority = task.uxBasePriority;
+		memcpy(&entries[i], &entry, sizeof(entry));
+
+		if (sendTaskInfo || newTask)
+			TransmitTaskInfo(task);
+
+		currentTaskNumber[i] = task.xTaskNumber;
+		currentRunTime[i] = task.ulRunTimeCounter;
+	}
+
+	memcpy(previousTaskNumber_, currentTaskNumber, header.tasks * sizeof(uint32_t));
+	memcpy(previousRunTime_, currentRunTime, header.tasks * sizeof(uint32_t));
+	previousTasks_ = header.tasks;
+	previousTotalRunTime_ = totalRunTime;
+
+	com_.TransmitAsync(lspc::MessageTypesToPC::RunTimeStats, msgBuf, sizeof(header) + header.tasks * sizeof(lspc::MessageTypesToPC::RunTimeStatsTask_t));
+}
+
+/**
+ * @brief 	Get the run time counter of a task at the previous call to Transmit
+ * @param	taskNumber     Input: unique task number
+ * @param	runTime        Output: run time counter, unchanged if the task was not present
+ * @retval	true if the task was present
+ */
+bool RunTimeStats::GetPreviousRunTime(uint32_t taskNumber, uint32_t& runTime)
+{
+	for (uint32_t i = 0; i < previousTasks_; i++) {
+		if (previousTaskNumber_[i] == taskNumber) {
+			runTime = previousRunTime_[i];
+			return true;
+		}
+	}
+	return false;
+}
+
+void RunTimeStats::TransmitTaskInfo(const TaskStatus_t& task)
+{
+	LSPC::Message<lspc::MessageTypesToPC::TaskInfo> info(com_);
+	if (!info.Reserved()) return;
+	info->task_number = task.xTaskNumber;
+	strncpy(info->name, task.pcTaskName, sizeof(info->name));
+	info->name[sizeof(info->name)-1] = 0;
+	info.Transmit();
+}
@@ -0,0 +1,58 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+ 
+
+#ifndef MODULES_RUNTIMESTATS_H
+#define MODULES_RUNTIMESTATS_H
+
+#include "cmsis_os.h"
+#include "LSPC.hpp"
+
+#define RUNTIMESTATS_MAX_TASKS			((LSPC_MAXIMUM_PACKAGE_LENGTH - sizeof(lspc::MessageTypesToPC::RunTimeStats_t)) / sizeof(lspc::MessageTypesToPC::RunTimeStatsTask_t))
+#define RUNTIMESTATS_TASK_INFO_INTERVAL	10000 // resend the task names with this interval [ms], such that a PC connecting later can decode the statistics
+
+/* Binary replacement of vTaskGetRunTimeStats.
+ * Each call to Transmit samples the state of all tasks and sends the run time counter deltas since the previous call
+ * together with the stack high water mark, state and priority of each task. Formatting is left to the PC.
+ * The task names are sent in separate TaskInfo messages when a new task shows up and periodically. */
+class RunTimeStats
+{
+	public:
+		RunTimeStats(LSPC& com);
+		~RunTimeStats();
+
+		void Transmit(void);
+
+	private:
+		bool GetPreviousRunTime(uint32_t taskNumber, uint32_t& runTime);
+		void TransmitTaskInfo(const TaskStatus_t& task);
+
+	private:
+		LSPC& com_;
+		TaskStatus_t * tasks_;
+		uint32_t tasksAllocated_;
+
+		uint32_t previousTotalRunTime_;
+		uint32_t previousTaskNumber_[RUNTIMESTATS_MAX_TASKS];
+		uint32_t previousRunTime_[RUNTIMESTATS_MAX_TASKS];
+		uint32_t previousTasks_;
+		TickType_t taskInfoTimestamp_;
+};
+
+#endif
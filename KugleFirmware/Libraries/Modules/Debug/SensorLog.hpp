@@ -0,0 +1,277 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+ 
+ 
+
+#ifndef MODULES_SENSORLOG_H
+#define MODULES_SENSORLOG_H
+
+#include "MessageTypes.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* Binary sensor log of the balance controller, recorded on the PC from SensorSample packages and replayed by Tools/SensorReplay.
+ * Header only, since it is not used by the firmware itself.
+ *
+ * The file is made to be memory mapped and contains (all little endian, every part aligned to 8 bytes):
+ *   SensorLog_Header_t
+ *   parameter block (see Parameters::ReadBlock), as dumped with the PARAMETERS block transfer when the log was started
+ *   IMU calibration block, as dumped with the IMU_CALIBRATION block transfer
+ *   array of SensorSample_t in the order they were received
+ *   array of SensorLog_Index_t with every SENSORLOG_INDEX_INTERVAL'th sample, to find a sample by time
+ * The header and index are written when the log is closed. If the logger did not close the log,
+ * the samples are still read from a log with sampleCount = 0, but without the index. */
+#define SENSORLOG_MAGIC             0x474F4C53 // "SLOG"
+#define SENSORLOG_VERSION           1
+#define SENSORLOG_INDEX_INTERVAL    1000 // samples per index entry
+#define SENSORLOG_ALIGN(size)       (((size) + 7) & ~(uint64_t)7)
+
+typedef struct {
+	uint32_t magic;
+	uint16_t version;
+	uint16_t sampleSize; // sizeof(SensorSample_t)
+	uint32_t parametersSize;
+	uint32_t calibrationSize;
+	uint64_t parametersOffset; // byte offsets from the start of the file
+	uint64_t calibrationOffset;
+	uint64_t samplesOffset;
+	uint64_t sampleCount;
+	uint64_t indexOffset;
+	uint64_t indexCount;
+	uint64_t duration; // microseconds from the first to the last sample
+} SensorLog_Header_t;
+
+typedef struct {
+	uint64_t time; // microseconds since the first sample, i.e. the unwrapped sample timer
+	uint64_t sample;
+} SensorLog_Index_t;
+
+class SensorLogWriter
+{
+	public:
+		SensorLogWriter() : file_(0), time_(0), prevTimer_(0) { memset(&header_, 0, sizeof(header_)); };
+		~SensorLogWriter() { Close(); };
+
+		/**
+		 * @brief 	Create a log file
+		 * @param	filename          Input: path of the log file, which is overwritten
+		 * @param	parameters        Input: parameter block
+		 * @param	parametersSize    Input: size of the parameter block in bytes
+		 * @param	calibration       Input: IMU calibration block
+		 * @param	calibrationSize   Input: size of the IMU calibration block in bytes
+		 * @retval	true if the file was created
+		 */
+		bool Open(const char * filename, const uint8_t * parameters, uint32_t parametersSize, const uint8_t * calibration, uint32_t calibrationSize)
+		{
+			Close();
+			file_ = fopen(filename, "wb");
+			if (!file_) return false;
+
+			memset(&header_, 0, sizeof(header_));
+			header_.magic = SENSORLOG_MAGIC;
+			header_.version = SENSORLOG_VERSION;
+			header_.sampleSize = sizeof(lspc::MessageTypesToPC::SensorSample_t);
+			header_.parametersSize = parametersSize;
+			header_.calibrationSize = calibrationSize;
+			header_.parametersOffset = SENSORLOG_ALIGN(sizeof(header_));
+			header_.calibrationOffset = header_.parametersOffset + SENSORLOG_ALIGN(parametersSize);
+			header_.samplesOffset = header_.calibrationOffset + SENSORLOG_ALIGN(calibrationSize);
+			index_.clear();
+			time_ = 0;
+
+			bool success = Write(&header_, sizeof(header_)) && Write(parameters, parametersSize) && Write(calibration, calibrationSize);
+			if (!success) Close();
+			return success;
+		}
+
+		/**
+		 * @brief 	Append a sample
+		 * @param	sample     Input: payload of a SensorSample package
+		 * @param	length     Input: payload length in bytes
+		 * @retval	false if the payload is not a sensor sample or the file could not be written
+		 */
+		bool Append(const uint8_t * sample, uint32_t length)
+		{
+			lspc::MessageTypesToPC::SensorSample_t msg;
+			if (!file_ || length != sizeof(msg)) return false;
+			memcpy(&msg, sample, sizeof(msg));
+
+			if (header_.sampleCount > 0)
+				time_ += (uint32_t)(msg.timer - prevTimer_); // the timer wraps around at 32 bit
+			prevTimer_ = msg.timer;
+
+			if (header_.sampleCount % SENSORLOG_INDEX_INTERVAL == 0) {
+				SensorLog_Index_t entry = { time_, header_.sampleCount };
+				index_.push_back(entry);
+			}
+			if (fwrite(&msg, sizeof(msg), 1, file_) != 1) return false;
+			header_.sampleCount++;
+			header_.duration = time_;
+			return true;
+		}
+
+		/**
+		 * @brief 	Write the index and the final header and close the file
+		 * @retval	true if the log was written successfully
+		 */
+		bool Close(void)
+		{
+			if (!file_) return false;
+			uint64_t end = header_.samplesOffset + header_.sampleCount * header_.sampleSize;
+			header_.indexOffset = SENSORLOG_ALIGN(end);
+			header_.indexCount = index_.size();
+
+			bool success = Write(0, header_.indexOffset - end)
+						&& (index_.empty() || Write(index_.data(), index_.size() * sizeof(SensorLog_Index_t)))
+						&& fseek(file_, 0, SEEK_SET) == 0
+						&& fwrite(&header_, sizeof(header_), 1, file_) == 1;
+			success &= (fclose(file_) == 0);
+			file_ = 0;
+			return success;
+		}
+
+	private:
+		/* Write data followed by padding to the next 8 byte boundary, or only padding if data is 0 */
+		bool Write(const void * data, uint64_t size)
+		{
+			static const uint8_t padding[8] = {0};
+			if (data && size > 0 && fwrite(data, size, 1, file_) != 1) return false;
+			uint64_t pad = data ? SENSORLOG_ALIGN(size) - size : size;
+			return pad == 0 || fwrite(padding, pad, 1, file_) == 1;
+		}
+
+	private:
+		FILE * file_;
+		SensorLog_Header_t header_;
+		std::vector<SensorLog_Index_t> index_;
+		uint64_t time_;
+		uint32_t prevTimer_;
+};
+
+class SensorLogReader
+{
+	public:
+		SensorLogReader() : data_(0), size_(0), samples_(0), sampleCount_(0), index_(0), indexCount_(0) {};
+		~SensorLogReader() { Close(); };
+
+		/**
+		 * @brief 	Memory map a log file
+		 * @param	filename    Input: path of the log file
+		 * @retval	true if the file is a valid sensor log
+		 */
+		bool Open(const char * filename)
+		{
+			Close();
+			int fd = open(filename, O_RDONLY);
+			if (fd < 0) return false;
+			struct stat st;
+			if (fstat(fd, &st) == 0 && st.st_size >= (off_t)sizeof(SensorLog_Header_t)) {
+				size_ = st.st_size;
+				void * data = mmap(0, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+				data_ = (data == MAP_FAILED) ? 0 : (const uint8_t *)data;
+			}
+			close(fd);
+			if (!data_) return false;
+
+			const SensorLog_Header_t& header = GetHeader();
+			if (header.magic != SENSORLOG_MAGIC || header.version != SENSORLOG_VERSION || header.sampleSize != sizeof(lspc::MessageTypesToPC::SensorSample_t)
+				|| header.parametersOffset + header.parametersSize > size_ || header.calibrationOffset + header.calibrationSize > size_ || header.samplesOffset > size_) {
+				Close();
+				return false;
+			}
+
+			samples_ = (const lspc::MessageTypesToPC::SensorSample_t *)&data_[header.samplesOffset];
+			if (header.sampleCount > 0 && header.samplesOffset + header.sampleCount * header.sampleSize <= size_) {
+				sampleCount_ = header.sampleCount;
+				if (header.indexOffset + header.indexCount * sizeof(SensorLog_Index_t) <= size_) {
+					index_ = (const SensorLog_Index_t *)&data_[header.indexOffset];
+					indexCount_ = header.indexCount;
+				}
+			} else {
+				sampleCount_ = (size_ - header.samplesOffset) / header.sampleSize; // log was not closed
+			}
+			return true;
+		}
+
+		void Close(void)
+		{
+			if (data_) munmap((void *)data_, size_);
+			data_ = 0;
+			size_ = 0;
+			samples_ = 0;
+			sampleCount_ = 0;
+			index_ = 0;
+			indexCount_ = 0;
+		}
+
+		const SensorLog_Header_t& GetHeader(void) const { return *(const SensorLog_Header_t *)data_; }
+		const uint8_t * GetParameters(void) const { return &data_[GetHeader().parametersOffset]; }
+		uint32_t GetParametersSize(void) const { return GetHeader().parametersSize; }
+		const uint8_t * GetCalibration(void) const { return &data_[GetHeader().calibrationOffset]; }
+		uint32_t GetCalibrationSize(void) const { return GetHeader().calibrationSize; }
+
+		uint64_t GetSampleCount(void) const { return sampleCount_; }
+		const lspc::MessageTypesToPC::SensorSample_t& GetSample(uint64_t sample) const { return samples_[sample]; }
+
+		/**
+		 * @brief 	Find the first sample at or after a given time, using the index
+		 * @param	time    Input: microseconds since the first sample
+		 * @retval	sample number, GetSampleCount() if the time is beyond the end of the log
+		 */
+		uint64_t Find(uint64_t time) const
+		{
+			/* Find the last index entry at or before the time */
+			uint64_t sample = 0;
+			uint64_t sampleTime = 0;
+			uint64_t low = 0, high = indexCount_;
+			while (low < high) {
+				uint64_t mid = (low + high) / 2;
+				if (index_[mid].time <= time) low = mid + 1;
+				else high = mid;
+			}
+			if (low > 0) {
+				sample = index_[low-1].sample;
+				sampleTime = index_[low-1].time;
+			}
+
+			/* Continue sample by sample from there */
+			while (sample < sampleCount_ && sampleTime < time) {
+				sample++;
+				if (sample < sampleCount_)
+					sampleTime += (uint32_t)(samples_[sample].timer - samples_[sample-1].timer);
+			}
+			return sample;
+		}
+
+	private:
+		const uint8_t * data_;
+		uint64_t size_;
+		const lspc::MessageTypesToPC::SensorSample_t * samples_;
+		uint64_t sampleCount_;
+		const SensorLog_Index_t * index_;
+		uint64_t indexCount_;
+};
+
+#endif
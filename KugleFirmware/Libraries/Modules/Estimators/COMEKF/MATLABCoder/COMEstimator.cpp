@@ -13,8 +13,7 @@
 #include "rt_nonfinite.h"
 #include "COMEstimator.h"
 #include "SteadyStateAcceleration.h"
-#include "SteadyStateAcceleration_dq.h"
-#include "SteadyStateAcceleration_dCOM.h"
+#include "SteadyStateAccelerationJacobian.h"
 
 // Function Definitions
 
@@ -51,8 +50,8 @@
 __attribute__((optimize("O3"))) void COMEstimator(const float X[2], const float P_prev[4], const float
   qQEKF[4], const float Cov_qQEKF[16], const float qdotQEKF[4], const float
   Velocity[2], const float VelocityDiff[2], const float Cov_Velocity_meas[4],
-  float SamplePeriod, float Jk, float Mk, float rk, float Mb, float Jbx, float
-  Jby, float Jbz, float Jw, float rw, float Bvk, float Bvm, float Bvb, float l,
+  float SamplePeriod, float Jk, float Mk, float rk, float Mb, float /*Jbx*/, float
+  /*Jby*/, float /*Jbz*/, float Jw, float rw, float /*Bvk*/, float /*Bvm*/, float /*Bvb*/, float l,
   float g, float X_out[2], float P_out[4])
 {
   float b_P_prev[4];
@@ -253,15 +252,13 @@ __attribute__((optimize("O3"))) void COMEstimator(const float X[2], const float
   // 'COMEstimator:59' z_hat = acceleration;
   //  Measurement Jacobian	
   // 'COMEstimator:62' dAcceleration_dCOM = SteadyStateAcceleration_dCOM(xCOM_apriori,yCOM_apriori,l,Jk,Mb,Mk,g,qQEKF(1),qQEKF(2),qQEKF(3),qQEKF(4),rk); 
-  SteadyStateAcceleration_dCOM(X[0], X[1], l, Jk, Mb, Mk, g, qQEKF[0], qQEKF[1],
-    qQEKF[2], qQEKF[3], rk, dAcceleration_dCOM);
+  // 'COMEstimator:66' dAcceleration_dqB = SteadyStateAcceleration_dq(xCOM_apriori,yCOM_apriori,l,Jk,Mb,Mk,g,qQEKF(1),qQEKF(2),qQEKF(3),qQEKF(4),rk); 
+  //  Both Jacobians are computed in a single pass with forward-mode automatic differentiation
+  SteadyStateAcceleration_Jacobian(X[0], X[1], l, Jk, Mb, Mk, g, qQEKF[0], qQEKF[1],
+    qQEKF[2], qQEKF[3], rk, dAcceleration_dqB, dAcceleration_dCOM);
 
   // 'COMEstimator:63' H = dAcceleration_dCOM;
   //  Measurement covariance
-  // 'COMEstimator:66' dAcceleration_dqB = SteadyStateAcceleration_dq(xCOM_apriori,yCOM_apriori,l,Jk,Mb,Mk,g,qQEKF(1),qQEKF(2),qQEKF(3),qQEKF(4),rk); 
-  SteadyStateAcceleration_dq(X[0], X[1], l, Jk, Mb, Mk, g, qQEKF[0], qQEKF[1],
-    qQEKF[2], qQEKF[3], rk, dAcceleration_dqB);
-
   // 'COMEstimator:67' cov_acceleration_uncertainty = dt^2 * dAcceleration_dqB * Cov_qQEKF * dAcceleration_dqB'; 
   a21 = SamplePeriod * SamplePeriod;
 
@@ -22,11 +22,14 @@
 
 #include "Parameters.h"
 #include "Timer.h"
+#include <math.h>
 
 class Kinematics
 {
 	private:
+#ifndef M_PI // not defined by the C library in strict ANSI mode, but by most host C libraries
 		const double M_PI = 3.14159265358979323846264338327950288;
+#endif
 
 	public:
 		Kinematics(Parameters& params, Timer * microsTimer);
@@ -0,0 +1,456 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+ 
+ 
+#include "MEKF.h"
+#include "Math.h"
+#include "Matrix.h"
+#include <string.h> // for memcpy
+#include <math.h>
+ 
+#include "Quaternion.h"
+
+MEKF::MEKF(Parameters& params, Timer * microsTimer) : _params(params), _microsTimer(microsTimer)
+{
+	Reset();
+}
+
+MEKF::MEKF(Parameters& params) : _params(params), _microsTimer(0)
+{
+	Reset();
+}
+
+MEKF::~MEKF()
+{
+}
+
+void MEKF::Reset()
+{
+	X[0] = 1; // initialize as unit quaternion
+	X[1] = 0;
+	X[2] = 0;
+	X[3] = 0;
+	X[4] = 0;
+	X[5] = 0;
+
+	dq[0] = 0;
+	dq[1] = 0;
+	dq[2] = 0;
+	dq[3] = 0;
+
+	memset(P, 0, sizeof(P));
+	for (int i = 0; i < 5; i++) {
+		P[Matrix_SymmetricIndex(5, i, i)] = _params.estimator.MEKF_P_init_diagonal[i];
+	}
+
+	memcpy(cov_gyro_, _params.estimator.cov_gyro_mpu, sizeof(cov_gyro_));
+
+	if (_microsTimer)
+		_prevTimerValue = _microsTimer->Get();
+	else
+		_prevTimerValue = 0;
+}
+
+/**
+ * @brief 	Reset attitude estimator to an angle based on an accelerometer measurement
+ * @param	accelerometer[3]   Input: acceleration measurement in body frame [m/s^2]
+ */
+void MEKF::Reset(const float /*accelerometer*/[3])
+{
+	Reset();
+}
+
+/**
+ * @brief 	Estimate attitude quaternion given accelerometer and gyroscope measurements
+ * @param	accelerometer[3]   Input: acceleration measurement in body frame [m/s^2]
+ * @param	gyroscope[3]       Input: angular velocity measurement in body frame [rad/s]
+ */
+void MEKF::Step(const float accelerometer[3], const float gyroscope[3])
+{
+	Step(accelerometer, gyroscope, _params.estimator.EstimateBias);
+}
+
+/**
+ * @brief 	Estimate attitude quaternion given accelerometer and gyroscope measurements
+ * @param	accelerometer[3]   Input: acceleration measurement in body frame [m/s^2]
+ * @param	gyroscope[3]       Input: angular velocity measurement in body frame [rad/s]
+ * @param   EstimateBias       Input: flag to control if gyroscope bias should be estimated
+ */
+void MEKF::Step(const float accelerometer[3], const float gyroscope[3], const bool EstimateBias)
+{
+	float dt;
+
+	if (!_microsTimer) return; // timer not defined
+	dt = _microsTimer->GetDeltaTime(_prevTimerValue);
+	_prevTimerValue = _microsTimer->Get();
+
+	Step(accelerometer, gyroscope, EstimateBias, dt);
+}
+
+/**
+ * @brief 	Estimate attitude quaternion given accelerometer and gyroscope measurements and passed time
+ * @param	accelerometer[3]   Input: acceleration measurement in body frame [m/s^2]
+ * @param	gyroscope[3]       Input: angular velocity measurement in body frame [rad/s]
+ * @param   EstimateBias       Input: flag to control if gyroscope bias should be estimated
+ * @param	dt    			   Input: time passed since last estimate
+ */
+void MEKF::Step(const float accelerometer[3], const float gyroscope[3], const bool EstimateBias, const float dt)
+{
+	Step(accelerometer, gyroscope, EstimateBias, _params.estimator.CreateQdotFromQDifference, _params.estimator.cov_acc_mpu, _params.estimator.cov_gyro_mpu, _params.estimator.sigma2_bias, _params.model.g, dt);
+}
+
+/**
+ * @brief 	Estimate attitude quaternion given accelerometer and gyroscope measurements and passed time
+ * @param	accelerometer[3]   Input: acceleration measurement in body frame [m/s^2]
+ * @param	gyroscope[3]       Input: angular velocity measurement in body frame [rad/s]
+ * @param   EstimateBias       Input: flag to control if gyroscope bias should be estimated
+ * @param   CreateQdotFromDifference  Input: flag to control if qdot estimate is generated by differentiating q estimate
+ * @param   cov_acc            Input: accelerometer sensor covariance matrix
+ * @param   cov_gyro           Input: gyroscope sensor covariance matrix
+ * @param   sigma2_bias        Input: bias variance (random walk)
+ * @param   g                  Input: gravity constant [m/s^2] (not used since the accelerometer measurement is normalized)
+ * @param	dt    			   Input: time passed since last estimate
+ */
+void MEKF::Step(const float accelerometer[3], const float gyroscope[3], const bool EstimateBias, const bool CreateQdotFromDifference, const float cov_acc[9], const float cov_gyro[9], const float sigma2_bias, const float /*g*/, const float dt)
+{
+	if (dt == 0) return; // no time has passed
+
+	const float Bias = EstimateBias ? 1.f : 0.f;
+
+	float q_prev[4];
+	memcpy(q_prev, X, sizeof(q_prev));
+	memcpy(cov_gyro_, cov_gyro, sizeof(cov_gyro_));
+
+	/* Measurement vector (normalized accelerometer) */
+	float z[3] = {0, 0, 0};
+	float norm2_acc = accelerometer[0]*accelerometer[0] + accelerometer[1]*accelerometer[1] + accelerometer[2]*accelerometer[2];
+	if (norm2_acc > 0) {
+		float inv_norm_acc = 1.f / sqrtf(norm2_acc);
+		z[0] = accelerometer[0] * inv_norm_acc;
+		z[1] = accelerometer[1] * inv_norm_acc;
+		z[2] = accelerometer[2] * inv_norm_acc;
+	}
+
+	/* Prediction step - propagate the nominal quaternion with the bias corrected angular velocity:  q_apriori = q o exp([0; omega*dt/2])
+	 * The rotation within one sample is small, so the exponential is expanded to second order instead of evaluating sin and cos */
+	float omega[3] = {gyroscope[0] - X[4], gyroscope[1] - X[5], gyroscope[2]};
+	float q_apriori[4];
+	float q_exp[4] = {0, 0.5f*dt*omega[0], 0.5f*dt*omega[1], 0.5f*dt*omega[2]};
+	q_exp[0] = 1 - 0.5f*(q_exp[1]*q_exp[1] + q_exp[2]*q_exp[2] + q_exp[3]*q_exp[3]);
+	Quaternion_Phi(X, q_exp, q_apriori);
+
+	/* P_apriori = F * P * F' + Q  with the error-state Jacobian and process covariance
+	 * F = [ A,            B                 ]    A = eye(3) - dt*[omega x],  B = -dt*Bias*[eye(2); zeros(1,2)]
+	 *     [ zeros(2,3),   Bias*eye(2)       ]
+	 * Q = blkdiag(dt^2 * cov_gyro, sigma2_bias*dt*Bias*eye(2))
+	 * Only the non-zero blocks of F are multiplied. With P = [Paa, Pab; Pab', Pbb]:
+	 *   M = A*Paa + B*Pab',  N = A*Pab + B*Pbb
+	 *   P_apriori = [ M*A' + N*B' + Qaa,   Bias*N ;   Bias*N',   Bias^2*Pbb + Qbb ] */
+	float Paa[3][3], Pab[3][2];
+	for (int i = 0; i < 3; i++) {
+		for (int j = 0; j < 3; j++) Paa[i][j] = P[Matrix_SymmetricIndex(5, i, j)];
+		for (int j = 0; j < 2; j++) Pab[i][j] = P[Matrix_SymmetricIndex(5, i, 3 + j)];
+	}
+	const float wx = dt*omega[0], wy = dt*omega[1], wz = dt*omega[2];
+	const float Bdt = dt * Bias;
+
+	/* A*X = X - [w x]*X  for each column of X */
+	float M[3][3], N[3][2];
+	for (int j = 0; j < 3; j++) {
+		M[0][j] = Paa[0][j] + wz*Paa[1][j] - wy*Paa[2][j] - Bdt*Pab[j][0];
+		M[1][j] = Paa[1][j] - wz*Paa[0][j] + wx*Paa[2][j] - Bdt*Pab[j][1];
+		M[2][j] = Paa[2][j] + wy*Paa[0][j] - wx*Paa[1][j];
+	}
+	const float Pbb00 = P[Matrix_SymmetricIndex(5, 3, 3)], Pbb01 = P[Matrix_SymmetricIndex(5, 3, 4)], Pbb11 = P[Matrix_SymmetricIndex(5, 4, 4)];
+	for (int j = 0; j < 2; j++) {
+		float Pbb0j = (j == 0) ? Pbb00 : Pbb01;
+		float Pbb1j = (j == 0) ? Pbb01 : Pbb11;
+		N[0][j] = Pab[0][j] + wz*Pab[1][j] - wy*Pab[2][j] - Bdt*Pbb0j;
+		N[1][j] = Pab[1][j] - wz*Pab[0][j] + wx*Pab[2][j] - Bdt*Pbb1j;
+		N[2][j] = Pab[2][j] + wy*Pab[0][j] - wx*Pab[1][j];
+	}
+
+	float P_apriori[MATRIX_SYMMETRIC_SIZE(5)];
+	for (int i = 0; i < 3; i++) {
+		/* (M*A')[i][j] = M[i][j] - ([w x]*M[i][:]')[j] */
+		float MAt[3] = {
+			M[i][0] + wz*M[i][1] - wy*M[i][2],
+			M[i][1] - wz*M[i][0] + wx*M[i][2],
+			M[i][2] + wy*M[i][0] - wx*M[i][1]
+		};
+		MAt[0] -= Bdt * N[i][0]; // N*B'
+		MAt[1] -= Bdt * N[i][1];
+		for (int j = i; j < 3; j++)
+			P_apriori[Matrix_SymmetricIndex(5, i, j)] = MAt[j] + dt*dt * cov_gyro[3*i + j];
+		P_apriori[Matrix_SymmetricIndex(5, i, 3)] = Bias * N[i][0];
+		P_apriori[Matrix_SymmetricIndex(5, i, 4)] = Bias * N[i][1];
+	}
+	P_apriori[Matrix_SymmetricIndex(5, 3, 3)] = Bias*Bias * Pbb00 + sigma2_bias * dt * Bias;
+	P_apriori[Matrix_SymmetricIndex(5, 3, 4)] = Bias*Bias * Pbb01;
+	P_apriori[Matrix_SymmetricIndex(5, 4, 4)] = Bias*Bias * Pbb11 + sigma2_bias * dt * Bias;
+
+	/* Update/correction step */
+	/* Accelerometer measurement model (gravity direction in body frame):  z_hat = devec * Phi(q_apriori)' * Gamma(q_apriori) * [0;0;0;1] */
+	float z_hat[3];
+	z_hat[0] = 2*(q_apriori[1]*q_apriori[3] - q_apriori[0]*q_apriori[2]);
+	z_hat[1] = 2*(q_apriori[2]*q_apriori[3] + q_apriori[0]*q_apriori[1]);
+	z_hat[2] = q_apriori[0]*q_apriori[0] - q_apriori[1]*q_apriori[1] - q_apriori[2]*q_apriori[2] + q_apriori[3]*q_apriori[3];
+
+	/* Measurement Jacobian:  H = [[z_hat x], zeros(3,2)]  since  z = (eye(3) - [dtheta x]) * z_hat = z_hat + [z_hat x] * dtheta
+	 * so H*x is the cross product of z_hat with the attitude part of x */
+
+	/* PHt = P_apriori * H',  row i is  z_hat x P_apriori[i][0:2] */
+	float PHt[5*3];
+	for (int i = 0; i < 5; i++) {
+		float p0 = P_apriori[Matrix_SymmetricIndex(5, i, 0)], p1 = P_apriori[Matrix_SymmetricIndex(5, i, 1)], p2 = P_apriori[Matrix_SymmetricIndex(5, i, 2)];
+		PHt[3*i + 0] = z_hat[1]*p2 - z_hat[2]*p1;
+		PHt[3*i + 1] = z_hat[2]*p0 - z_hat[0]*p2;
+		PHt[3*i + 2] = z_hat[0]*p1 - z_hat[1]*p0;
+	}
+
+	/* S = H * P_apriori * H' + R,  column j is  z_hat x PHt[0:2][j] */
+	float S[3*3];
+	for (int j = 0; j < 3; j++) {
+		float c0 = PHt[3*0 + j], c1 = PHt[3*1 + j], c2 = PHt[3*2 + j];
+		S[3*0 + j] = z_hat[1]*c2 - z_hat[2]*c1 + cov_acc[3*0 + j];
+		S[3*1 + j] = z_hat[2]*c0 - z_hat[0]*c2 + cov_acc[3*1 + j];
+		S[3*2 + j] = z_hat[0]*c1 - z_hat[1]*c0 + cov_acc[3*2 + j];
+	}
+
+	/* K = P_apriori * H' / S */
+	float Sinv[3*3];
+	Matrix_SymmetricInverse3x3(S, Sinv);
+
+	float K[5*3];
+	for (int i = 0; i < 5; i++) {
+		for (int j = 0; j < 3; j++) {
+			K[3*i + j] = PHt[3*i + 0]*Sinv[3*0 + j] + PHt[3*i + 1]*Sinv[3*1 + j] + PHt[3*i + 2]*Sinv[3*2 + j];
+		}
+	}
+
+	/* Error-state estimate:  dX = K * (z - z_hat) */
+	float innovation[3] = {z[0] - z_hat[0], z[1] - z_hat[1], z[2] - z_hat[2]};
+	float dX[5];
+	for (int i = 0; i < 5; i++) {
+		dX[i] = K[3*i + 0]*innovation[0] + K[3*i + 1]*innovation[1] + K[3*i + 2]*innovation[2];
+	}
+
+	/* P_aposteriori = (eye(5) - K*H) * P_apriori = P_apriori - K * PHt'   or in Joseph form   (eye(5) - K*H) * P_apriori * (eye(5) - K*H)' + K*R*K' */
+	if (_params.estimator.UseJosephForm) {
+		float H[3*5] = {
+			0,          -z_hat[2],   z_hat[1],   0, 0,
+			z_hat[2],   0,          -z_hat[0],   0, 0,
+			-z_hat[1],  z_hat[0],    0,          0, 0
+		};
+		Matrix_SymmetricJosephUpdate(P_apriori, H, K, cov_acc, 5, 3, P);
+	} else {
+		for (int i = 0; i < 5; i++) {
+			for (int j = i; j < 5; j++) {
+				P[Matrix_SymmetricIndex(5, i, j)] = P_apriori[Matrix_SymmetricIndex(5, i, j)] - (K[3*i + 0]*PHt[3*j + 0] + K[3*i + 1]*PHt[3*j + 1] + K[3*i + 2]*PHt[3*j + 2]);
+			}
+		}
+	}
+
+	/* Inject the error-state into the nominal state:  q = q_apriori o exp([0; dtheta/2])  and reset the error-state to zero */
+	float dq_err[4] = {0, 0.5f*dX[0], 0.5f*dX[1], 0.5f*dX[2]};
+	dq_err[0] = 1 - 0.5f*(dq_err[1]*dq_err[1] + dq_err[2]*dq_err[2] + dq_err[3]*dq_err[3]);
+	Quaternion_Phi(q_apriori, dq_err, X);
+
+	/* The second order exponentials keep the norm within O(angle^4) of one, so a Newton step of 1/sqrt(norm^2) normalizes it */
+	float norm2_q = X[0]*X[0] + X[1]*X[1] + X[2]*X[2] + X[3]*X[3];
+	float scale = (fabsf(norm2_q - 1) < 1E-2f) ? 1.5f - 0.5f*norm2_q : 1.f / sqrtf(norm2_q);
+	X[0] *= scale;
+	X[1] *= scale;
+	X[2] *= scale;
+	X[3] *= scale;
+
+	X[4] += Bias * dX[3];
+	X[5] += Bias * dX[4];
+
+	/* Quaternion derivative */
+	if (CreateQdotFromDifference) {
+		dq[0] = (X[0] - q_prev[0]) / dt;
+		dq[1] = (X[1] - q_prev[1]) / dt;
+		dq[2] = (X[2] - q_prev[2]) / dt;
+		dq[3] = (X[3] - q_prev[3]) / dt;
+	} else {
+		/* dq = 1/2 * Phi(q) * [0; omega]  using the updated bias estimate */
+		float omega_q[4] = {0, gyroscope[0] - X[4], gyroscope[1] - X[5], gyroscope[2]};
+		Quaternion_Phi(X, omega_q, dq);
+		dq[0] *= 0.5f;
+		dq[1] *= 0.5f;
+		dq[2] *= 0.5f;
+		dq[3] *= 0.5f;
+	}
+}
+
+/**
+ * @brief 	Get estimated attitude quaternion
+ * @param	q[4]		Output: estimated attitude quaternion
+ */
+void MEKF::GetQuaternion(float q[4])
+{
+	q[0] = X[0];
+	q[1] = X[1];
+	q[2] = X[2];
+	q[3] = X[3];
+}
+
+/**
+ * @brief 	Get estimated attitude quaternion derivative
+ * @param	dq[4]		Output: estimated attitude quaternion derivative
+ */
+void MEKF::GetQuaternionDerivative(float dq_out[4])
+{
+	dq_out[0] = dq[0];
+	dq_out[1] = dq[1];
+	dq_out[2] = dq[2];
+	dq_out[3] = dq[3];
+}
+
+/**
+ * @brief 	Get covariance matrix of estimated quaternion
+ *          Computed from the attitude error covariance as  Cov_q = G * Cov_dtheta * G'  with  G = 1/2 * Phi(q) * [zeros(1,3); eye(3)]
+ * @param	Cov_q[4*4]		Output: quaternion estimate covariance
+ */
+void MEKF::GetQuaternionCovariance(float Cov_q[4*4])
+{
+	float G[4*3] = {
+		-0.5f*X[1], -0.5f*X[2], -0.5f*X[3],
+		 0.5f*X[0], -0.5f*X[3],  0.5f*X[2],
+		 0.5f*X[3],  0.5f*X[0], -0.5f*X[1],
+		-0.5f*X[2],  0.5f*X[1],  0.5f*X[0]
+	};
+
+	float GP[4*3];
+	for (int m = 0; m < 4; m++) {
+		for (int n = 0; n < 3; n++) {
+			GP[3*m + n] = G[3*m + 0]*P[Matrix_SymmetricIndex(5, 0, n)] + G[3*m + 1]*P[Matrix_SymmetricIndex(5, 1, n)] + G[3*m + 2]*P[Matrix_SymmetricIndex(5, 2, n)];
+		}
+	}
+
+	for (int m = 0; m < 4; m++) {
+		for (int n = m; n < 4; n++) {
+			Cov_q[4*m + n] = GP[3*m + 0]*G[3*n + 0] + GP[3*m + 1]*G[3*n + 1] + GP[3*m + 2]*G[3*n + 2];
+			Cov_q[4*n + m] = Cov_q[4*m + n];
+		}
+	}
+}
+
+/**
+ * @brief 	Get covariance matrix of estimated quaternion derivative
+ *          Computed from the gyroscope and bias covariance as  Cov_dq = G * (cov_gyro + [eye(2); zeros(1,2)] * Cov_bias * [eye(2), zeros(2,1)]) * G'
+ * @param	Cov_dq[4*4]		Output: quaternion derivative estimate covariance
+ */
+void MEKF::GetQuaternionDerivativeCovariance(float Cov_dq[4*4])
+{
+	float G[4*3] = {
+		-0.5f*X[1], -0.5f*X[2], -0.5f*X[3],
+		 0.5f*X[0], -0.5f*X[3],  0.5f*X[2],
+		 0.5f*X[3],  0.5f*X[0], -0.5f*X[1],
+		-0.5f*X[2],  0.5f*X[1],  0.5f*X[0]
+	};
+
+	float cov_omega[3*3];
+	memcpy(cov_omega, cov_gyro_, sizeof(cov_omega));
+	cov_omega[0] += P[Matrix_SymmetricIndex(5, 3, 3)];
+	cov_omega[1] += P[Matrix_SymmetricIndex(5, 3, 4)];
+	cov_omega[3] += P[Matrix_SymmetricIndex(5, 3, 4)];
+	cov_omega[4] += P[Matrix_SymmetricIndex(5, 4, 4)];
+
+	float GC[4*3];
+	for (int m = 0; m < 4; m++) {
+		for (int n = 0; n < 3; n++) {
+			GC[3*m + n] = G[3*m + 0]*cov_omega[3*0 + n] + G[3*m + 1]*cov_omega[3*1 + n] + G[3*m + 2]*cov_omega[3*2 + n];
+		}
+	}
+
+	for (int m = 0; m < 4; m++) {
+		for (int n = m; n < 4; n++) {
+			Cov_dq[4*m + n] = GC[3*m + 0]*G[3*n + 0] + GC[3*m + 1]*G[3*n + 1] + GC[3*m + 2]*G[3*n + 2];
+			Cov_dq[4*n + m] = Cov_dq[4*m + n];
+		}
+	}
+}
+
+bool MEKF::UnitTest(void)
+{
+	const float g = 9.82f;
+
+	const float cov_gyro_mpu[9] = {0.2529E-03,   -0.0064E-03,    0.1981E-03,
+								  -0.0064E-03,    0.9379E-03,   -0.0038E-03,
+								   0.1981E-03,   -0.0038E-03,    1.6828E-03};
+	const float cov_acc_mpu[9] = {0.4273E-03,    0.0072E-03,    0.0096E-03,
+								  0.0072E-03,    0.4333E-03,    0.0041E-03,
+								  0.0096E-03,    0.0041E-03,    1.0326E-03};
+
+	const float sigma2_bias = 1E-11;
+	const float dt = 1.0 / 400.0; // 400 Hz
+
+	/* Test 1: Convergence to a constant 5 degree roll angle given by the accelerometer */
+	Reset();
+
+	const float roll = deg2rad(5.f);
+	const float Accelerometer[3] = {0, g*sinf(roll), g*cosf(roll)};
+	const float Gyroscope[3] = {0, 0, 0};
+
+	for (int i = 0; i < 2000; i++)
+		Step(Accelerometer, Gyroscope, false, false, cov_acc_mpu, cov_gyro_mpu, sigma2_bias, g, dt);
+
+	float q[4];
+	GetQuaternion(q);
+
+	const float q_expected[4] = {cosf(roll/2), sinf(roll/2), 0, 0};
+	for (int i = 0; i < 4; i++) {
+		if (fabsf(q[i] - q_expected[i]) > 1E-3) return false;
+	}
+
+	/* Test 2: Yaw integration (unobservable from the accelerometer) with a constant angular velocity, starting from upright */
+	Reset();
+
+	const float AccelerometerUpright[3] = {0, 0, g};
+	const float GyroscopeYaw[3] = {0, 0, 0.5};
+
+	for (int i = 0; i < 400; i++)
+		Step(AccelerometerUpright, GyroscopeYaw, false, false, cov_acc_mpu, cov_gyro_mpu, sigma2_bias, g, dt);
+
+	GetQuaternion(q);
+
+	float dq_est[4];
+	GetQuaternionDerivative(dq_est);
+
+	const float yaw = 0.5f * 400 * dt;
+	const float q_yaw_expected[4] = {cosf(yaw/2), 0, 0, sinf(yaw/2)};
+	const float dq_yaw_expected[4] = {-0.25f*sinf(yaw/2), 0, 0, 0.25f*cosf(yaw/2)};
+	for (int i = 0; i < 4; i++) {
+		if (fabsf(q[i] - q_yaw_expected[i]) > 1E-4) return false;
+		if (fabsf(dq_est[i] - dq_yaw_expected[i]) > 1E-4) return false;
+	}
+
+	/* The quaternion covariance should be positive semi-definite, hence with a non-negative diagonal */
+	float Cov_q[4*4];
+	GetQuaternionCovariance(Cov_q);
+	for (int i = 0; i < 4; i++) {
+		if (Cov_q[5*i] < 0) return false;
+	}
+
+	Reset();
+
+	return true;
+}
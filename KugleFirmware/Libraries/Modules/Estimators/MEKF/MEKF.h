@@ -0,0 +1,67 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+ 
+#ifndef MODULES_ESTIMATORS_MEKF_H
+#define MODULES_ESTIMATORS_MEKF_H
+
+#include "Parameters.h"
+#include "Timer.h"
+#include "Matrix.h"
+
+/* Multiplicative error-state EKF (MEKF) for attitude estimation
+ * The attitude is kept as a unit quaternion, while the filter estimates a 3-dimensional attitude error, dtheta, defined in body frame
+ *   q_true = q o [1; dtheta/2]
+ * together with the gyro bias of the x and y axis. The covariance is thus only 5x5 compared to the 10x10 of the QEKF.
+ * The interface matches the QEKF so the two can be used interchangeably.
+ */
+class MEKF
+{
+	public:
+		MEKF(Parameters& params, Timer * microsTimer);
+		MEKF(Parameters& params);
+		~MEKF();
+
+		void Reset();
+		void Reset(const float accelerometer[3]);
+		void Step(const float accelerometer[3], const float gyroscope[3]);
+		void Step(const float accelerometer[3], const float gyroscope[3], const bool EstimateBias);
+		void Step(const float accelerometer[3], const float gyroscope[3], const bool EstimateBias, const float dt);
+		void Step(const float accelerometer[3], const float gyroscope[3], const bool EstimateBias, const bool CreateQdotFromDifference, const float cov_acc[9], const float cov_gyro[9], const float sigma2_bias, const float g, const float dt);
+
+		void GetQuaternion(float q[4]);
+		void GetQuaternionDerivative(float dq[4]);
+		void GetQuaternionCovariance(float Cov_q[4*4]);
+		void GetQuaternionDerivativeCovariance(float Cov_dq[4*4]);
+
+		bool UnitTest(void);
+
+	private:
+		Parameters& _params;
+		Timer * _microsTimer;
+		uint32_t _prevTimerValue;
+
+		/* State estimate */
+		float X[6];    // state estimates = { q[0], q[1], q[2], q[3], gyro_bias[0], gyro_bias[1] }
+		float dq[4];   // quaternion derivative computed from the bias corrected gyroscope measurement
+		float P[MATRIX_SYMMETRIC_SIZE(5)]; // error-state covariance matrix (packed symmetric, see Matrix.h), error states = { dtheta[0], dtheta[1], dtheta[2], gyro_bias[0], gyro_bias[1] }
+		float cov_gyro_[9]; // gyroscope covariance used in last step, for the quaternion derivative covariance
+};
+	
+	
+#endif
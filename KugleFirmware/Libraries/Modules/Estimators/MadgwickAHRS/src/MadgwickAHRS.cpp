@@ -30,6 +30,8 @@
 
 #include "MadgwickAHRS.h"
 #include <math.h>
+#include <stdint.h>
+#include <string.h>
 
 //============================================================================================
 // Functions
@@ -43,7 +45,7 @@ Madgwick::Madgwick(float sampleFrequency, float _beta) {
 	q1 = 0.0f;
 	q2 = 0.0f;
 	q3 = 0.0f;
-	invSampleFreq = 1.0f / sampleFreqDef;
+	invSampleFreq = 1.0f / sampleFrequency;
 	anglesComputed = 0;
 }
 
@@ -56,7 +58,7 @@ void Madgwick::Reset()
 }
 
 /* Reset quaternion to attitude determined from current accelerometer measurement */
-void Madgwick::Reset(float ax, float ay, float az)
+void Madgwick::Reset(float /*ax*/, float /*ay*/, float /*az*/)
 {
 	q0 = 1.0f;
 	q1 = 0.0f;
@@ -237,10 +239,11 @@ void Madgwick::updateIMU(float gx, float gy, float gz, float ax, float ay, float
 
 float Madgwick::invSqrt(float x) {
 	float halfx = 0.5f * x;
-	float y = x;
-	long i = *(long*)&y;
+	float y;
+	int32_t i;
+	memcpy(&i, &x, sizeof(i)); // reinterpret the bits without breaking strict aliasing, and 32 bit on the host as well
 	i = 0x5f3759df - (i>>1);
-	y = *(float*)&i;
+	memcpy(&y, &i, sizeof(y));
 	y = y * (1.5f - (halfx * y * y));
 	y = y * (1.5f - (halfx * y * y));
 	return y;
@@ -21,7 +21,9 @@
 #include "QEKF_coder.h"
 #include "QEKF_initialize.h"
 #include "Math.h"
+#include "Matrix.h"
 #include <string.h> // for memcpy
+#include <math.h>
  
 #include "Quaternion.h"
 
@@ -41,7 +43,9 @@ QEKF::~QEKF()
 
 void QEKF::Reset()
 {
-	QEKF_initialize(_params.estimator.QEKF_P_init_diagonal, X, P);
+	float P_init[10*10];
+	QEKF_initialize(_params.estimator.QEKF_P_init_diagonal, X, P_init);
+	Matrix_SymmetricPack(P_init, 10, P);
 
 	if (_microsTimer)
 		_prevTimerValue = _microsTimer->Get();
@@ -53,7 +57,7 @@ void QEKF::Reset()
  * @brief 	Reset attitude estimator to an angle based on an accelerometer measurement
  * @param	accelerometer[3]   Input: acceleration measurement in body frame [m/s^2]
  */
-void QEKF::Reset(const float accelerometer[3])
+void QEKF::Reset(const float /*accelerometer*/[3])
 {
 	Reset();
 }
@@ -109,24 +113,171 @@ void QEKF::Step(const float accelerometer[3], const float gyroscope[3], const bo
  * @param   g                  Input: gravity constant [m/s^2]
  * @param	dt    			   Input: time passed since last estimate
  */
-void QEKF::Step(const float accelerometer[3], const float gyroscope[3], const bool EstimateBias, const bool CreateQdotFromDifference, const float cov_acc[9], const float cov_gyro[9], const float sigma2_bias, const float g, const float dt)
+void QEKF::Step(const float accelerometer[3], const float gyroscope[3], const bool EstimateBias, const bool CreateQdotFromDifference, const float cov_acc[9], const float cov_gyro[9], const float sigma2_bias, const float /*g*/, const float dt)
 {
 	if (dt == 0) return; // no time has passed
 
+	/* This is a hand-written version of the MATLAB generated QEKF (see _QEKF in MATLABCoder/QEKF_coder.cpp)
+	 * which stores the covariance in packed symmetric format, only computes the upper triangle of the symmetric products
+	 * and only multiplies the non-zero blocks of the model Jacobian, F, and the measurement Jacobian, H.
+	 * The accelerometer measurement is always normalized, hence the gravity constant, g, is not used.
+	 */
+	const float Bias = EstimateBias ? 1.f : 0.f;
+	const float * q = &X[0];
+	const float * dq = &X[4];
+
 	float X_prev[10];
 	memcpy(X_prev, X, sizeof(X_prev));
 
-	float P_prev[10*10];
-	memcpy(P_prev, P, sizeof(P_prev));
-
-	_QEKF(X_prev, P_prev,
-		 gyroscope, accelerometer,
-		 dt,
-		 EstimateBias,
-		 true,  // normalize accelerometer = true
-		 cov_gyro, cov_acc, sigma2_bias,
-		 g,
-		 X, P);
+	/* Measurement vector (normalized accelerometer) */
+	float z[3] = {0, 0, 0};
+	float norm_acc = sqrtf(accelerometer[0]*accelerometer[0] + accelerometer[1]*accelerometer[1] + accelerometer[2]*accelerometer[2]);
+	if (norm_acc > 0) {
+		z[0] = accelerometer[0] / norm_acc;
+		z[1] = accelerometer[1] / norm_acc;
+		z[2] = accelerometer[2] / norm_acc;
+	}
+
+	/* Prediction step */
+	float omega[4] = {0, gyroscope[0] - X[8], gyroscope[1] - X[9], gyroscope[2]}; // bias corrected angular velocity as pure quaternion
+
+	float X_apriori[10];
+	X_apriori[0] = q[0] + dt * dq[0]; // q_apriori = q + dt * dq
+	X_apriori[1] = q[1] + dt * dq[1];
+	X_apriori[2] = q[2] + dt * dq[2];
+	X_apriori[3] = q[3] + dt * dq[3];
+	Quaternion_Phi(q, omega, &X_apriori[4]); // dq_apriori = 1/2 * Phi(q) * [0;omega]
+	X_apriori[4] *= 0.5f;
+	X_apriori[5] *= 0.5f;
+	X_apriori[6] *= 0.5f;
+	X_apriori[7] *= 0.5f;
+	X_apriori[8] = X[8]; // gyro_bias_apriori = gyro_bias
+	X_apriori[9] = X[9];
+
+	/* Model Jacobian
+	 * F = [ eye(4),      dt*eye(4),  zeros(4,2)
+	 *       A,           zeros(4),   B
+	 *       zeros(2,4),  zeros(2,4), Bias*eye(2) ]
+	 * with the non-zero blocks
+	 *   A = 1/2 * Gamma([0;omega])                                    (4x4)
+	 *   B = -Bias/2 * Phi(q) * [zeros(1,2); eye(2); zeros(1,2)]       (4x2)
+	 * Only these blocks are stored and multiplied in the covariance propagation below
+	 */
+	float A[4*4] = {
+		0.5f*omega[0], -0.5f*omega[1], -0.5f*omega[2], -0.5f*omega[3],
+		0.5f*omega[1],  0.5f*omega[0],  0.5f*omega[3], -0.5f*omega[2],
+		0.5f*omega[2], -0.5f*omega[3],  0.5f*omega[0],  0.5f*omega[1],
+		0.5f*omega[3],  0.5f*omega[2], -0.5f*omega[1],  0.5f*omega[0]
+	};
+	float B[4*2] = {
+		-0.5f*Bias * -q[1],  -0.5f*Bias * -q[2],
+		-0.5f*Bias * q[0],   -0.5f*Bias * -q[3],
+		-0.5f*Bias * q[3],   -0.5f*Bias * q[0],
+		-0.5f*Bias * -q[2],  -0.5f*Bias * q[1]
+	};
+
+	/* Process covariance of the quaternion derivative states
+	 * Q = blkdiag(zeros(4), G*cov_gyro*G', sigma2_bias*dt*Bias*eye(2))   with   G = 1/2 * Phi(q) * [zeros(1,3); eye(3)]
+	 */
+	float G[4*3] = {
+		-0.5f*q[1], -0.5f*q[2], -0.5f*q[3],
+		 0.5f*q[0], -0.5f*q[3],  0.5f*q[2],
+		 0.5f*q[3],  0.5f*q[0], -0.5f*q[1],
+		-0.5f*q[2],  0.5f*q[1],  0.5f*q[0]
+	};
+	float Gcov[4*3];
+	for (int i = 0; i < 4; i++) {
+		for (int j = 0; j < 3; j++) {
+			Gcov[3*i + j] = G[3*i + 0]*cov_gyro[3*0 + j] + G[3*i + 1]*cov_gyro[3*1 + j] + G[3*i + 2]*cov_gyro[3*2 + j];
+		}
+	}
+	float Q_dq[4*4];
+	for (int i = 0; i < 4; i++) {
+		for (int j = i; j < 4; j++) {
+			Q_dq[4*i + j] = Gcov[3*i + 0]*G[3*j + 0] + Gcov[3*i + 1]*G[3*j + 1] + Gcov[3*i + 2]*G[3*j + 2];
+		}
+	}
+
+	/* P_apriori = F * P * F' + Q */
+	float P_apriori[MATRIX_SYMMETRIC_SIZE(10)];
+	PropagateCovariance(A, B, Bias, dt, Q_dq, sigma2_bias * dt * Bias, P_apriori);
+
+	/* Update/correction step */
+	const float * q_apriori = &X_apriori[0];
+
+	/* Accelerometer measurement model:  z_hat = -devec * Phi(q_apriori)' * Gamma(q_apriori) * [0;0;0;-1] */
+	float z_hat[3];
+	z_hat[0] = 2*(q_apriori[1]*q_apriori[3] - q_apriori[0]*q_apriori[2]);
+	z_hat[1] = 2*(q_apriori[2]*q_apriori[3] + q_apriori[0]*q_apriori[1]);
+	z_hat[2] = q_apriori[0]*q_apriori[0] - q_apriori[1]*q_apriori[1] - q_apriori[2]*q_apriori[2] + q_apriori[3]*q_apriori[3];
+
+	/* Measurement Jacobian (Row-major):  H = [dz_hat/dq_apriori, zeros(3,4), zeros(3,2)] */
+	float H[3*10];
+	memset(H, 0, sizeof(H));
+	H[10*0 + 0] = -2*q_apriori[2];  H[10*0 + 1] = 2*q_apriori[3];   H[10*0 + 2] = -2*q_apriori[0];  H[10*0 + 3] = 2*q_apriori[1];
+	H[10*1 + 0] = 2*q_apriori[1];   H[10*1 + 1] = 2*q_apriori[0];   H[10*1 + 2] = 2*q_apriori[3];   H[10*1 + 3] = 2*q_apriori[2];
+	H[10*2 + 0] = 2*q_apriori[0];   H[10*2 + 1] = -2*q_apriori[1];  H[10*2 + 2] = -2*q_apriori[2];  H[10*2 + 3] = 2*q_apriori[3];
+
+	/* PHt = P_apriori * H' */
+	float PHt[10*3];
+	for (int i = 0; i < 10; i++) {
+		for (int j = 0; j < 3; j++) {
+			float sum = 0;
+			for (int k = 0; k < 4; k++) // H only has non-zero entries in the first 4 columns
+				sum += P_apriori[Matrix_SymmetricIndex(10, i, k)] * H[10*j + k];
+			PHt[3*i + j] = sum;
+		}
+	}
+
+	/* S = H * P_apriori * H' + R */
+	float S[3*3];
+	for (int i = 0; i < 3; i++) {
+		for (int j = i; j < 3; j++) {
+			float sum = cov_acc[3*i + j];
+			for (int k = 0; k < 4; k++)
+				sum += H[10*i + k] * PHt[3*k + j];
+			S[3*i + j] = sum;
+			S[3*j + i] = sum;
+		}
+	}
+
+	/* K = P_apriori * H' / S   using the closed form inverse of the symmetric 3x3 matrix S */
+	float Sinv[3*3];
+	Matrix_SymmetricInverse3x3(S, Sinv);
+
+	float K[10*3];
+	for (int i = 0; i < 10; i++) {
+		for (int j = 0; j < 3; j++) {
+			K[3*i + j] = PHt[3*i + 0]*Sinv[3*0 + j] + PHt[3*i + 1]*Sinv[3*1 + j] + PHt[3*i + 2]*Sinv[3*2 + j];
+		}
+	}
+
+	/* X_aposteriori = X_apriori + K * (z - z_hat) */
+	float innovation[3] = {z[0] - z_hat[0], z[1] - z_hat[1], z[2] - z_hat[2]};
+	for (int i = 0; i < 10; i++) {
+		X[i] = X_apriori[i] + K[3*i + 0]*innovation[0] + K[3*i + 1]*innovation[1] + K[3*i + 2]*innovation[2];
+	}
+
+	/* P_aposteriori = (eye(10) - K*H) * P_apriori   or in Joseph form   (eye(10) - K*H) * P_apriori * (eye(10) - K*H)' + K*R*K' */
+	if (_params.estimator.UseJosephForm) {
+		Matrix_SymmetricJosephUpdate(P_apriori, H, K, cov_acc, 10, 3, P);
+	} else {
+		/* Since P_apriori is symmetric, H * P_apriori = PHt' which is already computed, hence  P = P_apriori - K * PHt' */
+		int idx = 0;
+		for (int i = 0; i < 10; i++) {
+			for (int j = i; j < 10; j++) {
+				P[idx] = P_apriori[idx] - K[3*i + 0]*PHt[3*j + 0] - K[3*i + 1]*PHt[3*j + 1] - K[3*i + 2]*PHt[3*j + 2];
+				idx++;
+			}
+		}
+	}
+
+	/* Normalize quaternion */
+	float norm_q = sqrtf(X[0]*X[0] + X[1]*X[1] + X[2]*X[2] + X[3]*X[3]);
+	X[0] /= norm_q;
+	X[1] /= norm_q;
+	X[2] /= norm_q;
+	X[3] /= norm_q;
 
     if (CreateQdotFromDifference) {
       X[4] = (X[0] - X_prev[0]) / dt; // dq[0]
@@ -136,6 +287,91 @@ void QEKF::Step(const float accelerometer[3], const float gyroscope[3], const bo
     }
 }
 
+/**
+ * @brief 	Propagate the covariance, P = F * P * F' + Q, by only multiplying the non-zero blocks of F
+ *          With the state split into X = {q, dq, gyro_bias} the propagated blocks become
+ *            P_q,q       = P_q,q + dt*(P_q,dq + P_dq,q) + dt^2*P_dq,dq
+ *            P_q,dq      = (P_q,q + dt*P_dq,q)*A' + (P_q,b + dt*P_dq,b)*B'
+ *            P_q,b       = Bias * (P_q,b + dt*P_dq,b)
+ *            P_dq,dq     = (A*P_q,q + B*P_b,q)*A' + (A*P_q,b + B*P_b,b)*B' + Q_dq
+ *            P_dq,b      = Bias * (A*P_q,b + B*P_b,b)
+ *            P_b,b       = Bias^2 * P_b,b + Q_b
+ * @param	A[4*4]          Input: Jacobian of dq with respect to q, 1/2 * Gamma([0;omega])
+ * @param	B[4*2]          Input: Jacobian of dq with respect to gyro bias
+ * @param	Bias            Input: 1 if bias is estimated, otherwise 0
+ * @param	dt              Input: time passed since last estimate
+ * @param	Q_dq[4*4]       Input: process covariance of dq (only upper triangle used)
+ * @param	Q_b             Input: process variance of the gyro bias states
+ * @param	P_apriori[55]   Output: packed propagated covariance
+ */
+void QEKF::PropagateCovariance(const float A[4*4], const float B[4*2], const float Bias, const float dt, const float Q_dq[4*4], const float Q_b, float P_apriori[MATRIX_SYMMETRIC_SIZE(10)])
+{
+	/* Extract the blocks of the packed covariance */
+	float Pqq[4*4], Pqdq[4*4], Pqb[4*2], Pdqdq[4*4], Pdqb[4*2], Pbb[2*2];
+	for (int i = 0; i < 4; i++) {
+		for (int j = 0; j < 4; j++) {
+			Pqq[4*i + j] = P[Matrix_SymmetricIndex(10, i, j)];
+			Pqdq[4*i + j] = P[Matrix_SymmetricIndex(10, i, 4+j)];
+			Pdqdq[4*i + j] = P[Matrix_SymmetricIndex(10, 4+i, 4+j)];
+		}
+		for (int j = 0; j < 2; j++) {
+			Pqb[2*i + j] = P[Matrix_SymmetricIndex(10, i, 8+j)];
+			Pdqb[2*i + j] = P[Matrix_SymmetricIndex(10, 4+i, 8+j)];
+		}
+	}
+	Pbb[0] = P[Matrix_SymmetricIndex(10, 8, 8)];
+	Pbb[1] = P[Matrix_SymmetricIndex(10, 8, 9)];
+	Pbb[2] = Pbb[1];
+	Pbb[3] = P[Matrix_SymmetricIndex(10, 9, 9)];
+
+	/* Row-block of F*P corresponding to q:  [T1, *, T2] with T1 = P_q,q + dt*P_dq,q  and  T2 = P_q,b + dt*P_dq,b */
+	float T1[4*4], T2[4*2];
+	for (int i = 0; i < 4; i++) {
+		for (int j = 0; j < 4; j++)
+			T1[4*i + j] = Pqq[4*i + j] + dt * Pqdq[4*j + i];
+		for (int j = 0; j < 2; j++)
+			T2[2*i + j] = Pqb[2*i + j] + dt * Pdqb[2*i + j];
+	}
+
+	/* Row-block of F*P corresponding to dq:  [V, *, U] with V = A*P_q,q + B*P_b,q  and  U = A*P_q,b + B*P_b,b */
+	float V[4*4], U[4*2];
+	for (int i = 0; i < 4; i++) {
+		for (int j = 0; j < 4; j++)
+			V[4*i + j] = A[4*i + 0]*Pqq[4*0 + j] + A[4*i + 1]*Pqq[4*1 + j] + A[4*i + 2]*Pqq[4*2 + j] + A[4*i + 3]*Pqq[4*3 + j]
+			           + B[2*i + 0]*Pqb[2*j + 0] + B[2*i + 1]*Pqb[2*j + 1];
+		for (int j = 0; j < 2; j++)
+			U[2*i + j] = A[4*i + 0]*Pqb[2*0 + j] + A[4*i + 1]*Pqb[2*1 + j] + A[4*i + 2]*Pqb[2*2 + j] + A[4*i + 3]*Pqb[2*3 + j]
+			           + B[2*i + 0]*Pbb[2*0 + j] + B[2*i + 1]*Pbb[2*1 + j];
+	}
+
+	for (int i = 0; i < 4; i++) {
+		/* P_q,q  (upper triangle) */
+		for (int j = i; j < 4; j++)
+			P_apriori[Matrix_SymmetricIndex(10, i, j)] = Pqq[4*i + j] + dt*(Pqdq[4*i + j] + Pqdq[4*j + i]) + dt*dt*Pdqdq[4*i + j];
+
+		/* P_q,dq  (full block) */
+		for (int j = 0; j < 4; j++)
+			P_apriori[Matrix_SymmetricIndex(10, i, 4+j)] = T1[4*i + 0]*A[4*j + 0] + T1[4*i + 1]*A[4*j + 1] + T1[4*i + 2]*A[4*j + 2] + T1[4*i + 3]*A[4*j + 3]
+			                                             + T2[2*i + 0]*B[2*j + 0] + T2[2*i + 1]*B[2*j + 1];
+
+		/* P_q,b  and  P_dq,b */
+		for (int j = 0; j < 2; j++) {
+			P_apriori[Matrix_SymmetricIndex(10, i, 8+j)] = Bias * T2[2*i + j];
+			P_apriori[Matrix_SymmetricIndex(10, 4+i, 8+j)] = Bias * U[2*i + j];
+		}
+
+		/* P_dq,dq  (upper triangle) */
+		for (int j = i; j < 4; j++)
+			P_apriori[Matrix_SymmetricIndex(10, 4+i, 4+j)] = V[4*i + 0]*A[4*j + 0] + V[4*i + 1]*A[4*j + 1] + V[4*i + 2]*A[4*j + 2] + V[4*i + 3]*A[4*j + 3]
+			                                               + U[2*i + 0]*B[2*j + 0] + U[2*i + 1]*B[2*j + 1] + Q_dq[4*i + j];
+	}
+
+	/* P_b,b */
+	P_apriori[Matrix_SymmetricIndex(10, 8, 8)] = Bias*Bias*Pbb[0] + Q_b;
+	P_apriori[Matrix_SymmetricIndex(10, 8, 9)] = Bias*Bias*Pbb[1];
+	P_apriori[Matrix_SymmetricIndex(10, 9, 9)] = Bias*Bias*Pbb[3] + Q_b;
+}
+
 /**
  * @brief 	Get estimated attitude quaternion
  * @param	q[4]		Output: estimated attitude quaternion
@@ -168,7 +404,7 @@ void QEKF::GetQuaternionCovariance(float Cov_q[4*4])
 {
     for (int m = 0; m < 4; m++) {
       for (int n = 0; n < 4; n++) {
-        Cov_q[4*m + n] = P[10*m + n];
+        Cov_q[4*m + n] = P[Matrix_SymmetricIndex(10, m, n)];
       }
     }
 }
@@ -181,7 +417,7 @@ void QEKF::GetQuaternionDerivativeCovariance(float Cov_dq[4*4])
 {
     for (int m = 0; m < 4; m++) {
       for (int n = 0; n < 4; n++) {
-        Cov_dq[4*m + n] = P[10*m + n + 44];
+        Cov_dq[4*m + n] = P[Matrix_SymmetricIndex(10, m + 4, n + 4)];
       }
     }
 }
@@ -203,7 +439,9 @@ bool QEKF::UnitTest(void)
 
 	const float QEKF_P_init_diagonal[10] = {1E-5, 1E-5, 1E-5, 1E-7,   1E-7, 1E-7, 1E-7, 1E-7,   1E-5, 1E-5};
 
-	QEKF_initialize(QEKF_P_init_diagonal, X, P); // reset
+	float P_init[10*10];
+	QEKF_initialize(QEKF_P_init_diagonal, X, P_init); // reset
+	Matrix_SymmetricPack(P_init, 10, P);
 
 	const float Accelerometer[3] = {0.05, 0, 9.82};
 	const float Gyroscope[3] = {1.0, 0.5, 0.09};
@@ -252,5 +490,26 @@ bool QEKF::UnitTest(void)
 		  Math_Round(Cov_q[3+12], 9) == Math_Round(Cov_q_diag_expected[3], 9)))
 		return false;
 
+	/* Compare the full state and covariance against the MATLAB generated implementation */
+	float X_ref[10];
+	float P_ref[10*10];
+	QEKF_initialize(QEKF_P_init_diagonal, X_ref, P_ref);
+	for (int k = 0; k < 2; k++) {
+		float X_prev[10];
+		float P_prev[10*10];
+		memcpy(X_prev, X_ref, sizeof(X_prev));
+		memcpy(P_prev, P_ref, sizeof(P_prev));
+		_QEKF(X_prev, P_prev, Gyroscope, Accelerometer, dt, EstimateBias, true, cov_gyro_mpu, cov_acc_mpu, sigma2_bias, g, X_ref, P_ref);
+	}
+
+	for (int i = 0; i < 10; i++) {
+		if (fabsf(X[i] - X_ref[i]) > 1E-6f)
+			return false;
+		for (int j = 0; j < 10; j++) {
+			if (fabsf(P[Matrix_SymmetricIndex(10, i, j)] - P_ref[10*i + j]) > 1E-4f * sqrtf(P_ref[11*i] * P_ref[11*j]))
+				return false;
+		}
+	}
+
 	return true;
 }
@@ -22,6 +22,7 @@
 
 #include "Parameters.h"
 #include "Timer.h"
+#include "Matrix.h"
 
 class QEKF
 {
@@ -44,6 +45,9 @@ class QEKF
 
 		bool UnitTest(void);
 
+	private:
+		void PropagateCovariance(const float A[4*4], const float B[4*2], const float Bias, const float dt, const float Q_dq[4*4], const float Q_b, float P_apriori[MATRIX_SYMMETRIC_SIZE(10)]);
+
 	private:
 		Parameters& _params;
 		Timer * _microsTimer;
@@ -51,7 +55,7 @@ class QEKF
 
 		/* State estimate */
 		float X[10];    // state estimates = { q[0], q[1], q[2], q[3], dq[0], dq[1], dq[2], dq[3], gyro_bias[0], gyro_bias[1] }
-		float P[10*10]; // covariance matrix
+		float P[MATRIX_SYMMETRIC_SIZE(10)]; // covariance matrix (packed symmetric, see Matrix.h)
 };
 	
 	
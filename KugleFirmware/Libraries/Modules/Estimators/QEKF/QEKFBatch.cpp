@@ -0,0 +1,427 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+
+#include "QEKFBatch.h"
+#include "QEKF.h"
+#include "QEKF_initialize.h"
+#include "Matrix.h"
+#include <string.h> // for memcpy
+#include <math.h>
+
+typedef QEKFBatch_lane_t lane_t;
+
+static inline lane_t Broadcast(const float value)
+{
+	lane_t v;
+	for (int n = 0; n < QEKF_BATCH_SIZE; n++)
+		v[n] = value;
+	return v;
+}
+
+static inline lane_t Load(const float values[QEKF_BATCH_SIZE])
+{
+	lane_t v;
+	memcpy(&v, values, sizeof(v));
+	return v;
+}
+
+static inline lane_t Sqrt(const lane_t x)
+{
+	lane_t v;
+	for (int n = 0; n < QEKF_BATCH_SIZE; n++)
+		v[n] = sqrtf(x[n]);
+	return v;
+}
+
+QEKFBatch::QEKFBatch(Parameters& params) : _params(params)
+{
+	Reset();
+}
+
+QEKFBatch::~QEKFBatch()
+{
+}
+
+void QEKFBatch::Reset()
+{
+	float X_init[10];
+	float P_init[10*10];
+	QEKF_initialize(_params.estimator.QEKF_P_init_diagonal, X_init, P_init);
+
+	for (int i = 0; i < 10; i++)
+		X[i] = Broadcast(X_init[i]);
+
+	int idx = 0;
+	for (int i = 0; i < 10; i++) {
+		for (int j = i; j < 10; j++) {
+			P[idx++] = Broadcast(P_init[10*i + j]);
+		}
+	}
+}
+
+/**
+ * @brief 	Estimate attitude quaternion of all instances given their accelerometer and gyroscope measurements and passed time
+ * @param	accelerometer[3][QEKF_BATCH_SIZE]   Input: acceleration measurements in body frame [m/s^2], accelerometer[i][n] is axis i of instance n
+ * @param	gyroscope[3][QEKF_BATCH_SIZE]       Input: angular velocity measurements in body frame [rad/s]
+ * @param	dt[QEKF_BATCH_SIZE]                 Input: time passed since last estimate of each instance
+ */
+void QEKFBatch::Step(const float accelerometer[3][QEKF_BATCH_SIZE], const float gyroscope[3][QEKF_BATCH_SIZE], const float dt[QEKF_BATCH_SIZE])
+{
+	Step(accelerometer, gyroscope, _params.estimator.EstimateBias, _params.estimator.CreateQdotFromQDifference, _params.estimator.cov_acc_mpu, _params.estimator.cov_gyro_mpu, _params.estimator.sigma2_bias, dt);
+}
+
+/**
+ * @brief 	Estimate attitude quaternion of all instances given their accelerometer and gyroscope measurements and passed time
+ *          Each instance follows the equations of QEKF::Step, see QEKF.cpp for the derivation of the individual blocks
+ * @param	accelerometer[3][QEKF_BATCH_SIZE]   Input: acceleration measurements in body frame [m/s^2], accelerometer[i][n] is axis i of instance n
+ * @param	gyroscope[3][QEKF_BATCH_SIZE]       Input: angular velocity measurements in body frame [rad/s]
+ * @param   EstimateBias       Input: flag to control if gyroscope bias should be estimated
+ * @param   CreateQdotFromDifference  Input: flag to control if qdot estimate is generated by differentiating q estimate
+ * @param   cov_acc            Input: accelerometer sensor covariance matrix (shared by all instances)
+ * @param   cov_gyro           Input: gyroscope sensor covariance matrix (shared by all instances)
+ * @param   sigma2_bias        Input: bias variance (random walk)
+ * @param	dt[QEKF_BATCH_SIZE]  Input: time passed since last estimate of each instance, instances with dt = 0 are left untouched
+ */
+void QEKFBatch::Step(const float accelerometer[3][QEKF_BATCH_SIZE], const float gyroscope[3][QEKF_BATCH_SIZE], const bool EstimateBias, const bool CreateQdotFromDifference, const float cov_acc[9], const float cov_gyro[9], const float sigma2_bias, const float dt_[QEKF_BATCH_SIZE])
+{
+	const float Bias = EstimateBias ? 1.f : 0.f;
+	const lane_t zero = Broadcast(0);
+	const lane_t dt = Load(dt_);
+	const lane_t * q = &X[0];
+	const lane_t * dq = &X[4];
+
+	/* Measurement vector (normalized accelerometer) */
+	lane_t acc[3] = {Load(accelerometer[0]), Load(accelerometer[1]), Load(accelerometer[2])};
+	lane_t norm_acc = Sqrt(acc[0]*acc[0] + acc[1]*acc[1] + acc[2]*acc[2]);
+	lane_t z[3];
+	z[0] = norm_acc > 0 ? acc[0] / norm_acc : zero;
+	z[1] = norm_acc > 0 ? acc[1] / norm_acc : zero;
+	z[2] = norm_acc > 0 ? acc[2] / norm_acc : zero;
+
+	/* Prediction step */
+	lane_t omega[3] = {Load(gyroscope[0]) - X[8], Load(gyroscope[1]) - X[9], Load(gyroscope[2])}; // bias corrected angular velocity
+
+	/* G = 1/2 * Phi(q) * [zeros(1,3); eye(3)] */
+	lane_t G[4*3] = {
+		-0.5f*q[1], -0.5f*q[2], -0.5f*q[3],
+		 0.5f*q[0], -0.5f*q[3],  0.5f*q[2],
+		 0.5f*q[3],  0.5f*q[0], -0.5f*q[1],
+		-0.5f*q[2],  0.5f*q[1],  0.5f*q[0]
+	};
+
+	lane_t X_apriori[10];
+	for (int i = 0; i < 4; i++) {
+		X_apriori[i] = q[i] + dt * dq[i]; // q_apriori = q + dt * dq
+		X_apriori[4+i] = G[3*i + 0]*omega[0] + G[3*i + 1]*omega[1] + G[3*i + 2]*omega[2]; // dq_apriori = 1/2 * Phi(q) * [0;omega]
+	}
+	X_apriori[8] = X[8]; // gyro_bias_apriori = gyro_bias
+	X_apriori[9] = X[9];
+
+	/* Non-zero blocks of the model Jacobian, A = 1/2 * Gamma([0;omega])  and  B = -Bias/2 * Phi(q) * [zeros(1,2); eye(2); zeros(1,2)] */
+	lane_t A[4*4] = {
+		zero,          -0.5f*omega[0], -0.5f*omega[1], -0.5f*omega[2],
+		0.5f*omega[0],  zero,           0.5f*omega[2], -0.5f*omega[1],
+		0.5f*omega[1], -0.5f*omega[2],  zero,           0.5f*omega[0],
+		0.5f*omega[2],  0.5f*omega[1], -0.5f*omega[0],  zero
+	};
+	lane_t B[4*2] = {
+		-0.5f*Bias * -q[1],  -0.5f*Bias * -q[2],
+		-0.5f*Bias * q[0],   -0.5f*Bias * -q[3],
+		-0.5f*Bias * q[3],   -0.5f*Bias * q[0],
+		-0.5f*Bias * -q[2],  -0.5f*Bias * q[1]
+	};
+
+	/* Q_dq = G*cov_gyro*G' */
+	lane_t Gcov[4*3];
+	for (int i = 0; i < 4; i++) {
+		for (int j = 0; j < 3; j++) {
+			Gcov[3*i + j] = G[3*i + 0]*cov_gyro[3*0 + j] + G[3*i + 1]*cov_gyro[3*1 + j] + G[3*i + 2]*cov_gyro[3*2 + j];
+		}
+	}
+	lane_t Q_dq[4*4];
+	for (int i = 0; i < 4; i++) {
+		for (int j = i; j < 4; j++) {
+			Q_dq[4*i + j] = Gcov[3*i + 0]*G[3*j + 0] + Gcov[3*i + 1]*G[3*j + 1] + Gcov[3*i + 2]*G[3*j + 2];
+		}
+	}
+	lane_t Q_b = sigma2_bias * dt * Bias;
+
+	/* P_apriori = F * P * F' + Q   (see QEKF::PropagateCovariance) */
+	lane_t Pqq[4*4], Pqdq[4*4], Pqb[4*2], Pdqdq[4*4], Pdqb[4*2], Pbb[2*2];
+	for (int i = 0; i < 4; i++) {
+		for (int j = 0; j < 4; j++) {
+			Pqq[4*i + j] = P[Matrix_SymmetricIndex(10, i, j)];
+			Pqdq[4*i + j] = P[Matrix_SymmetricIndex(10, i, 4+j)];
+			Pdqdq[4*i + j] = P[Matrix_SymmetricIndex(10, 4+i, 4+j)];
+		}
+		for (int j = 0; j < 2; j++) {
+			Pqb[2*i + j] = P[Matrix_SymmetricIndex(10, i, 8+j)];
+			Pdqb[2*i + j] = P[Matrix_SymmetricIndex(10, 4+i, 8+j)];
+		}
+	}
+	Pbb[0] = P[Matrix_SymmetricIndex(10, 8, 8)];
+	Pbb[1] = P[Matrix_SymmetricIndex(10, 8, 9)];
+	Pbb[2] = Pbb[1];
+	Pbb[3] = P[Matrix_SymmetricIndex(10, 9, 9)];
+
+	lane_t T1[4*4], T2[4*2];
+	for (int i = 0; i < 4; i++) {
+		for (int j = 0; j < 4; j++)
+			T1[4*i + j] = Pqq[4*i + j] + dt * Pqdq[4*j + i];
+		for (int j = 0; j < 2; j++)
+			T2[2*i + j] = Pqb[2*i + j] + dt * Pdqb[2*i + j];
+	}
+
+	lane_t V[4*4], U[4*2];
+	for (int i = 0; i < 4; i++) {
+		for (int j = 0; j < 4; j++)
+			V[4*i + j] = A[4*i + 0]*Pqq[4*0 + j] + A[4*i + 1]*Pqq[4*1 + j] + A[4*i + 2]*Pqq[4*2 + j] + A[4*i + 3]*Pqq[4*3 + j]
+			           + B[2*i + 0]*Pqb[2*j + 0] + B[2*i + 1]*Pqb[2*j + 1];
+		for (int j = 0; j < 2; j++)
+			U[2*i + j] = A[4*i + 0]*Pqb[2*0 + j] + A[4*i + 1]*Pqb[2*1 + j] + A[4*i + 2]*Pqb[2*2 + j] + A[4*i + 3]*Pqb[2*3 + j]
+			           + B[2*i + 0]*Pbb[2*0 + j] + B[2*i + 1]*Pbb[2*1 + j];
+	}
+
+	lane_t P_apriori[MATRIX_SYMMETRIC_SIZE(10)];
+	for (int i = 0; i < 4; i++) {
+		for (int j = i; j < 4; j++)
+			P_apriori[Matrix_SymmetricIndex(10, i, j)] = Pqq[4*i + j] + dt*(Pqdq[4*i + j] + Pqdq[4*j + i]) + dt*dt*Pdqdq[4*i + j];
+
+		for (int j = 0; j < 4; j++)
+			P_apriori[Matrix_SymmetricIndex(10, i, 4+j)] = T1[4*i + 0]*A[4*j + 0] + T1[4*i + 1]*A[4*j + 1] + T1[4*i + 2]*A[4*j + 2] + T1[4*i + 3]*A[4*j + 3]
+			                                             + T2[2*i + 0]*B[2*j + 0] + T2[2*i + 1]*B[2*j + 1];
+
+		for (int j = 0; j < 2; j++) {
+			P_apriori[Matrix_SymmetricIndex(10, i, 8+j)] = Bias * T2[2*i + j];
+			P_apriori[Matrix_SymmetricIndex(10, 4+i, 8+j)] = Bias * U[2*i + j];
+		}
+
+		for (int j = i; j < 4; j++)
+			P_apriori[Matrix_SymmetricIndex(10, 4+i, 4+j)] = V[4*i + 0]*A[4*j + 0] + V[4*i + 1]*A[4*j + 1] + V[4*i + 2]*A[4*j + 2] + V[4*i + 3]*A[4*j + 3]
+			                                               + U[2*i + 0]*B[2*j + 0] + U[2*i + 1]*B[2*j + 1] + Q_dq[4*i + j];
+	}
+	P_apriori[Matrix_SymmetricIndex(10, 8, 8)] = Bias*Bias*Pbb[0] + Q_b;
+	P_apriori[Matrix_SymmetricIndex(10, 8, 9)] = Bias*Bias*Pbb[1];
+	P_apriori[Matrix_SymmetricIndex(10, 9, 9)] = Bias*Bias*Pbb[3] + Q_b;
+
+	/* Update/correction step */
+	const lane_t * q_apriori = &X_apriori[0];
+
+	lane_t z_hat[3];
+	z_hat[0] = 2*(q_apriori[1]*q_apriori[3] - q_apriori[0]*q_apriori[2]);
+	z_hat[1] = 2*(q_apriori[2]*q_apriori[3] + q_apriori[0]*q_apriori[1]);
+	z_hat[2] = q_apriori[0]*q_apriori[0] - q_apriori[1]*q_apriori[1] - q_apriori[2]*q_apriori[2] + q_apriori[3]*q_apriori[3];
+
+	/* Non-zero block of the measurement Jacobian, H = [dz_hat/dq_apriori, zeros(3,4), zeros(3,2)] */
+	lane_t H[3*4] = {
+		-2*q_apriori[2],  2*q_apriori[3], -2*q_apriori[0],  2*q_apriori[1],
+		 2*q_apriori[1],  2*q_apriori[0],  2*q_apriori[3],  2*q_apriori[2],
+		 2*q_apriori[0], -2*q_apriori[1], -2*q_apriori[2],  2*q_apriori[3]
+	};
+
+	/* PHt = P_apriori * H' */
+	lane_t PHt[10*3];
+	for (int i = 0; i < 10; i++) {
+		for (int j = 0; j < 3; j++) {
+			lane_t sum = zero;
+			for (int k = 0; k < 4; k++)
+				sum += P_apriori[Matrix_SymmetricIndex(10, i, k)] * H[4*j + k];
+			PHt[3*i + j] = sum;
+		}
+	}
+
+	/* S = H * P_apriori * H' + R */
+	lane_t S[3*3];
+	for (int i = 0; i < 3; i++) {
+		for (int j = i; j < 3; j++) {
+			lane_t sum = cov_acc[3*i + j] + zero;
+			for (int k = 0; k < 4; k++)
+				sum += H[4*i + k] * PHt[3*k + j];
+			S[3*i + j] = sum;
+			S[3*j + i] = sum;
+		}
+	}
+
+	/* Closed form inverse of the symmetric 3x3 matrix S (see Matrix_SymmetricInverse3x3) */
+	lane_t Sinv[3*3];
+	Sinv[0] = S[4]*S[8] - S[5]*S[5];
+	Sinv[1] = S[2]*S[5] - S[1]*S[8];
+	Sinv[2] = S[1]*S[5] - S[2]*S[4];
+	Sinv[4] = S[0]*S[8] - S[2]*S[2];
+	Sinv[5] = S[1]*S[2] - S[0]*S[5];
+	Sinv[8] = S[0]*S[4] - S[1]*S[1];
+	lane_t invDet = 1.f / (S[0]*Sinv[0] + S[1]*Sinv[1] + S[2]*Sinv[2]);
+	Sinv[0] *= invDet;  Sinv[1] *= invDet;  Sinv[2] *= invDet;
+	Sinv[4] *= invDet;  Sinv[5] *= invDet;  Sinv[8] *= invDet;
+	Sinv[3] = Sinv[1];
+	Sinv[6] = Sinv[2];
+	Sinv[7] = Sinv[5];
+
+	lane_t K[10*3];
+	for (int i = 0; i < 10; i++) {
+		for (int j = 0; j < 3; j++) {
+			K[3*i + j] = PHt[3*i + 0]*Sinv[3*0 + j] + PHt[3*i + 1]*Sinv[3*1 + j] + PHt[3*i + 2]*Sinv[3*2 + j];
+		}
+	}
+
+	/* X_aposteriori = X_apriori + K * (z - z_hat) */
+	lane_t innovation[3] = {z[0] - z_hat[0], z[1] - z_hat[1], z[2] - z_hat[2]};
+	lane_t X_aposteriori[10];
+	for (int i = 0; i < 10; i++) {
+		X_aposteriori[i] = X_apriori[i] + K[3*i + 0]*innovation[0] + K[3*i + 1]*innovation[1] + K[3*i + 2]*innovation[2];
+	}
+
+	/* Normalize quaternion */
+	lane_t norm_q = Sqrt(X_aposteriori[0]*X_aposteriori[0] + X_aposteriori[1]*X_aposteriori[1] + X_aposteriori[2]*X_aposteriori[2] + X_aposteriori[3]*X_aposteriori[3]);
+	for (int i = 0; i < 4; i++)
+		X_aposteriori[i] /= norm_q;
+
+	if (CreateQdotFromDifference) {
+		for (int i = 0; i < 4; i++)
+			X_aposteriori[4+i] = (X_aposteriori[i] - X[i]) / dt;
+	}
+
+	/* P_aposteriori = P_apriori - K * PHt'   while instances where no time has passed keep their previous estimate */
+	int idx = 0;
+	for (int i = 0; i < 10; i++) {
+		for (int j = i; j < 10; j++) {
+			P[idx] = dt != 0 ? P_apriori[idx] - K[3*i + 0]*PHt[3*j + 0] - K[3*i + 1]*PHt[3*j + 1] - K[3*i + 2]*PHt[3*j + 2] : P[idx];
+			idx++;
+		}
+	}
+
+	for (int i = 0; i < 10; i++)
+		X[i] = dt != 0 ? X_aposteriori[i] : X[i];
+}
+
+/**
+ * @brief 	Get estimated attitude quaternion of one instance
+ * @param	instance    Input: instance index, 0 to QEKF_BATCH_SIZE-1
+ * @param	q[4]		Output: estimated attitude quaternion
+ */
+void QEKFBatch::GetQuaternion(int instance, float q[4])
+{
+	for (int i = 0; i < 4; i++)
+		q[i] = X[i][instance];
+}
+
+/**
+ * @brief 	Get estimated attitude quaternion derivative of one instance
+ * @param	instance    Input: instance index, 0 to QEKF_BATCH_SIZE-1
+ * @param	dq[4]		Output: estimated attitude quaternion derivative
+ */
+void QEKFBatch::GetQuaternionDerivative(int instance, float dq[4])
+{
+	for (int i = 0; i < 4; i++)
+		dq[i] = X[4+i][instance];
+}
+
+/**
+ * @brief 	Get covariance matrix of estimated quaternion of one instance
+ * @param	instance        Input: instance index, 0 to QEKF_BATCH_SIZE-1
+ * @param	Cov_q[4*4]		Output: quaternion estimate covariance
+ */
+void QEKFBatch::GetQuaternionCovariance(int instance, float Cov_q[4*4])
+{
+    for (int m = 0; m < 4; m++) {
+      for (int n = 0; n < 4; n++) {
+        Cov_q[4*m + n] = P[Matrix_SymmetricIndex(10, m, n)][instance];
+      }
+    }
+}
+
+/**
+ * @brief 	Get covariance matrix of estimated quaternion derivative of one instance
+ * @param	instance        Input: instance index, 0 to QEKF_BATCH_SIZE-1
+ * @param	Cov_dq[4*4]		Output: quaternion derivative estimate covariance
+ */
+void QEKFBatch::GetQuaternionDerivativeCovariance(int instance, float Cov_dq[4*4])
+{
+    for (int m = 0; m < 4; m++) {
+      for (int n = 0; n < 4; n++) {
+        Cov_dq[4*m + n] = P[Matrix_SymmetricIndex(10, m + 4, n + 4)][instance];
+      }
+    }
+}
+
+/**
+ * @brief 	Run every instance on its own input sequence and compare against the scalar QEKF
+ */
+bool QEKFBatch::UnitTest(void)
+{
+	const float cov_gyro_mpu[9] = {0.2529E-03,   -0.0064E-03,    0.1981E-03,
+								  -0.0064E-03,    0.9379E-03,   -0.0038E-03,
+								   0.1981E-03,   -0.0038E-03,    1.6828E-03};
+	const float cov_acc_mpu[9] = {0.4273E-03,    0.0072E-03,    0.0096E-03,
+								  0.0072E-03,    0.4333E-03,    0.0041E-03,
+								  0.0096E-03,    0.0041E-03,    1.0326E-03};
+
+	const float sigma2_bias = 1E-11;
+	const bool EstimateBias = true;
+	const bool CreateQdotFromDifference = false;
+	const int steps = 100;
+
+	float accelerometer[3][QEKF_BATCH_SIZE];
+	float gyroscope[3][QEKF_BATCH_SIZE];
+	float dt[QEKF_BATCH_SIZE];
+
+	Reset();
+	for (int k = 0; k < steps; k++) {
+		for (int n = 0; n < QEKF_BATCH_SIZE; n++) {
+			accelerometer[0][n] = 0.05f * n;
+			accelerometer[1][n] = -0.02f * n;
+			accelerometer[2][n] = 9.82f;
+			gyroscope[0][n] = 0.1f * n;
+			gyroscope[1][n] = 0.5f - 0.05f * n;
+			gyroscope[2][n] = 0.09f;
+			dt[n] = (k % (n+1) == n) ? 0 : 1.0f / 400.0f; // let some instances skip a step
+		}
+		Step(accelerometer, gyroscope, EstimateBias, CreateQdotFromDifference, cov_acc_mpu, cov_gyro_mpu, sigma2_bias, dt);
+	}
+
+	QEKF qEKF(_params);
+	for (int n = 0; n < QEKF_BATCH_SIZE; n++) {
+		qEKF.Reset();
+		for (int k = 0; k < steps; k++) {
+			float acc[3] = {0.05f * n, -0.02f * n, 9.82f};
+			float gyro[3] = {0.1f * n, 0.5f - 0.05f * n, 0.09f};
+			qEKF.Step(acc, gyro, EstimateBias, CreateQdotFromDifference, cov_acc_mpu, cov_gyro_mpu, sigma2_bias, _params.model.g, (k % (n+1) == n) ? 0 : 1.0f / 400.0f);
+		}
+
+		float q[4], q_ref[4], dq[4], dq_ref[4], Cov_q[4*4], Cov_q_ref[4*4];
+		GetQuaternion(n, q);
+		GetQuaternionDerivative(n, dq);
+		GetQuaternionCovariance(n, Cov_q);
+		qEKF.GetQuaternion(q_ref);
+		qEKF.GetQuaternionDerivative(dq_ref);
+		qEKF.GetQuaternionCovariance(Cov_q_ref);
+
+		for (int i = 0; i < 4; i++) {
+			if (fabsf(q[i] - q_ref[i]) > 1E-5f || fabsf(dq[i] - dq_ref[i]) > 1E-5f)
+				return false;
+			for (int j = 0; j < 4; j++) {
+				if (fabsf(Cov_q[4*i + j] - Cov_q_ref[4*i + j]) > 1E-3f * sqrtf(Cov_q_ref[5*i] * Cov_q_ref[5*j]))
+					return false;
+			}
+		}
+	}
+
+	Reset();
+	return true;
+}
@@ -0,0 +1,66 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+
+#ifndef MODULES_ESTIMATORS_QEKF_BATCH_H
+#define MODULES_ESTIMATORS_QEKF_BATCH_H
+
+#include "Parameters.h"
+#include "Matrix.h"
+
+/* Number of filter instances evaluated together, one per vector lane.
+ * Use 8 for AVX2 (8 floats per register) and 16 for AVX-512 when building for a host. */
+#ifndef QEKF_BATCH_SIZE
+#define QEKF_BATCH_SIZE 8
+#endif
+
+/* One float per filter instance. The GCC vector extension lowers element-wise arithmetic
+ * to the widest SIMD instructions available on the target and to scalar code otherwise (e.g. on the Cortex-M7) */
+typedef float QEKFBatch_lane_t __attribute__((vector_size(QEKF_BATCH_SIZE * sizeof(float))));
+
+/* Batched (structure-of-arrays) version of the QEKF running QEKF_BATCH_SIZE independent instances in lock-step.
+ * Intended for offline replay and parameter sweeps on a host, e.g. when tuning covariances over logged data.
+ * Every instance follows the same equations as QEKF::Step, without the Joseph form update.
+ * Note that objects of this class require alignment to sizeof(QEKFBatch_lane_t) */
+class QEKFBatch
+{
+	public:
+		QEKFBatch(Parameters& params);
+		~QEKFBatch();
+
+		void Reset();
+		void Step(const float accelerometer[3][QEKF_BATCH_SIZE], const float gyroscope[3][QEKF_BATCH_SIZE], const float dt[QEKF_BATCH_SIZE]);
+		void Step(const float accelerometer[3][QEKF_BATCH_SIZE], const float gyroscope[3][QEKF_BATCH_SIZE], const bool EstimateBias, const bool CreateQdotFromDifference, const float cov_acc[9], const float cov_gyro[9], const float sigma2_bias, const float dt[QEKF_BATCH_SIZE]);
+
+		void GetQuaternion(int instance, float q[4]);
+		void GetQuaternionDerivative(int instance, float dq[4]);
+		void GetQuaternionCovariance(int instance, float Cov_q[4*4]);
+		void GetQuaternionDerivativeCovariance(int instance, float Cov_dq[4*4]);
+
+		bool UnitTest(void);
+
+	private:
+		Parameters& _params;
+
+		/* State estimate, X[i][n] is state i of instance n (see QEKF.h for the state ordering) */
+		QEKFBatch_lane_t X[10];
+		QEKFBatch_lane_t P[MATRIX_SYMMETRIC_SIZE(10)]; // covariance matrix (packed symmetric, see Matrix.h)
+};
+
+
+#endif
@@ -1,920 +0,0 @@
-//
-// Academic License - for use in teaching, academic research, and meeting
-// course requirements at degree granting institutions only.  Not for
-// government, commercial, or other organizational use.
-// File: SteadyStateAcceleration_dq.cpp
-//
-// MATLAB Coder version            : 4.0
-// C/C++ source code generated on  : 19-Nov-2018 11:57:59
-//
-
-// Include Files
-#include "rt_nonfinite.h"
-#include "VelocityEstimator.h"
-#include "SteadyStateAcceleration_dq.h"
-
-// Function Definitions
-
-//
-// function dAcceleration_dq = SteadyStateAcceleration_dq(COM_X,COM_Y,COM_Z,Jk,Mb,Mk,g,q1,q2,q3,q4,rk)
-// STEADYSTATEACCELERATION_DQ
-//     DACCELERATION_DQ = STEADYSTATEACCELERATION_DQ(COM_X,COM_Y,COM_Z,JK,MB,MK,G,Q1,Q2,Q3,Q4,RK)
-// Arguments    : float COM_X
-//                float COM_Y
-//                float COM_Z
-//                float Jk
-//                float Mb
-//                float Mk
-//                float g
-//                float q1
-//                float q2
-//                float q3
-//                float q4
-//                float rk
-//                float dAcceleration_dq[8]
-// Return Type  : void
-//
-__attribute__((optimize("O3"))) void SteadyStateAcceleration_dq(float COM_X, float COM_Y, float COM_Z, float Jk,
-  float Mb, float Mk, float g, float q1, float q2, float q3, float q4, float rk,
-  float dAcceleration_dq[8])
-{
-  float t2;
-  float t3;
-  float t4;
-  float t5;
-  float t6;
-  float t7;
-  float t8;
-  float t9;
-  float t10;
-  float t11;
-  float t12;
-  float t13;
-  float t31;
-  float t32;
-  float t40;
-  float t41;
-  float t42;
-  float t43;
-  float t44;
-  float t45;
-  float t46;
-  float t47;
-  float t48;
-  float t49;
-  float t50;
-  float t51;
-  float t52;
-  float t53;
-  float t54;
-  float t55;
-  float t56;
-  float t57;
-  float t58;
-  float t59;
-  float t60;
-  float t61;
-  float t62;
-  float t63;
-  float t64;
-  float t65;
-  float t67;
-  float t68;
-  float t69;
-  float t70;
-  float t71;
-  float t72;
-  float t73;
-  float t74;
-  float t75;
-  float t76;
-  float t77;
-  float t78;
-  float t79;
-  float t80;
-  float t81;
-  float t82;
-  float t83;
-  float t84;
-  float t85;
-  float t86;
-  float t87;
-  float t88;
-  float t89;
-  float t90;
-  float t91;
-  float t92;
-  float t93;
-  float t94;
-  float t95;
-  float t96;
-  float t97;
-  float t98;
-  float t99;
-  float t100;
-  float t101;
-  float t102;
-  float t103;
-  float t104;
-  float t105;
-  float t106;
-  float t107;
-  float t108;
-  float t109;
-  float t110;
-  float t111;
-  float t112;
-  float t113;
-  float t114;
-  float t115;
-  float t116;
-  float t117;
-  float t118;
-  float t119;
-  float t120;
-  float t121;
-  float t122;
-  float t123;
-  float t124;
-  float t125;
-  float t126;
-  float t127;
-  float t128;
-  float t129;
-  float t130;
-  float t131;
-  float t132;
-  float t133;
-  float t134;
-  float t135;
-  float t136;
-  float t137;
-  float t138;
-  float t139;
-  float t140;
-  float t141;
-  float t142;
-  float t143;
-  float t144;
-  float t145;
-  float t146;
-  float t147;
-  float f0;
-  float f1;
-  float f2;
-  float f3;
-  float f4;
-  float f5;
-  float f6;
-  float f7;
-  float f8;
-  float f9;
-  float x[8];
-  int i0;
-  int i1;
-  int i2;
-  int i3;
-
-  //     This function was generated by the Symbolic Math Toolbox version 8.1.
-  //     16-Nov-2018 12:04:26
-  // 'SteadyStateAcceleration_dq:8' t2 = rk.^2;
-  t2 = rk * rk;
-
-  // 'SteadyStateAcceleration_dq:9' t3 = q1.^2;
-  t3 = q1 * q1;
-
-  // 'SteadyStateAcceleration_dq:10' t4 = q2.^2;
-  t4 = q2 * q2;
-
-  // 'SteadyStateAcceleration_dq:11' t5 = q3.^2;
-  t5 = q3 * q3;
-
-  // 'SteadyStateAcceleration_dq:12' t6 = q4.^2;
-  t6 = q4 * q4;
-
-  // 'SteadyStateAcceleration_dq:13' t7 = t5.^2;
-  t7 = t5 * t5;
-
-  // 'SteadyStateAcceleration_dq:14' t8 = COM_X.^2;
-  t8 = COM_X * COM_X;
-
-  // 'SteadyStateAcceleration_dq:15' t9 = t3.^2;
-  t9 = t3 * t3;
-
-  // 'SteadyStateAcceleration_dq:16' t10 = t4.^2;
-  t10 = t4 * t4;
-
-  // 'SteadyStateAcceleration_dq:17' t11 = COM_Z.^2;
-  t11 = COM_Z * COM_Z;
-
-  // 'SteadyStateAcceleration_dq:18' t12 = t6.^2;
-  t12 = t6 * t6;
-
-  // 'SteadyStateAcceleration_dq:19' t13 = COM_Y.^2;
-  t13 = COM_Y * COM_Y;
-
-  // 'SteadyStateAcceleration_dq:20' t14 = Mb.*t2;
-  // 'SteadyStateAcceleration_dq:21' t15 = Mk.*t2;
-  // 'SteadyStateAcceleration_dq:22' t16 = COM_Z.*Mb.*rk.*t9;
-  // 'SteadyStateAcceleration_dq:23' t17 = COM_Z.*Mb.*rk.*t12;
-  // 'SteadyStateAcceleration_dq:24' t18 = COM_Z.*Mb.*rk.*t3.*t6.*2.0;
-  // 'SteadyStateAcceleration_dq:25' t19 = COM_Y.*Mb.*q1.*q2.*rk.*t4.*2.0;
-  // 'SteadyStateAcceleration_dq:26' t20 = COM_Y.*Mb.*q1.*q2.*rk.*t3.*2.0;
-  // 'SteadyStateAcceleration_dq:27' t21 = COM_X.*Mb.*q2.*q4.*rk.*t6.*2.0;
-  // 'SteadyStateAcceleration_dq:28' t22 = COM_X.*Mb.*q2.*q4.*rk.*t4.*2.0;
-  // 'SteadyStateAcceleration_dq:29' t23 = COM_Y.*Mb.*q3.*q4.*rk.*t6.*2.0;
-  // 'SteadyStateAcceleration_dq:30' t24 = COM_Y.*Mb.*q3.*q4.*rk.*t5.*2.0;
-  // 'SteadyStateAcceleration_dq:31' t25 = COM_X.*Mb.*q2.*q4.*rk.*t3.*2.0;
-  // 'SteadyStateAcceleration_dq:32' t26 = COM_Y.*Mb.*q1.*q2.*rk.*t5.*2.0;
-  // 'SteadyStateAcceleration_dq:33' t27 = COM_Y.*Mb.*q1.*q2.*rk.*t6.*2.0;
-  // 'SteadyStateAcceleration_dq:34' t28 = COM_X.*Mb.*q2.*q4.*rk.*t5.*2.0;
-  // 'SteadyStateAcceleration_dq:35' t29 = COM_Y.*Mb.*q3.*q4.*rk.*t3.*2.0;
-  // 'SteadyStateAcceleration_dq:36' t30 = COM_Y.*Mb.*q3.*q4.*rk.*t4.*2.0;
-  // 'SteadyStateAcceleration_dq:37' t33 = COM_Z.*Mb.*rk.*t10;
-  // 'SteadyStateAcceleration_dq:38' t34 = COM_Z.*Mb.*rk.*t7;
-  // 'SteadyStateAcceleration_dq:39' t35 = COM_Z.*Mb.*rk.*t4.*t5.*2.0;
-  // 'SteadyStateAcceleration_dq:40' t36 = COM_X.*Mb.*q1.*q3.*rk.*t5.*2.0;
-  // 'SteadyStateAcceleration_dq:41' t37 = COM_X.*Mb.*q1.*q3.*rk.*t3.*2.0;
-  // 'SteadyStateAcceleration_dq:42' t38 = COM_X.*Mb.*q1.*q3.*rk.*t4.*2.0;
-  // 'SteadyStateAcceleration_dq:43' t39 = COM_X.*Mb.*q1.*q3.*rk.*t6.*2.0;
-  // 'SteadyStateAcceleration_dq:44' t31 = Jk+t14+t15+t16+t17+t18+t19+t20+t21+t22+t23+t24+t25+t26+t27+t28+t29+t30-t33-t34-t35-t36-t37-t38-t39; 
-  t31 = (((((((((((((((((((((((Jk + Mb * t2) + Mk * t2) + COM_Z * Mb * rk * t9)
-    + COM_Z * Mb * rk * t12) + COM_Z * Mb * rk * t3 * t6 * 2.0F) + COM_Y * Mb *
-    q1 * q2 * rk * t4 * 2.0F) + COM_Y * Mb * q1 * q2 * rk * t3 * 2.0F) + COM_X *
-                        Mb * q2 * q4 * rk * t6 * 2.0F) + COM_X * Mb * q2 * q4 *
-                       rk * t4 * 2.0F) + COM_Y * Mb * q3 * q4 * rk * t6 * 2.0F)
-                     + COM_Y * Mb * q3 * q4 * rk * t5 * 2.0F) + COM_X * Mb * q2 *
-                    q4 * rk * t3 * 2.0F) + COM_Y * Mb * q1 * q2 * rk * t5 * 2.0F)
-                  + COM_Y * Mb * q1 * q2 * rk * t6 * 2.0F) + COM_X * Mb * q2 *
-                 q4 * rk * t5 * 2.0F) + COM_Y * Mb * q3 * q4 * rk * t3 * 2.0F) +
-               COM_Y * Mb * q3 * q4 * rk * t4 * 2.0F) - COM_Z * Mb * rk * t10) -
-             COM_Z * Mb * rk * t7) - COM_Z * Mb * rk * t4 * t5 * 2.0F) - COM_X *
-           Mb * q1 * q3 * rk * t5 * 2.0F) - COM_X * Mb * q1 * q3 * rk * t3 *
-          2.0F) - COM_X * Mb * q1 * q3 * rk * t4 * 2.0F) - COM_X * Mb * q1 * q3 *
-    rk * t6 * 2.0F;
-
-  // 'SteadyStateAcceleration_dq:45' t32 = 1.0./t31.^2;
-  t32 = 1.0F / (t31 * t31);
-
-  // 'SteadyStateAcceleration_dq:46' t40 = COM_Y.*Jk.*q1;
-  t40 = COM_Y * Jk * q1;
-
-  // 'SteadyStateAcceleration_dq:47' t41 = COM_X.*Jk.*q4;
-  t41 = COM_X * Jk * q4;
-
-  // 'SteadyStateAcceleration_dq:48' t42 = COM_Y.*Mb.*q1.*t2;
-  t42 = COM_Y * Mb * q1 * t2;
-
-  // 'SteadyStateAcceleration_dq:49' t43 = COM_X.*Mb.*q4.*t2;
-  t43 = COM_X * Mb * q4 * t2;
-
-  // 'SteadyStateAcceleration_dq:50' t44 = COM_Y.*Mk.*q1.*t2;
-  t44 = COM_Y * Mk * q1 * t2;
-
-  // 'SteadyStateAcceleration_dq:51' t45 = COM_X.*Mk.*q4.*t2;
-  t45 = COM_X * Mk * q4 * t2;
-
-  // 'SteadyStateAcceleration_dq:52' t46 = Mb.*q2.*rk.*t10.*t11;
-  t46 = Mb * q2 * rk * t10 * t11;
-
-  // 'SteadyStateAcceleration_dq:53' t47 = Mb.*q2.*rk.*t7.*t11;
-  t47 = Mb * q2 * rk * t7 * t11;
-
-  // 'SteadyStateAcceleration_dq:54' t48 = Mb.*q2.*rk.*t4.*t5.*t11.*2.0;
-  t48 = Mb * q2 * rk * t4 * t5 * t11 * 2.0F;
-
-  // 'SteadyStateAcceleration_dq:55' t49 = COM_Y.*COM_Z.*Mb.*q1.*rk.*t9;
-  t49 = COM_Y * COM_Z * Mb * q1 * rk * t9;
-
-  // 'SteadyStateAcceleration_dq:56' t50 = COM_X.*COM_Y.*Mb.*q3.*rk.*t4.*t5.*2.0; 
-  t50 = COM_X * COM_Y * Mb * q3 * rk * t4 * t5 * 2.0F;
-
-  // 'SteadyStateAcceleration_dq:57' t51 = COM_X.*COM_Z.*Mb.*q4.*rk.*t3.*t6.*2.0; 
-  t51 = COM_X * COM_Z * Mb * q4 * rk * t3 * t6 * 2.0F;
-
-  // 'SteadyStateAcceleration_dq:58' t52 = COM_Y.*COM_Z.*Mb.*q1.*rk.*t3.*t5.*2.0; 
-  t52 = COM_Y * COM_Z * Mb * q1 * rk * t3 * t5 * 2.0F;
-
-  // 'SteadyStateAcceleration_dq:59' t53 = Mb.*q1.*q3.*q4.*rk.*t6.*t11.*4.0;
-  t53 = Mb * q1 * q3 * q4 * rk * t6 * t11 * 4.0F;
-
-  // 'SteadyStateAcceleration_dq:60' t54 = Mb.*q1.*q3.*q4.*rk.*t3.*t11.*4.0;
-  t54 = Mb * q1 * q3 * q4 * rk * t3 * t11 * 4.0F;
-
-  // 'SteadyStateAcceleration_dq:61' t55 = Mb.*q2.*rk.*t3.*t6.*t11.*2.0;
-  t55 = Mb * q2 * rk * t3 * t6 * t11 * 2.0F;
-
-  // 'SteadyStateAcceleration_dq:62' t56 = COM_X.*COM_Y.*Mb.*q3.*rk.*t10.*3.0;
-  t56 = COM_X * COM_Y * Mb * q3 * rk * t10 * 3.0F;
-
-  // 'SteadyStateAcceleration_dq:63' t57 = COM_X.*COM_Z.*Mb.*q4.*rk.*t9.*3.0;
-  t57 = COM_X * COM_Z * Mb * q4 * rk * t9 * 3.0F;
-
-  // 'SteadyStateAcceleration_dq:64' t58 = COM_Y.*COM_Z.*Mb.*q1.*rk.*t7;
-  t58 = COM_Y * COM_Z * Mb * q1 * rk * t7;
-
-  // 'SteadyStateAcceleration_dq:65' t59 = COM_X.*COM_Y.*Mb.*q1.*q2.*q4.*rk.*t4.*4.0; 
-  t59 = COM_X * COM_Y * Mb * q1 * q2 * q4 * rk * t4 * 4.0F;
-
-  // 'SteadyStateAcceleration_dq:66' t60 = COM_X.*COM_Y.*Mb.*q1.*q2.*q4.*rk.*t3.*4.0; 
-  t60 = COM_X * COM_Y * Mb * q1 * q2 * q4 * rk * t3 * 4.0F;
-
-  // 'SteadyStateAcceleration_dq:67' t61 = COM_X.*COM_Y.*Mb.*q3.*rk.*t3.*t6.*6.0; 
-  t61 = COM_X * COM_Y * Mb * q3 * rk * t3 * t6 * 6.0F;
-
-  // 'SteadyStateAcceleration_dq:68' t62 = COM_X.*COM_Z.*Mb.*q4.*rk.*t3.*t4.*2.0; 
-  t62 = COM_X * COM_Z * Mb * q4 * rk * t3 * t4 * 2.0F;
-
-  // 'SteadyStateAcceleration_dq:69' t63 = COM_Y.*COM_Z.*Mb.*q1.*rk.*t4.*t6.*2.0; 
-  t63 = COM_Y * COM_Z * Mb * q1 * rk * t4 * t6 * 2.0F;
-
-  // 'SteadyStateAcceleration_dq:70' t64 = COM_Y.*COM_Z.*Mb.*q1.*rk.*t5.*t6.*6.0; 
-  t64 = COM_Y * COM_Z * Mb * q1 * rk * t5 * t6 * 6.0F;
-
-  // 'SteadyStateAcceleration_dq:71' t65 = Mb.*q1.*q3.*q4.*rk.*t4.*t13.*4.0;
-  t65 = Mb * q1 * q3 * q4 * rk * t4 * t13 * 4.0F;
-
-  // 'SteadyStateAcceleration_dq:72' t66 = COM_Y.*Jk.*q2;
-  t31 = COM_Y * Jk * q2;
-
-  // 'SteadyStateAcceleration_dq:73' t67 = COM_Z.*Jk.*q1;
-  t67 = COM_Z * Jk * q1;
-
-  // 'SteadyStateAcceleration_dq:74' t68 = COM_Y.*Mb.*q2.*t2;
-  t68 = COM_Y * Mb * q2 * t2;
-
-  // 'SteadyStateAcceleration_dq:75' t69 = COM_Z.*Mb.*q1.*t2;
-  t69 = COM_Z * Mb * q1 * t2;
-
-  // 'SteadyStateAcceleration_dq:76' t70 = COM_Y.*Mk.*q2.*t2;
-  t70 = COM_Y * Mk * q2 * t2;
-
-  // 'SteadyStateAcceleration_dq:77' t71 = COM_Z.*Mk.*q1.*t2;
-  t71 = COM_Z * Mk * q1 * t2;
-
-  // 'SteadyStateAcceleration_dq:78' t72 = Mb.*q1.*rk.*t9.*t11;
-  t72 = Mb * q1 * rk * t9 * t11;
-
-  // 'SteadyStateAcceleration_dq:79' t73 = Mb.*q1.*rk.*t11.*t12;
-  t73 = Mb * q1 * rk * t11 * t12;
-
-  // 'SteadyStateAcceleration_dq:80' t74 = Mb.*q1.*rk.*t3.*t6.*t11.*2.0;
-  t74 = Mb * q1 * rk * t3 * t6 * t11 * 2.0F;
-
-  // 'SteadyStateAcceleration_dq:81' t75 = COM_X.*COM_Y.*Mb.*q4.*rk.*t12;
-  t75 = COM_X * COM_Y * Mb * q4 * rk * t12;
-
-  // 'SteadyStateAcceleration_dq:82' t76 = COM_X.*COM_Y.*Mb.*q4.*rk.*t4.*t6.*2.0; 
-  t76 = COM_X * COM_Y * Mb * q4 * rk * t4 * t6 * 2.0F;
-
-  // 'SteadyStateAcceleration_dq:83' t77 = COM_X.*COM_Z.*Mb.*q3.*rk.*t4.*t5.*2.0; 
-  t77 = COM_X * COM_Z * Mb * q3 * rk * t4 * t5 * 2.0F;
-
-  // 'SteadyStateAcceleration_dq:84' t78 = COM_X.*COM_Y.*Mb.*q4.*rk.*t5.*t6.*2.0; 
-  t78 = COM_X * COM_Y * Mb * q4 * rk * t5 * t6 * 2.0F;
-
-  // 'SteadyStateAcceleration_dq:85' t79 = COM_Y.*COM_Z.*Mb.*q2.*rk.*t4.*t5.*2.0; 
-  t79 = COM_Y * COM_Z * Mb * q2 * rk * t4 * t5 * 2.0F;
-
-  // 'SteadyStateAcceleration_dq:86' t80 = Mb.*q2.*q3.*q4.*rk.*t5.*t11.*4.0;
-  t80 = Mb * q2 * q3 * q4 * rk * t5 * t11 * 4.0F;
-
-  // 'SteadyStateAcceleration_dq:87' t81 = Mb.*q2.*q3.*q4.*rk.*t4.*t11.*4.0;
-  t81 = Mb * q2 * q3 * q4 * rk * t4 * t11 * 4.0F;
-
-  // 'SteadyStateAcceleration_dq:88' t82 = Mb.*q1.*rk.*t4.*t5.*t11.*2.0;
-  t82 = Mb * q1 * rk * t4 * t5 * t11 * 2.0F;
-
-  // 'SteadyStateAcceleration_dq:89' t83 = COM_X.*COM_Y.*Mb.*q4.*rk.*t10;
-  t83 = COM_X * COM_Y * Mb * q4 * rk * t10;
-
-  // 'SteadyStateAcceleration_dq:90' t84 = COM_X.*COM_Z.*Mb.*q3.*rk.*t10.*3.0;
-  t84 = COM_X * COM_Z * Mb * q3 * rk * t10 * 3.0F;
-
-  // 'SteadyStateAcceleration_dq:91' t85 = COM_X.*COM_Y.*Mb.*q4.*rk.*t7;
-  t85 = COM_X * COM_Y * Mb * q4 * rk * t7;
-
-  // 'SteadyStateAcceleration_dq:92' t86 = COM_Y.*COM_Z.*Mb.*q2.*rk.*t7.*3.0;
-  t86 = COM_Y * COM_Z * Mb * q2 * rk * t7 * 3.0F;
-
-  // 'SteadyStateAcceleration_dq:93' t87 = COM_X.*COM_Y.*Mb.*q1.*q2.*q3.*rk.*t5.*4.0; 
-  t87 = COM_X * COM_Y * Mb * q1 * q2 * q3 * rk * t5 * 4.0F;
-
-  // 'SteadyStateAcceleration_dq:94' t88 = COM_X.*COM_Z.*Mb.*q3.*rk.*t3.*t4.*2.0; 
-  t88 = COM_X * COM_Z * Mb * q3 * rk * t3 * t4 * 2.0F;
-
-  // 'SteadyStateAcceleration_dq:95' t89 = COM_Y.*COM_Z.*Mb.*q2.*rk.*t3.*t6.*2.0; 
-  t89 = COM_Y * COM_Z * Mb * q2 * rk * t3 * t6 * 2.0F;
-
-  // 'SteadyStateAcceleration_dq:96' t90 = Mb.*q2.*q3.*q4.*rk.*t3.*t13.*4.0;
-  t90 = Mb * q2 * q3 * q4 * rk * t3 * t13 * 4.0F;
-
-  // 'SteadyStateAcceleration_dq:97' t91 = COM_X.*COM_Y.*Mb.*q1.*q2.*q3.*rk.*t6.*4.0; 
-  t91 = COM_X * COM_Y * Mb * q1 * q2 * q3 * rk * t6 * 4.0F;
-
-  // 'SteadyStateAcceleration_dq:98' t92 = COM_X.*Jk.*q2;
-  t92 = COM_X * Jk * q2;
-
-  // 'SteadyStateAcceleration_dq:99' t93 = COM_Y.*Jk.*q3;
-  t93 = COM_Y * Jk * q3;
-
-  // 'SteadyStateAcceleration_dq:100' t94 = COM_Z.*Jk.*q4;
-  t94 = COM_Z * Jk * q4;
-
-  // 'SteadyStateAcceleration_dq:101' t95 = COM_X.*Mb.*q2.*t2;
-  t95 = COM_X * Mb * q2 * t2;
-
-  // 'SteadyStateAcceleration_dq:102' t96 = COM_Y.*Mb.*q3.*t2;
-  t96 = COM_Y * Mb * q3 * t2;
-
-  // 'SteadyStateAcceleration_dq:103' t97 = COM_Z.*Mb.*q4.*t2;
-  t97 = COM_Z * Mb * q4 * t2;
-
-  // 'SteadyStateAcceleration_dq:104' t98 = COM_X.*Mk.*q2.*t2;
-  t98 = COM_X * Mk * q2 * t2;
-
-  // 'SteadyStateAcceleration_dq:105' t99 = COM_Y.*Mk.*q3.*t2;
-  t99 = COM_Y * Mk * q3 * t2;
-
-  // 'SteadyStateAcceleration_dq:106' t100 = COM_Z.*Mk.*q4.*t2;
-  t100 = COM_Z * Mk * q4 * t2;
-
-  // 'SteadyStateAcceleration_dq:107' t101 = Mb.*q4.*rk.*t11.*t12;
-  t101 = Mb * q4 * rk * t11 * t12;
-
-  // 'SteadyStateAcceleration_dq:108' t102 = Mb.*q4.*rk.*t9.*t11;
-  t102 = Mb * q4 * rk * t9 * t11;
-
-  // 'SteadyStateAcceleration_dq:109' t103 = Mb.*q4.*rk.*t3.*t6.*t11.*2.0;
-  t103 = Mb * q4 * rk * t3 * t6 * t11 * 2.0F;
-
-  // 'SteadyStateAcceleration_dq:110' t104 = COM_X.*COM_Z.*Mb.*q2.*rk.*t10;
-  t104 = COM_X * COM_Z * Mb * q2 * rk * t10;
-
-  // 'SteadyStateAcceleration_dq:111' t105 = COM_X.*COM_Z.*Mb.*q2.*rk.*t3.*t4.*2.0; 
-  t105 = COM_X * COM_Z * Mb * q2 * rk * t3 * t4 * 2.0F;
-
-  // 'SteadyStateAcceleration_dq:112' t106 = COM_X.*COM_Y.*Mb.*q1.*rk.*t3.*t6.*2.0; 
-  t106 = COM_X * COM_Y * Mb * q1 * rk * t3 * t6 * 2.0F;
-
-  // 'SteadyStateAcceleration_dq:113' t107 = COM_Y.*COM_Z.*Mb.*q3.*rk.*t4.*t5.*2.0; 
-  t107 = COM_Y * COM_Z * Mb * q3 * rk * t4 * t5 * 2.0F;
-
-  // 'SteadyStateAcceleration_dq:114' t108 = Mb.*q1.*q2.*q3.*rk.*t5.*t11.*4.0;
-  t108 = Mb * q1 * q2 * q3 * rk * t5 * t11 * 4.0F;
-
-  // 'SteadyStateAcceleration_dq:115' t109 = Mb.*q1.*q2.*q3.*rk.*t4.*t11.*4.0;
-  t109 = Mb * q1 * q2 * q3 * rk * t4 * t11 * 4.0F;
-
-  // 'SteadyStateAcceleration_dq:116' t110 = Mb.*q4.*rk.*t4.*t5.*t11.*2.0;
-  t110 = Mb * q4 * rk * t4 * t5 * t11 * 2.0F;
-
-  // 'SteadyStateAcceleration_dq:117' t111 = COM_X.*COM_Z.*Mb.*q2.*rk.*t9;
-  t111 = COM_X * COM_Z * Mb * q2 * rk * t9;
-
-  // 'SteadyStateAcceleration_dq:118' t112 = COM_X.*COM_Y.*Mb.*q1.*rk.*t12.*3.0; 
-  t112 = COM_X * COM_Y * Mb * q1 * rk * t12 * 3.0F;
-
-  // 'SteadyStateAcceleration_dq:119' t113 = COM_Y.*COM_Z.*Mb.*q3.*rk.*t10.*3.0; 
-  t113 = COM_Y * COM_Z * Mb * q3 * rk * t10 * 3.0F;
-
-  // 'SteadyStateAcceleration_dq:120' t114 = COM_X.*COM_Y.*Mb.*q2.*q3.*q4.*rk.*t6.*4.0; 
-  t114 = COM_X * COM_Y * Mb * q2 * q3 * q4 * rk * t6 * 4.0F;
-
-  // 'SteadyStateAcceleration_dq:121' t115 = COM_X.*COM_Y.*Mb.*q2.*q3.*q4.*rk.*t5.*4.0; 
-  t115 = COM_X * COM_Y * Mb * q2 * q3 * q4 * rk * t5 * 4.0F;
-
-  // 'SteadyStateAcceleration_dq:122' t116 = COM_X.*COM_Y.*Mb.*q1.*rk.*t4.*t5.*6.0; 
-  t116 = COM_X * COM_Y * Mb * q1 * rk * t4 * t5 * 6.0F;
-
-  // 'SteadyStateAcceleration_dq:123' t117 = COM_X.*COM_Z.*Mb.*q2.*rk.*t3.*t5.*6.0; 
-  t117 = COM_X * COM_Z * Mb * q2 * rk * t3 * t5 * 6.0F;
-
-  // 'SteadyStateAcceleration_dq:124' t118 = COM_X.*COM_Z.*Mb.*q2.*rk.*t3.*t6.*2.0; 
-  t118 = COM_X * COM_Z * Mb * q2 * rk * t3 * t6 * 2.0F;
-
-  // 'SteadyStateAcceleration_dq:125' t119 = COM_Y.*COM_Z.*Mb.*q3.*rk.*t3.*t6.*2.0; 
-  t119 = COM_Y * COM_Z * Mb * q3 * rk * t3 * t6 * 2.0F;
-
-  // 'SteadyStateAcceleration_dq:126' t120 = Mb.*q1.*q2.*q3.*rk.*t6.*t13.*4.0;
-  t120 = Mb * q1 * q2 * q3 * rk * t6 * t13 * 4.0F;
-
-  // 'SteadyStateAcceleration_dq:127' t121 = COM_Y.*Jk.*q4;
-  t121 = COM_Y * Jk * q4;
-
-  // 'SteadyStateAcceleration_dq:128' t122 = COM_Y.*Mb.*q4.*t2;
-  t122 = COM_Y * Mb * q4 * t2;
-
-  // 'SteadyStateAcceleration_dq:129' t123 = COM_Y.*Mk.*q4.*t2;
-  t123 = COM_Y * Mk * q4 * t2;
-
-  // 'SteadyStateAcceleration_dq:130' t124 = Mb.*q3.*rk.*t7.*t11;
-  t124 = Mb * q3 * rk * t7 * t11;
-
-  // 'SteadyStateAcceleration_dq:131' t125 = Mb.*q3.*rk.*t10.*t11;
-  t125 = Mb * q3 * rk * t10 * t11;
-
-  // 'SteadyStateAcceleration_dq:132' t126 = Mb.*q3.*rk.*t4.*t5.*t11.*2.0;
-  t126 = Mb * q3 * rk * t4 * t5 * t11 * 2.0F;
-
-  // 'SteadyStateAcceleration_dq:133' t127 = COM_X.*COM_Y.*Mb.*q2.*rk.*t10;
-  t127 = COM_X * COM_Y * Mb * q2 * rk * t10;
-
-  // 'SteadyStateAcceleration_dq:134' t128 = COM_X.*COM_Z.*Mb.*q1.*rk.*t9;
-  t128 = COM_X * COM_Z * Mb * q1 * rk * t9;
-
-  // 'SteadyStateAcceleration_dq:135' t129 = COM_Y.*COM_Z.*Mb.*q4.*rk.*t12;
-  t129 = COM_Y * COM_Z * Mb * q4 * rk * t12;
-
-  // 'SteadyStateAcceleration_dq:136' t130 = COM_X.*COM_Y.*Mb.*q2.*rk.*t3.*t4.*2.0; 
-  t130 = COM_X * COM_Y * Mb * q2 * rk * t3 * t4 * 2.0F;
-
-  // 'SteadyStateAcceleration_dq:137' t131 = COM_X.*COM_Z.*Mb.*q1.*rk.*t3.*t4.*2.0; 
-  t131 = COM_X * COM_Z * Mb * q1 * rk * t3 * t4 * 2.0F;
-
-  // 'SteadyStateAcceleration_dq:138' t132 = COM_X.*COM_Y.*Mb.*q2.*rk.*t4.*t6.*2.0; 
-  t132 = COM_X * COM_Y * Mb * q2 * rk * t4 * t6 * 2.0F;
-
-  // 'SteadyStateAcceleration_dq:139' t133 = COM_Y.*COM_Z.*Mb.*q4.*rk.*t4.*t6.*2.0; 
-  t133 = COM_Y * COM_Z * Mb * q4 * rk * t4 * t6 * 2.0F;
-
-  // 'SteadyStateAcceleration_dq:140' t134 = Mb.*q1.*q2.*q4.*rk.*t6.*t11.*4.0;
-  t134 = Mb * q1 * q2 * q4 * rk * t6 * t11 * 4.0F;
-
-  // 'SteadyStateAcceleration_dq:141' t135 = Mb.*q1.*q2.*q4.*rk.*t3.*t11.*4.0;
-  t135 = Mb * q1 * q2 * q4 * rk * t3 * t11 * 4.0F;
-
-  // 'SteadyStateAcceleration_dq:142' t136 = Mb.*q3.*rk.*t3.*t6.*t11.*2.0;
-  t136 = Mb * q3 * rk * t3 * t6 * t11 * 2.0F;
-
-  // 'SteadyStateAcceleration_dq:143' t137 = COM_X.*COM_Y.*Mb.*q2.*rk.*t9;
-  t137 = COM_X * COM_Y * Mb * q2 * rk * t9;
-
-  // 'SteadyStateAcceleration_dq:144' t138 = COM_X.*COM_Z.*Mb.*q1.*rk.*t10;
-  t138 = COM_X * COM_Z * Mb * q1 * rk * t10;
-
-  // 'SteadyStateAcceleration_dq:145' t139 = COM_X.*COM_Y.*Mb.*q2.*rk.*t12;
-  t139 = COM_X * COM_Y * Mb * q2 * rk * t12;
-
-  // 'SteadyStateAcceleration_dq:146' t140 = COM_Y.*COM_Z.*Mb.*q4.*rk.*t10;
-  t140 = COM_Y * COM_Z * Mb * q4 * rk * t10;
-
-  // 'SteadyStateAcceleration_dq:147' t141 = COM_X.*COM_Y.*Mb.*q1.*q3.*q4.*rk.*t3.*4.0; 
-  t141 = COM_X * COM_Y * Mb * q1 * q3 * q4 * rk * t3 * 4.0F;
-
-  // 'SteadyStateAcceleration_dq:148' t142 = COM_X.*COM_Z.*Mb.*q1.*rk.*t4.*t5.*2.0; 
-  t142 = COM_X * COM_Z * Mb * q1 * rk * t4 * t5 * 2.0F;
-
-  // 'SteadyStateAcceleration_dq:149' t143 = COM_X.*COM_Z.*Mb.*q1.*rk.*t4.*t6.*6.0; 
-  t143 = COM_X * COM_Z * Mb * q1 * rk * t4 * t6 * 6.0F;
-
-  // 'SteadyStateAcceleration_dq:150' t144 = COM_Y.*COM_Z.*Mb.*q4.*rk.*t3.*t4.*6.0; 
-  t144 = COM_Y * COM_Z * Mb * q4 * rk * t3 * t4 * 6.0F;
-
-  // 'SteadyStateAcceleration_dq:151' t145 = COM_Y.*COM_Z.*Mb.*q4.*rk.*t3.*t5.*2.0; 
-  t145 = COM_Y * COM_Z * Mb * q4 * rk * t3 * t5 * 2.0F;
-
-  // 'SteadyStateAcceleration_dq:152' t146 = Mb.*q1.*q2.*q4.*rk.*t5.*t13.*4.0;
-  t146 = Mb * q1 * q2 * q4 * rk * t5 * t13 * 4.0F;
-
-  // 'SteadyStateAcceleration_dq:153' t147 = COM_X.*COM_Y.*Mb.*q1.*q3.*q4.*rk.*t4.*4.0; 
-  t147 = COM_X * COM_Y * Mb * q1 * q3 * q4 * rk * t4 * 4.0F;
-
-  // 'SteadyStateAcceleration_dq:154' dAcceleration_dq = reshape([Mb.*g.*rk.*t32.*(t121+t122+t123+t124+t125+t126+t127+t128+t129+t130+t131+t132+t133+t134+t135+t136+t137+t138+t139+t140+t141+t142+t143+t144+t145+t146+t147-COM_X.*Jk.*q1-COM_Z.*Jk.*q3-COM_X.*Mb.*q1.*t2-COM_Z.*Mb.*q3.*t2-COM_X.*Mk.*q1.*t2-COM_Z.*Mk.*q3.*t2+Mb.*q3.*rk.*t7.*t8-Mb.*q3.*rk.*t8.*t9-Mb.*q3.*rk.*t8.*t10+Mb.*q3.*rk.*t8.*t12+Mb.*q3.*rk.*t9.*t11.*3.0+Mb.*q3.*rk.*t10.*t13.*2.0-Mb.*q3.*rk.*t11.*t12+Mb.*q3.*rk.*t12.*t13.*2.0-COM_X.*COM_Y.*Mb.*q2.*rk.*t7.*3.0+COM_X.*COM_Z.*Mb.*q1.*rk.*t7-COM_Y.*COM_Z.*Mb.*q4.*rk.*t7.*3.0-COM_X.*COM_Z.*Mb.*q1.*rk.*t12.*3.0-COM_Y.*COM_Z.*Mb.*q4.*rk.*t9.*3.0-Mb.*q3.*rk.*t3.*t4.*t8.*2.0+Mb.*q3.*rk.*t3.*t5.*t8.*4.0+Mb.*q3.*rk.*t3.*t6.*t8.*4.0+Mb.*q3.*rk.*t5.*t6.*t8.*2.0+Mb.*q3.*rk.*t3.*t4.*t13.*6.0-Mb.*q3.*rk.*t3.*t6.*t13.*2.0+Mb.*q3.*rk.*t4.*t5.*t13.*2.0+Mb.*q3.*rk.*t4.*t6.*t13.*4.0+Mb.*q3.*rk.*t5.*t6.*t13.*2.0-Mb.*q1.*q2.*q4.*rk.*t5.*t8.*4.0-Mb.*q1.*q2.*q4.*rk.*t6.*t8.*4.0-Mb.*q1.*q2.*q4.*rk.*t3.*t13.*4.0-COM_X.*COM_Y.*Mb.*q2.*rk.*t3.*t5.*1.0e1-COM_X.*COM_Z.*Mb.*q1.*rk.*t3.*t5.*6.0-COM_X.*COM_Y.*Mb.*q2.*rk.*t3.*t6.*6.0-COM_X.*COM_Y.*Mb.*q2.*rk.*t4.*t5.*2.0-COM_X.*COM_Z.*Mb.*q1.*rk.*t3.*t6.*2.0-COM_X.*COM_Y.*Mb.*q2.*rk.*t5.*t6.*2.0-COM_X.*COM_Z.*Mb.*q1.*rk.*t5.*t6.*2.0-COM_Y.*COM_Z.*Mb.*q4.*rk.*t3.*t6.*2.0-COM_Y.*COM_Z.*Mb.*q4.*rk.*t4.*t5.*2.0-COM_Y.*COM_Z.*Mb.*q4.*rk.*t5.*t6.*2.0+COM_Y.*COM_Z.*Mb.*q1.*q2.*q3.*rk.*t3.*8.0-COM_X.*COM_Y.*Mb.*q1.*q3.*q4.*rk.*t5.*4.0-COM_X.*COM_Z.*Mb.*q2.*q3.*q4.*rk.*t3.*4.0-COM_X.*COM_Y.*Mb.*q1.*q3.*q4.*rk.*t6.*4.0-COM_X.*COM_Z.*Mb.*q2.*q3.*q4.*rk.*t4.*4.0+COM_Y.*COM_Z.*Mb.*q1.*q2.*q3.*rk.*t6.*8.0-COM_X.*COM_Z.*Mb.*q2.*q3.*q4.*rk.*t5.*4.0-COM_X.*COM_Z.*Mb.*q2.*q3.*q4.*rk.*t6.*4.0).*-2.0,Mb.*g.*rk.*t32.*(t40+t41+t42+t43+t44+t45+t46+t47+t48-t49-t50-t51-t52-t53-t54+t55-t56-t57-t58+t59-t60-t61+t62+t63-t64+t65-COM_Z.*Jk.*q2-COM_Z.*Mb.*q2.*t2-COM_Z.*Mk.*q2.*t2+Mb.*q2.*rk.*t7.*t8.*2.0-Mb.*q2.*rk.*t7.*t13+Mb.*q2.*rk.*t8.*t12.*2.0+Mb.*q2.*rk.*t9.*t11.*3.0-Mb.*q2.*rk.*t9.*t13+Mb.*q2.*rk.*t10.*t13-Mb.*q2.*rk.*t11.*t12+Mb.*q2.*rk.*t12.*t13+COM_X.*COM_Y.*Mb.*q3.*rk.*t7+COM_X.*COM_Y.*Mb.*q3.*rk.*t9+COM_X.*COM_Z.*Mb.*q4.*rk.*t7-COM_Y.*COM_Z.*Mb.*q1.*rk.*t10+COM_X.*COM_Y.*Mb.*q3.*rk.*t12-COM_X.*COM_Z.*Mb.*q4.*rk.*t10.*3.0+COM_Y.*COM_Z.*Mb.*q1.*rk.*t12.*3.0+COM_X.*COM_Z.*Mb.*q4.*rk.*t12+Mb.*q2.*rk.*t3.*t5.*t8.*6.0-Mb.*q2.*rk.*t3.*t6.*t8.*2.0+Mb.*q2.*rk.*t4.*t5.*t8.*2.0+Mb.*q2.*rk.*t4.*t6.*t8.*2.0+Mb.*q2.*rk.*t5.*t6.*t8.*4.0+Mb.*q2.*rk.*t3.*t4.*t13.*4.0-Mb.*q2.*rk.*t3.*t5.*t13.*2.0+Mb.*q2.*rk.*t3.*t6.*t13.*4.0+Mb.*q2.*rk.*t4.*t6.*t13.*2.0+Mb.*q1.*q3.*q4.*rk.*t3.*t8.*4.0-Mb.*q1.*q3.*q4.*rk.*t4.*t8.*4.0+Mb.*q1.*q3.*q4.*rk.*t6.*t13.*4.0-COM_X.*COM_Y.*Mb.*q3.*rk.*t3.*t4.*1.0e1+COM_Y.*COM_Z.*Mb.*q1.*rk.*t3.*t4.*6.0+COM_X.*COM_Y.*Mb.*q3.*rk.*t3.*t5.*2.0+COM_Y.*COM_Z.*Mb.*q1.*rk.*t3.*t6.*2.0-COM_Y.*COM_Z.*Mb.*q1.*rk.*t4.*t5.*2.0-COM_X.*COM_Y.*Mb.*q3.*rk.*t4.*t6.*2.0+COM_X.*COM_Z.*Mb.*q4.*rk.*t3.*t5.*6.0+COM_X.*COM_Y.*Mb.*q3.*rk.*t5.*t6.*2.0-COM_X.*COM_Z.*Mb.*q4.*rk.*t4.*t5.*2.0-COM_X.*COM_Z.*Mb.*q4.*rk.*t4.*t6.*2.0+COM_X.*COM_Z.*Mb.*q4.*rk.*t5.*t6.*2.0-COM_X.*COM_Z.*Mb.*q1.*q2.*q3.*rk.*t3.*8.0-COM_X.*COM_Y.*Mb.*q1.*q2.*q4.*rk.*t5.*4.0+COM_X.*COM_Y.*Mb.*q1.*q2.*q4.*rk.*t6.*4.0-COM_X.*COM_Z.*Mb.*q1.*q2.*q3.*rk.*t6.*8.0-COM_Y.*COM_Z.*Mb.*q2.*q3.*q4.*rk.*t3.*4.0-COM_Y.*COM_Z.*Mb.*q2.*q3.*q4.*rk.*t4.*4.0-COM_Y.*COM_Z.*Mb.*q2.*q3.*q4.*rk.*t5.*4.0-COM_Y.*COM_Z.*Mb.*q2.*q3.*q4.*rk.*t6.*4.0).*2.0,Mb.*g.*rk.*t32.*(t92+t93+t94+t95+t96+t97+t98+t99+t100+t101+t102+t103+t104+t105+t106+t107+t108+t109+t110+t111+t112+t113+t114+t115+t116+t117+t118+t119+t120+Mb.*q4.*rk.*t7.*t8-Mb.*q4.*rk.*t8.*t9-Mb.*q4.*rk.*t7.*t11-Mb.*q4.*rk.*t8.*t10+Mb.*q4.*rk.*t7.*t13.*2.0+Mb.*q4.*rk.*t8.*t12+Mb.*q4.*rk.*t10.*t11.*3.0+Mb.*q4.*rk.*t9.*t13.*2.0-COM_X.*COM_Y.*Mb.*q1.*rk.*t7-COM_X.*COM_Y.*Mb.*q1.*rk.*t9-COM_X.*COM_Z.*Mb.*q2.*rk.*t7.*3.0-COM_X.*COM_Y.*Mb.*q1.*rk.*t10-COM_Y.*COM_Z.*Mb.*q3.*rk.*t7-COM_Y.*COM_Z.*Mb.*q3.*rk.*t9+COM_X.*COM_Z.*Mb.*q2.*rk.*t12+COM_Y.*COM_Z.*Mb.*q3.*rk.*t12.*3.0-Mb.*q4.*rk.*t3.*t4.*t8.*2.0+Mb.*q4.*rk.*t4.*t5.*t8.*4.0+Mb.*q4.*rk.*t4.*t6.*t8.*4.0+Mb.*q4.*rk.*t5.*t6.*t8.*2.0+Mb.*q4.*rk.*t3.*t4.*t13.*6.0+Mb.*q4.*rk.*t3.*t5.*t13.*4.0+Mb.*q4.*rk.*t3.*t6.*t13.*2.0-Mb.*q4.*rk.*t4.*t5.*t13.*2.0+Mb.*q4.*rk.*t5.*t6.*t13.*2.0-Mb.*q1.*q2.*q3.*rk.*t5.*t8.*4.0-Mb.*q1.*q2.*q3.*rk.*t6.*t8.*4.0-Mb.*q1.*q2.*q3.*rk.*t4.*t13.*4.0-COM_X.*COM_Y.*Mb.*q1.*rk.*t3.*t4.*2.0-COM_X.*COM_Y.*Mb.*q1.*rk.*t3.*t5.*2.0+COM_X.*COM_Y.*Mb.*q1.*rk.*t4.*t6.*1.0e1+COM_X.*COM_Y.*Mb.*q1.*rk.*t5.*t6.*2.0-COM_X.*COM_Z.*Mb.*q2.*rk.*t4.*t5.*2.0-COM_Y.*COM_Z.*Mb.*q3.*rk.*t3.*t4.*6.0-COM_X.*COM_Z.*Mb.*q2.*rk.*t4.*t6.*6.0-COM_Y.*COM_Z.*Mb.*q3.*rk.*t3.*t5.*2.0-COM_X.*COM_Z.*Mb.*q2.*rk.*t5.*t6.*2.0-COM_Y.*COM_Z.*Mb.*q3.*rk.*t4.*t6.*2.0+COM_Y.*COM_Z.*Mb.*q3.*rk.*t5.*t6.*2.0-COM_X.*COM_Y.*Mb.*q2.*q3.*q4.*rk.*t3.*4.0-COM_X.*COM_Z.*Mb.*q1.*q3.*q4.*rk.*t3.*4.0-COM_X.*COM_Y.*Mb.*q2.*q3.*q4.*rk.*t4.*4.0-COM_X.*COM_Z.*Mb.*q1.*q3.*q4.*rk.*t4.*4.0-COM_Y.*COM_Z.*Mb.*q1.*q2.*q4.*rk.*t4.*8.0-COM_X.*COM_Z.*Mb.*q1.*q3.*q4.*rk.*t5.*4.0-COM_Y.*COM_Z.*Mb.*q1.*q2.*q4.*rk.*t5.*8.0-COM_X.*COM_Z.*Mb.*q1.*q3.*q4.*rk.*t6.*4.0).*2.0,Mb.*g.*rk.*t32.*(t66+t67+t68+t69+t70+t71+t72+t73+t74-t75-t76-t77-t78-t79-t80-t81+t82-t83-t84-t85-t86-t87+t88+t89+t90+t91-COM_X.*Jk.*q3-COM_X.*Mb.*q3.*t2-COM_X.*Mk.*q3.*t2+Mb.*q1.*rk.*t7.*t8.*2.0-Mb.*q1.*rk.*t7.*t11+Mb.*q1.*rk.*t7.*t13+Mb.*q1.*rk.*t8.*t12.*2.0+Mb.*q1.*rk.*t10.*t11.*3.0+Mb.*q1.*rk.*t9.*t13-Mb.*q1.*rk.*t10.*t13-Mb.*q1.*rk.*t12.*t13+COM_X.*COM_Z.*Mb.*q3.*rk.*t7+COM_X.*COM_Y.*Mb.*q4.*rk.*t9.*3.0-COM_X.*COM_Z.*Mb.*q3.*rk.*t9.*3.0+COM_Y.*COM_Z.*Mb.*q2.*rk.*t9+COM_Y.*COM_Z.*Mb.*q2.*rk.*t10+COM_X.*COM_Z.*Mb.*q3.*rk.*t12+COM_Y.*COM_Z.*Mb.*q2.*rk.*t12+Mb.*q1.*rk.*t3.*t5.*t8.*2.0+Mb.*q1.*rk.*t3.*t6.*t8.*2.0-Mb.*q1.*rk.*t4.*t5.*t8.*2.0+Mb.*q1.*rk.*t4.*t6.*t8.*6.0+Mb.*q1.*rk.*t5.*t6.*t8.*4.0+Mb.*q1.*rk.*t3.*t4.*t13.*4.0+Mb.*q1.*rk.*t3.*t5.*t13.*2.0+Mb.*q1.*rk.*t4.*t5.*t13.*4.0-Mb.*q1.*rk.*t4.*t6.*t13.*2.0-Mb.*q2.*q3.*q4.*rk.*t3.*t8.*4.0+Mb.*q2.*q3.*q4.*rk.*t4.*t8.*4.0+Mb.*q2.*q3.*q4.*rk.*t5.*t13.*4.0+COM_X.*COM_Y.*Mb.*q4.*rk.*t3.*t4.*1.0e1-COM_Y.*COM_Z.*Mb.*q2.*rk.*t3.*t4.*6.0+COM_X.*COM_Y.*Mb.*q4.*rk.*t3.*t5.*2.0-COM_X.*COM_Z.*Mb.*q3.*rk.*t3.*t5.*2.0-COM_Y.*COM_Z.*Mb.*q2.*rk.*t3.*t5.*2.0+COM_X.*COM_Y.*Mb.*q4.*rk.*t3.*t6.*2.0+COM_X.*COM_Y.*Mb.*q4.*rk.*t4.*t5.*6.0-COM_X.*COM_Z.*Mb.*q3.*rk.*t3.*t6.*2.0+COM_X.*COM_Z.*Mb.*q3.*rk.*t4.*t6.*6.0+COM_Y.*COM_Z.*Mb.*q2.*rk.*t4.*t6.*2.0+COM_X.*COM_Z.*Mb.*q3.*rk.*t5.*t6.*2.0+COM_Y.*COM_Z.*Mb.*q2.*rk.*t5.*t6.*6.0-COM_X.*COM_Y.*Mb.*q1.*q2.*q3.*rk.*t3.*4.0+COM_X.*COM_Y.*Mb.*q1.*q2.*q3.*rk.*t4.*4.0-COM_X.*COM_Z.*Mb.*q1.*q2.*q4.*rk.*t4.*8.0-COM_X.*COM_Z.*Mb.*q1.*q2.*q4.*rk.*t5.*8.0+COM_Y.*COM_Z.*Mb.*q1.*q3.*q4.*rk.*t3.*4.0+COM_Y.*COM_Z.*Mb.*q1.*q3.*q4.*rk.*t4.*4.0+COM_Y.*COM_Z.*Mb.*q1.*q3.*q4.*rk.*t5.*4.0+COM_Y.*COM_Z.*Mb.*q1.*q3.*q4.*rk.*t6.*4.0).*-2.0,Mb.*g.*rk.*t32.*(t66+t67+t68+t69+t70+t71+t72+t73+t74+t75+t76+t77+t78+t79+t80+t81+t82+t83+t84+t85+t86+t87+t88+t89+t90+t91-COM_X.*Jk.*q3-COM_X.*Mb.*q3.*t2-COM_X.*Mk.*q3.*t2-Mb.*q1.*rk.*t7.*t8+Mb.*q1.*rk.*t8.*t9+Mb.*q1.*rk.*t7.*t11.*3.0+Mb.*q1.*rk.*t8.*t10-Mb.*q1.*rk.*t8.*t12-Mb.*q1.*rk.*t10.*t11+Mb.*q1.*rk.*t10.*t13.*2.0+Mb.*q1.*rk.*t12.*t13.*2.0-COM_X.*COM_Z.*Mb.*q3.*rk.*t7-COM_X.*COM_Y.*Mb.*q4.*rk.*t9.*3.0-COM_X.*COM_Z.*Mb.*q3.*rk.*t9+COM_Y.*COM_Z.*Mb.*q2.*rk.*t9.*3.0-COM_Y.*COM_Z.*Mb.*q2.*rk.*t10-COM_X.*COM_Z.*Mb.*q3.*rk.*t12-COM_Y.*COM_Z.*Mb.*q2.*rk.*t12+Mb.*q1.*rk.*t3.*t4.*t8.*2.0+Mb.*q1.*rk.*t3.*t5.*t8.*4.0+Mb.*q1.*rk.*t4.*t5.*t8.*4.0-Mb.*q1.*rk.*t5.*t6.*t8.*2.0+Mb.*q1.*rk.*t3.*t4.*t13.*2.0+Mb.*q1.*rk.*t3.*t6.*t13.*2.0-Mb.*q1.*rk.*t4.*t5.*t13.*2.0+Mb.*q1.*rk.*t4.*t6.*t13.*4.0+Mb.*q1.*rk.*t5.*t6.*t13.*6.0-Mb.*q2.*q3.*q4.*rk.*t3.*t8.*4.0-Mb.*q2.*q3.*q4.*rk.*t4.*t8.*4.0-Mb.*q2.*q3.*q4.*rk.*t5.*t13.*4.0-COM_X.*COM_Y.*Mb.*q4.*rk.*t3.*t4.*2.0+COM_Y.*COM_Z.*Mb.*q2.*rk.*t3.*t4.*2.0-COM_X.*COM_Y.*Mb.*q4.*rk.*t3.*t5.*1.0e1+COM_X.*COM_Z.*Mb.*q3.*rk.*t3.*t5.*6.0-COM_Y.*COM_Z.*Mb.*q2.*rk.*t3.*t5.*2.0-COM_X.*COM_Y.*Mb.*q4.*rk.*t3.*t6.*2.0-COM_X.*COM_Y.*Mb.*q4.*rk.*t4.*t5.*6.0-COM_X.*COM_Z.*Mb.*q3.*rk.*t3.*t6.*2.0-COM_X.*COM_Z.*Mb.*q3.*rk.*t4.*t6.*6.0-COM_Y.*COM_Z.*Mb.*q2.*rk.*t4.*t6.*2.0-COM_X.*COM_Z.*Mb.*q3.*rk.*t5.*t6.*2.0-COM_Y.*COM_Z.*Mb.*q2.*rk.*t5.*t6.*6.0-COM_X.*COM_Y.*Mb.*q1.*q2.*q3.*rk.*t3.*4.0-COM_X.*COM_Y.*Mb.*q1.*q2.*q3.*rk.*t4.*4.0+COM_X.*COM_Z.*Mb.*q1.*q2.*q4.*rk.*t3.*4.0+COM_X.*COM_Z.*Mb.*q1.*q2.*q4.*rk.*t4.*4.0+COM_X.*COM_Z.*Mb.*q1.*q2.*q4.*rk.*t5.*4.0+COM_X.*COM_Z.*Mb.*q1.*q2.*q4.*rk.*t6.*4.0-COM_Y.*COM_Z.*Mb.*q1.*q3.*q4.*rk.*t4.*8.0-COM_Y.*COM_Z.*Mb.*q1.*q3.*q4.*rk.*t5.*8.0).*2.0,Mb.*g.*rk.*t32.*(t92+t93+t94+t95+t96+t97+t98+t99+t100+t101+t102+t103-t104-t105-t106-t107-t108-t109+t110-t111-t112-t113+t114-t115-t116-t117+t118+t119+t120+Mb.*q4.*rk.*t8.*t9.*2.0+Mb.*q4.*rk.*t7.*t11.*3.0+Mb.*q4.*rk.*t8.*t10.*2.0-Mb.*q4.*rk.*t7.*t13-Mb.*q4.*rk.*t10.*t11-Mb.*q4.*rk.*t9.*t13+Mb.*q4.*rk.*t10.*t13+Mb.*q4.*rk.*t12.*t13+COM_X.*COM_Y.*Mb.*q1.*rk.*t7+COM_X.*COM_Y.*Mb.*q1.*rk.*t9+COM_X.*COM_Z.*Mb.*q2.*rk.*t7.*3.0+COM_X.*COM_Y.*Mb.*q1.*rk.*t10+COM_Y.*COM_Z.*Mb.*q3.*rk.*t7+COM_Y.*COM_Z.*Mb.*q3.*rk.*t9+COM_X.*COM_Z.*Mb.*q2.*rk.*t12.*3.0+COM_Y.*COM_Z.*Mb.*q3.*rk.*t12+Mb.*q4.*rk.*t3.*t4.*t8.*4.0+Mb.*q4.*rk.*t3.*t5.*t8.*6.0+Mb.*q4.*rk.*t3.*t6.*t8.*2.0-Mb.*q4.*rk.*t4.*t5.*t8.*2.0+Mb.*q4.*rk.*t4.*t6.*t8.*2.0-Mb.*q4.*rk.*t3.*t5.*t13.*2.0+Mb.*q4.*rk.*t4.*t5.*t13.*4.0+Mb.*q4.*rk.*t4.*t6.*t13.*2.0+Mb.*q4.*rk.*t5.*t6.*t13.*4.0+Mb.*q1.*q2.*q3.*rk.*t5.*t8.*4.0-Mb.*q1.*q2.*q3.*rk.*t6.*t8.*4.0+Mb.*q1.*q2.*q3.*rk.*t4.*t13.*4.0+COM_X.*COM_Y.*Mb.*q1.*rk.*t3.*t4.*2.0+COM_X.*COM_Y.*Mb.*q1.*rk.*t3.*t5.*2.0-COM_X.*COM_Y.*Mb.*q1.*rk.*t4.*t6.*2.0-COM_X.*COM_Y.*Mb.*q1.*rk.*t5.*t6.*1.0e1+COM_X.*COM_Z.*Mb.*q2.*rk.*t4.*t5.*2.0+COM_Y.*COM_Z.*Mb.*q3.*rk.*t3.*t4.*6.0+COM_X.*COM_Z.*Mb.*q2.*rk.*t4.*t6.*2.0+COM_Y.*COM_Z.*Mb.*q3.*rk.*t3.*t5.*2.0-COM_X.*COM_Z.*Mb.*q2.*rk.*t5.*t6.*2.0-COM_Y.*COM_Z.*Mb.*q3.*rk.*t4.*t6.*2.0-COM_Y.*COM_Z.*Mb.*q3.*rk.*t5.*t6.*6.0-COM_X.*COM_Y.*Mb.*q2.*q3.*q4.*rk.*t3.*4.0+COM_Y.*COM_Z.*Mb.*q1.*q2.*q4.*rk.*t3.*4.0+COM_X.*COM_Y.*Mb.*q2.*q3.*q4.*rk.*t4.*4.0+COM_X.*COM_Z.*Mb.*q1.*q3.*q4.*rk.*t4.*8.0+COM_Y.*COM_Z.*Mb.*q1.*q2.*q4.*rk.*t4.*4.0+COM_X.*COM_Z.*Mb.*q1.*q3.*q4.*rk.*t5.*8.0+COM_Y.*COM_Z.*Mb.*q1.*q2.*q4.*rk.*t5.*4.0+COM_Y.*COM_Z.*Mb.*q1.*q2.*q4.*rk.*t6.*4.0).*2.0,Mb.*g.*rk.*t32.*(t40+t41+t42+t43+t44+t45+t46+t47+t48+t49+t50+t51+t52+t53+t54+t55+t56+t57+t58+t59+t60+t61+t62+t63+t64+t65-COM_Z.*Jk.*q2-COM_Z.*Mb.*q2.*t2-COM_Z.*Mk.*q2.*t2-Mb.*q2.*rk.*t7.*t8+Mb.*q2.*rk.*t8.*t9+Mb.*q2.*rk.*t8.*t10+Mb.*q2.*rk.*t7.*t13.*2.0-Mb.*q2.*rk.*t8.*t12-Mb.*q2.*rk.*t9.*t11+Mb.*q2.*rk.*t9.*t13.*2.0+Mb.*q2.*rk.*t11.*t12.*3.0-COM_X.*COM_Y.*Mb.*q3.*rk.*t7-COM_X.*COM_Y.*Mb.*q3.*rk.*t9-COM_X.*COM_Z.*Mb.*q4.*rk.*t7-COM_Y.*COM_Z.*Mb.*q1.*rk.*t10.*3.0-COM_X.*COM_Y.*Mb.*q3.*rk.*t12-COM_X.*COM_Z.*Mb.*q4.*rk.*t10-COM_Y.*COM_Z.*Mb.*q1.*rk.*t12.*3.0-COM_X.*COM_Z.*Mb.*q4.*rk.*t12+Mb.*q2.*rk.*t3.*t4.*t8.*2.0+Mb.*q2.*rk.*t3.*t6.*t8.*4.0+Mb.*q2.*rk.*t4.*t6.*t8.*4.0-Mb.*q2.*rk.*t5.*t6.*t8.*2.0+Mb.*q2.*rk.*t3.*t4.*t13.*2.0+Mb.*q2.*rk.*t3.*t5.*t13.*4.0-Mb.*q2.*rk.*t3.*t6.*t13.*2.0+Mb.*q2.*rk.*t4.*t5.*t13.*2.0+Mb.*q2.*rk.*t5.*t6.*t13.*6.0-Mb.*q1.*q3.*q4.*rk.*t3.*t8.*4.0-Mb.*q1.*q3.*q4.*rk.*t4.*t8.*4.0-Mb.*q1.*q3.*q4.*rk.*t6.*t13.*4.0+COM_X.*COM_Y.*Mb.*q3.*rk.*t3.*t4.*2.0-COM_Y.*COM_Z.*Mb.*q1.*rk.*t3.*t4.*2.0-COM_X.*COM_Y.*Mb.*q3.*rk.*t3.*t5.*2.0-COM_Y.*COM_Z.*Mb.*q1.*rk.*t3.*t6.*2.0-COM_Y.*COM_Z.*Mb.*q1.*rk.*t4.*t5.*2.0+COM_X.*COM_Y.*Mb.*q3.*rk.*t4.*t6.*1.0e1-COM_X.*COM_Z.*Mb.*q4.*rk.*t3.*t5.*6.0-COM_X.*COM_Y.*Mb.*q3.*rk.*t5.*t6.*2.0-COM_X.*COM_Z.*Mb.*q4.*rk.*t4.*t5.*2.0+COM_X.*COM_Z.*Mb.*q4.*rk.*t4.*t6.*6.0-COM_X.*COM_Z.*Mb.*q4.*rk.*t5.*t6.*2.0+COM_X.*COM_Z.*Mb.*q1.*q2.*q3.*rk.*t3.*4.0+COM_X.*COM_Z.*Mb.*q1.*q2.*q3.*rk.*t4.*4.0-COM_X.*COM_Y.*Mb.*q1.*q2.*q4.*rk.*t5.*4.0+COM_X.*COM_Z.*Mb.*q1.*q2.*q3.*rk.*t5.*4.0-COM_X.*COM_Y.*Mb.*q1.*q2.*q4.*rk.*t6.*4.0+COM_X.*COM_Z.*Mb.*q1.*q2.*q3.*rk.*t6.*4.0+COM_Y.*COM_Z.*Mb.*q2.*q3.*q4.*rk.*t3.*8.0+COM_Y.*COM_Z.*Mb.*q2.*q3.*q4.*rk.*t6.*8.0).*-2.0,Mb.*g.*rk.*t32.*(t121+t122+t123+t124+t125+t126-t127-t128-t129-t130-t131-t132-t133-t134-t135+t136-t137-t138-t139-t140-t141+t142-t143-t144+t145+t146+t147-COM_X.*Jk.*q1-COM_Z.*Jk.*q3-COM_X.*Mb.*q1.*t2-COM_Z.*Mb.*q3.*t2-COM_X.*Mk.*q1.*t2-COM_Z.*Mk.*q3.*t2+Mb.*q3.*rk.*t8.*t9.*2.0+Mb.*q3.*rk.*t8.*t10.*2.0+Mb.*q3.*rk.*t7.*t13-Mb.*q3.*rk.*t9.*t11+Mb.*q3.*rk.*t9.*t13-Mb.*q3.*rk.*t10.*t13+Mb.*q3.*rk.*t11.*t12.*3.0-Mb.*q3.*rk.*t12.*t13+COM_X.*COM_Y.*Mb.*q2.*rk.*t7.*3.0+COM_X.*COM_Z.*Mb.*q1.*rk.*t7.*3.0-COM_Y.*COM_Z.*Mb.*q4.*rk.*t7+COM_X.*COM_Z.*Mb.*q1.*rk.*t12.*3.0+COM_Y.*COM_Z.*Mb.*q4.*rk.*t9.*3.0+Mb.*q3.*rk.*t3.*t4.*t8.*4.0+Mb.*q3.*rk.*t3.*t5.*t8.*2.0-Mb.*q3.*rk.*t3.*t6.*t8.*2.0+Mb.*q3.*rk.*t4.*t5.*t8.*2.0+Mb.*q3.*rk.*t4.*t6.*t8.*6.0+Mb.*q3.*rk.*t3.*t5.*t13.*2.0+Mb.*q3.*rk.*t3.*t6.*t13.*4.0-Mb.*q3.*rk.*t4.*t6.*t13.*2.0+Mb.*q3.*rk.*t5.*t6.*t13.*4.0-Mb.*q1.*q2.*q4.*rk.*t5.*t8.*4.0+Mb.*q1.*q2.*q4.*rk.*t6.*t8.*4.0+Mb.*q1.*q2.*q4.*rk.*t3.*t13.*4.0+COM_X.*COM_Y.*Mb.*q2.*rk.*t3.*t5.*2.0+COM_X.*COM_Z.*Mb.*q1.*rk.*t3.*t5.*2.0+COM_X.*COM_Y.*Mb.*q2.*rk.*t3.*t6.*6.0+COM_X.*COM_Y.*Mb.*q2.*rk.*t4.*t5.*2.0+COM_X.*COM_Z.*Mb.*q1.*rk.*t3.*t6.*2.0+COM_X.*COM_Y.*Mb.*q2.*rk.*t5.*t6.*1.0e1-COM_X.*COM_Z.*Mb.*q1.*rk.*t5.*t6.*2.0+COM_Y.*COM_Z.*Mb.*q4.*rk.*t3.*t6.*2.0-COM_Y.*COM_Z.*Mb.*q4.*rk.*t4.*t5.*2.0+COM_Y.*COM_Z.*Mb.*q4.*rk.*t5.*t6.*6.0-COM_Y.*COM_Z.*Mb.*q1.*q2.*q3.*rk.*t3.*4.0-COM_Y.*COM_Z.*Mb.*q1.*q2.*q3.*rk.*t4.*4.0-COM_X.*COM_Y.*Mb.*q1.*q3.*q4.*rk.*t5.*4.0+COM_X.*COM_Z.*Mb.*q2.*q3.*q4.*rk.*t3.*8.0-COM_Y.*COM_Z.*Mb.*q1.*q2.*q3.*rk.*t5.*4.0+COM_X.*COM_Y.*Mb.*q1.*q3.*q4.*rk.*t6.*4.0-COM_Y.*COM_Z.*Mb.*q1.*q2.*q3.*rk.*t6.*4.0+COM_X.*COM_Z.*Mb.*q2.*q3.*q4.*rk.*t6.*8.0).*-2.0],[2,4]); 
-  f0 = (((((((((((((((((((((((((((((t121 + t122) + t123) + t124) + t125) + t126)
-    + t127) + t128) + t129) + t130) + t131) + t132) + t133) + t134) + t135) +
-                      t136) + t137) + t138) + t139) + t140) + t141) + t142) +
-               t143) + t144) + t145) + t146) + t147) - COM_X * Jk * q1) - COM_Z *
-         Jk * q3) - COM_X * Mb * q1 * t2) - COM_Z * Mb * q3 * t2;
-  f1 = COM_X * Mk * q1 * t2;
-  f2 = COM_Z * Mk * q3;
-  f3 = Mb * q3 * rk * t7;
-  f4 = Mb * q3 * rk;
-  f5 = Mb * q3 * rk;
-  f6 = Mb * q3;
-  f7 = Mb * q3 * rk;
-  f8 = Mb * q3;
-  f9 = COM_X * COM_Y;
-  x[0] = Mb * g * rk * t32 * (((((((((((((((((((((((((((((((((((((((((((((f0 -
-    f1) - f2 * t2) + f3 * t8) - f4 * t8 * t9) - f5 * t8 * t10) + f6 * rk * t8 *
-    t12) + f7 * t9 * t11 * 3.0F) + f8 * rk * t10 * t13 * 2.0F) - Mb * q3 * rk *
-    t11 * t12) + Mb * q3 * rk * t12 * t13 * 2.0F) - f9 * Mb * q2 * rk * t7 *
-    3.0F) + COM_X * COM_Z * Mb * q1 * rk * t7) - COM_Y * COM_Z * Mb * q4 * rk *
-    t7 * 3.0F) - COM_X * COM_Z * Mb * q1 * rk * t12 * 3.0F) - COM_Y * COM_Z * Mb
-    * q4 * rk * t9 * 3.0F) - Mb * q3 * rk * t3 * t4 * t8 * 2.0F) + Mb * q3 * rk *
-    t3 * t5 * t8 * 4.0F) + Mb * q3 * rk * t3 * t6 * t8 * 4.0F) + Mb * q3 * rk *
-    t5 * t6 * t8 * 2.0F) + Mb * q3 * rk * t3 * t4 * t13 * 6.0F) - Mb * q3 * rk *
-    t3 * t6 * t13 * 2.0F) + Mb * q3 * rk * t4 * t5 * t13 * 2.0F) + Mb * q3 * rk *
-    t4 * t6 * t13 * 4.0F) + Mb * q3 * rk * t5 * t6 * t13 * 2.0F) - Mb * q1 * q2 *
-    q4 * rk * t5 * t8 * 4.0F) - Mb * q1 * q2 * q4 * rk * t6 * t8 * 4.0F) - Mb *
-    q1 * q2 * q4 * rk * t3 * t13 * 4.0F) - COM_X * COM_Y * Mb * q2 * rk * t3 *
-    t5 * 10.0F) - COM_X * COM_Z * Mb * q1 * rk * t3 * t5 * 6.0F) - COM_X * COM_Y
-    * Mb * q2 * rk * t3 * t6 * 6.0F) - COM_X * COM_Y * Mb * q2 * rk * t4 * t5 *
-    2.0F) - COM_X * COM_Z * Mb * q1 * rk * t3 * t6 * 2.0F) - COM_X * COM_Y * Mb *
-    q2 * rk * t5 * t6 * 2.0F) - COM_X * COM_Z * Mb * q1 * rk * t5 * t6 * 2.0F) -
-    COM_Y * COM_Z * Mb * q4 * rk * t3 * t6 * 2.0F) - COM_Y * COM_Z * Mb * q4 *
-    rk * t4 * t5 * 2.0F) - COM_Y * COM_Z * Mb * q4 * rk * t5 * t6 * 2.0F) +
-    COM_Y * COM_Z * Mb * q1 * q2 * q3 * rk * t3 * 8.0F) - COM_X * COM_Y * Mb *
-    q1 * q3 * q4 * rk * t5 * 4.0F) - COM_X * COM_Z * Mb * q2 * q3 * q4 * rk * t3
-    * 4.0F) - COM_X * COM_Y * Mb * q1 * q3 * q4 * rk * t6 * 4.0F) - COM_X *
-    COM_Z * Mb * q2 * q3 * q4 * rk * t4 * 4.0F) + COM_Y * COM_Z * Mb * q1 * q2 *
-    q3 * rk * t6 * 8.0F) - COM_X * COM_Z * Mb * q2 * q3 * q4 * rk * t5 * 4.0F) -
-    COM_X * COM_Z * Mb * q2 * q3 * q4 * rk * t6 * 4.0F) * -2.0F;
-  f0 = (((((((((((((((((((((((((((((t40 + t41) + t42) + t43) + t44) + t45) + t46)
-    + t47) + t48) - t49) - t50) - t51) - t52) - t53) - t54) + t55) - t56) - t57)
-                   - t58) + t59) - t60) - t61) + t62) + t63) - t64) + t65) -
-           COM_Z * Jk * q2) - COM_Z * Mb * q2 * t2) - COM_Z * Mk * q2 * t2) + Mb
-        * q2 * rk * t7 * t8 * 2.0F) - Mb * q2 * rk * t7 * t13;
-  f1 = Mb * q2 * rk * t8 * t12 * 2.0F;
-  f2 = Mb * q2 * rk * t9 * t11;
-  f3 = Mb * q2 * rk * t9;
-  f4 = Mb * q2 * rk;
-  f5 = Mb * q2 * rk;
-  f6 = Mb * q2;
-  f7 = COM_X * COM_Y * Mb;
-  f8 = COM_X * COM_Y;
-  f9 = COM_X * COM_Z;
-  x[1] = Mb * g * rk * t32 * (((((((((((((((((((((((((((((((((((((((((((((f0 +
-    f1) + f2 * 3.0F) - f3 * t13) + f4 * t10 * t13) - f5 * t11 * t12) + f6 * rk *
-    t12 * t13) + f7 * q3 * rk * t7) + f8 * Mb * q3 * rk * t9) + f9 * Mb * q4 *
-    rk * t7) - COM_Y * COM_Z * Mb * q1 * rk * t10) + COM_X * COM_Y * Mb * q3 *
-    rk * t12) - COM_X * COM_Z * Mb * q4 * rk * t10 * 3.0F) + COM_Y * COM_Z * Mb *
-    q1 * rk * t12 * 3.0F) + COM_X * COM_Z * Mb * q4 * rk * t12) + Mb * q2 * rk *
-    t3 * t5 * t8 * 6.0F) - Mb * q2 * rk * t3 * t6 * t8 * 2.0F) + Mb * q2 * rk *
-    t4 * t5 * t8 * 2.0F) + Mb * q2 * rk * t4 * t6 * t8 * 2.0F) + Mb * q2 * rk *
-    t5 * t6 * t8 * 4.0F) + Mb * q2 * rk * t3 * t4 * t13 * 4.0F) - Mb * q2 * rk *
-    t3 * t5 * t13 * 2.0F) + Mb * q2 * rk * t3 * t6 * t13 * 4.0F) + Mb * q2 * rk *
-    t4 * t6 * t13 * 2.0F) + Mb * q1 * q3 * q4 * rk * t3 * t8 * 4.0F) - Mb * q1 *
-    q3 * q4 * rk * t4 * t8 * 4.0F) + Mb * q1 * q3 * q4 * rk * t6 * t13 * 4.0F) -
-    COM_X * COM_Y * Mb * q3 * rk * t3 * t4 * 10.0F) + COM_Y * COM_Z * Mb * q1 *
-    rk * t3 * t4 * 6.0F) + COM_X * COM_Y * Mb * q3 * rk * t3 * t5 * 2.0F) +
-    COM_Y * COM_Z * Mb * q1 * rk * t3 * t6 * 2.0F) - COM_Y * COM_Z * Mb * q1 *
-    rk * t4 * t5 * 2.0F) - COM_X * COM_Y * Mb * q3 * rk * t4 * t6 * 2.0F) +
-    COM_X * COM_Z * Mb * q4 * rk * t3 * t5 * 6.0F) + COM_X * COM_Y * Mb * q3 *
-    rk * t5 * t6 * 2.0F) - COM_X * COM_Z * Mb * q4 * rk * t4 * t5 * 2.0F) -
-    COM_X * COM_Z * Mb * q4 * rk * t4 * t6 * 2.0F) + COM_X * COM_Z * Mb * q4 *
-    rk * t5 * t6 * 2.0F) - COM_X * COM_Z * Mb * q1 * q2 * q3 * rk * t3 * 8.0F) -
-    COM_X * COM_Y * Mb * q1 * q2 * q4 * rk * t5 * 4.0F) + COM_X * COM_Y * Mb *
-    q1 * q2 * q4 * rk * t6 * 4.0F) - COM_X * COM_Z * Mb * q1 * q2 * q3 * rk * t6
-    * 8.0F) - COM_Y * COM_Z * Mb * q2 * q3 * q4 * rk * t3 * 4.0F) - COM_Y *
-    COM_Z * Mb * q2 * q3 * q4 * rk * t4 * 4.0F) - COM_Y * COM_Z * Mb * q2 * q3 *
-    q4 * rk * t5 * 4.0F) - COM_Y * COM_Z * Mb * q2 * q3 * q4 * rk * t6 * 4.0F) *
-    2.0F;
-  f0 = (((((((((((((((((((((((((((((t92 + t93) + t94) + t95) + t96) + t97) + t98)
-    + t99) + t100) + t101) + t102) + t103) + t104) + t105) + t106) + t107) +
-                     t108) + t109) + t110) + t111) + t112) + t113) + t114) +
-              t115) + t116) + t117) + t118) + t119) + t120) + Mb * q4 * rk * t7 *
-        t8) - Mb * q4 * rk * t8 * t9;
-  f1 = Mb * q4 * rk * t7 * t11;
-  f2 = Mb * q4 * rk * t8;
-  f3 = Mb * q4 * rk * t7 * t13;
-  f4 = Mb * q4 * rk;
-  f5 = Mb * q4 * rk * t10;
-  f6 = Mb * q4 * rk;
-  f7 = COM_X * COM_Y * Mb;
-  f8 = COM_X * COM_Y;
-  f9 = COM_X * COM_Z * Mb;
-  x[2] = Mb * g * rk * t32 * (((((((((((((((((((((((((((((((((((((((((((((f0 -
-    f1) - f2 * t10) + f3 * 2.0F) + f4 * t8 * t12) + f5 * t11 * 3.0F) + f6 * t9 *
-    t13 * 2.0F) - f7 * q1 * rk * t7) - f8 * Mb * q1 * rk * t9) - f9 * q2 * rk *
-    t7 * 3.0F) - COM_X * COM_Y * Mb * q1 * rk * t10) - COM_Y * COM_Z * Mb * q3 *
-    rk * t7) - COM_Y * COM_Z * Mb * q3 * rk * t9) + COM_X * COM_Z * Mb * q2 * rk
-    * t12) + COM_Y * COM_Z * Mb * q3 * rk * t12 * 3.0F) - Mb * q4 * rk * t3 * t4
-    * t8 * 2.0F) + Mb * q4 * rk * t4 * t5 * t8 * 4.0F) + Mb * q4 * rk * t4 * t6 *
-    t8 * 4.0F) + Mb * q4 * rk * t5 * t6 * t8 * 2.0F) + Mb * q4 * rk * t3 * t4 *
-    t13 * 6.0F) + Mb * q4 * rk * t3 * t5 * t13 * 4.0F) + Mb * q4 * rk * t3 * t6 *
-    t13 * 2.0F) - Mb * q4 * rk * t4 * t5 * t13 * 2.0F) + Mb * q4 * rk * t5 * t6 *
-    t13 * 2.0F) - Mb * q1 * q2 * q3 * rk * t5 * t8 * 4.0F) - Mb * q1 * q2 * q3 *
-    rk * t6 * t8 * 4.0F) - Mb * q1 * q2 * q3 * rk * t4 * t13 * 4.0F) - COM_X *
-    COM_Y * Mb * q1 * rk * t3 * t4 * 2.0F) - COM_X * COM_Y * Mb * q1 * rk * t3 *
-    t5 * 2.0F) + COM_X * COM_Y * Mb * q1 * rk * t4 * t6 * 10.0F) + COM_X * COM_Y
-    * Mb * q1 * rk * t5 * t6 * 2.0F) - COM_X * COM_Z * Mb * q2 * rk * t4 * t5 *
-    2.0F) - COM_Y * COM_Z * Mb * q3 * rk * t3 * t4 * 6.0F) - COM_X * COM_Z * Mb *
-    q2 * rk * t4 * t6 * 6.0F) - COM_Y * COM_Z * Mb * q3 * rk * t3 * t5 * 2.0F) -
-    COM_X * COM_Z * Mb * q2 * rk * t5 * t6 * 2.0F) - COM_Y * COM_Z * Mb * q3 *
-    rk * t4 * t6 * 2.0F) + COM_Y * COM_Z * Mb * q3 * rk * t5 * t6 * 2.0F) -
-    COM_X * COM_Y * Mb * q2 * q3 * q4 * rk * t3 * 4.0F) - COM_X * COM_Z * Mb *
-    q1 * q3 * q4 * rk * t3 * 4.0F) - COM_X * COM_Y * Mb * q2 * q3 * q4 * rk * t4
-    * 4.0F) - COM_X * COM_Z * Mb * q1 * q3 * q4 * rk * t4 * 4.0F) - COM_Y *
-    COM_Z * Mb * q1 * q2 * q4 * rk * t4 * 8.0F) - COM_X * COM_Z * Mb * q1 * q3 *
-    q4 * rk * t5 * 4.0F) - COM_Y * COM_Z * Mb * q1 * q2 * q4 * rk * t5 * 8.0F) -
-    COM_X * COM_Z * Mb * q1 * q3 * q4 * rk * t6 * 4.0F) * 2.0F;
-  f0 = (((((((((((((((((((((((((((((t31 + t67) + t68) + t69) + t70) + t71) + t72)
-    + t73) + t74) - t75) - t76) - t77) - t78) - t79) - t80) - t81) + t82) - t83)
-                   - t84) - t85) - t86) - t87) + t88) + t89) + t90) + t91) -
-           COM_X * Jk * q3) - COM_X * Mb * q3 * t2) - COM_X * Mk * q3 * t2) + Mb
-        * q1 * rk * t7 * t8 * 2.0F) - Mb * q1 * rk * t7 * t11;
-  f1 = Mb * q1 * rk * t7 * t13;
-  f2 = Mb * q1 * rk * t8 * t12;
-  f3 = Mb * q1 * rk * t10 * t11;
-  f4 = Mb * q1 * rk;
-  f5 = Mb * q1 * rk;
-  f6 = Mb * q1;
-  f7 = COM_X * COM_Z * Mb;
-  f8 = COM_X * COM_Y * Mb;
-  f9 = COM_X * COM_Z * Mb;
-  x[3] = Mb * g * rk * t32 * (((((((((((((((((((((((((((((((((((((((((((((f0 +
-    f1) + f2 * 2.0F) + f3 * 3.0F) + f4 * t9 * t13) - f5 * t10 * t13) - f6 * rk *
-    t12 * t13) + f7 * q3 * rk * t7) + f8 * q4 * rk * t9 * 3.0F) - f9 * q3 * rk *
-    t9 * 3.0F) + COM_Y * COM_Z * Mb * q2 * rk * t9) + COM_Y * COM_Z * Mb * q2 *
-    rk * t10) + COM_X * COM_Z * Mb * q3 * rk * t12) + COM_Y * COM_Z * Mb * q2 *
-    rk * t12) + Mb * q1 * rk * t3 * t5 * t8 * 2.0F) + Mb * q1 * rk * t3 * t6 *
-    t8 * 2.0F) - Mb * q1 * rk * t4 * t5 * t8 * 2.0F) + Mb * q1 * rk * t4 * t6 *
-    t8 * 6.0F) + Mb * q1 * rk * t5 * t6 * t8 * 4.0F) + Mb * q1 * rk * t3 * t4 *
-    t13 * 4.0F) + Mb * q1 * rk * t3 * t5 * t13 * 2.0F) + Mb * q1 * rk * t4 * t5 *
-    t13 * 4.0F) - Mb * q1 * rk * t4 * t6 * t13 * 2.0F) - Mb * q2 * q3 * q4 * rk *
-    t3 * t8 * 4.0F) + Mb * q2 * q3 * q4 * rk * t4 * t8 * 4.0F) + Mb * q2 * q3 *
-    q4 * rk * t5 * t13 * 4.0F) + COM_X * COM_Y * Mb * q4 * rk * t3 * t4 * 10.0F)
-    - COM_Y * COM_Z * Mb * q2 * rk * t3 * t4 * 6.0F) + COM_X * COM_Y * Mb * q4 *
-    rk * t3 * t5 * 2.0F) - COM_X * COM_Z * Mb * q3 * rk * t3 * t5 * 2.0F) -
-    COM_Y * COM_Z * Mb * q2 * rk * t3 * t5 * 2.0F) + COM_X * COM_Y * Mb * q4 *
-    rk * t3 * t6 * 2.0F) + COM_X * COM_Y * Mb * q4 * rk * t4 * t5 * 6.0F) -
-    COM_X * COM_Z * Mb * q3 * rk * t3 * t6 * 2.0F) + COM_X * COM_Z * Mb * q3 *
-    rk * t4 * t6 * 6.0F) + COM_Y * COM_Z * Mb * q2 * rk * t4 * t6 * 2.0F) +
-    COM_X * COM_Z * Mb * q3 * rk * t5 * t6 * 2.0F) + COM_Y * COM_Z * Mb * q2 *
-    rk * t5 * t6 * 6.0F) - COM_X * COM_Y * Mb * q1 * q2 * q3 * rk * t3 * 4.0F) +
-    COM_X * COM_Y * Mb * q1 * q2 * q3 * rk * t4 * 4.0F) - COM_X * COM_Z * Mb *
-    q1 * q2 * q4 * rk * t4 * 8.0F) - COM_X * COM_Z * Mb * q1 * q2 * q4 * rk * t5
-    * 8.0F) + COM_Y * COM_Z * Mb * q1 * q3 * q4 * rk * t3 * 4.0F) + COM_Y *
-    COM_Z * Mb * q1 * q3 * q4 * rk * t4 * 4.0F) + COM_Y * COM_Z * Mb * q1 * q3 *
-    q4 * rk * t5 * 4.0F) + COM_Y * COM_Z * Mb * q1 * q3 * q4 * rk * t6 * 4.0F) *
-    -2.0F;
-  f0 = (((((((((((((((((((((((((((((t31 + t67) + t68) + t69) + t70) + t71) + t72)
-    + t73) + t74) + t75) + t76) + t77) + t78) + t79) + t80) + t81) + t82) + t83)
-                   + t84) + t85) + t86) + t87) + t88) + t89) + t90) + t91) -
-           COM_X * Jk * q3) - COM_X * Mb * q3 * t2) - COM_X * Mk * q3 * t2) - Mb
-        * q1 * rk * t7 * t8) + Mb * q1 * rk * t8 * t9;
-  f1 = Mb * q1 * rk * t7 * t11 * 3.0F;
-  f2 = Mb * q1 * rk * t8;
-  f3 = Mb * q1 * rk * t8;
-  f4 = Mb * q1 * rk;
-  f5 = Mb * q1 * rk * t10;
-  f6 = Mb * q1 * rk;
-  f7 = COM_X * COM_Z * Mb;
-  f8 = COM_X * COM_Y * Mb;
-  f9 = COM_X * COM_Z;
-  t31 = COM_Y * COM_Z;
-  x[4] = Mb * g * rk * t32 * (((((((((((((((((((((((((((((((((((((((((((((f0 +
-    f1) + f2 * t10) - f3 * t12) - f4 * t10 * t11) + f5 * t13 * 2.0F) + f6 * t12 *
-    t13 * 2.0F) - f7 * q3 * rk * t7) - f8 * q4 * rk * t9 * 3.0F) - f9 * Mb * q3 *
-    rk * t9) + t31 * Mb * q2 * rk * t9 * 3.0F) - COM_Y * COM_Z * Mb * q2 * rk *
-    t10) - COM_X * COM_Z * Mb * q3 * rk * t12) - COM_Y * COM_Z * Mb * q2 * rk *
-    t12) + Mb * q1 * rk * t3 * t4 * t8 * 2.0F) + Mb * q1 * rk * t3 * t5 * t8 *
-    4.0F) + Mb * q1 * rk * t4 * t5 * t8 * 4.0F) - Mb * q1 * rk * t5 * t6 * t8 *
-    2.0F) + Mb * q1 * rk * t3 * t4 * t13 * 2.0F) + Mb * q1 * rk * t3 * t6 * t13 *
-    2.0F) - Mb * q1 * rk * t4 * t5 * t13 * 2.0F) + Mb * q1 * rk * t4 * t6 * t13 *
-    4.0F) + Mb * q1 * rk * t5 * t6 * t13 * 6.0F) - Mb * q2 * q3 * q4 * rk * t3 *
-    t8 * 4.0F) - Mb * q2 * q3 * q4 * rk * t4 * t8 * 4.0F) - Mb * q2 * q3 * q4 *
-    rk * t5 * t13 * 4.0F) - COM_X * COM_Y * Mb * q4 * rk * t3 * t4 * 2.0F) +
-    COM_Y * COM_Z * Mb * q2 * rk * t3 * t4 * 2.0F) - COM_X * COM_Y * Mb * q4 *
-    rk * t3 * t5 * 10.0F) + COM_X * COM_Z * Mb * q3 * rk * t3 * t5 * 6.0F) -
-    COM_Y * COM_Z * Mb * q2 * rk * t3 * t5 * 2.0F) - COM_X * COM_Y * Mb * q4 *
-    rk * t3 * t6 * 2.0F) - COM_X * COM_Y * Mb * q4 * rk * t4 * t5 * 6.0F) -
-    COM_X * COM_Z * Mb * q3 * rk * t3 * t6 * 2.0F) - COM_X * COM_Z * Mb * q3 *
-    rk * t4 * t6 * 6.0F) - COM_Y * COM_Z * Mb * q2 * rk * t4 * t6 * 2.0F) -
-    COM_X * COM_Z * Mb * q3 * rk * t5 * t6 * 2.0F) - COM_Y * COM_Z * Mb * q2 *
-    rk * t5 * t6 * 6.0F) - COM_X * COM_Y * Mb * q1 * q2 * q3 * rk * t3 * 4.0F) -
-    COM_X * COM_Y * Mb * q1 * q2 * q3 * rk * t4 * 4.0F) + COM_X * COM_Z * Mb *
-    q1 * q2 * q4 * rk * t3 * 4.0F) + COM_X * COM_Z * Mb * q1 * q2 * q4 * rk * t4
-    * 4.0F) + COM_X * COM_Z * Mb * q1 * q2 * q4 * rk * t5 * 4.0F) + COM_X *
-    COM_Z * Mb * q1 * q2 * q4 * rk * t6 * 4.0F) - COM_Y * COM_Z * Mb * q1 * q3 *
-    q4 * rk * t4 * 8.0F) - COM_Y * COM_Z * Mb * q1 * q3 * q4 * rk * t5 * 8.0F) *
-    2.0F;
-  f0 = (((((((((((((((((((((((((((((t92 + t93) + t94) + t95) + t96) + t97) + t98)
-    + t99) + t100) + t101) + t102) + t103) - t104) - t105) - t106) - t107) -
-                     t108) - t109) + t110) - t111) - t112) - t113) + t114) -
-              t115) - t116) - t117) + t118) + t119) + t120) + Mb * q4 * rk * t8 *
-        t9 * 2.0F) + Mb * q4 * rk * t7 * t11 * 3.0F;
-  f1 = Mb * q4 * rk * t8 * t10 * 2.0F;
-  f2 = Mb * q4 * rk * t7;
-  f3 = Mb * q4 * rk * t10;
-  f4 = Mb * q4 * rk;
-  f5 = Mb * q4 * rk;
-  f6 = Mb * q4;
-  f7 = COM_X * COM_Y * Mb;
-  f8 = COM_X * COM_Y;
-  f9 = COM_X * COM_Z * Mb;
-  x[5] = Mb * g * rk * t32 * (((((((((((((((((((((((((((((((((((((((((((((f0 +
-    f1) - f2 * t13) - f3 * t11) - f4 * t9 * t13) + f5 * t10 * t13) + f6 * rk *
-    t12 * t13) + f7 * q1 * rk * t7) + f8 * Mb * q1 * rk * t9) + f9 * q2 * rk *
-    t7 * 3.0F) + COM_X * COM_Y * Mb * q1 * rk * t10) + COM_Y * COM_Z * Mb * q3 *
-    rk * t7) + COM_Y * COM_Z * Mb * q3 * rk * t9) + COM_X * COM_Z * Mb * q2 * rk
-    * t12 * 3.0F) + COM_Y * COM_Z * Mb * q3 * rk * t12) + Mb * q4 * rk * t3 * t4
-    * t8 * 4.0F) + Mb * q4 * rk * t3 * t5 * t8 * 6.0F) + Mb * q4 * rk * t3 * t6 *
-    t8 * 2.0F) - Mb * q4 * rk * t4 * t5 * t8 * 2.0F) + Mb * q4 * rk * t4 * t6 *
-    t8 * 2.0F) - Mb * q4 * rk * t3 * t5 * t13 * 2.0F) + Mb * q4 * rk * t4 * t5 *
-    t13 * 4.0F) + Mb * q4 * rk * t4 * t6 * t13 * 2.0F) + Mb * q4 * rk * t5 * t6 *
-    t13 * 4.0F) + Mb * q1 * q2 * q3 * rk * t5 * t8 * 4.0F) - Mb * q1 * q2 * q3 *
-    rk * t6 * t8 * 4.0F) + Mb * q1 * q2 * q3 * rk * t4 * t13 * 4.0F) + COM_X *
-    COM_Y * Mb * q1 * rk * t3 * t4 * 2.0F) + COM_X * COM_Y * Mb * q1 * rk * t3 *
-    t5 * 2.0F) - COM_X * COM_Y * Mb * q1 * rk * t4 * t6 * 2.0F) - COM_X * COM_Y *
-    Mb * q1 * rk * t5 * t6 * 10.0F) + COM_X * COM_Z * Mb * q2 * rk * t4 * t5 *
-    2.0F) + COM_Y * COM_Z * Mb * q3 * rk * t3 * t4 * 6.0F) + COM_X * COM_Z * Mb *
-    q2 * rk * t4 * t6 * 2.0F) + COM_Y * COM_Z * Mb * q3 * rk * t3 * t5 * 2.0F) -
-    COM_X * COM_Z * Mb * q2 * rk * t5 * t6 * 2.0F) - COM_Y * COM_Z * Mb * q3 *
-    rk * t4 * t6 * 2.0F) - COM_Y * COM_Z * Mb * q3 * rk * t5 * t6 * 6.0F) -
-    COM_X * COM_Y * Mb * q2 * q3 * q4 * rk * t3 * 4.0F) + COM_Y * COM_Z * Mb *
-    q1 * q2 * q4 * rk * t3 * 4.0F) + COM_X * COM_Y * Mb * q2 * q3 * q4 * rk * t4
-    * 4.0F) + COM_X * COM_Z * Mb * q1 * q3 * q4 * rk * t4 * 8.0F) + COM_Y *
-    COM_Z * Mb * q1 * q2 * q4 * rk * t4 * 4.0F) + COM_X * COM_Z * Mb * q1 * q3 *
-    q4 * rk * t5 * 8.0F) + COM_Y * COM_Z * Mb * q1 * q2 * q4 * rk * t5 * 4.0F) +
-    COM_Y * COM_Z * Mb * q1 * q2 * q4 * rk * t6 * 4.0F) * 2.0F;
-  f0 = (((((((((((((((((((((((((((((t40 + t41) + t42) + t43) + t44) + t45) + t46)
-    + t47) + t48) + t49) + t50) + t51) + t52) + t53) + t54) + t55) + t56) + t57)
-                   + t58) + t59) + t60) + t61) + t62) + t63) + t64) + t65) -
-           COM_Z * Jk * q2) - COM_Z * Mb * q2 * t2) - COM_Z * Mk * q2 * t2) - Mb
-        * q2 * rk * t7 * t8) + Mb * q2 * rk * t8 * t9;
-  f1 = Mb * q2 * rk * t8 * t10;
-  f2 = Mb * q2 * rk * t7 * t13;
-  f3 = Mb * q2 * rk * t8;
-  f4 = Mb * q2 * rk;
-  f5 = Mb * q2 * rk * t9;
-  f6 = Mb * q2 * rk;
-  f7 = COM_X * COM_Y * Mb;
-  f8 = COM_X * COM_Y;
-  f9 = COM_X * COM_Z;
-  t31 = COM_Y * COM_Z;
-  x[6] = Mb * g * rk * t32 * (((((((((((((((((((((((((((((((((((((((((((((f0 +
-    f1) + f2 * 2.0F) - f3 * t12) - f4 * t9 * t11) + f5 * t13 * 2.0F) + f6 * t11 *
-    t12 * 3.0F) - f7 * q3 * rk * t7) - f8 * Mb * q3 * rk * t9) - f9 * Mb * q4 *
-    rk * t7) - t31 * Mb * q1 * rk * t10 * 3.0F) - COM_X * COM_Y * Mb * q3 * rk *
-    t12) - COM_X * COM_Z * Mb * q4 * rk * t10) - COM_Y * COM_Z * Mb * q1 * rk *
-    t12 * 3.0F) - COM_X * COM_Z * Mb * q4 * rk * t12) + Mb * q2 * rk * t3 * t4 *
-    t8 * 2.0F) + Mb * q2 * rk * t3 * t6 * t8 * 4.0F) + Mb * q2 * rk * t4 * t6 *
-    t8 * 4.0F) - Mb * q2 * rk * t5 * t6 * t8 * 2.0F) + Mb * q2 * rk * t3 * t4 *
-    t13 * 2.0F) + Mb * q2 * rk * t3 * t5 * t13 * 4.0F) - Mb * q2 * rk * t3 * t6 *
-    t13 * 2.0F) + Mb * q2 * rk * t4 * t5 * t13 * 2.0F) + Mb * q2 * rk * t5 * t6 *
-    t13 * 6.0F) - Mb * q1 * q3 * q4 * rk * t3 * t8 * 4.0F) - Mb * q1 * q3 * q4 *
-    rk * t4 * t8 * 4.0F) - Mb * q1 * q3 * q4 * rk * t6 * t13 * 4.0F) + COM_X *
-    COM_Y * Mb * q3 * rk * t3 * t4 * 2.0F) - COM_Y * COM_Z * Mb * q1 * rk * t3 *
-    t4 * 2.0F) - COM_X * COM_Y * Mb * q3 * rk * t3 * t5 * 2.0F) - COM_Y * COM_Z *
-    Mb * q1 * rk * t3 * t6 * 2.0F) - COM_Y * COM_Z * Mb * q1 * rk * t4 * t5 *
-    2.0F) + COM_X * COM_Y * Mb * q3 * rk * t4 * t6 * 10.0F) - COM_X * COM_Z * Mb
-    * q4 * rk * t3 * t5 * 6.0F) - COM_X * COM_Y * Mb * q3 * rk * t5 * t6 * 2.0F)
-    - COM_X * COM_Z * Mb * q4 * rk * t4 * t5 * 2.0F) + COM_X * COM_Z * Mb * q4 *
-    rk * t4 * t6 * 6.0F) - COM_X * COM_Z * Mb * q4 * rk * t5 * t6 * 2.0F) +
-    COM_X * COM_Z * Mb * q1 * q2 * q3 * rk * t3 * 4.0F) + COM_X * COM_Z * Mb *
-    q1 * q2 * q3 * rk * t4 * 4.0F) - COM_X * COM_Y * Mb * q1 * q2 * q4 * rk * t5
-    * 4.0F) + COM_X * COM_Z * Mb * q1 * q2 * q3 * rk * t5 * 4.0F) - COM_X *
-    COM_Y * Mb * q1 * q2 * q4 * rk * t6 * 4.0F) + COM_X * COM_Z * Mb * q1 * q2 *
-    q3 * rk * t6 * 4.0F) + COM_Y * COM_Z * Mb * q2 * q3 * q4 * rk * t3 * 8.0F) +
-    COM_Y * COM_Z * Mb * q2 * q3 * q4 * rk * t6 * 8.0F) * -2.0F;
-  f0 = (((((((((((((((((((((((((((((t121 + t122) + t123) + t124) + t125) + t126)
-    - t127) - t128) - t129) - t130) - t131) - t132) - t133) - t134) - t135) +
-                      t136) - t137) - t138) - t139) - t140) - t141) + t142) -
-               t143) - t144) + t145) + t146) + t147) - COM_X * Jk * q1) - COM_Z *
-         Jk * q3) - COM_X * Mb * q1 * t2) - COM_Z * Mb * q3 * t2;
-  f1 = COM_X * Mk * q1 * t2;
-  f2 = COM_Z * Mk * q3;
-  f3 = Mb * q3 * rk * t8 * t9;
-  f4 = Mb * q3 * rk * t8;
-  f5 = Mb * q3 * rk;
-  f6 = Mb * q3;
-  f7 = Mb * q3;
-  f8 = Mb * q3;
-  f9 = COM_X * COM_Y;
-  x[7] = Mb * g * rk * t32 * (((((((((((((((((((((((((((((((((((((((((((((f0 -
-    f1) - f2 * t2) + f3 * 2.0F) + f4 * t10 * 2.0F) + f5 * t7 * t13) - f6 * rk *
-    t9 * t11) + f7 * rk * t9 * t13) - Mb * q3 * rk * t10 * t13) + f8 * rk * t11 *
-    t12 * 3.0F) - Mb * q3 * rk * t12 * t13) + f9 * Mb * q2 * rk * t7 * 3.0F) +
-    COM_X * COM_Z * Mb * q1 * rk * t7 * 3.0F) - COM_Y * COM_Z * Mb * q4 * rk *
-    t7) + COM_X * COM_Z * Mb * q1 * rk * t12 * 3.0F) + COM_Y * COM_Z * Mb * q4 *
-    rk * t9 * 3.0F) + Mb * q3 * rk * t3 * t4 * t8 * 4.0F) + Mb * q3 * rk * t3 *
-    t5 * t8 * 2.0F) - Mb * q3 * rk * t3 * t6 * t8 * 2.0F) + Mb * q3 * rk * t4 *
-    t5 * t8 * 2.0F) + Mb * q3 * rk * t4 * t6 * t8 * 6.0F) + Mb * q3 * rk * t3 *
-    t5 * t13 * 2.0F) + Mb * q3 * rk * t3 * t6 * t13 * 4.0F) - Mb * q3 * rk * t4 *
-    t6 * t13 * 2.0F) + Mb * q3 * rk * t5 * t6 * t13 * 4.0F) - Mb * q1 * q2 * q4 *
-    rk * t5 * t8 * 4.0F) + Mb * q1 * q2 * q4 * rk * t6 * t8 * 4.0F) + Mb * q1 *
-    q2 * q4 * rk * t3 * t13 * 4.0F) + COM_X * COM_Y * Mb * q2 * rk * t3 * t5 *
-    2.0F) + COM_X * COM_Z * Mb * q1 * rk * t3 * t5 * 2.0F) + COM_X * COM_Y * Mb *
-    q2 * rk * t3 * t6 * 6.0F) + COM_X * COM_Y * Mb * q2 * rk * t4 * t5 * 2.0F) +
-    COM_X * COM_Z * Mb * q1 * rk * t3 * t6 * 2.0F) + COM_X * COM_Y * Mb * q2 *
-    rk * t5 * t6 * 10.0F) - COM_X * COM_Z * Mb * q1 * rk * t5 * t6 * 2.0F) +
-    COM_Y * COM_Z * Mb * q4 * rk * t3 * t6 * 2.0F) - COM_Y * COM_Z * Mb * q4 *
-    rk * t4 * t5 * 2.0F) + COM_Y * COM_Z * Mb * q4 * rk * t5 * t6 * 6.0F) -
-    COM_Y * COM_Z * Mb * q1 * q2 * q3 * rk * t3 * 4.0F) - COM_Y * COM_Z * Mb *
-    q1 * q2 * q3 * rk * t4 * 4.0F) - COM_X * COM_Y * Mb * q1 * q3 * q4 * rk * t5
-    * 4.0F) + COM_X * COM_Z * Mb * q2 * q3 * q4 * rk * t3 * 8.0F) - COM_Y *
-    COM_Z * Mb * q1 * q2 * q3 * rk * t5 * 4.0F) + COM_X * COM_Y * Mb * q1 * q3 *
-    q4 * rk * t6 * 4.0F) - COM_Y * COM_Z * Mb * q1 * q2 * q3 * rk * t6 * 4.0F) +
-    COM_X * COM_Z * Mb * q2 * q3 * q4 * rk * t6 * 8.0F) * -2.0F;
-  i0 = 0;
-  i1 = 0;
-  i2 = 0;
-  for (i3 = 0; i3 < 8; i3++) {
-    dAcceleration_dq[i1 + (i0 << 2)] = x[i2];
-    i0++;
-    if (i0 > 1) {
-      i0 = 0;
-      i1++;
-    }
-
-    i2++;
-  }
-}
-
-//
-// File trailer for SteadyStateAcceleration_dq.cpp
-//
-// [EOF]
-//
@@ -14,8 +14,7 @@
 #include "VelocityEstimator.h"
 #include "OffsetEstimator_dEncoders2L_dq.h"
 #include "SteadyStateAcceleration.h"
-#include "SteadyStateAcceleration_dCOM.h"
-#include "SteadyStateAcceleration_dq.h"
+#include "SteadyStateAccelerationJacobian.h"
 
 // Function Definitions
 
@@ -345,13 +344,11 @@ __attribute__((optimize("O3"))) void VelocityEstimator(const float X[2], const f
   //  Process covariances
   // dAcceleration_dqB = OffsetEstimator_Acceleration_dqB(Jk,Jw,Mb,Mk,g,l,qQEKF(1),qQEKF(2),qQEKF(3),qQEKF(4),rk,rw,xCOM,yCOM);     
   // 'VelocityEstimator:47' dAcceleration_dqB = SteadyStateAcceleration_dq(xCOM,yCOM,l,Jk,Mb,Mk,g,qQEKF(1),qQEKF(2),qQEKF(3),qQEKF(4),rk); 
-  SteadyStateAcceleration_dq(COM[0], COM[1], l, Jk, Mb, Mk, g, qQEKF[0], qQEKF[1],
-    qQEKF[2], qQEKF[3], rk, b_dAcceleration_dqB);
-
   // dAcceleration_dqB = SteadyStateAcceleration_dq_Full(xCOM,yCOM,l,Jk,Jw,Mb,Mk,dx_ball,dy_ball,g,qQEKF(1),qQEKF(2),qQEKF(3),qQEKF(4),rk,rw); 
   // 'VelocityEstimator:49' dAcceleration_dCOM = SteadyStateAcceleration_dCOM(xCOM,yCOM,l,Jk,Mb,Mk,g,qQEKF(1),qQEKF(2),qQEKF(3),qQEKF(4),rk); 
-  SteadyStateAcceleration_dCOM(COM[0], COM[1], l, Jk, Mb, Mk, g, qQEKF[0],
-    qQEKF[1], qQEKF[2], qQEKF[3], rk, b_dAcceleration_dCOM);
+  //  Both Jacobians are computed in a single pass with forward-mode automatic differentiation
+  SteadyStateAcceleration_Jacobian(COM[0], COM[1], l, Jk, Mb, Mk, g, qQEKF[0],
+    qQEKF[1], qQEKF[2], qQEKF[3], rk, b_dAcceleration_dqB, b_dAcceleration_dCOM);
 
   // 'VelocityEstimator:51' cov_COM = Var_COM * eye(2);
   // 'VelocityEstimator:52' cov_velocity = dt^2 * dAcceleration_dqB * eta_qQEKF_velocity*Cov_qQEKF * dAcceleration_dqB' + dt^2 * dAcceleration_dCOM * cov_COM * dAcceleration_dCOM'; 
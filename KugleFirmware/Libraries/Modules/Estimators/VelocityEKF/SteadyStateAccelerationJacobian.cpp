@@ -0,0 +1,78 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+ 
+ 
+#include "SteadyStateAccelerationJacobian.h"
+#include "Dual.hpp"
+
+/* Steady state acceleration model without wheel inertia and ball velocity terms (Jw = 0, dx = dy = 0)
+ * This is the model which the Jacobians used by the velocity and COM estimator are linearized from.
+ * The symbolic expression reduces to
+ *   acceleration = Mb*g*rk * devec(R(q)*COM)_xy / ( Mb*rk*|q|^2 * (R(q)*COM)_z + Jk + (Mb+Mk)*rk^2 )
+ * where R(q) is the rotation matrix of the (not necessarily normalized) quaternion, such that the derivatives
+ * with respect to the individual quaternion elements match the ones from the symbolic model.
+ * The function is templated on the scalar type of the linearization variables, to be evaluated with dual numbers.
+ */
+template <typename T>
+__attribute__((optimize("O3"))) static void SteadyStateAcceleration_Simplified(T COM_X, T COM_Y, float COM_Z, float Jk, float Mb, float Mk, float g, T q1, T q2, T q3, T q4, float rk, T acceleration[2])
+{
+	T q1q1 = q1*q1;
+	T q2q2 = q2*q2;
+	T q3q3 = q3*q3;
+	T q4q4 = q4*q4;
+
+	/* COM in inertial frame = R(q) * [COM_X; COM_Y; COM_Z] */
+	T COM_inertial_x = (q1q1 + q2q2 - q3q3 - q4q4)*COM_X + 2*(q2*q3 - q1*q4)*COM_Y + 2*COM_Z*(q1*q3 + q2*q4);
+	T COM_inertial_y = 2*(q2*q3 + q1*q4)*COM_X + (q1q1 - q2q2 + q3q3 - q4q4)*COM_Y + 2*COM_Z*(q3*q4 - q1*q2);
+	T COM_inertial_z = 2*(q2*q4 - q1*q3)*COM_X + 2*(q3*q4 + q1*q2)*COM_Y + COM_Z*(q1q1 - q2q2 - q3q3 + q4q4);
+
+	T denominator = Mb*rk*(q1q1 + q2q2 + q3q3 + q4q4)*COM_inertial_z + (Jk + (Mb + Mk)*rk*rk);
+	T gain = (Mb*g*rk) / denominator;
+
+	acceleration[0] = gain * COM_inertial_x;
+	acceleration[1] = gain * COM_inertial_y;
+}
+
+/**
+ * @brief 	Compute the Jacobians of the steady state acceleration with respect to the quaternion and the COM in a single pass
+ *          Uses forward-mode automatic differentiation (dual numbers) of the simplified steady state acceleration model, and thus replaces
+ *          the separately generated SteadyStateAcceleration_dq and SteadyStateAcceleration_dCOM functions (same argument order and output layout)
+ * @param	COM_X, COM_Y, COM_Z   Input: center of mass [m] (COM_Z = l)
+ * @param	Jk, Mb, Mk, g, rk     Input: model parameters
+ * @param	q1, q2, q3, q4        Input: attitude quaternion
+ * @param	dAcceleration_dq[8]   Output: 2x4 Jacobian, row-major
+ * @param	dAcceleration_dCOM[4] Output: 2x2 Jacobian with respect to COM_X and COM_Y, row-major
+ */
+__attribute__((optimize("O3"))) void SteadyStateAcceleration_Jacobian(float COM_X, float COM_Y, float COM_Z, float Jk, float Mb, float Mk, float g, float q1, float q2, float q3, float q4, float rk, float dAcceleration_dq[8], float dAcceleration_dCOM[4])
+{
+	/* Linearization variables = { q1, q2, q3, q4, COM_X, COM_Y } */
+	typedef Dual<6> dual_t;
+	dual_t acceleration[2];
+
+	SteadyStateAcceleration_Simplified<dual_t>(dual_t::Variable(COM_X, 4), dual_t::Variable(COM_Y, 5), COM_Z, Jk, Mb, Mk, g,
+											   dual_t::Variable(q1, 0), dual_t::Variable(q2, 1), dual_t::Variable(q3, 2), dual_t::Variable(q4, 3), rk,
+											   acceleration);
+
+	for (int i = 0; i < 2; i++) {
+		for (int j = 0; j < 4; j++)
+			dAcceleration_dq[4*i + j] = acceleration[i].d[j];
+		for (int j = 0; j < 2; j++)
+			dAcceleration_dCOM[2*i + j] = acceleration[i].d[4 + j];
+	}
+}
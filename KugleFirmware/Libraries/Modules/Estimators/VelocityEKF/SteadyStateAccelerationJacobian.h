@@ -0,0 +1,26 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+ 
+#ifndef MODULES_ESTIMATORS_STEADYSTATEACCELERATIONJACOBIAN_H
+#define MODULES_ESTIMATORS_STEADYSTATEACCELERATIONJACOBIAN_H
+
+void SteadyStateAcceleration_Jacobian(float COM_X, float COM_Y, float COM_Z, float Jk, float Mb, float Mk, float g, float q1, float q2, float q3, float q4, float rk, float dAcceleration_dq[8], float dAcceleration_dCOM[4]);
+	
+	
+#endif
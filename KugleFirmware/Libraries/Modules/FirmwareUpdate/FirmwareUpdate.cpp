@@ -0,0 +1,198 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+ 
+
+#include "FirmwareUpdate.h"
+#include "cmsis_os.h"
+#include "stm32h7xx_hal.h"
+#include "Debug.h"
+
+FirmwareUpdate::FirmwareUpdate(LSPC& com, EEPROM * eeprom, uint32_t taskPriority) : com_(com), eeprom_(eeprom),
+	flash_(FLASH_BANK_2, 0, FIRMWAREUPDATE_IMAGE_SECTORS), writer_(flash_),
+	receiver_(&Transmit, (void *)&com, lspc::MessageTypesToPC::FirmwareUpdateAck),
+	inProgress_(false), taskHandle_(0), start_(0), erasing_(false), erasedSectors_(0), size_(0), crc_(0)
+{
+	xTaskCreate(FirmwareUpdate::Thread, (char *)"Firmware update", FIRMWAREUPDATE_THREAD_STACK, (void*) this, taskPriority, &taskHandle_);
+	if (!taskHandle_) {
+		ERROR("Could not create firmware update task");
+		return;
+	}
+
+	/* Register message type callbacks */
+	com_.registerCallback<lspc::MessageTypesFromPC::FirmwareUpdateStart>(&FirmwareUpdateStart_Callback, (void *)this);
+	com_.registerCallback(lspc::MessageTypesFromPC::FirmwareUpdateChunk, &FirmwareUpdateChunk_Callback, (void *)this);
+}
+
+FirmwareUpdate::~FirmwareUpdate()
+{
+	/* Unregister message callbacks */
+	com_.unregisterCallback(lspc::MessageTypesFromPC::FirmwareUpdateStart);
+	com_.unregisterCallback(lspc::MessageTypesFromPC::FirmwareUpdateChunk);
+	if (taskHandle_)
+		vTaskDelete(taskHandle_); // stop task
+}
+
+/* Copy the EEPROM into the active bank, toggle the SWAP_BANK option bit and reboot */
+void FirmwareUpdate::SwapBanks(void)
+{
+	if (eeprom_) {
+		InternalFlash eepromTarget(FLASH_BANK_1, EEPROM_FIRST_SECTOR, EEPROM_SECTORS);
+		if (!eeprom_->CopyTo(eepromTarget)) {
+			ERROR("Could not copy EEPROM before swapping flash banks");
+			return;
+		}
+	}
+
+	FLASH_OBProgramInitTypeDef optionBytes;
+	optionBytes.OptionType = OPTIONBYTE_USER;
+	optionBytes.USERType = OB_USER_SWAP_BANK;
+	optionBytes.USERConfig = READ_BIT(FLASH->OPTSR_CUR, FLASH_OPTSR_SWAP_BANK_OPT) ? OB_SWAP_BANK_DISABLE : OB_SWAP_BANK_ENABLE;
+
+	HAL_FLASH_Unlock();
+	HAL_FLASH_OB_Unlock();
+	HAL_StatusTypeDef status = HAL_FLASHEx_OBProgram(&optionBytes);
+	if (status == HAL_OK)
+		status = HAL_FLASH_OB_Launch();
+	HAL_FLASH_OB_Lock();
+	HAL_FLASH_Lock();
+
+	if (status != HAL_OK) {
+		ERROR("Could not swap flash banks");
+		return;
+	}
+
+	NVIC_SystemReset();
+}
+
+void FirmwareUpdate::Transmit(void * param, uint8_t type, const uint8_t * payload, uint16_t length)
+{
+	LSPC * com = (LSPC *)param;
+	com->TransmitAsync(type, payload, length);
+}
+
+void FirmwareUpdate::TransmitInfo(lspc::TransferTypes::status_t status, uint32_t erasedSectors, uint32_t sectors)
+{
+	lspc::MessageTypesToPC::FirmwareUpdateInfo_t info;
+	info.status = status;
+	info.max_size = writer_.GetMaximumSize();
+	info.erased_sectors = erasedSectors;
+	info.sectors = sectors;
+	com_.TransmitAsync<lspc::MessageTypesToPC::FirmwareUpdateInfo>(info);
+}
+
+/* Erase the sectors of the image of the latest start one at a time and start receiving the image. Runs in the task of the module.
+ * A new start during the erase restarts it, since the start callback notifies the task again. */
+void FirmwareUpdate::Erase(void)
+{
+	uint32_t start = __atomic_load_n(&start_, __ATOMIC_ACQUIRE);
+	if (!writer_.Begin(size_)) return;
+
+	uint32_t sectors = writer_.GetSectors();
+	for (uint32_t sector = 0; sector < sectors; sector++) {
+		if (__atomic_load_n(&start_, __ATOMIC_ACQUIRE) != start) return;
+		if (!writer_.EraseSector(sector)) {
+			__atomic_store_n(&erasing_, false, __ATOMIC_RELEASE);
+			TransmitInfo(lspc::TransferTypes::WRITE_ERROR, sector, sectors);
+			return;
+		}
+		if (sector + 1 < sectors) {
+			__atomic_store_n(&erasedSectors_, sector + 1, __ATOMIC_RELEASE);
+			TransmitInfo(lspc::TransferTypes::IN_PROGRESS, sector + 1, sectors);
+		}
+	}
+
+	receiver_.Start(&ImageWriter::Write_Callback, (void *)&writer_, writer_.GetImage(), size_, crc_);
+	__atomic_store_n(&inProgress_, true, __ATOMIC_RELEASE);
+	if (__atomic_load_n(&start_, __ATOMIC_ACQUIRE) != start) { // restarted while the receiver was started
+		__atomic_store_n(&inProgress_, false, __ATOMIC_RELEASE);
+		return;
+	}
+	__atomic_store_n(&erasing_, false, __ATOMIC_RELEASE);
+	TransmitInfo(lspc::TransferTypes::IN_PROGRESS, sectors, sectors); // all sectors erased, the image can be sent
+}
+
+void FirmwareUpdate::Thread(void * pvParameters)
+{
+	FirmwareUpdate * update = (FirmwareUpdate *)pvParameters;
+
+	while (1) {
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+		update->Erase();
+	}
+}
+
+/* Start erasing the inactive bank for an image, after which it is received. An update in progress is aborted.
+ * A repeated start of the image which is being erased (eg. if the PC has missed the progress) is answered with the progress. */
+void FirmwareUpdate::FirmwareUpdateStart_Callback(void * param, const lspc::MessageTypesFromPC::FirmwareUpdateStart_t& msg)
+{
+	FirmwareUpdate * update = (FirmwareUpdate *)param;
+	if (!update) return;
+
+	if (msg.magic_key != FIRMWAREUPDATE_MAGIC_KEY) return;
+
+	uint32_t sectors = (msg.size + update->flash_.GetSectorSize() - 1) / update->flash_.GetSectorSize();
+	if (__atomic_load_n(&update->erasing_, __ATOMIC_ACQUIRE) && msg.size == update->size_ && msg.crc == update->crc_) {
+		update->TransmitInfo(lspc::TransferTypes::IN_PROGRESS, __atomic_load_n(&update->erasedSectors_, __ATOMIC_ACQUIRE), sectors);
+		return;
+	}
+
+	__atomic_store_n(&update->inProgress_, false, __ATOMIC_RELEASE);
+	update->params_.Refresh();
+	if (update->params_.controller.mode != lspc::ParameterTypes::OFF || msg.size == 0 || msg.size > update->writer_.GetMaximumSize()) {
+		__atomic_store_n(&update->erasing_, false, __ATOMIC_RELEASE);
+		__atomic_add_fetch(&update->start_, 1, __ATOMIC_ACQ_REL); // stop an erase in progress
+		update->TransmitInfo(lspc::TransferTypes::REJECTED, 0, 0);
+		return;
+	}
+
+	/* The task reads the size and CRC after it has been notified, and restarts if another start is accepted while it erases */
+	update->size_ = msg.size;
+	update->crc_ = msg.crc;
+	__atomic_store_n(&update->erasedSectors_, 0, __ATOMIC_RELEASE);
+	__atomic_store_n(&update->erasing_, true, __ATOMIC_RELEASE);
+	__atomic_add_fetch(&update->start_, 1, __ATOMIC_ACQ_REL);
+
+	update->TransmitInfo(lspc::TransferTypes::IN_PROGRESS, 0, sectors); // accepted, nothing erased yet
+	xTaskNotifyGive(update->taskHandle_);
+}
+
+void FirmwareUpdate::FirmwareUpdateChunk_Callback(void * param, const std::vector<uint8_t>& payload)
+{
+	FirmwareUpdate * update = (FirmwareUpdate *)param;
+	if (!update) return;
+	if (!__atomic_load_n(&update->inProgress_, __ATOMIC_ACQUIRE)) return;
+
+	if (update->receiver_.Receive(payload.data(), payload.size())) {
+		/* Complete image programmed and verified */
+		update->params_.Refresh();
+		if (update->params_.controller.mode != lspc::ParameterTypes::OFF) {
+			update->receiver_.Finish(lspc::TransferTypes::REJECTED); // the controller has been enabled during the update
+			__atomic_store_n(&update->inProgress_, false, __ATOMIC_RELEASE);
+			return;
+		}
+
+		for (int i = 0; i < FIRMWAREUPDATE_FINAL_ACKS; i++)
+			update->receiver_.Finish(lspc::TransferTypes::COMPLETE); // the final acknowledge can not be repeated after the reboot, hence it is sent a few times
+		osDelay(100); // let the final acknowledge be transmitted before rebooting
+		update->SwapBanks();
+
+		update->receiver_.Finish(lspc::TransferTypes::WRITE_ERROR); // only reached if the banks could not be swapped
+		__atomic_store_n(&update->inProgress_, false, __ATOMIC_RELEASE);
+	}
+}
@@ -0,0 +1,82 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+ 
+
+#ifndef MODULES_FIRMWAREUPDATE_H
+#define MODULES_FIRMWAREUPDATE_H
+
+#include "cmsis_os.h"
+#include "LSPC.hpp"
+#include "Transfer.hpp"
+#include "Parameters.h"
+#include "EEPROM.h"
+#include "InternalFlash.h"
+#include "ImageWriter.h"
+
+#define FIRMWAREUPDATE_MAGIC_KEY		0x4B55474C
+#define FIRMWAREUPDATE_IMAGE_SECTORS	6 // sector 0-5 of a bank hold the firmware image, sector 6-7 are used by the EEPROM (see linker script)
+#define FIRMWAREUPDATE_FINAL_ACKS		3 // number of times the final acknowledge is sent before swapping the banks
+#define FIRMWAREUPDATE_THREAD_STACK		256
+
+/* In-application firmware update using the two flash banks.
+ * The new image is streamed over LSPC (see Transfer.hpp) and programmed into the inactive bank, which is mapped at FLASH_BANK2_BASE.
+ * Programming and erasing the inactive bank does not stall the execution from the active bank, so the controller threads keep running.
+ * The sectors are erased one at a time by a task of the module (about 1 second each), which reports the progress with a FirmwareUpdateInfo
+ * after every sector, such that the LSPC receiver is not blocked. The image is received once all sectors of it have been erased.
+ * When the image has been verified with its CRC32, the EEPROM sectors are copied to the active bank and the banks are swapped
+ * with the SWAP_BANK option bit, followed by a single reboot into the new firmware. The EEPROM sectors of the old firmware bank thereby
+ * end up at the EEPROM address of the swapped memory map.
+ * An interrupted update leaves the active firmware untouched, and the update has to be restarted from the beginning.
+ * Updates are only accepted while the controller is in OFF mode. */
+class FirmwareUpdate
+{
+	public:
+		FirmwareUpdate(LSPC& com, EEPROM * eeprom, uint32_t taskPriority);
+		~FirmwareUpdate();
+
+	private:
+		void Erase(void);
+		void TransmitInfo(lspc::TransferTypes::status_t status, uint32_t erasedSectors, uint32_t sectors);
+		void SwapBanks(void);
+
+		static void Thread(void * pvParameters);
+
+		static void Transmit(void * param, uint8_t type, const uint8_t * payload, uint16_t length);
+		static void FirmwareUpdateStart_Callback(void * param, const lspc::MessageTypesFromPC::FirmwareUpdateStart_t& msg);
+		static void FirmwareUpdateChunk_Callback(void * param, const std::vector<uint8_t>& payload);
+
+	private:
+		LSPC& com_;
+		EEPROM * eeprom_;
+		Parameters params_;
+
+		InternalFlash flash_; // firmware sectors of the inactive bank
+		ImageWriter writer_;
+		lspc::TransferReceiver receiver_;
+		bool inProgress_; // the image is being received
+
+		TaskHandle_t taskHandle_;
+		uint32_t start_; // incremented by every accepted start, such that the task restarts the erase
+		bool erasing_; // the sectors of the latest start are being erased
+		uint32_t erasedSectors_; // progress of the erase, reported to a repeated start
+		uint32_t size_;  // size and CRC of the image of the latest accepted start
+		uint32_t crc_;
+};
+
+#endif
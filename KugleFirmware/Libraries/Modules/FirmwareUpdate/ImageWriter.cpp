@@ -0,0 +1,126 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+ 
+
+#include "ImageWriter.h"
+#include <string.h> // for memcpy
+
+ImageWriter::ImageWriter(FlashMemory& flash) : flash_(flash), size_(0), erasedSectors_(0)
+{
+}
+
+ImageWriter::~ImageWriter()
+{
+}
+
+/**
+ * @brief 	Start a new image. The sectors it covers have to be erased with EraseSector before they are written.
+ * @param	size       Input: image size in bytes
+ * @retval	true if the image fits
+ */
+bool ImageWriter::Begin(uint32_t size)
+{
+	size_ = 0;
+	erasedSectors_ = 0;
+	if (size == 0 || size > GetMaximumSize()) return false;
+
+	size_ = size;
+	return true;
+}
+
+/**
+ * @brief 	Erase the next sector of the image, which takes about 1 second on the STM32H7
+ * @param	sector     Input: sector to erase, has to be GetErasedSectors()
+ * @retval	true if the sector was erased
+ */
+bool ImageWriter::EraseSector(uint32_t sector)
+{
+	if (sector != erasedSectors_ || sector >= GetSectors()) return false;
+	if (!flash_.EraseSector(sector)) return false;
+	erasedSectors_++;
+	return true;
+}
+
+/**
+ * @brief 	Get the number of sectors covered by the image
+ */
+uint32_t ImageWriter::GetSectors(void)
+{
+	return (size_ + flash_.GetSectorSize() - 1) / flash_.GetSectorSize();
+}
+
+uint32_t ImageWriter::GetErasedSectors(void)
+{
+	return erasedSectors_;
+}
+
+/**
+ * @brief 	Program a piece of the image. Flash words which are completely erased (0xFF) are skipped.
+ * @param	offset     Input: byte offset within the image, must be a multiple of FLASH_WORD_SIZE
+ * @param	data       Input: image data
+ * @param	length     Input: number of bytes, the last flash word is padded with 0xFF
+ * @retval	true if successful
+ */
+bool ImageWriter::Write(uint32_t offset, const uint8_t * data, uint16_t length)
+{
+	if ((offset % FLASH_WORD_SIZE) != 0 || offset + length > size_) return false;
+
+	uint32_t sectorSize = flash_.GetSectorSize();
+	if (length > 0 && (offset + length - 1) / sectorSize >= erasedSectors_) return false; // not erased yet
+	uint64_t word[FLASH_WORD_SIZE/8];
+	while (length > 0) {
+		uint16_t wordLength = (length < FLASH_WORD_SIZE) ? length : FLASH_WORD_SIZE;
+		memset(word, 0xFF, FLASH_WORD_SIZE);
+		memcpy(word, data, wordLength);
+
+		bool erased = true;
+		for (uint32_t i = 0; i < FLASH_WORD_SIZE/8; i++)
+			erased &= (word[i] == 0xFFFFFFFFFFFFFFFFULL);
+
+		if (!erased && !flash_.ProgramWord(offset / sectorSize, offset % sectorSize, word))
+			return false;
+
+		offset += FLASH_WORD_SIZE;
+		data += wordLength;
+		length -= wordLength;
+	}
+
+	return true;
+}
+
+/**
+ * @brief 	Get the memory mapped image, eg. to verify it
+ */
+const uint8_t * ImageWriter::GetImage(void)
+{
+	return flash_.GetSectorAddress(0);
+}
+
+uint32_t ImageWriter::GetMaximumSize(void)
+{
+	return flash_.GetSectorCount() * flash_.GetSectorSize();
+}
+
+/* Write function for lspc::TransferReceiver */
+bool ImageWriter::Write_Callback(void * param, uint32_t offset, const uint8_t * data, uint16_t length)
+{
+	ImageWriter * writer = (ImageWriter *)param;
+	if (!writer) return false;
+	return writer->Write(offset, data, length);
+}
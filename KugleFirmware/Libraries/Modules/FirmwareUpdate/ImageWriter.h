@@ -0,0 +1,54 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+ 
+
+#ifndef MODULES_FIRMWAREUPDATE_IMAGEWRITER_H
+#define MODULES_FIRMWAREUPDATE_IMAGEWRITER_H
+
+#include <stdint.h>
+#include "FlashMemory.h"
+
+/* Writes a firmware image, received in pieces, into a flash memory (the inactive flash bank).
+ * The sectors of the image are erased one at a time with EraseSector, such that the erase can be spread over time,
+ * and pieces are only programmed into sectors which have been erased.
+ * The pieces can arrive out of order, but have to start at a flash word boundary.
+ * Independent of the HAL, such that it can be tested with the FlashEmulator of Tools/HostTests on a PC. */
+class ImageWriter
+{
+	public:
+		ImageWriter(FlashMemory& flash);
+		~ImageWriter();
+
+		bool Begin(uint32_t size);
+		bool EraseSector(uint32_t sector);
+		uint32_t GetSectors(void);
+		uint32_t GetErasedSectors(void);
+		bool Write(uint32_t offset, const uint8_t * data, uint16_t length);
+		const uint8_t * GetImage(void);
+		uint32_t GetMaximumSize(void);
+
+		static bool Write_Callback(void * param, uint32_t offset, const uint8_t * data, uint16_t length);
+
+	private:
+		FlashMemory& flash_;
+		uint32_t size_;
+		uint32_t erasedSectors_; // sectors 0 to erasedSectors_-1 have been erased since Begin
+};
+
+#endif
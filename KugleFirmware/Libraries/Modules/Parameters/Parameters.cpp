@@ -20,16 +20,35 @@
 #include "Parameters.h"
 #include "EEPROM.h"
 #include "Debug.h"
+#include "ParametersTable.h"
+#include "StaticArena.h"
+#include <math.h> // for isfinite
 
 // Create global parameter variable in project scope
 static Parameters * paramsGlobal = 0;
+STATIC_ARENA(paramsGlobalArena, STATIC_ARENA_SIZEOF(Parameters)); // the global object lives until power off
+
+/* Reflection tables generated from the declaration list in ParametersTable.h */
+#define PARAMETERS_SECTION_ENTRIES(section, LIST) \
+	static constexpr Parameters_Entry_t section##_parameters[] = { LIST(PARAMETERS_TABLE_ENTRY) }; \
+	static_assert(Parameters_IsOrdered(section##_parameters, sizeof(section##_parameters)/sizeof(Parameters_Entry_t)), "Parameters of section '" #section "' are not listed in the order of their ids"); \
+	static_assert(Parameters_IsSupported(section##_parameters, sizeof(section##_parameters)/sizeof(Parameters_Entry_t)), "Section '" #section "' contains a parameter of unsupported type");
+PARAMETERS_TABLE(PARAMETERS_SECTION_ENTRIES)
+
+#define PARAMETERS_SECTION(section, LIST) \
+	{ #section, lspc::ParameterLookup::section, section##_parameters, sizeof(section##_parameters)/sizeof(Parameters_Entry_t) },
+static constexpr Parameters_Section_t ParametersTable[] = { PARAMETERS_TABLE(PARAMETERS_SECTION) };
+static_assert(Parameters_IsOrdered(ParametersTable, sizeof(ParametersTable)/sizeof(Parameters_Section_t)), "Parameter sections are not listed in the order of their ids");
+
+#define PARAMETERS_SECTION_ADDRESS(section, LIST) \
+	case lspc::ParameterLookup::section: return (uint8_t *)&this->section;
 
 Parameters::Parameters(EEPROM * eeprom, LSPC * com) : eeprom_(0), com_(0), readSemaphore_(0), writeSemaphore_(0), changeCounter_(0)
 {
 	if (!paramsGlobal) { // first parameter object being created
 		// Create global object to hold all parameters
 		paramsGlobal = (Parameters *)1; // needs to set this to a value, since "new Parameters" will call the constructor again
-		paramsGlobal = new Parameters;
+		paramsGlobal = new (paramsGlobalArena) Parameters;
 
 		paramsGlobal->readSemaphore_ = xSemaphoreCreateBinary();
 		if (paramsGlobal->readSemaphore_ == NULL) {
@@ -55,16 +74,18 @@ Parameters::Parameters(EEPROM * eeprom, LSPC * com) : eeprom_(0), com_(0), readS
 			paramsGlobal->com_ = com;
 
 			/* Register message type callbacks */
-			paramsGlobal->com_->registerCallback(lspc::MessageTypesFromPC::GetParameter, &GetParameter_Callback, (void *)paramsGlobal);
-			paramsGlobal->com_->registerCallback(lspc::MessageTypesFromPC::SetParameter, &SetParameter_Callback, (void *)paramsGlobal);
+			paramsGlobal->com_->registerCallback<lspc::MessageTypesFromPC::GetParameter>(&GetParameter_Callback, (void *)paramsGlobal);
+			paramsGlobal->com_->registerCallback<lspc::MessageTypesFromPC::SetParameter>(&SetParameter_Callback, (void *)paramsGlobal);
 			paramsGlobal->com_->registerCallback(lspc::MessageTypesFromPC::StoreParameters, &StoreParameters_Callback, (void *)paramsGlobal);
 			paramsGlobal->com_->registerCallback(lspc::MessageTypesFromPC::DumpParameters, &DumpParameters_Callback, (void *)paramsGlobal);
+			paramsGlobal->com_->registerCallback(lspc::MessageTypesFromPC::GetParameters, &GetParameters_Callback, (void *)paramsGlobal);
+			paramsGlobal->com_->registerCallback(lspc::MessageTypesFromPC::SetParameters, &SetParameters_Callback, (void *)paramsGlobal);
 		}
 	}
 
 	ParametersSize = PARAMETERS_LENGTH;
 
-	if ((uint32_t)paramsGlobal > 1) { // global object exist - load parameters from this
+	if ((uintptr_t)paramsGlobal > 1) { // global object exist - load parameters from this
 		Refresh(); // get parameters from global object into this
 	}
 }
@@ -88,6 +109,8 @@ Parameters::~Parameters()
 			com_->unregisterCallback(lspc::MessageTypesFromPC::SetParameter);
 			com_->unregisterCallback(lspc::MessageTypesFromPC::StoreParameters);
 			com_->unregisterCallback(lspc::MessageTypesFromPC::DumpParameters);
+			com_->unregisterCallback(lspc::MessageTypesFromPC::GetParameters);
+			com_->unregisterCallback(lspc::MessageTypesFromPC::SetParameters);
 		}
 	}
 }
@@ -143,12 +166,67 @@ void Parameters::UnlockAfterChange(void)
 	if (!paramsGlobal) return;
 
 	memcpy((uint8_t *)&paramsGlobal->ForceDefaultParameters, (uint8_t *)&ForceDefaultParameters, PARAMETERS_LENGTH); // copy changed parameters (from current object) into global parameters object
+	paramsGlobal->changeCounter_++; // increase change counter to indicate a change
 	xSemaphoreGive( paramsGlobal->readSemaphore_ ); // give back the protection semaphore since we are now finished with changes
 
  	//paramsGlobal->StoreParameters(); // store the newly update global parameters in EEPROM (if it exists)
 	xSemaphoreGive( paramsGlobal->writeSemaphore_ ); // give back the EEPROM storing protection semaphore
 }
 
+/* Size of the complete parameter block, as stored in EEPROM */
+uint16_t Parameters::GetBlockSize(void)
+{
+	if (!paramsGlobal) return 0;
+	return PARAMETERS_LENGTH;
+}
+
+/* Copy the complete parameter block of the global object, eg. to make a backup */
+bool Parameters::ReadBlock(uint8_t * data, uint16_t length)
+{
+	if (!paramsGlobal || length != PARAMETERS_LENGTH) return false;
+
+	xSemaphoreTake( paramsGlobal->readSemaphore_, ( TickType_t ) portMAX_DELAY);
+	memcpy(data, (uint8_t *)&paramsGlobal->ForceDefaultParameters, PARAMETERS_LENGTH);
+	xSemaphoreGive( paramsGlobal->readSemaphore_ );
+
+	return true;
+}
+
+/* Replace the complete parameter block of the global object, eg. when restoring a backup.
+ * The block is only accepted if it has been created by firmware with the same parameter layout (size)
+ * and every parameter of the reflection table has a valid value, such that a corrupted block can not set eg. a NaN gain or an unknown controller mode.
+ * Note that the parameters are not stored into EEPROM. */
+bool Parameters::WriteBlock(const uint8_t * data, uint16_t length)
+{
+	if (!paramsGlobal || length != PARAMETERS_LENGTH) return false;
+
+	uint16_t blockParametersSize;
+	memcpy(&blockParametersSize, &data[(uint8_t *)&paramsGlobal->ParametersSize - (uint8_t *)&paramsGlobal->ForceDefaultParameters], sizeof(blockParametersSize));
+	if (blockParametersSize != PARAMETERS_LENGTH) return false;
+
+	for (uint32_t i = 0; i < sizeof(ParametersTable)/sizeof(Parameters_Section_t); i++) {
+		const Parameters_Section_t& section = ParametersTable[i];
+		uint32_t sectionOffset = paramsGlobal->GetSectionAddress(section.type) - (uint8_t *)&paramsGlobal->ForceDefaultParameters;
+		for (uint32_t j = 0; j < section.count; j++) {
+			if (!ValidateValues(&section.parameters[j], &data[sectionOffset + section.parameters[j].offset]))
+				return false;
+		}
+	}
+
+	/* Lock for change */
+	xSemaphoreTake( paramsGlobal->writeSemaphore_, ( TickType_t ) portMAX_DELAY);
+	xSemaphoreTake( paramsGlobal->readSemaphore_, ( TickType_t ) portMAX_DELAY);
+	paramsGlobal->changeCounter_++; // increase change counter to indicate a change
+
+	memcpy((uint8_t *)&paramsGlobal->ForceDefaultParameters, data, PARAMETERS_LENGTH);
+
+	/* Unlock after change */
+	xSemaphoreGive( paramsGlobal->readSemaphore_ ); // give back the protection semaphore since we are now finished with changes
+	xSemaphoreGive( paramsGlobal->writeSemaphore_ ); // give back the EEPROM storing protection semaphore
+
+	return true;
+}
+
 void Parameters::LoadParametersFromEEPROM(EEPROM * eeprom)
 {
 	if (!eeprom) return; // EEPROM not configured
@@ -177,17 +255,13 @@ void Parameters::StoreParameters(void)
 }
 
 
-void Parameters::SetParameter_Callback(void * param, const std::vector<uint8_t>& payload)
+void Parameters::SetParameter_Callback(void * param, const lspc::MessageTypesFromPC::SetParameter_t& msg, const uint8_t * values, uint16_t length)
 {
 	Parameters * params = (Parameters *)param;
 	if (!params) return;
 	if (params != paramsGlobal) return;
 
-	lspc::MessageTypesFromPC::SetParameter_t msg;
-	if (payload.size() <= sizeof(msg)) return; // package is too short (missing parameter value)
-	memcpy((uint8_t *)&msg, payload.data(), sizeof(msg));
-	uint16_t paramValueLengthBytes = payload.size() - sizeof(msg);
-	void * paramValuePtr = (uint8_t *)(payload.data() + sizeof(msg));
+	if (length == 0) return; // package is too short (missing parameter value)
 
 	/* Lock for change */
 	xSemaphoreTake( paramsGlobal->writeSemaphore_, ( TickType_t ) portMAX_DELAY);
@@ -196,24 +270,11 @@ void Parameters::SetParameter_Callback(void * param, const std::vector<uint8_t>&
 
 	/* Change/set the given parameter */
 	bool acknowledged = false;
-	void * paramPtr;
-	lspc::ParameterLookup::ValueType_t valueType;
-	uint8_t arraySize;
-	paramsGlobal->LookupParameter(msg.type, msg.param, &paramPtr, valueType, arraySize);
-	if (valueType != lspc::ParameterLookup::_unknown) {
-		uint8_t copyLength = 0;
-		if (valueType == lspc::ParameterLookup::_bool) copyLength = 1;
-		else if (valueType == lspc::ParameterLookup::_float) copyLength = 4;
-		else if (valueType == lspc::ParameterLookup::_uint8) copyLength = 1;
-		else if (valueType == lspc::ParameterLookup::_uint16) copyLength = 2;
-		else if (valueType == lspc::ParameterLookup::_uint32) copyLength = 4;
-
-		// Determine and verify length
-		if (arraySize == msg.arraySize && valueType == msg.valueType && arraySize*copyLength == paramValueLengthBytes) {
-			// Update the parameter
-			memcpy((uint8_t *)paramPtr, (uint8_t *)paramValuePtr, arraySize*copyLength);
-			acknowledged = true;
-		}
+	uint8_t * paramPtr;
+	if (paramsGlobal->LookupSetParameter(msg, &paramPtr) == length && ValidateValues(paramsGlobal->LookupParameter(msg.type, msg.param, &paramPtr), values)) {
+		// Update the parameter
+		memcpy(paramPtr, values, length);
+		acknowledged = true;
 	}
 
 	/* Send acknowledge response back to PC */
@@ -221,61 +282,150 @@ void Parameters::SetParameter_Callback(void * param, const std::vector<uint8_t>&
 	msgAck.type = msg.type;
 	msgAck.param = msg.param;
 	msgAck.acknowledged = acknowledged;
-	paramsGlobal->com_->TransmitAsync(lspc::MessageTypesToPC::SetParameterAck, (uint8_t *)&msgAck, sizeof(msgAck));
+	paramsGlobal->com_->TransmitAsync<lspc::MessageTypesToPC::SetParameterAck>(msgAck);
 
 	/* Unlock after change */
 	xSemaphoreGive( paramsGlobal->readSemaphore_ ); // give back the protection semaphore since we are now finished with changes
 	xSemaphoreGive( paramsGlobal->writeSemaphore_ ); // give back the EEPROM storing protection semaphore
 }
 
-void Parameters::GetParameter_Callback(void * param, const std::vector<uint8_t>& payload)
+void Parameters::GetParameter_Callback(void * param, const lspc::MessageTypesFromPC::GetParameter_t& msg)
+{
+	Parameters * params = (Parameters *)param;
+	if (!params) return;
+	if (params != paramsGlobal) return;
+
+	/* Lock for reading */
+	xSemaphoreTake( paramsGlobal->readSemaphore_, ( TickType_t ) portMAX_DELAY);
+
+	/* Read the given parameter */
+	uint8_t * paramPtr;
+	const Parameters_Entry_t * entry = paramsGlobal->LookupParameter(msg.type, msg.param, &paramPtr);
+	if (entry) {
+		// Read parameter straight into the response package
+		uint16_t valueLength = entry->valueSize * entry->arraySize;
+		LSPC::Message<lspc::MessageTypesToPC::GetParameter> response(*paramsGlobal->com_, valueLength);
+		if (response.Reserved()) {
+			response->type = msg.type;
+			response->param = msg.param;
+			response->valueType = entry->valueType;
+			response->arraySize = entry->arraySize;
+			memcpy(response.Data(), paramPtr, valueLength);
+			response.Transmit();
+		}
+	}
+
+	/* Unlock after reading */
+	xSemaphoreGive( paramsGlobal->readSemaphore_ ); // give back the read protection semaphore
+}
+
+/* Read several parameters in one request. The values are read under a single lock, hence they are consistent with each other.
+ * The responses are serialized straight into the payload of the transmit package, which is sent whenever the next response does not fit */
+void Parameters::GetParameters_Callback(void * param, const std::vector<uint8_t>& payload)
 {
 	Parameters * params = (Parameters *)param;
 	if (!params) return;
 	if (params != paramsGlobal) return;
 
 	lspc::MessageTypesFromPC::GetParameter_t msg;
-	if (payload.size() != sizeof(msg)) return;
-	memcpy((uint8_t *)&msg, payload.data(), sizeof(msg));
+	if (payload.size() == 0 || (payload.size() % sizeof(msg)) != 0) return;
+
+	lspc::LSPC_Async_Package_t package;
+	bool reserved = paramsGlobal->com_->Reserve(lspc::MessageTypesToPC::GetParameters, LSPC_MAXIMUM_PACKAGE_LENGTH, package);
+	uint16_t msgLength = 0;
 
 	/* Lock for reading */
 	xSemaphoreTake( paramsGlobal->readSemaphore_, ( TickType_t ) portMAX_DELAY);
 
-	/* Change/set the given parameter */
-	void * paramPtr;
-	lspc::ParameterLookup::ValueType_t valueType;
-	uint8_t arraySize;
-	paramsGlobal->LookupParameter(msg.type, msg.param, &paramPtr, valueType, arraySize);
-	if (valueType != lspc::ParameterLookup::_unknown) {
-		// Read parameter and send response
-		uint8_t copyLength = 0;
-		if (valueType == lspc::ParameterLookup::_bool) copyLength = 1;
-		else if (valueType == lspc::ParameterLookup::_float) copyLength = 4;
-		else if (valueType == lspc::ParameterLookup::_uint8) copyLength = 1;
-		else if (valueType == lspc::ParameterLookup::_uint16) copyLength = 2;
-		else if (valueType == lspc::ParameterLookup::_uint32) copyLength = 4;
+	for (size_t i = 0; i < payload.size() && reserved; i += sizeof(msg)) {
+		memcpy((uint8_t *)&msg, &payload[i], sizeof(msg));
 
 		lspc::MessageTypesToPC::GetParameter_t response;
 		response.type = msg.type;
 		response.param = msg.param;
-		response.valueType = valueType;
-		response.arraySize = arraySize;
-
-		uint16_t responseLengthBytes = sizeof(response) + copyLength*arraySize;
-		uint8_t * msgBuf = (uint8_t *)pvPortMalloc(responseLengthBytes);
-		if (msgBuf) {
-			memcpy(msgBuf, &response, sizeof(response));
-			memcpy(&msgBuf[sizeof(response)], (uint8_t *)paramPtr, arraySize*copyLength);
-			paramsGlobal->com_->TransmitAsync(lspc::MessageTypesToPC::GetParameter, msgBuf, responseLengthBytes);
-			vPortFree(msgBuf);
+		response.valueType = lspc::ParameterLookup::_unknown;
+		response.arraySize = 0;
+		uint16_t valueLength = 0;
+
+		uint8_t * paramPtr;
+		const Parameters_Entry_t * entry = paramsGlobal->LookupParameter(msg.type, msg.param, &paramPtr);
+		if (entry) {
+			response.valueType = entry->valueType;
+			response.arraySize = entry->arraySize;
+			valueLength = entry->valueSize * entry->arraySize;
+		}
+
+		if (msgLength + sizeof(response) + valueLength > LSPC_MAXIMUM_PACKAGE_LENGTH) { // send the parameters collected so far, since the next one does not fit
+			paramsGlobal->com_->Shrink(package, msgLength);
+			paramsGlobal->com_->Submit(package);
+			msgLength = 0;
+			reserved = paramsGlobal->com_->Reserve(lspc::MessageTypesToPC::GetParameters, LSPC_MAXIMUM_PACKAGE_LENGTH, package);
+			if (!reserved) break;
 		}
+
+		uint8_t * msgBuf = package.payload;
+		memcpy(&msgBuf[msgLength], &response, sizeof(response));
+		if (valueLength > 0)
+			memcpy(&msgBuf[msgLength + sizeof(response)], paramPtr, valueLength);
+		msgLength += sizeof(response) + valueLength;
 	}
 
 	/* Unlock after reading */
 	xSemaphoreGive( paramsGlobal->readSemaphore_ ); // give back the read protection semaphore
+
+	if (reserved) {
+		paramsGlobal->com_->Shrink(package, msgLength);
+		paramsGlobal->com_->Submit(package);
+	}
+}
+
+/* Set several parameters in one request. The request is validated completely before any parameter is changed, so either all or none of the parameters are set */
+void Parameters::SetParameters_Callback(void * param, const std::vector<uint8_t>& payload)
+{
+	Parameters * params = (Parameters *)param;
+	if (!params) return;
+	if (params != paramsGlobal) return;
+
+	lspc::MessageTypesToPC::SetParametersAck_t msgAck;
+	msgAck.count = 0;
+	msgAck.acknowledged = (payload.size() > 0);
+
+	/* Validate all parameters */
+	uint8_t * paramPtr;
+	uint16_t valueLength;
+	uint16_t offset = 0;
+	while (offset < payload.size()) {
+		uint16_t length = paramsGlobal->ParseSetParameter(&payload[offset], payload.size() - offset, &paramPtr, valueLength);
+		if (!length) {
+			msgAck.acknowledged = false;
+			break;
+		}
+		offset += length;
+		msgAck.count++;
+	}
+
+	if (msgAck.acknowledged) {
+		/* Lock for change */
+		xSemaphoreTake( paramsGlobal->writeSemaphore_, ( TickType_t ) portMAX_DELAY);
+		xSemaphoreTake( paramsGlobal->readSemaphore_, ( TickType_t ) portMAX_DELAY);
+		paramsGlobal->changeCounter_++; // increase change counter to indicate a change
+
+		offset = 0;
+		while (offset < payload.size()) {
+			offset += paramsGlobal->ParseSetParameter(&payload[offset], payload.size() - offset, &paramPtr, valueLength);
+			memcpy(paramPtr, &payload[offset - valueLength], valueLength);
+		}
+
+		/* Unlock after change */
+		xSemaphoreGive( paramsGlobal->readSemaphore_ ); // give back the protection semaphore since we are now finished with changes
+		xSemaphoreGive( paramsGlobal->writeSemaphore_ ); // give back the EEPROM storing protection semaphore
+	}
+
+	/* Send acknowledge response back to PC */
+	paramsGlobal->com_->TransmitAsync<lspc::MessageTypesToPC::SetParametersAck>(msgAck);
 }
 
-void Parameters::StoreParameters_Callback(void * param, const std::vector<uint8_t>& payload)
+void Parameters::StoreParameters_Callback(void * param, const std::vector<uint8_t>& /*payload*/)
 {
 	Parameters * params = (Parameters *)param;
 	if (!params) return;
@@ -302,10 +452,10 @@ void Parameters::StoreParameters_Callback(void * param, const std::vector<uint8_
 	xSemaphoreGive( paramsGlobal->writeSemaphore_ ); // give back the EEPROM storing protection semaphore
 
 	/* Send acknowledge to PC */
-	paramsGlobal->com_->TransmitAsync(lspc::MessageTypesToPC::StoreParametersAck, (uint8_t *)&msgAck, sizeof(msgAck));
+	paramsGlobal->com_->TransmitAsync<lspc::MessageTypesToPC::StoreParametersAck>(msgAck);
 }
 
-void Parameters::DumpParameters_Callback(void * param, const std::vector<uint8_t>& payload)
+void Parameters::DumpParameters_Callback(void * param, const std::vector<uint8_t>& /*payload*/)
 {
 	Parameters * params = (Parameters *)param;
 	if (!params) return;
@@ -337,67 +487,98 @@ void Parameters::DumpParameters_Callback(void * param, const std::vector<uint8_t
 	xSemaphoreGive( paramsGlobal->readSemaphore_ ); // give back the read protection semaphore
 }
 
-void Parameters::LookupParameter(uint8_t type, uint8_t param, void ** paramPtr, lspc::ParameterLookup::ValueType_t& valueType, uint8_t& arraySize)
+/**
+ * @brief 	Look up a parameter in the reflection table
+ * @param	type       Input: section id (lspc::ParameterLookup::type_t)
+ * @param	param      Input: parameter id within the section
+ * @param	paramPtr   Output: address of the parameter value in this object
+ * @retval	table entry of the parameter or 0 if the parameter does not exist
+ */
+const Parameters_Entry_t * Parameters::LookupParameter(uint8_t type, uint8_t param, uint8_t ** paramPtr)
 {
-	valueType = lspc::ParameterLookup::_unknown;
-	*paramPtr = (void *)0;
-	arraySize = 1; // arrays not supported yet
-
-	if (type == lspc::ParameterLookup::debug) {
-		switch (param) {
-			case lspc::ParameterLookup::EnableLogOutput: valueType = lspc::ParameterLookup::_bool; *paramPtr = (void *)&this->debug.EnableLogOutput; return;
-			case lspc::ParameterLookup::EnableRawSensorOutput: valueType = lspc::ParameterLookup::_bool; *paramPtr = (void *)&this->debug.EnableRawSensorOutput; return;
-			default: return;
-		}
-	}
-	else if (type == lspc::ParameterLookup::test) {
-		switch (param) {
-			case lspc::ParameterLookup::tmp: valueType = lspc::ParameterLookup::_float; *paramPtr = (void *)&this->test.tmp; return;
-			case lspc::ParameterLookup::tmp2: valueType = lspc::ParameterLookup::_float; *paramPtr = (void *)&this->test.tmp2; return;
-			default: return;
-		}
-	}
-	else if (type == lspc::ParameterLookup::behavioural) {
-		switch (param) {
-			case lspc::ParameterLookup::IndependentHeading: valueType = lspc::ParameterLookup::_bool; *paramPtr = (void *)&this->behavioural.IndependentHeading; return;
-			case lspc::ParameterLookup::YawVelocityBraking: valueType = lspc::ParameterLookup::_bool; *paramPtr = (void *)&this->behavioural.YawVelocityBraking; return;
-			case lspc::ParameterLookup::StepTestEnabled: valueType = lspc::ParameterLookup::_bool; *paramPtr = (void *)&this->behavioural.StepTestEnabled; return;
-			case lspc::ParameterLookup::VelocityControllerEnabled: valueType = lspc::ParameterLookup::_bool; *paramPtr = (void *)&this->behavioural.VelocityControllerEnabled; return;
-			case lspc::ParameterLookup::JoystickVelocityControl: valueType = lspc::ParameterLookup::_bool; *paramPtr = (void *)&this->behavioural.JoystickVelocityControl; return;
-			default: return;
-		}
-	}
-	else if (type == lspc::ParameterLookup::controller) {
-		switch (param) {
-			case lspc::ParameterLookup::ControllerSampleRate: valueType = lspc::ParameterLookup::_float; *paramPtr = (void *)&this->controller.SampleRate; return;
-			case lspc::ParameterLookup::mode: valueType = lspc::ParameterLookup::_uint8; *paramPtr = (void *)&this->controller.mode; return;
-			case lspc::ParameterLookup::type: valueType = lspc::ParameterLookup::_uint8; *paramPtr = (void *)&this->controller.type; return;
-			case lspc::ParameterLookup::EnableTorqueLPF: valueType = lspc::ParameterLookup::_bool; *paramPtr = (void *)&this->controller.EnableTorqueLPF; return;
-			default: return;
-		}
-	}
-	else if (type == lspc::ParameterLookup::estimator) {
-		switch (param) {
-			case lspc::ParameterLookup::EstimatorSampleRate: valueType = lspc::ParameterLookup::_float; *paramPtr = (void *)&this->estimator.SampleRate; return;
-			case lspc::ParameterLookup::EnableSensorLPFfilters: valueType = lspc::ParameterLookup::_bool; *paramPtr = (void *)&this->estimator.EnableSensorLPFfilters; return;
-			case lspc::ParameterLookup::EnableSoftwareLPFfilters: valueType = lspc::ParameterLookup::_bool; *paramPtr = (void *)&this->estimator.EnableSoftwareLPFfilters; return;
-			case lspc::ParameterLookup::CreateQdotFromQDifference: valueType = lspc::ParameterLookup::_bool; *paramPtr = (void *)&this->estimator.CreateQdotFromQDifference; return;
-			case lspc::ParameterLookup::UseMadgwick: valueType = lspc::ParameterLookup::_bool; *paramPtr = (void *)&this->estimator.UseMadgwick; return;
-			case lspc::ParameterLookup::UseVelocityEstimator: valueType = lspc::ParameterLookup::_bool; *paramPtr = (void *)&this->estimator.UseVelocityEstimator; return;
-			case lspc::ParameterLookup::EstimateCOM: valueType = lspc::ParameterLookup::_bool; *paramPtr = (void *)&this->estimator.EstimateCOM; return;
-			default: return;
-		}
+	*paramPtr = 0;
+	if (type < 1 || type > sizeof(ParametersTable)/sizeof(Parameters_Section_t)) return 0;
+
+	const Parameters_Section_t& section = ParametersTable[type - 1];
+	if (param < 1 || param > section.count) return 0;
+
+	const Parameters_Entry_t * entry = &section.parameters[param - 1];
+	*paramPtr = GetSectionAddress(type) + entry->offset;
+	return entry;
+}
+
+uint8_t * Parameters::GetSectionAddress(uint8_t type)
+{
+	switch (type) {
+		PARAMETERS_TABLE(PARAMETERS_SECTION_ADDRESS)
+		default: return 0;
 	}
-	else if (type == lspc::ParameterLookup::model) {
-		switch (param) {
-			case lspc::ParameterLookup::l: valueType = lspc::ParameterLookup::_float; *paramPtr = (void *)&this->model.l; return;
-			case lspc::ParameterLookup::Mk: valueType = lspc::ParameterLookup::_float; *paramPtr = (void *)&this->model.Mk; return;
-			case lspc::ParameterLookup::Mb: valueType = lspc::ParameterLookup::_float; *paramPtr = (void *)&this->model.Mb; return;
-			default: return;
+}
+
+/**
+ * @brief 	Validate a SetParameter_t header and the values following it against the reflection table
+ * @param	data         Input: SetParameter_t header followed by the parameter values
+ * @param	length       Input: number of bytes available in data
+ * @param	paramPtr     Output: address of the parameter value in this object
+ * @param	valueLength  Output: number of value bytes following the header
+ * @retval	number of bytes of the header and values, or 0 if the parameter is unknown, does not match the table or is truncated
+ */
+uint16_t Parameters::ParseSetParameter(const uint8_t * data, uint16_t length, uint8_t ** paramPtr, uint16_t& valueLength)
+{
+	lspc::MessageTypesFromPC::SetParameter_t msg;
+	if (length < sizeof(msg)) return 0;
+	memcpy((uint8_t *)&msg, data, sizeof(msg));
+
+	valueLength = LookupSetParameter(msg, paramPtr);
+	if (!valueLength) return 0;
+	if (sizeof(msg) + valueLength > length) return 0;
+	if (!ValidateValues(LookupParameter(msg.type, msg.param, paramPtr), &data[sizeof(msg)])) return 0;
+
+	return sizeof(msg) + valueLength;
+}
+
+/**
+ * @brief 	Validate a SetParameter_t header against the reflection table
+ * @param	msg          Input: SetParameter_t header
+ * @param	paramPtr     Output: address of the parameter value in this object
+ * @retval	number of value bytes which have to follow the header, or 0 if the parameter is unknown or does not match the table
+ */
+uint16_t Parameters::LookupSetParameter(const lspc::MessageTypesFromPC::SetParameter_t& msg, uint8_t ** paramPtr)
+{
+	const Parameters_Entry_t * entry = LookupParameter(msg.type, msg.param, paramPtr);
+	if (!entry) return 0;
+	if (msg.valueType != entry->valueType || msg.arraySize != entry->arraySize) return 0;
+
+	return entry->valueSize * entry->arraySize;
+}
+
+
+/**
+ * @brief 	Check that all values (array elements) of a parameter are valid for its type: floats have to be finite and
+ *          bool, integer and enum values can not exceed the largest value of the type
+ * @param	entry        Input: reflection table entry of the parameter
+ * @param	values       Input: parameter values, not necessarily aligned
+ * @retval	true if all values are valid
+ */
+bool Parameters::ValidateValues(const Parameters_Entry_t * entry, const uint8_t * values)
+{
+	if (!entry) return false;
+
+	for (uint32_t i = 0; i < entry->arraySize; i++) {
+		const uint8_t * value = &values[i * entry->valueSize];
+		if (entry->valueType == lspc::ParameterLookup::_float) {
+			float floatValue;
+			memcpy(&floatValue, value, sizeof(floatValue));
+			if (!isfinite(floatValue)) return false;
+		} else {
+			uint32_t integerValue = 0;
+			memcpy(&integerValue, value, entry->valueSize); // little endian
+			if (integerValue > entry->maxValue) return false;
 		}
 	}
-}
 
+	return true;
+}
 
 /*
 void Parameters::StoreThread(void)
@@ -26,7 +26,9 @@
 #include "EEPROM.h"
 #include "LSPC.hpp"
 
-#define PARAMETERS_LENGTH 	((uint32_t)&paramsGlobal->eeprom_ - (uint32_t)&paramsGlobal->ForceDefaultParameters)
+struct Parameters_Entry_t; // see ParametersTable.h
+
+#define PARAMETERS_LENGTH 	((uint32_t)((uint8_t *)&paramsGlobal->eeprom_ - (uint8_t *)&paramsGlobal->ForceDefaultParameters))
 
 class Parameters
 {
@@ -38,6 +40,7 @@ class Parameters
 			/* Debugging parameters */
 			bool EnableLogOutput = false;
 			bool EnableRawSensorOutput = true;
+			uint16_t RunTimeStatsPeriod = 1000; // period of the task run time statistics in ms, eg. 100 for load debugging (0 = disabled)
 			/* Debugging parameters end */
 		} debug;
 
@@ -117,6 +120,7 @@ class Parameters
 			float SoftwareLPFcoeffs_b[3] = {0.011353393934590, -0.014789591644084, 0.011353393934590};	// Created using:  [num, den] = cheby2(2,40,20/(Fs/2))
 			bool CreateQdotFromQDifference = false;
 			bool UseMadgwick = false;
+			bool UseMEKF = false; // use the multiplicative error-state EKF instead of the QEKF (if Madgwick is not used)
 			bool EstimateBias = true;
 			bool Use2Lvelocity = true; // if velocity estimator is not used
 			bool UseVelocityEstimator = true;
@@ -154,9 +158,12 @@ class Parameters
 			#endif
 
 			float sigma2_bias = 1E-11;
+			bool UseJosephForm = false; // use the Joseph form covariance update, (I-KH)*P*(I-KH)' + K*R*K', which is numerically more robust but more expensive than (I-KH)*P
 
 			// X_QEKF = {q0, q1, q2, q3,   dq0, dq1, dq2, dq3,   gyro_bias_x, gyro_bias_y}
 			float QEKF_P_init_diagonal[10] = {1E-5, 1E-5, 1E-5, 1E-7,   1E-7, 1E-7, 1E-7, 1E-7,   1E-5, 1E-5}; // initialize q3 variance lower than others, since yaw can not be estimated so we are more certain on the initial value to let gyro integration (dead-reckoning) dominate the "yaw" estimate
+			// X_MEKF = {dtheta_x, dtheta_y, dtheta_z,   gyro_bias_x, gyro_bias_y}  (attitude error in body frame)
+			float MEKF_P_init_diagonal[5] = {4E-5, 4E-5, 4E-7,   1E-5, 1E-5}; // 4*QEKF variance since dtheta ~ 2*dq_vec, lower yaw variance for the same reason as in the QEKF
 			float VelocityEstimator_P_init_diagonal[2] = {1E-1, 1E-1}; // initialize velocity estimator covariance
 			float COMEstimator_P_init_diagonal[2] = {1E-12, 1E-12}; // initialize COM estimator covariance
 			/* Estimator Tuning parameters end */
@@ -212,14 +219,24 @@ class Parameters
 		void LockForChange(void);
 		void UnlockAfterChange(void);
 
+		uint16_t GetBlockSize(void);
+		bool ReadBlock(uint8_t * data, uint16_t length);
+		bool WriteBlock(const uint8_t * data, uint16_t length);
+
 	private:
 		void LoadParametersFromEEPROM(EEPROM * eeprom = 0);
 		void AttachEEPROM(EEPROM * eeprom);
 		void StoreParameters(void); // stores to EEPROM
-		void LookupParameter(uint8_t type, uint8_t param, void ** paramPtr, lspc::ParameterLookup::ValueType_t& valueType, uint8_t& arraySize);
-
-		static void GetParameter_Callback(void * param, const std::vector<uint8_t>& payload);
-		static void SetParameter_Callback(void * param, const std::vector<uint8_t>& payload);
+		const Parameters_Entry_t * LookupParameter(uint8_t type, uint8_t param, uint8_t ** paramPtr);
+		uint8_t * GetSectionAddress(uint8_t type);
+		uint16_t ParseSetParameter(const uint8_t * data, uint16_t length, uint8_t ** paramPtr, uint16_t& valueLength);
+		uint16_t LookupSetParameter(const lspc::MessageTypesFromPC::SetParameter_t& msg, uint8_t ** paramPtr);
+		static bool ValidateValues(const Parameters_Entry_t * entry, const uint8_t * values);
+
+		static void GetParameter_Callback(void * param, const lspc::MessageTypesFromPC::GetParameter_t& msg);
+		static void SetParameter_Callback(void * param, const lspc::MessageTypesFromPC::SetParameter_t& msg, const uint8_t * values, uint16_t length);
+		static void GetParameters_Callback(void * param, const std::vector<uint8_t>& payload);
+		static void SetParameters_Callback(void * param, const std::vector<uint8_t>& payload);
 		static void StoreParameters_Callback(void * param, const std::vector<uint8_t>& payload);
 		static void DumpParameters_Callback(void * param, const std::vector<uint8_t>& payload);
 
@@ -0,0 +1,196 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+ 
+
+#ifndef MODULES_PARAMETERS_TABLE_H
+#define MODULES_PARAMETERS_TABLE_H
+
+#include <stdint.h>
+#include <stddef.h> // for offsetof
+#include <type_traits>
+#include "MessageTypes.h"
+
+/* Reflection table of the parameters accessible over LSPC.
+ * Every section lists its parameters as PARAM(section, id, field), where id is the lspc::ParameterLookup id of the parameter.
+ * The parameters of a section have to be listed in the order of their ids (starting from 1), since lookups index directly into the table.
+ * Name, value type, array size and offset of each parameter are derived from the field declaration in Parameters.h at compile time.
+ * When adding a parameter, add it to the section struct in Parameters.h, to the id enum in MessageTypes.h and to the list below. */
+#define PARAMETERS_TABLE_DEBUG(PARAM) \
+	PARAM(debug, EnableLogOutput, EnableLogOutput) \
+	PARAM(debug, EnableRawSensorOutput, EnableRawSensorOutput) \
+	PARAM(debug, RunTimeStatsPeriod, RunTimeStatsPeriod)
+
+#define PARAMETERS_TABLE_BEHAVIOURAL(PARAM) \
+	PARAM(behavioural, IndependentHeading, IndependentHeading) \
+	PARAM(behavioural, YawVelocityBraking, YawVelocityBraking) \
+	PARAM(behavioural, StepTestEnabled, StepTestEnabled) \
+	PARAM(behavioural, VelocityControllerEnabled, VelocityControllerEnabled) \
+	PARAM(behavioural, JoystickVelocityControl, JoystickVelocityControl)
+
+#define PARAMETERS_TABLE_CONTROLLER(PARAM) \
+	PARAM(controller, ControllerSampleRate, SampleRate) \
+	PARAM(controller, type, type) \
+	PARAM(controller, mode, mode) \
+	PARAM(controller, EnableTorqueLPF, EnableTorqueLPF) \
+	PARAM(controller, TorqueLPFtau, TorqueLPFtau) \
+	PARAM(controller, EnableTorqueSaturation, EnableTorqueSaturation) \
+	PARAM(controller, TorqueMax, TorqueMax) \
+	PARAM(controller, TorqueRampUp, TorqueRampUp) \
+	PARAM(controller, TorqueRampUpTime, TorqueRampUpTime) \
+	PARAM(controller, DisableQdot, DisableQdot) \
+	PARAM(controller, K, K) \
+	PARAM(controller, ContinousSwitching, ContinousSwitching) \
+	PARAM(controller, eta, eta) \
+	PARAM(controller, epsilon, epsilon) \
+	PARAM(controller, LQR_K, LQR_K) \
+	PARAM(controller, LQR_MaxYawError, LQR_MaxYawError) \
+	PARAM(controller, VelocityController_MaxTilt, VelocityController_MaxTilt) \
+	PARAM(controller, VelocityController_MaxIntegralCorrection, VelocityController_MaxIntegralCorrection) \
+	PARAM(controller, VelocityController_VelocityClamp, VelocityController_VelocityClamp) \
+	PARAM(controller, VelocityController_IntegralGain, VelocityController_IntegralGain)
+
+#define PARAMETERS_TABLE_ESTIMATOR(PARAM) \
+	PARAM(estimator, EstimatorSampleRate, SampleRate) \
+	PARAM(estimator, EnableSensorLPFfilters, EnableSensorLPFfilters) \
+	PARAM(estimator, EnableSoftwareLPFfilters, EnableSoftwareLPFfilters) \
+	PARAM(estimator, SoftwareLPFcoeffs_a, SoftwareLPFcoeffs_a) \
+	PARAM(estimator, SoftwareLPFcoeffs_b, SoftwareLPFcoeffs_b) \
+	PARAM(estimator, CreateQdotFromQDifference, CreateQdotFromQDifference) \
+	PARAM(estimator, UseMadgwick, UseMadgwick) \
+	PARAM(estimator, EstimateBias, EstimateBias) \
+	PARAM(estimator, Use2Lvelocity, Use2Lvelocity) \
+	PARAM(estimator, UseVelocityEstimator, UseVelocityEstimator) \
+	PARAM(estimator, UseCOMestimateInVelocityEstimator, UseCOMestimateInVelocityEstimator) \
+	PARAM(estimator, EstimateCOM, EstimateCOM) \
+	PARAM(estimator, EstimateCOMminVelocity, EstimateCOMminVelocity) \
+	PARAM(estimator, MaxCOMDeviation, MaxCOMDeviation) \
+	PARAM(estimator, MadgwickBeta, MadgwickBeta) \
+	PARAM(estimator, GyroCov_Tuning_Factor, GyroCov_Tuning_Factor) \
+	PARAM(estimator, AccelCov_Tuning_Factor, AccelCov_Tuning_Factor) \
+	PARAM(estimator, cov_gyro_mpu, cov_gyro_mpu) \
+	PARAM(estimator, cov_acc_mpu, cov_acc_mpu) \
+	PARAM(estimator, sigma2_bias, sigma2_bias) \
+	PARAM(estimator, QEKF_P_init_diagonal, QEKF_P_init_diagonal) \
+	PARAM(estimator, VelocityEstimator_P_init_diagonal, VelocityEstimator_P_init_diagonal) \
+	PARAM(estimator, COMEstimator_P_init_diagonal, COMEstimator_P_init_diagonal) \
+	PARAM(estimator, UseJosephForm, UseJosephForm) \
+	PARAM(estimator, UseMEKF, UseMEKF) \
+	PARAM(estimator, MEKF_P_init_diagonal, MEKF_P_init_diagonal)
+
+#define PARAMETERS_TABLE_MODEL(PARAM) \
+	PARAM(model, l, l) \
+	PARAM(model, COM_X, COM_X) \
+	PARAM(model, COM_Y, COM_Y) \
+	PARAM(model, COM_Z, COM_Z) \
+	PARAM(model, g, g) \
+	PARAM(model, rk, rk) \
+	PARAM(model, Mk, Mk) \
+	PARAM(model, Jk, Jk) \
+	PARAM(model, rw, rw) \
+	PARAM(model, Mw, Mw) \
+	PARAM(model, i_gear, i_gear) \
+	PARAM(model, Jow, Jow) \
+	PARAM(model, Jm, Jm) \
+	PARAM(model, Jw, Jw) \
+	PARAM(model, Mb, Mb) \
+	PARAM(model, Jbx, Jbx) \
+	PARAM(model, Jby, Jby) \
+	PARAM(model, Jbz, Jbz) \
+	PARAM(model, Bvk, Bvk) \
+	PARAM(model, Bvm, Bvm) \
+	PARAM(model, Bvb, Bvb) \
+	PARAM(model, EncoderTicksPrRev, EncoderTicksPrRev) \
+	PARAM(model, TicksPrRev, TicksPrRev)
+
+#define PARAMETERS_TABLE_TEST(PARAM) \
+	PARAM(test, tmp, tmp) \
+	PARAM(test, tmp2, tmp2)
+
+/* Sections in the order of their lspc::ParameterLookup::type_t ids (starting from 1) */
+#define PARAMETERS_TABLE(SECTION) \
+	SECTION(debug, PARAMETERS_TABLE_DEBUG) \
+	SECTION(behavioural, PARAMETERS_TABLE_BEHAVIOURAL) \
+	SECTION(controller, PARAMETERS_TABLE_CONTROLLER) \
+	SECTION(estimator, PARAMETERS_TABLE_ESTIMATOR) \
+	SECTION(model, PARAMETERS_TABLE_MODEL) \
+	SECTION(test, PARAMETERS_TABLE_TEST)
+
+typedef struct Parameters_Entry_t {
+	const char * name;    // "section.field"
+	uint8_t param;        // lspc::ParameterLookup id within the section
+	lspc::ParameterLookup::ValueType_t valueType;
+	uint8_t valueSize;    // size of a single value (array element) in bytes
+	uint8_t arraySize;    // number of values, 1 if not an array
+	uint16_t offset;      // byte offset of the field within the section struct
+	uint32_t maxValue;    // largest valid value of an integer, enum or bool value
+} Parameters_Entry_t;
+
+typedef struct Parameters_Section_t {
+	const char * name;
+	uint8_t type;         // lspc::ParameterLookup::type_t id
+	const Parameters_Entry_t * parameters; // parameters ordered by id, such that parameters[id-1] is the parameter with the given id
+	uint8_t count;
+} Parameters_Section_t;
+
+/* Mapping from field type to LSPC value type */
+template<typename T> struct Parameters_ValueType { static constexpr lspc::ParameterLookup::ValueType_t value = lspc::ParameterLookup::_unknown; };
+template<> struct Parameters_ValueType<bool> { static constexpr lspc::ParameterLookup::ValueType_t value = lspc::ParameterLookup::_bool; };
+template<> struct Parameters_ValueType<float> { static constexpr lspc::ParameterLookup::ValueType_t value = lspc::ParameterLookup::_float; };
+template<> struct Parameters_ValueType<uint8_t> { static constexpr lspc::ParameterLookup::ValueType_t value = lspc::ParameterLookup::_uint8; };
+template<> struct Parameters_ValueType<uint16_t> { static constexpr lspc::ParameterLookup::ValueType_t value = lspc::ParameterLookup::_uint16; };
+template<> struct Parameters_ValueType<uint32_t> { static constexpr lspc::ParameterLookup::ValueType_t value = lspc::ParameterLookup::_uint32; };
+template<> struct Parameters_ValueType<lspc::ParameterTypes::controllerType_t> { static constexpr lspc::ParameterLookup::ValueType_t value = lspc::ParameterLookup::_uint8; };
+template<> struct Parameters_ValueType<lspc::ParameterTypes::controllerMode_t> { static constexpr lspc::ParameterLookup::ValueType_t value = lspc::ParameterLookup::_uint8; };
+
+/* Largest valid value of a field type, such that out of range bool and enum values can be rejected */
+template<typename T> struct Parameters_MaxValue { static constexpr uint32_t value = 0xFFFFFFFF; };
+template<> struct Parameters_MaxValue<bool> { static constexpr uint32_t value = 1; };
+template<> struct Parameters_MaxValue<uint8_t> { static constexpr uint32_t value = 0xFF; };
+template<> struct Parameters_MaxValue<uint16_t> { static constexpr uint32_t value = 0xFFFF; };
+template<> struct Parameters_MaxValue<lspc::ParameterTypes::controllerType_t> { static constexpr uint32_t value = lspc::ParameterTypes::SLIDING_MODE_CONTROLLER; };
+template<> struct Parameters_MaxValue<lspc::ParameterTypes::controllerMode_t> { static constexpr uint32_t value = lspc::ParameterTypes::PATH_FOLLOWING; };
+
+/* Table entry of the field of a section struct (struct Parameters::<section>_t) */
+#define PARAMETERS_TABLE_ENTRY(section, id, field) \
+	{ #section "." #field, \
+	  lspc::ParameterLookup::id, \
+	  Parameters_ValueType<std::remove_extent<decltype(Parameters::section##_t::field)>::type>::value, \
+	  sizeof(std::remove_extent<decltype(Parameters::section##_t::field)>::type), \
+	  sizeof(Parameters::section##_t::field) / sizeof(std::remove_extent<decltype(Parameters::section##_t::field)>::type), \
+	  offsetof(Parameters::section##_t, field), \
+	  Parameters_MaxValue<std::remove_extent<decltype(Parameters::section##_t::field)>::type>::value },
+
+/* Compile-time checks that the entries of a table are ordered by their ids, starting from 1 */
+constexpr bool Parameters_IsOrdered(const Parameters_Entry_t * table, uint32_t count, uint32_t i = 0)
+{
+	return (i == count) || (table[i].param == i+1 && Parameters_IsOrdered(table, count, i+1));
+}
+
+constexpr bool Parameters_IsOrdered(const Parameters_Section_t * table, uint32_t count, uint32_t i = 0)
+{
+	return (i == count) || (table[i].type == i+1 && Parameters_IsOrdered(table, count, i+1));
+}
+
+/* Compile-time check that all value types are supported */
+constexpr bool Parameters_IsSupported(const Parameters_Entry_t * table, uint32_t count, uint32_t i = 0)
+{
+	return (i == count) || (table[i].valueType != lspc::ParameterLookup::_unknown && Parameters_IsSupported(table, count, i+1));
+}
+
+#endif
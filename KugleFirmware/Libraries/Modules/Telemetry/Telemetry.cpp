@@ -0,0 +1,308 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+ 
+ 
+#include "Telemetry.h"
+#include "Debug.h"
+#include "CRC32.h"
+#include <string.h> // for memcpy
+#include <math.h>
+
+Telemetry::Telemetry(LSPC& com) : com_(com), numberOfStreams_(0)
+{
+	com_.registerCallback(lspc::MessageTypesFromPC::TelemetrySettings, &TelemetrySettings_Callback, (void *)this);
+	com_.registerCallback<lspc::MessageTypesFromPC::EstimatorSettings>(&EstimatorSettings_Callback, (void *)this);
+}
+
+Telemetry::~Telemetry()
+{
+	com_.unregisterCallback(lspc::MessageTypesFromPC::TelemetrySettings);
+	com_.unregisterCallback(lspc::MessageTypesFromPC::EstimatorSettings);
+}
+
+/**
+ * @brief 	Add a periodic message type to the rate control. Registering an existing stream keeps its current prescaler.
+ * @param	type       Input: message type
+ * @param	prescaler  Input: default prescaler, 0 to leave the stream unsubscribed until the PC enables it
+ */
+void Telemetry::Register(lspc::MessageTypesToPC::MessageTypesToPC_t type, uint16_t prescaler)
+{
+	if (Find(type)) return;
+	if (numberOfStreams_ >= TELEMETRY_MAX_STREAMS) {
+		ERROR("Too many telemetry streams");
+		return;
+	}
+
+	stream_t& stream = streams_[numberOfStreams_];
+	stream.type = type;
+	stream.format = lspc::TelemetryTypes::FULL;
+	stream.prescaler = prescaler;
+	stream.counter = 0;
+	stream.restart = true;
+	stream.synchronizedTime = false;
+	stream.frame = 0;
+	stream.framesSinceKeyFrame = 0;
+	stream.constantsChecksum = 0;
+	numberOfStreams_++; // publish the stream after it has been initialized
+}
+
+/**
+ * @brief 	Change the prescaler of a registered stream
+ * @retval	false if the message type has not been registered
+ */
+bool Telemetry::SetPrescaler(uint8_t type, uint16_t prescaler)
+{
+	stream_t * stream = Find(type);
+	if (!stream) return false;
+
+	stream->prescaler = prescaler;
+	stream->counter = 0;
+	stream->restart = true;
+	return true;
+}
+
+/**
+ * @brief 	Select the format of a registered stream. Message types without a compact field table are always sent in the full format.
+ * @retval	false if the message type has not been registered
+ */
+bool Telemetry::SetFormat(uint8_t type, lspc::TelemetryTypes::format_t format)
+{
+	stream_t * stream = Find(type);
+	if (!stream) return false;
+
+	uint8_t fieldCount;
+	if (format != lspc::TelemetryTypes::COMPACT || !lspc::TelemetryTypes::GetCompactFields(type, fieldCount))
+		format = lspc::TelemetryTypes::FULL;
+
+	stream->format = format;
+	stream->restart = true;
+	return true;
+}
+
+/**
+ * @brief 	Check whether the current sample of a stream should be transmitted. Call once per sample, before building the message.
+ * @retval	true if the message should be built and transmitted
+ */
+bool Telemetry::Due(lspc::MessageTypesToPC::MessageTypesToPC_t type)
+{
+	stream_t * stream = Find(type);
+	if (!stream || stream->prescaler == 0) return false;
+	if (!com_.Connected()) {
+		stream->restart = true; // start a new compact session when the PC connects
+		return false;
+	}
+	if (!com_.Accepts(type)) return false; // transmit queue is full, so the message would be dropped anyway
+
+	if (++stream->counter < stream->prescaler) return false;
+	stream->counter = 0;
+	return true;
+}
+
+/**
+ * @brief 	Transmit a message of a stream in the format selected by the PC
+ * @param	type       Input: message type
+ * @param	msg        Input: message structure
+ * @param	length     Input: size of the message structure
+ * @param	synchronizedTime  Input: the time field is in the synchronized time base (see TimeSync::GetTelemetryTime), sent with compact frames
+ * @retval	true if the message was queued for transmission
+ */
+bool Telemetry::Transmit(lspc::MessageTypesToPC::MessageTypesToPC_t type, const void * msg, uint16_t length, bool synchronizedTime)
+{
+	stream_t * stream = Find(type);
+	if (!stream || stream->format != lspc::TelemetryTypes::COMPACT)
+		return com_.TransmitAsync(type, (const uint8_t *)msg, length);
+
+	uint8_t buffer[LSPC_MAXIMUM_PACKAGE_LENGTH];
+	int32_t values[TELEMETRY_COMPACT_MAX_VALUES];
+	uint32_t constantsChecksum;
+	uint16_t encodedLength = EncodeCompact(*stream, (const uint8_t *)msg, length, synchronizedTime, buffer, values, constantsChecksum);
+	if (!encodedLength)
+		return com_.TransmitAsync(type, (const uint8_t *)msg, length);
+
+	// The encoder state only advances when the frame has been queued, such that the next delta refers to a frame the PC will receive
+	if (!com_.TransmitAsync(lspc::MessageTypesToPC::CompactTelemetry, buffer, encodedLength))
+		return false;
+
+	lspc::TelemetryTypes::Compact_t header;
+	memcpy(&header, buffer, sizeof(header));
+	memcpy(stream->previous, values, sizeof(values));
+	stream->frame++;
+	stream->framesSinceKeyFrame = (header.flags & lspc::TelemetryTypes::COMPACT_KEY_FRAME) ? 1 : stream->framesSinceKeyFrame + 1;
+	stream->constantsChecksum = constantsChecksum;
+	stream->synchronizedTime = synchronizedTime;
+	stream->restart = false;
+	return true;
+}
+
+static uint8_t * WriteVarint(uint8_t * buffer, int64_t value)
+{
+	uint64_t zigzag = ((uint64_t)value << 1) ^ (uint64_t)(value >> 63); // small negative and positive values get small codes
+	while (zigzag >= 0x80) {
+		*buffer++ = (uint8_t)(zigzag | 0x80);
+		zigzag >>= 7;
+	}
+	*buffer++ = (uint8_t)zigzag;
+	return buffer;
+}
+
+/**
+ * @brief 	Quantize a value of a FIELD_FLOAT or FIELD_WRAPPING field
+ * @param	value      Input: value to quantize
+ * @param	field      Input: field of the value
+ * @param	quantized  Output: number of quantization steps
+ * @retval	false if the value can not be represented, i.e. it is not a number or a FIELD_FLOAT value is outside the 32 bit range
+ */
+static bool Quantize(float value, const lspc::TelemetryTypes::CompactField_t& field, int64_t& quantized)
+{
+	if (!isfinite(value)) return false;
+	double steps = rint((double)value / field.resolution);
+	if (field.kind == lspc::TelemetryTypes::FIELD_WRAPPING) {
+		if (fabs(steps) >= 9223372036854775808.0) return false; // 2^63
+	} else {
+		if (steps > 2147483647.0 || steps < -2147483648.0) return false;
+	}
+	quantized = (int64_t)steps;
+	return true;
+}
+
+/**
+ * @brief 	Encode a message in the compact format, see TelemetryTypes::Compact_t
+ * @param	stream             Input: stream of the message
+ * @param	msg                Input: message structure
+ * @param	length             Input: size of the message structure
+ * @param	synchronizedTime   Input: time base of the time field
+ * @param	buffer             Output: encoded package of at most LSPC_MAXIMUM_PACKAGE_LENGTH bytes
+ * @param	values             Output: quantized values, which become the reference of the next frame once the package has been sent
+ * @param	constantsChecksum  Output: checksum of the constant fields
+ * @retval	length of the encoded package or 0 if the message can not be encoded
+ */
+uint16_t Telemetry::EncodeCompact(stream_t& stream, const uint8_t * msg, uint16_t length, bool synchronizedTime, uint8_t * buffer, int32_t values[TELEMETRY_COMPACT_MAX_VALUES], uint32_t& constantsChecksum)
+{
+	uint8_t fieldCount;
+	const lspc::TelemetryTypes::CompactField_t * fields = lspc::TelemetryTypes::GetCompactFields(stream.type, fieldCount);
+	if (!fields) return 0;
+
+	// Constant fields are only sent when they have changed or a new session starts
+	constantsChecksum = 0xFFFFFFFF;
+	for (uint8_t i = 0; i < fieldCount; i++) {
+		if (fields[i].kind != lspc::TelemetryTypes::FIELD_CONSTANT) continue;
+		if (fields[i].offset + fields[i].count * sizeof(float) > length) return 0;
+		constantsChecksum = CRC32_Update(constantsChecksum, &msg[fields[i].offset], fields[i].count * sizeof(float));
+	}
+
+	lspc::TelemetryTypes::Compact_t header;
+	header.type = stream.type;
+	header.flags = 0;
+	header.frame = stream.frame;
+	if (synchronizedTime)
+		header.flags |= lspc::TelemetryTypes::COMPACT_SYNCHRONIZED;
+	// The time jumps when the time base changes, possibly by more than the 32 bit delta of a wrapping field can hold
+	if (stream.restart || stream.framesSinceKeyFrame >= TELEMETRY_KEY_FRAME_INTERVAL || synchronizedTime != stream.synchronizedTime)
+		header.flags |= lspc::TelemetryTypes::COMPACT_KEY_FRAME;
+	if (stream.restart || constantsChecksum != stream.constantsChecksum)
+		header.flags |= lspc::TelemetryTypes::COMPACT_CONSTANTS;
+
+	uint8_t * ptr = buffer + sizeof(header);
+	if (header.flags & lspc::TelemetryTypes::COMPACT_CONSTANTS) {
+		for (uint8_t i = 0; i < fieldCount; i++) {
+			if (fields[i].kind != lspc::TelemetryTypes::FIELD_CONSTANT) continue;
+			if (ptr + fields[i].count * sizeof(float) > buffer + LSPC_MAXIMUM_PACKAGE_LENGTH) return 0;
+			memcpy(ptr, &msg[fields[i].offset], fields[i].count * sizeof(float));
+			ptr += fields[i].count * sizeof(float);
+		}
+	}
+
+	uint8_t index = 0;
+	for (uint8_t i = 0; i < fieldCount; i++) {
+		const lspc::TelemetryTypes::CompactField_t& field = fields[i];
+		if (field.kind == lspc::TelemetryTypes::FIELD_CONSTANT) continue;
+		uint8_t size = (field.kind == lspc::TelemetryTypes::FIELD_UINT8) ? 1 : sizeof(float);
+		if (field.offset + field.count * size > length) return 0;
+		if (index + field.count > TELEMETRY_COMPACT_MAX_VALUES) return 0;
+		uint8_t maxVarint = (field.kind == lspc::TelemetryTypes::FIELD_WRAPPING) ? 10 : 5; // 64 bit key frame values of WRAPPING fields
+		if (ptr + field.count * maxVarint > buffer + LSPC_MAXIMUM_PACKAGE_LENGTH) return 0;
+
+		for (uint8_t n = 0; n < field.count; n++, index++) {
+			int64_t steps;
+			if (field.kind == lspc::TelemetryTypes::FIELD_UINT8) {
+				steps = msg[field.offset + n];
+			} else {
+				float value;
+				memcpy(&value, &msg[field.offset + n * sizeof(float)], sizeof(value));
+				if (!Quantize(value, field, steps))
+					return 0; // sent in the full format, which keeps the delta reference of the stream unchanged
+			}
+			values[index] = (int32_t)(uint32_t)steps; // WRAPPING values are only referenced by their lower 32 bits
+
+			if (header.flags & lspc::TelemetryTypes::COMPACT_KEY_FRAME)
+				ptr = WriteVarint(ptr, steps);
+			else
+				ptr = WriteVarint(ptr, (int32_t)((uint32_t)values[index] - (uint32_t)stream.previous[index])); // wraps around at 32 bits
+		}
+	}
+
+	memcpy(buffer, &header, sizeof(header));
+	return ptr - buffer;
+}
+
+Telemetry::stream_t * Telemetry::Find(uint8_t type)
+{
+	for (uint8_t i = 0; i < numberOfStreams_; i++) {
+		if (streams_[i].type == type)
+			return &streams_[i];
+	}
+	return 0;
+}
+
+void Telemetry::TransmitInfo(void)
+{
+	lspc::TelemetryTypes::Stream_t info[TELEMETRY_MAX_STREAMS];
+
+	for (uint8_t i = 0; i < numberOfStreams_; i++) {
+		info[i].type = streams_[i].type;
+		info[i].format = streams_[i].format;
+		info[i].prescaler = streams_[i].prescaler;
+	}
+
+	com_.TransmitAsync(lspc::MessageTypesToPC::TelemetryInfo, (const uint8_t *)info, numberOfStreams_ * sizeof(lspc::TelemetryTypes::Stream_t));
+}
+
+void Telemetry::TelemetrySettings_Callback(void * param, const std::vector<uint8_t>& payload)
+{
+	Telemetry * telemetry = (Telemetry *)param;
+	if (!telemetry) return;
+	if (payload.size() % sizeof(lspc::TelemetryTypes::Stream_t) != 0) return; // package is malformed
+
+	for (size_t offset = 0; offset < payload.size(); offset += sizeof(lspc::TelemetryTypes::Stream_t)) {
+		lspc::TelemetryTypes::Stream_t setting;
+		memcpy(&setting, &payload[offset], sizeof(setting));
+		telemetry->SetPrescaler(setting.type, setting.prescaler); // unknown message types are left out of the reply
+		telemetry->SetFormat(setting.type, setting.format);
+	}
+
+	telemetry->TransmitInfo();
+}
+
+void Telemetry::EstimatorSettings_Callback(void * param, const lspc::MessageTypesFromPC::EstimatorSettings_t& msg)
+{
+	Telemetry * telemetry = (Telemetry *)param;
+	if (!telemetry) return;
+
+	telemetry->SetPrescaler(lspc::MessageTypesToPC::StateEstimates, msg.estimate_msg_prescaler);
+}
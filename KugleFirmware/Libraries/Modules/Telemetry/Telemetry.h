@@ -0,0 +1,82 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+ 
+ 
+
+#ifndef MODULES_TELEMETRY_H
+#define MODULES_TELEMETRY_H
+
+#include "cmsis_os.h"
+#include "LSPC.hpp"
+
+#define TELEMETRY_MAX_STREAMS	16
+#define TELEMETRY_COMPACT_MAX_VALUES	16 // maximum number of delta encoded values of a message in the compact format
+#define TELEMETRY_KEY_FRAME_INTERVAL	50 // maximum number of compact frames between key frames
+
+/* Rate control of the periodic telemetry messages.
+ * Each periodic message type is registered as a stream with a prescaler, such that only every prescaler'th sample is transmitted.
+ * The producer calls Due() before building a message, so no serialization work is done for skipped samples,
+ * for unsubscribed streams (prescaler 0) or while no PC is connected.
+ * The PC sets the prescalers with the TelemetrySettings message and gets the current settings in the TelemetryInfo reply.
+ * The StateEstimates prescaler is also set by the estimate_msg_prescaler of the EstimatorSettings message.
+ * The PC can furthermore select the compact format for a stream, in which case Transmit() sends the message
+ * quantized and delta encoded as a CompactTelemetry package (see TelemetryTypes::Compact_t), which also carries the time base
+ * of the time field given to Transmit(), ie. whether it came from TimeSync::GetTelemetryTime while the clocks were synchronized.
+ * The full format has no room for it, so the PC only knows it from the synchronized flag of the TimeSync replies. */
+class Telemetry
+{
+	public:
+		Telemetry(LSPC& com);
+		~Telemetry();
+
+		void Register(lspc::MessageTypesToPC::MessageTypesToPC_t type, uint16_t prescaler = 1);
+		bool SetPrescaler(uint8_t type, uint16_t prescaler);
+		bool SetFormat(uint8_t type, lspc::TelemetryTypes::format_t format);
+		bool Due(lspc::MessageTypesToPC::MessageTypesToPC_t type);
+		bool Transmit(lspc::MessageTypesToPC::MessageTypesToPC_t type, const void * msg, uint16_t length, bool synchronizedTime = false);
+
+	private:
+		typedef struct {
+			uint8_t type;
+			lspc::TelemetryTypes::format_t format;
+			uint16_t prescaler;
+			uint16_t counter;
+			/* Compact format encoder state */
+			bool restart; // send a key frame with the constant fields next
+			bool synchronizedTime; // time base of the previous frame
+			uint16_t frame;
+			uint16_t framesSinceKeyFrame;
+			uint32_t constantsChecksum; // of the constant fields sent last
+			int32_t previous[TELEMETRY_COMPACT_MAX_VALUES]; // quantized values of the previous frame
+		} stream_t;
+
+		stream_t * Find(uint8_t type);
+		uint16_t EncodeCompact(stream_t& stream, const uint8_t * msg, uint16_t length, bool synchronizedTime, uint8_t * buffer, int32_t values[TELEMETRY_COMPACT_MAX_VALUES], uint32_t& constantsChecksum);
+		void TransmitInfo(void);
+
+		static void TelemetrySettings_Callback(void * param, const std::vector<uint8_t>& payload);
+		static void EstimatorSettings_Callback(void * param, const lspc::MessageTypesFromPC::EstimatorSettings_t& msg);
+
+	private:
+		LSPC& com_;
+		stream_t streams_[TELEMETRY_MAX_STREAMS];
+		uint8_t numberOfStreams_;
+};
+
+#endif
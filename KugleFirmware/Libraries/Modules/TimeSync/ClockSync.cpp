@@ -0,0 +1,211 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+ 
+ 
+
+#include "ClockSync.h"
+#include <math.h>
+
+ClockSync::ClockSync()
+{
+	Reset();
+}
+
+void ClockSync::Reset(void)
+{
+	initialized_ = false;
+	time_ = 0;
+	offsetBase_ = 0;
+	offset_ = 0;
+	drift_ = 0;
+	P_[0] = 1e12; // 1 second standard deviation
+	P_[1] = 0;
+	P_[2] = CLOCKSYNC_INITIAL_DRIFT * CLOCKSYNC_INITIAL_DRIFT;
+	minDelay_ = 0;
+	delay_ = 0;
+	rejected_ = 0;
+}
+
+/**
+ * @brief 	Update the estimate with the time stamps of an exchange
+ * @param	t1         Input: transmit time of the request (reference clock)
+ * @param	t2         Input: reception time of the request (local clock)
+ * @param	t3         Input: transmit time of the reply (local clock)
+ * @param	t4         Input: reception time of the reply (reference clock)
+ * @retval	false if the exchange was rejected
+ */
+bool ClockSync::Update(uint64_t t1, uint64_t t2, uint64_t t3, uint64_t t4)
+{
+	if (t3 < t2 || t4 < t1) return false;
+	double delay = (double)(t4 - t1) - (double)(t3 - t2);
+	if (delay < 0) return false;
+
+	uint64_t midpoint = t2 + (t3 - t2) / 2;
+	if (initialized_ && midpoint < time_) return false; // older than the estimate
+
+	if (!initialized_) {
+		offsetBase_ = (int64_t)(t1 - t2);
+		minDelay_ = delay;
+	}
+
+	// Offset measured by the exchange, relative to offsetBase_
+	double measurement = ((double)((int64_t)(t1 - t2) - offsetBase_) + (double)((int64_t)(t4 - t3) - offsetBase_)) / 2;
+
+	// Queueing adds to the delay in either direction, which makes an excess delay an error of up to half of it
+	minDelay_ = fmin(delay, minDelay_ + CLOCKSYNC_MIN_DELAY_AGING);
+	double asymmetry = (delay - minDelay_) / 2;
+	double R = CLOCKSYNC_TIMESTAMP_NOISE * CLOCKSYNC_TIMESTAMP_NOISE + asymmetry * asymmetry;
+	delay_ = delay;
+
+	if (!initialized_) {
+		offset_ = measurement;
+		drift_ = 0;
+		P_[0] = R + delay * delay / 4; // the first exchange can be asymmetric by up to half of its delay
+		P_[1] = 0;
+		P_[2] = CLOCKSYNC_INITIAL_DRIFT * CLOCKSYNC_INITIAL_DRIFT;
+		time_ = midpoint;
+		initialized_ = true;
+		return true;
+	}
+
+	// Predict the offset at the midpoint of the exchange from the drift
+	double dt = (double)(midpoint - time_) * 1e-6; // seconds, which also converts the drift from ppm to microseconds per second
+	double offset = offset_ + drift_ * dt;
+	double P00 = P_[0] + 2 * dt * P_[1] + dt * dt * P_[2] + CLOCKSYNC_PHASE_NOISE * dt;
+	double P01 = P_[1] + dt * P_[2];
+	double P11 = P_[2] + CLOCKSYNC_FREQUENCY_NOISE * dt;
+
+	double innovation = measurement - offset;
+	double S = P00 + R;
+	if (innovation * innovation > CLOCKSYNC_GATE * CLOCKSYNC_GATE * S) {
+		if (++rejected_ < CLOCKSYNC_MAX_REJECTIONS) return false;
+		// The clocks have been stepped, so start over from this exchange
+		Reset();
+		return Update(t1, t2, t3, t4);
+	}
+	rejected_ = 0;
+
+	double K0 = P00 / S;
+	double K1 = P01 / S;
+	offset_ = offset + K0 * innovation;
+	drift_ = drift_ + K1 * innovation;
+	P_[0] = (1 - K0) * P00;
+	P_[1] = (1 - K0) * P01;
+	P_[2] = P11 - K1 * P01;
+	time_ = midpoint;
+
+	// Move the whole microseconds into the integer base
+	int64_t whole = (int64_t)offset_;
+	offsetBase_ += whole;
+	offset_ -= whole;
+
+	return true;
+}
+
+/**
+ * @brief 	Convert a local time to the reference clock
+ * @param	local      Input: local time in microseconds
+ * @retval	reference time in microseconds, or the local time if no exchange has been received
+ */
+uint64_t ClockSync::ToReference(uint64_t local) const
+{
+	return local + GetOffset(local);
+}
+
+/**
+ * @brief 	Get the estimated offset of the reference clock at a local time
+ * @param	local      Input: local time in microseconds
+ * @retval	reference time minus local time in microseconds
+ */
+int64_t ClockSync::GetOffset(uint64_t local) const
+{
+	if (!initialized_) return 0;
+	double dt = (double)(int64_t)(local - time_) * 1e-6;
+	return offsetBase_ + (int64_t)floor(offset_ + drift_ * dt + 0.5);
+}
+
+bool ClockSync::IsSynchronized(void) const
+{
+	return initialized_ && P_[0] < CLOCKSYNC_SYNCHRONIZED_STD * CLOCKSYNC_SYNCHRONIZED_STD;
+}
+
+float ClockSync::GetOffsetStd(void) const
+{
+	return sqrt(P_[0]);
+}
+
+/* Uniformly distributed number in (0,1) from a linear congruential generator */
+static double UnitTestRandom(uint32_t& seed)
+{
+	seed = seed * 1664525 + 1013904223;
+	return ((seed >> 8) + 0.5) / 16777216.0;
+}
+
+/* One way delay of a simulated USB link in microseconds: a fixed latency, exponentially distributed jitter and occasional queueing */
+static double UnitTestDelay(uint32_t& seed)
+{
+	double delay = 125 - 60 * log(UnitTestRandom(seed));
+	if (UnitTestRandom(seed) < 0.1)
+		delay += 3000 * UnitTestRandom(seed);
+	return delay;
+}
+
+/**
+ * @brief 	Synchronize a simulated clock, which runs 45 ppm slow with a drift changing by 2 ppm over the simulation,
+ *          to a reference clock which is stepped by half a second half way, with exchanges every 250 ms over a jittery link
+ * @retval	true if the error of the synchronized time stays below 50 microseconds 30 seconds after the start and after the step
+ */
+bool ClockSync::UnitTest(void)
+{
+	const double period = 250e3; // microseconds between exchanges
+	const int exchanges = 2400; // 10 minutes
+	const double reference0 = 1.5e15; // reference time at boot of the local clock
+	const double tolerance = 50; // microseconds
+	const int settling = 120; // exchanges after the start and after the step which are not checked
+
+	ClockSync sync;
+	uint32_t seed = 12345;
+	double step = 0;
+	double maxError = 0;
+
+	for (int i = 0; i < exchanges; i++) {
+		if (i == exchanges / 2) step = 0.5e6; // the reference clock is stepped, eg. by NTP on the PC
+
+		// Local clock as a function of the true time since boot, with a slowly changing rate
+		#define LOCAL_TIME(t)	((t) * (1 - 45e-6) - (t) * (t) * 2e-6 / (2 * exchanges * period))
+		double t = 1e6 + i * period + 1000 * UnitTestRandom(seed); // true time since boot
+		double t2 = t + UnitTestDelay(seed);
+		double t3 = t2 + 20 + 100 * UnitTestRandom(seed); // processing time
+		double t4 = t3 + UnitTestDelay(seed);
+
+		sync.Update((uint64_t)(reference0 + step + t), (uint64_t)LOCAL_TIME(t2), (uint64_t)LOCAL_TIME(t3), (uint64_t)(reference0 + step + t4));
+
+		// Compare the synchronized time with the reference in between the exchanges
+		double check = t4 + period / 2;
+		double error = fabs((double)(int64_t)(sync.ToReference((uint64_t)LOCAL_TIME(check)) - (uint64_t)(reference0 + step + check)));
+		#undef LOCAL_TIME
+
+		if ((i > settling && i < exchanges / 2) || i > exchanges / 2 + settling) {
+			if (!sync.IsSynchronized()) return false;
+			if (error > maxError) maxError = error;
+		}
+	}
+
+	return maxError < tolerance;
+}
@@ -0,0 +1,78 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+ 
+ 
+
+#ifndef MODULES_TIMESYNC_CLOCKSYNC_H
+#define MODULES_TIMESYNC_CLOCKSYNC_H
+
+#include <stdint.h>
+
+#define CLOCKSYNC_TIMESTAMP_NOISE		20.0     // standard deviation of the offset measured by an exchange without queueing delays, in microseconds
+#define CLOCKSYNC_PHASE_NOISE			4.0      // white phase noise of the clocks in microseconds^2 per second
+#define CLOCKSYNC_FREQUENCY_NOISE		1e-4     // random walk of the relative clock rate in ppm^2 per second (crystal temperature drift)
+#define CLOCKSYNC_INITIAL_DRIFT			100.0    // standard deviation of the relative clock rate before the first estimate, in ppm
+#define CLOCKSYNC_MIN_DELAY_AGING		1.0      // microseconds per exchange the minimum round trip delay increases by, to follow a slower link
+#define CLOCKSYNC_GATE					5.0      // exchanges with an innovation beyond this many standard deviations are rejected as outliers
+#define CLOCKSYNC_MAX_REJECTIONS		10       // consecutive rejected exchanges after which the estimate is restarted, eg. when the PC clock has been stepped
+#define CLOCKSYNC_SYNCHRONIZED_STD		500.0    // standard deviation of the offset in microseconds below which the clocks are considered synchronized
+
+/* Estimator of the offset and relative rate (drift) between a local clock and a reference clock,
+ * from exchanges with four time stamps as in NTP and PTP. The reference sends a request at t1 (reference clock),
+ * which is received at t2 and answered at t3 (local clock), and the reply is received at t4 (reference clock).
+ * Each exchange measures the offset at the midpoint (t2+t3)/2 as ((t1-t2) + (t4-t3))/2 with an error of at most
+ * half the round trip delay (t4-t1)-(t3-t2), which is exact if the delays of the request and the reply are equal.
+ *
+ * A Kalman filter with the offset and the drift as states fuses the exchanges. The measurement variance grows with the
+ * round trip delay in excess of the smallest recently seen delay, since the excess comes from queueing on either side
+ * and makes the delays asymmetric. Exchanges with a small delay therefore dominate the estimate.
+ * A constant asymmetry of the link (eg. a longer path for the reply) is not observable and remains as a bias.
+ *
+ * The class has no dependencies on the hardware, such that it can also be used on a PC. */
+class ClockSync
+{
+	public:
+		ClockSync();
+
+		void Reset(void);
+		bool Update(uint64_t t1, uint64_t t2, uint64_t t3, uint64_t t4);
+
+		uint64_t ToReference(uint64_t local) const;
+		bool IsSynchronized(void) const;
+		int64_t GetOffset(uint64_t local) const;
+		float GetDrift(void) const { return drift_; }
+		float GetOffsetStd(void) const;
+		float GetDelay(void) const { return delay_; }
+		uint32_t GetRejected(void) const { return rejected_; }
+
+		bool UnitTest(void);
+
+	private:
+		bool initialized_;
+		uint64_t time_; // local time of the estimate
+		int64_t offsetBase_; // integer part of the offset, which keeps the filtered offset small enough for a double with sub-microsecond resolution
+		double offset_; // reference time minus local time in microseconds, relative to offsetBase_
+		double drift_; // rate of the reference clock relative to the local clock minus one, in ppm
+		double P_[3]; // covariance of the offset and the drift, packed symmetric (P00, P01, P11)
+		double minDelay_;
+		float delay_; // round trip delay of the latest exchange
+		uint32_t rejected_; // consecutive rejected exchanges
+};
+
+#endif
@@ -0,0 +1,142 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+ 
+ 
+
+#include "TimeSync.h"
+#include "Debug.h"
+#include <string.h> // for memcpy
+
+TimeSync::TimeSync(LSPC& com, Timer& microsTimer) : com_(com), microsTimer_(microsTimer), epoch_(0), sequence_(0), t1_(0), t2_(0), t3_(0), pending_(false)
+{
+	if (!clock_.UnitTest()) {
+		ERROR("Clock synchronization unit test failed");
+	}
+
+	com_.registerCallback<lspc::MessageTypesFromPC::TimeSync>(&TimeSync_Callback, (void *)this);
+}
+
+TimeSync::~TimeSync()
+{
+	com_.unregisterCallback(lspc::MessageTypesFromPC::TimeSync);
+}
+
+/**
+ * @brief 	Get the robot time, ie. the microseconds timer extended to 64 bits
+ * @retval	microseconds since boot
+ */
+uint64_t TimeSync::GetLocalTime(void)
+{
+	return microsTimer_.Get64();
+}
+
+/**
+ * @brief 	Get the synchronized time
+ * @retval	PC time in microseconds since the UNIX epoch, or the robot time if no exchange has been completed
+ */
+uint64_t TimeSync::GetTime(void)
+{
+	uint64_t local = GetLocalTime();
+
+	taskENTER_CRITICAL();
+	ClockSync clock = clock_;
+	taskEXIT_CRITICAL();
+
+	return clock.ToReference(local);
+}
+
+/**
+ * @brief 	Get the time stamp of a telemetry message
+ * @retval	seconds since the epoch given by the PC if the clocks are synchronized, otherwise seconds since boot
+ */
+float TimeSync::GetTelemetryTime(void)
+{
+	bool synchronized;
+	return GetTelemetryTime(synchronized);
+}
+
+/**
+ * @brief 	Get the time stamp of a telemetry message and its time base
+ * @param	synchronized  Output: true if the time stamp is in seconds since the epoch given by the PC, false if since boot
+ * @retval	time stamp in seconds
+ */
+float TimeSync::GetTelemetryTime(bool& synchronized)
+{
+	uint64_t local = GetLocalTime();
+
+	taskENTER_CRITICAL();
+	ClockSync clock = clock_;
+	uint64_t epoch = epoch_;
+	taskEXIT_CRITICAL();
+
+	synchronized = clock.IsSynchronized();
+	if (!synchronized)
+		return (float)((double)local * 1e-6);
+	return (float)((double)(int64_t)(clock.ToReference(local) - epoch) * 1e-6);
+}
+
+bool TimeSync::IsSynchronized(void)
+{
+	taskENTER_CRITICAL();
+	bool synchronized = clock_.IsSynchronized();
+	taskEXIT_CRITICAL();
+
+	return synchronized;
+}
+
+/* Complete the previous exchange with its reception time on the PC and answer the request */
+void TimeSync::TimeSync_Callback(void * param, const lspc::MessageTypesFromPC::TimeSync_t& msg)
+{
+	TimeSync * timeSync = (TimeSync *)param;
+	if (!timeSync) return;
+
+	uint64_t t2 = timeSync->GetLocalTime(); // as early as possible
+
+	// The estimate is only modified by this task, so it is updated on a copy which is published at once
+	ClockSync clock = timeSync->clock_;
+	if (timeSync->pending_ && msg.previous_t4 != 0 && msg.sequence == timeSync->sequence_ + 1)
+		clock.Update(timeSync->t1_, timeSync->t2_, timeSync->t3_, msg.previous_t4);
+
+	taskENTER_CRITICAL();
+	timeSync->clock_ = clock;
+	timeSync->epoch_ = msg.epoch;
+	taskEXIT_CRITICAL();
+
+	timeSync->sequence_ = msg.sequence;
+	timeSync->pending_ = false;
+
+	// The reply is filled in place in the transmit queue, such that t3 is stamped right before it is queued
+	LSPC::Message<lspc::MessageTypesToPC::TimeSync> reply(timeSync->com_);
+	if (!reply.Reserved()) return;
+	reply->t1 = msg.t1;
+	reply->t2 = t2;
+	reply->epoch = msg.epoch;
+	reply->drift = clock.GetDrift();
+	reply->offset_std = clock.GetOffsetStd();
+	reply->delay = clock.GetDelay();
+	reply->sequence = msg.sequence;
+	reply->synchronized = clock.IsSynchronized() ? 1 : 0;
+	reply->t3 = timeSync->GetLocalTime(); // as late as possible
+	reply->offset = clock.GetOffset(reply->t3);
+
+	timeSync->t1_ = reply->t1;
+	timeSync->t2_ = reply->t2;
+	timeSync->t3_ = reply->t3;
+	timeSync->pending_ = reply.Transmit();
+}
@@ -0,0 +1,71 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+ 
+ 
+
+#ifndef MODULES_TIMESYNC_H
+#define MODULES_TIMESYNC_H
+
+#include "cmsis_os.h"
+#include "LSPC.hpp"
+#include "Timer.h"
+#include "ClockSync.h"
+
+/* Synchronization of the robot clock to the PC clock over LSPC.
+ *
+ * The PC periodically sends TimeSync requests, each answered right away with the reception and transmit times on the robot.
+ * Together with the transmit time of the request and the reception time of the reply on the PC, which arrives with the next
+ * request, this gives the four time stamps of an exchange, from which ClockSync estimates the offset and drift of the PC clock.
+ * The robot time is the microseconds timer, extended to 64 bits by the timer interrupt such that it does not wrap around (see Timer::Get64).
+ *
+ * Telemetry is time stamped with GetTelemetryTime, which is the PC time in seconds since the epoch given by the PC
+ * once the clocks are synchronized, and the seconds since boot before that. The time base of each time stamp is sent with
+ * compact telemetry frames (COMPACT_SYNCHRONIZED), and the synchronized flag of the TimeSync reply gives the current one.
+ * The step of a float is at most 0.49 ms for the first 2.3 hours (2^13 seconds) after the epoch, and 0.98 ms up to 4.6 hours (2^14 seconds). */
+class TimeSync
+{
+	public:
+		TimeSync(LSPC& com, Timer& microsTimer);
+		~TimeSync();
+
+		uint64_t GetLocalTime(void);
+		uint64_t GetTime(void);
+		float GetTelemetryTime(void);
+		float GetTelemetryTime(bool& synchronized);
+		bool IsSynchronized(void);
+
+	private:
+		static void TimeSync_Callback(void * param, const lspc::MessageTypesFromPC::TimeSync_t& msg);
+
+	private:
+		LSPC& com_;
+		Timer& microsTimer_;
+
+		ClockSync clock_;
+		uint64_t epoch_; // PC time of zero telemetry time
+
+		/* Time stamps of the latest exchange, which is completed with t4 in the next request */
+		uint32_t sequence_;
+		uint64_t t1_;
+		uint64_t t2_;
+		uint64_t t3_;
+		bool pending_;
+};
+
+#endif
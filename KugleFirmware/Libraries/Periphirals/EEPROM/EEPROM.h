@@ -48,55 +48,16 @@
 #define ADDR_FLASH_SECTOR_6_BANK2     ((uint32_t)0x081C0000) /* Base @ of Sector 6, 128 Kbytes */
 #define ADDR_FLASH_SECTOR_7_BANK2     ((uint32_t)0x081E0000) /* Base @ of Sector 7, 128 Kbytes */
 
-/* Exported constants --------------------------------------------------------*/
-/* EEPROM emulation firmware error codes */
-#define EE_OK      (uint32_t)HAL_OK
-#define EE_ERROR   (uint32_t)HAL_ERROR
-#define EE_BUSY    (uint32_t)HAL_BUSY
-#define EE_TIMEOUT (uint32_t)HAL_TIMEOUT
-
-/* Define the size of the sectors to be used */
-
-  #define PAGE_SIZE               (uint32_t)0x20000  /* Page size = 128KByte */
-
-
-/* Device voltage range supposed to be [2.7V to 3.6V], the operation will
-   be done by word  */
-#define VOLTAGE_RANGE           (uint8_t)VOLTAGE_RANGE_3
-
-/* EEPROM emulation start address in Flash */
-
-  #define EEPROM_START_ADDRESS  ADDR_FLASH_SECTOR_6_BANK2 /* sector6 of bank 2 */
-
-
-/* Pages 0 and 1 base and end addresses */
-#define PAGE0_BASE_ADDRESS    ((uint32_t)(EEPROM_START_ADDRESS + 0x0000))
-#define PAGE0_END_ADDRESS     ((uint32_t)(EEPROM_START_ADDRESS + (PAGE_SIZE - 1)))
-
-  #define PAGE0_ID               FLASH_SECTOR_6
-
-
-#define PAGE1_BASE_ADDRESS    ((uint32_t)(EEPROM_START_ADDRESS + PAGE_SIZE))
-#define PAGE1_END_ADDRESS     ((uint32_t)(EEPROM_START_ADDRESS + (2 * PAGE_SIZE - 1)))
-
-  #define PAGE1_ID               FLASH_SECTOR_7
-
-
-/* Used Flash pages for EEPROM emulation */
-#define PAGE0                 ((uint16_t)0x0000)
-#define PAGE1                 ((uint16_t)0x0001) /* Page nb between PAGE0_BASE_ADDRESS & PAGE1_BASE_ADDRESS*/
-
-/* Page status definitions */
-#define ERASED                ((uint16_t)0xFFFF)     /* Page is empty */
-#define RECEIVE_DATA          ((uint16_t)0xEEEE)     /* Page is marked to receive data */
-#define VALID_PAGE            ((uint16_t)0x0000)     /* Page containing valid data */
-
-/* Valid pages in read and write defines */
-#define READ_FROM_VALID_PAGE  ((uint8_t)0x00)
-#define WRITE_IN_VALID_PAGE   ((uint8_t)0x01)
+/* Flash sectors used for parameter storage (see FlashRecordStore) */
+#define EEPROM_START_ADDRESS	ADDR_FLASH_SECTOR_6_BANK2 /* sector6 of bank 2 */
+#define EEPROM_FLASH_BANK		FLASH_BANK_2
+#define EEPROM_FIRST_SECTOR		FLASH_SECTOR_6
+#define EEPROM_SECTORS			2 /* sector 6 and 7 */
 
 #ifdef __cplusplus
 
+#include "InternalFlash.h"
+#include "FlashRecordStore.h"
 #include <vector>
 
 class EEPROM
@@ -117,9 +78,7 @@ class EEPROM
 			EEPROM_FLASH_COMPLETE = 0x0000, /* HAL_OK */
 			EEPROM_ERROR    = 0x01,
 			EEPROM_BUSY     = 0x02,
-			EEPROM_TIMEOUT  = 0x03,
-			EEPROM_PAGE_FULL = 0x0080, 	 /* Page full define */
-			EEPROM_NO_VALID_PAGE = 0x00AB   /* No valid page define */
+			EEPROM_TIMEOUT  = 0x03
 		} errorCode_t;
 
 	public:
@@ -137,31 +96,30 @@ class EEPROM
 		errorCode_t ReadData(uint16_t address, uint8_t * data, uint16_t dataLength);
 
 		bool EnableSection(uint16_t address, uint16_t sectionSize);
+		uint16_t GetSectionSize(uint16_t address);
+		bool CopyTo(FlashMemory& target);
 		bool WasFormattedAtBoot(void);
 
 	private:
-		uint16_t Init(void);
+		typedef struct section_t {
+			uint16_t address;
+			uint16_t size;
+		} section_t;
+
 		bool CheckForAssignedStructureChange(void);
 		void InitializeInternalState(void);
-		bool IsSectionInUse(uint16_t address);
-		HAL_StatusTypeDef Format(void);
-
-		uint16_t FindValidPage(uint8_t Operation);
-		errorCode_t VerifyPageFullWriteVariable(uint16_t VirtAddress, uint16_t Data);
-		errorCode_t PageTransfer(uint16_t VirtAddress, uint16_t Data);
-		uint16_t VerifyPageFullyErased(uint32_t Address);
-
-		errorCode_t ReadVariable(uint16_t VirtAddress, uint16_t* Data);
-		errorCode_t WriteVariable(uint16_t VirtAddress, uint16_t Data);
+		const section_t * FindSection(uint16_t address, uint16_t length);
+		errorCode_t Write(uint16_t address, const uint8_t * data, uint16_t length);
+		errorCode_t Read(uint16_t address, uint8_t * data, uint16_t length);
 
 		uint32_t CalculateSectionsTableChecksum(void);
 
 	private:
 		SemaphoreHandle_t resourceSemaphore_;
-		std::vector<uint16_t> * virtAddrTable_;
-
-		uint16_t DataVar = 0;
-		uint32_t Address = 0;
+		InternalFlash flash_;
+		FlashRecordStore store_;
+		std::vector<section_t> sectionsTable_;
+		uint8_t content_[FLASHRECORDSTORE_PATCH_BUFFER_SIZE]; // section content merged with a partial write
 
 		bool WasFormattedAtBoot_;
 
@@ -0,0 +1,42 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+ 
+#ifndef PERIPHIRALS_FLASHMEMORY_H
+#define PERIPHIRALS_FLASHMEMORY_H
+
+#include <stdint.h>
+
+#define FLASH_WORD_SIZE		32 // smallest programmable unit of the STM32H7 flash in bytes (256-bit flash word)
+
+/* Abstract sector based flash memory with memory mapped read access.
+ * A flash word can only be programmed once after the sector containing it has been erased. */
+class FlashMemory
+{
+	public:
+		virtual ~FlashMemory() {};
+
+		virtual uint32_t GetSectorCount(void) = 0;
+		virtual uint32_t GetSectorSize(void) = 0;
+		virtual const uint8_t * GetSectorAddress(uint32_t sector) = 0;
+
+		virtual bool ProgramWord(uint32_t sector, uint32_t offset, const uint64_t data[FLASH_WORD_SIZE/8]) = 0;
+		virtual bool EraseSector(uint32_t sector) = 0;
+};
+
+#endif
@@ -0,0 +1,615 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+ 
+#include "FlashRecordStore.h"
+#include "CRC32.h"
+#include <stddef.h> // for offsetof
+#include <string.h> // for memcpy
+
+FlashRecordStore::FlashRecordStore(FlashMemory& flash) : flash_(flash), valid_(false), activeSector_(0), sequence_(0), eraseCount_(0), writeOffset_(0), indexSize_(0)
+{
+	sectorSize_ = flash_.GetSectorSize();
+	sectorCount_ = flash_.GetSectorCount();
+}
+
+FlashRecordStore::~FlashRecordStore()
+{
+}
+
+/**
+ * @brief 	Locate the active sector, index its records and find the end of its log. The flash is formatted if no valid sector exists.
+ * @retval	true if the store is ready for use
+ */
+bool FlashRecordStore::Init(void)
+{
+	valid_ = false;
+	for (uint32_t sector = 0; sector < sectorCount_; sector++) {
+		const sector_header_t * header = GetValidSectorHeader(sector);
+		if (header && (!valid_ || header->sequence > sequence_)) {
+			activeSector_ = sector;
+			sequence_ = header->sequence;
+			eraseCount_ = header->eraseCount;
+			valid_ = true;
+		}
+	}
+
+	if (!valid_)
+		return Format();
+
+	writeOffset_ = ScanForEnd(activeSector_);
+	BuildIndex();
+	return true;
+}
+
+/**
+ * @brief 	Erase all sectors and take the first sector into use, discarding all stored records
+ * @retval	true if successful
+ */
+bool FlashRecordStore::Format(void)
+{
+	uint32_t eraseCount = 0;
+
+	valid_ = false;
+	for (uint32_t sector = 0; sector < sectorCount_; sector++) {
+		uint32_t sectorEraseCount;
+		if (!PrepareSector(sector, sectorEraseCount)) return false;
+		if (sector == 0) eraseCount = sectorEraseCount;
+	}
+
+	if (!ProgramSectorHeader(0, 1, eraseCount)) return false;
+
+	activeSector_ = 0;
+	sequence_ = 1;
+	eraseCount_ = eraseCount;
+	writeOffset_ = FLASH_WORD_SIZE;
+	indexSize_ = 0;
+	valid_ = true;
+
+	return true;
+}
+
+/**
+ * @brief 	Store a new value for a key as a single complete record. The active sector is compacted first if the record does not fit.
+ * @param	key        Input: record key
+ * @param	data       Input: payload
+ * @param	length     Input: payload length in bytes
+ * @retval	true if the record was written successfully
+ */
+bool FlashRecordStore::Write(uint16_t key, const uint8_t * data, uint16_t length)
+{
+	return AppendRecord(key, FLASHRECORDSTORE_RECORD_FULL, data, length);
+}
+
+/**
+ * @brief 	Store a new value for a key by only writing the byte ranges which differ from the stored value.
+ *          A complete record is written instead if the key does not exist, if the length has changed (layout change),
+ *          if the key already has FLASHRECORDSTORE_MAX_PATCHES patches or if the patch would not be smaller than the value.
+ *          Nothing is written if the value is unchanged.
+ * @param	key        Input: record key
+ * @param	data       Input: new value
+ * @param	length     Input: value length in bytes
+ * @retval	true if the value is stored
+ */
+bool FlashRecordStore::Update(uint16_t key, const uint8_t * data, uint16_t length)
+{
+	if (!valid_) return false;
+
+	int32_t i = FindIndex(key);
+	if (i < 0 || GetRecord(index_[i].offset)->length != length || index_[i].patches >= FLASHRECORDSTORE_MAX_PATCHES || length > sizeof(patch_))
+		return Write(key, data, length);
+
+	uint8_t * patch = patch_; // a patch which is not smaller than the value is replaced by a complete record, hence it always fits
+
+	/* Collect the changed ranges, merging ranges separated by less than a range header */
+	uint8_t current[2*FLASH_WORD_SIZE];
+	uint32_t patchLength = 0;
+	uint32_t rangeStart = 0, rangeEnd = 0; // rangeEnd = 0 when no range is open
+	bool tooLarge = false;
+	for (uint32_t pos = 0; pos <= length && !tooLarge; pos += sizeof(current)) {
+		uint32_t n = (pos < length) ? length - pos : 0;
+		if (n > sizeof(current)) n = sizeof(current);
+		Read(key, pos, current, n);
+
+		for (uint32_t j = 0; j <= n; j++) {
+			bool last = (pos + j == length);
+			if (!last && (j == n || data[pos+j] == current[j])) continue;
+
+			uint32_t idx = pos + j;
+			if (rangeEnd > 0 && !last && idx <= rangeEnd + 2*sizeof(uint16_t)) {
+				rangeEnd = idx + 1; // extend the open range
+				continue;
+			}
+
+			if (rangeEnd > 0) { // close the open range
+				uint16_t rangeOffset = rangeStart;
+				uint16_t rangeLength = rangeEnd - rangeStart;
+				if (patchLength + 2*sizeof(uint16_t) + rangeLength >= length) {
+					tooLarge = true;
+					break;
+				}
+				memcpy(&patch[patchLength], &rangeOffset, sizeof(uint16_t));
+				memcpy(&patch[patchLength + sizeof(uint16_t)], &rangeLength, sizeof(uint16_t));
+				memcpy(&patch[patchLength + 2*sizeof(uint16_t)], &data[rangeStart], rangeLength);
+				patchLength += 2*sizeof(uint16_t) + rangeLength;
+				rangeEnd = 0;
+			}
+
+			if (!last) {
+				rangeStart = idx;
+				rangeEnd = idx + 1;
+			}
+		}
+	}
+
+	bool success;
+	if (tooLarge)
+		success = Write(key, data, length);
+	else if (patchLength == 0)
+		success = true; // unchanged
+	else
+		success = AppendRecord(key, FLASHRECORDSTORE_RECORD_PATCH, patch, patchLength);
+
+	return success;
+}
+
+/**
+ * @brief 	Read (part of) the latest value of a key
+ * @param	key        Input: record key
+ * @param	offset     Input: byte offset into the payload to start reading from
+ * @param	data       Output: read payload bytes
+ * @param	length     Input: number of bytes to read
+ * @retval	number of bytes read, which is less than length if the stored payload is shorter, and 0 if the key does not exist
+ */
+uint16_t FlashRecordStore::Read(uint16_t key, uint16_t offset, uint8_t * data, uint16_t length)
+{
+	if (!valid_) return 0;
+
+	int32_t i = FindIndex(key);
+	if (i < 0) return 0;
+
+	const record_header_t * record = GetRecord(index_[i].offset);
+	if (offset >= record->length) return 0;
+
+	if (length > record->length - offset)
+		length = record->length - offset;
+	memcpy(data, (const uint8_t *)(record + 1) + offset, length);
+
+	if (index_[i].patches > 0) {
+		uint32_t patchOffset = index_[i].firstPatch;
+		while (patchOffset < writeOffset_) {
+			const record_header_t * patch = GetRecord(patchOffset);
+			if (patch->magic != FLASHRECORDSTORE_RECORD_MAGIC) break;
+			if (patch->key == key && patch->type == FLASHRECORDSTORE_RECORD_PATCH && IsRecordValid(patch))
+				ApplyPatch(patch, offset, data, length);
+			patchOffset += RecordSize(patch->length);
+		}
+	}
+
+	return length;
+}
+
+/**
+ * @brief 	Copy the latest value of every key into the next sector and make that sector the active one.
+ *          Values with patches are merged into a single complete record.
+ *          The new sector header is programmed last, so a power failure during compaction leaves the current sector active.
+ * @retval	true if successful
+ */
+bool FlashRecordStore::Compact(void)
+{
+	if (!valid_) return false;
+
+	uint32_t target = (activeSector_ + 1) % sectorCount_;
+	if (target == activeSector_) return false; // at least two sectors are needed
+
+	uint32_t targetEraseCount;
+	if (!PrepareSector(target, targetEraseCount)) return false;
+
+	uint32_t targetOffset[FLASHRECORDSTORE_MAX_KEYS];
+	uint32_t offset = FLASH_WORD_SIZE;
+	for (uint32_t i = 0; i < indexSize_; i++) {
+		const record_header_t * record = GetRecord(index_[i].offset);
+		if (offset + RecordSize(record->length) > sectorSize_) return false;
+
+		bool success;
+		if (index_[i].patches == 0)
+			success = ProgramRecord(target, offset, *record, (const uint8_t *)(record + 1));
+		else
+			success = ProgramMergedRecord(target, offset, i);
+		if (!success) return false;
+
+		targetOffset[i] = offset;
+		offset += RecordSize(record->length);
+	}
+
+	if (!ProgramSectorHeader(target, sequence_ + 1, targetEraseCount)) return false;
+
+	activeSector_ = target;
+	sequence_++;
+	eraseCount_ = targetEraseCount;
+	writeOffset_ = offset;
+	for (uint32_t i = 0; i < indexSize_; i++) {
+		index_[i].offset = targetOffset[i];
+		index_[i].firstPatch = 0;
+		index_[i].patches = 0;
+	}
+
+	return true;
+}
+
+uint32_t FlashRecordStore::GetFreeSpace(void)
+{
+	if (!valid_) return 0;
+	return sectorSize_ - writeOffset_;
+}
+
+/**
+ * @brief 	Get the number of times the active sector has been erased
+ */
+uint32_t FlashRecordStore::GetEraseCount(void)
+{
+	return eraseCount_;
+}
+
+const FlashRecordStore::sector_header_t * FlashRecordStore::GetValidSectorHeader(uint32_t sector)
+{
+	const sector_header_t * header = (const sector_header_t *)flash_.GetSectorAddress(sector);
+	if (header->magic != FLASHRECORDSTORE_SECTOR_MAGIC) return 0;
+	if (header->crc != CRC32_Calculate((const uint8_t *)header, offsetof(sector_header_t, crc))) return 0;
+	return header;
+}
+
+const FlashRecordStore::record_header_t * FlashRecordStore::GetRecord(uint32_t offset)
+{
+	return (const record_header_t *)(flash_.GetSectorAddress(activeSector_) + offset);
+}
+
+/**
+ * @brief 	Append a record to the active sector, compacting the sector first if the record does not fit
+ * @param	key        Input: record key
+ * @param	type       Input: FLASHRECORDSTORE_RECORD_FULL or FLASHRECORDSTORE_RECORD_PATCH
+ * @param	data       Input: payload
+ * @param	length     Input: payload length in bytes
+ * @retval	true if the record was written successfully
+ */
+bool FlashRecordStore::AppendRecord(uint16_t key, uint16_t type, const uint8_t * data, uint16_t length)
+{
+	if (!valid_) return false;
+
+	uint32_t size = RecordSize(length);
+	if (size > sectorSize_ - FLASH_WORD_SIZE) return false; // record can never fit
+
+	if (FindIndex(key) < 0 && (type != FLASHRECORDSTORE_RECORD_FULL || indexSize_ == FLASHRECORDSTORE_MAX_KEYS)) return false; // patch without value or no room for a new key in the index
+
+	if (writeOffset_ + size > sectorSize_) {
+		if (!Compact()) return false;
+		if (writeOffset_ + size > sectorSize_) return false; // not enough space even after compaction
+	}
+
+	record_header_t header;
+	CreateHeader(header, key, type, data, length);
+
+	if (!ProgramRecord(activeSector_, writeOffset_, header, data)) {
+		writeOffset_ = sectorSize_; // the content after the last record is unknown, hence compact on next write
+		return false;
+	}
+
+	UpdateIndex(key, writeOffset_, type);
+	writeOffset_ += size;
+	return true;
+}
+
+void FlashRecordStore::CreateHeader(record_header_t& header, uint16_t key, uint16_t type, const uint8_t * data, uint16_t length)
+{
+	header.magic = FLASHRECORDSTORE_RECORD_MAGIC;
+	header.key = key;
+	header.length = length;
+	header.type = type;
+	header.reserved = 0xFFFF;
+	header.crc = CRC32_Update(CRC32_Calculate((const uint8_t *)&header, offsetof(record_header_t, crc)), data, length);
+}
+
+/**
+ * @brief 	Overwrite the part of a value which is changed by a patch record
+ * @param	patch      Input: patch record
+ * @param	offset     Input: offset of data within the value
+ * @param	data       Input/Output: part of the value to patch
+ * @param	length     Input: number of bytes in data
+ */
+void FlashRecordStore::ApplyPatch(const record_header_t * patch, uint16_t offset, uint8_t * data, uint16_t length)
+{
+	const uint8_t * range = (const uint8_t *)(patch + 1);
+	const uint8_t * end = range + patch->length;
+
+	while (range + 2*sizeof(uint16_t) <= end) {
+		uint16_t rangeOffset, rangeLength;
+		memcpy(&rangeOffset, range, sizeof(uint16_t));
+		memcpy(&rangeLength, range + sizeof(uint16_t), sizeof(uint16_t));
+		range += 2*sizeof(uint16_t);
+		if (range + rangeLength > end) break;
+
+		uint32_t start = (rangeOffset > offset) ? rangeOffset : offset;
+		uint32_t stop = ((uint32_t)rangeOffset + rangeLength < (uint32_t)offset + length) ? (uint32_t)rangeOffset + rangeLength : (uint32_t)offset + length;
+		if (start < stop)
+			memcpy(&data[start - offset], &range[start - rangeOffset], stop - start);
+
+		range += rangeLength;
+	}
+}
+
+/**
+ * @brief 	Look up a key in the RAM index
+ * @retval	index entry or -1 if the key has no valid value
+ */
+int32_t FlashRecordStore::FindIndex(uint16_t key)
+{
+	for (uint32_t i = 0; i < indexSize_; i++) {
+		if (index_[i].key == key)
+			return i;
+	}
+	return -1;
+}
+
+/**
+ * @brief 	Register a new record of a key in the RAM index
+ * @retval	false if the key is new and the index is full, or if a patch has no complete value to apply to
+ */
+bool FlashRecordStore::UpdateIndex(uint16_t key, uint32_t offset, uint16_t type)
+{
+	int32_t i = FindIndex(key);
+
+	if (type == FLASHRECORDSTORE_RECORD_PATCH) {
+		if (i < 0) return false;
+		if (index_[i].patches == 0)
+			index_[i].firstPatch = offset;
+		index_[i].patches++;
+		return true;
+	}
+
+	if (i < 0) {
+		if (indexSize_ == FLASHRECORDSTORE_MAX_KEYS) return false;
+		i = indexSize_++;
+		index_[i].key = key;
+	}
+	index_[i].offset = offset;
+	index_[i].firstPatch = 0;
+	index_[i].patches = 0;
+	return true;
+}
+
+/**
+ * @brief 	Scan the log of the active sector once and index the latest record with a valid CRC of every key.
+ *          Only the latest complete record of each key is CRC checked, the log is only scanned again for a key if that record is torn.
+ */
+void FlashRecordStore::BuildIndex(void)
+{
+	indexSize_ = 0;
+
+	uint32_t offset = FLASH_WORD_SIZE;
+	while (offset < writeOffset_) {
+		const record_header_t * record = GetRecord(offset);
+		if (record->magic != FLASHRECORDSTORE_RECORD_MAGIC) break;
+		UpdateIndex(record->key, offset, record->type);
+		offset += RecordSize(record->length);
+	}
+
+	uint32_t i = 0;
+	while (i < indexSize_) {
+		if (IsRecordValid(GetRecord(index_[i].offset))) {
+			i++;
+			continue;
+		}
+
+		/* Fall back to the latest valid complete record before the torn one */
+		uint32_t end = index_[i].offset;
+		bool found = false;
+		offset = FLASH_WORD_SIZE;
+		while (offset < end) {
+			const record_header_t * record = GetRecord(offset);
+			if (record->magic != FLASHRECORDSTORE_RECORD_MAGIC) break; // never follow the length of a header which is not a record header
+			if (record->key == index_[i].key && record->type == FLASHRECORDSTORE_RECORD_FULL && IsRecordValid(record)) {
+				index_[i].offset = offset;
+				found = true;
+			}
+			offset += RecordSize(record->length);
+		}
+
+		if (found) {
+			IndexPatches(i);
+			i++;
+		} else { // no valid record of this key, hence remove it from the index
+			index_[i] = index_[indexSize_ - 1];
+			indexSize_--;
+		}
+	}
+}
+
+/**
+ * @brief 	Find the patch records following the complete record of an index entry
+ */
+void FlashRecordStore::IndexPatches(uint32_t i)
+{
+	const record_header_t * record = GetRecord(index_[i].offset);
+	uint32_t offset = index_[i].offset + RecordSize(record->length);
+
+	index_[i].firstPatch = 0;
+	index_[i].patches = 0;
+	while (offset < writeOffset_) {
+		record = GetRecord(offset);
+		if (record->magic != FLASHRECORDSTORE_RECORD_MAGIC) break;
+		if (record->key == index_[i].key && record->type == FLASHRECORDSTORE_RECORD_PATCH) {
+			if (index_[i].patches == 0)
+				index_[i].firstPatch = offset;
+			index_[i].patches++;
+		}
+		offset += RecordSize(record->length);
+	}
+}
+
+uint32_t FlashRecordStore::RecordSize(uint16_t length)
+{
+	return ((sizeof(record_header_t) + length + FLASH_WORD_SIZE - 1) / FLASH_WORD_SIZE) * FLASH_WORD_SIZE;
+}
+
+bool FlashRecordStore::IsRecordValid(const record_header_t * record)
+{
+	if (record->magic != FLASHRECORDSTORE_RECORD_MAGIC) return false;
+	uint32_t crc = CRC32_Update(CRC32_Calculate((const uint8_t *)record, offsetof(record_header_t, crc)), (const uint8_t *)(record + 1), record->length);
+	return (crc == record->crc);
+}
+
+bool FlashRecordStore::IsErased(const uint8_t * address, uint32_t length)
+{
+	const uint32_t * words = (const uint32_t *)address;
+	for (uint32_t i = 0; i < length / 4; i++)
+		if (words[i] != 0xFFFFFFFF) return false;
+	return true;
+}
+
+/**
+ * @brief 	Find the end of the log in a sector by following the record lengths from the start of the sector
+ * @param	sector     Input: sector index
+ * @retval	offset of the first free flash word, or the sector size if the sector contains unrecognized content
+ */
+uint32_t FlashRecordStore::ScanForEnd(uint32_t sector)
+{
+	const uint8_t * base = flash_.GetSectorAddress(sector);
+
+	uint32_t offset = FLASH_WORD_SIZE;
+	while (offset + FLASH_WORD_SIZE <= sectorSize_) {
+		if (IsErased(&base[offset], FLASH_WORD_SIZE)) break; // end of log
+
+		const record_header_t * record = (const record_header_t *)&base[offset];
+		if (record->magic != FLASHRECORDSTORE_RECORD_MAGIC || offset + RecordSize(record->length) > sectorSize_)
+			return sectorSize_; // unrecognized content (e.g. a header torn by a power failure), hence mark the sector as full to compact it on next write
+
+		offset += RecordSize(record->length);
+	}
+
+	return offset;
+}
+
+/**
+ * @brief 	Ensure that a sector is erased while keeping track of its erase count
+ * @param	sector         Input: sector index
+ * @param	eraseCount     Output: number of times the sector has been erased
+ * @retval	true if the sector is erased
+ */
+bool FlashRecordStore::PrepareSector(uint32_t sector, uint32_t& eraseCount)
+{
+	const sector_header_t * header = GetValidSectorHeader(sector);
+	eraseCount = header ? header->eraseCount : eraseCount_; // use the count of the active sector as estimate if the sector has no valid header
+
+	if (IsErased(flash_.GetSectorAddress(sector), sectorSize_)) return true;
+
+	if (!flash_.EraseSector(sector)) return false;
+	eraseCount++;
+
+	return true;
+}
+
+bool FlashRecordStore::ProgramSectorHeader(uint32_t sector, uint32_t sequence, uint32_t eraseCount)
+{
+	uint64_t word[FLASH_WORD_SIZE/8];
+	memset(word, 0xFF, sizeof(word));
+
+	sector_header_t * header = (sector_header_t *)word;
+	header->magic = FLASHRECORDSTORE_SECTOR_MAGIC;
+	header->sequence = sequence;
+	header->eraseCount = eraseCount;
+	header->crc = CRC32_Calculate((const uint8_t *)header, offsetof(sector_header_t, crc));
+
+	return flash_.ProgramWord(sector, 0, word);
+}
+
+/**
+ * @brief 	Program a record header followed by its payload into consecutive flash words, padding the last word with 0xFF
+ * @param	sector     Input: sector index
+ * @param	offset     Input: offset of the first flash word of the record
+ * @param	header     Input: record header (including CRC)
+ * @param	payload    Input: record payload of header.length bytes
+ * @retval	true if all flash words were programmed successfully
+ */
+bool FlashRecordStore::ProgramRecord(uint32_t sector, uint32_t offset, const record_header_t& header, const uint8_t * payload)
+{
+	uint64_t word[FLASH_WORD_SIZE/8];
+	uint8_t * wordBytes = (uint8_t *)word;
+	const uint8_t * headerBytes = (const uint8_t *)&header;
+	uint32_t total = sizeof(record_header_t) + header.length;
+
+	for (uint32_t pos = 0; pos < total; pos += FLASH_WORD_SIZE) {
+		for (uint32_t i = 0; i < FLASH_WORD_SIZE; i++) {
+			uint32_t idx = pos + i;
+			if (idx < sizeof(record_header_t))
+				wordBytes[i] = headerBytes[idx];
+			else if (idx < total)
+				wordBytes[i] = payload[idx - sizeof(record_header_t)];
+			else
+				wordBytes[i] = 0xFF;
+		}
+		if (!flash_.ProgramWord(sector, offset + pos, word)) return false;
+	}
+
+	return true;
+}
+
+/**
+ * @brief 	Program the latest value of a key with patches as a single complete record. The value is read with the patches applied
+ *          a flash word at a time, so it is not copied into RAM (the patch buffer can be in use by the update which triggered the compaction).
+ * @param	sector     Input: sector index
+ * @param	offset     Input: offset of the first flash word of the record
+ * @param	i          Input: index entry of the key
+ * @retval	true if all flash words were programmed successfully
+ */
+bool FlashRecordStore::ProgramMergedRecord(uint32_t sector, uint32_t offset, uint32_t i)
+{
+	uint16_t key = index_[i].key;
+	uint16_t length = GetRecord(index_[i].offset)->length;
+	uint64_t word[FLASH_WORD_SIZE/8];
+	uint8_t * wordBytes = (uint8_t *)word;
+
+	record_header_t header;
+	header.magic = FLASHRECORDSTORE_RECORD_MAGIC;
+	header.key = key;
+	header.length = length;
+	header.type = FLASHRECORDSTORE_RECORD_FULL;
+	header.reserved = 0xFFFF;
+	header.crc = CRC32_Calculate((const uint8_t *)&header, offsetof(record_header_t, crc));
+	for (uint32_t pos = 0; pos < length; pos += FLASH_WORD_SIZE) {
+		uint16_t n = Read(key, pos, wordBytes, FLASH_WORD_SIZE);
+		header.crc = CRC32_Update(header.crc, wordBytes, n);
+	}
+
+	const uint8_t * headerBytes = (const uint8_t *)&header;
+	uint32_t total = sizeof(record_header_t) + length;
+	for (uint32_t pos = 0; pos < total; pos += FLASH_WORD_SIZE) {
+		memset(wordBytes, 0xFF, FLASH_WORD_SIZE);
+		uint32_t headerBytesInWord = 0;
+		if (pos < sizeof(record_header_t)) {
+			headerBytesInWord = sizeof(record_header_t) - pos;
+			if (headerBytesInWord > FLASH_WORD_SIZE) headerBytesInWord = FLASH_WORD_SIZE;
+			memcpy(wordBytes, &headerBytes[pos], headerBytesInWord);
+		}
+		uint32_t payloadPos = pos + headerBytesInWord - sizeof(record_header_t);
+		if (headerBytesInWord < FLASH_WORD_SIZE && payloadPos < length)
+			Read(key, payloadPos, &wordBytes[headerBytesInWord], FLASH_WORD_SIZE - headerBytesInWord);
+		if (!flash_.ProgramWord(sector, offset + pos, word)) return false;
+	}
+
+	return true;
+}
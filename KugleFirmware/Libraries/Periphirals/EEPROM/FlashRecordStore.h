@@ -0,0 +1,126 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+ 
+#ifndef PERIPHIRALS_FLASHRECORDSTORE_H
+#define PERIPHIRALS_FLASHRECORDSTORE_H
+
+#include "FlashMemory.h"
+
+#define FLASHRECORDSTORE_SECTOR_MAGIC	0x4B52534C // "LSRK"
+#define FLASHRECORDSTORE_RECORD_MAGIC	0x4B434552 // "RECK"
+#define FLASHRECORDSTORE_MAX_KEYS		16 // size of the RAM index of the latest record of each key
+#define FLASHRECORDSTORE_MAX_PATCHES	16 // number of patch records after which an update rewrites the complete value
+#define FLASHRECORDSTORE_PATCH_BUFFER_SIZE	2048 // values up to this length are updated with patch records, longer values are always written completely
+#define FLASHRECORDSTORE_RECORD_FULL	0xFFFF // record type of a complete value
+#define FLASHRECORDSTORE_RECORD_PATCH	0x0001 // record type of a list of changed byte ranges of the latest complete value
+
+/* Log-structured key/value store on top of a sector based flash memory.
+ *
+ * Every write appends a complete record (header + payload, padded to whole flash words) to the active sector.
+ * The latest record with a valid CRC for a given key holds the current value, so a record torn by a power failure
+ * is simply ignored and the previous value remains. When the active sector is full, the latest record of every key
+ * is copied into the next sector, whose header is programmed last to commit the transfer.
+ * The sectors are used in a round-robin fashion, which spreads the erase cycles evenly (wear-levelling).
+ * The location of the latest valid record of each key is indexed in RAM when the store is initialized,
+ * hence reading a value is a single copy from flash.
+ *
+ * Update() only stores the bytes that differ from the stored value, as a patch record following the complete record.
+ * All changed ranges of one update are kept in the same patch record, so an update is applied atomically.
+ * Patches are merged into a complete record when the sector is compacted or when a key has FLASHRECORDSTORE_MAX_PATCHES patches.
+ * The patch is collected in a buffer of the store, so no memory is allocated.
+ *
+ * Sector layout:   [sector header word][record][record]...[erased]
+ * Record layout:   [record header][payload][0xFF padding to FLASH_WORD_SIZE]
+ * Patch payload:   [uint16_t offset][uint16_t length][length bytes] repeated for each changed range
+ */
+class FlashRecordStore
+{
+	public:
+		FlashRecordStore(FlashMemory& flash);
+		~FlashRecordStore();
+
+		bool Init(void);
+		bool Format(void);
+
+		bool Write(uint16_t key, const uint8_t * data, uint16_t length);
+		bool Update(uint16_t key, const uint8_t * data, uint16_t length);
+		uint16_t Read(uint16_t key, uint16_t offset, uint8_t * data, uint16_t length);
+		bool Compact(void);
+
+		uint32_t GetFreeSpace(void);
+		uint32_t GetEraseCount(void);
+
+	private:
+		typedef struct sector_header_t {
+			uint32_t magic;
+			uint32_t sequence;   // incremented every time a new sector is taken into use, the valid sector with the highest sequence is the active one
+			uint32_t eraseCount; // number of times this sector has been erased by the store
+			uint32_t crc;        // CRC-32 of the fields above
+		} sector_header_t;
+
+		typedef struct record_header_t {
+			uint32_t magic;
+			uint16_t key;
+			uint16_t length;     // payload length in bytes
+			uint16_t type;       // FLASHRECORDSTORE_RECORD_FULL or FLASHRECORDSTORE_RECORD_PATCH
+			uint16_t reserved;
+			uint32_t crc;        // CRC-32 of the fields above followed by the payload
+		} record_header_t;
+
+		const sector_header_t * GetValidSectorHeader(uint32_t sector);
+		const record_header_t * GetRecord(uint32_t offset);
+		int32_t FindIndex(uint16_t key);
+		bool UpdateIndex(uint16_t key, uint32_t offset, uint16_t type);
+		void BuildIndex(void);
+		void IndexPatches(uint32_t i);
+		void ApplyPatch(const record_header_t * patch, uint16_t offset, uint8_t * data, uint16_t length);
+		bool AppendRecord(uint16_t key, uint16_t type, const uint8_t * data, uint16_t length);
+		void CreateHeader(record_header_t& header, uint16_t key, uint16_t type, const uint8_t * data, uint16_t length);
+		uint32_t RecordSize(uint16_t length);
+		bool IsRecordValid(const record_header_t * record);
+		bool IsErased(const uint8_t * address, uint32_t length);
+		uint32_t ScanForEnd(uint32_t sector);
+		bool PrepareSector(uint32_t sector, uint32_t& eraseCount);
+		bool ProgramSectorHeader(uint32_t sector, uint32_t sequence, uint32_t eraseCount);
+		bool ProgramRecord(uint32_t sector, uint32_t offset, const record_header_t& header, const uint8_t * payload);
+		bool ProgramMergedRecord(uint32_t sector, uint32_t offset, uint32_t i);
+
+	private:
+		FlashMemory& flash_;
+		uint32_t sectorSize_;
+		uint32_t sectorCount_;
+
+		bool valid_;
+		uint32_t activeSector_;
+		uint32_t sequence_;
+		uint32_t eraseCount_;
+		uint32_t writeOffset_; // offset of the first free flash word in the active sector
+
+		struct {
+			uint16_t key;
+			uint32_t offset;     // offset of the latest valid complete record within the active sector
+			uint32_t firstPatch; // offset of the first patch record following it (0 if none)
+			uint32_t patches;    // number of patch records following it
+		} index_[FLASHRECORDSTORE_MAX_KEYS];
+		uint32_t indexSize_;
+
+		uint8_t patch_[FLASHRECORDSTORE_PATCH_BUFFER_SIZE];
+};
+
+#endif
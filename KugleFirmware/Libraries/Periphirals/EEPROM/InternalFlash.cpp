@@ -0,0 +1,93 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+ 
+#include "InternalFlash.h"
+#include "stm32h7xx_hal.h"
+
+InternalFlash::InternalFlash(uint32_t bank, uint32_t firstSector, uint32_t sectorCount) : bank_(bank), firstSector_(firstSector), sectorCount_(sectorCount)
+{
+}
+
+InternalFlash::~InternalFlash()
+{
+}
+
+uint32_t InternalFlash::GetSectorCount(void)
+{
+	return sectorCount_;
+}
+
+uint32_t InternalFlash::GetSectorSize(void)
+{
+	return FLASH_SECTOR_SIZE;
+}
+
+const uint8_t * InternalFlash::GetSectorAddress(uint32_t sector)
+{
+	uint32_t bankBase = (bank_ == FLASH_BANK_1) ? FLASH_BANK1_BASE : FLASH_BANK2_BASE;
+	return (const uint8_t *)(bankBase + (firstSector_ + sector) * FLASH_SECTOR_SIZE);
+}
+
+/**
+ * @brief 	Program one 256-bit flash word
+ * @param	sector     Input: sector index (relative to the first sector)
+ * @param	offset     Input: byte offset within the sector, must be a multiple of FLASH_WORD_SIZE
+ * @param	data       Input: flash word content
+ * @retval	true if the word was programmed successfully
+ */
+bool InternalFlash::ProgramWord(uint32_t sector, uint32_t offset, const uint64_t data[FLASH_WORD_SIZE/8])
+{
+	if (sector >= sectorCount_ || (offset % FLASH_WORD_SIZE) != 0 || offset >= FLASH_SECTOR_SIZE) return false;
+
+	HAL_FLASH_Unlock();
+	HAL_StatusTypeDef status = HAL_FLASH_Program(FLASH_TYPEPROGRAM_FLASHWORD, (uint32_t)GetSectorAddress(sector) + offset, (uint64_t)((uint32_t)data));
+	HAL_FLASH_Lock();
+
+	return (status == HAL_OK);
+}
+
+/**
+ * @brief 	Erase a sector and invalidate any cached content of it
+ * @param	sector     Input: sector index (relative to the first sector)
+ * @retval	true if the sector was erased successfully
+ */
+bool InternalFlash::EraseSector(uint32_t sector)
+{
+	if (sector >= sectorCount_) return false;
+
+	FLASH_EraseInitTypeDef eraseInit;
+	uint32_t sectorError = 0;
+	eraseInit.TypeErase = FLASH_TYPEERASE_SECTORS;
+	eraseInit.Banks = bank_;
+	eraseInit.Sector = firstSector_ + sector;
+	eraseInit.NbSectors = 1;
+	eraseInit.VoltageRange = FLASH_VOLTAGE_RANGE_3;
+
+	HAL_FLASH_Unlock();
+	if (bank_ == FLASH_BANK_1)
+		__HAL_FLASH_CLEAR_FLAG_BANK1(FLASH_FLAG_ALL_ERRORS_BANK1);
+	else
+		__HAL_FLASH_CLEAR_FLAG_BANK2(FLASH_FLAG_ALL_ERRORS_BANK2);
+	HAL_StatusTypeDef status = HAL_FLASHEx_Erase(&eraseInit, &sectorError);
+	HAL_FLASH_Lock();
+
+	SCB_CleanInvalidateDCache_by_Addr((uint32_t *)GetSectorAddress(sector), FLASH_SECTOR_SIZE);
+
+	return (status == HAL_OK);
+}
@@ -0,0 +1,46 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+ 
+#ifndef PERIPHIRALS_INTERNALFLASH_H
+#define PERIPHIRALS_INTERNALFLASH_H
+
+#include "stm32h7xx_hal.h"
+#include "FlashMemory.h"
+
+/* Consecutive sectors of the internal STM32H7 flash */
+class InternalFlash : public FlashMemory
+{
+	public:
+		InternalFlash(uint32_t bank, uint32_t firstSector, uint32_t sectorCount);
+		~InternalFlash();
+
+		uint32_t GetSectorCount(void);
+		uint32_t GetSectorSize(void);
+		const uint8_t * GetSectorAddress(uint32_t sector);
+
+		bool ProgramWord(uint32_t sector, uint32_t offset, const uint64_t data[FLASH_WORD_SIZE/8]);
+		bool EraseSector(uint32_t sector);
+
+	private:
+		uint32_t bank_;
+		uint32_t firstSector_;
+		uint32_t sectorCount_;
+};
+
+#endif
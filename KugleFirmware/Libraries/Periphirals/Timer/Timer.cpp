@@ -209,6 +209,24 @@ uint32_t Timer::Get()
 	return (uint32_t)__HAL_TIM_GET_COUNTER(&_hRes->handle) + _hRes->counterOffset;
 }
 
+/**
+ * @brief 	Return the timer value extended to 64 bits, which does not wrap around. Must not be called from an interrupt.
+ * @return	uint64_t			Timer counts since the timer was started or reset
+ */
+uint64_t Timer::Get64()
+{
+	if (!_hRes) return 0;
+
+	taskENTER_CRITICAL(); // the timer interrupt updates the offset
+	uint64_t offset = ((uint64_t)_hRes->counterOffsetHigh << 32) | _hRes->counterOffset;
+	uint32_t counter = __HAL_TIM_GET_COUNTER(&_hRes->handle);
+	if (__HAL_TIM_GET_FLAG(&_hRes->handle, TIM_FLAG_UPDATE) != RESET)
+		counter = __HAL_TIM_GET_COUNTER(&_hRes->handle) + (_hRes->maxValue + 1); // the counter has wrapped around, but the interrupt has not been served yet
+	taskEXIT_CRITICAL();
+
+	return offset + counter;
+}
+
 float Timer::GetTime()
 {
 	return (float)Get() / (float)_hRes->frequency;
@@ -220,6 +238,7 @@ void Timer::Reset()
 		xQueueReset(_hRes->callbackSemaphore);
 	__HAL_TIM_SET_COUNTER(&_hRes->handle, 0);
 	_hRes->counterOffset = 0;
+	_hRes->counterOffsetHigh = 0;
 }
 
 void Timer::Wait(uint32_t MicrosToWait)
@@ -319,7 +338,10 @@ void Timer::InterruptHandler(Timer::hardware_resource_t * timer)
 		{
 			__HAL_TIM_CLEAR_IT(&timer->handle, TIM_IT_UPDATE);
 
-			timer->counterOffset += (timer->maxValue + 1);
+			uint32_t counterOffset = timer->counterOffset + (timer->maxValue + 1);
+			if (counterOffset < timer->counterOffset)
+				timer->counterOffsetHigh++; // see Get64
+			timer->counterOffset = counterOffset;
 
 			if (timer->callbackSemaphore) {
 				portBASE_TYPE xHigherPriorityTaskWoken = pdFALSE;
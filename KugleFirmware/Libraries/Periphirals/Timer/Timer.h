@@ -48,6 +48,7 @@ class Timer
 		void SetMaxValue(uint16_t maxValue);
 
 		uint32_t Get();
+		uint64_t Get64();
 		float GetTime();
 		void Reset();
 		void Wait(uint32_t MicrosToWait);
@@ -59,6 +60,7 @@ class Timer
 			uint32_t frequency;
 			uint16_t maxValue;
 			uint32_t counterOffset;
+			uint32_t counterOffsetHigh; // wrap arounds of counterOffset, counted by the interrupt such that none is missed
 			TIM_HandleTypeDef handle;
 			TaskHandle_t callbackTaskHandle;
 			void (*TimerCallback)();
@@ -365,6 +365,33 @@ size_t xPortGetMinimumEverFreeHeapSize( void )
 }
 /*-----------------------------------------------------------*/
 
+/* Heap inspection used by the allocation tracer in MemoryManagement.c */
+size_t xPortGetBlockSize( void *pv )
+{
+BlockLink_t *pxLink = ( BlockLink_t * ) ( ( uint8_t * ) pv - xHeapStructSize );
+
+	return pxLink->xBlockSize & ~xBlockAllocatedBit;
+}
+/*-----------------------------------------------------------*/
+
+void vPortGetFreeBlocks( void ( *pxCallback )( size_t xBlockSize, void *pvParameter ), void *pvParameter )
+{
+BlockLink_t *pxBlock;
+
+	vTaskSuspendAll();
+	{
+		if( pxEnd != NULL )
+		{
+			for( pxBlock = xStart.pxNextFreeBlock; pxBlock != pxEnd; pxBlock = pxBlock->pxNextFreeBlock )
+			{
+				pxCallback( pxBlock->xBlockSize, pvParameter );
+			}
+		}
+	}
+	( void ) xTaskResumeAll();
+}
+/*-----------------------------------------------------------*/
+
 void vPortInitialiseBlocks( void )
 {
 	/* This just exists to keep the linker quiet. */
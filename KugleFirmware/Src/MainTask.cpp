@@ -51,11 +51,17 @@
 #include "LQR.h"
 #include "SlidingMode.h"
 #include "Debug.h"
+#include "RunTimeStats.h"
 #include "COMEKF.h"
 #include "MadgwickAHRS.h"
 #include "QEKF.h"
 #include "VelocityEKF.h"
 #include "Parameters.h"
+#include "BlockTransfer.h"
+#include "FirmwareUpdate.h"
+#include "Telemetry.h"
+#include "TimeSync.h"
+#include "BlackBox.h"
 #include "PowerManagement.h"
 #include "FrontPanel.h"
 #include "Joystick.h"
@@ -67,17 +73,27 @@
 #include "PathFollowingController.h"
 
 /* Miscellaneous includes */
+#include "MemoryManagement.h"
 #include "MATLABCoderInit.h"
 #include <stdlib.h>
 #include <vector>
 #include "ProcessorInit.h"
+#include "StaticArena.h"
+
+/* Long-lived objects created at boot are placed in a statically sized arena instead of the FreeRTOS heap */
+#define BOOT_ARENA_SIZE		( STATIC_ARENA_SIZEOF(EEPROM) + STATIC_ARENA_SIZEOF(PowerManagement) + STATIC_ARENA_SIZEOF(USBCDC) + STATIC_ARENA_SIZEOF(LSPC) \
+							+ STATIC_ARENA_SIZEOF(Debug) + STATIC_ARENA_SIZEOF(Parameters) + STATIC_ARENA_SIZEOF(BlockTransfer) + STATIC_ARENA_SIZEOF(FirmwareUpdate) \
+							+ STATIC_ARENA_SIZEOF(SPI) + STATIC_ARENA_SIZEOF(MPU9250) + STATIC_ARENA_SIZEOF(Timer) + 3*STATIC_ARENA_SIZEOF(ESCON) \
+							+ STATIC_ARENA_SIZEOF(Telemetry) + STATIC_ARENA_SIZEOF(TimeSync) + STATIC_ARENA_SIZEOF(BalanceController) + STATIC_ARENA_SIZEOF(RunTimeStats) + STATIC_ARENA_SIZEOF(BlackBox) )
+STATIC_ARENA(bootArena, BOOT_ARENA_SIZE);
 
 void MainTask(void * pvParameters)
 {
 	/* Use this task to:
 	 * - Create objects for each module
 	 *     (OBS! It is very important that objects created with "new"
-	 *      only happens within a thread due to the usage of the FreeRTOS managed heap)
+	 *      only happens within a thread due to the usage of the FreeRTOS managed heap.
+	 *      Objects living until power off are created with "new (bootArena)" and have to be added to BOOT_ARENA_SIZE)
 	 * - Link any modules together if necessary
 	 * - Create message exchange queues and/or semaphore
 	 * - (Create) and start threads related to modules
@@ -86,30 +102,42 @@ void MainTask(void * pvParameters)
 	 */
 
 	/* Initialize EEPROM */
-	EEPROM * eeprom = new EEPROM;
+	EEPROM * eeprom = new (bootArena) EEPROM;
 
 	/* Initialize MATLAB coder globals */
 	MATLABCoder_initialize();
 
 	/* Initialize power management */
-	PowerManagement * pm = new PowerManagement(POWER_MANAGEMENT_PRIORITY);
+	PowerManagement * pm = new (bootArena) PowerManagement(POWER_MANAGEMENT_PRIORITY);
 	pm->Enable(true, true); // enable 19V and 5V power
 
 	/* Initialize communication */
-	USBCDC * usb = new USBCDC(USBCDC_TRANSMITTER_PRIORITY);
-	LSPC * lspcUSB = new LSPC(usb, LSPC_RECEIVER_PRIORITY, LSPC_TRANSMITTER_PRIORITY); // very important to use "new", otherwise the object gets placed on the stack which does not have enough memory!
-	Debug * dbg = new Debug(lspcUSB); // pair debug module with configured LSPC module to enable "Debug::print" functionality
+	USBCDC * usb = new (bootArena) USBCDC(USBCDC_TRANSMITTER_PRIORITY);
+	LSPC * lspcUSB = new (bootArena) LSPC(usb, LSPC_RECEIVER_PRIORITY, LSPC_TRANSMITTER_PRIORITY); // very important to use "new", otherwise the object gets placed on the stack which does not have enough memory!
+	Debug * dbg = new (bootArena) Debug(lspcUSB); // pair debug module with configured LSPC module to enable "Debug::print" functionality
 
 	/* Register general (system wide) LSPC callbacks */
 	lspcUSB->registerCallback(lspc::MessageTypesFromPC::Reboot, &Reboot_Callback);
 	lspcUSB->registerCallback(lspc::MessageTypesFromPC::EnterBootloader, &EnterBootloader_Callback);
+	lspcUSB->registerCallback(lspc::MessageTypesFromPC::HeapStats, &HeapStats_Callback, (void *)lspcUSB);
 
 	/* Initialize global parameters */
-	Parameters& params = *(new Parameters(eeprom, lspcUSB));
+	Parameters& params = *(new (bootArena) Parameters(eeprom, lspcUSB));
+
+	/* Initialize the black box recorder of the balance controller */
+	BlackBox * blackBox = new (bootArena) BlackBox(*lspcUSB, BLACKBOX_PRIORITY);
+
+	/* Initialize dump/restore of parameters and calibration and dump of black box recordings */
+	BlockTransfer * blockTransfer = new (bootArena) BlockTransfer(*lspcUSB, eeprom, blackBox);
+	if (!blockTransfer) ERROR("Could not initialize block transfer");
+
+	/* Initialize firmware update over LSPC */
+	FirmwareUpdate * firmwareUpdate = new (bootArena) FirmwareUpdate(*lspcUSB, eeprom, FIRMWARE_UPDATE_PRIORITY);
+	if (!firmwareUpdate) ERROR("Could not initialize firmware update");
 
 	/* Initialize and configure IMU */
-	SPI * spi = new SPI(SPI::PORT_SPI6, MPU9250_Bus::SPI_LOW_FREQUENCY, GPIOG, GPIO_PIN_8);
-	MPU9250 * imu = new MPU9250(spi);
+	SPI * spi = new (bootArena) SPI(SPI::PORT_SPI6, MPU9250_Bus::SPI_LOW_FREQUENCY, GPIOG, GPIO_PIN_8);
+	MPU9250 * imu = new (bootArena) MPU9250(spi);
 	imu->AttachEEPROM(eeprom);
 	imu->Configure(MPU9250::ACCEL_RANGE_2G, MPU9250::GYRO_RANGE_250DPS);
 	if (params.estimator.EnableSensorLPFfilters) {
@@ -125,29 +153,37 @@ void MainTask(void * pvParameters)
 	imu->ConfigureInterrupt(GPIOE, GPIO_PIN_3);
 
 	/* Initialize microseconds timer */
-	Timer * microsTimer = new Timer(Timer::TIMER6, 1000000);
+	Timer * microsTimer = new (bootArena) Timer(Timer::TIMER6, 1000000);
 
 	/* Initialize motors */
-	ESCON * motor1 = new ESCON(1);
-	ESCON * motor2 = new ESCON(2);
-	ESCON * motor3 = new ESCON(3);
+	ESCON * motor1 = new (bootArena) ESCON(1);
+	ESCON * motor2 = new (bootArena) ESCON(2);
+	ESCON * motor3 = new (bootArena) ESCON(3);
 
 	/* Test info */
 	Debug::print("Booting...\n");
 
+	/* Initialize rate control of the periodic messages */
+	Telemetry * telemetry = new (bootArena) Telemetry(*lspcUSB);
+
+	/* Initialize synchronization of the robot clock to the PC clock */
+	TimeSync * timeSync = new (bootArena) TimeSync(*lspcUSB, *microsTimer);
+
 	/******* APPLICATION LAYERS *******/
-	BalanceController * balanceController = new BalanceController(*imu, *motor1, *motor2, *motor3, *lspcUSB, *microsTimer);
+	BalanceController * balanceController = new (bootArena) BalanceController(*imu, *motor1, *motor2, *motor3, *lspcUSB, *telemetry, *blackBox, *microsTimer, *timeSync);
 	if (!balanceController) ERROR("Could not initialize balance controller");
 
-	/* Send CPU load every second */
-	char * pcWriteBuffer = (char *)pvPortMalloc(1024);
+	/* Send task run time statistics with the configured period */
+	RunTimeStats * runTimeStats = new (bootArena) RunTimeStats(*lspcUSB);
 	while (1)
 	{
-		vTaskGetRunTimeStats(pcWriteBuffer);
-		char * endPtr = &pcWriteBuffer[strlen(pcWriteBuffer)];
-		*endPtr++ = '\n'; *endPtr++ = '\n'; *endPtr++ = 0;
-		lspcUSB->TransmitAsync(lspc::MessageTypesToPC::CPUload, (uint8_t *)pcWriteBuffer, strlen(pcWriteBuffer));
-		osDelay(1000);
+		params.Refresh();
+		if (params.debug.RunTimeStatsPeriod > 0) {
+			runTimeStats->Transmit();
+			osDelay(params.debug.RunTimeStatsPeriod);
+		} else {
+			osDelay(100); // check again later if the statistics have been enabled
+		}
 	}
 
 	/*while (1)
@@ -169,3 +205,52 @@ void EnterBootloader_Callback(void * param, const std::vector<uint8_t>& payload)
 	USBD_DeInit(&USBCDC::hUsbDeviceFS);
 	Enter_DFU_Bootloader();
 }
+
+void HeapStats_Callback(void * param, const std::vector<uint8_t>& payload)
+{
+	LSPC * com = (LSPC *)param;
+	if (!com) return;
+
+	MemoryTrace_TaskStats_t * tasks = (MemoryTrace_TaskStats_t *)pvPortMalloc(MEMORY_TRACE_MAX_TASKS * sizeof(MemoryTrace_TaskStats_t));
+	if (!tasks) return;
+
+	MemoryTrace_HeapStats_t heap;
+	MemoryTrace_GetHeapStats(&heap);
+	uint32_t numberOfTasks = MemoryTrace_GetTaskStats(tasks, MEMORY_TRACE_MAX_TASKS);
+
+	lspc::MessageTypesToPC::HeapStats_t msg;
+	msg.free_bytes = heap.freeBytes;
+	msg.minimum_ever_free_bytes = heap.minimumEverFreeBytes;
+	msg.free_blocks = heap.freeBlocks;
+	msg.largest_free_block = heap.largestFreeBlock;
+	memcpy(msg.free_block_histogram, heap.freeBlockHistogram, sizeof(msg.free_block_histogram));
+	msg.allocations = heap.allocations;
+	msg.frees = heap.frees;
+	msg.failed_allocations = heap.failedAllocations;
+	msg.current_bytes = heap.currentBytes;
+	msg.peak_bytes = heap.peakBytes;
+	msg.tasks = numberOfTasks;
+	com->TransmitAsync<lspc::MessageTypesToPC::HeapStats>(msg);
+
+	/* Send the task statistics with as many entries per package as possible */
+	const uint32_t entriesPerPackage = LSPC_MAXIMUM_PACKAGE_LENGTH / sizeof(lspc::MessageTypesToPC::HeapTaskStats_t);
+	lspc::MessageTypesToPC::HeapTaskStats_t entries[entriesPerPackage];
+	uint32_t count = 0;
+	for (uint32_t i = 0; i < numberOfTasks; i++) {
+		entries[count].allocations = tasks[i].allocations;
+		entries[count].frees = tasks[i].frees;
+		entries[count].failed_allocations = tasks[i].failedAllocations;
+		entries[count].allocated_bytes = tasks[i].allocatedBytes;
+		entries[count].freed_bytes = tasks[i].freedBytes;
+		entries[count].peak_bytes = tasks[i].peakBytes;
+		memcpy(entries[count].name, tasks[i].name, sizeof(entries[count].name));
+		count++;
+
+		if (count == entriesPerPackage || i == numberOfTasks-1) {
+			com->TransmitAsync(lspc::MessageTypesToPC::HeapTaskStats, (uint8_t *)entries, count * sizeof(lspc::MessageTypesToPC::HeapTaskStats_t));
+			count = 0;
+		}
+	}
+
+	vPortFree(tasks);
+}
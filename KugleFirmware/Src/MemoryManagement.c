@@ -1,4 +1,6 @@
+#ifndef MEMORY_MANAGEMENT_HOST
 #include "stm32h7xx_hal.h"
+#endif
 #include "stdlib.h"
 #include "cmsis_os.h"
 #include "FreeRTOS.h"
@@ -7,6 +9,8 @@
 #include <malloc.h>
 #include "MemoryManagement.h"
 
+#ifndef MEMORY_MANAGEMENT_HOST // the newlib wrappers and the linker placed heap are only used on target, the allocation tracer is also used in host builds
+
 /* Adjustments of the Dynamic Memory scheme
  * See: https://mcuoneclipse.com/2017/07/02/using-freertos-with-newlib-and-newlib-nano/
  * And: http://www.nadler.com/embedded/newlibAndFreeRTOS.html
@@ -78,6 +82,136 @@ void ZeroInitFreeRTOSheap(void)
 	freeRTOSMemoryScheme = configUSE_HEAP_SCHEME;
 	memset(heapPtr, 0, configTOTAL_HEAP_SIZE);
 }
+#endif
+
+/* Allocation tracer, called from pvPortMalloc and vPortFree through the traceMALLOC and traceFREE macros (see FreeRTOSConfig.h)
+ * while the scheduler is suspended, hence no further locking is needed.
+ * Each task is assigned a slot the first time it allocates or frees memory. The slot is stored as the task number (vTaskSetTaskNumber). */
+static MemoryTrace_TaskStats_t memoryTraceTasks[MEMORY_TRACE_MAX_TASKS] = { { 0, 0, 0, 0, 0, 0, "(startup)" } };
+static uint32_t memoryTraceSlots = 1; // slot 0 is used before the scheduler is started
+static uint32_t memoryTraceCurrentBytes[MEMORY_TRACE_MAX_TASKS];
+static uint32_t memoryTraceTotalCurrentBytes = 0;
+static uint32_t memoryTraceTotalPeakBytes = 0;
+
+static MemoryTrace_TaskStats_t * MemoryTrace_GetTask(uint32_t * slot)
+{
+	TaskHandle_t task = xTaskGetCurrentTaskHandle();
+	*slot = 0;
+	if (task && xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED) {
+		*slot = uxTaskGetTaskNumber(task);
+		if (*slot == 0 || *slot >= MEMORY_TRACE_MAX_TASKS) { // first allocation of this task
+			if (memoryTraceSlots < MEMORY_TRACE_MAX_TASKS-1) {
+				*slot = memoryTraceSlots++;
+				strncpy(memoryTraceTasks[*slot].name, pcTaskGetName(task), MEMORY_TRACE_NAME_LENGTH-1);
+			} else {
+				*slot = MEMORY_TRACE_MAX_TASKS-1;
+				strncpy(memoryTraceTasks[*slot].name, "(other tasks)", MEMORY_TRACE_NAME_LENGTH-1);
+				memoryTraceSlots = MEMORY_TRACE_MAX_TASKS;
+			}
+			vTaskSetTaskNumber(task, *slot);
+		}
+	}
+	return &memoryTraceTasks[*slot];
+}
+
+void MemoryTrace_Malloc(void * ptr, unsigned int size)
+{
+	uint32_t slot;
+	MemoryTrace_TaskStats_t * stats = MemoryTrace_GetTask(&slot);
+	if (!ptr) {
+		stats->failedAllocations++;
+		return;
+	}
+
+	size = xPortGetBlockSize(ptr); // the requested size is rounded up to the size of the block being used
+	stats->allocations++;
+	stats->allocatedBytes += size;
+	memoryTraceCurrentBytes[slot] += size;
+	if ((int32_t)memoryTraceCurrentBytes[slot] > (int32_t)stats->peakBytes)
+		stats->peakBytes = memoryTraceCurrentBytes[slot];
+
+	memoryTraceTotalCurrentBytes += size;
+	if (memoryTraceTotalCurrentBytes > memoryTraceTotalPeakBytes)
+		memoryTraceTotalPeakBytes = memoryTraceTotalCurrentBytes;
+}
+
+void MemoryTrace_Free(void * ptr, unsigned int size)
+{
+	(void)ptr; // the block size is given by heap_4
+	uint32_t slot;
+	MemoryTrace_TaskStats_t * stats = MemoryTrace_GetTask(&slot);
+	stats->frees++;
+	stats->freedBytes += size;
+	memoryTraceCurrentBytes[slot] -= size; // can become negative for a task freeing memory allocated by another task
+	memoryTraceTotalCurrentBytes -= size;
+}
+
+/**
+ * @brief 	Copy the allocation statistics of the tasks which have used the heap
+ * @param	stats      Output: array of task statistics
+ * @param	maxTasks   Input: number of elements in the array
+ * @retval	number of task statistics copied
+ */
+uint32_t MemoryTrace_GetTaskStats(MemoryTrace_TaskStats_t * stats, uint32_t maxTasks)
+{
+	vTaskSuspendAll();
+	uint32_t tasks = (memoryTraceSlots < maxTasks) ? memoryTraceSlots : maxTasks;
+	memcpy(stats, memoryTraceTasks, tasks * sizeof(MemoryTrace_TaskStats_t));
+	xTaskResumeAll();
+	return tasks;
+}
+
+static void MemoryTrace_FreeBlock(size_t blockSize, void * param)
+{
+	MemoryTrace_HeapStats_t * stats = (MemoryTrace_HeapStats_t *)param;
+	uint32_t bin = 0;
+	while ((16U << (bin+1)) <= blockSize && bin < MEMORY_TRACE_HISTOGRAM_BINS-1)
+		bin++;
+	stats->freeBlockHistogram[bin]++;
+	stats->freeBlocks++;
+	if (blockSize > stats->largestFreeBlock)
+		stats->largestFreeBlock = blockSize;
+}
+
+/**
+ * @brief 	Get the heap usage and the free block size histogram, which shows the fragmentation of the heap
+ * @param	stats      Output: heap statistics
+ */
+void MemoryTrace_GetHeapStats(MemoryTrace_HeapStats_t * stats)
+{
+	memset(stats, 0, sizeof(MemoryTrace_HeapStats_t));
+	vPortGetFreeBlocks(&MemoryTrace_FreeBlock, stats); // walks the free list with the scheduler suspended
+
+	vTaskSuspendAll();
+	stats->freeBytes = xPortGetFreeHeapSize();
+	stats->minimumEverFreeBytes = xPortGetMinimumEverFreeHeapSize();
+	for (uint32_t i = 0; i < memoryTraceSlots; i++) {
+		stats->allocations += memoryTraceTasks[i].allocations;
+		stats->frees += memoryTraceTasks[i].frees;
+		stats->failedAllocations += memoryTraceTasks[i].failedAllocations;
+	}
+	stats->currentBytes = memoryTraceTotalCurrentBytes;
+	stats->peakBytes = memoryTraceTotalPeakBytes;
+	xTaskResumeAll();
+}
+
+/**
+ * @brief 	Reset the counters and peaks, eg. between test cases. The task slots and the currently allocated bytes are kept.
+ */
+void MemoryTrace_Reset(void)
+{
+	vTaskSuspendAll();
+	for (uint32_t i = 0; i < MEMORY_TRACE_MAX_TASKS; i++) {
+		memoryTraceTasks[i].allocations = 0;
+		memoryTraceTasks[i].frees = 0;
+		memoryTraceTasks[i].failedAllocations = 0;
+		memoryTraceTasks[i].allocatedBytes = 0;
+		memoryTraceTasks[i].freedBytes = 0;
+		memoryTraceTasks[i].peakBytes = ((int32_t)memoryTraceCurrentBytes[i] > 0) ? memoryTraceCurrentBytes[i] : 0;
+	}
+	memoryTraceTotalPeakBytes = memoryTraceTotalCurrentBytes;
+	xTaskResumeAll();
+}
 
 #if 0
 // Define the 'new' operator for C++ to use the freeRTOS memory management
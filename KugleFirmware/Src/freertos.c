@@ -99,6 +99,17 @@ unsigned long getRunTimeCounterValue(void)
 {
 	return HAL_GetHighResTick();
 }
+
+/* Memory of the idle task, needed when configSUPPORT_STATIC_ALLOCATION is on */
+static StaticTask_t xIdleTaskTCBBuffer;
+static StackType_t xIdleStack[configMINIMAL_STACK_SIZE];
+
+void vApplicationGetIdleTaskMemory(StaticTask_t **ppxIdleTaskTCBBuffer, StackType_t **ppxIdleTaskStackBuffer, uint32_t *pulIdleTaskStackSize)
+{
+	*ppxIdleTaskTCBBuffer = &xIdleTaskTCBBuffer;
+	*ppxIdleTaskStackBuffer = &xIdleStack[0];
+	*pulIdleTaskStackSize = configMINIMAL_STACK_SIZE;
+}
 /* USER CODE END 1 */
 
 /* Private application code --------------------------------------------------*/
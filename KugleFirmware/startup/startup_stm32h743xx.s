@@ -60,6 +60,9 @@ defined in linker script */
 .word  _sbss
 /* end address for the .bss section. defined in linker script */
 .word  _ebss
+/* start and end address of the static arenas. defined in linker script */
+.word  _sstatic_arena
+.word  _estatic_arena
 /* stack used for SystemInit_ExtMemCtl; always internal RAM used */
 
 /**
@@ -114,6 +117,18 @@ LoopFillZerobss:
   cmp  r2, r3
   bcc  FillZerobss
 
+/* Zero fill the static arenas (NOLOAD section), since the objects placed in them rely on zeroed memory as on the heap */
+  ldr  r2, =_sstatic_arena
+  b  LoopFillZeroStaticArena
+FillZeroStaticArena:
+  movs  r3, #0
+  str  r3, [r2], #4
+
+LoopFillZeroStaticArena:
+  ldr  r3, = _estatic_arena
+  cmp  r2, r3
+  bcc  FillZeroStaticArena
+
 /* Call the clock system intitialization function.*/
   bl  SystemInit   
 /* Call static constructors */
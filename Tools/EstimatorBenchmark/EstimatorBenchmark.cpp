@@ -0,0 +1,500 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+ 
+
+/* Benchmark of the attitude estimators on synthetic IMU data, run on the host.
+ *
+ * A robot rotating with a smooth random angular velocity is simulated, and the accelerometer and gyroscope
+ * measurements are generated from it with noise (the covariances of the MPU9250 parameters) and a constant gyro bias.
+ * The unit tests of the estimators (including QEKFBatch, which is only used on a host) and a finite difference check of the steady state
+ * acceleration Jacobians used by the velocity and COM estimators are run first, then every estimator is run over the same samples and reported with its time per step on this machine, its largest tilt error
+ * and the conditioning of its covariance matrix:
+ *   - smallest eigenvalue of the covariance of the vector part of the quaternion normalized by its diagonal (the correlation
+ *     matrix), which turns negative when the covariance loses positive definiteness. The full quaternion covariance of the
+ *     MEKF is singular by construction, since it is mapped from its 3-dimensional attitude error.
+ *   - largest asymmetry |P(i,j) - P(j,i)| relative to sqrt(P(i,i)*P(j,j)), which is zero by construction for packed storage
+ * The Madgwick filter has no covariance and is run at the sample rate of the balance loop with MadgwickBeta,
+ * once integrating with the true sample period and once with the period of sampleFreqDef, as it did before it used its constructor argument.
+ * The host timing is only a relative measure between the estimators, not a measure of the Cortex-M7 timing.
+ * Build with build.sh.
+ *
+ * Usage: EstimatorBenchmark [samples]
+ */
+
+#include "QEKF.h"
+#include "MEKF.h"
+#include "QEKFBatch.h"
+#include "QEKF_coder.h"
+#include "QEKF_initialize.h"
+#include "SteadyStateAcceleration.h"
+#include "SteadyStateAccelerationJacobian.h"
+#include "MadgwickAHRS.h"
+#include "Parameters.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+#include <new>
+
+#define SAMPLE_RATE		400.0 // Hz
+
+typedef struct {
+	float accelerometer[3];
+	float gyroscope[3];
+	float q[4]; // true attitude
+} Sample_t;
+
+typedef struct {
+	const char * name;
+	double nsPerStep;
+	double tiltError; // largest tilt error after convergence [deg]
+	double tiltSquares; // sum of squared tilt errors after convergence, for the RMS
+	int tiltSamples;
+	double minEigenvalue; // smallest eigenvalue of the normalized covariance over the run
+	double maxAsymmetry;
+} Result_t;
+
+static uint32_t seed = 1;
+
+static double Uniform(void)
+{
+	seed = seed * 1664525u + 1013904223u;
+	return ((seed >> 8) + 0.5) / 16777216.0;
+}
+
+static double Gaussian(void)
+{
+	return sqrt(-2 * log(Uniform())) * cos(2 * M_PI * Uniform());
+}
+
+/* Correlated noise with the given covariance, through its Cholesky factor */
+static void Noise(const float cov[9], float noise[3])
+{
+	double L[9] = {0};
+	for (int i = 0; i < 3; i++) {
+		for (int j = 0; j <= i; j++) {
+			double sum = cov[3*i + j];
+			for (int k = 0; k < j; k++) sum -= L[3*i + k] * L[3*j + k];
+			L[3*i + j] = (i == j) ? sqrt(sum) : sum / L[3*j + j];
+		}
+	}
+	double n[3] = {Gaussian(), Gaussian(), Gaussian()};
+	for (int i = 0; i < 3; i++)
+		noise[i] = L[3*i + 0] * n[0] + L[3*i + 1] * n[1] + L[3*i + 2] * n[2];
+}
+
+static void Simulate(const Parameters& params, Sample_t * samples, int count)
+{
+	const double bias[3] = {0.004, -0.003, 0};
+	double q[4] = {1, 0, 0, 0};
+	double omega[3] = {0, 0, 0};
+	const double dt = 1.0 / SAMPLE_RATE;
+
+	for (int k = 0; k < count; k++) {
+		/* Smooth random angular velocity, mostly tilting around the upright position like a balancing robot */
+		for (int i = 0; i < 3; i++)
+			omega[i] = 0.995 * omega[i] + 0.05 * Gaussian();
+		omega[0] -= 0.5 * q[1]; // pull the tilt back towards upright
+		omega[1] -= 0.5 * q[2];
+
+		/* q = q o [1; omega*dt/2] */
+		double dq[4] = {1, omega[0] * dt / 2, omega[1] * dt / 2, omega[2] * dt / 2};
+		double p[4] = {q[0]*dq[0] - q[1]*dq[1] - q[2]*dq[2] - q[3]*dq[3],
+					   q[0]*dq[1] + q[1]*dq[0] + q[2]*dq[3] - q[3]*dq[2],
+					   q[0]*dq[2] - q[1]*dq[3] + q[2]*dq[0] + q[3]*dq[1],
+					   q[0]*dq[3] + q[1]*dq[2] - q[2]*dq[1] + q[3]*dq[0]};
+		double norm = sqrt(p[0]*p[0] + p[1]*p[1] + p[2]*p[2] + p[3]*p[3]);
+		for (int i = 0; i < 4; i++) q[i] = p[i] / norm;
+
+		/* Gravity in body frame, R(q)' * [0; 0; g] */
+		const double g = params.model.g;
+		double acc[3] = {2 * (q[1]*q[3] - q[0]*q[2]) * g,
+						 2 * (q[2]*q[3] + q[0]*q[1]) * g,
+						 (q[0]*q[0] - q[1]*q[1] - q[2]*q[2] + q[3]*q[3]) * g};
+
+		Sample_t& s = samples[k];
+		float accNoise[3], gyroNoise[3];
+		Noise(params.estimator.cov_acc_mpu, accNoise);
+		Noise(params.estimator.cov_gyro_mpu, gyroNoise);
+		for (int i = 0; i < 3; i++) {
+			s.accelerometer[i] = acc[i] + accNoise[i];
+			s.gyroscope[i] = omega[i] + bias[i] + gyroNoise[i];
+		}
+		for (int i = 0; i < 4; i++) s.q[i] = q[i];
+	}
+}
+
+/* Eigenvalues of a symmetric matrix with the cyclic Jacobi method, returns the smallest */
+static double MinEigenvalue(double * A, int n)
+{
+	for (int sweep = 0; sweep < 100; sweep++) {
+		double off = 0;
+		for (int i = 0; i < n; i++)
+			for (int j = i + 1; j < n; j++)
+				off += A[n*i + j] * A[n*i + j];
+		if (off < 1e-30) break;
+
+		for (int p = 0; p < n; p++) {
+			for (int r = p + 1; r < n; r++) {
+				if (A[n*p + r] == 0) continue;
+				double theta = (A[n*r + r] - A[n*p + p]) / (2 * A[n*p + r]);
+				double t = (theta >= 0 ? 1 : -1) / (fabs(theta) + sqrt(theta*theta + 1));
+				double c = 1 / sqrt(t*t + 1), s = t * c;
+				for (int k = 0; k < n; k++) {
+					double akp = A[n*k + p], akr = A[n*k + r];
+					A[n*k + p] = c * akp - s * akr;
+					A[n*k + r] = s * akp + c * akr;
+				}
+				for (int k = 0; k < n; k++) {
+					double apk = A[n*p + k], ark = A[n*r + k];
+					A[n*p + k] = c * apk - s * ark;
+					A[n*r + k] = s * apk + c * ark;
+				}
+			}
+		}
+	}
+
+	double minimum = A[0];
+	for (int i = 1; i < n; i++)
+		if (A[n*i + i] < minimum) minimum = A[n*i + i];
+	return minimum;
+}
+
+/* Update the conditioning measures of the result with the vector part of a quaternion covariance */
+static void Condition(const float Cov_q[4*4], Result_t& result)
+{
+	const int n = 3;
+	const float * P = &Cov_q[4 + 1];
+	double A[3*3];
+	for (int i = 0; i < n; i++) {
+		for (int j = 0; j < n; j++) {
+			double scale = sqrt(fabs((double)P[4*i + i] * P[4*j + j]));
+			if (scale == 0) scale = 1;
+			double asymmetry = fabs((double)P[4*i + j] - P[4*j + i]) / scale;
+			if (asymmetry > result.maxAsymmetry) result.maxAsymmetry = asymmetry;
+			A[n*i + j] = 0.5 * ((double)P[4*i + j] + P[4*j + i]) / scale;
+		}
+	}
+	double minimum = MinEigenvalue(A, n);
+	if (minimum < result.minEigenvalue) result.minEigenvalue = minimum;
+}
+
+/* Tilt error, the angle between the estimated and the true gravity direction in body frame, since the yaw is not observable */
+static double TiltError(const float q[4], const float q_true[4])
+{
+	double z[3] = {2 * (q[1]*q[3] - q[0]*q[2]), 2 * (q[2]*q[3] + q[0]*q[1]), q[0]*q[0] - q[1]*q[1] - q[2]*q[2] + q[3]*q[3]};
+	double z_true[3] = {2 * (q_true[1]*q_true[3] - q_true[0]*q_true[2]), 2 * (q_true[2]*q_true[3] + q_true[0]*q_true[1]), q_true[0]*q_true[0] - q_true[1]*q_true[1] - q_true[2]*q_true[2] + q_true[3]*q_true[3]};
+	double norm = sqrt(z[0]*z[0] + z[1]*z[1] + z[2]*z[2]) * sqrt(z_true[0]*z_true[0] + z_true[1]*z_true[1] + z_true[2]*z_true[2]);
+	double dot = (z[0]*z_true[0] + z[1]*z_true[1] + z[2]*z_true[2]) / norm;
+	if (dot > 1) dot = 1;
+	return acos(dot) * 180 / M_PI;
+}
+
+static void Print(const Result_t& result, double reference)
+{
+	printf("%-30s %6.0f ns/step (%4.2fx)   tilt RMS %6.3f deg, max %6.3f deg", result.name,
+		   result.nsPerStep, reference / result.nsPerStep, sqrt(result.tiltSquares / result.tiltSamples), result.tiltError);
+	if (isinf(result.minEigenvalue))
+		printf("   (no covariance)\n");
+	else
+		printf("   min eigenvalue %9.3e   asymmetry %8.2e\n", result.minEigenvalue, result.maxAsymmetry);
+}
+
+static void Tilt(const float q[4], const float q_true[4], Result_t& result)
+{
+	double error = TiltError(q, q_true);
+	if (error > result.tiltError) result.tiltError = error;
+	result.tiltSquares += error * error;
+	result.tiltSamples++;
+}
+
+static void Initialize(Result_t& result, const char * name)
+{
+	result.name = name;
+	result.nsPerStep = 0;
+	result.tiltError = 0;
+	result.tiltSquares = 0;
+	result.tiltSamples = 0;
+	result.minEigenvalue = INFINITY;
+	result.maxAsymmetry = 0;
+}
+
+#define CONDITION_INTERVAL	100 // samples between each evaluation of the conditioning (not timed)
+#define CONVERGENCE_SAMPLES	2000 // samples before the tilt error is evaluated
+
+/* MATLAB generated QEKF with dense covariance, the reference of the hand-written QEKF */
+static Result_t RunGeneratedQEKF(const Parameters& params, const Sample_t * samples, int count)
+{
+	Result_t result;
+	Initialize(result, "QEKF (generated, dense P)");
+	const float dt = 1.0 / SAMPLE_RATE;
+
+	float X[10], P[10*10];
+	QEKF_initialize(params.estimator.QEKF_P_init_diagonal, X, P);
+
+	std::chrono::steady_clock::duration elapsed(0);
+	for (int k = 0; k < count; k += CONDITION_INTERVAL) {
+		int end = (k + CONDITION_INTERVAL < count) ? k + CONDITION_INTERVAL : count;
+		auto start = std::chrono::steady_clock::now();
+		for (int i = k; i < end; i++) {
+			float X_prev[10], P_prev[10*10];
+			memcpy(X_prev, X, sizeof(X_prev));
+			memcpy(P_prev, P, sizeof(P_prev));
+			_QEKF(X_prev, P_prev, samples[i].gyroscope, samples[i].accelerometer, dt, params.estimator.EstimateBias, true,
+				  params.estimator.cov_gyro_mpu, params.estimator.cov_acc_mpu, params.estimator.sigma2_bias, params.model.g, X, P);
+		}
+		elapsed += std::chrono::steady_clock::now() - start;
+
+		float Cov_q[4*4];
+		for (int i = 0; i < 4; i++)
+			for (int j = 0; j < 4; j++)
+				Cov_q[4*i + j] = P[10*i + j];
+		Condition(Cov_q, result);
+		if (end > CONVERGENCE_SAMPLES)
+			Tilt(X, samples[end - 1].q, result);
+	}
+
+	result.nsPerStep = std::chrono::duration<double, std::nano>(elapsed).count() / count;
+	return result;
+}
+
+/* Estimator with the QEKF interface, ie. the hand-written QEKF (see QEKF::Step) or the MEKF */
+template <class ESTIMATOR>
+static Result_t Run(Parameters& params, const Sample_t * samples, int count, bool joseph, const char * name)
+{
+	Result_t result;
+	Initialize(result, name);
+	const float dt = 1.0 / SAMPLE_RATE;
+
+	params.estimator.UseJosephForm = joseph;
+	ESTIMATOR estimator(params);
+	estimator.Reset();
+
+	std::chrono::steady_clock::duration elapsed(0);
+	for (int k = 0; k < count; k += CONDITION_INTERVAL) {
+		int end = (k + CONDITION_INTERVAL < count) ? k + CONDITION_INTERVAL : count;
+		auto start = std::chrono::steady_clock::now();
+		for (int i = k; i < end; i++)
+			estimator.Step(samples[i].accelerometer, samples[i].gyroscope, params.estimator.EstimateBias, dt);
+		elapsed += std::chrono::steady_clock::now() - start;
+
+		float Cov_q[4*4];
+		estimator.GetQuaternionCovariance(Cov_q);
+		Condition(Cov_q, result);
+		if (end > CONVERGENCE_SAMPLES) {
+			float q[4];
+			estimator.GetQuaternion(q);
+			Tilt(q, samples[end - 1].q, result);
+		}
+	}
+
+	result.nsPerStep = std::chrono::duration<double, std::nano>(elapsed).count() / count;
+	return result;
+}
+
+/* QEKF_BATCH_SIZE instances of the QEKF in lock-step, each running over the samples from its own starting point.
+ * The time is given per instance and step, and the tilt error and conditioning are of the first instance. */
+static Result_t RunQEKFBatch(Parameters& params, const Sample_t * samples, int count)
+{
+	Result_t result;
+	Initialize(result, "QEKFBatch (per instance)");
+
+	params.estimator.UseJosephForm = false; // not supported by the batch
+	static uint8_t memory[sizeof(QEKFBatch)] __attribute__((aligned(sizeof(QEKFBatch_lane_t))));
+	QEKFBatch * batch = new (memory) QEKFBatch(params);
+	batch->Reset();
+
+	float accelerometer[3][QEKF_BATCH_SIZE];
+	float gyroscope[3][QEKF_BATCH_SIZE];
+	float dt[QEKF_BATCH_SIZE];
+	for (int n = 0; n < QEKF_BATCH_SIZE; n++)
+		dt[n] = 1.0 / SAMPLE_RATE;
+
+	std::chrono::steady_clock::duration elapsed(0);
+	for (int k = 0; k < count; k += CONDITION_INTERVAL) {
+		int end = (k + CONDITION_INTERVAL < count) ? k + CONDITION_INTERVAL : count;
+		auto start = std::chrono::steady_clock::now();
+		for (int i = k; i < end; i++) {
+			for (int n = 0; n < QEKF_BATCH_SIZE; n++) {
+				const Sample_t& sample = samples[(i + (int64_t)n * count / QEKF_BATCH_SIZE) % count];
+				for (int j = 0; j < 3; j++) {
+					accelerometer[j][n] = sample.accelerometer[j];
+					gyroscope[j][n] = sample.gyroscope[j];
+				}
+			}
+			batch->Step(accelerometer, gyroscope, params.estimator.EstimateBias, params.estimator.CreateQdotFromQDifference,
+						params.estimator.cov_acc_mpu, params.estimator.cov_gyro_mpu, params.estimator.sigma2_bias, dt);
+		}
+		elapsed += std::chrono::steady_clock::now() - start;
+
+		float Cov_q[4*4];
+		batch->GetQuaternionCovariance(0, Cov_q);
+		Condition(Cov_q, result);
+		if (end > CONVERGENCE_SAMPLES) {
+			float q[4];
+			batch->GetQuaternion(0, q);
+			Tilt(q, samples[end - 1].q, result);
+		}
+	}
+
+	batch->~QEKFBatch();
+	result.nsPerStep = std::chrono::duration<double, std::nano>(elapsed).count() / count / QEKF_BATCH_SIZE;
+	return result;
+}
+
+/* Madgwick filter as used by the balance loop, updated at sampleRate with every SAMPLE_RATE/sampleRate'th sample.
+ * The filter is constructed with sampleFrequency, which only equals sampleRate when the filter integrates with the true sample period.
+ * It has no covariance and does not estimate the gyro bias. */
+static Result_t RunMadgwick(const Sample_t * samples, int count, float sampleRate, float sampleFrequency, float beta, const char * name)
+{
+	Result_t result;
+	Initialize(result, name);
+	const int decimation = (int)(SAMPLE_RATE / sampleRate + 0.5);
+
+	Madgwick madgwick(sampleFrequency, beta);
+	madgwick.Reset();
+
+	std::chrono::steady_clock::duration elapsed(0);
+	int steps = 0;
+	for (int k = 0; k < count; k += CONDITION_INTERVAL) {
+		int end = (k + CONDITION_INTERVAL < count) ? k + CONDITION_INTERVAL : count;
+		auto start = std::chrono::steady_clock::now();
+		for (int i = k; i < end; i++) {
+			if (i % decimation) continue;
+			madgwick.updateIMU(samples[i].gyroscope[0], samples[i].gyroscope[1], samples[i].gyroscope[2],
+							   samples[i].accelerometer[0], samples[i].accelerometer[1], samples[i].accelerometer[2]);
+			steps++;
+		}
+		elapsed += std::chrono::steady_clock::now() - start;
+
+		if (end > CONVERGENCE_SAMPLES) {
+			int last = (end - 1) / decimation * decimation; // sample of the latest update
+			float q[4];
+			madgwick.getQuaternion(q);
+			Tilt(q, samples[last].q, result);
+		}
+	}
+
+	result.nsPerStep = std::chrono::duration<double, std::nano>(elapsed).count() / steps;
+	return result;
+}
+
+#define JACOBIAN_STATES		1000 // random states at which the steady state acceleration Jacobians are checked
+#define JACOBIAN_STEP		1E-3f // finite difference step of the quaternion elements [-] and COM offsets [m]
+#define JACOBIAN_TOLERANCE	1E-3 // largest deviation from the finite differences, relative to the largest Jacobian entry
+
+/* Compare the dual number Jacobians of SteadyStateAcceleration_Jacobian with central finite differences of the generated
+ * SteadyStateAcceleration model (which they are linearized from with Jw = 0 and dx = dy = 0) at random attitudes and COM offsets */
+static bool JacobianTest(const Parameters& params, double& maxDeviation)
+{
+	const float Jk = params.model.Jk, Mb = params.model.Mb, Mk = params.model.Mk, g = params.model.g, rk = params.model.rk, rw = params.model.rw, l = params.model.l;
+	maxDeviation = 0;
+
+	for (int n = 0; n < JACOBIAN_STATES; n++) {
+		/* Random attitude within 30 degrees of upright around a random axis, and a random COM offset within 5 cm */
+		double axis[3] = {Gaussian(), Gaussian(), Gaussian()};
+		double axisNorm = sqrt(axis[0]*axis[0] + axis[1]*axis[1] + axis[2]*axis[2]);
+		double angle = (2*Uniform() - 1) * M_PI / 6;
+		float q[4] = {(float)cos(angle/2), (float)(sin(angle/2)*axis[0]/axisNorm), (float)(sin(angle/2)*axis[1]/axisNorm), (float)(sin(angle/2)*axis[2]/axisNorm)};
+		float COM[2] = {(float)(0.1*Uniform() - 0.05), (float)(0.1*Uniform() - 0.05)};
+
+		float dAcceleration_dq[8], dAcceleration_dCOM[4];
+		SteadyStateAcceleration_Jacobian(COM[0], COM[1], l, Jk, Mb, Mk, g, q[0], q[1], q[2], q[3], rk, dAcceleration_dq, dAcceleration_dCOM);
+
+		/* Finite differences with respect to {q1, q2, q3, q4, COM_X, COM_Y} */
+		float x[6] = {q[0], q[1], q[2], q[3], COM[0], COM[1]};
+		double difference[2][6];
+		for (int j = 0; j < 6; j++) {
+			float plus[6], minus[6], accelerationPlus[2], accelerationMinus[2];
+			memcpy(plus, x, sizeof(plus));
+			memcpy(minus, x, sizeof(minus));
+			plus[j] += JACOBIAN_STEP;
+			minus[j] -= JACOBIAN_STEP;
+			SteadyStateAcceleration(plus[4], plus[5], l, Jk, 0, Mb, Mk, 0, 0, g, plus[0], plus[1], plus[2], plus[3], rk, rw, accelerationPlus);
+			SteadyStateAcceleration(minus[4], minus[5], l, Jk, 0, Mb, Mk, 0, 0, g, minus[0], minus[1], minus[2], minus[3], rk, rw, accelerationMinus);
+			for (int i = 0; i < 2; i++)
+				difference[i][j] = ((double)accelerationPlus[i] - accelerationMinus[i]) / ((double)plus[j] - minus[j]);
+		}
+
+		double largest = 0, deviation = 0;
+		for (int i = 0; i < 2; i++) {
+			for (int j = 0; j < 6; j++) {
+				double jacobian = (j < 4) ? dAcceleration_dq[4*i + j] : dAcceleration_dCOM[2*i + (j - 4)];
+				largest = fmax(largest, fabs(difference[i][j]));
+				deviation = fmax(deviation, fabs(jacobian - difference[i][j]));
+			}
+		}
+		maxDeviation = fmax(maxDeviation, deviation / largest);
+	}
+
+	return maxDeviation < JACOBIAN_TOLERANCE;
+}
+
+int main(int argc, char ** argv)
+{
+	int count = (argc > 1) ? atoi(argv[1]) : 200000;
+	if (count <= CONVERGENCE_SAMPLES) {
+		fprintf(stderr, "At least %d samples are required\n", CONVERGENCE_SAMPLES + 1);
+		return 1;
+	}
+
+	Parameters params;
+
+	/* The benchmark is only meaningful if the estimators pass their unit tests */
+	QEKF qEKF(params);
+	MEKF mEKF(params);
+	static uint8_t batchMemory[sizeof(QEKFBatch)] __attribute__((aligned(sizeof(QEKFBatch_lane_t))));
+	QEKFBatch * batch = new (batchMemory) QEKFBatch(params);
+	bool qEKFPassed = qEKF.UnitTest();
+	bool mEKFPassed = mEKF.UnitTest();
+	bool batchPassed = batch->UnitTest();
+	batch->~QEKFBatch();
+	printf("Unit tests: QEKF %s, MEKF %s, QEKFBatch (%d instances) %s\n", qEKFPassed ? "passed" : "FAILED", mEKFPassed ? "passed" : "FAILED",
+		   QEKF_BATCH_SIZE, batchPassed ? "passed" : "FAILED");
+	if (!qEKFPassed || !mEKFPassed || !batchPassed) return 1;
+
+	Sample_t * samples = new Sample_t[count];
+	Simulate(params, samples, count);
+
+	/* After the simulation, since it draws from the same random sequence */
+	double jacobianDeviation;
+	bool jacobianPassed = JacobianTest(params, jacobianDeviation);
+	printf("Steady state acceleration Jacobians (dq, dCOM) vs finite differences at %d states: %s, max deviation %.1e relative\n", JACOBIAN_STATES,
+		   jacobianPassed ? "passed" : "FAILED", jacobianDeviation);
+	if (!jacobianPassed) {
+		delete[] samples;
+		return 1;
+	}
+	printf("%d samples at %.0f Hz (%.0f s)\n", count, SAMPLE_RATE, count / SAMPLE_RATE);
+
+	Result_t reference = RunGeneratedQEKF(params, samples, count);
+	Print(reference, reference.nsPerStep);
+	Print(Run<QEKF>(params, samples, count, false, "QEKF (packed P)"), reference.nsPerStep);
+	Print(Run<QEKF>(params, samples, count, true, "QEKF (packed P, Joseph form)"), reference.nsPerStep);
+	Print(Run<MEKF>(params, samples, count, false, "MEKF"), reference.nsPerStep);
+	Print(Run<MEKF>(params, samples, count, true, "MEKF (Joseph form)"), reference.nsPerStep);
+	Print(RunQEKFBatch(params, samples, count), reference.nsPerStep);
+	Print(RunMadgwick(samples, count, params.controller.SampleRate, params.controller.SampleRate, params.estimator.MadgwickBeta, "Madgwick"), reference.nsPerStep);
+	Print(RunMadgwick(samples, count, params.controller.SampleRate, sampleFreqDef, params.estimator.MadgwickBeta, "Madgwick (dt of sampleFreqDef)"), reference.nsPerStep);
+
+	delete[] samples;
+	return 0;
+}
@@ -0,0 +1,24 @@
+#!/bin/sh
+# Build the estimator benchmark for the host from the firmware sources, with the stand-ins of Tools/SensorReplay/host for the hardware and RTOS dependencies
+cd "$(dirname "$0")"
+LIB=../../KugleFirmware/Libraries
+CXX=${CXX:-g++}
+# QEKFBatch is only vectorized with the SIMD instructions of the target, eg. BATCH_FLAGS="-O3 -mavx512f -mfma -fno-math-errno -DQEKF_BATCH_SIZE=16"
+BATCH_FLAGS=${BATCH_FLAGS:-"-O3 -march=native -fno-math-errno"}
+
+INCLUDES="-I../SensorReplay/host -I$LIB/Modules/Debug -I$LIB/Modules/Parameters -I$LIB/Devices/LSPC \
+	-I$LIB/Modules/Estimators/QEKF -I$LIB/Modules/Estimators/QEKF/MATLABCoder -I$LIB/Modules/Estimators/MEKF -I$LIB/Modules/Estimators/MadgwickAHRS/src \
+	-I$LIB/Modules/Estimators/VelocityEKF -I$LIB/Modules/Estimators/VelocityEKF/MATLABCoder -I$LIB/Misc/Dual \
+	-I$LIB/Misc/Matrix -I$LIB/Misc/Quaternion -I$LIB/Misc/Math -I$LIB/Misc/MATLABCoderInit -I$LIB/Misc/StaticArena"
+
+SOURCES="EstimatorBenchmark.cpp $LIB/Modules/Parameters/Parameters.cpp \
+	$LIB/Modules/Estimators/QEKF/QEKF.cpp $LIB/Modules/Estimators/QEKF/MATLABCoder/*.cpp $LIB/Modules/Estimators/MEKF/MEKF.cpp $LIB/Modules/Estimators/MadgwickAHRS/src/MadgwickAHRS.cpp \
+	$LIB/Modules/Estimators/VelocityEKF/SteadyStateAccelerationJacobian.cpp $LIB/Modules/Estimators/VelocityEKF/MATLABCoder/SteadyStateAcceleration.cpp \
+	$LIB/Misc/Matrix/*.cpp $LIB/Misc/Quaternion/Quaternion.cpp $LIB/Misc/Math/Math.cpp $LIB/Misc/MATLABCoderInit/*.cpp $LIB/Misc/StaticArena/StaticArena.cpp"
+
+# The batch size has to be the same in every translation unit, so the -D options of BATCH_FLAGS are passed to all of them
+DEFINES=$(for flag in $BATCH_FLAGS; do case $flag in -D*) printf '%s ' "$flag";; esac; done)
+
+$CXX -std=gnu++11 $BATCH_FLAGS -Wall -Wextra $INCLUDES -c $LIB/Modules/Estimators/QEKF/QEKFBatch.cpp -o QEKFBatch.o && \
+$CXX -std=gnu++11 -O2 -Wall -Wextra $DEFINES $INCLUDES $SOURCES QEKFBatch.o -o EstimatorBenchmark && \
+rm -f QEKFBatch.o
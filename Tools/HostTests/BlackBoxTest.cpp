@@ -0,0 +1,196 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+
+
+/* Host test of the black box recorder (BlackBox.cpp) with its task on the deterministic FreeRTOS stand-in of host/rtos.
+ *
+ * The test task records a sample every 5 ms like the balance controller and talks to the recorder through BlackBoxCommand and
+ * BlackBoxInfo messages over host LSPC sockets. Every record carries its sample number, such that the test checks:
+ *  - the recording starts with the oldest record and is in order after the circular buffer has wrapped around, also when it
+ *    wrapped exactly at the end
+ *  - the window of BLACKBOX_POST_TRIGGER_RECORDS records after the trigger, the trigger record index and the trigger cause,
+ *    where later triggers are ignored
+ *  - the recording is kept (Arm refused, further records ignored) until it has been dumped and the PC arms the recorder again
+ * It also prints the time of Record reported in BlackBoxInfo. On the host DWT->CYCCNT counts nanoseconds of the PC clock,
+ * so the numbers only show that the measurement works; the cycle count of the target is read from BlackBoxInfo on the robot.
+ * Build with build.sh.
+ */
+
+#include "BlackBox.h"
+#include "Priorities.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TEST_PRIORITY		BALANCE_CONTROLLER_PRIORITY
+#define SAMPLE_TIME			5 // ms, 200 Hz balance loop
+#define SAMPLE_US			(SAMPLE_TIME * 1000)
+
+static int failures = 0;
+
+#define CHECK(condition, ...) do { if (!(condition)) { printf("FAILED: " __VA_ARGS__); printf("\n"); failures++; } } while (0)
+
+static LSPC pc;
+static LSPC robot;
+static lspc::MessageTypesToPC::BlackBoxInfo_t info;
+static uint32_t infos = 0;
+static uint32_t readyInfos = 0; // sent by the recorder task when a recording became ready
+
+static void ToRobot(void * param, const uint8_t * frame, uint16_t length)
+{
+	(void)param;
+	robot.Deliver(frame, length);
+}
+
+static void ToPC(void * param, const uint8_t * frame, uint16_t length)
+{
+	(void)param;
+	pc.Deliver(frame, length);
+}
+
+static void BlackBoxInfo_Callback(void * param, const std::vector<uint8_t>& payload)
+{
+	(void)param;
+	if (payload.size() != sizeof(info)) return;
+	memcpy(&info, payload.data(), sizeof(info));
+	infos++;
+}
+
+/* Send a BlackBoxCommand from the PC, which is answered with a BlackBoxInfo */
+static void Command(lspc::BlackBoxTypes::command_t command)
+{
+	lspc::MessageTypesFromPC::BlackBoxCommand_t msg;
+	msg.command = command;
+	uint32_t count = infos;
+	pc.TransmitAsync(lspc::MessageTypesFromPC::BlackBoxCommand, (const uint8_t *)&msg, sizeof(msg));
+	CHECK(infos == count + 1, "BlackBoxCommand %u not answered", command);
+}
+
+/* Record a sample of the balance loop and wait for the next one */
+static void Sample(BlackBox& blackBox, uint32_t sample)
+{
+	lspc::BlackBoxTypes::Record_t record;
+	memset(&record, 0, sizeof(record));
+	record.time = sample * SAMPLE_US;
+	record.mode = (uint8_t)sample;
+	record.compute_time = (float)sample;
+	blackBox.Record(record);
+
+	uint32_t count = infos;
+	osDelay(SAMPLE_TIME);
+	if (infos != count && info.state == lspc::BlackBoxTypes::READY) readyInfos++;
+}
+
+/* Record from the first sample until the recording is ready, with the trigger before the given sample
+ * @retval	last sample recorded */
+static uint32_t RecordUntilReady(BlackBox& blackBox, uint32_t first, uint32_t triggerSample, lspc::BlackBoxTypes::trigger_t cause)
+{
+	uint32_t sample;
+	for (sample = first; sample < triggerSample + 2 * BLACKBOX_RECORDS; sample++) {
+		if (sample == triggerSample) {
+			if (cause == lspc::BlackBoxTypes::MANUAL) Command(lspc::BlackBoxTypes::TRIGGER);
+			else blackBox.Trigger(cause);
+		}
+		if (sample == triggerSample + 1) {
+			blackBox.Trigger(lspc::BlackBoxTypes::NAN_TORQUE); // only the first trigger is used
+			CHECK(!blackBox.Arm(), "recorder armed while the trigger window is being recorded");
+		}
+		Sample(blackBox, sample);
+		if (readyInfos) break;
+	}
+	return sample;
+}
+
+/* Check the recording against the samples which should have been kept */
+static void CheckRecording(BlackBox& blackBox, const char * name, uint32_t firstSample, uint32_t records, uint32_t triggerSample, lspc::BlackBoxTypes::trigger_t cause, uint32_t readySample)
+{
+	printf("%-20s %4u records from sample %u, trigger record %u, ready after sample %u\n", name, info.records, firstSample, info.triggerRecord, readySample);
+	CHECK(readyInfos == 1 && info.state == lspc::BlackBoxTypes::READY, "%s: recording not announced as ready", name);
+	CHECK(readySample == triggerSample + BLACKBOX_POST_TRIGGER_RECORDS, "%s: ready after sample %u, %u samples after the trigger", name, readySample, readySample - triggerSample);
+	CHECK(info.trigger == cause, "%s: trigger %u, expected %u", name, info.trigger, cause);
+	CHECK(info.records == records && info.triggerRecord == triggerSample - firstSample, "%s: %u records with the trigger at %u, expected %u records with the trigger at %u",
+		  name, info.records, info.triggerRecord, records, triggerSample - firstSample);
+	CHECK(info.recordSize == sizeof(lspc::BlackBoxTypes::Record_t), "%s: record size %u", name, info.recordSize);
+
+	/* Records after the end of the window are not stored */
+	for (uint32_t sample = readySample + 1; sample < readySample + 10; sample++)
+		Sample(blackBox, sample);
+
+	uint32_t size;
+	const lspc::BlackBoxTypes::Record_t * recording = (const lspc::BlackBoxTypes::Record_t *)blackBox.GetRecording(size);
+	CHECK(recording && size == records * sizeof(lspc::BlackBoxTypes::Record_t), "%s: recording of %u bytes", name, size);
+	if (!recording) return;
+	uint32_t disordered = 0;
+	for (uint32_t i = 0; i < size / sizeof(lspc::BlackBoxTypes::Record_t); i++)
+		if (recording[i].time != (firstSample + i) * SAMPLE_US || recording[i].mode != (uint8_t)(firstSample + i) || recording[i].compute_time != (float)(firstSample + i))
+			disordered++;
+	CHECK(disordered == 0, "%s: %u records out of order", name, disordered);
+	CHECK(recording[info.triggerRecord].time == triggerSample * SAMPLE_US, "%s: trigger record of sample %u", name, recording[info.triggerRecord].time / SAMPLE_US);
+}
+
+/* The PC arms the recorder after the dump, which discards the recording */
+static void Rearm(BlackBox& blackBox)
+{
+	Command(lspc::BlackBoxTypes::ARM);
+	uint32_t size;
+	CHECK(info.state == lspc::BlackBoxTypes::RECORDING && info.records == 0 && info.maxRecordCycles == 0, "state %u with %u records after arming", info.state, info.records);
+	CHECK(blackBox.GetRecording(size) == 0 && size == 0, "recording still available after arming");
+	readyInfos = 0;
+}
+
+int main(void)
+{
+	HostScheduler& scheduler = HostScheduler::Get();
+	scheduler.Attach(TEST_PRIORITY);
+
+	pc.Connect(&ToRobot, 0);
+	robot.Connect(&ToPC, 0);
+	pc.registerCallback(lspc::MessageTypesToPC::BlackBoxInfo, &BlackBoxInfo_Callback);
+	BlackBox * blackBox = new BlackBox(robot, BLACKBOX_PRIORITY); // never deleted, since the thread of its task can not be ended
+
+	/* The buffer wraps around several times before the trigger */
+	uint32_t trigger = 3000;
+	uint32_t ready = RecordUntilReady(*blackBox, 0, trigger, lspc::BlackBoxTypes::TILT_LIMIT);
+	CheckRecording(*blackBox, "wrapped", trigger + BLACKBOX_POST_TRIGGER_RECORDS + 1 - BLACKBOX_RECORDS, BLACKBOX_RECORDS, trigger, lspc::BlackBoxTypes::TILT_LIMIT, ready);
+
+	Command(lspc::BlackBoxTypes::INFO);
+	printf("Record of %u bytes at %u Hz: %u ns latest, %u ns max (PC clock in place of DWT->CYCCNT)\n", (unsigned int)sizeof(lspc::BlackBoxTypes::Record_t),
+		   1000 / SAMPLE_TIME, info.recordCycles, info.maxRecordCycles);
+	CHECK(info.maxRecordCycles > 0 && info.maxRecordCycles >= info.recordCycles, "Record time %u, maximum %u", info.recordCycles, info.maxRecordCycles);
+
+	/* Manual trigger before the buffer is full, the recording starts at the first record after arming */
+	Rearm(*blackBox);
+	trigger = 5100;
+	ready = RecordUntilReady(*blackBox, 5000, trigger, lspc::BlackBoxTypes::MANUAL);
+	CheckRecording(*blackBox, "not wrapped", 5000, trigger - 5000 + 1 + BLACKBOX_POST_TRIGGER_RECORDS, trigger, lspc::BlackBoxTypes::MANUAL, ready);
+
+	/* The buffer is full exactly when the window ends, so the head is back at the start */
+	Rearm(*blackBox);
+	trigger = 7000 + BLACKBOX_RECORDS - 1 - BLACKBOX_POST_TRIGGER_RECORDS;
+	ready = RecordUntilReady(*blackBox, 7000, trigger, lspc::BlackBoxTypes::NAN_TORQUE);
+	CheckRecording(*blackBox, "wrapped at the end", 7000, BLACKBOX_RECORDS, trigger, lspc::BlackBoxTypes::NAN_TORQUE, ready);
+
+	if (failures) {
+		printf("BlackBoxTest: %d checks FAILED\n", failures);
+		return 1;
+	}
+	printf("BlackBoxTest: passed\n");
+	return 0;
+}
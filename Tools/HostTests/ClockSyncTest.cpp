@@ -0,0 +1,163 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+ 
+
+/* Host test of the clock synchronization of ClockSync.cpp over a simulated USB link. The PC sends a request every
+ * 250 ms like LSPCCapture, the robot clock runs 80 ppm fast with a temperature drift of +-2 ppm, and the link has a
+ * fixed latency, exponential jitter and occasional queueing delays of up to 3 ms in either direction. Half way the PC
+ * clock is stepped by half a second, eg. by NTP. Between the exchanges the robot time of a random instant is converted to
+ * the PC clock like a telemetry time stamp and compared with the true PC time. The test prints the RMS and largest error
+ * after the estimate has converged at the start and after the step, and checks:
+ *  - the error stays below CLOCKSYNC_TEST_TOLERANCE once converged, and the clocks are reported as synchronized
+ *  - the estimate converges within CLOCKSYNC_TEST_SETTLING exchanges, also after the step, where the exchanges are
+ *    rejected as outliers until CLOCKSYNC_MAX_REJECTIONS restarts the estimate
+ *  - the estimated drift follows the rate of the robot clock. It lags the temperature drift by about a ppm, which only
+ *    adds a fraction of a microsecond to the time stamps between two exchanges.
+ * Build with build.sh.
+ */
+
+#include "ClockSync.h"
+
+#include <stdio.h>
+#include <math.h>
+#include <vector>
+
+#define CLOCKSYNC_TEST_PERIOD		250e3 // microseconds between exchanges, CAPTURE_SYNC_INTERVAL of LSPCCapture
+#define CLOCKSYNC_TEST_EXCHANGES	9600 // 40 minutes
+#define CLOCKSYNC_TEST_STEP			0.5e6 // step of the PC clock half way, in microseconds
+#define CLOCKSYNC_TEST_SKEW			80e-6 // rate of the robot clock relative to the true time minus one
+#define CLOCKSYNC_TEST_WANDER		2e-6 // amplitude of the temperature drift of the robot clock rate
+#define CLOCKSYNC_TEST_WANDER_PERIOD	2400e6 // microseconds
+#define CLOCKSYNC_TEST_TOLERANCE	50.0 // microseconds
+#define CLOCKSYNC_TEST_SETTLING		120 // exchanges (30 seconds) allowed for convergence at the start and after the step
+#define CLOCKSYNC_TEST_DRIFT_TOLERANCE	1.5 // ppm, the estimate lags the temperature drift
+
+static int failures = 0;
+
+#define CHECK(condition, ...) do { if (!(condition)) { printf("FAILED: " __VA_ARGS__); printf("\n"); failures++; } } while (0)
+
+static uint32_t randomState = 12345;
+static double Random(void)
+{
+	randomState = randomState * 1103515245 + 12345;
+	return ((randomState >> 8) + 0.5) / 16777216.0;
+}
+
+/* One way delay of the link in microseconds */
+static double Delay(void)
+{
+	double delay = 125 - 60 * log(Random());
+	if (Random() < 0.1)
+		delay += 3000 * Random();
+	return delay;
+}
+
+/* Robot clock in microseconds at a true time since boot */
+static double Local(double t)
+{
+	return t * (1 + CLOCKSYNC_TEST_SKEW) + CLOCKSYNC_TEST_WANDER * CLOCKSYNC_TEST_WANDER_PERIOD / (2 * M_PI) * sin(2 * M_PI * t / CLOCKSYNC_TEST_WANDER_PERIOD);
+}
+
+/* Rate of the PC clock relative to the robot clock minus one in ppm, ie. the drift estimated by ClockSync */
+static double Drift(double t)
+{
+	double rate = 1 + CLOCKSYNC_TEST_SKEW + CLOCKSYNC_TEST_WANDER * cos(2 * M_PI * t / CLOCKSYNC_TEST_WANDER_PERIOD);
+	return (1 / rate - 1) * 1e6;
+}
+
+/* First exchange from which the error stays below the tolerance up to end */
+static int Converged(const std::vector<double>& errors, int begin, int end)
+{
+	int converged = begin;
+	for (int i = begin; i < end; i++)
+		if (errors[i] > CLOCKSYNC_TEST_TOLERANCE) converged = i + 1;
+	return converged;
+}
+
+/* RMS and largest error of the exchanges from begin to end */
+static void Statistics(const char * name, const std::vector<double>& errors, int begin, int end)
+{
+	double squares = 0, max = 0;
+	for (int i = begin; i < end; i++) {
+		squares += errors[i] * errors[i];
+		if (errors[i] > max) max = errors[i];
+	}
+	double rms = sqrt(squares / (end - begin));
+	printf("%-26s error RMS %5.1f us, max %5.1f us over %d exchanges\n", name, rms, max, end - begin);
+	CHECK(max < CLOCKSYNC_TEST_TOLERANCE, "%s: largest error %.1f us, tolerance %.0f us", name, max, CLOCKSYNC_TEST_TOLERANCE);
+}
+
+int main(void)
+{
+	const double reference0 = 1.5e15; // PC time at boot of the robot
+	const int stepAt = CLOCKSYNC_TEST_EXCHANGES / 2;
+
+	CHECK(ClockSync().UnitTest(), "ClockSync::UnitTest failed");
+
+	ClockSync sync;
+	std::vector<double> errors(CLOCKSYNC_TEST_EXCHANGES);
+	std::vector<bool> synchronized(CLOCKSYNC_TEST_EXCHANGES);
+	double maxDriftError = 0;
+	int rejected = 0;
+	double step = 0;
+
+	for (int i = 0; i < CLOCKSYNC_TEST_EXCHANGES; i++) {
+		if (i == stepAt) step = CLOCKSYNC_TEST_STEP;
+
+		double t1 = 1e6 + i * CLOCKSYNC_TEST_PERIOD + 1000 * Random(); // true time since boot
+		double t2 = t1 + Delay();
+		double t3 = t2 + 20 + 100 * Random(); // processing in the LSPC task
+		double t4 = t3 + Delay();
+		if (!sync.Update((uint64_t)(reference0 + step + t1), (uint64_t)Local(t2), (uint64_t)Local(t3), (uint64_t)(reference0 + step + t4)))
+			rejected++;
+
+		double t = t4 + CLOCKSYNC_TEST_PERIOD * Random(); // telemetry time stamp before the next exchange
+		errors[i] = fabs((double)(int64_t)(sync.ToReference((uint64_t)Local(t)) - (uint64_t)(reference0 + step + t)));
+		synchronized[i] = sync.IsSynchronized();
+
+		bool settled = (i >= CLOCKSYNC_TEST_SETTLING && i < stepAt) || i >= stepAt + CLOCKSYNC_TEST_SETTLING;
+		if (settled && fabs(sync.GetDrift() - Drift(t)) > maxDriftError)
+			maxDriftError = fabs(sync.GetDrift() - Drift(t));
+	}
+
+	int converged = Converged(errors, 0, stepAt);
+	int recovered = Converged(errors, stepAt, CLOCKSYNC_TEST_EXCHANGES);
+	printf("Converged after %d exchanges at the start and %d after the step of %.1f s (%d exchanges rejected)\n",
+		   converged, recovered - stepAt, CLOCKSYNC_TEST_STEP * 1e-6, rejected);
+	CHECK(converged <= CLOCKSYNC_TEST_SETTLING, "converged after %d exchanges at the start", converged);
+	CHECK(recovered - stepAt <= CLOCKSYNC_TEST_SETTLING, "converged %d exchanges after the step", recovered - stepAt);
+	CHECK(recovered - stepAt >= CLOCKSYNC_MAX_REJECTIONS - 1, "the step was followed after %d exchanges, before the estimate was restarted", recovered - stepAt);
+
+	Statistics("After convergence", errors, CLOCKSYNC_TEST_SETTLING, stepAt);
+	Statistics("After the step", errors, stepAt + CLOCKSYNC_TEST_SETTLING, CLOCKSYNC_TEST_EXCHANGES);
+	printf("Largest drift error %.3f ppm at a drift of %.0f +- %.0f ppm\n", maxDriftError, Drift(0) + CLOCKSYNC_TEST_WANDER * 1e6, CLOCKSYNC_TEST_WANDER * 1e6);
+	CHECK(maxDriftError < CLOCKSYNC_TEST_DRIFT_TOLERANCE, "largest drift error %.3f ppm", maxDriftError);
+
+	int unsynchronized = 0;
+	for (int i = 0; i < CLOCKSYNC_TEST_EXCHANGES; i++)
+		if (((i >= CLOCKSYNC_TEST_SETTLING && i < stepAt) || i >= stepAt + CLOCKSYNC_TEST_SETTLING) && !synchronized[i]) unsynchronized++;
+	CHECK(unsynchronized == 0, "not synchronized at %d exchanges after convergence", unsynchronized);
+
+	if (failures) {
+		printf("ClockSyncTest: %d checks FAILED\n", failures);
+		return 1;
+	}
+	printf("ClockSyncTest: passed\n");
+	return 0;
+}
@@ -0,0 +1,387 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+
+
+/* Host round trip test of the compact telemetry format: the encoder of the firmware (Telemetry::Transmit and EncodeCompact)
+ * sends the messages over a host LSPC socket, and CompactDecoder.h of the PC tools decodes them. Every decoded value is
+ * compared with the transmitted one, which has to be within half a quantization step. The test checks:
+ *  - key frames start every session and follow at least every TELEMETRY_KEY_FRAME_INTERVAL frames
+ *  - delta frames are zigzag encoded: a change of one step up or down takes a single byte per value
+ *  - FIELD_WRAPPING values (the time and the encoder angles) keep decoding when their step count wraps around at 2^31
+ *    and 2^32, in both directions
+ *  - CONSTANT fields are sent at the start of a session and again only in the frame where their checksum changes
+ *  - a value which can not be quantized is sent in the full format without breaking the delta chain
+ *  - after a lost frame the delta frames are skipped until the next key frame, from which the stream decodes again
+ *  - every frame carries the time base of its time stamp, and a change of the time base starts a key frame
+ * Build with build.sh.
+ */
+
+#include "Telemetry.h"
+#include "CompactDecoder.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
+
+#define FRAMES				2000
+#define SAMPLE_TIME			0.005f // 200 Hz balance loop
+#define LOST_FRAME			210 // frame of the encoder stream which the link drops
+
+static int failures = 0;
+
+#define CHECK(condition, ...) do { if (!(condition)) { printf("FAILED: " __VA_ARGS__); printf("\n"); failures++; } } while (0)
+
+static uint32_t randomState = 1234;
+static uint32_t Random(uint32_t range)
+{
+	randomState = randomState * 1103515245 + 12345;
+	return (randomState >> 8) % range;
+}
+
+static float RandomSigned(float range)
+{
+	return range * ((float)Random(2000001) / 1000000.0f - 1.0f);
+}
+
+/* PC side: the packages delivered by the link and the result of decoding the latest one */
+static LSPC pc;
+static CompactDecoder decoder;
+static bool dropNext = false;
+
+static struct {
+	bool compact; // a CompactTelemetry package was received
+	bool full; // a message in the full format was received
+	uint8_t flags;
+	uint16_t length; // of the CompactTelemetry package
+	uint8_t type;
+	uint16_t size; // of the decoded message, 0 if it was not decoded
+	uint8_t msg[LSPC_MAXIMUM_PACKAGE_LENGTH];
+} received;
+
+static void Link(void * param, const uint8_t * frame, uint16_t length)
+{
+	(void)param;
+	if (dropNext) {
+		dropNext = false;
+		return;
+	}
+	pc.Deliver(frame, length);
+}
+
+static void CompactTelemetry_Callback(void * param, const std::vector<uint8_t>& payload)
+{
+	(void)param;
+	received.compact = true;
+	received.flags = (payload.size() >= sizeof(lspc::TelemetryTypes::Compact_t)) ? payload[1] : 0;
+	received.length = payload.size();
+	received.size = decoder.Decode(payload.data(), payload.size(), received.type, received.msg, sizeof(received.msg));
+}
+
+static void Full_Callback(void * param, const std::vector<uint8_t>& payload)
+{
+	(void)param;
+	received.full = true;
+	memcpy(received.msg, payload.data(), payload.size() < sizeof(received.msg) ? payload.size() : sizeof(received.msg));
+}
+
+typedef struct {
+	uint32_t frames; // received
+	uint32_t decoded;
+	uint32_t mismatches; // decoded values further than half a step from the transmitted value
+	uint32_t keyFrames;
+	uint32_t constantsFrames;
+	uint32_t maxKeyFrameGap;
+	uint32_t sinceKeyFrame;
+	uint32_t keyBytes;
+	uint32_t deltaBytes;
+} Result_t;
+
+/* Compare the decoded message with the transmitted one using the field table of the message type */
+static bool Matches(uint8_t type, const uint8_t * msg, const uint8_t * decoded)
+{
+	uint8_t fieldCount;
+	const lspc::TelemetryTypes::CompactField_t * fields = lspc::TelemetryTypes::GetCompactFields(type, fieldCount);
+	for (uint8_t i = 0; i < fieldCount; i++) {
+		const lspc::TelemetryTypes::CompactField_t& field = fields[i];
+		if (field.kind == lspc::TelemetryTypes::FIELD_UINT8) {
+			if (memcmp(&msg[field.offset], &decoded[field.offset], field.count)) return false;
+			continue;
+		}
+		if (field.kind == lspc::TelemetryTypes::FIELD_CONSTANT) {
+			if (memcmp(&msg[field.offset], &decoded[field.offset], field.count * sizeof(float))) return false;
+			continue;
+		}
+		for (uint8_t n = 0; n < field.count; n++) {
+			float value, result;
+			memcpy(&value, &msg[field.offset + n * sizeof(float)], sizeof(value));
+			memcpy(&result, &decoded[field.offset + n * sizeof(float)], sizeof(result));
+			if (fabsf(result - value) > 0.5f * field.resolution + fabsf(value) * FLT_EPSILON) return false;
+		}
+	}
+	return true;
+}
+
+/* Transmit a message of a compact stream and decode it on the PC
+ * @retval	true if the message was decoded */
+static bool Send(Telemetry& telemetry, lspc::MessageTypesToPC::MessageTypesToPC_t type, const void * msg, uint16_t length, Result_t& r, bool synchronizedTime = false)
+{
+	memset(&received, 0, sizeof(received));
+	if (!telemetry.Due(type) || !telemetry.Transmit(type, msg, length, synchronizedTime)) {
+		CHECK(false, "message of type 0x%02X not transmitted", type);
+		return false;
+	}
+	if (!received.compact) return false;
+
+	r.frames++;
+	if (received.flags & lspc::TelemetryTypes::COMPACT_KEY_FRAME) {
+		r.keyFrames++;
+		r.keyBytes += received.length;
+		r.sinceKeyFrame = 0;
+	} else {
+		r.deltaBytes += received.length;
+	}
+	if (++r.sinceKeyFrame > r.maxKeyFrameGap) r.maxKeyFrameGap = r.sinceKeyFrame;
+	if (received.flags & lspc::TelemetryTypes::COMPACT_CONSTANTS) r.constantsFrames++;
+	if (!received.size) return false;
+
+	r.decoded++;
+	if (received.type != type || received.size < length || !Matches(type, (const uint8_t *)msg, received.msg)) r.mismatches++;
+	return true;
+}
+
+static void Start(Telemetry& telemetry, lspc::MessageTypesToPC::MessageTypesToPC_t type)
+{
+	telemetry.Register(type, 1);
+	telemetry.SetFormat(type, lspc::TelemetryTypes::COMPACT);
+}
+
+static void PrintResult(const char * name, const Result_t& r)
+{
+	printf("%-15s %5u frames, %4u key frames of %5.1f bytes, delta frames of %5.1f bytes, %u with constants\n", name, r.frames, r.keyFrames,
+		   r.keyFrames ? (double)r.keyBytes / r.keyFrames : 0.0, (r.frames > r.keyFrames) ? (double)r.deltaBytes / (r.frames - r.keyFrames) : 0.0, r.constantsFrames);
+}
+
+/* The time and the accumulated encoder angles are WRAPPING fields of 1e-5 steps, whose step counts pass 2^31 (21474.8) and
+ * 2^32 (42949.7) during the run. Frame LOST_FRAME is dropped by the link. */
+static void TestEncoders(Telemetry& telemetry)
+{
+	Result_t r;
+	memset(&r, 0, sizeof(r));
+	Start(telemetry, lspc::MessageTypesToPC::RawSensor_Encoders);
+
+	lspc::MessageTypesToPC::RawSensor_Encoders_t msg;
+	double time = 42945.0; // s, about 12 hours after boot
+	double angle[3] = { 21474.0, 42948.0, -42948.0 }; // rad
+	const double velocity[3] = { 20.0, 40.0, -40.0 }; // rad/s
+
+	uint32_t lostDecoded = 0; // frames decoded between the lost frame and the next key frame
+	uint32_t resyncFrame = 0;
+	for (uint32_t frame = 0; frame < FRAMES; frame++) {
+		msg.time = (float)time;
+		msg.angle1 = (float)angle[0];
+		msg.angle2 = (float)angle[1];
+		msg.angle3 = (float)angle[2];
+
+		dropNext = (frame == LOST_FRAME);
+		uint32_t keyFrames = r.keyFrames;
+		bool decoded = Send(telemetry, lspc::MessageTypesToPC::RawSensor_Encoders, &msg, sizeof(msg), r);
+		if (frame > LOST_FRAME && !resyncFrame) {
+			if (r.keyFrames > keyFrames) resyncFrame = frame;
+			else if (decoded) lostDecoded++;
+		}
+		CHECK(decoded || (frame >= LOST_FRAME && resyncFrame == 0), "frame %u not decoded", frame);
+
+		time += SAMPLE_TIME;
+		for (int i = 0; i < 3; i++)
+			angle[i] += velocity[i] * SAMPLE_TIME + 0.01 * sin(0.1 * frame + i);
+	}
+
+	PrintResult("encoders", r);
+	printf("                lost frame %u, delta frames skipped until the key frame %u\n", LOST_FRAME, resyncFrame);
+	CHECK(msg.time > 42949.7f && msg.angle1 > 21474.9f && msg.angle2 > 42949.7f && msg.angle3 < -42949.7f, "the WRAPPING values did not pass the wrap arounds of their step counts");
+	CHECK(r.frames == FRAMES - 1, "%u of %u frames received", r.frames, FRAMES - 1);
+	CHECK(r.mismatches == 0, "%u decoded frames differ from the transmitted messages", r.mismatches);
+	CHECK(resyncFrame > LOST_FRAME && resyncFrame - LOST_FRAME <= TELEMETRY_KEY_FRAME_INTERVAL, "resynchronized at frame %u after losing frame %u", resyncFrame, LOST_FRAME);
+	CHECK(lostDecoded == 0, "%u delta frames decoded after the lost frame", lostDecoded);
+	CHECK(r.decoded == r.frames - (resyncFrame - LOST_FRAME - 1) && decoder.GetSkipped() == resyncFrame - LOST_FRAME - 1,
+		  "%u of %u frames decoded, %u skipped", r.decoded, r.frames, decoder.GetSkipped());
+	CHECK(r.maxKeyFrameGap <= TELEMETRY_KEY_FRAME_INTERVAL, "%u frames between key frames", r.maxKeyFrameGap);
+}
+
+/* Set every value of the message to a whole number of steps */
+static void SetSteps(lspc::MessageTypesToPC::StateEstimates_t& msg, int32_t steps)
+{
+	uint8_t fieldCount;
+	const lspc::TelemetryTypes::CompactField_t * fields = lspc::TelemetryTypes::GetCompactFields(lspc::MessageTypesToPC::StateEstimates, fieldCount);
+	for (uint8_t i = 0; i < fieldCount; i++)
+		for (uint8_t n = 0; n < fields[i].count; n++) {
+			float value = (float)((double)(steps + 1000 * i + 100 * n) * fields[i].resolution);
+			memcpy((uint8_t *)&msg + fields[i].offset + n * sizeof(float), &value, sizeof(value));
+		}
+}
+
+/* Random walk of FLOAT values, changes of a single step in both directions and a value which can not be quantized */
+static void TestStateEstimates(Telemetry& telemetry)
+{
+	Result_t r;
+	memset(&r, 0, sizeof(r));
+	Start(telemetry, lspc::MessageTypesToPC::StateEstimates);
+
+	lspc::MessageTypesToPC::StateEstimates_t msg;
+	memset(&msg, 0, sizeof(msg));
+	msg.q.w = 1;
+	for (uint32_t frame = 0; frame < FRAMES; frame++) {
+		msg.time = frame * SAMPLE_TIME;
+		msg.q.x += RandomSigned(1e-3f); msg.q.y += RandomSigned(1e-3f); msg.q.z += RandomSigned(1e-3f);
+		msg.dq.x = RandomSigned(0.05f); msg.dq.y = RandomSigned(0.05f); msg.dq.z = RandomSigned(0.05f);
+		msg.pos.x += RandomSigned(1e-3f); msg.pos.y += RandomSigned(1e-3f);
+		msg.vel.x = RandomSigned(0.5f); msg.vel.y = RandomSigned(0.5f);
+		msg.COM.z = 0.2f + RandomSigned(0.01f);
+		Send(telemetry, lspc::MessageTypesToPC::StateEstimates, &msg, sizeof(msg), r);
+	}
+	PrintResult("state estimates", r);
+
+	/* Zigzag encoding: a change of one step takes one byte per value, whether up or down */
+	uint8_t fieldCount, values = 0;
+	const lspc::TelemetryTypes::CompactField_t * fields = lspc::TelemetryTypes::GetCompactFields(lspc::MessageTypesToPC::StateEstimates, fieldCount);
+	for (uint8_t i = 0; i < fieldCount; i++) values += fields[i].count;
+	const int32_t steps[] = { 1000, 999, 1000, 1064, 1000 }; // changes of -1, +1, +64 (two bytes) and -64 (one byte)
+	const uint16_t lengths[] = { 0, 1, 1, 2, 1 }; // bytes per value of the delta frames
+	for (uint32_t i = 0; i < sizeof(steps) / sizeof(steps[0]); i++) {
+		SetSteps(msg, steps[i]);
+		bool decoded = Send(telemetry, lspc::MessageTypesToPC::StateEstimates, &msg, sizeof(msg), r);
+		if (i == 0) continue;
+		CHECK(decoded && !(received.flags & lspc::TelemetryTypes::COMPACT_KEY_FRAME) && received.length == sizeof(lspc::TelemetryTypes::Compact_t) + lengths[i] * values,
+			  "delta of %d steps: frame of %u bytes, expected %u", steps[i] - steps[i-1], received.length, (unsigned int)(sizeof(lspc::TelemetryTypes::Compact_t) + lengths[i] * values));
+	}
+
+	/* A value which can not be quantized is sent in the full format, and the next delta frame still refers to the last compact frame */
+	msg.q.w = NAN;
+	Send(telemetry, lspc::MessageTypesToPC::StateEstimates, &msg, sizeof(msg), r);
+	CHECK(received.full && !received.compact, "message with a NaN not sent in the full format");
+	msg.q.w = 1;
+	bool decoded = Send(telemetry, lspc::MessageTypesToPC::StateEstimates, &msg, sizeof(msg), r);
+	CHECK(decoded, "frame after a message in the full format not decoded");
+
+	CHECK(r.mismatches == 0, "%u decoded frames differ from the transmitted messages", r.mismatches);
+	CHECK(r.decoded == r.frames, "%u of %u frames decoded", r.decoded, r.frames);
+	CHECK(r.keyFrames >= 1 + (FRAMES - 1) / TELEMETRY_KEY_FRAME_INTERVAL && r.maxKeyFrameGap <= TELEMETRY_KEY_FRAME_INTERVAL, "%u key frames, %u frames between key frames",
+		  r.keyFrames, r.maxKeyFrameGap);
+}
+
+/* The covariances of the IMU message are CONSTANT fields */
+static void TestConstants(Telemetry& telemetry)
+{
+	Result_t r;
+	memset(&r, 0, sizeof(r));
+	Start(telemetry, lspc::MessageTypesToPC::RawSensor_IMU_MPU9250);
+
+	lspc::MessageTypesToPC::RawSensor_IMU_MPU9250_t msg;
+	memset(&msg, 0, sizeof(msg));
+	for (int i = 0; i < 9; i += 4) {
+		msg.accelerometer.cov[i] = 1e-3f;
+		msg.gyroscope.cov[i] = 1e-5f;
+		msg.magnetometer.cov[i] = 1e-2f;
+	}
+
+	const uint32_t changeFrame = 130, restartFrame = 170;
+	uint32_t constantsAt[4] = { 0, 0, 0, 0 }, constantsFrames = 0;
+	for (uint32_t frame = 0; frame < 200; frame++) {
+		msg.time = frame * SAMPLE_TIME;
+		msg.accelerometer.x = RandomSigned(1); msg.accelerometer.y = RandomSigned(1); msg.accelerometer.z = 9.82f + RandomSigned(0.2f);
+		msg.gyroscope.x = RandomSigned(0.1f); msg.gyroscope.y = RandomSigned(0.1f); msg.gyroscope.z = RandomSigned(0.1f);
+		msg.magnetometer.x = RandomSigned(0.5f); msg.magnetometer.y = RandomSigned(0.5f); msg.magnetometer.z = RandomSigned(0.5f);
+		if (frame == changeFrame) msg.gyroscope.cov[4] = 2e-5f; // recalibration
+		if (frame == restartFrame) telemetry.SetFormat(lspc::MessageTypesToPC::RawSensor_IMU_MPU9250, lspc::TelemetryTypes::COMPACT); // reconfigured by the PC
+
+		Send(telemetry, lspc::MessageTypesToPC::RawSensor_IMU_MPU9250, &msg, sizeof(msg), r);
+		if ((received.flags & lspc::TelemetryTypes::COMPACT_CONSTANTS) && constantsFrames < 4)
+			constantsAt[constantsFrames++] = frame;
+	}
+	PrintResult("IMU", r);
+
+	CHECK(constantsFrames == 3 && constantsAt[0] == 0 && constantsAt[1] == changeFrame && constantsAt[2] == restartFrame,
+		  "constants sent in %u frames (%u, %u, %u), expected 0, %u and %u", constantsFrames, constantsAt[0], constantsAt[1], constantsAt[2], changeFrame, restartFrame);
+	CHECK(r.mismatches == 0 && r.decoded == r.frames, "%u of %u frames decoded, %u differ from the transmitted messages", r.decoded, r.frames, r.mismatches);
+}
+
+/* The time of the ControllerInfo stream is in seconds since boot, about 8 hours after boot, until the clocks are synchronized
+ * at frame TIMEBASE_FRAMES. From then it is in seconds since the epoch given by the PC, which started the capture 2 seconds before,
+ * until the synchronization is lost at frame 2*TIMEBASE_FRAMES. Both jumps of the time are beyond the 2^31 steps of a delta. */
+#define TIMEBASE_FRAMES		60
+
+static void TestTimeBase(Telemetry& telemetry)
+{
+	Result_t r;
+	memset(&r, 0, sizeof(r));
+	Start(telemetry, lspc::MessageTypesToPC::ControllerInfo);
+
+	lspc::MessageTypesToPC::ControllerInfo_t msg;
+	memset(&msg, 0, sizeof(msg));
+	double bootTime = 30000.0;
+	double epochTime = 2.0;
+	uint32_t wrongBase = 0;
+	uint32_t keyFrameAt[2] = { 0, 0 };
+	for (uint32_t frame = 0; frame < 3 * TIMEBASE_FRAMES; frame++) {
+		bool synchronizedTime = (frame >= TIMEBASE_FRAMES && frame < 2 * TIMEBASE_FRAMES);
+		msg.time = (float)(synchronizedTime ? epochTime : bootTime);
+		msg.torque1 = RandomSigned(1.0f);
+		msg.compute_time = 1e-6f * Random(500);
+
+		uint32_t keyFrames = r.keyFrames;
+		bool decoded = Send(telemetry, lspc::MessageTypesToPC::ControllerInfo, &msg, sizeof(msg), r, synchronizedTime);
+		if (!decoded || (bool)(received.flags & lspc::TelemetryTypes::COMPACT_SYNCHRONIZED) != synchronizedTime ||
+			decoder.IsSynchronizedTime(lspc::MessageTypesToPC::ControllerInfo) != synchronizedTime)
+			wrongBase++;
+		if (r.keyFrames > keyFrames && frame % TIMEBASE_FRAMES == 0 && frame > 0)
+			keyFrameAt[frame / TIMEBASE_FRAMES - 1] = frame;
+
+		bootTime += SAMPLE_TIME;
+		epochTime += SAMPLE_TIME;
+	}
+	PrintResult("time base", r);
+
+	CHECK(wrongBase == 0, "%u frames not decoded with the time base they were sent with", wrongBase);
+	CHECK(keyFrameAt[0] == TIMEBASE_FRAMES && keyFrameAt[1] == 2 * TIMEBASE_FRAMES, "key frames at the time base changes %u and %u, expected %u and %u",
+		  keyFrameAt[0], keyFrameAt[1], TIMEBASE_FRAMES, 2 * TIMEBASE_FRAMES);
+	CHECK(r.mismatches == 0 && r.decoded == r.frames, "%u of %u frames decoded, %u differ from the transmitted messages", r.decoded, r.frames, r.mismatches);
+}
+
+int main(void)
+{
+	LSPC robot;
+	robot.Connect(&Link, 0);
+	pc.registerCallback(lspc::MessageTypesToPC::CompactTelemetry, &CompactTelemetry_Callback);
+	pc.registerCallback(lspc::MessageTypesToPC::StateEstimates, &Full_Callback);
+
+	Telemetry telemetry(robot);
+	TestEncoders(telemetry);
+	TestStateEstimates(telemetry);
+	TestConstants(telemetry);
+	TestTimeBase(telemetry);
+
+	if (failures) {
+		printf("CompactTelemetryTest: %d checks FAILED\n", failures);
+		return 1;
+	}
+	printf("CompactTelemetryTest: passed\n");
+	return 0;
+}
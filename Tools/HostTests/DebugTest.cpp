@@ -0,0 +1,298 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+
+
+/* Host test of the lock-free debug text path: Debug::Message, Notify and the transmitter thread of Debug.cpp with the
+ * firmware LSPC socket, running on the deterministic FreeRTOS stand-in and the USB model of host/rtos.
+ *
+ * Every message is a line with the name of its producer, its sequence number and a pattern, which the PC side checks:
+ *  - a message longer than a package is split up and arrives in one piece
+ *  - producer tasks below and above the priority of the transmitter thread interleave their messages, and every message
+ *    arrives once, in the order of its producer and unchanged
+ *  - the wakeups of the transmitter thread (task notifications) stay at most two per transmitted package, which carries
+ *    several messages
+ *  - a task which finds the text buffer full waits for room instead of dropping its messages
+ *  - messages from an interrupt are dropped when the buffer is full, and the transmitter reports the number dropped once,
+ *    after the messages which were stored
+ * Build with build.sh.
+ */
+
+#include "Debug.h"
+#include "LSPC.hpp"
+#include "cmsis_os.h"
+#include "USBCDC.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#define TEST_PRIORITY				2 // TEST_BENCH_PRIORITY, below the transmitter thread (DEBUG_MESSAGE_PRIORITY)
+#define PRODUCERS					3
+#define STEADY_MESSAGES				2000 // per producer
+#define STEADY_GAP					2000 // us, maximum pause between the messages of a producer
+#define BURST_MESSAGES				40 // of 200 bytes from one task, four times the text buffer
+#define INTERRUPT_MESSAGES			100 // of 60 bytes from one interrupt handler
+#define DRAIN_TIME					100 // ms for the link to carry everything stored
+
+static int failures = 0;
+
+#define CHECK(condition, ...) do { if (!(condition)) { printf("FAILED: " __VA_ARGS__); printf("\n"); failures++; } } while (0)
+
+static uint32_t randomState = 4711;
+static uint32_t Random(uint32_t range)
+{
+	randomState = randomState * 1103515245 + 12345;
+	return (randomState >> 8) % range;
+}
+
+/* PC side of the link, which collects the text of the Debug packages */
+class PCSocket : public lspc::SocketBase
+{
+	public:
+		PCSocket() : packages(0) {};
+
+		bool send(uint8_t type, const std::vector<uint8_t> &payload) override { (void)type; (void)payload; return false; };
+
+		static void Receive(void * param, const uint8_t * data, uint32_t length)
+		{
+			PCSocket * pc = (PCSocket *)param;
+			for (uint32_t i = 0; i < length; i++)
+				pc->processIncomingByte(data[i]);
+		}
+
+		std::string text;
+		uint32_t packages;
+};
+
+static PCSocket pc;
+
+static void Text_Callback(void * param, const std::vector<uint8_t>& payload)
+{
+	(void)param;
+	pc.text.append((const char *)payload.data(), payload.size());
+	pc.packages++;
+}
+
+/* Message of the given length (including the line feed) with the name of the producer, its sequence number and a pattern */
+static void SendMessage(char name, uint32_t sequence, uint32_t length)
+{
+	char msg[MAX_DEBUG_TEXT_LENGTH + 1];
+	int header = snprintf(msg, sizeof(msg), "%c %u ", name, (unsigned int)sequence);
+	uint32_t i;
+	for (i = header; i < length - 1; i++)
+		msg[i] = 'a' + (sequence + i) % 26;
+	msg[i++] = '\n';
+	msg[i] = 0;
+	Debug::Message(msg);
+}
+
+typedef struct {
+	uint32_t received[26]; // messages of each producer name
+	uint32_t next[26]; // expected sequence number
+	uint32_t missing[26]; // sequence numbers skipped
+	uint32_t disordered;
+	uint32_t corrupt;
+	uint32_t reports; // drop reports
+	uint32_t reportedDropped;
+	uint32_t receivedAfterReport; // messages after the latest drop report
+} Text_t;
+
+/* Check every line of the received text and clear it */
+static Text_t ParseText(void)
+{
+	Text_t t;
+	memset(&t, 0, sizeof(t));
+
+	size_t start = 0, end;
+	while ((end = pc.text.find('\n', start)) != std::string::npos) {
+		std::string line = pc.text.substr(start, end - start);
+		start = end + 1;
+		if (line.empty()) continue; // in front of a drop report
+
+		unsigned long dropped;
+		char closing;
+		if (sscanf(line.c_str(), "[%lu debug messages dropped%c", &dropped, &closing) == 2 && closing == ']') {
+			t.reports++;
+			t.reportedDropped += dropped;
+			t.receivedAfterReport = 0;
+			continue;
+		}
+
+		char name;
+		unsigned int sequence;
+		int header;
+		if (sscanf(line.c_str(), "%c %u %n", &name, &sequence, &header) != 2 || name < 'A' || name > 'Z') {
+			t.corrupt++;
+			continue;
+		}
+		bool intact = true;
+		for (size_t i = header; i < line.size(); i++)
+			if (line[i] != (char)('a' + (sequence + i) % 26)) intact = false;
+		if (!intact) t.corrupt++;
+
+		uint32_t n = name - 'A';
+		if (sequence < t.next[n]) t.disordered++;
+		else t.missing[n] += sequence - t.next[n];
+		t.next[n] = sequence + 1;
+		t.received[n]++;
+		t.receivedAfterReport++;
+	}
+	if (start != pc.text.size()) t.corrupt++; // unterminated line
+	pc.text.clear();
+	return t;
+}
+
+typedef struct {
+	char name;
+	uint32_t priority;
+	volatile bool done;
+} Producer_t;
+
+static void ProducerThread(void * param)
+{
+	Producer_t * producer = (Producer_t *)param;
+	HostScheduler& scheduler = HostScheduler::Get();
+
+	for (uint32_t i = 0; i < STEADY_MESSAGES; i++) {
+		SendMessage(producer->name, i, 10 + Random(30)); // several messages per package
+		scheduler.DelayUntil(scheduler.Now() + Random(STEADY_GAP));
+	}
+	producer->done = true;
+}
+
+static void BurstThread(void * param)
+{
+	Producer_t * producer = (Producer_t *)param;
+	for (uint32_t i = 0; i < BURST_MESSAGES; i++)
+		SendMessage(producer->name, i, 200);
+	producer->done = true;
+}
+
+/* A message longer than a package is split into records, which are transmitted in order */
+static void TestLongMessage(void)
+{
+	std::string msg;
+	for (int i = 0; i < 3 * MAX_DEBUG_TEXT_LENGTH - 17; i++)
+		msg += (char)('A' + i % 26);
+	msg += '\n';
+
+	Debug::Message(msg.c_str());
+	osDelay(DRAIN_TIME);
+	CHECK(pc.text == msg, "long message of %u characters received as %u characters", (unsigned int)msg.size(), (unsigned int)pc.text.size());
+	pc.text.clear();
+}
+
+/* Producers below (A, B) and above (C) the priority of the transmitter thread */
+static void TestProducers(void)
+{
+	static Producer_t producers[PRODUCERS] = { { 'A', 1, false }, { 'B', TEST_PRIORITY, false }, { 'C', 5, false } };
+
+	uint64_t notifications = HostScheduler::Get().NotificationsGiven();
+	uint32_t packages = pc.packages;
+	for (int p = 0; p < PRODUCERS; p++)
+		xTaskCreate(ProducerThread, "Producer", 256, &producers[p], producers[p].priority, 0);
+	while (!producers[0].done || !producers[1].done || !producers[2].done)
+		osDelay(10);
+	osDelay(DRAIN_TIME);
+	notifications = HostScheduler::Get().NotificationsGiven() - notifications;
+	packages = pc.packages - packages;
+
+	Text_t t = ParseText();
+	uint32_t messages = PRODUCERS * STEADY_MESSAGES;
+	printf("%u producers of %u messages: %u packages, %lu wakeups of the transmitter, %.2f per package, %.2f messages per package\n", PRODUCERS, STEADY_MESSAGES,
+		   packages, (unsigned long)notifications, (double)notifications / packages, (double)messages / packages);
+	for (int p = 0; p < PRODUCERS; p++) {
+		uint32_t n = producers[p].name - 'A';
+		CHECK(t.received[n] == STEADY_MESSAGES && t.missing[n] == 0, "producer %c: %u of %u messages received, %u missing",
+			  producers[p].name, t.received[n], STEADY_MESSAGES, t.missing[n]);
+	}
+	CHECK(t.disordered == 0 && t.corrupt == 0, "%u messages out of order, %u corrupt", t.disordered, t.corrupt);
+	CHECK(t.reports == 0, "%u messages reported dropped", t.reportedDropped);
+	/* Waking only when the buffer was empty or a package filled up batches the messages, a wakeup per message would not */
+	CHECK(notifications <= 2 * packages && 3 * notifications <= messages, "%lu wakeups for %u packages of %u messages", (unsigned long)notifications, packages, messages);
+}
+
+/* A task waits for room in the full buffer */
+static void TestFullBuffer(void)
+{
+	static Producer_t producer = { 'D', 5, false };
+	xTaskCreate(BurstThread, "Burst", 256, &producer, producer.priority, 0);
+	while (!producer.done)
+		osDelay(10);
+	osDelay(DRAIN_TIME);
+
+	Text_t t = ParseText();
+	printf("%u messages of 200 bytes from a task: %u received\n", BURST_MESSAGES, t.received['D' - 'A']);
+	CHECK(t.received['D' - 'A'] == BURST_MESSAGES && t.missing['D' - 'A'] == 0 && t.disordered == 0 && t.corrupt == 0,
+		  "%u of %u messages received, %u missing, %u out of order, %u corrupt", t.received['D' - 'A'], BURST_MESSAGES, t.missing['D' - 'A'], t.disordered, t.corrupt);
+	CHECK(t.reports == 0, "%u messages of a task reported dropped", t.reportedDropped);
+}
+
+/* An interrupt handler does not wait: the messages which do not fit are dropped and reported after the stored ones */
+static void TestInterruptOverflow(void)
+{
+	HostInterrupt(1);
+	for (uint32_t i = 0; i < INTERRUPT_MESSAGES; i++)
+		SendMessage('I', i, 60);
+	HostInterrupt(0);
+	osDelay(DRAIN_TIME);
+
+	/* Nothing more is dropped, so the next message is not followed by another report */
+	SendMessage('J', 0, 20);
+	osDelay(DRAIN_TIME);
+
+	Text_t t = ParseText();
+	uint32_t received = t.received['I' - 'A'];
+	printf("%u messages of 60 bytes from an interrupt: %u received, %u reported dropped\n", INTERRUPT_MESSAGES, received, t.reportedDropped);
+	CHECK(received > 0 && received < INTERRUPT_MESSAGES && t.missing['I' - 'A'] == 0, "%u of %u messages received, %u missing in between",
+		  received, INTERRUPT_MESSAGES, t.missing['I' - 'A']);
+	CHECK(t.reports == 1 && t.reportedDropped == INTERRUPT_MESSAGES - received, "%u reports of %u dropped messages, %u were dropped",
+		  t.reports, t.reportedDropped, INTERRUPT_MESSAGES - received);
+	CHECK(t.received['J' - 'A'] == 1 && t.receivedAfterReport == 1, "%u messages after the drop report", t.receivedAfterReport);
+	CHECK(t.disordered == 0 && t.corrupt == 0, "%u messages out of order, %u corrupt", t.disordered, t.corrupt);
+}
+
+int main(void)
+{
+	HostScheduler& scheduler = HostScheduler::Get();
+	scheduler.Attach(TEST_PRIORITY);
+
+	USBCDC usb;
+	LSPC * lspc = new LSPC(&usb, LSPC_RECEIVER_PRIORITY, LSPC_TRANSMITTER_PRIORITY); // never deleted, since its tasks never end
+	usb.Connect(&PCSocket::Receive, &pc);
+	pc.registerCallback(lspc::MessageTypesToPC::Debug, &Text_Callback);
+	new Debug(lspc);
+
+	TestLongMessage();
+	TestProducers();
+	TestFullBuffer();
+	TestInterruptOverflow();
+
+	uint32_t dropped = lspc->GetDropped(lspc::TransmitTypes::BULK);
+	CHECK(dropped == 0, "%u packages refused by the socket", dropped);
+
+	if (failures) {
+		printf("DebugTest: %d checks FAILED\n", failures);
+		return 1;
+	}
+	printf("DebugTest: passed\n");
+	return 0;
+}
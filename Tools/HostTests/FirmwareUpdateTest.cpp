@@ -0,0 +1,410 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+ 
+
+/* Host test of the in-application firmware update (FirmwareUpdate and ImageWriter) over a loopback of two LSPC sockets.
+ *
+ * The flash banks are emulated by FlashEmulator through the InternalFlash stand-in of host/, and a system reset throws
+ * HostReset, after which the test reboots the robot by creating a new FirmwareUpdate. The PC side streams the image over a
+ * LinkModel which drops and reorders frames, as in TransferTest. The task of FirmwareUpdate, which erases the inactive bank,
+ * runs on the FreeRTOS stand-in of host/rtos with a lower priority than the test, so it only runs while the link is idle.
+ *
+ * ImageWriter: the size limits, the alignment of the writes and the skipping of erased flash words.
+ * FirmwareUpdate: a complete update has to program the image into the inactive bank and swap the banks exactly once.
+ * The start has to be answered before any sector is erased, and the erase progress has to be reported after every sector.
+ * A link outage during the transfer has to be resumed without starting over, and an update interrupted by a restart of the
+ * PC tool or by a power failure of the robot has to succeed when it is started again. An image with a bad CRC, an oversized
+ * or empty image and an update while the controller is running have to be rejected without swapping the banks.
+ * Build with build.sh.
+ */
+
+#include "LSPC.hpp"
+#include "LinkModel.h"
+#include "Transfer.hpp"
+#include "FirmwareUpdate.h"
+#include "ImageWriter.h"
+#include "InternalFlash.h"
+#include "FlashEmulator.h"
+#include "Parameters.h"
+#include "CRC32.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define TIMEOUT			20000   // us without any package after which the PC side times out
+#define GIVE_UP			2000000 // us without any package from the robot after which the PC gives up
+#define IMAGE_SIZE		300001
+#define LINK_DROP_RATE	0.02f
+#define TEST_PRIORITY	2
+#define UPDATE_PRIORITY	1 // below the test, which receives the LSPC packages like the LSPC receiver task
+
+static int failures = 0;
+
+#define CHECK(condition, ...) do { if (!(condition)) { printf("FAILED: " __VA_ARGS__); printf("\n"); failures++; } } while (0)
+
+/* The robot side with the modules which are created at boot */
+typedef struct {
+	LSPC com;
+	FirmwareUpdate * update;
+	uint32_t resets;
+	uint32_t powerFailures;
+} Robot_t;
+
+static void Reboot(Robot_t& robot)
+{
+	delete robot.update;
+	InternalFlash::GetBank(FLASH_BANK_2).PowerOn();
+	robot.update = new FirmwareUpdate(robot.com, 0, UPDATE_PRIORITY);
+}
+
+static bool SwappedBanks(void)
+{
+	return READ_BIT(FLASH->OPTSR_CUR, FLASH_OPTSR_SWAP_BANK_OPT);
+}
+
+/* PC side of an update */
+typedef struct {
+	bool infoReceived;
+	bool erased; // all sectors of the image have been erased, or the update has been rejected
+	lspc::MessageTypesToPC::FirmwareUpdateInfo_t info;
+	uint32_t progress; // bit n is set if a report of n erased sectors (n > 0) has been received
+	uint32_t erasesAtStart; // sector erases of the bank when the start was sent
+	uint32_t erasesAtReply; // and when its reply was received
+	lspc::TransferSender * sender;
+	LinkModel * link;
+	uint64_t lastResponse; // time of the latest package from the robot
+} UpdateClient_t;
+
+static void TransmitPackage(void * param, uint8_t type, const uint8_t * payload, uint16_t length)
+{
+	((LSPC *)param)->TransmitAsync(type, payload, length);
+}
+
+static void FirmwareUpdateInfo_Callback(void * param, const std::vector<uint8_t>& payload)
+{
+	UpdateClient_t * client = (UpdateClient_t *)param;
+	lspc::MessageTypesToPC::FirmwareUpdateInfo_t info;
+	client->lastResponse = client->link->Now();
+	if (payload.size() != sizeof(info)) return;
+	memcpy(&info, payload.data(), sizeof(info));
+
+	if (info.erased_sectors > 0 && info.erased_sectors < 32)
+		client->progress |= (1u << info.erased_sectors);
+	if (client->erased) return;
+	if (!client->infoReceived && info.erased_sectors == 0) // the reply to the start, unless it has been lost
+		client->erasesAtReply = InternalFlash::GetBank(FLASH_BANK_2).GetEraseCount();
+	if (client->infoReceived && info.status == lspc::TransferTypes::IN_PROGRESS && info.erased_sectors < client->info.erased_sectors)
+		return; // reordered info
+	client->info = info;
+	client->infoReceived = true;
+	client->erased = (info.status != lspc::TransferTypes::IN_PROGRESS || info.erased_sectors == info.sectors);
+}
+
+static void FirmwareUpdateAck_Callback(void * param, const std::vector<uint8_t>& payload)
+{
+	UpdateClient_t * client = (UpdateClient_t *)param;
+	lspc::TransferTypes::Ack_t ack;
+	client->lastResponse = client->link->Now();
+	if (payload.size() != sizeof(ack)) return;
+	memcpy(&ack, payload.data(), sizeof(ack));
+	client->sender->Acknowledge(ack);
+}
+
+/**
+ * @brief 	Run an update from the PC side, as the PC tool does
+ * @param	image        Input: firmware image; its size is sent with the start, also if it is too large to be sent
+ * @param	crc          Input: CRC sent with the start
+ * @param	abortAt      Input: simulated time at which the PC tool stops the update (0 = never)
+ * @param	outageAt     Input: simulated time at which the link drops every frame for 'outage' [us] (0 = never)
+ * @param	maxSize      Output: maximum image size reported by the robot (optional)
+ * @param	progress     Output: bit n is set if the progress of n erased sectors has been reported (optional)
+ * @retval	final status reported by the robot, or IN_PROGRESS if the update was aborted or the robot stopped responding
+ */
+static lspc::TransferTypes::status_t Update(LSPC& pc, Robot_t& robot, LinkModel& link, const std::vector<uint8_t>& image, uint32_t crc,
+											uint64_t abortAt = 0, uint64_t outageAt = 0, uint32_t outage = 0, uint32_t * maxSize = 0, uint32_t * progress = 0)
+{
+	lspc::TransferSender sender(&TransmitPackage, &pc, lspc::MessageTypesFromPC::FirmwareUpdateChunk);
+	UpdateClient_t client;
+	client.infoReceived = false;
+	client.erased = false;
+	client.progress = 0;
+	client.erasesAtStart = InternalFlash::GetBank(FLASH_BANK_2).GetEraseCount();
+	client.erasesAtReply = client.erasesAtStart;
+	client.sender = &sender;
+	client.link = &link;
+	client.lastResponse = link.Now();
+	pc.registerCallback(lspc::MessageTypesToPC::FirmwareUpdateInfo, &FirmwareUpdateInfo_Callback, &client);
+	pc.registerCallback(lspc::MessageTypesToPC::FirmwareUpdateAck, &FirmwareUpdateAck_Callback, &client);
+
+	lspc::MessageTypesFromPC::FirmwareUpdateStart_t start;
+	start.magic_key = FIRMWAREUPDATE_MAGIC_KEY;
+	start.size = image.size();
+	start.crc = crc;
+	pc.TransmitAsync(lspc::MessageTypesFromPC::FirmwareUpdateStart, (const uint8_t *)&start, sizeof(start));
+
+	lspc::TransferTypes::status_t status = lspc::TransferTypes::IN_PROGRESS;
+	bool started = false;
+	while (status == lspc::TransferTypes::IN_PROGRESS && link.Now() - client.lastResponse < GIVE_UP && (!abortAt || link.Now() < abortAt)) {
+		if (outageAt && link.Now() >= outageAt) {
+			if (link.Now() < outageAt + outage) {
+				link.SetDropRate(1);
+			} else {
+				link.SetDropRate(LINK_DROP_RATE);
+				outageAt = 0;
+			}
+		}
+
+		bool stepped;
+		try {
+			stepped = link.Step(link.Now() + TIMEOUT);
+		} catch (HostReset&) {
+			robot.resets++;
+			Reboot(robot);
+			stepped = true;
+		}
+		if (!InternalFlash::GetBank(FLASH_BANK_2).IsPoweredOn()) { // power failure while programming or erasing
+			robot.powerFailures++;
+			Reboot(robot);
+		}
+
+		if (!stepped) {
+			osDelay(1); // let the task of the robot erase while the link is idle
+			if (!InternalFlash::GetBank(FLASH_BANK_2).IsPoweredOn()) { // power failure while erasing
+				robot.powerFailures++;
+				Reboot(robot);
+			}
+			link.Advance(link.Now() + TIMEOUT);
+			if (!client.infoReceived) // the start or its reply has been lost, hence start again
+				pc.TransmitAsync(lspc::MessageTypesFromPC::FirmwareUpdateStart, (const uint8_t *)&start, sizeof(start));
+			else if (started)
+				sender.Timeout();
+		}
+
+		if (client.erased && !started) {
+			started = true;
+			if (maxSize) *maxSize = client.info.max_size;
+			CHECK(client.erasesAtReply == client.erasesAtStart || client.info.status != lspc::TransferTypes::IN_PROGRESS,
+				  "start answered after %u sectors were erased", client.erasesAtReply - client.erasesAtStart);
+			if (client.info.status != lspc::TransferTypes::IN_PROGRESS)
+				status = client.info.status;
+			else
+				sender.Start(image.data(), image.size());
+		}
+
+		if (sender.Completed())
+			status = sender.GetStatus();
+	}
+
+	if (progress) *progress = client.progress;
+
+	/* Let the remaining packages arrive, without continuing an aborted transfer */
+	pc.unregisterCallback(lspc::MessageTypesToPC::FirmwareUpdateInfo);
+	pc.unregisterCallback(lspc::MessageTypesToPC::FirmwareUpdateAck);
+	while (true) {
+		try {
+			if (!link.Step(link.Now() + TIMEOUT)) break;
+		} catch (HostReset&) {
+			robot.resets++;
+			Reboot(robot);
+		}
+	}
+
+	return status;
+}
+
+static std::vector<uint8_t> RandomImage(LinkModel& link, uint32_t size)
+{
+	std::vector<uint8_t> image(size);
+	for (uint32_t i = 0; i < size; i++)
+		image[i] = (uint8_t)link.Random(256);
+	for (uint32_t i = 1000; i < 5000 && i < size; i++)
+		image[i] = 0xFF; // erased flash, as in the padding between the sections of an image
+	return image;
+}
+
+static bool ImageProgrammed(const std::vector<uint8_t>& image)
+{
+	return memcmp(InternalFlash::GetBank(FLASH_BANK_2).GetSectorAddress(0), image.data(), image.size()) == 0;
+}
+
+static void TestImageWriter(void)
+{
+	FlashEmulator flash(FIRMWAREUPDATE_IMAGE_SECTORS, FLASH_SECTOR_SIZE);
+	ImageWriter writer(flash);
+	CHECK(writer.GetMaximumSize() == FIRMWAREUPDATE_IMAGE_SECTORS * FLASH_SECTOR_SIZE, "maximum image size %u", writer.GetMaximumSize());
+	CHECK(!writer.Begin(0), "empty image accepted");
+	CHECK(!writer.Begin(writer.GetMaximumSize() + 1), "oversized image accepted");
+	CHECK(flash.GetEraseCount() == 0, "rejected image erased %u sectors", flash.GetEraseCount());
+
+	/* An image of one and a half sectors covers two sectors, which are erased one at a time in order */
+	uint32_t size = FLASH_SECTOR_SIZE + FLASH_SECTOR_SIZE/2;
+	CHECK(writer.Begin(size) && writer.GetSectors() == 2, "image of %u bytes rejected or covers %u sectors", size, writer.GetSectors());
+	CHECK(flash.GetEraseCount() == 0, "Begin erased %u sectors", flash.GetEraseCount());
+	CHECK(!writer.EraseSector(1), "sector erased out of order");
+
+	uint8_t data[3*FLASH_WORD_SIZE];
+	memset(data, 0xA5, sizeof(data));
+	memset(&data[FLASH_WORD_SIZE], 0xFF, FLASH_WORD_SIZE);
+	CHECK(writer.EraseSector(0) && writer.GetErasedSectors() == 1, "erase of the first sector failed");
+	CHECK(writer.Write(0, data, FLASH_WORD_SIZE), "write into an erased sector failed");
+	CHECK(!writer.Write(FLASH_SECTOR_SIZE - FLASH_WORD_SIZE, data, sizeof(data)), "write into a sector which is not erased accepted");
+	CHECK(writer.EraseSector(1) && !writer.EraseSector(2) && flash.GetEraseCount() == 2, "image of %u bytes erased %u sectors", size, flash.GetEraseCount());
+	flash.ResetStatistics();
+	CHECK(writer.Write(FLASH_SECTOR_SIZE - FLASH_WORD_SIZE, data, sizeof(data)), "write across a sector boundary failed");
+	CHECK(flash.GetProgramCount() == 2, "erased flash word programmed (%u words programmed)", flash.GetProgramCount());
+	CHECK(memcmp(writer.GetImage() + FLASH_SECTOR_SIZE - FLASH_WORD_SIZE, data, sizeof(data)) == 0, "written data differs");
+
+	CHECK(!writer.Write(FLASH_WORD_SIZE/2, data, 1), "unaligned write accepted");
+	CHECK(!writer.Write(size - FLASH_WORD_SIZE/2, data, FLASH_WORD_SIZE), "write beyond the image accepted");
+	CHECK(writer.Write(size - FLASH_WORD_SIZE, data, FLASH_WORD_SIZE), "write of the last word failed");
+	CHECK(!writer.Write(size - FLASH_WORD_SIZE, data, FLASH_WORD_SIZE), "flash word programmed twice");
+}
+
+static void TestUpdate(LSPC& pc, Robot_t& robot, LinkModel& link)
+{
+	FlashEmulator& bank = InternalFlash::GetBank(FLASH_BANK_2);
+	std::vector<uint8_t> image = RandomImage(link, IMAGE_SIZE);
+	uint32_t crc = CRC32_Calculate(image.data(), image.size());
+
+	/* Complete update */
+	bool swapped = SwappedBanks();
+	uint32_t resets = robot.resets;
+	bank.ResetStatistics();
+	uint64_t begin = link.Now();
+	uint32_t progress = 0;
+	link.SetDropRate(0); // such that every progress report arrives
+	CHECK(Update(pc, robot, link, image, crc, 0, 0, 0, 0, &progress) == lspc::TransferTypes::COMPLETE, "update");
+	link.SetDropRate(LINK_DROP_RATE);
+	CHECK(progress == (2u << ((IMAGE_SIZE + FLASH_SECTOR_SIZE - 1) / FLASH_SECTOR_SIZE)) - 2, "erase progress not reported after every sector (0x%X)", progress);
+	CHECK(ImageProgrammed(image), "programmed image differs");
+	CHECK(robot.resets == resets + 1, "%u resets after an update", robot.resets - resets);
+	CHECK(SwappedBanks() != swapped, "banks not swapped");
+	CHECK(bank.GetEraseCount() == (IMAGE_SIZE + FLASH_SECTOR_SIZE - 1) / FLASH_SECTOR_SIZE, "%u sectors erased", bank.GetEraseCount());
+	printf("Update: %u bytes in %.2f s, %u words programmed\n", IMAGE_SIZE, 1e-6 * (link.Now() - begin), bank.GetProgramCount());
+	const uint32_t operations = bank.GetEraseCount() + bank.GetProgramCount(); // flash operations of an update
+
+	/* A link outage of 1 second during the transfer is resumed where it stopped */
+	image = RandomImage(link, IMAGE_SIZE);
+	crc = CRC32_Calculate(image.data(), image.size());
+	swapped = SwappedBanks();
+	resets = robot.resets;
+	bank.ResetStatistics();
+	CHECK(Update(pc, robot, link, image, crc, 0, link.Now() + 150000, 1000000) == lspc::TransferTypes::COMPLETE, "update with link outage");
+	CHECK(ImageProgrammed(image), "programmed image differs after link outage");
+	CHECK(bank.GetEraseCount() == (IMAGE_SIZE + FLASH_SECTOR_SIZE - 1) / FLASH_SECTOR_SIZE, "update restarted after link outage (%u sectors erased)", bank.GetEraseCount());
+	CHECK(robot.resets == resets + 1 && SwappedBanks() != swapped, "banks not swapped once after link outage");
+
+	/* The PC tool is restarted during the transfer and starts over with another image */
+	std::vector<uint8_t> aborted = RandomImage(link, IMAGE_SIZE);
+	image = RandomImage(link, IMAGE_SIZE - 1000);
+	crc = CRC32_Calculate(image.data(), image.size());
+	swapped = SwappedBanks();
+	resets = robot.resets;
+	CHECK(Update(pc, robot, link, aborted, CRC32_Calculate(aborted.data(), aborted.size()), link.Now() + 100000) == lspc::TransferTypes::IN_PROGRESS, "aborted update did not stop");
+	CHECK(robot.resets == resets && SwappedBanks() == swapped, "banks swapped by an aborted update");
+	CHECK(Update(pc, robot, link, image, crc) == lspc::TransferTypes::COMPLETE, "update after aborted update");
+	CHECK(ImageProgrammed(image), "programmed image differs after aborted update");
+	CHECK(robot.resets == resets + 1 && SwappedBanks() != swapped, "banks not swapped once after aborted update");
+
+	/* Power failures of the robot while erasing and programming, after which the PC tool starts the update again if it failed */
+	for (uint32_t cut = 1; cut < operations; cut += operations / 13) {
+		image = RandomImage(link, IMAGE_SIZE);
+		crc = CRC32_Calculate(image.data(), image.size());
+		swapped = SwappedBanks();
+		resets = robot.resets;
+		uint32_t powerFailures = robot.powerFailures;
+		bank.SetPowerFailAfter(cut);
+		lspc::TransferTypes::status_t status = Update(pc, robot, link, image, crc);
+		CHECK(robot.powerFailures == powerFailures + 1, "no power failure after %u operations", cut);
+		if (status != lspc::TransferTypes::COMPLETE) {
+			CHECK(robot.resets == resets && SwappedBanks() == swapped, "banks swapped by a failed update (power failure after %u operations)", cut);
+			status = Update(pc, robot, link, image, crc);
+		}
+		CHECK(status == lspc::TransferTypes::COMPLETE, "update after power failure after %u operations", cut);
+		CHECK(ImageProgrammed(image), "programmed image differs after power failure after %u operations", cut);
+		CHECK(robot.resets == resets + 1 && SwappedBanks() != swapped, "banks not swapped once after power failure after %u operations", cut);
+	}
+}
+
+static void TestRejectedUpdates(LSPC& pc, Robot_t& robot, LinkModel& link)
+{
+	FlashEmulator& bank = InternalFlash::GetBank(FLASH_BANK_2);
+	std::vector<uint8_t> image = RandomImage(link, IMAGE_SIZE);
+	uint32_t crc = CRC32_Calculate(image.data(), image.size());
+	bool swapped = SwappedBanks();
+	uint32_t resets = robot.resets;
+
+	/* Bad CRC */
+	CHECK(Update(pc, robot, link, image, crc ^ 0x00000001) == lspc::TransferTypes::CRC_ERROR, "image with bad CRC not rejected");
+
+	/* Oversized and empty image */
+	uint32_t maxSize = 0;
+	std::vector<uint8_t> oversized(FIRMWAREUPDATE_IMAGE_SECTORS * FLASH_SECTOR_SIZE + 1, 0);
+	bank.ResetStatistics();
+	CHECK(Update(pc, robot, link, oversized, 0, 0, 0, 0, &maxSize) == lspc::TransferTypes::REJECTED, "oversized image not rejected");
+	CHECK(maxSize == FIRMWAREUPDATE_IMAGE_SECTORS * FLASH_SECTOR_SIZE, "maximum image size %u", maxSize);
+	CHECK(Update(pc, robot, link, std::vector<uint8_t>(), 0) == lspc::TransferTypes::REJECTED, "empty image not rejected");
+	CHECK(bank.GetEraseCount() == 0, "rejected image erased %u sectors", bank.GetEraseCount());
+
+	/* Controller running */
+	Parameters params;
+	params.LockForChange();
+	params.controller.mode = lspc::ParameterTypes::QUATERNION_CONTROL;
+	params.UnlockAfterChange();
+	CHECK(Update(pc, robot, link, image, crc) == lspc::TransferTypes::REJECTED, "update while the controller is running not rejected");
+	params.LockForChange();
+	params.controller.mode = lspc::ParameterTypes::OFF;
+	params.UnlockAfterChange();
+
+	CHECK(robot.resets == resets && SwappedBanks() == swapped, "banks swapped by a rejected update");
+
+	/* The robot still accepts an update */
+	CHECK(Update(pc, robot, link, image, crc) == lspc::TransferTypes::COMPLETE, "update after rejected updates");
+	CHECK(ImageProgrammed(image), "programmed image differs after rejected updates");
+}
+
+int main(void)
+{
+	HostScheduler::Get().Attach(TEST_PRIORITY);
+	TestImageWriter();
+
+	Parameters params; // global parameters, which the FirmwareUpdate reads the controller mode from
+	LSPC pc;
+	Robot_t robot;
+	robot.update = 0;
+	robot.resets = 0;
+	robot.powerFailures = 0;
+	LinkModel link(pc, robot.com, 7);
+	link.SetDropRate(LINK_DROP_RATE);
+	link.SetReordering(0.05f, 3000);
+	Reboot(robot);
+
+	TestUpdate(pc, robot, link);
+	TestRejectedUpdates(pc, robot, link);
+	printf("Link: %u frames, %u dropped, %u reordered\n", link.GetFrames(), link.GetDropped(), link.GetReordered());
+
+	delete robot.update;
+
+	if (failures) {
+		printf("FirmwareUpdateTest: %d checks FAILED\n", failures);
+		return 1;
+	}
+	printf("FirmwareUpdateTest: passed\n");
+	return 0;
+}
@@ -0,0 +1,155 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+ 
+#include "FlashEmulator.h"
+#include <string.h> // for memcpy
+
+/**
+ * @brief 	Create an erased flash memory
+ * @param	sectorCount      Input: number of sectors
+ * @param	sectorSize       Input: size of each sector in bytes (multiple of FLASH_WORD_SIZE)
+ * @param	programTime_us   Input: modelled time to program one flash word [us]
+ * @param	eraseTime_us     Input: modelled time to erase one sector [us]
+ */
+FlashEmulator::FlashEmulator(uint32_t sectorCount, uint32_t sectorSize, uint32_t programTime_us, uint32_t eraseTime_us) : sectorCount_(sectorCount), sectorSize_(sectorSize), programTime_us_(programTime_us), eraseTime_us_(eraseTime_us), poweredOn_(true), operationsUntilPowerFail_(0)
+{
+	memory_ = new uint8_t[sectorCount_ * sectorSize_];
+	memset(memory_, 0xFF, sectorCount_ * sectorSize_);
+	sectorEraseCount_ = new uint32_t[sectorCount_];
+	ResetStatistics();
+}
+
+FlashEmulator::~FlashEmulator()
+{
+	delete[] memory_;
+	delete[] sectorEraseCount_;
+}
+
+uint32_t FlashEmulator::GetSectorCount(void)
+{
+	return sectorCount_;
+}
+
+uint32_t FlashEmulator::GetSectorSize(void)
+{
+	return sectorSize_;
+}
+
+const uint8_t * FlashEmulator::GetSectorAddress(uint32_t sector)
+{
+	return &memory_[sector * sectorSize_];
+}
+
+/**
+ * @brief 	Program one flash word. Fails if the word is not erased or if the power has failed.
+ *          The operation that triggers a simulated power failure only programs the first half of the word.
+ */
+bool FlashEmulator::ProgramWord(uint32_t sector, uint32_t offset, const uint64_t data[FLASH_WORD_SIZE/8])
+{
+	if (!poweredOn_) return false;
+	if (sector >= sectorCount_ || (offset % FLASH_WORD_SIZE) != 0 || offset >= sectorSize_) return false;
+
+	uint8_t * word = &memory_[sector * sectorSize_ + offset];
+	for (int i = 0; i < FLASH_WORD_SIZE; i++)
+		if (word[i] != 0xFF) return false; // flash words can only be programmed once after erase
+
+	programCount_++;
+	elapsedTime_ += programTime_us_;
+
+	if (operationsUntilPowerFail_ > 0 && --operationsUntilPowerFail_ == 0) {
+		memcpy(word, data, FLASH_WORD_SIZE/2);
+		poweredOn_ = false;
+		return false;
+	}
+
+	memcpy(word, data, FLASH_WORD_SIZE);
+	return true;
+}
+
+/**
+ * @brief 	Erase one sector. The operation that triggers a simulated power failure only erases the first half of the sector.
+ */
+bool FlashEmulator::EraseSector(uint32_t sector)
+{
+	if (!poweredOn_) return false;
+	if (sector >= sectorCount_) return false;
+
+	eraseCount_++;
+	sectorEraseCount_[sector]++;
+	elapsedTime_ += eraseTime_us_;
+
+	if (operationsUntilPowerFail_ > 0 && --operationsUntilPowerFail_ == 0) {
+		memset(&memory_[sector * sectorSize_], 0xFF, sectorSize_/2);
+		poweredOn_ = false;
+		return false;
+	}
+
+	memset(&memory_[sector * sectorSize_], 0xFF, sectorSize_);
+	return true;
+}
+
+/**
+ * @brief 	Simulate a power failure during the n'th following program or erase operation
+ * @param	operations   Input: number of operations until the power fails (0 disables the power failure)
+ */
+void FlashEmulator::SetPowerFailAfter(uint32_t operations)
+{
+	operationsUntilPowerFail_ = operations;
+}
+
+void FlashEmulator::PowerOn(void)
+{
+	poweredOn_ = true;
+	operationsUntilPowerFail_ = 0;
+}
+
+bool FlashEmulator::IsPoweredOn(void)
+{
+	return poweredOn_;
+}
+
+void FlashEmulator::ResetStatistics(void)
+{
+	programCount_ = 0;
+	eraseCount_ = 0;
+	elapsedTime_ = 0;
+	for (uint32_t i = 0; i < sectorCount_; i++)
+		sectorEraseCount_[i] = 0;
+}
+
+uint32_t FlashEmulator::GetProgramCount(void)
+{
+	return programCount_;
+}
+
+uint32_t FlashEmulator::GetEraseCount(void)
+{
+	return eraseCount_;
+}
+
+uint32_t FlashEmulator::GetSectorEraseCount(uint32_t sector)
+{
+	if (sector >= sectorCount_) return 0;
+	return sectorEraseCount_[sector];
+}
+
+uint64_t FlashEmulator::GetElapsedTime(void)
+{
+	return elapsedTime_;
+}
@@ -0,0 +1,67 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+ 
+#ifndef HOSTTESTS_FLASHEMULATOR_H
+#define HOSTTESTS_FLASHEMULATOR_H
+
+#include "FlashMemory.h"
+
+/* RAM backed flash memory for testing the flash storage layers on a PC.
+ * It enforces the program-once rule of the flash words, counts program and erase operations,
+ * accumulates a modelled programming time and can simulate a power failure after a given number of operations. */
+class FlashEmulator : public FlashMemory
+{
+	public:
+		FlashEmulator(uint32_t sectorCount, uint32_t sectorSize, uint32_t programTime_us = 100, uint32_t eraseTime_us = 1500000);
+		~FlashEmulator();
+
+		uint32_t GetSectorCount(void);
+		uint32_t GetSectorSize(void);
+		const uint8_t * GetSectorAddress(uint32_t sector);
+
+		bool ProgramWord(uint32_t sector, uint32_t offset, const uint64_t data[FLASH_WORD_SIZE/8]);
+		bool EraseSector(uint32_t sector);
+
+		void SetPowerFailAfter(uint32_t operations);
+		void PowerOn(void);
+		bool IsPoweredOn(void);
+
+		void ResetStatistics(void);
+		uint32_t GetProgramCount(void);
+		uint32_t GetEraseCount(void);
+		uint32_t GetSectorEraseCount(uint32_t sector);
+		uint64_t GetElapsedTime(void); // modelled time spent programming and erasing [us]
+
+	private:
+		uint32_t sectorCount_;
+		uint32_t sectorSize_;
+		uint32_t programTime_us_;
+		uint32_t eraseTime_us_;
+		uint8_t * memory_;
+
+		bool poweredOn_;
+		uint32_t operationsUntilPowerFail_; // 0 = disabled
+
+		uint32_t programCount_;
+		uint32_t eraseCount_;
+		uint32_t * sectorEraseCount_;
+		uint64_t elapsedTime_;
+};
+
+#endif
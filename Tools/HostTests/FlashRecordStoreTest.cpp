@@ -0,0 +1,448 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+ 
+
+/* Host test of the FlashRecordStore on the FlashEmulator.
+ *
+ * Power failure: a sequence of writes of two keys, which includes several compactions, is first run once to count its
+ * flash operations. It is then repeated with the power cut during each of these operations. After every cut the store
+ * is initialized again from the flash, as at boot, and every key has to hold either the value of its last completed
+ * write or the value of the write that was interrupted. The store then has to accept and keep new values.
+ *
+ * Patches: the number of flash operations of Update() is checked for single changes, unchanged values, the patch limit
+ * and layout changes, and a tuning session (1-3 floats of a parameter block changed per store) is stored with Write()
+ * and with Update() to compare their flash programs and sector erases. The index rebuilt at boot is compared with
+ * a RAM copy of the values of many keys with patches, also with the power cut during the patch updates.
+ *
+ * Boot timing: a 128 KB sector is filled to 10%, 50% and 95% with parameter sized records of the EEPROM sections, and the
+ * time of Init (one scan of the log which rebuilds the index) and of reading every section afterwards is printed.
+ * Build with build.sh.
+ */
+
+#include "FlashEmulator.h"
+#include "FlashRecordStore.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+
+#define SECTOR_COUNT	2
+#define SECTOR_SIZE		4096 // small sectors to get compactions within a short sequence
+#define WRITES			24   // writes of each key in the power failure sequence
+
+#define KEY_A			0x1000
+#define KEY_B			0x0050
+#define LENGTH_A		600
+#define LENGTH_B		40
+
+#define PARAMETERS_SIZE	1040 // size of the parameter block
+#define TUNING_STORES	20000
+#define REBUILD_KEYS	8
+#define REBUILD_LENGTH	200
+#define REBUILD_UPDATES	300
+
+#define BOOT_SECTOR_SIZE	(128*1024) // sector size of the STM32H743
+#define BOOT_KEYS			3 // EEPROM sections written in turn
+#define BOOT_REPETITIONS	200 // boots per fill level, the average is printed
+
+static int failures = 0;
+
+#define CHECK(condition, ...) do { if (!(condition)) { printf("FAILED: " __VA_ARGS__); printf("\n"); failures++; } } while (0)
+
+static void Pattern(uint8_t * data, uint16_t length, uint16_t key, uint32_t version)
+{
+	for (uint32_t i = 0; i < length; i++)
+		data[i] = (uint8_t)(version * 31 + i * 7 + key);
+}
+
+static bool HasValue(FlashRecordStore& store, uint16_t key, uint16_t length, uint32_t version)
+{
+	uint8_t expected[LENGTH_A];
+	uint8_t stored[LENGTH_A];
+	Pattern(expected, length, key, version);
+	if (store.Read(key, 0, stored, length) != length) return false;
+	return memcmp(expected, stored, length) == 0;
+}
+
+/**
+ * @brief 	Write the initial value (version 0) of both keys followed by the power failure sequence
+ * @param	store      Input: formatted store
+ * @param	versionA   Output: version of the last completed write of key A
+ * @param	versionB   Output: version of the last completed write of key B
+ * @param	pendingKey Output: key of the write that failed, 0 if all writes completed
+ */
+static void WriteSequence(FlashRecordStore& store, uint32_t& versionA, uint32_t& versionB, uint16_t& pendingKey)
+{
+	uint8_t data[LENGTH_A];
+	pendingKey = 0;
+	versionA = versionB = 0;
+
+	for (uint32_t version = 1; version <= WRITES; version++) {
+		Pattern(data, LENGTH_A, KEY_A, version);
+		if (!store.Write(KEY_A, data, LENGTH_A)) { pendingKey = KEY_A; return; }
+		versionA = version;
+
+		Pattern(data, LENGTH_B, KEY_B, version);
+		if (!store.Write(KEY_B, data, LENGTH_B)) { pendingKey = KEY_B; return; }
+		versionB = version;
+	}
+}
+
+static bool Prepare(FlashEmulator& flash, FlashRecordStore& store)
+{
+	uint8_t data[LENGTH_A];
+	if (!store.Format()) return false;
+	Pattern(data, LENGTH_A, KEY_A, 0);
+	if (!store.Write(KEY_A, data, LENGTH_A)) return false;
+	Pattern(data, LENGTH_B, KEY_B, 0);
+	if (!store.Write(KEY_B, data, LENGTH_B)) return false;
+	flash.ResetStatistics();
+	return true;
+}
+
+static void TestPowerFailure(void)
+{
+	uint32_t operations;
+	{
+		FlashEmulator flash(SECTOR_COUNT, SECTOR_SIZE);
+		FlashRecordStore store(flash);
+		CHECK(Prepare(flash, store), "prepare");
+
+		uint32_t versionA, versionB;
+		uint16_t pendingKey;
+		WriteSequence(store, versionA, versionB, pendingKey);
+		CHECK(pendingKey == 0 && versionA == WRITES && versionB == WRITES, "sequence without power failure");
+		operations = flash.GetProgramCount() + flash.GetEraseCount();
+		CHECK(flash.GetEraseCount() >= 2, "sequence has to include compactions (%u erases)", flash.GetEraseCount());
+	}
+
+	uint32_t trials = 0;
+	for (uint32_t cut = 1; cut <= operations; cut++) {
+		FlashEmulator flash(SECTOR_COUNT, SECTOR_SIZE);
+		{
+			FlashRecordStore store(flash);
+			Prepare(flash, store);
+			flash.SetPowerFailAfter(cut);
+
+			uint32_t versionA, versionB;
+			uint16_t pendingKey;
+			WriteSequence(store, versionA, versionB, pendingKey);
+			CHECK(!flash.IsPoweredOn() && pendingKey != 0, "cut %u: power failure not triggered", cut);
+			flash.PowerOn();
+
+			FlashRecordStore restarted(flash); // boot
+			CHECK(restarted.Init(), "cut %u: init", cut);
+			CHECK(HasValue(restarted, KEY_A, LENGTH_A, versionA) || (pendingKey == KEY_A && HasValue(restarted, KEY_A, LENGTH_A, versionA + 1)),
+				  "cut %u: key A lost (version %u)", cut, versionA);
+			CHECK(HasValue(restarted, KEY_B, LENGTH_B, versionB) || (pendingKey == KEY_B && HasValue(restarted, KEY_B, LENGTH_B, versionB + 1)),
+				  "cut %u: key B lost (version %u)", cut, versionB);
+
+			/* The store has to keep working after the power failure, including compactions */
+			uint8_t data[LENGTH_A];
+			bool written = true;
+			for (uint32_t version = 100; version < 100 + WRITES; version++) {
+				Pattern(data, LENGTH_A, KEY_A, version);
+				written &= restarted.Write(KEY_A, data, LENGTH_A);
+			}
+			Pattern(data, LENGTH_B, KEY_B, 200);
+			written &= restarted.Write(KEY_B, data, LENGTH_B);
+			CHECK(written, "cut %u: write after power failure", cut);
+		}
+
+		FlashRecordStore rebooted(flash);
+		CHECK(rebooted.Init(), "cut %u: second init", cut);
+		CHECK(HasValue(rebooted, KEY_A, LENGTH_A, 100 + WRITES - 1) && HasValue(rebooted, KEY_B, LENGTH_B, 200), "cut %u: values written after power failure lost", cut);
+		trials++;
+	}
+
+	printf("Power failure: %u cut points\n", trials);
+}
+
+/* Deterministic pseudo random numbers, such that a failing case can be reproduced */
+static uint32_t randomState = 1;
+static uint32_t Random(uint32_t range)
+{
+	randomState = randomState * 1664525 + 1013904223;
+	return (randomState >> 8) % range;
+}
+
+static uint32_t Operations(FlashEmulator& flash)
+{
+	return flash.GetProgramCount() + flash.GetEraseCount();
+}
+
+static void TestPatchOperations(void)
+{
+	FlashEmulator flash(SECTOR_COUNT, 128*1024);
+	FlashRecordStore store(flash);
+	CHECK(store.Format(), "format");
+
+	uint8_t value[PARAMETERS_SIZE];
+	uint8_t stored[PARAMETERS_SIZE];
+	Pattern(value, PARAMETERS_SIZE, KEY_A, 0);
+	CHECK(store.Update(KEY_A, value, PARAMETERS_SIZE), "first update");
+
+	flash.ResetStatistics();
+	CHECK(store.Update(KEY_A, value, PARAMETERS_SIZE) && Operations(flash) == 0, "unchanged value: %u operations", Operations(flash));
+
+	/* One changed float is a single flash word: 16 byte header, 4 byte range header and 4 bytes */
+	value[100] ^= 0x01;
+	value[103] ^= 0x80;
+	flash.ResetStatistics();
+	CHECK(store.Update(KEY_A, value, PARAMETERS_SIZE) && Operations(flash) == 1, "one float changed: %u operations", Operations(flash));
+
+	/* Two distant floats are two ranges in the same patch record */
+	value[8] ^= 0xFF;
+	value[1000] ^= 0xFF;
+	flash.ResetStatistics();
+	CHECK(store.Update(KEY_A, value, PARAMETERS_SIZE) && Operations(flash) == 1, "two floats changed: %u operations", Operations(flash));
+
+	/* After FLASHRECORDSTORE_MAX_PATCHES patches the complete value is written again */
+	for (uint32_t i = 2; i < FLASHRECORDSTORE_MAX_PATCHES; i++) {
+		value[i] ^= 0xFF;
+		CHECK(store.Update(KEY_A, value, PARAMETERS_SIZE), "patch %u", i);
+	}
+	value[500] ^= 0xFF;
+	flash.ResetStatistics();
+	uint32_t completeRecord = (16 + PARAMETERS_SIZE + FLASH_WORD_SIZE - 1) / FLASH_WORD_SIZE;
+	CHECK(store.Update(KEY_A, value, PARAMETERS_SIZE) && Operations(flash) == completeRecord, "patch limit: %u operations, expected %u", Operations(flash), completeRecord);
+	CHECK(store.Read(KEY_A, 0, stored, PARAMETERS_SIZE) == PARAMETERS_SIZE && !memcmp(value, stored, PARAMETERS_SIZE), "value after patches");
+
+	/* A layout change (other length) writes the complete value */
+	flash.ResetStatistics();
+	CHECK(store.Update(KEY_A, value, PARAMETERS_SIZE - 4) && Operations(flash) == (16 + PARAMETERS_SIZE - 4 + FLASH_WORD_SIZE - 1) / FLASH_WORD_SIZE, "layout change: %u operations", Operations(flash));
+
+	/* A value larger than the patch buffer is always written completely */
+	static uint8_t large[FLASHRECORDSTORE_PATCH_BUFFER_SIZE + 64];
+	Pattern(large, sizeof(large), KEY_B, 0);
+	CHECK(store.Update(KEY_B, large, sizeof(large)), "large value");
+	large[10] ^= 0xFF;
+	flash.ResetStatistics();
+	CHECK(store.Update(KEY_B, large, sizeof(large)) && Operations(flash) == (16 + sizeof(large) + FLASH_WORD_SIZE - 1) / FLASH_WORD_SIZE, "large value update: %u operations", Operations(flash));
+}
+
+/**
+ * @brief 	Store a parameter block TUNING_STORES times with 1-3 floats changed each time
+ * @param	patch      Input: store with Update() instead of Write()
+ * @param	programs   Output: number of flash word programs
+ * @param	erases     Output: number of sector erases
+ */
+static void TuningSession(bool patch, uint32_t& programs, uint32_t& erases)
+{
+	FlashEmulator flash(SECTOR_COUNT, 128*1024);
+	FlashRecordStore store(flash);
+	store.Format();
+
+	float parameters[PARAMETERS_SIZE / sizeof(float)];
+	for (uint32_t i = 0; i < PARAMETERS_SIZE / sizeof(float); i++)
+		parameters[i] = 0.1f * i;
+	store.Write(KEY_A, (const uint8_t *)parameters, PARAMETERS_SIZE);
+	flash.ResetStatistics();
+
+	randomState = 1;
+	bool success = true;
+	for (uint32_t n = 0; n < TUNING_STORES; n++) {
+		uint32_t changes = 1 + Random(3);
+		for (uint32_t i = 0; i < changes; i++)
+			parameters[Random(PARAMETERS_SIZE / sizeof(float))] += 0.01f;
+		if (patch)
+			success &= store.Update(KEY_A, (const uint8_t *)parameters, PARAMETERS_SIZE);
+		else
+			success &= store.Write(KEY_A, (const uint8_t *)parameters, PARAMETERS_SIZE);
+	}
+
+	FlashRecordStore rebooted(flash);
+	float stored[PARAMETERS_SIZE / sizeof(float)];
+	CHECK(success && rebooted.Init() && rebooted.Read(KEY_A, 0, (uint8_t *)stored, PARAMETERS_SIZE) == PARAMETERS_SIZE
+		  && !memcmp(parameters, stored, PARAMETERS_SIZE), "tuning session (%s)", patch ? "Update" : "Write");
+
+	programs = flash.GetProgramCount();
+	erases = flash.GetEraseCount();
+}
+
+static void TestTuningSession(void)
+{
+	uint32_t writePrograms, writeErases, updatePrograms, updateErases;
+	TuningSession(false, writePrograms, writeErases);
+	TuningSession(true, updatePrograms, updateErases);
+	printf("Tuning session, %u stores of %u bytes:\n", TUNING_STORES, PARAMETERS_SIZE);
+	printf("  Write:  %7u flash word programs, %4u sector erases\n", writePrograms, writeErases);
+	printf("  Update: %7u flash word programs, %4u sector erases\n", updatePrograms, updateErases);
+	CHECK(updatePrograms * 5 < writePrograms && updateErases * 5 < writeErases, "patch records do not reduce the flash operations");
+}
+
+/**
+ * @brief 	Update random bytes of REBUILD_KEYS keys, keeping a RAM copy of the values of the completed updates
+ * @retval	false if an update failed (power failure)
+ */
+static bool RandomUpdates(FlashRecordStore& store, uint8_t values[REBUILD_KEYS][REBUILD_LENGTH], uint32_t& pendingKey, uint8_t pending[REBUILD_LENGTH])
+{
+	for (uint32_t n = 0; n < REBUILD_UPDATES; n++) {
+		pendingKey = Random(REBUILD_KEYS);
+		memcpy(pending, values[pendingKey], REBUILD_LENGTH);
+		uint32_t changes = 1 + Random(4);
+		for (uint32_t i = 0; i < changes; i++)
+			pending[Random(REBUILD_LENGTH)] = (uint8_t)Random(256);
+		if (!store.Update(pendingKey + 1, pending, REBUILD_LENGTH)) return false;
+		memcpy(values[pendingKey], pending, REBUILD_LENGTH);
+	}
+	return true;
+}
+
+static bool HasValues(FlashRecordStore& store, uint8_t values[REBUILD_KEYS][REBUILD_LENGTH], uint32_t pendingKey, const uint8_t * pending)
+{
+	uint8_t stored[REBUILD_LENGTH];
+	for (uint32_t key = 0; key < REBUILD_KEYS; key++) {
+		if (store.Read(key + 1, 0, stored, REBUILD_LENGTH) != REBUILD_LENGTH) return false;
+		if (!memcmp(stored, values[key], REBUILD_LENGTH)) continue;
+		if (pending && key == pendingKey && !memcmp(stored, pending, REBUILD_LENGTH)) continue;
+		return false;
+	}
+	return true;
+}
+
+static void TestIndexRebuild(void)
+{
+	static uint8_t values[REBUILD_KEYS][REBUILD_LENGTH];
+	static uint8_t initial[REBUILD_KEYS][REBUILD_LENGTH];
+	uint8_t pending[REBUILD_LENGTH];
+	uint32_t pendingKey;
+
+	for (uint32_t key = 0; key < REBUILD_KEYS; key++)
+		Pattern(initial[key], REBUILD_LENGTH, key + 1, 0);
+
+	/* Reference sequence, which also counts the operations */
+	uint32_t operations;
+	{
+		FlashEmulator flash(SECTOR_COUNT, SECTOR_SIZE);
+		FlashRecordStore store(flash);
+		store.Format();
+		memcpy(values, initial, sizeof(values));
+		for (uint32_t key = 0; key < REBUILD_KEYS; key++)
+			store.Write(key + 1, values[key], REBUILD_LENGTH);
+		flash.ResetStatistics();
+
+		randomState = 7;
+		CHECK(RandomUpdates(store, values, pendingKey, pending), "updates without power failure");
+		operations = Operations(flash);
+		CHECK(flash.GetEraseCount() >= 2, "update sequence has to include compactions (%u erases)", flash.GetEraseCount());
+
+		FlashRecordStore rebooted(flash);
+		CHECK(rebooted.Init() && HasValues(rebooted, values, 0, 0), "index rebuilt at boot differs from the values");
+	}
+
+	/* Power failure during each operation of the update sequence */
+	uint32_t trials = 0;
+	for (uint32_t cut = 1; cut <= operations; cut++) {
+		FlashEmulator flash(SECTOR_COUNT, SECTOR_SIZE);
+		FlashRecordStore store(flash);
+		store.Format();
+		memcpy(values, initial, sizeof(values));
+		for (uint32_t key = 0; key < REBUILD_KEYS; key++)
+			store.Write(key + 1, values[key], REBUILD_LENGTH);
+		flash.SetPowerFailAfter(cut);
+
+		randomState = 7;
+		CHECK(!RandomUpdates(store, values, pendingKey, pending), "cut %u: power failure not triggered", cut);
+		flash.PowerOn();
+
+		FlashRecordStore rebooted(flash);
+		CHECK(rebooted.Init() && HasValues(rebooted, values, pendingKey, pending), "cut %u: values lost", cut);
+		trials++;
+	}
+
+	printf("Index rebuild: %u keys with patches, power failure at %u cut points\n", REBUILD_KEYS, trials);
+}
+
+/**
+ * @brief 	Fill the active sector of a store to a given level with records of the BOOT_KEYS keys in turn
+ * @param	fill   Input: fraction of the sector to fill
+ * @param	values Output: latest value of each key
+ * @retval	number of records written
+ */
+static uint32_t Fill(FlashRecordStore& store, float fill, uint8_t values[BOOT_KEYS][PARAMETERS_SIZE])
+{
+	uint32_t records = 0;
+	while (BOOT_SECTOR_SIZE - store.GetFreeSpace() < fill * BOOT_SECTOR_SIZE) {
+		uint32_t key = records % BOOT_KEYS;
+		Pattern(values[key], PARAMETERS_SIZE, key + 1, records);
+		if (!store.Write(key + 1, values[key], PARAMETERS_SIZE)) break;
+		records++;
+	}
+	return records;
+}
+
+static void TestBootTiming(void)
+{
+	const float fills[] = {0.10f, 0.50f, 0.95f};
+	static uint8_t values[BOOT_KEYS][PARAMETERS_SIZE];
+	uint8_t stored[PARAMETERS_SIZE];
+
+	printf("Boot timing, %u KB sector with %u byte records of %u keys (average of %u boots):\n", BOOT_SECTOR_SIZE / 1024, PARAMETERS_SIZE, BOOT_KEYS, BOOT_REPETITIONS);
+	for (uint32_t f = 0; f < sizeof(fills) / sizeof(fills[0]); f++) {
+		FlashEmulator flash(SECTOR_COUNT, BOOT_SECTOR_SIZE);
+		uint32_t records;
+		{
+			FlashRecordStore store(flash);
+			store.Format();
+			flash.ResetStatistics();
+			records = Fill(store, fills[f], values);
+			CHECK(flash.GetEraseCount() == 0, "fill %.0f%%: sector compacted while filling", 100 * fills[f]);
+		}
+
+		std::chrono::steady_clock::duration initTime(0), readTime(0);
+		bool success = true;
+		for (uint32_t n = 0; n < BOOT_REPETITIONS; n++) {
+			FlashRecordStore store(flash);
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			success &= store.Init();
+			std::chrono::steady_clock::time_point initialized = std::chrono::steady_clock::now();
+			for (uint32_t key = 0; key < BOOT_KEYS; key++)
+				success &= store.Read(key + 1, 0, stored, PARAMETERS_SIZE) == PARAMETERS_SIZE;
+			readTime += std::chrono::steady_clock::now() - initialized;
+			initTime += initialized - start;
+
+			for (uint32_t key = 0; key < BOOT_KEYS; key++) {
+				store.Read(key + 1, 0, stored, PARAMETERS_SIZE);
+				success &= !memcmp(stored, values[key], PARAMETERS_SIZE);
+			}
+		}
+		CHECK(success, "fill %.0f%%: boot", 100 * fills[f]);
+
+		printf("  fill %2.0f%% (%4u records): Init (log scan and index rebuild) %7.1f us, reading the %u keys %5.2f us\n", 100 * fills[f], records,
+			   std::chrono::duration<double, std::micro>(initTime).count() / BOOT_REPETITIONS, BOOT_KEYS,
+			   std::chrono::duration<double, std::micro>(readTime).count() / BOOT_REPETITIONS);
+	}
+}
+
+int main(void)
+{
+	TestPowerFailure();
+	TestPatchOperations();
+	TestTuningSession();
+	TestIndexRebuild();
+	TestBootTiming();
+
+	if (failures) {
+		printf("FlashRecordStoreTest: %d checks FAILED\n", failures);
+		return 1;
+	}
+	printf("FlashRecordStoreTest: passed\n");
+	return 0;
+}
@@ -0,0 +1,340 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+ 
+
+/* Host stress test of the priority classes of the LSPC transmitter under a saturated link.
+ *
+ * Like LSPCThroughputTest, the firmware socket runs on the deterministic FreeRTOS stand-in and the USB model of host/rtos.
+ * The test task floods the socket with telemetry and bulk packages of random size, far more than the link can carry, and
+ * queues control packages at random times in between. The PC side checks that:
+ *  - every queued package arrives exactly once, in order and unchanged, across the swaps of the two transfer buffers
+ *  - a package never overtakes a package of higher priority which was queued before it (strict priority)
+ *  - no control package is dropped, and control packages are not held back by the flood
+ *  - every transfer and every run of packages of one class starts with a Sequence package, whose sequence number matches
+ *    the packages received and whose dropped counter matches the packages the socket refused
+ *  - the packages are taken from the package pool of the socket: the flood makes no heap calls (counted by replacing the
+ *    C library allocation functions), the pool never runs empty, and every package is returned to it
+ * Build with build.sh.
+ */
+
+#include "LSPC.hpp"
+#include "cmsis_os.h"
+#include "USBCDC.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#define TEST_PRIORITY				6 // BALANCE_CONTROLLER_PRIORITY
+#define LSPC_RECEIVER_PRIORITY		11
+#define LSPC_TRANSMITTER_PRIORITY	13
+#define FLOOD_TIME					2000 // ms of simulated time
+#define CLASSES						lspc::TransmitTypes::PRIORITIES
+
+static int failures = 0;
+
+#define CHECK(condition, ...) do { if (!(condition)) { printf("FAILED: " __VA_ARGS__); printf("\n"); failures++; } } while (0)
+
+/* Count every heap call as in StaticArenaTest. Only one task of the scheduler runs at a time. */
+static unsigned long heapCalls = 0;
+
+extern "C" {
+
+void * __libc_malloc(size_t size);
+void * __libc_calloc(size_t count, size_t size);
+void * __libc_realloc(void * ptr, size_t size);
+void __libc_free(void * ptr);
+
+void * malloc(size_t size)
+{
+	heapCalls++;
+	return __libc_malloc(size);
+}
+
+void * calloc(size_t count, size_t size)
+{
+	heapCalls++;
+	return __libc_calloc(count, size);
+}
+
+void * realloc(void * ptr, size_t size)
+{
+	heapCalls++;
+	return __libc_realloc(ptr, size);
+}
+
+void free(void * ptr)
+{
+	if (ptr) heapCalls++;
+	__libc_free(ptr);
+}
+
+}
+
+/* Every package starts with its position in the order of all queued packages, its sequence number within its class
+ * and the time it was queued. The rest of the payload is filled with a pattern of the sequence number. */
+typedef struct {
+	uint32_t order;
+	uint32_t sequence;
+	uint32_t time; // us
+} Stamp_t;
+
+typedef struct {
+	const char * name;
+	lspc::MessageTypesToPC::MessageTypesToPC_t types[3];
+
+	/* Producer */
+	std::vector<uint32_t> queuedOrder; // order of each queued package
+	uint32_t refused;
+
+	/* PC */
+	uint32_t received;
+	uint32_t lost; // or out of order
+	uint32_t corrupt;
+	uint32_t overtaking; // packages which arrived before a package of higher priority queued before them
+	uint32_t latencyMax; // us
+	uint32_t sequences; // Sequence packages
+	uint32_t sequenceErrors;
+	uint32_t reportedDropped;
+} Class_t;
+
+static Class_t classes[CLASSES] = {
+	{ "control", { lspc::MessageTypesToPC::SetParameterAck, lspc::MessageTypesToPC::TransferAck, lspc::MessageTypesToPC::CalibrateIMUAck }, std::vector<uint32_t>(), 0, 0, 0, 0, 0, 0, 0, 0, 0 },
+	{ "telemetry", { lspc::MessageTypesToPC::StateEstimates, lspc::MessageTypesToPC::RawSensor_Encoders, lspc::MessageTypesToPC::SensorSample }, std::vector<uint32_t>(), 0, 0, 0, 0, 0, 0, 0, 0, 0 },
+	{ "bulk", { lspc::MessageTypesToPC::MathDump, lspc::MessageTypesToPC::DebugLog, lspc::MessageTypesToPC::RunTimeStats }, std::vector<uint32_t>(), 0, 0, 0, 0, 0, 0, 0, 0, 0 },
+};
+
+static uint32_t queuedPackages = 0;
+static uint32_t poolMinimum = LSPC_PACKAGE_POOL_SIZE; // fewest packages left in the pool of the socket
+static uint32_t outsidePool = 0; // reserved packages whose payload is not part of the socket
+
+static uint32_t randomState = 2019;
+static uint32_t Random(uint32_t range)
+{
+	randomState = randomState * 1103515245 + 12345;
+	return (randomState >> 8) % range;
+}
+
+static uint8_t Pattern(uint32_t sequence, uint32_t index)
+{
+	return (uint8_t)(sequence * 7 + index);
+}
+
+/* PC side of the link, which checks the framing of every transfer */
+class PCSocket : public lspc::SocketBase
+{
+	public:
+		PCSocket() : transfers(0), transferStart(false), runClass(CLASSES), missingSequence(0)
+		{
+			incoming_data.reserve(LSPC_MAXIMUM_FRAME_LENGTH); // as in the processing thread of the firmware socket
+			incoming_payload.reserve(LSPC_MAXIMUM_PAYLOAD_LENGTH);
+		};
+
+		bool send(uint8_t type, const std::vector<uint8_t> &payload) override { (void)type; (void)payload; return false; };
+
+		static void Receive(void * param, const uint8_t * data, uint32_t length)
+		{
+			PCSocket * pc = (PCSocket *)param;
+			pc->transfers++;
+			pc->transferStart = true;
+			pc->runClass = CLASSES;
+			for (uint32_t i = 0; i < length; i++)
+				pc->processIncomingByte(data[i]);
+		}
+
+		uint32_t transfers;
+		bool transferStart; // no package of the transfer decoded yet
+		uint32_t runClass; // class announced by the latest Sequence package of the transfer
+		uint32_t missingSequence; // packages without a Sequence package of their class in front of them
+};
+
+static PCSocket pc;
+
+static void Sequence_Callback(void * param, const std::vector<uint8_t>& payload)
+{
+	(void)param;
+	lspc::TransmitTypes::Sequence_t sequence;
+	pc.transferStart = false;
+	if (payload.size() != sizeof(sequence)) {
+		pc.runClass = CLASSES;
+		return;
+	}
+	memcpy(&sequence, payload.data(), sizeof(sequence));
+	if (sequence.priority >= CLASSES) {
+		pc.runClass = CLASSES;
+		return;
+	}
+
+	/* Nothing is lost after queueing, so the sequence number is the number of packages received, and the dropped counter only grows */
+	Class_t& c = classes[sequence.priority];
+	c.sequences++;
+	if (sequence.sequence != (uint16_t)c.received || sequence.dropped < c.reportedDropped) c.sequenceErrors++;
+	c.reportedDropped = sequence.dropped;
+	pc.runClass = sequence.priority;
+}
+
+static void Package_Callback(void * param, const std::vector<uint8_t>& payload)
+{
+	uint32_t priority = (uint32_t)(uintptr_t)param;
+	Class_t& c = classes[priority];
+
+	if (pc.transferStart || pc.runClass != priority) pc.missingSequence++;
+	pc.transferStart = false;
+
+	Stamp_t stamp;
+	if (payload.size() < sizeof(stamp)) {
+		c.corrupt++;
+		return;
+	}
+	memcpy(&stamp, payload.data(), sizeof(stamp));
+	for (size_t i = sizeof(stamp); i < payload.size(); i++)
+		if (payload[i] != Pattern(stamp.sequence, i)) {
+			c.corrupt++;
+			break;
+		}
+
+	if (stamp.sequence != c.received || stamp.sequence >= c.queuedOrder.size() || c.queuedOrder[stamp.sequence] != stamp.order) c.lost++;
+
+	/* The first package of each higher class which has not arrived yet must have been queued after this one */
+	for (uint32_t h = 0; h < priority; h++)
+		if (classes[h].received < classes[h].queuedOrder.size() && classes[h].queuedOrder[classes[h].received] < stamp.order)
+			c.overtaking++;
+
+	uint32_t latency = (uint32_t)HostScheduler::Get().Now() - stamp.time;
+	if (latency > c.latencyMax) c.latencyMax = latency;
+	c.received++;
+}
+
+static void Send(LSPC& lspc, uint32_t priority, uint16_t length)
+{
+	Class_t& c = classes[priority];
+	uint8_t payload[LSPC_MAXIMUM_PACKAGE_LENGTH];
+
+	Stamp_t stamp = { queuedPackages, (uint32_t)c.queuedOrder.size(), (uint32_t)HostScheduler::Get().Now() };
+	memcpy(payload, &stamp, sizeof(stamp));
+	for (size_t i = sizeof(stamp); i < length; i++)
+		payload[i] = Pattern(stamp.sequence, i);
+
+	uint8_t type = c.types[Random(3)];
+	bool queued;
+	if (Random(2)) {
+		queued = lspc.TransmitAsync(type, payload, length);
+	} else {
+		/* Filled in place before the final length is known, like Parameters::GetParameters_Callback */
+		lspc::LSPC_Async_Package_t package;
+		queued = lspc.Reserve(type, LSPC_MAXIMUM_PACKAGE_LENGTH, package);
+		if (queued) {
+			if (package.payload < (uint8_t *)&lspc || package.payload + LSPC_MAXIMUM_PACKAGE_LENGTH > (uint8_t *)(&lspc + 1)) outsidePool++;
+			memcpy(package.payload, payload, length);
+			lspc.Shrink(package, length);
+			queued = lspc.Submit(package);
+		}
+	}
+
+	if (queued) {
+		c.queuedOrder.push_back(queuedPackages++);
+	} else {
+		c.refused++;
+	}
+	if (lspc.GetPoolAvailable() < poolMinimum) poolMinimum = lspc.GetPoolAvailable();
+}
+
+int main(void)
+{
+	HostScheduler& scheduler = HostScheduler::Get();
+	scheduler.Attach(TEST_PRIORITY);
+
+	USBCDC usb;
+	LSPC * lspc = new LSPC(&usb, LSPC_RECEIVER_PRIORITY, LSPC_TRANSMITTER_PRIORITY); // never deleted, since its tasks never end
+	usb.Connect(&PCSocket::Receive, &pc);
+	pc.registerCallback(lspc::MessageTypesToPC::Sequence, &Sequence_Callback);
+	for (uint32_t p = 0; p < CLASSES; p++)
+		for (int t = 0; t < 3; t++)
+			pc.registerCallback(classes[p].types[t], &Package_Callback, (void *)(uintptr_t)p);
+
+	for (uint32_t p = 0; p < CLASSES; p++)
+		classes[p].queuedOrder.reserve(FLOOD_TIME * 100); // more than can be queued, such that the bookkeeping does not use the heap either
+	unsigned long calls = heapCalls;
+
+	/* Every millisecond about 30 telemetry and 35 bulk packages of up to 250 bytes, around 9 MB/s, and one control package
+	 * on average, in random order and partly at random times within the millisecond */
+	for (uint32_t ms = 0; ms < FLOOD_TIME; ms++) {
+		uint32_t remaining[CLASSES] = { Random(3), 20 + Random(20), 20 + Random(30) };
+		while (remaining[0] + remaining[1] + remaining[2] > 0) {
+			uint32_t pick = Random(remaining[0] + remaining[1] + remaining[2]);
+			uint32_t priority = (pick < remaining[0]) ? 0 : (pick < remaining[0] + remaining[1]) ? 1 : 2;
+			remaining[priority]--;
+			Send(*lspc, priority, sizeof(Stamp_t) + Random(LSPC_MAXIMUM_PACKAGE_LENGTH - sizeof(Stamp_t) + 1));
+			if (Random(16) == 0) scheduler.DelayUntil(scheduler.Now() + Random(300));
+		}
+		scheduler.DelayUntil((uint64_t)(ms + 1) * 1000);
+	}
+
+	/* After the flood one more package of each class reports the final dropped counters */
+	osDelay(50);
+	for (uint32_t p = 0; p < CLASSES; p++)
+		Send(*lspc, p, sizeof(Stamp_t));
+	osDelay(20);
+	calls = heapCalls - calls;
+
+	printf("%u ms flood, %u transfers, %u packages queued:\n", FLOOD_TIME, pc.transfers, queuedPackages);
+	for (uint32_t p = 0; p < CLASSES; p++) {
+		Class_t& c = classes[p];
+		printf("  %-9s: %6u queued, %6u refused, %6u received, %u lost, %u corrupt, %u overtaking, max latency %5.2f ms, %u Sequence packages\n",
+			   c.name, (uint32_t)c.queuedOrder.size(), c.refused, c.received, c.lost, c.corrupt, c.overtaking, c.latencyMax / 1000.0, c.sequences);
+
+		CHECK(c.received == c.queuedOrder.size() && c.lost == 0 && c.corrupt == 0, "%s: %u of %u packages received, %u lost or out of order, %u corrupt",
+			  c.name, c.received, (uint32_t)c.queuedOrder.size(), c.lost, c.corrupt);
+		CHECK(c.overtaking == 0, "%s: %u packages overtook a package of higher priority", c.name, c.overtaking);
+		CHECK(c.sequenceErrors == 0, "%s: %u Sequence packages do not match the packages received", c.name, c.sequenceErrors);
+		CHECK(c.reportedDropped == c.refused && lspc->GetDropped((lspc::TransmitTypes::priority_t)p) == c.refused, "%s: %u packages refused, %u reported dropped, %u counted by the socket",
+			  c.name, c.refused, c.reportedDropped, lspc->GetDropped((lspc::TransmitTypes::priority_t)p));
+	}
+
+	/* The link was saturated, yet control packages are neither dropped nor delayed by more than the transfers ahead of them (see LSPCThroughputTest) */
+	CHECK(classes[1].refused > 0 && classes[2].refused > 0, "the link was not saturated");
+	CHECK(classes[0].refused == 0, "%u control packages dropped", classes[0].refused);
+	CHECK(classes[0].latencyMax <= 4 * USBCDC_FRAME_US, "control package latency %u us", classes[0].latencyMax);
+	CHECK(pc.missingSequence == 0, "%u packages without a Sequence package in front of them", pc.missingSequence);
+
+	printf("  %lu heap calls, at least %u of %u packages left in the pool\n", calls, poolMinimum, LSPC_PACKAGE_POOL_SIZE);
+	CHECK(calls == 0, "%lu heap calls during the flood", calls);
+	CHECK(outsidePool == 0, "%u packages are not part of the package pool", outsidePool);
+	CHECK(poolMinimum > 0, "the package pool ran empty");
+	CHECK(lspc->GetPoolAvailable() == LSPC_PACKAGE_POOL_SIZE, "%u of %u packages returned to the pool", lspc->GetPoolAvailable(), LSPC_PACKAGE_POOL_SIZE);
+
+	/* An empty pool refuses the package instead of allocating one, and released packages are available again */
+	static lspc::LSPC_Async_Package_t reserved[LSPC_PACKAGE_POOL_SIZE];
+	uint32_t count = 0;
+	while (count < LSPC_PACKAGE_POOL_SIZE && lspc->Reserve(lspc::MessageTypesToPC::TransferAck, LSPC_MAXIMUM_PACKAGE_LENGTH, reserved[count]))
+		count++;
+	lspc::LSPC_Async_Package_t package;
+	CHECK(count == LSPC_PACKAGE_POOL_SIZE && !lspc->Reserve(lspc::MessageTypesToPC::TransferAck, 1, package), "%u packages reserved from a pool of %u", count, LSPC_PACKAGE_POOL_SIZE);
+	for (uint32_t i = 0; i < count; i++)
+		lspc->Release(reserved[i]);
+	CHECK(lspc->GetPoolAvailable() == LSPC_PACKAGE_POOL_SIZE, "%u of %u packages available after the release", lspc->GetPoolAvailable(), LSPC_PACKAGE_POOL_SIZE);
+
+	if (failures) {
+		printf("LSPCStressTest: %d checks FAILED\n", failures);
+		return 1;
+	}
+	printf("LSPCStressTest: passed\n");
+	return 0;
+}
@@ -0,0 +1,215 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+ 
+
+/* Host loopback harness of the LSPC transmitter, which measures the telemetry bandwidth and the latency of the packages.
+ *
+ * The firmware socket (LSPC.hpp) runs with its transmitter and processing tasks on the deterministic FreeRTOS stand-in
+ * of host/rtos, and transmits over the USB full speed model of host/rtos/USBCDC.h. The PC side decodes the completed
+ * transfers with SocketBase. The test task sends the message mix of the balance loop every 5 ms, multiplied by a load
+ * factor, and acknowledges at random times in between. It checks that at the normal load every package arrives in order
+ * within the coalescing timeout, that the packages are combined into few transfers, and that acknowledges are sent right
+ * away at every load. Build with build.sh.
+ */
+
+#include "LSPC.hpp"
+#include "cmsis_os.h"
+#include "USBCDC.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define TEST_PRIORITY			6 // BALANCE_CONTROLLER_PRIORITY
+#define LSPC_RECEIVER_PRIORITY	11
+#define LSPC_TRANSMITTER_PRIORITY	13
+#define SAMPLE_PERIOD			5000 // us
+#define RUN_TIME				2000000 // us of simulated time per load
+#define ACK_PERIOD				20 // samples between acknowledges
+
+static int failures = 0;
+
+#define CHECK(condition, ...) do { if (!(condition)) { printf("FAILED: " __VA_ARGS__); printf("\n"); failures++; } } while (0)
+
+/* Every package starts with its sequence number and the time it was queued */
+typedef struct {
+	uint32_t sequence;
+	uint32_t time; // us
+} Stamp_t;
+
+typedef struct {
+	lspc::MessageTypesToPC::MessageTypesToPC_t type;
+	uint16_t length; // payload bytes
+	uint32_t sent;
+	uint32_t received;
+	uint32_t nextSequence;
+	uint32_t outOfOrder;
+	uint64_t latencySum;
+	uint32_t latencyMax;
+} Stream_t;
+
+/* Packages of one balance loop sample, 292 bytes */
+static Stream_t telemetry[] = {
+	{ lspc::MessageTypesToPC::StateEstimates, 88, 0, 0, 0, 0, 0, 0 },
+	{ lspc::MessageTypesToPC::ControllerInfo, 72, 0, 0, 0, 0, 0, 0 },
+	{ lspc::MessageTypesToPC::RawSensor_IMU_MPU9250, 60, 0, 0, 0, 0, 0, 0 },
+	{ lspc::MessageTypesToPC::RawSensor_Encoders, 44, 0, 0, 0, 0, 0, 0 },
+	{ lspc::MessageTypesToPC::CompactTelemetry, 28, 0, 0, 0, 0, 0, 0 },
+};
+#define TELEMETRY_STREAMS	(sizeof(telemetry) / sizeof(Stream_t))
+
+static Stream_t ack = { lspc::MessageTypesToPC::SetParameterAck, 12, 0, 0, 0, 0, 0, 0 };
+
+static uint32_t randomState = 4711;
+static uint32_t Random(uint32_t range)
+{
+	randomState = randomState * 1103515245 + 12345;
+	return (randomState >> 8) % range;
+}
+
+/* PC side of the link */
+class PCSocket : public lspc::SocketBase
+{
+	public:
+		bool send(uint8_t type, const std::vector<uint8_t> &payload) override { (void)type; (void)payload; return false; };
+
+		static void Receive(void * param, const uint8_t * data, uint32_t length)
+		{
+			PCSocket * pc = (PCSocket *)param;
+			for (uint32_t i = 0; i < length; i++)
+				pc->processIncomingByte(data[i]);
+		}
+};
+
+static void Package_Callback(void * param, const std::vector<uint8_t>& payload)
+{
+	Stream_t * stream = (Stream_t *)param;
+	Stamp_t stamp;
+	if (payload.size() != stream->length) {
+		stream->outOfOrder++;
+		return;
+	}
+	memcpy(&stamp, payload.data(), sizeof(stamp));
+	if (stamp.sequence != stream->nextSequence) stream->outOfOrder++;
+	stream->nextSequence = stamp.sequence + 1;
+	stream->received++;
+
+	uint32_t latency = (uint32_t)HostScheduler::Get().Now() - stamp.time;
+	stream->latencySum += latency;
+	if (latency > stream->latencyMax) stream->latencyMax = latency;
+}
+
+static void Send(LSPC& lspc, Stream_t& stream)
+{
+	uint8_t payload[LSPC_MAXIMUM_PACKAGE_LENGTH];
+	memset(payload, 0xA5, stream.length);
+	Stamp_t stamp = { stream.sent, (uint32_t)HostScheduler::Get().Now() };
+	memcpy(payload, &stamp, sizeof(stamp));
+	if (lspc.TransmitAsync(stream.type, payload, stream.length))
+		stream.sent++; // only queued packages are numbered, so a dropped package leaves no gap
+}
+
+static void ResetStream(Stream_t& stream)
+{
+	stream.sent = stream.received = stream.nextSequence = stream.outOfOrder = 0;
+	stream.latencySum = stream.latencyMax = 0;
+}
+
+static void RunLoad(LSPC& lspc, USBCDC& usb, uint32_t load)
+{
+	HostScheduler& scheduler = HostScheduler::Get();
+	for (size_t s = 0; s < TELEMETRY_STREAMS; s++) ResetStream(telemetry[s]);
+	ResetStream(ack);
+	uint32_t dropped = lspc.GetDropped(lspc::TransmitTypes::TELEMETRY);
+	uint64_t transfers = usb.GetTransfers(), packets = usb.GetPackets();
+
+	uint64_t start = scheduler.Now();
+	uint32_t samples = RUN_TIME / SAMPLE_PERIOD;
+	for (uint32_t sample = 0; sample < samples; sample++) {
+		scheduler.DelayUntil(start + (uint64_t)sample * SAMPLE_PERIOD);
+		for (uint32_t i = 0; i < load; i++)
+			for (size_t s = 0; s < TELEMETRY_STREAMS; s++)
+				Send(lspc, telemetry[s]);
+
+		if (sample % ACK_PERIOD == ACK_PERIOD / 2) { // a request of the PC answered at a random time between two samples
+			scheduler.DelayUntil(scheduler.Now() + Random(SAMPLE_PERIOD));
+			Send(lspc, ack);
+		}
+	}
+	scheduler.DelayUntil(start + RUN_TIME + 20000); // let the queues drain
+
+	uint32_t sent = 0, received = 0, outOfOrder = 0, latencyMax = 0, bytes = 0;
+	uint64_t latencySum = 0;
+	for (size_t s = 0; s < TELEMETRY_STREAMS; s++) {
+		sent += telemetry[s].sent;
+		received += telemetry[s].received;
+		outOfOrder += telemetry[s].outOfOrder;
+		latencySum += telemetry[s].latencySum;
+		if (telemetry[s].latencyMax > latencyMax) latencyMax = telemetry[s].latencyMax;
+		bytes += telemetry[s].received * telemetry[s].length;
+	}
+	dropped = lspc.GetDropped(lspc::TransmitTypes::TELEMETRY) - dropped;
+	transfers = usb.GetTransfers() - transfers;
+	packets = usb.GetPackets() - packets;
+
+	double seconds = RUN_TIME * 1e-6;
+	printf("  load %2u: offered %4.0f kB/s, delivered %4.0f kB/s, %4.0f transfers/s, %4.0f USB packets/s, %5.1f%% dropped, latency avg %4.2f ms, max %4.2f ms, ack avg %4.2f ms, max %4.2f ms\n",
+		   load, (double)load * 292 / SAMPLE_PERIOD * 1000, bytes / seconds / 1000, transfers / seconds, packets / seconds,
+		   100.0 * dropped / (sent + dropped), received ? latencySum / 1000.0 / received : 0, latencyMax / 1000.0, ack.received ? ack.latencySum / 1000.0 / ack.received : 0, ack.latencyMax / 1000.0);
+
+	/* Queued packages arrive exactly once and in order at every load, and acknowledges are never dropped */
+	CHECK(received == sent && outOfOrder == 0, "load %u: %u of %u telemetry packages received, %u out of order", load, received, sent, outOfOrder);
+	CHECK(ack.received == ack.sent && ack.sent == (samples + ACK_PERIOD / 2) / ACK_PERIOD && ack.outOfOrder == 0, "load %u: %u of %u acknowledges received", load, ack.received, ack.sent);
+
+	/* An acknowledge flushes the transfer right away. It only waits for the rest of the transfer in progress, the transfer
+	 * prepared meanwhile and its own transfer, each of which starts at a USB frame and takes less than a frame. */
+	CHECK(ack.latencyMax <= 4 * USBCDC_FRAME_US, "load %u: acknowledge latency %u us", load, ack.latencyMax);
+
+	if (load == 1) { // the balance loop at 200 Hz
+		CHECK(dropped == 0, "%u telemetry packages dropped at the normal load", dropped);
+		CHECK(latencyMax <= LSPC_COALESCE_TIMEOUT * 1000 + 2 * USBCDC_FRAME_US, "telemetry latency %u us at the normal load", latencyMax);
+		CHECK(transfers * 3 <= sent + ack.sent, "%u packages sent in %u transfers at the normal load", sent + ack.sent, (uint32_t)transfers);
+		/* Without the coalescing timeout an acknowledge mostly waits for the next USB frame only, half a frame on average */
+		CHECK(ack.latencySum <= (uint64_t)ack.received * USBCDC_FRAME_US * 3 / 4, "average acknowledge latency %u us at the normal load", (uint32_t)(ack.latencySum / (ack.received ? ack.received : 1)));
+	}
+}
+
+int main(void)
+{
+	HostScheduler::Get().Attach(TEST_PRIORITY);
+
+	USBCDC usb;
+	LSPC * lspc = new LSPC(&usb, LSPC_RECEIVER_PRIORITY, LSPC_TRANSMITTER_PRIORITY); // never deleted, since its tasks never end
+	PCSocket pc;
+	usb.Connect(&PCSocket::Receive, &pc);
+	for (size_t s = 0; s < TELEMETRY_STREAMS; s++)
+		pc.registerCallback(telemetry[s].type, &Package_Callback, &telemetry[s]);
+	pc.registerCallback(ack.type, &Package_Callback, &ack);
+
+	printf("Balance loop telemetry (292 bytes per %u us sample, multiplied by the load) with an acknowledge every %u samples:\n", SAMPLE_PERIOD, ACK_PERIOD);
+	const uint32_t loads[] = { 1, 2, 4, 8, 16 };
+	for (size_t i = 0; i < sizeof(loads) / sizeof(loads[0]); i++)
+		RunLoad(*lspc, usb, loads[i]);
+
+	if (failures) {
+		printf("LSPCThroughputTest: %d checks FAILED\n", failures);
+		return 1;
+	}
+	printf("LSPCThroughputTest: passed\n");
+	return 0;
+}
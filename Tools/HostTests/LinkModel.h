@@ -0,0 +1,138 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+ 
+
+#ifndef HOSTTESTS_LINKMODEL_H
+#define HOSTTESTS_LINKMODEL_H
+
+#include "LSPC.hpp"
+#include <stdint.h>
+#include <vector>
+
+/* Model of the serial link between two host LSPC sockets (the PC and the robot) with simulated time.
+ * Each direction transmits the encoded frames one after another at a given rate and delivers them after a latency.
+ * Frames can be dropped at random, and delayed at random such that later frames overtake them (reordering).
+ * The random numbers are deterministic for a given seed, such that a failing case can be reproduced. */
+class LinkModel
+{
+	public:
+		LinkModel(LSPC& pc, LSPC& robot, uint32_t seed, uint32_t bytesPerSecond = 1000000, uint32_t latency_us = 1000)
+			: now_(0), random_(seed), dropRate_(0), reorderRate_(0), reorderDelay_(0), bytesPerSecond_(bytesPerSecond), latency_(latency_us), frames_(0), dropped_(0), reordered_(0)
+		{
+			toRobot_.link = this; toRobot_.to = &robot; toRobot_.freeAt = 0;
+			toPC_.link = this; toPC_.to = &pc; toPC_.freeAt = 0;
+			pc.Connect(&Transmit, &toRobot_);
+			robot.Connect(&Transmit, &toPC_);
+		}
+
+		/* Fraction of the frames which are lost */
+		void SetDropRate(float rate) { dropRate_ = rate; }
+
+		/* Fraction of the frames which are delayed by up to 'delay' after the frames sent after them */
+		void SetReordering(float rate, uint32_t delay_us) { reorderRate_ = rate; reorderDelay_ = delay_us; }
+
+		/* Deliver the next frame, if it arrives before the deadline. The simulated time advances to its arrival.
+		 * @retval	false if no frame arrives before the deadline */
+		bool Step(uint64_t deadline)
+		{
+			size_t next = inFlight_.size();
+			for (size_t i = 0; i < inFlight_.size(); i++)
+				if (next == inFlight_.size() || inFlight_[i].arrival < inFlight_[next].arrival)
+					next = i;
+			if (next == inFlight_.size() || inFlight_[next].arrival > deadline) return false;
+
+			Frame_t frame = inFlight_[next];
+			inFlight_.erase(inFlight_.begin() + next);
+			if (frame.arrival > now_) now_ = frame.arrival;
+			frame.to->Deliver(frame.data.data(), frame.data.size());
+			return true;
+		}
+
+		/* Let the simulated time pass, eg. until a timeout */
+		void Advance(uint64_t time) { if (time > now_) now_ = time; }
+
+		uint64_t Now(void) const { return now_; }
+		bool Idle(void) const { return inFlight_.empty(); }
+		uint32_t GetFrames(void) const { return frames_; }
+		uint32_t GetDropped(void) const { return dropped_; }
+		uint32_t GetReordered(void) const { return reordered_; }
+
+		uint32_t Random(uint32_t range)
+		{
+			random_ = random_ * 1664525 + 1013904223;
+			return (random_ >> 8) % range;
+		}
+
+	private:
+		typedef struct {
+			LinkModel * link;
+			LSPC * to;
+			uint64_t freeAt; // time at which the previous frame has been transmitted
+		} Direction_t;
+
+		typedef struct {
+			uint64_t arrival;
+			LSPC * to;
+			std::vector<uint8_t> data;
+		} Frame_t;
+
+		static void Transmit(void * param, const uint8_t * data, uint16_t length)
+		{
+			Direction_t * direction = (Direction_t *)param;
+			LinkModel * link = direction->link;
+
+			uint64_t start = (direction->freeAt > link->now_) ? direction->freeAt : link->now_;
+			direction->freeAt = start + ((uint64_t)length * 1000000 + link->bytesPerSecond_ - 1) / link->bytesPerSecond_;
+			link->frames_++;
+
+			if (link->Random(1000000) < link->dropRate_ * 1000000) {
+				link->dropped_++;
+				return;
+			}
+
+			Frame_t frame;
+			frame.arrival = direction->freeAt + link->latency_;
+			if (link->reorderDelay_ > 0 && link->Random(1000000) < link->reorderRate_ * 1000000) {
+				frame.arrival += 1 + link->Random(link->reorderDelay_);
+				link->reordered_++;
+			}
+			frame.to = direction->to;
+			frame.data.assign(data, data + length);
+			link->inFlight_.push_back(frame);
+		}
+
+	private:
+		uint64_t now_; // simulated time [us]
+		uint32_t random_;
+		float dropRate_;
+		float reorderRate_;
+		uint32_t reorderDelay_;
+		uint32_t bytesPerSecond_;
+		uint32_t latency_;
+
+		Direction_t toRobot_;
+		Direction_t toPC_;
+		std::vector<Frame_t> inFlight_;
+
+		uint32_t frames_;
+		uint32_t dropped_;
+		uint32_t reordered_;
+};
+
+#endif
@@ -0,0 +1,258 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+ 
+
+/* Host round trip test of the deferred binary logging: the LOG macro and the ring of Log.cpp encode the records like on
+ * the target, the packages are assembled like by the Debug transmitter thread, and LogDecoder.hpp rebuilds the text.
+ *
+ * Log.cpp is built with LOG_HOST, where the 'log_strings' section is loaded and the format table is read from it
+ * instead of from the firmware ELF file. The test compares the decoded text with printf of the same format and arguments,
+ * checks the order and count of records across many wrap-arounds of the ring, the dropping of records when the ring is
+ * full, concurrent producers and corrupt packages. Build with build.sh.
+ */
+
+#include "Log.h"
+#include "LogDecoder.hpp"
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <thread>
+#include <vector>
+
+#define PACKAGE_WORDS		62 // MAX_DEBUG_LOG_WORDS of Debug.h, including the dropped counter
+#define WRAP_RECORDS		100000
+#define PRODUCERS			4
+#define PRODUCER_RECORDS	20000
+
+/* Bounds of the format table, defined by the linker for the loaded 'log_strings' section */
+extern "C" const char __start_log_strings[];
+extern "C" const char __stop_log_strings[];
+
+static int failures = 0;
+
+#define CHECK(condition, ...) do { if (!(condition)) { printf("FAILED: " __VA_ARGS__); printf("\n"); failures++; } } while (0)
+
+static LogDecoder decoder(std::vector<char>(__start_log_strings, __stop_log_strings));
+
+static uint32_t randomState = 12345;
+static uint32_t Random(uint32_t range)
+{
+	randomState = randomState * 1103515245 + 12345;
+	return (randomState >> 8) % range;
+}
+
+/* Read one package from the ring like Debug::TransmitLog and decode it */
+static std::vector<LogDecoder::Record_t> ReadPackage(uint32_t maxWords = PACKAGE_WORDS)
+{
+	uint32_t package[PACKAGE_WORDS];
+	package[0] = Log::GetDropped();
+	uint32_t words = Log::Read(&package[1], maxWords - 1);
+	if (words == 0) return std::vector<LogDecoder::Record_t>();
+	return decoder.Decode((const uint8_t *)package, (words + 1) * sizeof(uint32_t));
+}
+
+/* Log a record and compare the decoded text with printf of the same arguments */
+#define CHECK_ROUND_TRIP(format, ...) do { \
+		LOG(format, ##__VA_ARGS__); \
+		char expected[256]; \
+		snprintf(expected, sizeof(expected), format, ##__VA_ARGS__); \
+		std::vector<LogDecoder::Record_t> records = ReadPackage(); \
+		CHECK(records.size() == 1, "%u records decoded for \"%s\"", (unsigned int)records.size(), format); \
+		if (records.size() == 1) CHECK(records[0].text == expected, "decoded \"%s\", expected \"%s\"", records[0].text.c_str(), expected); \
+	} while (0)
+
+static void TestFormats(void)
+{
+	CHECK_ROUND_TRIP("No arguments\n");
+	CHECK_ROUND_TRIP("Integers: %d %i %u %5d|%-5d|%05d\n", -12345, 42, 4000000000u, 7, -7, 99);
+	CHECK_ROUND_TRIP("Hex and octal: %x %X %08x %#o\n", 0xDEADBEEFu, 0xABCDu, 0x1234u, 8u);
+	CHECK_ROUND_TRIP("Small types: %d %d %u %d %u %c\n", (short)-300, (signed char)-5, (unsigned short)65000, true, (unsigned char)200, 'K');
+	CHECK_ROUND_TRIP("Long: %ld %lu %lx\n", -100000L, 3000000000UL, 0xCAFEUL);
+	CHECK_ROUND_TRIP("Floats: %f %4.2f %.3e %g %-8.1f|\n", 1.5f, -0.25f, 1024.0f, 0.125f, 3.0f);
+	CHECK_ROUND_TRIP("Double as float: %f %lf\n", 2.75, -8.5);
+	CHECK_ROUND_TRIP("Percent: 100%% of %d\n", 3);
+	CHECK_ROUND_TRIP("Sixteen: %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d\n", 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16);
+
+	/* Missing arguments and unsupported conversions are marked instead of read past the record */
+	const uint32_t args[1] = { 5 };
+	CHECK(LogDecoder::Format("%d %d", args, 1) == "5 <?>", "missing argument decoded as \"%s\"", LogDecoder::Format("%d %d", args, 1).c_str());
+	CHECK(LogDecoder::Format("%s", args, 1) == "<%s?>", "string argument decoded as \"%s\"", LogDecoder::Format("%s", args, 1).c_str());
+}
+
+/* Records of 4, 8 and 19 words, such that the ring wraps at varying positions with padding records */
+static void WriteSequence(uint32_t seq)
+{
+	switch (seq % 3) {
+		case 0: LOG("seq %u\n", seq); break;
+		case 1: LOG("seq %u %d %d %d %d\n", seq, -1, -2, -3, -4); break;
+		default: LOG("seq %u %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d\n", seq, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15); break;
+	}
+}
+
+static bool ParseSequence(const LogDecoder::Record_t& record, uint32_t * seq)
+{
+	return sscanf(record.text.c_str(), "seq %u", seq) == 1;
+}
+
+static void TestWrapAround(void)
+{
+	uint32_t dropped = Log::GetDropped();
+	uint32_t written = 0, expected = 0;
+	bool ordered = true, complete = true;
+
+	while (expected < WRAP_RECORDS) {
+		/* Write a burst which fits into the ring, then read a few packages of random size */
+		uint32_t burst = Random(60);
+		for (uint32_t i = 0; i < burst && written < WRAP_RECORDS && Log::GetPending() + 2*19 <= LOG_BUFFER_SIZE; i++)
+			WriteSequence(written++);
+
+		uint32_t packages = 1 + Random(4);
+		for (uint32_t p = 0; p < packages; p++) {
+			std::vector<LogDecoder::Record_t> records = ReadPackage(20 + Random(PACKAGE_WORDS - 20 + 1));
+			for (size_t i = 0; i < records.size(); i++) {
+				uint32_t seq;
+				if (!ParseSequence(records[i], &seq)) complete = false;
+				else if (seq != expected) ordered = false;
+				expected++;
+			}
+		}
+	}
+
+	CHECK(ordered && complete, "records out of order or not decoded after %u records", expected);
+	CHECK(written == WRAP_RECORDS && expected == WRAP_RECORDS, "%u records written, %u read", written, expected);
+	CHECK(Log::GetDropped() == dropped, "%u records dropped while the ring did not overflow", Log::GetDropped() - dropped);
+	CHECK(Log::GetPending() == 0, "%u words left in the ring", Log::GetPending());
+}
+
+static void TestOverflow(void)
+{
+	uint32_t dropped = Log::GetDropped();
+	const uint32_t records = LOG_BUFFER_SIZE; // more 4 word records than fit
+
+	for (uint32_t i = 0; i < records; i++)
+		LOG("seq %u\n", i);
+
+	/* The oldest records are kept and the newer ones dropped, and the dropped count is reported in every package */
+	uint32_t read = 0;
+	bool ordered = true;
+	std::vector<LogDecoder::Record_t> package;
+	while (!(package = ReadPackage()).empty()) {
+		for (size_t i = 0; i < package.size(); i++) {
+			uint32_t seq;
+			if (!ParseSequence(package[i], &seq) || seq != read) ordered = false;
+			read++;
+		}
+		CHECK(decoder.GetDropped() == Log::GetDropped(), "package reports %u dropped records, expected %u", decoder.GetDropped(), Log::GetDropped());
+	}
+	CHECK(ordered, "kept records are not the oldest in order");
+	CHECK(read > 0 && read < records, "%u of %u records kept", read, records);
+	CHECK(Log::GetDropped() - dropped == records - read, "%u records dropped, %u not kept", Log::GetDropped() - dropped, records - read);
+
+	/* The ring is usable again once read */
+	CHECK_ROUND_TRIP("After overflow %d\n", 1);
+}
+
+static void TestConcurrentProducers(void)
+{
+	uint32_t dropped = Log::GetDropped();
+	std::vector<std::thread> producers;
+	volatile bool done = false;
+
+	for (int p = 0; p < PRODUCERS; p++)
+		producers.push_back(std::thread([p]() {
+			for (uint32_t i = 0; i < PRODUCER_RECORDS; i++) {
+				while (Log::GetPending() > LOG_BUFFER_SIZE / 2) std::this_thread::yield(); // mostly keep up with the reader, drops are still possible
+				LOG("producer %d seq %u\n", p, i);
+			}
+		}));
+
+	std::thread finisher([&]() {
+		for (size_t p = 0; p < producers.size(); p++) producers[p].join();
+		done = true;
+	});
+
+	/* Records of one producer keep their order, records are either received or counted as dropped */
+	uint32_t next[PRODUCERS] = { 0 };
+	uint32_t received = 0;
+	bool ordered = true, valid = true;
+	while (true) {
+		bool finished = done;
+		std::vector<LogDecoder::Record_t> records = ReadPackage();
+		for (size_t i = 0; i < records.size(); i++) {
+			int p;
+			uint32_t seq;
+			if (sscanf(records[i].text.c_str(), "producer %d seq %u", &p, &seq) != 2 || p < 0 || p >= PRODUCERS) {
+				valid = false;
+				continue;
+			}
+			if (seq < next[p]) ordered = false;
+			next[p] = seq + 1;
+			received++;
+		}
+		if (finished && records.empty()) break;
+	}
+	finisher.join();
+
+	printf("Concurrent producers: %u records received, %u dropped\n", received, Log::GetDropped() - dropped);
+	CHECK(valid, "corrupt records from concurrent producers");
+	CHECK(ordered, "records of a producer out of order");
+	CHECK(received + (Log::GetDropped() - dropped) == PRODUCERS * PRODUCER_RECORDS, "%u records received and %u dropped of %u",
+		  received, Log::GetDropped() - dropped, PRODUCERS * PRODUCER_RECORDS);
+}
+
+static void TestCorruptPackages(void)
+{
+	LOG("first %d\n", 1);
+	LOG("second %d %d\n", 2, 3);
+	uint32_t package[PACKAGE_WORDS];
+	package[0] = Log::GetDropped();
+	uint32_t words = Log::Read(&package[1], PACKAGE_WORDS - 1);
+	CHECK(words == 2 * LOG_RECORD_WORDS + 3, "%u words read for two records", words);
+
+	/* A truncated package decodes up to the last complete record */
+	std::vector<LogDecoder::Record_t> records = decoder.Decode((const uint8_t *)package, words * sizeof(uint32_t));
+	CHECK(records.size() == 1 && records[0].text == "first 1\n", "truncated package decoded into %u records", (unsigned int)records.size());
+
+	/* An unknown format id gives an empty text, and decoding stops at an invalid header */
+	package[1 + 1] = (uint32_t)(__stop_log_strings - __start_log_strings) + 100;
+	records = decoder.Decode((const uint8_t *)package, (words + 1) * sizeof(uint32_t));
+	CHECK(records.size() == 2 && records[0].text.empty() && records[1].text == "second 2 3\n", "package with an unknown id decoded into %u records", (unsigned int)records.size());
+	package[1 + LOG_RECORD_WORDS + 1] = 0; // header of the second record
+	records = decoder.Decode((const uint8_t *)package, (words + 1) * sizeof(uint32_t));
+	CHECK(records.size() == 1, "package with an invalid header decoded into %u records", (unsigned int)records.size());
+	records = decoder.Decode((const uint8_t *)package, 2);
+	CHECK(records.empty(), "package shorter than the dropped counter decoded into %u records", (unsigned int)records.size());
+}
+
+int main(void)
+{
+	TestFormats();
+	TestWrapAround();
+	TestOverflow();
+	TestConcurrentProducers();
+	TestCorruptPackages();
+
+	if (failures) {
+		printf("LogTest: %d checks FAILED\n", failures);
+		return 1;
+	}
+	printf("LogTest: passed\n");
+	return 0;
+}
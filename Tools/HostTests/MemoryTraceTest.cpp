@@ -0,0 +1,254 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+ 
+
+/* Host test of the allocation tracer of MemoryManagement.c, which heap_4.c calls through traceMALLOC and traceFREE.
+ *
+ * Both are built for the PC with MEMORY_MANAGEMENT_HOST and the FreeRTOS stand-ins in host/freertos, and the task functions
+ * below switch between simulated tasks. The test checks the per task counts, bytes and peaks, including memory freed by
+ * another task than the one which allocated it, failed allocations, the sharing of the last slot when running out of slots,
+ * the reset of the counters, and the heap statistics with the free block histogram of a fragmented heap.
+ * Build with build.sh.
+ */
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "MemoryManagement.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define TASKS		40
+
+static int failures = 0;
+
+#define CHECK(condition, ...) do { if (!(condition)) { printf("FAILED: " __VA_ARGS__); printf("\n"); failures++; } } while (0)
+
+/* Simulated tasks */
+typedef struct {
+	char name[MEMORY_TRACE_NAME_LENGTH];
+	UBaseType_t number;
+} Task_t;
+
+static Task_t tasks[TASKS];
+static Task_t * currentTask = 0;
+static BaseType_t schedulerState = taskSCHEDULER_NOT_STARTED;
+static int suspended = 0;
+
+extern "C" {
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+	return currentTask;
+}
+
+BaseType_t xTaskGetSchedulerState(void)
+{
+	return schedulerState;
+}
+
+UBaseType_t uxTaskGetNumberOfTasks(void)
+{
+	return (schedulerState == taskSCHEDULER_NOT_STARTED) ? 0 : TASKS;
+}
+
+UBaseType_t uxTaskGetTaskNumber(TaskHandle_t task)
+{
+	return ((Task_t *)task)->number;
+}
+
+void vTaskSetTaskNumber(TaskHandle_t task, const UBaseType_t number)
+{
+	CHECK(suspended > 0, "task slot assigned without the scheduler being suspended");
+	((Task_t *)task)->number = number;
+}
+
+char * pcTaskGetName(TaskHandle_t task)
+{
+	return ((Task_t *)task)->name;
+}
+
+void vTaskSuspendAll(void)
+{
+	suspended++;
+}
+
+BaseType_t xTaskResumeAll(void)
+{
+	suspended--;
+	return pdFALSE;
+}
+
+}
+
+static void StartScheduler(void)
+{
+	for (int i = 0; i < TASKS; i++) {
+		snprintf(tasks[i].name, sizeof(tasks[i].name), "Task %d", i);
+		tasks[i].number = 0;
+	}
+	schedulerState = taskSCHEDULER_RUNNING;
+}
+
+static void SwitchTo(int task)
+{
+	currentTask = &tasks[task];
+}
+
+static uint32_t BlockSize(void * ptr)
+{
+	return xPortGetBlockSize(ptr);
+}
+
+/* Statistics of the slot used by the given task, found by its name */
+static MemoryTrace_TaskStats_t GetTaskStats(const char * name)
+{
+	MemoryTrace_TaskStats_t stats[MEMORY_TRACE_MAX_TASKS];
+	MemoryTrace_TaskStats_t result;
+	memset(&result, 0, sizeof(result));
+	uint32_t slots = MemoryTrace_GetTaskStats(stats, MEMORY_TRACE_MAX_TASKS);
+	for (uint32_t i = 0; i < slots; i++)
+		if (strcmp(stats[i].name, name) == 0)
+			result = stats[i];
+	return result;
+}
+
+/* Bin of the free block histogram, bin i holds blocks of 16*2^i to 16*2^(i+1)-1 bytes */
+static uint32_t HistogramBin(uint32_t blockSize)
+{
+	uint32_t bin = 0;
+	for (uint32_t size = blockSize / 16; size > 1 && bin < MEMORY_TRACE_HISTOGRAM_BINS-1; size /= 2)
+		bin++;
+	return bin;
+}
+
+int main(void)
+{
+	/* Allocations before the scheduler is started */
+	void * startup = pvPortMalloc(100);
+	const size_t heapSize = xPortGetFreeHeapSize() + BlockSize(startup);
+	MemoryTrace_TaskStats_t stats = GetTaskStats("(startup)");
+	CHECK(stats.allocations == 1 && stats.allocatedBytes == BlockSize(startup), "startup allocation: %u allocations of %u bytes", stats.allocations, stats.allocatedBytes);
+	CHECK(BlockSize(startup) >= 100 && BlockSize(startup) < 100 + 32, "block size %u of an allocation of 100 bytes", BlockSize(startup));
+
+	/* Two tasks, where task 0 frees memory allocated by task 1 */
+	StartScheduler();
+	SwitchTo(0);
+	void * a1 = pvPortMalloc(200);
+	void * a2 = pvPortMalloc(50);
+	SwitchTo(1);
+	void * b1 = pvPortMalloc(1000);
+	uint32_t b1Size = BlockSize(b1);
+	SwitchTo(0);
+	vPortFree(b1);
+	SwitchTo(1);
+	void * b2 = pvPortMalloc(10);
+
+	stats = GetTaskStats("Task 0");
+	CHECK(stats.allocations == 2 && stats.frees == 1, "task 0: %u allocations and %u frees", stats.allocations, stats.frees);
+	CHECK(stats.allocatedBytes == BlockSize(a1) + BlockSize(a2), "task 0: %u bytes allocated", stats.allocatedBytes);
+	CHECK(stats.freedBytes == b1Size, "task 0: %u bytes freed", stats.freedBytes);
+	CHECK(stats.peakBytes == BlockSize(a1) + BlockSize(a2), "task 0: peak of %u bytes", stats.peakBytes);
+	stats = GetTaskStats("Task 1");
+	CHECK(stats.allocations == 2 && stats.frees == 0, "task 1: %u allocations and %u frees", stats.allocations, stats.frees);
+	CHECK(stats.peakBytes == b1Size + BlockSize(b2), "task 1: peak of %u bytes", stats.peakBytes);
+
+	MemoryTrace_HeapStats_t heap;
+	MemoryTrace_GetHeapStats(&heap);
+	uint32_t current = BlockSize(startup) + BlockSize(a1) + BlockSize(a2) + BlockSize(b2);
+	CHECK(heap.allocations == 5 && heap.frees == 1, "heap: %u allocations and %u frees", heap.allocations, heap.frees);
+	CHECK(heap.currentBytes == current, "heap: %u bytes allocated, expected %u", heap.currentBytes, current);
+	CHECK(heap.currentBytes + heap.freeBytes == heapSize, "heap: %u bytes allocated and %u free of %u", heap.currentBytes, heap.freeBytes, (uint32_t)heapSize);
+	CHECK(heap.peakBytes == current - BlockSize(b2) + b1Size, "heap: peak of %u bytes", heap.peakBytes);
+
+	/* Failed allocation */
+	SwitchTo(2);
+	CHECK(pvPortMalloc(configTOTAL_HEAP_SIZE) == 0, "allocation larger than the heap succeeded");
+	stats = GetTaskStats("Task 2");
+	CHECK(stats.failedAllocations == 1 && stats.allocations == 0 && stats.allocatedBytes == 0, "task 2: %u failed allocations, %u allocations", stats.failedAllocations, stats.allocations);
+	MemoryTrace_GetHeapStats(&heap);
+	CHECK(heap.failedAllocations == 1, "heap: %u failed allocations", heap.failedAllocations);
+
+	/* Reset keeps the currently allocated bytes as the new peaks */
+	MemoryTrace_Reset();
+	stats = GetTaskStats("Task 1");
+	CHECK(stats.allocations == 0 && stats.allocatedBytes == 0, "task 1 after reset: %u allocations of %u bytes", stats.allocations, stats.allocatedBytes);
+	CHECK(stats.peakBytes == b1Size + BlockSize(b2), "task 1 after reset: peak of %u bytes", stats.peakBytes);
+	stats = GetTaskStats("Task 0");
+	CHECK(stats.peakBytes == 0, "task 0 after reset: peak of %u bytes, although it has freed more than it allocated", stats.peakBytes);
+	MemoryTrace_GetHeapStats(&heap);
+	CHECK(heap.allocations == 0 && heap.failedAllocations == 0 && heap.peakBytes == current, "heap after reset: %u allocations, peak of %u bytes", heap.allocations, heap.peakBytes);
+
+	/* Fragmentation: free every other of 20 blocks, which leaves 10 free blocks in front of the remaining heap */
+	SwitchTo(0);
+	vPortFree(a1);
+	vPortFree(a2);
+	SwitchTo(1);
+	vPortFree(b2);
+	void * blocks[20];
+	for (int i = 0; i < 20; i++)
+		blocks[i] = pvPortMalloc(100);
+	uint32_t blockSize = BlockSize(blocks[0]);
+	for (int i = 0; i < 20; i += 2)
+		vPortFree(blocks[i]);
+
+	MemoryTrace_GetHeapStats(&heap);
+	uint32_t remaining = heapSize - BlockSize(startup) - 20 * blockSize;
+	CHECK(heap.freeBlocks == 11, "heap: %u free blocks", heap.freeBlocks);
+	CHECK(heap.largestFreeBlock == remaining, "heap: largest free block of %u bytes, expected %u", heap.largestFreeBlock, remaining);
+	CHECK(heap.freeBytes == remaining + 10 * blockSize, "heap: %u bytes free", heap.freeBytes);
+	uint16_t histogram[MEMORY_TRACE_HISTOGRAM_BINS] = { 0 };
+	histogram[HistogramBin(blockSize)] += 10;
+	histogram[HistogramBin(remaining)] += 1;
+	for (int i = 0; i < MEMORY_TRACE_HISTOGRAM_BINS; i++)
+		CHECK(heap.freeBlockHistogram[i] == histogram[i], "histogram bin %d: %u blocks, expected %u", i, heap.freeBlockHistogram[i], histogram[i]);
+	CHECK(heap.minimumEverFreeBytes <= heap.freeBytes - 10 * blockSize, "heap: minimum ever free of %u bytes", heap.minimumEverFreeBytes);
+
+	for (int i = 1; i < 20; i += 2)
+		vPortFree(blocks[i]);
+	MemoryTrace_GetHeapStats(&heap);
+	CHECK(heap.freeBlocks == 1 && heap.largestFreeBlock == heapSize - BlockSize(startup), "heap not merged after freeing all blocks: %u free blocks", heap.freeBlocks);
+
+	/* More tasks than slots share the last slot */
+	for (int task = 3; task < TASKS; task++) {
+		SwitchTo(task);
+		vPortFree(pvPortMalloc(16));
+	}
+	MemoryTrace_TaskStats_t slots[MEMORY_TRACE_MAX_TASKS];
+	CHECK(MemoryTrace_GetTaskStats(slots, MEMORY_TRACE_MAX_TASKS) == MEMORY_TRACE_MAX_TASKS, "not all slots used");
+	const uint32_t ownSlots = MEMORY_TRACE_MAX_TASKS - 1 - 4; // slots left for task 3 and up, after (startup) and task 0 to 2
+	CHECK(strcmp(slots[MEMORY_TRACE_MAX_TASKS-1].name, "(other tasks)") == 0, "last slot named '%s'", slots[MEMORY_TRACE_MAX_TASKS-1].name);
+	CHECK(slots[MEMORY_TRACE_MAX_TASKS-1].allocations == (TASKS - 3) - ownSlots, "last slot: %u allocations", slots[MEMORY_TRACE_MAX_TASKS-1].allocations);
+	CHECK(strcmp(slots[MEMORY_TRACE_MAX_TASKS-2].name, "Task 29") == 0 && slots[MEMORY_TRACE_MAX_TASKS-2].allocations == 1, "slot %d: '%s' with %u allocations", MEMORY_TRACE_MAX_TASKS-2, slots[MEMORY_TRACE_MAX_TASKS-2].name, slots[MEMORY_TRACE_MAX_TASKS-2].allocations);
+
+	/* Nothing left but the startup allocation */
+	MemoryTrace_GetHeapStats(&heap);
+	CHECK(heap.currentBytes == BlockSize(startup), "heap: %u bytes left allocated", heap.currentBytes);
+	vPortFree(startup);
+	MemoryTrace_GetHeapStats(&heap);
+	CHECK(heap.currentBytes == 0 && heap.freeBytes == heapSize, "heap: %u bytes allocated, %u of %u free", heap.currentBytes, heap.freeBytes, (uint32_t)heapSize);
+	CHECK(suspended == 0, "scheduler left suspended");
+
+	if (failures) {
+		printf("MemoryTraceTest: %d checks FAILED\n", failures);
+		return 1;
+	}
+	printf("MemoryTraceTest: passed\n");
+	return 0;
+}
@@ -0,0 +1,189 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+ 
+
+/* Host test of the static arenas, in which the long-lived objects are constructed instead of on the heap.
+ *
+ * The C library allocation functions are replaced below by counting wrappers. The test checks the arena itself (alignment,
+ * exact fit, exhaustion reported with ERROR, zeroed memory after a reset) and then constructs and destroys the balance controller
+ * objects (Parameters, BalanceLoop and QuaternionVelocityControl) many times in an arena of BALANCECONTROLLER_ARENA_SIZE, running
+ * the balance loop in between, and checks that this makes no heap calls. Only this restart of the controller is covered, not
+ * the other tasks running after boot.
+ * Build with build.sh.
+ */
+
+#include "StaticArena.h"
+#include "Debug.h"
+#include "Parameters.h"
+#include "BalanceController.h"
+#include "BalanceLoop.h"
+#include "QuaternionVelocityControl.h"
+#include "IMU.h"
+#include "Timer.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define RESTARTS	1000
+#define STEPS		10 // balance loop iterations between two restarts
+#define SAMPLE_TIME	5000 // microseconds
+
+static int failures = 0;
+
+#define CHECK(condition, ...) do { if (!(condition)) { printf("FAILED: " __VA_ARGS__); printf("\n"); failures++; } } while (0)
+
+/* Count every heap call, including the ones of operator new, by replacing the C library allocation functions (glibc) */
+static unsigned long heapCalls = 0;
+
+extern "C" {
+
+void * __libc_malloc(size_t size);
+void * __libc_calloc(size_t count, size_t size);
+void * __libc_realloc(void * ptr, size_t size);
+void __libc_free(void * ptr);
+
+void * malloc(size_t size)
+{
+	heapCalls++;
+	return __libc_malloc(size);
+}
+
+void * calloc(size_t count, size_t size)
+{
+	heapCalls++;
+	return __libc_calloc(count, size);
+}
+
+void * realloc(void * ptr, size_t size)
+{
+	heapCalls++;
+	return __libc_realloc(ptr, size);
+}
+
+void free(void * ptr)
+{
+	if (ptr) heapCalls++;
+	__libc_free(ptr);
+}
+
+}
+
+struct Element_t {
+	uint8_t value;
+	Element_t() : value(0x5A) {};
+};
+
+static void TestArena(void)
+{
+	static uint8_t memory[64] __attribute__((aligned(STATIC_ARENA_ALIGNMENT)));
+	memset(memory, 0, sizeof(memory));
+	StaticArena arena(memory, sizeof(memory));
+
+	/* Every allocation is aligned, and the arena fits exactly the objects it is sized for */
+	uint8_t * a = (uint8_t *)arena.Allocate(1);
+	uint8_t * b = (uint8_t *)arena.Allocate(STATIC_ARENA_ALIGNMENT + 1);
+	CHECK(a == memory, "first allocation at %p, expected %p", a, memory);
+	CHECK(b == memory + STATIC_ARENA_ALIGNMENT, "second allocation at offset %d", (int)(b - memory));
+	CHECK(arena.GetUsed() == 3 * STATIC_ARENA_ALIGNMENT, "%u bytes used after two allocations", (unsigned int)arena.GetUsed());
+
+	Element_t * element = new (arena) Element_t;
+	CHECK(element && element->value == 0x5A, "placement new did not construct the object");
+	CHECK(arena.Allocate(sizeof(memory) - arena.GetUsed()) != 0, "allocation of the remaining space failed");
+	CHECK(arena.GetUsed() == arena.GetSize(), "arena not full: %u of %u bytes used", (unsigned int)arena.GetUsed(), (unsigned int)arena.GetSize());
+	CHECK(Debug::ErrorCount() == 0, "%d errors reported before the arena was exhausted", Debug::ErrorCount());
+
+	/* An exhausted arena is reported with ERROR, which stops the firmware on target, and the constructor is not called */
+	memory[sizeof(memory) - 1] = 0xA5;
+	Element_t * overflow = new (arena) Element_t;
+	CHECK(overflow == 0, "allocation from an exhausted arena succeeded");
+	CHECK(Debug::ErrorCount() == 1, "%d errors reported for an exhausted arena, expected 1", Debug::ErrorCount());
+	CHECK(memory[sizeof(memory) - 1] == 0xA5, "constructor called for an allocation from an exhausted arena");
+
+	/* A reset zeroes the used memory, such that recreated objects see the same memory as after boot */
+	arena.Reset();
+	CHECK(arena.GetUsed() == 0, "%u bytes used after a reset", (unsigned int)arena.GetUsed());
+	bool zeroed = true;
+	for (size_t i = 0; i < sizeof(memory); i++)
+		if (memory[i] != 0) zeroed = false;
+	CHECK(zeroed, "memory not zeroed by the reset");
+
+	Debug::ErrorCount() = 0;
+}
+
+static void TestControllerRestarts(void)
+{
+	STATIC_ARENA(controllerArena, BALANCECONTROLLER_ARENA_SIZE);
+
+	Timer microsTimer;
+	IMU imu;
+	IMU::Measurement_t imuMeas;
+	memset(&imuMeas, 0, sizeof(imuMeas));
+	imuMeas.Accelerometer[2] = 9.82f; // standing still and upright
+	const int32_t encoderTicks[3] = { 0, 0, 0 };
+	const float encoderAngle[3] = { 0, 0, 0 };
+	const float xy[2] = { 0, 0 };
+	const float q_ref[4] = { 1, 0, 0, 0 };
+	const float omega_ref[3] = { 0, 0, 0 };
+
+	uint32_t timer = 0;
+	size_t used = 0;
+	unsigned long calls = heapCalls;
+
+	/* Like BalanceController::Thread, which creates the objects at every start and destroys them at stop */
+	for (int restart = 0; restart < RESTARTS; restart++) {
+		controllerArena.Reset();
+		Parameters& params = *(new (controllerArena) Parameters);
+		BalanceLoop& loop = *(new (controllerArena) BalanceLoop(params, &microsTimer));
+		QuaternionVelocityControl& velocityController = *(new (controllerArena) QuaternionVelocityControl(params, &microsTimer, 1.0f / params.controller.SampleRate));
+		used = controllerArena.GetUsed();
+
+		microsTimer.Set(timer);
+		loop.Reset(imuMeas, encoderTicks, encoderAngle);
+		float q[4] = { 1, 0, 0, 0 }, dq[4] = { 0, 0, 0, 0 }, dxy[2] = { 0, 0 }, COM[3] = { 0, 0, params.model.l };
+		float torque[3];
+		for (int step = 0; step < STEPS; step++) {
+			timer += SAMPLE_TIME;
+			microsTimer.Set(timer);
+			loop.Estimate(imu, imuMeas, encoderTicks, encoderAngle, q, dq, dxy, COM);
+			loop.Control(q, dq, xy, dxy, q_ref, omega_ref, omega_ref, torque);
+		}
+
+		StaticArena_Destroy(&params);
+		StaticArena_Destroy(&loop);
+		StaticArena_Destroy(&velocityController);
+	}
+
+	CHECK(heapCalls == calls, "%lu heap calls during %d controller restarts", heapCalls - calls, RESTARTS);
+	CHECK(used == controllerArena.GetSize(), "controller arena of %u bytes holds %u bytes", (unsigned int)controllerArena.GetSize(), (unsigned int)used);
+	CHECK(Debug::ErrorCount() == 0, "%d errors reported during the controller restarts", Debug::ErrorCount());
+}
+
+int main(void)
+{
+	TestArena();
+	TestControllerRestarts();
+
+	if (failures) {
+		printf("StaticArenaTest: %d checks FAILED\n", failures);
+		return 1;
+	}
+	printf("StaticArenaTest: passed\n");
+	return 0;
+}
@@ -0,0 +1,319 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+ 
+
+/* Host test of the chunked block transfer (Transfer.hpp) and of the BlockTransfer module over a loopback of two LSPC sockets.
+ *
+ * The packages are COBS framed and decoded by the SocketBase of the firmware, and carried by a LinkModel with a rate of
+ * 1 MB/s and 1 ms latency, which drops frames and reorders them at random. The PC side times out after 20 ms without a
+ * package, as the PC tools do: the sender then retransmits the unacknowledged chunks and the receiver sends a probe.
+ *
+ * Transfer: blocks of 1 B to 64 KB are restored (PC to robot) and dumped (robot to PC) for each combination of drop rate
+ * and reordering, with several seeds, and have to arrive intact.
+ * BlockTransfer: the parameter block is dumped and restored through the module, and restores with a wrong CRC, a NaN float,
+ * an out of range controller mode or a bool which is neither 0 nor 1 have to be rejected without changing the parameters.
+ * Build with build.sh.
+ */
+
+#include "LSPC.hpp"
+#include "LinkModel.h"
+#include "Transfer.hpp"
+#include "BlockTransfer.h"
+#include "Parameters.h"
+#include "CRC32.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#define TIMEOUT			20000 // us without any package after which the PC side times out
+#define MAX_TIMEOUTS	200   // consecutive timeouts after which a transfer has failed
+#define SEEDS			10
+
+static int failures = 0;
+
+#define CHECK(condition, ...) do { if (!(condition)) { printf("FAILED: " __VA_ARGS__); printf("\n"); failures++; } } while (0)
+
+/* BlockTransfer only dumps the black box recording, which is not part of this test */
+const uint8_t * BlackBox::GetRecording(uint32_t& size)
+{
+	size = 0;
+	return 0;
+}
+
+static void TransmitPackage(void * param, uint8_t type, const uint8_t * payload, uint16_t length)
+{
+	((LSPC *)param)->TransmitAsync(type, payload, length);
+}
+
+/* Both ends of a raw transfer, each with a sender and a receiver */
+typedef struct Endpoint_t {
+	Endpoint_t(LSPC& com, uint8_t chunkType, uint8_t ackType) : sender(&TransmitPackage, &com, chunkType), receiver(&TransmitPackage, &com, ackType), completed(false) {}
+	lspc::TransferSender sender;
+	lspc::TransferReceiver receiver;
+	bool completed; // the receiver has received the complete block with a valid CRC
+} Endpoint_t;
+
+static void Chunk_Callback(void * param, const std::vector<uint8_t>& payload)
+{
+	Endpoint_t * endpoint = (Endpoint_t *)param;
+	if (endpoint->receiver.Receive(payload.data(), payload.size())) {
+		endpoint->completed = true;
+		endpoint->receiver.Finish(lspc::TransferTypes::COMPLETE);
+	}
+}
+
+static void Ack_Callback(void * param, const std::vector<uint8_t>& payload)
+{
+	Endpoint_t * endpoint = (Endpoint_t *)param;
+	lspc::TransferTypes::Ack_t ack;
+	if (payload.size() != sizeof(ack)) return;
+	memcpy(&ack, payload.data(), sizeof(ack));
+	endpoint->sender.Acknowledge(ack);
+}
+
+/**
+ * @brief 	Transfer a block of random bytes in one direction
+ * @param	restore    Input: true to send from the PC to the robot, false to send from the robot to the PC (dump)
+ * @retval	transfer time [us], or 0 if the transfer failed
+ */
+static uint64_t Transfer(uint32_t size, bool restore, float dropRate, float reorderRate, uint32_t seed)
+{
+	LSPC pc, robot;
+	LinkModel link(pc, robot, seed);
+	link.SetDropRate(dropRate);
+	link.SetReordering(reorderRate, 3000);
+
+	Endpoint_t pcEnd(pc, lspc::MessageTypesFromPC::TransferChunk, lspc::MessageTypesFromPC::TransferAck);
+	Endpoint_t robotEnd(robot, lspc::MessageTypesToPC::TransferChunk, lspc::MessageTypesToPC::TransferAck);
+	pc.registerCallback(lspc::MessageTypesToPC::TransferChunk, &Chunk_Callback, &pcEnd);
+	pc.registerCallback(lspc::MessageTypesToPC::TransferAck, &Ack_Callback, &pcEnd);
+	robot.registerCallback(lspc::MessageTypesFromPC::TransferChunk, &Chunk_Callback, &robotEnd);
+	robot.registerCallback(lspc::MessageTypesFromPC::TransferAck, &Ack_Callback, &robotEnd);
+
+	std::vector<uint8_t> block(size), received(size, 0);
+	for (uint32_t i = 0; i < size; i++)
+		block[i] = (uint8_t)link.Random(256);
+	uint32_t crc = CRC32_Calculate(block.data(), size);
+
+	Endpoint_t& from = restore ? pcEnd : robotEnd;
+	Endpoint_t& to = restore ? robotEnd : pcEnd;
+	to.receiver.Start(received.data(), size, crc);
+	from.sender.Start(block.data(), size);
+
+	/* Run until the PC side is done: the sender has got the final acknowledge (restore), or the block has been received (dump) */
+	uint32_t timeouts = 0;
+	while (restore ? !pcEnd.sender.Completed() : !pcEnd.completed) {
+		if (link.Step(link.Now() + TIMEOUT)) {
+			timeouts = 0;
+			continue;
+		}
+		if (++timeouts > MAX_TIMEOUTS) return 0;
+		link.Advance(link.Now() + TIMEOUT);
+		if (restore)
+			pcEnd.sender.Timeout();
+		else
+			pcEnd.receiver.Probe();
+	}
+
+	bool intact = (restore ? robotEnd.completed && pcEnd.sender.GetStatus() == lspc::TransferTypes::COMPLETE : true) && received == block;
+	return intact ? link.Now() : 0;
+}
+
+static void TestTransfer(void)
+{
+	const uint32_t sizes[] = { 1, LSPC_TRANSFER_CHUNK_SIZE, LSPC_TRANSFER_CHUNK_SIZE + 1, 5000, 65536 };
+	const float dropRates[] = { 0, 0.05f, 0.2f };
+	const float reorderRates[] = { 0, 0.1f };
+
+	uint32_t transfers = 0;
+	for (uint32_t s = 0; s < sizeof(sizes)/sizeof(sizes[0]); s++) {
+		for (uint32_t d = 0; d < sizeof(dropRates)/sizeof(dropRates[0]); d++) {
+			for (uint32_t r = 0; r < sizeof(reorderRates)/sizeof(reorderRates[0]); r++) {
+				for (int restore = 0; restore < 2; restore++) {
+					uint64_t total = 0;
+					for (uint32_t seed = 1; seed <= SEEDS; seed++) {
+						uint64_t time = Transfer(sizes[s], restore, dropRates[d], reorderRates[r], seed);
+						CHECK(time > 0, "%s of %u bytes with %.0f%% drops and %.0f%% reordering (seed %u)", restore ? "restore" : "dump", sizes[s], 100*dropRates[d], 100*reorderRates[r], seed);
+						total += time;
+						transfers++;
+					}
+					if (sizes[s] == 65536 && restore)
+						printf("  64 KB restore, %2.0f%% drops, %2.0f%% reordering: %4.0f kB/s\n", 100*dropRates[d], 100*reorderRates[r], 1e3 * sizes[s] * SEEDS / total);
+				}
+			}
+		}
+	}
+	printf("Transfer: %u transfers\n", transfers);
+}
+
+/* PC side of a BlockTransfer */
+typedef struct {
+	bool infoReceived;
+	lspc::MessageTypesToPC::TransferInfo_t info;
+	Endpoint_t * end;
+} BlockClient_t;
+
+static void TransferInfo_Callback(void * param, const std::vector<uint8_t>& payload)
+{
+	BlockClient_t * client = (BlockClient_t *)param;
+	if (payload.size() != sizeof(client->info) || client->infoReceived) return;
+	memcpy(&client->info, payload.data(), sizeof(client->info));
+	client->infoReceived = true;
+}
+
+/**
+ * @brief 	Dump or restore the parameter block through the BlockTransfer module of the robot
+ * @param	block      Input/Output: block to restore, or the dumped block
+ * @param	crc        Input: CRC sent with a restore
+ * @retval	final status reported by the robot
+ */
+static lspc::TransferTypes::status_t TransferParameters(LSPC& pc, LinkModel& link, bool restore, std::vector<uint8_t>& block, uint32_t crc)
+{
+	Endpoint_t pcEnd(pc, lspc::MessageTypesFromPC::TransferChunk, lspc::MessageTypesFromPC::TransferAck);
+	BlockClient_t client;
+	client.infoReceived = false;
+	client.end = &pcEnd;
+	pc.registerCallback(lspc::MessageTypesToPC::TransferInfo, &TransferInfo_Callback, &client);
+	pc.registerCallback(lspc::MessageTypesToPC::TransferChunk, &Chunk_Callback, &pcEnd);
+	pc.registerCallback(lspc::MessageTypesToPC::TransferAck, &Ack_Callback, &pcEnd);
+
+	lspc::MessageTypesFromPC::TransferStart_t start;
+	start.block = lspc::TransferTypes::PARAMETERS;
+	start.direction = restore ? lspc::TransferTypes::RESTORE : lspc::TransferTypes::DUMP;
+	start.size = restore ? block.size() : 0;
+	start.crc = crc;
+	pc.TransmitAsync(lspc::MessageTypesFromPC::TransferStart, (const uint8_t *)&start, sizeof(start));
+
+	lspc::TransferTypes::status_t status = lspc::TransferTypes::IN_PROGRESS;
+	bool started = false;
+	uint32_t timeouts = 0;
+	while (status == lspc::TransferTypes::IN_PROGRESS && timeouts <= MAX_TIMEOUTS) {
+		if (link.Step(link.Now() + TIMEOUT)) {
+			timeouts = 0;
+		} else {
+			timeouts++;
+			link.Advance(link.Now() + TIMEOUT);
+			if (!client.infoReceived) // the start or its reply has been lost, hence start again
+				pc.TransmitAsync(lspc::MessageTypesFromPC::TransferStart, (const uint8_t *)&start, sizeof(start));
+			else if (restore)
+				pcEnd.sender.Timeout();
+			else
+				pcEnd.receiver.Probe();
+		}
+
+		if (client.infoReceived && !started) {
+			started = true;
+			if (client.info.status != lspc::TransferTypes::IN_PROGRESS) {
+				status = client.info.status;
+			} else if (restore) {
+				pcEnd.sender.Start(block.data(), block.size());
+			} else {
+				block.assign(client.info.size, 0);
+				pcEnd.receiver.Start(block.data(), block.size(), client.info.crc);
+			}
+		}
+
+		if (restore && pcEnd.sender.Completed())
+			status = pcEnd.sender.GetStatus();
+		else if (!restore && pcEnd.completed)
+			status = lspc::TransferTypes::COMPLETE;
+	}
+
+	/* Let the final packages arrive */
+	while (link.Step(link.Now() + TIMEOUT));
+
+	pc.unregisterCallback(lspc::MessageTypesToPC::TransferInfo);
+	pc.unregisterCallback(lspc::MessageTypesToPC::TransferChunk);
+	pc.unregisterCallback(lspc::MessageTypesToPC::TransferAck);
+	return status;
+}
+
+static std::vector<uint8_t> ReadParameters(Parameters& params)
+{
+	std::vector<uint8_t> block(params.GetBlockSize());
+	params.ReadBlock(block.data(), block.size());
+	return block;
+}
+
+static void TestBlockTransfer(void)
+{
+	LSPC pc, robot;
+	LinkModel link(pc, robot, 3);
+	link.SetDropRate(0.05f);
+	link.SetReordering(0.1f, 3000);
+
+	Parameters params(0, &robot);
+	BlockTransfer blockTransfer(robot, 0, 0);
+
+	/* Dump */
+	std::vector<uint8_t> dump;
+	CHECK(TransferParameters(pc, link, false, dump, 0) == lspc::TransferTypes::COMPLETE, "parameter dump");
+	CHECK(dump == ReadParameters(params), "dumped parameters differ");
+
+	/* Restore of a changed parameter */
+	std::vector<uint8_t> block = dump;
+	uint32_t torqueMaxOffset = (uint8_t *)&params.controller.TorqueMax - (uint8_t *)&params.ForceDefaultParameters;
+	float torqueMax = params.controller.TorqueMax + 0.5f;
+	memcpy(&block[torqueMaxOffset], &torqueMax, sizeof(torqueMax));
+	CHECK(TransferParameters(pc, link, true, block, CRC32_Calculate(block.data(), block.size())) == lspc::TransferTypes::COMPLETE, "parameter restore");
+	CHECK(block == ReadParameters(params), "restored parameters differ");
+	dump = block;
+
+	/* Restore with a wrong CRC */
+	block[torqueMaxOffset] ^= 0x01;
+	CHECK(TransferParameters(pc, link, true, block, CRC32_Calculate(dump.data(), dump.size())) == lspc::TransferTypes::CRC_ERROR, "restore with wrong CRC not rejected");
+	CHECK(dump == ReadParameters(params), "parameters changed by a rejected restore (wrong CRC)");
+
+	/* Restores with invalid values */
+	float nan = NAN;
+	uint8_t mode = 7;
+	uint8_t invalidBool = 2;
+	struct {
+		const char * name;
+		uint32_t offset;
+		const void * value;
+		uint32_t size;
+	} invalid[] = {
+		{ "NaN float", torqueMaxOffset, &nan, sizeof(nan) },
+		{ "out of range controller mode", (uint32_t)((uint8_t *)&params.controller.mode - (uint8_t *)&params.ForceDefaultParameters), &mode, sizeof(mode) },
+		{ "invalid bool", (uint32_t)((uint8_t *)&params.estimator.UseMEKF - (uint8_t *)&params.ForceDefaultParameters), &invalidBool, sizeof(invalidBool) },
+	};
+	for (uint32_t i = 0; i < sizeof(invalid)/sizeof(invalid[0]); i++) {
+		block = dump;
+		memcpy(&block[invalid[i].offset], invalid[i].value, invalid[i].size);
+		CHECK(TransferParameters(pc, link, true, block, CRC32_Calculate(block.data(), block.size())) == lspc::TransferTypes::WRITE_ERROR, "restore with %s not rejected", invalid[i].name);
+		CHECK(dump == ReadParameters(params), "parameters changed by a rejected restore (%s)", invalid[i].name);
+	}
+
+	printf("BlockTransfer: %u frames, %u dropped, %u reordered\n", link.GetFrames(), link.GetDropped(), link.GetReordered());
+}
+
+int main(void)
+{
+	TestTransfer();
+	TestBlockTransfer();
+
+	if (failures) {
+		printf("TransferTest: %d checks FAILED\n", failures);
+		return 1;
+	}
+	printf("TransferTest: passed\n");
+	return 0;
+}
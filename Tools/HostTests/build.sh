@@ -0,0 +1,57 @@
+#!/bin/sh
+# Build the host tests of the firmware libraries. Every test is a separate program, which exits with 1 if a check fails; run.sh builds and runs all of them
+cd "$(dirname "$0")"
+LIB=../../KugleFirmware/Libraries
+CXX=${CXX:-g++}
+CC=${CC:-gcc}
+set -e
+CXXFLAGS="-std=gnu++11 -O2 -Wall -Wextra"
+CFLAGS="-std=gnu11 -O2 -Wall -Wextra"
+
+$CXX $CXXFLAGS -I$LIB/Periphirals/EEPROM -I$LIB/Misc/CRC \
+	FlashRecordStoreTest.cpp FlashEmulator.cpp $LIB/Periphirals/EEPROM/FlashRecordStore.cpp $LIB/Misc/CRC/CRC32.cpp -o FlashRecordStoreTest
+
+$CXX $CXXFLAGS -Ihost -I../SensorReplay/host -I$LIB/Devices/LSPC -I$LIB/Misc/CRC -I$LIB/Modules/Parameters -I$LIB/Modules/BlockTransfer -I$LIB/Modules/Debug -I$LIB/Misc/StaticArena \
+	TransferTest.cpp $LIB/Modules/BlockTransfer/BlockTransfer.cpp $LIB/Modules/Parameters/Parameters.cpp $LIB/Misc/CRC/CRC32.cpp $LIB/Misc/StaticArena/StaticArena.cpp -o TransferTest
+
+$CXX $CXXFLAGS -pthread -Ihost/rtos -Ihost -I. -I../SensorReplay/host -I$LIB/Periphirals/EEPROM -I$LIB/Devices/LSPC -I$LIB/Misc/CRC -I$LIB/Modules/Parameters -I$LIB/Modules/FirmwareUpdate -I$LIB/Modules/Debug -I$LIB/Misc/StaticArena \
+	FirmwareUpdateTest.cpp FlashEmulator.cpp $LIB/Modules/FirmwareUpdate/FirmwareUpdate.cpp $LIB/Modules/FirmwareUpdate/ImageWriter.cpp $LIB/Modules/Parameters/Parameters.cpp $LIB/Misc/CRC/CRC32.cpp $LIB/Misc/StaticArena/StaticArena.cpp -o FirmwareUpdateTest
+
+$CC $CFLAGS -DMEMORY_MANAGEMENT_HOST -Ihost/freertos -I../../KugleFirmware/Inc -c ../../KugleFirmware/Src/MemoryManagement.c -o MemoryManagement.o
+$CC $CFLAGS -Ihost/freertos -I../../KugleFirmware/Inc -c ../../KugleFirmware/Middlewares/Third_Party/FreeRTOS/Source/portable/MemMang/heap_4.c -o heap_4.o
+$CXX $CXXFLAGS -Ihost/freertos -I../../KugleFirmware/Inc MemoryTraceTest.cpp MemoryManagement.o heap_4.o -o MemoryTraceTest
+rm -f MemoryManagement.o heap_4.o
+
+CONTROLLER_INCLUDES="-I$LIB/Applications/BalanceController -I$LIB/Modules/Parameters -I$LIB/Devices/LSPC -I$LIB/Devices/IMU \
+	-I$LIB/Modules/Controllers/LQR -I$LIB/Modules/Controllers/SlidingMode -I$LIB/Modules/Controllers/ModelMatrices -I$LIB/Modules/Controllers/QuaternionVelocityControl \
+	-I$LIB/Modules/Estimators/QEKF -I$LIB/Modules/Estimators/QEKF/MATLABCoder -I$LIB/Modules/Estimators/MEKF -I$LIB/Modules/Estimators/MadgwickAHRS/src \
+	-I$LIB/Modules/Estimators/VelocityEKF -I$LIB/Modules/Estimators/VelocityEKF/MATLABCoder -I$LIB/Modules/Estimators/COMEKF -I$LIB/Modules/Estimators/COMEKF/MATLABCoder \
+	-I$LIB/Modules/Estimators/Kinematics -I$LIB/Modules/Estimators/Kinematics/MATLABCoder \
+	-I$LIB/Modules/Telemetry -I$LIB/Modules/Debug -I$LIB/Modules/TimeSync -I../../KugleFirmware/Inc \
+	-I$LIB/Misc/IIR -I$LIB/Misc/Dual -I$LIB/Misc/FirstOrderLPF -I$LIB/Misc/Matrix -I$LIB/Misc/Quaternion -I$LIB/Misc/Math -I$LIB/Misc/CRC -I$LIB/Misc/MATLABCoderInit -I$LIB/Misc/StaticArena"
+CONTROLLER_SOURCES="$LIB/Applications/BalanceController/BalanceLoop.cpp $LIB/Modules/Parameters/Parameters.cpp $LIB/Devices/IMU/IMU.cpp \
+	$LIB/Modules/Controllers/LQR/LQR.cpp $LIB/Modules/Controllers/SlidingMode/SlidingMode.cpp $LIB/Modules/Controllers/ModelMatrices/*.cpp $LIB/Modules/Controllers/QuaternionVelocityControl/QuaternionVelocityControl.cpp \
+	$LIB/Modules/Estimators/QEKF/QEKF.cpp $LIB/Modules/Estimators/QEKF/MATLABCoder/*.cpp $LIB/Modules/Estimators/MEKF/MEKF.cpp $LIB/Modules/Estimators/MadgwickAHRS/src/MadgwickAHRS.cpp \
+	$LIB/Modules/Estimators/VelocityEKF/*.cpp $LIB/Modules/Estimators/VelocityEKF/MATLABCoder/*.cpp $LIB/Modules/Estimators/COMEKF/*.cpp $LIB/Modules/Estimators/COMEKF/MATLABCoder/*.cpp \
+	$LIB/Modules/Estimators/Kinematics/*.cpp $LIB/Modules/Estimators/Kinematics/MATLABCoder/*.cpp \
+	$LIB/Misc/FirstOrderLPF/FirstOrderLPF.cpp $LIB/Misc/Matrix/*.cpp $LIB/Misc/Quaternion/Quaternion.cpp $LIB/Misc/Math/Math.cpp $LIB/Misc/CRC/CRC32.cpp $LIB/Misc/MATLABCoderInit/*.cpp $LIB/Misc/StaticArena/StaticArena.cpp"
+$CXX $CXXFLAGS -Ihost -I../SensorReplay/host $CONTROLLER_INCLUDES StaticArenaTest.cpp $CONTROLLER_SOURCES -o StaticArenaTest
+
+$CXX $CXXFLAGS -pthread -DLOG_HOST -I$LIB/Modules/Debug LogTest.cpp $LIB/Modules/Debug/Log.cpp $LIB/Modules/Debug/RecordBuffer.cpp -o LogTest
+
+# The LSPC socket of the firmware runs its tasks on the deterministic FreeRTOS stand-in and the USB model of host/rtos
+LSPC_INCLUDES="-Ihost/rtos -I$LIB/Devices/LSPC -Ihost"
+$CXX $CXXFLAGS -pthread $LSPC_INCLUDES LSPCThroughputTest.cpp -o LSPCThroughputTest
+$CXX $CXXFLAGS -pthread $LSPC_INCLUDES LSPCStressTest.cpp -o LSPCStressTest
+
+# The debug text path of the firmware with its transmitter thread, on the same stand-ins as the LSPC socket
+$CXX $CXXFLAGS -pthread -DLOG_HOST -I$LIB/Modules/Debug $LSPC_INCLUDES -I../../KugleFirmware/Inc \
+	DebugTest.cpp $LIB/Modules/Debug/Debug.cpp $LIB/Modules/Debug/Log.cpp $LIB/Modules/Debug/RecordBuffer.cpp -o DebugTest
+
+$CXX $CXXFLAGS -Ihost -I../SensorReplay/host -I$LIB/Devices/LSPC -I$LIB/Misc/CRC -I$LIB/Modules/Telemetry -I../LSPCClient \
+	CompactTelemetryTest.cpp $LIB/Modules/Telemetry/Telemetry.cpp $LIB/Misc/CRC/CRC32.cpp -o CompactTelemetryTest
+
+$CXX $CXXFLAGS -pthread -DLOG_HOST -Ihost/rtos -Ihost -I$LIB/Devices/LSPC -I$LIB/Modules/Debug -I../../KugleFirmware/Inc \
+	BlackBoxTest.cpp $LIB/Modules/Debug/BlackBox.cpp $LIB/Modules/Debug/Debug.cpp $LIB/Modules/Debug/Log.cpp $LIB/Modules/Debug/RecordBuffer.cpp -o BlackBoxTest
+
+$CXX $CXXFLAGS -I$LIB/Modules/TimeSync ClockSyncTest.cpp $LIB/Modules/TimeSync/ClockSync.cpp -o ClockSyncTest
@@ -0,0 +1,47 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+ 
+ 
+
+#ifndef HOST_DEBUG_H
+#define HOST_DEBUG_H
+
+#include <stdio.h>
+#include <stdarg.h>
+
+/* Debug messages of the host tests are printed to stderr. Errors are counted, such that a test can check that the
+ * firmware reported one, since ERROR returns on the host instead of stopping like on target */
+#define ERROR(msg)	Debug::Error("ERROR: ", __PRETTY_FUNCTION__, msg)
+
+class Debug
+{
+	public:
+		static void print(const char * msg) { fputs(msg, stderr); };
+		static void printf(const char * msgFmt, ...)
+		{
+			va_list args;
+			va_start(args, msgFmt);
+			vfprintf(stderr, msgFmt, args);
+			va_end(args);
+		};
+		static void Error(const char * type, const char * functionName, const char * msg) { fprintf(stderr, "%s%s: %s\n", type, functionName, msg); ErrorCount()++; };
+		static int& ErrorCount(void) { static int count = 0; return count; };
+};
+
+#endif
@@ -0,0 +1,65 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+ 
+#ifndef HOST_INTERNALFLASH_H
+#define HOST_INTERNALFLASH_H
+
+#include "stm32h7xx_hal.h"
+#include "FlashMemory.h"
+#include "FlashEmulator.h"
+
+/* Consecutive sectors of one of the two flash banks, emulated in RAM, see Tools/HostTests.
+ * The content of the banks is kept across the InternalFlash objects, such that it survives a reboot of the modules under test. */
+class InternalFlash : public FlashMemory
+{
+	public:
+		InternalFlash(uint32_t bank, uint32_t firstSector, uint32_t sectorCount) : bank_(GetBank(bank)), firstSector_(firstSector), sectorCount_(sectorCount) {};
+		~InternalFlash() {};
+
+		uint32_t GetSectorCount(void) { return sectorCount_; };
+		uint32_t GetSectorSize(void) { return FLASH_SECTOR_SIZE; };
+		const uint8_t * GetSectorAddress(uint32_t sector) { return bank_.GetSectorAddress(firstSector_ + sector); };
+
+		bool ProgramWord(uint32_t sector, uint32_t offset, const uint64_t data[FLASH_WORD_SIZE/8])
+		{
+			if (sector >= sectorCount_) return false;
+			return bank_.ProgramWord(firstSector_ + sector, offset, data);
+		};
+
+		bool EraseSector(uint32_t sector)
+		{
+			if (sector >= sectorCount_) return false;
+			return bank_.EraseSector(firstSector_ + sector);
+		};
+
+		/* Emulated flash bank, to inspect the content and to simulate power failures */
+		static FlashEmulator& GetBank(uint32_t bank)
+		{
+			static FlashEmulator bank1(FLASH_SECTOR_TOTAL, FLASH_SECTOR_SIZE);
+			static FlashEmulator bank2(FLASH_SECTOR_TOTAL, FLASH_SECTOR_SIZE);
+			return (bank == FLASH_BANK_2) ? bank2 : bank1;
+		};
+
+	private:
+		FlashEmulator& bank_;
+		uint32_t firstSector_;
+		uint32_t sectorCount_;
+};
+
+#endif
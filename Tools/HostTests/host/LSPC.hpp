@@ -0,0 +1,156 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+ 
+ 
+
+#ifndef HOST_LSPC_HPP
+#define HOST_LSPC_HPP
+
+#include "SocketBase.hpp"
+#include "MessageTypes.h"
+#include "MessageRegistry.hpp"
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+#define LSPC_MAXIMUM_PACKAGE_LENGTH		250
+#define LSPC_PACKAGE_POOL_SIZE			4 // packages are transmitted on Submit, so only the ones being filled are taken from the pool
+
+namespace lspc
+{
+typedef struct LSPC_Async_Package_t {
+	uint8_t type;
+	uint16_t length;
+	uint8_t * payload;
+} LSPC_Async_Package_t;
+}
+
+/* Socket of the host tests, which hands every transmitted package as an encoded frame to a link model
+ * and decodes the frames delivered by the link with the firmware's SocketBase.
+ * Packages are transmitted right away instead of being queued for a transmitter thread. */
+class LSPC : public lspc::SocketBase
+{
+	public:
+		typedef void (*Link_t)(void * param, const uint8_t * frame, uint16_t length);
+
+		LSPC() : link_(0), linkParam_(0) { memset(taken_, 0, sizeof(taken_)); };
+
+		void Connect(Link_t link, void * param) { link_ = link; linkParam_ = param; };
+		bool Connected(void) const { return link_ != 0; };
+		bool Accepts(uint8_t) const { return link_ != 0; }; // packages are transmitted right away, so there is no queue to fill up
+
+		/* Frame delivered by the link */
+		void Deliver(const uint8_t * frame, uint16_t length)
+		{
+			for (uint16_t i = 0; i < length; i++)
+				processIncomingByte(frame[i]);
+		}
+
+		bool send(uint8_t type, const std::vector<uint8_t> &payload) override { return TransmitAsync(type, payload.data(), payload.size()); };
+
+		using lspc::SocketBase::registerCallback;
+
+		template <lspc::MessageTypesFromPC::MessageTypesFromPC_t Type>
+		bool registerCallback(void (*handler)(void * param, const typename lspc::FromPC<Type>::type& msg), void * parameter = 0)
+		{
+			return registerMessageCallback(Type, handler, parameter);
+		}
+
+		template <lspc::MessageTypesFromPC::MessageTypesFromPC_t Type>
+		bool registerCallback(void (*handler)(void * param, const typename lspc::FromPC<Type>::type& msg, const uint8_t * data, uint16_t length), void * parameter = 0)
+		{
+			return registerMessageCallback(Type, handler, parameter);
+		}
+
+		/* Packages of the host side (MessageTypesFromPC) use the same framing, so any type can be transmitted */
+		bool TransmitAsync(uint8_t type, const uint8_t * payload, uint16_t length)
+		{
+			uint8_t frame[LSPC_MAXIMUM_PACKAGE_LENGTH + 4];
+			if (length > LSPC_MAXIMUM_PACKAGE_LENGTH || !link_) return false;
+			size_t frameLength = lspc::Packet::encode(type, payload, length, frame);
+			if (!frameLength) return false;
+			link_(linkParam_, frame, frameLength);
+			return true;
+		}
+
+		template <lspc::MessageTypesToPC::MessageTypesToPC_t Type>
+		bool TransmitAsync(const typename lspc::ToPC<Type>::type& msg) { return TransmitAsync(Type, (const uint8_t *)&msg, sizeof(msg)); };
+
+		bool Reserve(uint8_t type, uint16_t payloadLength, lspc::LSPC_Async_Package_t& package)
+		{
+			if (payloadLength > LSPC_MAXIMUM_PACKAGE_LENGTH) return false;
+			for (int i = 0; i < LSPC_PACKAGE_POOL_SIZE; i++) {
+				if (taken_[i]) continue;
+				taken_[i] = true;
+				package.type = type;
+				package.length = payloadLength;
+				package.payload = (uint8_t *)packages_[i];
+				memset(package.payload, 0, payloadLength);
+				return true;
+			}
+			return false;
+		}
+
+		void Shrink(lspc::LSPC_Async_Package_t& package, uint16_t payloadLength)
+		{
+			if (payloadLength < package.length)
+				package.length = payloadLength;
+		}
+
+		bool Submit(lspc::LSPC_Async_Package_t& package)
+		{
+			bool sent = TransmitAsync(package.type, package.payload, package.length);
+			Release(package);
+			return sent;
+		}
+
+		void Release(const lspc::LSPC_Async_Package_t& package)
+		{
+			for (int i = 0; i < LSPC_PACKAGE_POOL_SIZE; i++)
+				if (package.payload == (uint8_t *)packages_[i])
+					taken_[i] = false;
+		}
+
+		/* Message of a bound type filled in place, as LSPC::Message of the firmware */
+		template <lspc::MessageTypesToPC::MessageTypesToPC_t Type>
+		class Message
+		{
+			public:
+				typedef typename lspc::ToPC<Type>::type type;
+				Message(LSPC& com, uint16_t dataLength = 0) : com_(com) { reserved_ = (dataLength == 0 || lspc::ToPC<Type>::data) && com_.Reserve(Type, sizeof(type) + dataLength, package_); };
+				~Message() { if (reserved_) com_.Release(package_); };
+				bool Reserved(void) const { return reserved_; };
+				type * operator->() { return reinterpret_cast<type *>(package_.payload); };
+				type& operator*() { return *operator->(); };
+				uint8_t * Data(void) { return package_.payload + sizeof(type); };
+				bool Transmit(void) { if (!reserved_) return false; reserved_ = false; return com_.Submit(package_); };
+			private:
+				LSPC& com_;
+				lspc::LSPC_Async_Package_t package_;
+				bool reserved_;
+		};
+
+	private:
+		Link_t link_;
+		void * linkParam_;
+		uint64_t packages_[LSPC_PACKAGE_POOL_SIZE][(LSPC_MAXIMUM_PACKAGE_LENGTH + 7) / 8];
+		bool taken_[LSPC_PACKAGE_POOL_SIZE];
+};
+
+#endif
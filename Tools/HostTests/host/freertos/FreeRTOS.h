@@ -0,0 +1,65 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+ 
+#ifndef HOST_FREERTOS_H
+#define HOST_FREERTOS_H
+
+/* FreeRTOS stand-in for building heap_4.c and the allocation tracer of MemoryManagement.c on a PC, see Tools/HostTests.
+ * The task functions used by them are declared in task.h and implemented by the test. */
+#include <stdint.h>
+#include <stddef.h>
+#include <assert.h>
+
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+
+#define pdFALSE								( ( BaseType_t ) 0 )
+#define pdTRUE								( ( BaseType_t ) 1 )
+
+#define configSUPPORT_DYNAMIC_ALLOCATION	1
+#define configAPPLICATION_ALLOCATED_HEAP	0
+#define configUSE_MALLOC_FAILED_HOOK		0
+#define configTOTAL_HEAP_SIZE				((size_t)65536)
+#define configASSERT( x )					assert( x )
+
+#define portBYTE_ALIGNMENT					8
+#define portBYTE_ALIGNMENT_MASK				( 0x0007 )
+
+#define mtCOVERAGE_TEST_MARKER()
+
+/* Allocation tracing, as in FreeRTOSConfig.h */
+#include "MemoryManagement.h"
+#define traceMALLOC( pvAddress, uiSize ) MemoryTrace_Malloc( pvAddress, uiSize )
+#define traceFREE( pvAddress, uiSize ) MemoryTrace_Free( pvAddress, uiSize )
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void * pvPortMalloc( size_t xSize );
+void vPortFree( void * pv );
+size_t xPortGetFreeHeapSize( void );
+size_t xPortGetMinimumEverFreeHeapSize( void );
+void vPortInitialiseBlocks( void );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,49 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+ 
+#ifndef HOST_TASK_H
+#define HOST_TASK_H
+
+#include "FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef void * TaskHandle_t;
+
+#define taskSCHEDULER_SUSPENDED		( ( BaseType_t ) 0 )
+#define taskSCHEDULER_NOT_STARTED	( ( BaseType_t ) 1 )
+#define taskSCHEDULER_RUNNING		( ( BaseType_t ) 2 )
+
+/* Implemented by the test, which switches between simulated tasks */
+TaskHandle_t xTaskGetCurrentTaskHandle( void );
+BaseType_t xTaskGetSchedulerState( void );
+UBaseType_t uxTaskGetNumberOfTasks( void );
+UBaseType_t uxTaskGetTaskNumber( TaskHandle_t xTask );
+void vTaskSetTaskNumber( TaskHandle_t xTask, const UBaseType_t uxHandle );
+char * pcTaskGetName( TaskHandle_t xTaskToQuery );
+void vTaskSuspendAll( void );
+BaseType_t xTaskResumeAll( void );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
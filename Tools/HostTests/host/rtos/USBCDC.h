@@ -0,0 +1,105 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+ 
+
+#ifndef HOST_RTOS_USBCDC_H
+#define HOST_RTOS_USBCDC_H
+
+/* USB full speed CDC device of the host tests, with the timing of the bulk IN transfers to the PC.
+ * A transfer starts at the next 1 ms frame after the previous transfer has completed, since the PC polls the endpoint again
+ * in the next frame after a short packet. Its 64 byte packets (ended by a short or zero length packet) are sent at up to
+ * USBCDC_PACKETS_PER_FRAME per frame. WriteBlocking waits for the previous transfer to complete, like the firmware.
+ * The data is read from the buffer when the transfer completes, such that a buffer which is changed while it is being
+ * transmitted is noticed by the receiver. Nothing is received from the PC. */
+#include "cmsis_os.h"
+#include <stdint.h>
+
+#define USBCDC_PACKET_SIZE			64
+#define USBCDC_PACKETS_PER_FRAME	19 // bulk packets per 1 ms frame of an otherwise idle bus
+#define USBCDC_FRAME_US				1000
+#define USBCDC_FRAME_PHASE			500 // us, the USB frames are not synchronized with the RTOS tick
+#define USBCDC_MAX_TRANSFERS		2  // WriteBlocking waits for the previous transfer, whose completion timer may still be pending
+
+class USBCDC
+{
+	public:
+		typedef void (*Receiver_t)(void * param, const uint8_t * data, uint32_t length);
+
+		USBCDC(uint32_t transmitterTaskPriority = 0) : receiver_(0), receiverParam_(0), busyUntil_(0), transfersStarted_(0), transfersCompleted_(0), packets_(0), bytes_(0) { (void)transmitterTaskPriority; };
+
+		/* Receiver of the completed transfers on the PC. Called from a timer of the scheduler, so it may not call FreeRTOS functions. */
+		void Connect(Receiver_t receiver, void * param) { receiver_ = receiver; receiverParam_ = param; };
+
+		uint32_t Write(uint8_t * buffer, uint32_t length) { return WriteBlocking(buffer, length); };
+
+		uint32_t WriteBlocking(uint8_t * buffer, uint32_t length)
+		{
+			HostScheduler& scheduler = HostScheduler::Get();
+			scheduler.DelayUntil(busyUntil_); // wait for the previous transfer to complete
+
+			uint64_t start = (scheduler.Now() + USBCDC_FRAME_US - USBCDC_FRAME_PHASE - 1) / USBCDC_FRAME_US * USBCDC_FRAME_US + USBCDC_FRAME_PHASE; // next frame
+			uint32_t packets = length / USBCDC_PACKET_SIZE + 1;
+			busyUntil_ = start + (uint64_t)(packets / USBCDC_PACKETS_PER_FRAME) * USBCDC_FRAME_US + (uint64_t)(packets % USBCDC_PACKETS_PER_FRAME) * USBCDC_FRAME_US / USBCDC_PACKETS_PER_FRAME;
+
+			Transfer_t transfer = { buffer, length };
+			transfers_[transfersStarted_++ % USBCDC_MAX_TRANSFERS] = transfer;
+			scheduler.AddTimer(busyUntil_, &Complete, this);
+
+			packets_ += packets;
+			bytes_ += length;
+			return length;
+		}
+
+		int16_t Read() { return -1; };
+		bool Available() { return false; };
+		uint32_t WaitForNewData(uint32_t xTicksToWait = portMAX_DELAY)
+		{
+			HostScheduler& scheduler = HostScheduler::Get();
+			return scheduler.Block(this, scheduler.WakeTime(xTicksToWait)) ? 1 : 0;
+		}
+		bool Connected() { return true; };
+
+		uint64_t GetTransfers(void) const { return transfersCompleted_; };
+		uint64_t GetPackets(void) const { return packets_; };
+		uint64_t GetBytes(void) const { return bytes_; };
+
+	private:
+		typedef struct {
+			const uint8_t * buffer;
+			uint32_t length;
+		} Transfer_t;
+
+		static void Complete(void * param)
+		{
+			USBCDC * usb = (USBCDC *)param;
+			Transfer_t transfer = usb->transfers_[usb->transfersCompleted_++ % USBCDC_MAX_TRANSFERS];
+			if (usb->receiver_) usb->receiver_(usb->receiverParam_, transfer.buffer, transfer.length);
+		}
+
+		Receiver_t receiver_;
+		void * receiverParam_;
+		uint64_t busyUntil_; // simulated time at which the latest transfer completes [us]
+		Transfer_t transfers_[USBCDC_MAX_TRANSFERS]; // started, but not completed
+		uint64_t transfersStarted_;
+		uint64_t transfersCompleted_;
+		uint64_t packets_;
+		uint64_t bytes_;
+};
+
+#endif
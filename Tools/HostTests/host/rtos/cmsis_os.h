@@ -0,0 +1,424 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+ 
+
+#ifndef HOST_RTOS_CMSIS_OS_H
+#define HOST_RTOS_CMSIS_OS_H
+
+/* Deterministic stand-in of the FreeRTOS API for host tests of modules with their own tasks, such as the LSPC socket.
+ * Every task is a thread, but only one of them runs at a time like on the single core target: the ready task with the highest
+ * priority. A task runs until it blocks in a FreeRTOS call, or until it makes a task of higher priority ready (preemption).
+ * The time is simulated and only advances when every task is blocked, to the next timeout or timer. The results therefore
+ * do not depend on the speed of the PC or on how the operating system schedules the threads. */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+typedef uint32_t TickType_t;
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+typedef void * TaskHandle_t;
+typedef void (*TaskFunction_t)(void * param);
+
+#define configTICK_RATE_HZ		1000
+#define portMAX_DELAY			0xFFFFFFFF
+#define pdMS_TO_TICKS(ms)		((TickType_t)(ms))
+#define pdTRUE					1
+#define pdFALSE					0
+#define pdPASS					pdTRUE
+#define pdFAIL					pdFALSE
+#define errQUEUE_FULL			0
+
+#define HOST_TICK_US			(1000000 / configTICK_RATE_HZ)
+#define HOST_FOREVER			UINT64_MAX
+#define HOST_MAX_TIMERS			16 // pending timers which are added without using the heap
+
+class HostScheduler
+{
+	public:
+		typedef void (*TimerFunction_t)(void * param);
+
+		/* Never destroyed, since the threads of the tasks never end */
+		static HostScheduler& Get(void) { static HostScheduler * scheduler = new HostScheduler; return *scheduler; };
+
+		/* Make the calling thread (the test) a task, which keeps running until it blocks */
+		void Attach(uint32_t priority)
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			current_ = NewTask(priority);
+		}
+
+		TaskHandle_t Create(TaskFunction_t function, void * param, uint32_t priority)
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			Task_t * task = NewTask(priority);
+			std::thread([this, task, function, param]() {
+				{
+					std::unique_lock<std::mutex> lock(mutex_);
+					task->cv.wait(lock, [this, task]() { return current_ == task; });
+				}
+				function(param);
+				Block(0, HOST_FOREVER); // returning from a task is not allowed on target, the task is parked instead
+			}).detach();
+			Preempt(lock);
+			return task;
+		}
+
+		/* Never run the task again. Its thread stays blocked, since it can not be ended from another thread. */
+		void Delete(TaskHandle_t handle)
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			Task_t * task = (Task_t *)handle;
+			task->deleted = true;
+			task->ready = false;
+			task->object = 0;
+			task->wakeTime = HOST_FOREVER;
+		}
+
+		/* Task notifications used as a counting semaphore (xTaskNotifyGive and ulTaskNotifyTake).
+		 * From an interrupt the woken task does not preempt the running task before the handler is left, see HostInterrupt. */
+		void NotifyGive(TaskHandle_t handle, bool preempt = true)
+		{
+			Task_t * task = (Task_t *)handle;
+			{
+				std::unique_lock<std::mutex> lock(mutex_);
+				task->notifications++;
+				notificationsGiven_++;
+			}
+			Wake(&task->notifications, preempt);
+		}
+
+		uint32_t NotifyTake(bool clear, uint64_t wakeTime)
+		{
+			Task_t * task = current_;
+			while (task->notifications == 0) {
+				if (!Block(&task->notifications, wakeTime)) return 0;
+			}
+			uint32_t notifications = task->notifications;
+			task->notifications = clear ? 0 : notifications - 1;
+			return notifications;
+		}
+
+		/* Block the running task until Wake is called for the object or until the simulated time reaches the wake time [us]
+		 * @retval	true if woken by Wake, false at the wake time */
+		bool Block(const void * object, uint64_t wakeTime)
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			Task_t * task = current_;
+			task->ready = false;
+			task->woken = false;
+			task->object = object;
+			task->wakeTime = wakeTime;
+			Switch(lock);
+			return task->woken;
+		}
+
+		/* Make the tasks blocked on the object ready, the running task is preempted by a task of higher priority */
+		void Wake(const void * object, bool preempt = true)
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			for (size_t i = 0; i < tasks_.size(); i++) {
+				Task_t * task = tasks_[i];
+				if (!task->ready && !task->deleted && object && task->object == object) {
+					task->ready = true;
+					task->woken = true;
+					task->readyOrder = ++readyCounter_;
+				}
+			}
+			if (preempt) Preempt(lock);
+		}
+
+		/* Let a ready task of higher priority run, like the context switch at the end of an interrupt handler */
+		void Yield(void)
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			Preempt(lock);
+		}
+
+		void DelayUntil(uint64_t time) { if (time > now_) Block(0, time); };
+
+		/* Call a function when the simulated time reaches the given time. Timer functions may not call the scheduler. */
+		void AddTimer(uint64_t time, TimerFunction_t function, void * param)
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			Timer_t timer = { time, ++timerCounter_, function, param };
+			timers_.push_back(timer);
+		}
+
+		uint64_t Now(void) const { return now_; };
+
+		/* Task notifications given to any task since the start */
+		uint64_t NotificationsGiven(void) const { return notificationsGiven_; };
+
+		/* Absolute wake time of a FreeRTOS timeout in ticks, which ends at a tick */
+		uint64_t WakeTime(TickType_t ticks) const { return (ticks == portMAX_DELAY) ? HOST_FOREVER : (now_ / HOST_TICK_US + ticks) * HOST_TICK_US; };
+
+	private:
+		typedef struct Task_t {
+			uint32_t priority;
+			bool ready;
+			bool woken;
+			bool deleted;
+			uint32_t notifications;
+			const void * object;
+			uint64_t wakeTime;
+			uint64_t readyOrder; // tasks of the same priority run in the order in which they became ready
+			std::condition_variable cv;
+		} Task_t;
+
+		typedef struct {
+			uint64_t time;
+			uint64_t order;
+			TimerFunction_t function;
+			void * param;
+		} Timer_t;
+
+		HostScheduler() : current_(0), now_(0), readyCounter_(0), timerCounter_(0), notificationsGiven_(0) { timers_.reserve(HOST_MAX_TIMERS); };
+
+		Task_t * NewTask(uint32_t priority)
+		{
+			Task_t * task = new Task_t;
+			task->priority = priority;
+			task->ready = true;
+			task->woken = false;
+			task->deleted = false;
+			task->notifications = 0;
+			task->object = 0;
+			task->wakeTime = HOST_FOREVER;
+			task->readyOrder = ++readyCounter_;
+			tasks_.push_back(task);
+			return task;
+		}
+
+		Task_t * PickReady(void)
+		{
+			Task_t * next = 0;
+			for (size_t i = 0; i < tasks_.size(); i++) {
+				Task_t * task = tasks_[i];
+				if (task->ready && (!next || task->priority > next->priority || (task->priority == next->priority && task->readyOrder < next->readyOrder)))
+					next = task;
+			}
+			return next;
+		}
+
+		void Preempt(std::unique_lock<std::mutex>& lock)
+		{
+			Task_t * next = PickReady();
+			if (current_ && next && next->priority > current_->priority)
+				Switch(lock);
+		}
+
+		/* Hand the processor to the next ready task, advancing the time while no task is ready */
+		void Switch(std::unique_lock<std::mutex>& lock)
+		{
+			Task_t * self = current_;
+			Task_t * next;
+			while (!(next = PickReady())) {
+				uint64_t time = HOST_FOREVER;
+				for (size_t i = 0; i < timers_.size(); i++)
+					if (timers_[i].time < time) time = timers_[i].time;
+				for (size_t i = 0; i < tasks_.size(); i++)
+					if (tasks_[i]->wakeTime < time) time = tasks_[i]->wakeTime;
+				if (time == HOST_FOREVER) {
+					fprintf(stderr, "HostScheduler: every task is blocked forever\n");
+					abort();
+				}
+				if (time > now_) now_ = time;
+				RunTimers();
+				for (size_t i = 0; i < tasks_.size(); i++) {
+					Task_t * task = tasks_[i];
+					if (!task->ready && !task->deleted && task->wakeTime <= now_) {
+						task->ready = true;
+						task->readyOrder = ++readyCounter_;
+					}
+				}
+			}
+			if (next == self) return;
+
+			current_ = next;
+			next->cv.notify_one();
+			self->cv.wait(lock, [this, self]() { return current_ == self; });
+		}
+
+		/* Run the due timers in the order of their time, and of their creation for the same time */
+		void RunTimers(void)
+		{
+			while (true) {
+				size_t due = timers_.size();
+				for (size_t i = 0; i < timers_.size(); i++)
+					if (timers_[i].time <= now_ && (due == timers_.size() || timers_[i].time < timers_[due].time ||
+							(timers_[i].time == timers_[due].time && timers_[i].order < timers_[due].order)))
+						due = i;
+				if (due == timers_.size()) return;
+				Timer_t timer = timers_[due];
+				timers_.erase(timers_.begin() + due);
+				timer.function(timer.param);
+			}
+		}
+
+		std::mutex mutex_;
+		std::vector<Task_t *> tasks_;
+		Task_t * current_;
+		std::vector<Timer_t> timers_;
+		uint64_t now_; // simulated time [us]
+		uint64_t readyCounter_;
+		uint64_t timerCounter_;
+		uint64_t notificationsGiven_;
+};
+
+/* Queues and semaphores. Only the running task accesses them, so they need no lock of their own. */
+typedef struct {
+	UBaseType_t length;
+	UBaseType_t itemSize;
+	UBaseType_t head; // oldest item
+	UBaseType_t count;
+	uint8_t * storage; // allocated on creation like the queue storage of FreeRTOS, such that sending and receiving do not use the heap
+} HostQueue_t;
+
+typedef struct {
+	UBaseType_t count;
+	UBaseType_t maxCount;
+} HostSemaphore_t;
+
+typedef HostQueue_t * QueueHandle_t;
+typedef HostSemaphore_t * SemaphoreHandle_t;
+
+inline QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize)
+{
+	HostQueue_t * queue = new HostQueue_t;
+	queue->length = length;
+	queue->itemSize = itemSize;
+	queue->head = 0;
+	queue->count = 0;
+	queue->storage = new uint8_t[length * itemSize];
+	return queue;
+}
+
+inline BaseType_t xQueueSend(QueueHandle_t queue, const void * item, TickType_t ticksToWait)
+{
+	HostScheduler& scheduler = HostScheduler::Get();
+	uint64_t wakeTime = scheduler.WakeTime(ticksToWait);
+	while (queue->count >= queue->length) {
+		if (ticksToWait == 0 || !scheduler.Block(&queue->length, wakeTime)) return errQUEUE_FULL;
+	}
+	memcpy(&queue->storage[((queue->head + queue->count) % queue->length) * queue->itemSize], item, queue->itemSize);
+	queue->count++;
+	scheduler.Wake(&queue->count);
+	return pdTRUE;
+}
+
+inline BaseType_t xQueueReceive(QueueHandle_t queue, void * item, TickType_t ticksToWait)
+{
+	HostScheduler& scheduler = HostScheduler::Get();
+	uint64_t wakeTime = scheduler.WakeTime(ticksToWait);
+	while (queue->count == 0) {
+		if (ticksToWait == 0 || !scheduler.Block(&queue->count, wakeTime)) return pdFAIL;
+	}
+	memcpy(item, &queue->storage[queue->head * queue->itemSize], queue->itemSize);
+	queue->head = (queue->head + 1) % queue->length;
+	queue->count--;
+	scheduler.Wake(&queue->length);
+	return pdPASS;
+}
+
+inline UBaseType_t uxQueueSpacesAvailable(QueueHandle_t queue) { return queue->length - queue->count; }
+inline UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) { return queue->count; }
+
+inline SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t maxCount, UBaseType_t initialCount)
+{
+	HostSemaphore_t * semaphore = new HostSemaphore_t;
+	semaphore->count = initialCount;
+	semaphore->maxCount = maxCount;
+	return semaphore;
+}
+
+inline SemaphoreHandle_t xSemaphoreCreateBinary(void) { return xSemaphoreCreateCounting(1, 0); }
+
+inline BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticksToWait)
+{
+	HostScheduler& scheduler = HostScheduler::Get();
+	uint64_t wakeTime = scheduler.WakeTime(ticksToWait);
+	while (semaphore->count == 0) {
+		if (ticksToWait == 0 || !scheduler.Block(semaphore, wakeTime)) return pdFALSE;
+	}
+	semaphore->count--;
+	return pdTRUE;
+}
+
+inline BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore)
+{
+	if (semaphore->count >= semaphore->maxCount) return pdFALSE;
+	semaphore->count++;
+	HostScheduler::Get().Wake(semaphore);
+	return pdTRUE;
+}
+
+inline void vSemaphoreDelete(SemaphoreHandle_t semaphore) { delete semaphore; }
+
+inline void vQueueAddToRegistry(const void * queue, const char * name) { (void)queue; (void)name; }
+inline void vQueueUnregisterQueue(const void * queue) { (void)queue; }
+
+inline BaseType_t xTaskCreate(TaskFunction_t function, const char * name, uint16_t stackDepth, void * param, UBaseType_t priority, TaskHandle_t * handle)
+{
+	(void)name; (void)stackDepth;
+	TaskHandle_t task = HostScheduler::Get().Create(function, param, priority);
+	if (handle) *handle = task;
+	return pdPASS;
+}
+
+inline void vTaskDelete(TaskHandle_t task) { HostScheduler::Get().Delete(task); }
+inline void xTaskNotifyGive(TaskHandle_t task) { HostScheduler::Get().NotifyGive(task); }
+inline uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t ticksToWait)
+{
+	HostScheduler& scheduler = HostScheduler::Get();
+	return scheduler.NotifyTake(clear == pdTRUE, (ticksToWait == 0) ? scheduler.Now() : scheduler.WakeTime(ticksToWait));
+}
+
+/* Interrupts of the host tests. A test acts as an interrupt handler between HostInterrupt(number) and HostInterrupt(0), during
+ * which __get_IPSR returns the number. Tasks woken from the handler run when it is left, as requested by portYIELD_FROM_ISR. */
+typedef BaseType_t portBASE_TYPE;
+
+inline uint32_t& HostIPSR(void) { static uint32_t ipsr = 0; return ipsr; }
+inline uint32_t __get_IPSR(void) { return HostIPSR(); }
+inline void HostInterrupt(uint32_t number)
+{
+	HostIPSR() = number;
+	if (number == 0) HostScheduler::Get().Yield();
+}
+
+inline void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t * higherPriorityTaskWoken)
+{
+	HostScheduler::Get().NotifyGive(task, false);
+	if (higherPriorityTaskWoken) *higherPriorityTaskWoken = pdTRUE;
+}
+#define portYIELD_FROM_ISR(woken)	((void)(woken))
+
+inline void * pvPortMalloc(size_t size) { return malloc(size); }
+inline void vPortFree(void * ptr) { free(ptr); }
+
+inline TickType_t xTaskGetTickCount(void) { return (TickType_t)(HostScheduler::Get().Now() / HOST_TICK_US); }
+inline void vTaskDelay(TickType_t ticks) { HostScheduler& scheduler = HostScheduler::Get(); scheduler.DelayUntil(scheduler.WakeTime(ticks)); }
+inline void osDelay(uint32_t ms) { vTaskDelay(pdMS_TO_TICKS(ms)); }
+
+#endif
@@ -0,0 +1,125 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+ 
+#ifndef HOST_STM32H7XX_HAL_H
+#define HOST_STM32H7XX_HAL_H
+
+/* Flash, reset and cycle counter stand-ins of the host tests, see Tools/HostTests.
+ * The option bytes are kept in a host variable, and a system reset throws HostReset, which the test catches to reboot the modules. */
+#include <stdint.h>
+#include <stddef.h>
+#include <chrono>
+
+#define FLASH_BANK_1				0x01U
+#define FLASH_BANK_2				0x02U
+#define FLASH_SECTOR_SIZE			0x00020000U // 128 KB
+#define FLASH_SECTOR_6				6U
+#define FLASH_SECTOR_TOTAL			8U // sectors per bank
+
+#define FLASH_OPTSR_SWAP_BANK_OPT	(1UL << 31)
+#define OPTIONBYTE_USER				0x04U
+#define OB_USER_SWAP_BANK			FLASH_OPTSR_SWAP_BANK_OPT
+#define OB_SWAP_BANK_ENABLE			FLASH_OPTSR_SWAP_BANK_OPT
+#define OB_SWAP_BANK_DISABLE		0x00000000U
+
+#define READ_BIT(REG, BIT)			((REG) & (BIT))
+#define __EXPORT					// marks functions of the firmware which are called from C, nothing to do on the host
+
+typedef enum {
+	HAL_OK = 0x00U,
+	HAL_ERROR = 0x01U,
+	HAL_BUSY = 0x02U,
+	HAL_TIMEOUT = 0x03U
+} HAL_StatusTypeDef;
+
+typedef struct {
+	uint32_t OPTSR_CUR; // option bytes in effect
+	uint32_t OPTSR_PRG; // option bytes to be launched
+} FLASH_TypeDef;
+
+typedef struct {
+	uint32_t OptionType;
+	uint32_t USERType;
+	uint32_t USERConfig;
+} FLASH_OBProgramInitTypeDef;
+
+inline FLASH_TypeDef * HostFlash(void)
+{
+	static FLASH_TypeDef flash = { 0, 0 };
+	return &flash;
+}
+#define FLASH						HostFlash()
+
+inline HAL_StatusTypeDef HAL_FLASH_Unlock(void) { return HAL_OK; }
+inline HAL_StatusTypeDef HAL_FLASH_Lock(void) { return HAL_OK; }
+inline HAL_StatusTypeDef HAL_FLASH_OB_Unlock(void) { return HAL_OK; }
+inline HAL_StatusTypeDef HAL_FLASH_OB_Lock(void) { return HAL_OK; }
+
+inline HAL_StatusTypeDef HAL_FLASHEx_OBProgram(FLASH_OBProgramInitTypeDef * optionBytes)
+{
+	if (optionBytes->OptionType & OPTIONBYTE_USER)
+		FLASH->OPTSR_PRG = (FLASH->OPTSR_CUR & ~optionBytes->USERType) | (optionBytes->USERConfig & optionBytes->USERType);
+	return HAL_OK;
+}
+
+inline HAL_StatusTypeDef HAL_FLASH_OB_Launch(void)
+{
+	FLASH->OPTSR_CUR = FLASH->OPTSR_PRG;
+	return HAL_OK;
+}
+
+/* Debug registers of the Cortex-M7. The cycle counter DWT->CYCCNT counts nanoseconds of the PC clock instead of CPU cycles. */
+#define CoreDebug_DEMCR_TRCENA_Msk	(1UL << 24)
+#define DWT_CTRL_CYCCNTENA_Msk		(1UL << 0)
+
+typedef struct {
+	uint32_t DEMCR;
+} CoreDebug_Type;
+
+typedef struct {
+	struct {
+		operator uint32_t() const { return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count(); };
+	} CYCCNT;
+	uint32_t CTRL;
+	uint32_t LAR;
+} DWT_Type;
+
+inline CoreDebug_Type * HostCoreDebug(void)
+{
+	static CoreDebug_Type coreDebug = { 0 };
+	return &coreDebug;
+}
+#define CoreDebug					HostCoreDebug()
+
+inline DWT_Type * HostDWT(void)
+{
+	static DWT_Type dwt;
+	return &dwt;
+}
+#define DWT							HostDWT()
+
+/* Thrown by NVIC_SystemReset, which does not return on the target */
+struct HostReset {};
+
+inline void NVIC_SystemReset(void)
+{
+	throw HostReset();
+}
+
+#endif
@@ -0,0 +1,10 @@
+#!/bin/sh
+# Build and run all host tests, exits with 1 if any of them fails
+cd "$(dirname "$0")"
+./build.sh || exit 1
+
+failed=0
+for test in *Test; do
+	./$test || failed=1
+done
+exit $failed
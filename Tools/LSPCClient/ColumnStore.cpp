@@ -0,0 +1,285 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+ 
+#include "ColumnStore.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+static const char * ColumnTypeName(columnType_t type)
+{
+	switch (type) {
+		case COLUMN_FLOAT32: return "f32";
+		case COLUMN_INT32: return "i32";
+		case COLUMN_UINT32: return "u32";
+		case COLUMN_UINT16: return "u16";
+		case COLUMN_UINT8: return "u8";
+		case COLUMN_UINT64: return "u64";
+		case COLUMN_INT64: return "i64";
+		default: return "bin";
+	}
+}
+
+ColumnStore::Table::Table(const std::string& directory, const Column_t * columns, uint8_t columnCount) : directory_(directory), bufferedRows_(0), rows_(0), failed_(false)
+{
+	columns_.resize(columnCount + 1);
+	columns_[0].column.name = "host_time";
+	columns_[0].column.offset = 0;
+	columns_[0].column.count = 1;
+	columns_[0].column.type = COLUMN_UINT64;
+	for (uint8_t i = 0; i < columnCount; i++)
+		columns_[i + 1].column = columns[i];
+
+	for (size_t i = 0; i < columns_.size(); i++) {
+		columns_[i].valueSize = ColumnTypeSize(columns_[i].column.type);
+		columns_[i].fd = -1;
+		columns_[i].buffer.resize((size_t)COLUMN_STORE_BUFFER_ROWS * columns_[i].column.count * columns_[i].valueSize);
+	}
+}
+
+ColumnStore::Table::~Table()
+{
+	Flush();
+	for (size_t i = 0; i < columns_.size(); i++) {
+		if (columns_[i].fd >= 0)
+			close(columns_[i].fd);
+	}
+}
+
+/**
+ * @brief 	Create the table directory with the schema and the empty column files
+ * @retval	true if successful
+ */
+bool ColumnStore::Table::Create(void)
+{
+	if (mkdir(directory_.c_str(), 0755) != 0 && errno != EEXIST)
+		return false;
+
+	FILE * schema = fopen((directory_ + "/schema.txt").c_str(), "w");
+	if (!schema) return false;
+	for (size_t i = 0; i < columns_.size(); i++) {
+		const Column_t& column = columns_[i].column;
+		fprintf(schema, "%s %s %u\n", column.name, ColumnTypeName(column.type), column.count);
+
+		std::string path = directory_ + "/" + column.name + "." + ColumnTypeName(column.type);
+		columns_[i].fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		if (columns_[i].fd < 0) {
+			fclose(schema);
+			return false;
+		}
+	}
+	fclose(schema);
+	return true;
+}
+
+/**
+ * @brief 	Append a row to the table
+ * @param	record     Input: record with the column values at the offsets of the column table
+ * @param	time       Input: reception time in microseconds since the UNIX epoch
+ */
+void ColumnStore::Table::Append(const uint8_t * record, uint64_t time)
+{
+	column_t& timeColumn = columns_[0];
+	memcpy(&timeColumn.buffer[bufferedRows_ * sizeof(time)], &time, sizeof(time));
+
+	for (size_t i = 1; i < columns_.size(); i++) {
+		column_t& column = columns_[i];
+		size_t rowSize = column.column.count * column.valueSize;
+		memcpy(&column.buffer[bufferedRows_ * rowSize], &record[column.column.offset], rowSize);
+	}
+
+	rows_++;
+	if (++bufferedRows_ == COLUMN_STORE_BUFFER_ROWS)
+		Flush();
+}
+
+/**
+ * @brief 	Write the buffered rows to the column files
+ * @retval	false if a column file could not be written, in which case the table stops writing
+ */
+bool ColumnStore::Table::Flush(void)
+{
+	if (failed_) return false;
+
+	for (size_t i = 0; i < columns_.size(); i++) {
+		column_t& column = columns_[i];
+		size_t length = (size_t)bufferedRows_ * column.column.count * column.valueSize;
+		const uint8_t * data = column.buffer.data();
+		while (length > 0) {
+			ssize_t written = write(column.fd, data, length);
+			if (written < 0 && errno == EINTR) continue;
+			if (written <= 0) {
+				failed_ = true;
+				return false;
+			}
+			data += written;
+			length -= written;
+		}
+	}
+
+	bufferedRows_ = 0;
+	return true;
+}
+
+ColumnStore::ColumnStore() : rows_(0), rejected_(0), open_(false)
+{
+	memset(typeTables_, 0, sizeof(typeTables_));
+	memset(mathDumpTables_, 0, sizeof(mathDumpTables_));
+}
+
+ColumnStore::~ColumnStore()
+{
+	Close();
+}
+
+/**
+ * @brief 	Open a new store. The directory is created if it does not exist, existing tables within it are overwritten
+ * @param	directory  Input: store directory
+ * @retval	true if successful
+ */
+bool ColumnStore::Open(const std::string& directory)
+{
+	Close();
+	if (mkdir(directory.c_str(), 0755) != 0 && errno != EEXIST)
+		return false;
+
+	directory_ = directory;
+	rows_ = 0;
+	rejected_ = 0;
+	open_ = true;
+	return true;
+}
+
+void ColumnStore::Close(void)
+{
+	for (std::map<std::string, Table *>::iterator it = tables_.begin(); it != tables_.end(); ++it)
+		delete it->second;
+	tables_.clear();
+	memset(typeTables_, 0, sizeof(typeTables_));
+	memset(mathDumpTables_, 0, sizeof(mathDumpTables_));
+	open_ = false;
+}
+
+/**
+ * @brief 	Write the buffered rows of all tables, eg. periodically such that the column files can be read during a capture
+ * @retval	true if successful
+ */
+bool ColumnStore::Flush(void)
+{
+	bool success = true;
+	for (std::map<std::string, Table *>::iterator it = tables_.begin(); it != tables_.end(); ++it)
+		success &= it->second->Flush();
+	return success;
+}
+
+/**
+ * @brief 	Get a table of the store, which is created with the given columns if it does not exist
+ * @param	name         Input: table name, which is also the name of its directory
+ * @param	columns      Input: column table, the column names have to stay valid while the store is open
+ * @param	columnCount  Input: number of columns
+ * @retval	table or 0 if it could not be created
+ */
+ColumnStore::Table * ColumnStore::GetTable(const std::string& name, const Column_t * columns, uint8_t columnCount)
+{
+	if (!open_) return 0;
+
+	std::map<std::string, Table *>::iterator it = tables_.find(name);
+	if (it != tables_.end())
+		return it->second;
+
+	Table * table = new Table(directory_ + "/" + name, columns, columnCount);
+	if (!table->Create()) {
+		delete table;
+		return 0;
+	}
+	tables_[name] = table;
+	return table;
+}
+
+/**
+ * @brief 	Store a received package in the table of its message type
+ * @param	type       Input: message type (MessageTypesToPC)
+ * @param	payload    Input: package payload, ie. the message structure
+ * @param	length     Input: payload length
+ * @param	time       Input: reception time in microseconds since the UNIX epoch
+ */
+void ColumnStore::AppendMessage(uint8_t type, const uint8_t * payload, uint16_t length, uint64_t time)
+{
+	if (!open_) return;
+
+	if (type == lspc::MessageTypesToPC::MathDump) {
+		uint16_t count = length / sizeof(float);
+		if (count == 0 || count * sizeof(float) != length || count >= sizeof(mathDumpTables_) / sizeof(mathDumpTables_[0])) {
+			rejected_++;
+			return;
+		}
+		if (!mathDumpTables_[count]) {
+			Column_t& column = mathDumpColumns_[count];
+			column.name = "values";
+			column.offset = 0;
+			column.count = count;
+			column.type = COLUMN_FLOAT32;
+			mathDumpTables_[count] = GetTable("MathDump_" + std::to_string(count), &column, 1);
+			if (!mathDumpTables_[count]) return;
+		}
+		mathDumpTables_[count]->Append(payload, time);
+		rows_++;
+		return;
+	}
+
+	const MessageTable_t * message = GetMessageTable(type);
+	if (message) {
+		if (length != message->size) {
+			rejected_++;
+			return;
+		}
+		if (!typeTables_[type]) {
+			typeTables_[type] = GetTable(message->name, message->columns, message->columnCount);
+			if (!typeTables_[type]) return;
+		}
+		typeTables_[type]->Append(payload, time);
+		rows_++;
+		return;
+	}
+
+	static const Column_t RawColumns[] = {
+		{ "length", 0, 1, COLUMN_UINT16 },
+		{ "payload", sizeof(uint16_t), COLUMN_STORE_RAW_PAYLOAD, COLUMN_UINT8 }
+	};
+	if (length > COLUMN_STORE_RAW_PAYLOAD) {
+		rejected_++;
+		return;
+	}
+	if (!typeTables_[type]) {
+		char name[16];
+		snprintf(name, sizeof(name), "Raw_0x%02X", type);
+		typeTables_[type] = GetTable(name, RawColumns, sizeof(RawColumns) / sizeof(Column_t));
+		if (!typeTables_[type]) return;
+	}
+	uint8_t record[sizeof(uint16_t) + COLUMN_STORE_RAW_PAYLOAD];
+	memset(record, 0, sizeof(record));
+	memcpy(record, &length, sizeof(length));
+	memcpy(&record[sizeof(uint16_t)], payload, length);
+	typeTables_[type]->Append(record, time);
+	rows_++;
+}
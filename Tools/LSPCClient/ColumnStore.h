@@ -0,0 +1,102 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+ 
+#ifndef TOOLS_LSPCCLIENT_COLUMNSTORE_H
+#define TOOLS_LSPCCLIENT_COLUMNSTORE_H
+
+#include "MessageColumns.h"
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <map>
+
+#define COLUMN_STORE_BUFFER_ROWS	4096 // rows buffered per table before they are written to the column files
+#define COLUMN_STORE_RAW_PAYLOAD	254 // payload column width of message types without a message table (maximum LSPC payload)
+
+/* Store of captured messages with one directory per table and one file per column.
+ *
+ * A column file is a plain little-endian array of the column values, with 'width' values per row,
+ * such that it can be memory mapped directly, eg. with numpy.memmap(file, dtype='<f4').reshape(-1, width).
+ * The file extension gives the value type (f32, i32, u32, u16, u8, u64 or i64) and schema.txt of the table lists
+ * every column as "<name> <type> <width>". The first column of every table is host_time, the reception time
+ * in microseconds since the UNIX epoch, followed by the columns of the message structure.
+ *
+ * The rows of all columns of a table are written together, so after a flush every column file has the same number of rows.
+ * A table is created for every received message type, named after the message type. Message types without a message table
+ * are stored in "Raw_0xNN" as the payload length and the zero padded payload. MathDump arrays are stored in "MathDump_<n>",
+ * one table per array length n, with the array as a single column. */
+class ColumnStore
+{
+	public:
+		class Table
+		{
+			friend class ColumnStore;
+
+			public:
+				void Append(const uint8_t * record, uint64_t time);
+				uint64_t GetRows(void) const { return rows_; }
+
+			private:
+				Table(const std::string& directory, const Column_t * columns, uint8_t columnCount);
+				~Table();
+				bool Create(void);
+				bool Flush(void);
+
+			private:
+				typedef struct column_t {
+					Column_t column;
+					uint8_t valueSize;
+					int fd;
+					std::vector<uint8_t> buffer;
+				} column_t;
+
+				std::string directory_;
+				std::vector<column_t> columns_;
+				uint32_t bufferedRows_;
+				uint64_t rows_;
+				bool failed_;
+		};
+
+	public:
+		ColumnStore();
+		~ColumnStore();
+
+		bool Open(const std::string& directory);
+		void Close(void);
+		bool Flush(void);
+
+		Table * GetTable(const std::string& name, const Column_t * columns, uint8_t columnCount);
+		void AppendMessage(uint8_t type, const uint8_t * payload, uint16_t length, uint64_t time);
+
+		uint64_t GetRows(void) const { return rows_; }
+		uint64_t GetRejected(void) const { return rejected_; } // packages with a length not matching the message structure
+
+	private:
+		std::string directory_;
+		std::map<std::string, Table *> tables_;
+		Table * typeTables_[256]; // table of each message type, to avoid the lookup by name for every package
+		Table * mathDumpTables_[COLUMN_STORE_RAW_PAYLOAD / sizeof(float) + 1]; // MathDump table of each array length
+		Column_t mathDumpColumns_[COLUMN_STORE_RAW_PAYLOAD / sizeof(float) + 1];
+		uint64_t rows_;
+		uint64_t rejected_;
+		bool open_;
+};
+
+#endif
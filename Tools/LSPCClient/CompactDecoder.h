@@ -0,0 +1,188 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+ 
+#ifndef TOOLS_LSPCCLIENT_COMPACTDECODER_H
+#define TOOLS_LSPCCLIENT_COMPACTDECODER_H
+
+#include "MessageTypes.h"
+#include "MessageColumns.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <vector>
+
+/* Decoder of CompactTelemetry packages (see TelemetryTypes::Compact_t) back into the full message structures.
+ * A delta frame can only be decoded if the previous frame of the stream has been decoded,
+ * otherwise the stream is skipped until the next key frame.
+ * FIELD_WRAPPING values are kept as 64 bit step counts, which key frames set and delta frames advance by the 32 bit difference.
+ * The time base of the time field of each decoded message is given by IsSynchronizedTime. */
+class CompactDecoder
+{
+	public:
+		CompactDecoder() : decoded_(0), skipped_(0) {}
+
+		/**
+		 * @brief 	Decode a CompactTelemetry package
+		 * @param	payload    Input: package payload
+		 * @param	length     Input: payload length
+		 * @param	type       Output: message type of the decoded message
+		 * @param	msg        Output: decoded message structure
+		 * @param	size       Input: size of the msg buffer
+		 * @retval	size of the decoded message structure, or 0 if the package could not be decoded
+		 */
+		uint16_t Decode(const uint8_t * payload, uint16_t length, uint8_t& type, uint8_t * msg, uint16_t size)
+		{
+			lspc::TelemetryTypes::Compact_t header;
+			if (length < sizeof(header)) return 0;
+			memcpy(&header, payload, sizeof(header));
+			type = header.type;
+
+			uint8_t fieldCount;
+			const lspc::TelemetryTypes::CompactField_t * fields = lspc::TelemetryTypes::GetCompactFields(header.type, fieldCount);
+			if (!fields) return 0;
+
+			// The message structure ends with the last field of the table
+			uint16_t messageSize = 0;
+			uint8_t valueCount = 0, constantsSize = 0;
+			for (uint8_t i = 0; i < fieldCount; i++) {
+				uint16_t end = fields[i].offset + fields[i].count * (fields[i].kind == lspc::TelemetryTypes::FIELD_UINT8 ? 1 : sizeof(float));
+				if (end > messageSize) messageSize = end;
+				if (fields[i].kind == lspc::TelemetryTypes::FIELD_CONSTANT)
+					constantsSize += fields[i].count * sizeof(float);
+				else
+					valueCount += fields[i].count;
+			}
+			const MessageTable_t * table = GetMessageTable(header.type);
+			if (table && table->size > messageSize)
+				messageSize = table->size; // members after the last field of the compact table
+			messageSize = (messageSize + sizeof(float) - 1) & ~(sizeof(float) - 1); // structure padding
+			if (messageSize > size) return 0;
+
+			stream_t& stream = streams_[header.type];
+			if (stream.previous.size() != valueCount) {
+				stream.previous.assign(valueCount, 0);
+				stream.constants.assign(constantsSize, 0);
+				stream.valid = false;
+				stream.haveConstants = false;
+			}
+
+			bool keyFrame = header.flags & lspc::TelemetryTypes::COMPACT_KEY_FRAME;
+			if (!keyFrame && (!stream.valid || header.frame != (uint16_t)(stream.frame + 1))) {
+				stream.valid = false;
+				skipped_++;
+				return 0;
+			}
+
+			const uint8_t * ptr = payload + sizeof(header);
+			const uint8_t * end = payload + length;
+			if (header.flags & lspc::TelemetryTypes::COMPACT_CONSTANTS) {
+				if (ptr + constantsSize > end) return 0;
+				memcpy(stream.constants.data(), ptr, constantsSize);
+				ptr += constantsSize;
+				stream.haveConstants = true;
+			}
+
+			std::vector<int64_t> values(valueCount);
+			for (uint8_t i = 0, index = 0; i < fieldCount; i++) {
+				if (fields[i].kind == lspc::TelemetryTypes::FIELD_CONSTANT) continue;
+				for (uint8_t n = 0; n < fields[i].count; n++, index++) {
+					int64_t value;
+					if (!ReadVarint(ptr, end, value)) return 0;
+					if (keyFrame)
+						values[index] = value;
+					else if (fields[i].kind == lspc::TelemetryTypes::FIELD_WRAPPING)
+						values[index] = stream.previous[index] + (int32_t)value;
+					else
+						values[index] = (int32_t)((uint32_t)stream.previous[index] + (uint32_t)value);
+				}
+			}
+			stream.previous.swap(values);
+			stream.frame = header.frame;
+			stream.valid = true;
+			stream.synchronizedTime = header.flags & lspc::TelemetryTypes::COMPACT_SYNCHRONIZED;
+
+			memset(msg, 0, messageSize);
+			uint8_t index = 0;
+			uint16_t constantsOffset = 0;
+			for (uint8_t i = 0; i < fieldCount; i++) {
+				const lspc::TelemetryTypes::CompactField_t& field = fields[i];
+				if (field.kind == lspc::TelemetryTypes::FIELD_CONSTANT) {
+					if (stream.haveConstants)
+						memcpy(&msg[field.offset], &stream.constants[constantsOffset], field.count * sizeof(float));
+					else
+						for (uint8_t n = 0; n < field.count; n++) {
+							float nan = NAN; // constants of this session have not been received yet
+							memcpy(&msg[field.offset + n * sizeof(float)], &nan, sizeof(nan));
+						}
+					constantsOffset += field.count * sizeof(float);
+					continue;
+				}
+
+				for (uint8_t n = 0; n < field.count; n++, index++) {
+					if (field.kind == lspc::TelemetryTypes::FIELD_UINT8) {
+						msg[field.offset + n] = (uint8_t)stream.previous[index];
+					} else {
+						float value = (float)((double)stream.previous[index] * field.resolution);
+						memcpy(&msg[field.offset + n * sizeof(float)], &value, sizeof(value));
+					}
+				}
+			}
+
+			decoded_++;
+			return messageSize;
+		}
+
+		uint32_t GetDecoded(void) const { return decoded_; }
+		uint32_t GetSkipped(void) const { return skipped_; } // delta frames which could not be decoded since a previous frame was lost
+		// Time base of the latest decoded message of a type: seconds since the epoch given by the PC if true, otherwise seconds since boot
+		bool IsSynchronizedTime(uint8_t type) const { return streams_[type].synchronizedTime; }
+
+	private:
+		static bool ReadVarint(const uint8_t *& ptr, const uint8_t * end, int64_t& value)
+		{
+			uint64_t zigzag = 0;
+			for (uint8_t shift = 0; shift < 70; shift += 7) {
+				if (ptr >= end) return false;
+				uint8_t byte = *ptr++;
+				zigzag |= (uint64_t)(byte & 0x7F) << shift;
+				if (!(byte & 0x80)) {
+					value = (int64_t)((zigzag >> 1) ^ (0 - (zigzag & 1)));
+					return true;
+				}
+			}
+			return false;
+		}
+
+		typedef struct stream_t {
+			stream_t() : frame(0), valid(false), haveConstants(false), synchronizedTime(false) {}
+			std::vector<int64_t> previous; // quantized values of the previous frame
+			std::vector<uint8_t> constants;
+			uint16_t frame;
+			bool valid;
+			bool haveConstants;
+			bool synchronizedTime;
+		} stream_t;
+
+		stream_t streams_[256];
+		uint32_t decoded_;
+		uint32_t skipped_;
+};
+
+#endif
@@ -0,0 +1,170 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+ 
+/* Capture of the telemetry of the robot into a column store (see ColumnStore.h).
+ *
+ * The given telemetry streams are enabled when the capture starts and disabled again when it is stopped with Ctrl+C.
+ * Every received message is stored, including streams enabled by other means and the MathDump arrays.
+ * The robot clock is synchronized to the PC clock during the capture, such that the time of the telemetry is in
+ * seconds since the start of the capture once the robot reports that it is synchronized (stored in the TimeSync table).
+ * A stream is given as <type>[:<prescaler>[:compact]] with the message type as a name, eg. StateEstimates, or a number.
+ * Build with build.sh.
+ *
+ * Usage: LSPCCapture <serial device> <store directory> [stream ...]
+ *        eg. LSPCCapture /dev/ttyACM0 capture StateEstimates:1:compact RawSensor_IMU_MPU9250:2 MathDump
+ */
+
+#include "LSPCClient.h"
+#include "ColumnStore.h"
+#include "MessageColumns.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+#include <vector>
+
+#define CAPTURE_FLUSH_INTERVAL	1000000 // microseconds between writes of the buffered rows, such that the store can be read during the capture
+#define CAPTURE_SYNC_INTERVAL	250000 // microseconds between clock synchronization requests
+#define CAPTURE_STATS_INTERVAL	4 // clock synchronization requests between printed statistics
+
+typedef struct {
+	ColumnStore store;
+	uint64_t flushed;
+} capture_t;
+
+static volatile sig_atomic_t stop = 0;
+
+static void Stop_Handler(int)
+{
+	stop = 1;
+}
+
+static void Message_Handler(void * param, uint8_t type, const uint8_t * msg, uint16_t length, uint64_t time)
+{
+	capture_t * capture = (capture_t *)param;
+	capture->store.AppendMessage(type, msg, length, time);
+	if (time - capture->flushed > CAPTURE_FLUSH_INTERVAL) {
+		capture->store.Flush();
+		capture->flushed = time;
+	}
+}
+
+static bool ParseStream(const char * arg, lspc::TelemetryTypes::Stream_t& stream)
+{
+	char name[64];
+	unsigned int prescaler = 1;
+	char format[16] = "";
+	if (sscanf(arg, "%63[^:]:%u:%15s", name, &prescaler, format) < 1) return false;
+
+	stream.prescaler = prescaler;
+	stream.format = strcmp(format, "compact") ? lspc::TelemetryTypes::FULL : lspc::TelemetryTypes::COMPACT;
+	if (format[0] && stream.format != lspc::TelemetryTypes::COMPACT) return false;
+
+	if (!strcmp(name, "MathDump")) {
+		stream.type = lspc::MessageTypesToPC::MathDump;
+		return true;
+	}
+	for (size_t i = 0; i < sizeof(MessageTables) / sizeof(MessageTable_t); i++) {
+		if (!strcmp(name, MessageTables[i].name)) {
+			stream.type = MessageTables[i].type;
+			return true;
+		}
+	}
+
+	char * end;
+	unsigned long type = strtoul(name, &end, 0);
+	if (*end || type == 0 || type > 0xFF) return false;
+	stream.type = type;
+	return true;
+}
+
+int main(int argc, char ** argv)
+{
+	if (argc < 3) {
+		fprintf(stderr, "Usage: %s <serial device> <store directory> [<type>[:<prescaler>[:compact]] ...]\n", argv[0]);
+		return 1;
+	}
+
+	std::vector<lspc::TelemetryTypes::Stream_t> streams;
+	for (int i = 3; i < argc; i++) {
+		lspc::TelemetryTypes::Stream_t stream;
+		if (!ParseStream(argv[i], stream)) {
+			fprintf(stderr, "Invalid stream: %s\n", argv[i]);
+			return 1;
+		}
+		streams.push_back(stream);
+	}
+
+	capture_t * capture = new capture_t;
+	capture->flushed = 0;
+	if (!capture->store.Open(argv[2])) {
+		fprintf(stderr, "Could not create the store: %s\n", argv[2]);
+		return 1;
+	}
+
+	LSPCClient client;
+	client.SetHandler(&Message_Handler, capture);
+	if (!client.Open(argv[1])) {
+		fprintf(stderr, "Could not open the serial device: %s\n", argv[1]);
+		return 1;
+	}
+
+	signal(SIGINT, Stop_Handler);
+	signal(SIGTERM, Stop_Handler);
+
+	if (!streams.empty() && !client.send(lspc::MessageTypesFromPC::TelemetrySettings,
+			std::vector<uint8_t>((const uint8_t *)streams.data(), (const uint8_t *)(streams.data() + streams.size()))))
+		fprintf(stderr, "Could not enable the telemetry streams\n");
+
+	uint64_t epoch = LSPCClient::Now();
+	LSPCClient::stats_t previous = client.GetStats();
+	for (unsigned int tick = 1; !stop && client.IsReceiving(); tick++) {
+		client.SyncClock(epoch);
+		usleep(CAPTURE_SYNC_INTERVAL);
+		if (tick % CAPTURE_STATS_INTERVAL) continue;
+
+		LSPCClient::stats_t stats = client.GetStats();
+		fprintf(stderr, "\r%8.1f kB/s %8llu packages/s, lost %llu, dropped %llu, overflows %llu, compact skipped %u, ",
+				(stats.bytes - previous.bytes) / 1000.0, (unsigned long long)(stats.packages - previous.packages),
+				(unsigned long long)stats.lost, (unsigned long long)stats.dropped, (unsigned long long)stats.overflows, stats.compactSkipped);
+		if (stats.synchronized)
+			fprintf(stderr, "clock synchronized +-%.0f us    ", stats.offsetStd);
+		else
+			fprintf(stderr, "clock not synchronized    ");
+		previous = stats;
+	}
+	fprintf(stderr, "\n");
+
+	for (size_t i = 0; i < streams.size(); i++)
+		streams[i].prescaler = 0;
+	if (!streams.empty())
+		client.send(lspc::MessageTypesFromPC::TelemetrySettings,
+				std::vector<uint8_t>((const uint8_t *)streams.data(), (const uint8_t *)(streams.data() + streams.size())));
+
+	client.Close(); // decodes the remaining data
+	LSPCClient::stats_t stats = client.GetStats();
+	capture->store.Close();
+	printf("%llu bytes, %llu packages, %llu rows stored, %llu rejected, %llu lost, %llu dropped by the robot, %llu overflows\n",
+			(unsigned long long)stats.bytes, (unsigned long long)stats.packages, (unsigned long long)capture->store.GetRows(),
+			(unsigned long long)capture->store.GetRejected(), (unsigned long long)stats.lost, (unsigned long long)stats.dropped, (unsigned long long)stats.overflows);
+	delete capture;
+	return 0;
+}
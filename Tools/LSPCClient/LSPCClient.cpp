@@ -0,0 +1,340 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+ 
+#include "LSPCClient.h"
+#include "Packet.hpp"
+
+#include <stdio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#include <termios.h>
+#include <chrono>
+
+LSPCClient::LSPCClient() : fd_(-1), running_(false), handler_(0), handlerParam_(0), chunkTime_(0), priority_(lspc::TransmitTypes::PRIORITIES), syncSequence_(0), syncReplied_(0), syncT4_(0)
+{
+	memset(&stats_, 0, sizeof(stats_));
+	incoming_data.reserve(258); // largest encoded package
+
+	// SocketBase does not pass the message type to the callback, so every type is registered with its own parameter
+	for (int type = 1; type < 256; type++) {
+		receivers_[type].client = this;
+		receivers_[type].type = type;
+		registerCallback(type, &LSPCClient::Package_Callback, &receivers_[type]);
+	}
+}
+
+LSPCClient::~LSPCClient()
+{
+	Close();
+}
+
+/**
+ * @brief 	Open the serial device of the robot and start the I/O and decoding threads
+ * @param	device     Input: serial device, eg. /dev/ttyACM0, or a file or pipe with a raw capture of the link
+ * @retval	true if successful
+ */
+bool LSPCClient::Open(const char * device)
+{
+	Close();
+
+	fd_ = open(device, O_RDWR | O_NOCTTY | O_NONBLOCK);
+	if (fd_ < 0)
+		fd_ = open(device, O_RDONLY | O_NONBLOCK); // raw capture
+	if (fd_ < 0) return false;
+
+	struct termios tty;
+	if (tcgetattr(fd_, &tty) == 0) { // not a terminal if this fails, eg. a raw capture
+		cfmakeraw(&tty);
+		tty.c_cflag |= CLOCAL | CREAD;
+		tty.c_cc[VMIN] = 1; // with VMIN = 0 a read without data returns 0 instead of failing with EAGAIN
+		tty.c_cc[VTIME] = 0;
+		tcsetattr(fd_, TCSANOW, &tty);
+		tcflush(fd_, TCIFLUSH); // discard data received before the capture
+	}
+
+	for (int i = 0; i < lspc::TransmitTypes::PRIORITIES; i++) {
+		sequenceValid_[i] = false;
+		sequence_[i] = 0;
+		dropped_[i] = 0;
+	}
+	priority_ = lspc::TransmitTypes::PRIORITIES;
+	memset(&stats_, 0, sizeof(stats_));
+	syncReplied_ = 0;
+	syncT4_ = 0;
+
+	running_ = true;
+	ioThread_ = std::thread(&LSPCClient::IOThread, this);
+	decodeThread_ = std::thread(&LSPCClient::DecodeThread, this);
+	return true;
+}
+
+/**
+ * @brief 	Stop the threads and close the device. The data which has been read is decoded before returning
+ */
+void LSPCClient::Close(void)
+{
+	if (fd_ < 0) return;
+
+	running_ = false;
+	if (ioThread_.joinable()) ioThread_.join();
+	chunksAvailable_.notify_all();
+	if (decodeThread_.joinable()) decodeThread_.join();
+
+	close(fd_);
+	fd_ = -1;
+}
+
+/**
+ * @brief 	Set the handler of received messages, before the device is opened. It is called from the decoding thread
+ */
+void LSPCClient::SetHandler(MessageHandler_t handler, void * param)
+{
+	handler_ = handler;
+	handlerParam_ = param;
+}
+
+/**
+ * @brief 	Send a package to the robot
+ * @param	type       Input: message type (MessageTypesFromPC)
+ * @param	payload    Input: payload of at most 254 bytes
+ * @retval	true if the package was written to the device
+ */
+bool LSPCClient::send(uint8_t type, const std::vector<uint8_t> &payload)
+{
+	if (fd_ < 0 || type == 0x00 || payload.size() > 254) return false;
+
+	lspc::Packet packet(type, payload);
+	const uint8_t * data = packet.encodedDataPtr();
+	size_t length = packet.encodedDataSize();
+
+	std::lock_guard<std::mutex> lock(transmitMutex_);
+	while (length > 0) {
+		ssize_t written = write(fd_, data, length);
+		if (written < 0 && (errno == EAGAIN || errno == EINTR)) {
+			struct pollfd pfd = { fd_, POLLOUT, 0 };
+			if (poll(&pfd, 1, 1000) <= 0) return false; // the device does not accept data
+			continue;
+		}
+		if (written <= 0) return false;
+		data += written;
+		length -= written;
+	}
+	return true;
+}
+
+bool LSPCClient::Transmit(uint8_t type, const void * payload, uint16_t length)
+{
+	return send(type, std::vector<uint8_t>((const uint8_t *)payload, (const uint8_t *)payload + length));
+}
+
+/**
+ * @brief 	Configure a telemetry stream of the robot (TelemetrySettings)
+ * @param	type       Input: periodic message type (MessageTypesToPC)
+ * @param	prescaler  Input: transmit every prescaler'th sample, 0 unsubscribes the message
+ * @param	format     Input: FULL or COMPACT, the handler receives the full message structure in both cases
+ */
+bool LSPCClient::SetTelemetry(uint8_t type, uint16_t prescaler, lspc::TelemetryTypes::format_t format)
+{
+	lspc::TelemetryTypes::Stream_t stream;
+	stream.type = type;
+	stream.format = format;
+	stream.prescaler = prescaler;
+	return Transmit(lspc::MessageTypesFromPC::TelemetrySettings, &stream, sizeof(stream));
+}
+
+/**
+ * @brief 	Send a clock synchronization request, to be called periodically, eg. every 250 ms.
+ *          Each request completes the previous exchange with the reception time of its reply, if it has been received.
+ * @param	epoch      Input: PC time in microseconds since the UNIX epoch at which the telemetry time of the robot is zero
+ */
+bool LSPCClient::SyncClock(uint64_t epoch)
+{
+	lspc::MessageTypesFromPC::TimeSync_t msg;
+	memset(&msg, 0, sizeof(msg));
+	msg.epoch = epoch;
+	{
+		std::lock_guard<std::mutex> lock(statsMutex_);
+		msg.sequence = ++syncSequence_;
+		if (syncReplied_ + 1 == msg.sequence)
+			msg.previous_t4 = syncT4_;
+	}
+	msg.t1 = Now(); // as late as possible
+	return Transmit(lspc::MessageTypesFromPC::TimeSync, &msg, sizeof(msg));
+}
+
+LSPCClient::stats_t LSPCClient::GetStats(void)
+{
+	std::lock_guard<std::mutex> lock(statsMutex_);
+	return stats_;
+}
+
+uint64_t LSPCClient::Now(void)
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+/* Reads the device and queues the data for the decoding thread, without waiting for the decoding */
+void LSPCClient::IOThread(void)
+{
+	std::vector<uint8_t> buffer;
+	struct pollfd pfd = { fd_, POLLIN, 0 };
+
+	while (running_) {
+		if (buffer.empty()) {
+			std::lock_guard<std::mutex> lock(chunksMutex_);
+			if (!freeBuffers_.empty()) {
+				buffer.swap(freeBuffers_.back());
+				freeBuffers_.pop_back();
+			}
+		}
+		buffer.resize(LSPC_CLIENT_READ_SIZE);
+
+		ssize_t length = read(fd_, buffer.data(), buffer.size());
+		if (length < 0 && (errno == EAGAIN || errno == EINTR)) {
+			poll(&pfd, 1, 100); // wake up regularly to check whether the client is closed
+			continue;
+		}
+		if (length == 0) break; // end of a raw capture, or a pipe without writer
+		if (length < 0) {
+			fprintf(stderr, "Serial device read failed: %s\n", strerror(errno));
+			break;
+		}
+
+		uint64_t time = Now();
+		buffer.resize(length);
+		{
+			std::lock_guard<std::mutex> lock(chunksMutex_);
+			if (chunks_.size() >= LSPC_CLIENT_MAX_PENDING) {
+				freeBuffers_.push_back(std::vector<uint8_t>());
+				freeBuffers_.back().swap(chunks_.front().data);
+				chunks_.pop_front();
+				std::lock_guard<std::mutex> statsLock(statsMutex_);
+				stats_.overflows++;
+			}
+			chunks_.push_back(chunk_t());
+			chunks_.back().data.swap(buffer);
+			chunks_.back().time = time;
+		}
+		chunksAvailable_.notify_one();
+		buffer.clear();
+
+		std::lock_guard<std::mutex> lock(statsMutex_);
+		stats_.bytes += length;
+	}
+
+	running_ = false;
+	chunksAvailable_.notify_all();
+}
+
+/* Parses the queued data and calls the message handler. Continues until all queued data has been decoded after the I/O thread has stopped */
+void LSPCClient::DecodeThread(void)
+{
+	std::unique_lock<std::mutex> lock(chunksMutex_);
+	while (true) {
+		while (chunks_.empty() && running_)
+			chunksAvailable_.wait(lock);
+		if (chunks_.empty()) break;
+
+		chunk_t chunk;
+		chunk.data.swap(chunks_.front().data);
+		chunk.time = chunks_.front().time;
+		chunks_.pop_front();
+
+		lock.unlock();
+		chunkTime_ = chunk.time;
+		for (size_t i = 0; i < chunk.data.size(); i++) {
+#ifdef __EXCEPTIONS
+			try {
+				processIncomingByte(chunk.data[i]);
+			} catch (const std::exception&) {
+				// malformed package, the socket resynchronizes on the next header
+			}
+#else
+			processIncomingByte(chunk.data[i]);
+#endif
+		}
+		lock.lock();
+
+		chunk.data.clear();
+		freeBuffers_.push_back(std::vector<uint8_t>());
+		freeBuffers_.back().swap(chunk.data);
+	}
+}
+
+void LSPCClient::Package_Callback(void * param, const std::vector<uint8_t>& payload)
+{
+	receiver_t * receiver = (receiver_t *)param;
+	receiver->client->Receive(receiver->type, payload);
+}
+
+void LSPCClient::Receive(uint8_t type, const std::vector<uint8_t>& payload)
+{
+	std::unique_lock<std::mutex> lock(statsMutex_); // released before calling the handler
+	stats_.packages++;
+
+	if (type == lspc::MessageTypesToPC::Sequence) {
+		lspc::TransmitTypes::Sequence_t sequence;
+		if (!DecodeMessage(payload.data(), payload.size(), sequence) || sequence.priority >= lspc::TransmitTypes::PRIORITIES) {
+			priority_ = lspc::TransmitTypes::PRIORITIES;
+			return;
+		}
+		priority_ = sequence.priority;
+		if (sequenceValid_[priority_]) {
+			stats_.lost += (uint16_t)(sequence.sequence - sequence_[priority_]);
+			stats_.dropped += sequence.dropped - dropped_[priority_];
+		}
+		sequenceValid_[priority_] = true;
+		sequence_[priority_] = sequence.sequence;
+		dropped_[priority_] = sequence.dropped;
+		return;
+	}
+
+	if (priority_ < lspc::TransmitTypes::PRIORITIES)
+		sequence_[priority_]++;
+
+	if (type == lspc::MessageTypesToPC::TimeSync) {
+		lspc::MessageTypesToPC::TimeSync_t reply;
+		if (DecodeMessage(payload.data(), payload.size(), reply)) {
+			if (reply.sequence == syncSequence_) { // replies to older requests are too late to complete an exchange
+				syncReplied_ = reply.sequence;
+				syncT4_ = chunkTime_;
+			}
+			stats_.synchronized = reply.synchronized;
+			stats_.offsetStd = reply.offset_std;
+		}
+	}
+
+	if (type == lspc::MessageTypesToPC::CompactTelemetry) {
+		decoded_.resize(256);
+		uint8_t messageType;
+		uint16_t length = compact_.Decode(payload.data(), payload.size(), messageType, decoded_.data(), decoded_.size());
+		stats_.compactDecoded = compact_.GetDecoded();
+		stats_.compactSkipped = compact_.GetSkipped();
+		lock.unlock();
+		if (length && handler_)
+			handler_(handlerParam_, messageType, decoded_.data(), length, chunkTime_);
+		return;
+	}
+
+	lock.unlock();
+	if (handler_)
+		handler_(handlerParam_, type, payload.data(), payload.size(), chunkTime_);
+}
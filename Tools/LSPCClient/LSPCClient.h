@@ -0,0 +1,152 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+ 
+#ifndef TOOLS_LSPCCLIENT_LSPCCLIENT_H
+#define TOOLS_LSPCCLIENT_LSPCCLIENT_H
+
+#include "SocketBase.hpp"
+#include "MessageTypes.h"
+#include "CompactDecoder.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+#define LSPC_CLIENT_READ_SIZE		65536 // bytes requested per read from the serial device
+#define LSPC_CLIENT_MAX_PENDING		1024 // maximum number of reads waiting to be decoded, before the oldest is discarded
+
+/* PC side of the LSPC link to the robot over the USB serial device.
+ *
+ * A dedicated I/O thread reads the serial device with large non-blocking reads and hands the data to a decoding thread,
+ * such that the device is emptied even if decoding or storing falls behind. The decoding thread parses the packages
+ * with SocketBase and passes every package to the message handler, with CompactTelemetry packages decoded into the full
+ * message structures. The handler is called from the decoding thread only.
+ *
+ * The transmit sequence numbers (TransmitTypes::Sequence_t) are used to count packages lost on the link,
+ * in addition to the packages the robot dropped because its transmit queue was full.
+ *
+ * SyncClock sends a TimeSync request, with which the robot synchronizes its clock to the PC clock (see TimeSync.h).
+ * The reception time of the reply is the time of the read it arrived in, and is sent back with the next request. */
+class LSPCClient : public lspc::SocketBase
+{
+	public:
+		// Handler of received messages, with the reception time in microseconds since the UNIX epoch
+		typedef void (*MessageHandler_t)(void * param, uint8_t type, const uint8_t * msg, uint16_t length, uint64_t time);
+
+		typedef struct {
+			uint64_t bytes;
+			uint64_t packages;
+			uint64_t lost; // packages lost on the link, from gaps in the sequence numbers
+			uint64_t dropped; // packages dropped by the robot during the capture, as reported in the sequence packages
+			uint64_t overflows; // reads discarded because the decoding thread fell behind
+			uint32_t compactDecoded;
+			uint32_t compactSkipped; // compact delta frames which could not be decoded since a previous frame was lost
+			bool synchronized; // the robot clock is synchronized to the PC clock, according to the latest TimeSync reply
+			float offsetStd; // uncertainty of the synchronization in microseconds, from the latest TimeSync reply
+		} stats_t;
+
+	public:
+		LSPCClient();
+		~LSPCClient();
+
+		bool Open(const char * device);
+		void Close(void);
+		bool IsOpen(void) const { return fd_ >= 0; }
+		bool IsReceiving(void) const { return running_; } // false when the device has been closed or disconnected, or a raw capture has ended
+
+		void SetHandler(MessageHandler_t handler, void * param);
+
+		bool send(uint8_t type, const std::vector<uint8_t> &payload);
+		bool Transmit(uint8_t type, const void * payload, uint16_t length);
+		bool SetTelemetry(uint8_t type, uint16_t prescaler, lspc::TelemetryTypes::format_t format = lspc::TelemetryTypes::FULL);
+		bool SyncClock(uint64_t epoch);
+
+		stats_t GetStats(void);
+
+		static uint64_t Now(void);
+
+	private:
+		static void Package_Callback(void * param, const std::vector<uint8_t>& payload);
+		void Receive(uint8_t type, const std::vector<uint8_t>& payload);
+
+		void IOThread(void);
+		void DecodeThread(void);
+
+	private:
+		typedef struct {
+			std::vector<uint8_t> data;
+			uint64_t time; // time of the read
+		} chunk_t;
+
+		typedef struct {
+			LSPCClient * client;
+			uint8_t type;
+		} receiver_t;
+
+		int fd_;
+		std::atomic<bool> running_;
+		std::thread ioThread_;
+		std::thread decodeThread_;
+
+		std::mutex chunksMutex_;
+		std::condition_variable chunksAvailable_;
+		std::deque<chunk_t> chunks_; // reads waiting to be decoded
+		std::vector<std::vector<uint8_t>> freeBuffers_; // buffers of decoded chunks for reuse
+
+		std::mutex transmitMutex_;
+
+		MessageHandler_t handler_;
+		void * handlerParam_;
+		receiver_t receivers_[256]; // callback parameter of each message type
+		CompactDecoder compact_;
+		uint64_t chunkTime_; // reception time of the chunk being decoded
+		std::vector<uint8_t> decoded_;
+
+		bool sequenceValid_[lspc::TransmitTypes::PRIORITIES];
+		uint16_t sequence_[lspc::TransmitTypes::PRIORITIES]; // expected sequence number of the next package of each priority
+		uint32_t dropped_[lspc::TransmitTypes::PRIORITIES];
+		uint8_t priority_; // priority of the packages following the latest sequence package
+
+		std::mutex statsMutex_;
+		stats_t stats_;
+
+		/* Clock synchronization exchanges, protected by statsMutex_ */
+		uint32_t syncSequence_; // sequence number of the latest TimeSync request
+		uint32_t syncReplied_; // sequence number of the latest TimeSync reply
+		uint64_t syncT4_; // reception time of the latest TimeSync reply
+};
+
+/**
+ * @brief 	Copy a received message into its structure
+ * @retval	true if the message has the size of the structure
+ */
+template <typename T>
+inline bool DecodeMessage(const uint8_t * msg, uint16_t length, T& out)
+{
+	if (length != sizeof(T)) return false;
+	memcpy(&out, msg, sizeof(T));
+	return true;
+}
+
+#endif
@@ -0,0 +1,171 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+ 
+#ifndef TOOLS_LSPCCLIENT_MESSAGECOLUMNS_H
+#define TOOLS_LSPCCLIENT_MESSAGECOLUMNS_H
+
+#include "MessageTypes.h"
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef enum: uint8_t {
+	COLUMN_FLOAT32 = 0x00,
+	COLUMN_INT32,
+	COLUMN_UINT32,
+	COLUMN_UINT16,
+	COLUMN_UINT8,
+	COLUMN_UINT64,
+	COLUMN_INT64
+} columnType_t;
+
+/* A column of a table in the column store, taken from a fixed offset of the record.
+ * Array members are stored as a single column with 'count' values per row */
+typedef struct
+{
+	const char * name;
+	uint16_t offset; // byte offset of the first value within the record
+	uint16_t count; // number of consecutive values per row
+	columnType_t type;
+} Column_t;
+
+/* Layout of a message structure of MessageTypesToPC, used to store its packages in columns */
+typedef struct
+{
+	uint8_t type;
+	const char * name;
+	uint16_t size; // size of the message structure, packages of any other length are not decoded
+	const Column_t * columns;
+	uint8_t columnCount;
+} MessageTable_t;
+
+inline uint8_t ColumnTypeSize(columnType_t type)
+{
+	switch (type) {
+		case COLUMN_UINT64:
+		case COLUMN_INT64: return 8;
+		case COLUMN_UINT16: return 2;
+		case COLUMN_UINT8: return 1;
+		default: return 4;
+	}
+}
+
+#define COLUMN(msg, member, count, type)   { #member, (uint16_t)offsetof(lspc::MessageTypesToPC::msg, member), count, type }
+
+static const Column_t StateEstimatesColumns[] = {
+	COLUMN(StateEstimates_t, time, 1, COLUMN_FLOAT32),
+	COLUMN(StateEstimates_t, q.w, 1, COLUMN_FLOAT32), COLUMN(StateEstimates_t, q.x, 1, COLUMN_FLOAT32), COLUMN(StateEstimates_t, q.y, 1, COLUMN_FLOAT32), COLUMN(StateEstimates_t, q.z, 1, COLUMN_FLOAT32),
+	COLUMN(StateEstimates_t, dq.w, 1, COLUMN_FLOAT32), COLUMN(StateEstimates_t, dq.x, 1, COLUMN_FLOAT32), COLUMN(StateEstimates_t, dq.y, 1, COLUMN_FLOAT32), COLUMN(StateEstimates_t, dq.z, 1, COLUMN_FLOAT32),
+	COLUMN(StateEstimates_t, pos.x, 1, COLUMN_FLOAT32), COLUMN(StateEstimates_t, pos.y, 1, COLUMN_FLOAT32),
+	COLUMN(StateEstimates_t, vel.x, 1, COLUMN_FLOAT32), COLUMN(StateEstimates_t, vel.y, 1, COLUMN_FLOAT32),
+	COLUMN(StateEstimates_t, COM.x, 1, COLUMN_FLOAT32), COLUMN(StateEstimates_t, COM.y, 1, COLUMN_FLOAT32), COLUMN(StateEstimates_t, COM.z, 1, COLUMN_FLOAT32)
+};
+
+static const Column_t ControllerInfoColumns[] = {
+	COLUMN(ControllerInfo_t, time, 1, COLUMN_FLOAT32),
+	COLUMN(ControllerInfo_t, type, 1, COLUMN_UINT8),
+	COLUMN(ControllerInfo_t, mode, 1, COLUMN_UINT8),
+	COLUMN(ControllerInfo_t, torque1, 1, COLUMN_FLOAT32), COLUMN(ControllerInfo_t, torque2, 1, COLUMN_FLOAT32), COLUMN(ControllerInfo_t, torque3, 1, COLUMN_FLOAT32),
+	COLUMN(ControllerInfo_t, compute_time, 1, COLUMN_FLOAT32),
+	COLUMN(ControllerInfo_t, delivered_torque1, 1, COLUMN_FLOAT32), COLUMN(ControllerInfo_t, delivered_torque2, 1, COLUMN_FLOAT32), COLUMN(ControllerInfo_t, delivered_torque3, 1, COLUMN_FLOAT32)
+};
+
+static const Column_t RawSensor_IMU_MPU9250Columns[] = {
+	COLUMN(RawSensor_IMU_MPU9250_t, time, 1, COLUMN_FLOAT32),
+	COLUMN(RawSensor_IMU_MPU9250_t, accelerometer.x, 1, COLUMN_FLOAT32), COLUMN(RawSensor_IMU_MPU9250_t, accelerometer.y, 1, COLUMN_FLOAT32), COLUMN(RawSensor_IMU_MPU9250_t, accelerometer.z, 1, COLUMN_FLOAT32),
+	COLUMN(RawSensor_IMU_MPU9250_t, accelerometer.cov, 9, COLUMN_FLOAT32),
+	COLUMN(RawSensor_IMU_MPU9250_t, gyroscope.x, 1, COLUMN_FLOAT32), COLUMN(RawSensor_IMU_MPU9250_t, gyroscope.y, 1, COLUMN_FLOAT32), COLUMN(RawSensor_IMU_MPU9250_t, gyroscope.z, 1, COLUMN_FLOAT32),
+	COLUMN(RawSensor_IMU_MPU9250_t, gyroscope.cov, 9, COLUMN_FLOAT32),
+	COLUMN(RawSensor_IMU_MPU9250_t, magnetometer.x, 1, COLUMN_FLOAT32), COLUMN(RawSensor_IMU_MPU9250_t, magnetometer.y, 1, COLUMN_FLOAT32), COLUMN(RawSensor_IMU_MPU9250_t, magnetometer.z, 1, COLUMN_FLOAT32),
+	COLUMN(RawSensor_IMU_MPU9250_t, magnetometer.cov, 9, COLUMN_FLOAT32)
+};
+
+static const Column_t RawSensor_IMU_MTI200Columns[] = {
+	COLUMN(RawSensor_IMU_MTI200_t, time, 1, COLUMN_FLOAT32),
+	COLUMN(RawSensor_IMU_MTI200_t, accelerometer.x, 1, COLUMN_FLOAT32), COLUMN(RawSensor_IMU_MTI200_t, accelerometer.y, 1, COLUMN_FLOAT32), COLUMN(RawSensor_IMU_MTI200_t, accelerometer.z, 1, COLUMN_FLOAT32),
+	COLUMN(RawSensor_IMU_MTI200_t, gyroscope.x, 1, COLUMN_FLOAT32), COLUMN(RawSensor_IMU_MTI200_t, gyroscope.y, 1, COLUMN_FLOAT32), COLUMN(RawSensor_IMU_MTI200_t, gyroscope.z, 1, COLUMN_FLOAT32),
+	COLUMN(RawSensor_IMU_MTI200_t, magnetometer.x, 1, COLUMN_FLOAT32), COLUMN(RawSensor_IMU_MTI200_t, magnetometer.y, 1, COLUMN_FLOAT32), COLUMN(RawSensor_IMU_MTI200_t, magnetometer.z, 1, COLUMN_FLOAT32)
+};
+
+static const Column_t RawSensor_EncodersColumns[] = {
+	COLUMN(RawSensor_Encoders_t, time, 1, COLUMN_FLOAT32),
+	COLUMN(RawSensor_Encoders_t, angle1, 1, COLUMN_FLOAT32), COLUMN(RawSensor_Encoders_t, angle2, 1, COLUMN_FLOAT32), COLUMN(RawSensor_Encoders_t, angle3, 1, COLUMN_FLOAT32)
+};
+
+static const Column_t RawSensor_BatteryColumns[] = {
+	COLUMN(RawSensor_Battery_t, time, 1, COLUMN_FLOAT32),
+	COLUMN(RawSensor_Battery_t, vbat1, 1, COLUMN_FLOAT32), COLUMN(RawSensor_Battery_t, vbat2, 1, COLUMN_FLOAT32),
+	COLUMN(RawSensor_Battery_t, current1, 1, COLUMN_FLOAT32), COLUMN(RawSensor_Battery_t, current2, 1, COLUMN_FLOAT32),
+	COLUMN(RawSensor_Battery_t, pct1, 1, COLUMN_FLOAT32), COLUMN(RawSensor_Battery_t, pct2, 1, COLUMN_FLOAT32)
+};
+
+static const Column_t SensorSampleColumns[] = {
+	COLUMN(SensorSample_t, sample, 1, COLUMN_UINT32),
+	COLUMN(SensorSample_t, timer, 1, COLUMN_UINT32),
+	COLUMN(SensorSample_t, accelerometer, 3, COLUMN_FLOAT32),
+	COLUMN(SensorSample_t, gyroscope, 3, COLUMN_FLOAT32),
+	COLUMN(SensorSample_t, encoderTicks, 3, COLUMN_INT32),
+	COLUMN(SensorSample_t, encoderAngle, 3, COLUMN_FLOAT32),
+	COLUMN(SensorSample_t, xy, 2, COLUMN_FLOAT32),
+	COLUMN(SensorSample_t, q_ref, 4, COLUMN_FLOAT32),
+	COLUMN(SensorSample_t, omega_ref_body, 3, COLUMN_FLOAT32),
+	COLUMN(SensorSample_t, omega_ref_inertial, 3, COLUMN_FLOAT32),
+	COLUMN(SensorSample_t, type, 1, COLUMN_UINT8),
+	COLUMN(SensorSample_t, mode, 1, COLUMN_UINT8),
+	COLUMN(SensorSample_t, q, 4, COLUMN_FLOAT32),
+	COLUMN(SensorSample_t, torque, 3, COLUMN_FLOAT32)
+};
+
+static const Column_t TimeSyncColumns[] = {
+	COLUMN(TimeSync_t, t1, 1, COLUMN_UINT64), COLUMN(TimeSync_t, t2, 1, COLUMN_UINT64), COLUMN(TimeSync_t, t3, 1, COLUMN_UINT64),
+	COLUMN(TimeSync_t, epoch, 1, COLUMN_UINT64),
+	COLUMN(TimeSync_t, offset, 1, COLUMN_INT64),
+	COLUMN(TimeSync_t, drift, 1, COLUMN_FLOAT32), COLUMN(TimeSync_t, offset_std, 1, COLUMN_FLOAT32), COLUMN(TimeSync_t, delay, 1, COLUMN_FLOAT32),
+	COLUMN(TimeSync_t, sequence, 1, COLUMN_UINT32),
+	COLUMN(TimeSync_t, synchronized, 1, COLUMN_UINT8)
+};
+
+#undef COLUMN
+
+#define MESSAGE_TABLE(msg, columns)   { lspc::MessageTypesToPC::msg, #msg, sizeof(lspc::MessageTypesToPC::msg##_t), columns, sizeof(columns) / sizeof(Column_t) }
+
+static const MessageTable_t MessageTables[] = {
+	MESSAGE_TABLE(StateEstimates, StateEstimatesColumns),
+	MESSAGE_TABLE(ControllerInfo, ControllerInfoColumns),
+	MESSAGE_TABLE(RawSensor_IMU_MPU9250, RawSensor_IMU_MPU9250Columns),
+	MESSAGE_TABLE(RawSensor_IMU_MTI200, RawSensor_IMU_MTI200Columns),
+	MESSAGE_TABLE(RawSensor_Encoders, RawSensor_EncodersColumns),
+	MESSAGE_TABLE(RawSensor_Battery, RawSensor_BatteryColumns),
+	MESSAGE_TABLE(SensorSample, SensorSampleColumns),
+	MESSAGE_TABLE(TimeSync, TimeSyncColumns)
+};
+
+#undef MESSAGE_TABLE
+
+// Layout of a message type, or 0 if packages of the type are stored as raw payloads
+inline const MessageTable_t * GetMessageTable(uint8_t type)
+{
+	for (size_t i = 0; i < sizeof(MessageTables) / sizeof(MessageTable_t); i++) {
+		if (MessageTables[i].type == type)
+			return &MessageTables[i];
+	}
+	return 0;
+}
+
+#endif
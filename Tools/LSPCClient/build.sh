@@ -0,0 +1,7 @@
+#!/bin/sh
+# Build the PC side LSPC client and the capture tool, with the message definitions and package decoding of the firmware
+cd "$(dirname "$0")"
+LIB=../../KugleFirmware/Libraries
+CXX=${CXX:-g++}
+
+$CXX -std=gnu++11 -O2 -pthread -Wall -Wextra -I$LIB/Devices/LSPC LSPCCapture.cpp LSPCClient.cpp ColumnStore.cpp -o LSPCCapture
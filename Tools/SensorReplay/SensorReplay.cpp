@@ -0,0 +1,187 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+ 
+ 
+
+/* Deterministic replay of a sensor log (see SensorLog.hpp) through the estimators and controllers of the balance controller.
+ *
+ * The logged samples are fed through BalanceLoop, i.e. the same IMU correction, filters, estimators and controllers
+ * as the firmware, with the logged parameters, IMU calibration, controller mode and references.
+ * The sample time of the estimators is taken from the logged timer values, so a replay of a given log on a given
+ * build always produces the same output bit by bit. It is not bit identical to the firmware itself, since the
+ * estimators start from a reset at the first replayed sample and the host compiler and CMSIS-DSP stand-in
+ * (host/arm_math.h) may round differently than the Cortex-M7 build.
+ *
+ * The output is an array of Output_t records, or a text table if the output file name ends with ".csv".
+ * Build with build.sh, which compiles the firmware sources with the host stand-ins in host/.
+ *
+ * Usage: SensorReplay <log file> <output file> [start time] [end time]
+ *        times in seconds since the first sample of the log
+ */
+
+#include "SensorLog.hpp"
+#include "BalanceLoop.h"
+#include "Parameters.h"
+#include "IMU.h"
+#include "Timer.h"
+#include "CRC32.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+#include <new>
+
+typedef struct {
+	uint32_t sample; // sample number of the firmware
+	uint32_t timer;
+	float q[4];
+	float dq[4];
+	float dxy[2];
+	float COM[3];
+	float torque[3];
+} Output_t;
+
+static bool EndsWith(const char * text, const char * suffix)
+{
+	size_t length = strlen(text), suffixLength = strlen(suffix);
+	return length >= suffixLength && strcmp(&text[length - suffixLength], suffix) == 0;
+}
+
+static void WriteOutput(FILE * file, bool text, const Output_t& out)
+{
+	if (!text) {
+		fwrite(&out, sizeof(out), 1, file);
+		return;
+	}
+	/* 9 significant digits are enough to restore every float exactly */
+	fprintf(file, "%u,%u,%.9g,%.9g,%.9g,%.9g,%.9g,%.9g,%.9g,%.9g,%.9g,%.9g,%.9g,%.9g,%.9g,%.9g,%.9g,%.9g\n", out.sample, out.timer,
+			out.q[0], out.q[1], out.q[2], out.q[3], out.dq[0], out.dq[1], out.dq[2], out.dq[3], out.dxy[0], out.dxy[1],
+			out.COM[0], out.COM[1], out.COM[2], out.torque[0], out.torque[1], out.torque[2]);
+}
+
+int main(int argc, char ** argv)
+{
+	if (argc < 3) {
+		fprintf(stderr, "Usage: %s <log file> <output file> [start time] [end time]\n", argv[0]);
+		return 1;
+	}
+
+	SensorLogReader log;
+	if (!log.Open(argv[1])) {
+		fprintf(stderr, "Could not open sensor log %s\n", argv[1]);
+		return 1;
+	}
+
+	/* Load the logged parameters and IMU calibration */
+	Parameters params;
+	if (!params.WriteBlock(log.GetParameters(), log.GetParametersSize())) {
+		fprintf(stderr, "The parameter block of the log does not match the parameter layout of this build\n");
+		return 1;
+	}
+	params.Refresh();
+
+	IMU imu;
+	if (log.GetCalibrationSize() > 0 && !imu.LoadCalibration(log.GetCalibration(), log.GetCalibrationSize())) {
+		fprintf(stderr, "The IMU calibration block of the log does not match the calibration layout of this build\n");
+		return 1;
+	}
+
+	uint64_t first = (argc > 3) ? log.Find((uint64_t)(atof(argv[3]) * 1e6)) : 0;
+	uint64_t last = (argc > 4) ? log.Find((uint64_t)(atof(argv[4]) * 1e6)) : log.GetSampleCount();
+	if (first >= last) {
+		fprintf(stderr, "No samples to replay\n");
+		return 1;
+	}
+
+	bool text = EndsWith(argv[2], ".csv");
+	FILE * output = fopen(argv[2], text ? "w" : "wb");
+	if (!output) {
+		fprintf(stderr, "Could not create %s\n", argv[2]);
+		return 1;
+	}
+	static char outputBuffer[1 << 20];
+	setvbuf(output, outputBuffer, _IOFBF, sizeof(outputBuffer));
+	if (text)
+		fprintf(output, "sample,timer,q0,q1,q2,q3,dq0,dq1,dq2,dq3,dx,dy,COM_x,COM_y,COM_z,torque1,torque2,torque3\n");
+
+	Timer microsTimer;
+	BalanceLoop * loop = 0;
+
+	IMU::Measurement_t imuMeas;
+	memset(&imuMeas, 0, sizeof(imuMeas));
+	Output_t out;
+	uint32_t crc = 0;
+	uint64_t resets = 0, dropped = 0;
+	float qDeviation = 0, torqueDeviation = 0;
+
+	auto startTime = std::chrono::steady_clock::now();
+
+	for (uint64_t i = first; i < last; i++) {
+		const lspc::MessageTypesToPC::SensorSample_t& sample = log.GetSample(i);
+		microsTimer.Set(sample.timer);
+
+		memcpy(imuMeas.Accelerometer, sample.accelerometer, sizeof(imuMeas.Accelerometer));
+		memcpy(imuMeas.Gyroscope, sample.gyroscope, sizeof(imuMeas.Gyroscope));
+
+		/* Reset like the firmware at the first sample and whenever the balance controller was restarted */
+		if (!loop || sample.sample <= out.sample) {
+			if (loop) loop->~BalanceLoop();
+			static uint8_t loopMemory[sizeof(BalanceLoop)] __attribute__((aligned(16)));
+			loop = new (loopMemory) BalanceLoop(params, &microsTimer);
+			loop->Reset(imuMeas, sample.encoderTicks, sample.encoderAngle);
+			memset(&out, 0, sizeof(out));
+			out.COM[2] = params.model.l; // initialize COM directly above center of ball at height L
+			resets++;
+		} else {
+			dropped += sample.sample - out.sample - 1;
+		}
+
+		/* The controller type and mode are changed at run time, eg. when starting the balance controller */
+		params.controller.type = sample.type;
+		params.controller.mode = sample.mode;
+
+		loop->Estimate(imu, imuMeas, sample.encoderTicks, sample.encoderAngle, out.q, out.dq, out.dxy, out.COM);
+		loop->Control(out.q, out.dq, sample.xy, out.dxy, sample.q_ref, sample.omega_ref_body, sample.omega_ref_inertial, out.torque);
+
+		out.sample = sample.sample;
+		out.timer = sample.timer;
+		WriteOutput(output, text, out);
+		crc = CRC32_Update(crc, (const uint8_t *)&out, sizeof(out));
+
+		for (int j = 0; j < 4; j++) qDeviation = fmaxf(qDeviation, fabsf(out.q[j] - sample.q[j]));
+		for (int j = 0; j < 3; j++) torqueDeviation = fmaxf(torqueDeviation, fabsf(out.torque[j] - sample.torque[j]));
+	}
+
+	double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+	bool success = (fclose(output) == 0);
+
+	uint64_t samples = last - first;
+	printf("Replayed %llu samples (%llu resets, %llu dropped by the firmware) in %.3f s, %.0f samples/s\n",
+		   (unsigned long long)samples, (unsigned long long)resets, (unsigned long long)dropped, elapsed, samples / elapsed);
+	printf("Maximum deviation from the firmware: quaternion %g, torque %g\n", qDeviation, torqueDeviation);
+	printf("Output checksum: %08X\n", (unsigned int)crc);
+
+	if (!success) {
+		fprintf(stderr, "Could not write %s\n", argv[2]);
+		return 1;
+	}
+	return 0;
+}
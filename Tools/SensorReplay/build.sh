@@ -0,0 +1,22 @@
+#!/bin/sh
+# Build the sensor log replay tool for the host from the firmware sources, with the stand-ins in host/ for the hardware and RTOS dependencies
+cd "$(dirname "$0")"
+LIB=../../KugleFirmware/Libraries
+CXX=${CXX:-g++}
+
+INCLUDES="-Ihost -I$LIB/Applications/BalanceController -I$LIB/Modules/Debug -I$LIB/Modules/Parameters -I$LIB/Devices/LSPC -I$LIB/Devices/IMU \
+	-I$LIB/Modules/Controllers/LQR -I$LIB/Modules/Controllers/SlidingMode -I$LIB/Modules/Controllers/ModelMatrices \
+	-I$LIB/Modules/Estimators/QEKF -I$LIB/Modules/Estimators/QEKF/MATLABCoder -I$LIB/Modules/Estimators/MEKF -I$LIB/Modules/Estimators/MadgwickAHRS/src \
+	-I$LIB/Modules/Estimators/VelocityEKF -I$LIB/Modules/Estimators/VelocityEKF/MATLABCoder -I$LIB/Modules/Estimators/COMEKF -I$LIB/Modules/Estimators/COMEKF/MATLABCoder \
+	-I$LIB/Modules/Estimators/Kinematics -I$LIB/Modules/Estimators/Kinematics/MATLABCoder \
+	-I$LIB/Misc/IIR -I$LIB/Misc/Dual -I$LIB/Misc/FirstOrderLPF -I$LIB/Misc/Matrix -I$LIB/Misc/Quaternion -I$LIB/Misc/Math -I$LIB/Misc/CRC -I$LIB/Misc/MATLABCoderInit -I$LIB/Misc/StaticArena"
+
+SOURCES="SensorReplay.cpp $LIB/Applications/BalanceController/BalanceLoop.cpp $LIB/Modules/Parameters/Parameters.cpp $LIB/Devices/IMU/IMU.cpp \
+	$LIB/Modules/Controllers/LQR/LQR.cpp $LIB/Modules/Controllers/SlidingMode/SlidingMode.cpp $LIB/Modules/Controllers/ModelMatrices/*.cpp \
+	$LIB/Modules/Estimators/QEKF/QEKF.cpp $LIB/Modules/Estimators/QEKF/MATLABCoder/*.cpp $LIB/Modules/Estimators/MEKF/MEKF.cpp $LIB/Modules/Estimators/MadgwickAHRS/src/MadgwickAHRS.cpp \
+	$LIB/Modules/Estimators/VelocityEKF/*.cpp $LIB/Modules/Estimators/VelocityEKF/MATLABCoder/*.cpp $LIB/Modules/Estimators/COMEKF/*.cpp $LIB/Modules/Estimators/COMEKF/MATLABCoder/*.cpp \
+	$LIB/Modules/Estimators/Kinematics/*.cpp $LIB/Modules/Estimators/Kinematics/MATLABCoder/*.cpp \
+	$LIB/Misc/FirstOrderLPF/FirstOrderLPF.cpp $LIB/Misc/Matrix/*.cpp $LIB/Misc/Quaternion/Quaternion.cpp $LIB/Misc/Math/Math.cpp $LIB/Misc/CRC/CRC32.cpp $LIB/Misc/MATLABCoderInit/*.cpp $LIB/Misc/StaticArena/StaticArena.cpp"
+
+# No fast-math or FMA contraction, such that the results only depend on the order of the operations in the code
+$CXX -std=gnu++11 -O2 -ffp-contract=off -Wall -Wextra $INCLUDES $SOURCES -o SensorReplay
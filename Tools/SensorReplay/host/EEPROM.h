@@ -0,0 +1,54 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+ 
+ 
+
+#ifndef HOST_EEPROM_H
+#define HOST_EEPROM_H
+
+#include <stdint.h>
+
+#define EEPROM_FIRST_SECTOR		6
+#define EEPROM_SECTORS			2
+
+class FlashMemory;
+
+/* The replay has no EEPROM, the parameters and the IMU calibration are loaded from the log, see Tools/SensorReplay */
+class EEPROM
+{
+	public:
+		typedef enum {
+			EEPROM_FLASH_COMPLETE = 0,
+			EEPROM_ERROR
+		} errorCode_t;
+
+		struct sections_t {
+			uint16_t internal = 0x0000;
+			uint16_t parameters = 0x0010;
+			uint16_t imu_calibration = 0x1000;
+		} sections;
+
+		bool EnableSection(uint16_t, uint16_t) { return false; };
+		errorCode_t WriteData(uint16_t, uint8_t *, uint16_t) { return EEPROM_ERROR; };
+		errorCode_t ReadData(uint16_t, uint8_t *, uint16_t) { return EEPROM_ERROR; };
+		uint16_t GetSectionSize(uint16_t) { return 0; };
+		bool CopyTo(FlashMemory&) { return false; };
+};
+
+#endif
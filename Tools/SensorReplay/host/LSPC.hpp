@@ -0,0 +1,77 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+ 
+ 
+
+#ifndef HOST_LSPC_HPP
+#define HOST_LSPC_HPP
+
+#include "MessageTypes.h"
+#include "MessageRegistry.hpp"
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+#define LSPC_MAXIMUM_PACKAGE_LENGTH		250
+
+namespace lspc
+{
+typedef struct LSPC_Async_Package_t {
+	uint8_t type;
+	uint16_t length;
+	uint8_t * payload;
+} LSPC_Async_Package_t;
+}
+
+/* The replay is not connected to a PC, see Tools/SensorReplay */
+class LSPC
+{
+	public:
+		bool registerCallback(uint8_t, void (*)(void * param, const std::vector<uint8_t>& payload), void *) { return true; };
+		bool unregisterCallback(uint8_t) { return true; };
+		bool TransmitAsync(uint8_t, const uint8_t *, uint16_t) { return false; };
+		bool Reserve(uint8_t, uint16_t, lspc::LSPC_Async_Package_t&) { return false; };
+		void Shrink(lspc::LSPC_Async_Package_t&, uint16_t) {};
+		bool Submit(lspc::LSPC_Async_Package_t&) { return false; };
+
+		template <lspc::MessageTypesFromPC::MessageTypesFromPC_t Type>
+		bool registerCallback(void (*)(void * param, const typename lspc::FromPC<Type>::type& msg), void * = 0) { return true; };
+		template <lspc::MessageTypesFromPC::MessageTypesFromPC_t Type>
+		bool registerCallback(void (*)(void * param, const typename lspc::FromPC<Type>::type& msg, const uint8_t * data, uint16_t length), void * = 0) { return true; };
+		template <lspc::MessageTypesToPC::MessageTypesToPC_t Type>
+		bool TransmitAsync(const typename lspc::ToPC<Type>::type&) { return false; };
+
+		/* Nothing is reserved, so the message is never filled */
+		template <lspc::MessageTypesToPC::MessageTypesToPC_t Type>
+		class Message
+		{
+			public:
+				typedef typename lspc::ToPC<Type>::type type;
+				Message(LSPC&, uint16_t = 0) {};
+				bool Reserved(void) const { return false; };
+				type * operator->() { return &msg_; };
+				type& operator*() { return msg_; };
+				uint8_t * Data(void) { return 0; };
+				bool Transmit(void) { return false; };
+			private:
+				type msg_;
+		};
+};
+
+#endif
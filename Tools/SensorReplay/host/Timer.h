@@ -0,0 +1,56 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+ 
+ 
+
+#ifndef HOST_TIMER_H
+#define HOST_TIMER_H
+
+#include <stdint.h>
+
+/* Microseconds timer of the replay, which returns the timer value of the sample being replayed.
+ * GetDeltaTime is identical to the firmware implementation, such that the estimators see the same sample times. */
+class Timer
+{
+	public:
+		Timer(uint32_t frequency = 1000000) : frequency_(frequency), value_(0) {};
+
+		void Set(uint32_t value) { value_ = value; };
+		uint32_t Get() { return value_; };
+		float GetTime() { return (float)Get() / (float)frequency_; };
+
+		float GetDeltaTime(uint32_t prevTimerValue)
+		{
+			uint32_t timerDelta;
+			uint32_t timerNow = Get();
+			if (timerNow > prevTimerValue)
+				timerDelta = timerNow - prevTimerValue;
+			else
+				timerDelta = ((uint32_t)0xFFFFFFFF - prevTimerValue) + timerNow;
+
+			float microsTime = (float)timerDelta / (float)frequency_;
+			return microsTime;
+		}
+
+	private:
+		uint32_t frequency_;
+		uint32_t value_;
+};
+
+#endif
@@ -0,0 +1,153 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+ 
+ 
+
+#ifndef HOST_ARM_MATH_H
+#define HOST_ARM_MATH_H
+
+/* Portable implementation of the CMSIS-DSP functions used by the modules of the replay, see Tools/SensorReplay.
+ * Every sum is accumulated in the order of the elements, like the CMSIS-DSP functions without the DSP extension. */
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+typedef float float32_t;
+typedef int8_t q7_t;
+typedef int16_t q15_t;
+typedef int32_t q31_t;
+
+typedef enum {
+	ARM_MATH_SUCCESS = 0,
+	ARM_MATH_ARGUMENT_ERROR = -1,
+	ARM_MATH_LENGTH_ERROR = -2,
+	ARM_MATH_SIZE_MISMATCH = -3,
+	ARM_MATH_NANINF = -4,
+	ARM_MATH_SINGULAR = -5,
+	ARM_MATH_TEST_FAILURE = -6
+} arm_status;
+
+typedef struct {
+	uint16_t numRows;
+	uint16_t numCols;
+	float32_t * pData;
+} arm_matrix_instance_f32;
+
+inline void arm_mat_init_f32(arm_matrix_instance_f32 * S, uint16_t nRows, uint16_t nColumns, float32_t * pData)
+{
+	S->numRows = nRows;
+	S->numCols = nColumns;
+	S->pData = pData;
+}
+
+inline arm_status arm_mat_add_f32(const arm_matrix_instance_f32 * pSrcA, const arm_matrix_instance_f32 * pSrcB, arm_matrix_instance_f32 * pDst)
+{
+	if (pSrcA->numRows != pSrcB->numRows || pSrcA->numCols != pSrcB->numCols || pSrcA->numRows != pDst->numRows || pSrcA->numCols != pDst->numCols)
+		return ARM_MATH_SIZE_MISMATCH;
+	for (uint32_t i = 0; i < (uint32_t)pSrcA->numRows * pSrcA->numCols; i++)
+		pDst->pData[i] = pSrcA->pData[i] + pSrcB->pData[i];
+	return ARM_MATH_SUCCESS;
+}
+
+inline arm_status arm_mat_sub_f32(const arm_matrix_instance_f32 * pSrcA, const arm_matrix_instance_f32 * pSrcB, arm_matrix_instance_f32 * pDst)
+{
+	if (pSrcA->numRows != pSrcB->numRows || pSrcA->numCols != pSrcB->numCols || pSrcA->numRows != pDst->numRows || pSrcA->numCols != pDst->numCols)
+		return ARM_MATH_SIZE_MISMATCH;
+	for (uint32_t i = 0; i < (uint32_t)pSrcA->numRows * pSrcA->numCols; i++)
+		pDst->pData[i] = pSrcA->pData[i] - pSrcB->pData[i];
+	return ARM_MATH_SUCCESS;
+}
+
+inline arm_status arm_mat_scale_f32(const arm_matrix_instance_f32 * pSrc, float32_t scale, arm_matrix_instance_f32 * pDst)
+{
+	if (pSrc->numRows != pDst->numRows || pSrc->numCols != pDst->numCols)
+		return ARM_MATH_SIZE_MISMATCH;
+	for (uint32_t i = 0; i < (uint32_t)pSrc->numRows * pSrc->numCols; i++)
+		pDst->pData[i] = pSrc->pData[i] * scale;
+	return ARM_MATH_SUCCESS;
+}
+
+inline arm_status arm_mat_trans_f32(const arm_matrix_instance_f32 * pSrc, arm_matrix_instance_f32 * pDst)
+{
+	if (pSrc->numRows != pDst->numCols || pSrc->numCols != pDst->numRows)
+		return ARM_MATH_SIZE_MISMATCH;
+	for (uint16_t row = 0; row < pSrc->numRows; row++)
+		for (uint16_t col = 0; col < pSrc->numCols; col++)
+			pDst->pData[col * pDst->numCols + row] = pSrc->pData[row * pSrc->numCols + col];
+	return ARM_MATH_SUCCESS;
+}
+
+inline arm_status arm_mat_mult_f32(const arm_matrix_instance_f32 * pSrcA, const arm_matrix_instance_f32 * pSrcB, arm_matrix_instance_f32 * pDst)
+{
+	if (pSrcA->numCols != pSrcB->numRows || pSrcA->numRows != pDst->numRows || pSrcB->numCols != pDst->numCols)
+		return ARM_MATH_SIZE_MISMATCH;
+	for (uint16_t row = 0; row < pSrcA->numRows; row++) {
+		for (uint16_t col = 0; col < pSrcB->numCols; col++) {
+			float32_t sum = 0.0f;
+			for (uint16_t k = 0; k < pSrcA->numCols; k++)
+				sum += pSrcA->pData[row * pSrcA->numCols + k] * pSrcB->pData[k * pSrcB->numCols + col];
+			pDst->pData[row * pDst->numCols + col] = sum;
+		}
+	}
+	return ARM_MATH_SUCCESS;
+}
+
+inline void arm_add_f32(const float32_t * pSrcA, const float32_t * pSrcB, float32_t * pDst, uint32_t blockSize)
+{
+	for (uint32_t i = 0; i < blockSize; i++) pDst[i] = pSrcA[i] + pSrcB[i];
+}
+
+inline void arm_sub_f32(const float32_t * pSrcA, const float32_t * pSrcB, float32_t * pDst, uint32_t blockSize)
+{
+	for (uint32_t i = 0; i < blockSize; i++) pDst[i] = pSrcA[i] - pSrcB[i];
+}
+
+inline void arm_mult_f32(const float32_t * pSrcA, const float32_t * pSrcB, float32_t * pDst, uint32_t blockSize)
+{
+	for (uint32_t i = 0; i < blockSize; i++) pDst[i] = pSrcA[i] * pSrcB[i];
+}
+
+inline void arm_scale_f32(const float32_t * pSrc, float32_t scale, float32_t * pDst, uint32_t blockSize)
+{
+	for (uint32_t i = 0; i < blockSize; i++) pDst[i] = pSrc[i] * scale;
+}
+
+inline void arm_negate_f32(const float32_t * pSrc, float32_t * pDst, uint32_t blockSize)
+{
+	for (uint32_t i = 0; i < blockSize; i++) pDst[i] = -pSrc[i];
+}
+
+inline void arm_dot_prod_f32(const float32_t * pSrcA, const float32_t * pSrcB, uint32_t blockSize, float32_t * result)
+{
+	float32_t sum = 0.0f;
+	for (uint32_t i = 0; i < blockSize; i++) sum += pSrcA[i] * pSrcB[i];
+	*result = sum;
+}
+
+inline arm_status arm_sqrt_f32(float32_t in, float32_t * pOut)
+{
+	if (in >= 0.0f) {
+		*pOut = sqrtf(in);
+		return ARM_MATH_SUCCESS;
+	}
+	*pOut = 0.0f;
+	return ARM_MATH_ARGUMENT_ERROR;
+}
+
+#endif
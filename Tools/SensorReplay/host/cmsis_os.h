@@ -0,0 +1,52 @@
+/* Copyright (C) 2018-2019 Thomas Jespersen, TKJ Electronics. All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify  
+ * it under the terms of the GNU General Public License as published by  
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but 
+ * WITHOUT ANY WARRANTY; without even the implied warranty of 
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU 
+ * General Public License for more details. 
+ *
+ * Contact information
+ * ------------------------------------------
+ * Thomas Jespersen, TKJ Electronics
+ * Web      :  http://www.tkjelectronics.dk
+ * e-mail   :  thomasj@tkjelectronics.dk
+ * ------------------------------------------
+ */
+ 
+ 
+
+#ifndef HOST_CMSIS_OS_H
+#define HOST_CMSIS_OS_H
+
+/* Single threaded stand-in for the FreeRTOS API used by the modules of the replay, see Tools/SensorReplay */
+#include <stdint.h>
+#include <stdlib.h>
+
+typedef uint32_t TickType_t;
+typedef void * SemaphoreHandle_t;
+typedef void * QueueHandle_t;
+typedef void * TaskHandle_t;
+typedef long BaseType_t;
+typedef uint32_t StackType_t;
+typedef struct { uint8_t reserved[64]; } StaticTask_t;
+
+#define portMAX_DELAY           0xFFFFFFFF
+#define configTICK_RATE_HZ      1000
+#define pdTRUE                  1
+#define pdFALSE                 0
+
+inline SemaphoreHandle_t xSemaphoreCreateBinary(void) { static uint8_t semaphore; return &semaphore; }
+inline BaseType_t xSemaphoreTake(SemaphoreHandle_t, TickType_t) { return pdTRUE; }
+inline BaseType_t xSemaphoreGive(SemaphoreHandle_t) { return pdTRUE; }
+inline void vSemaphoreDelete(SemaphoreHandle_t) {}
+inline void vQueueAddToRegistry(QueueHandle_t, const char *) {}
+inline void vQueueUnregisterQueue(QueueHandle_t) {}
+inline void * pvPortMalloc(size_t size) { return malloc(size); }
+inline void vPortFree(void * data) { free(data); }
+inline void osDelay(uint32_t) {}
+
+#endif